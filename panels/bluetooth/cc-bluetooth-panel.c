@@ -248,3 +248,14 @@ cc_bluetooth_panel_init (CcBluetoothPanel *self)
     g_signal_connect_object (self->rfkill, "g-properties-changed", G_CALLBACK (airplane_mode_changed), self,
                              G_CONNECT_SWAPPED);
 }
+
+void
+cc_bluetooth_panel_static_init_func (void)
+{
+    cc_object_storage_declare_dbus_proxy (G_BUS_TYPE_SESSION, G_DBUS_PROXY_FLAGS_NONE,
+                                          "org.gnome.SettingsDaemon.Rfkill", "/org/gnome/SettingsDaemon/Rfkill",
+                                          "org.gnome.SettingsDaemon.Rfkill");
+    cc_object_storage_declare_dbus_proxy (G_BUS_TYPE_SESSION, G_DBUS_PROXY_FLAGS_NONE,
+                                          "org.gnome.SettingsDaemon.Rfkill", "/org/gnome/SettingsDaemon/Rfkill",
+                                          "org.freedesktop.DBus.Properties");
+}
@@ -28,4 +28,6 @@ G_BEGIN_DECLS
 
 #define CC_TYPE_BLUETOOTH_PANEL (cc_bluetooth_panel_get_type ())
 G_DECLARE_FINAL_TYPE (CcBluetoothPanel, cc_bluetooth_panel, CC, BLUETOOTH_PANEL, CcPanel);
+
+void cc_bluetooth_panel_static_init_func (void);
 G_END_DECLS
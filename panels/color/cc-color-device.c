@@ -152,18 +152,24 @@ cc_color_device_set_expanded (CcColorDevice *self, gboolean expanded)
     cc_color_device_refresh (self);
 }
 
+static void
+cc_color_device_set_enabled_cb (GObject *object, GAsyncResult *res, gpointer user_data)
+{
+    gboolean enable = GPOINTER_TO_INT (user_data);
+    g_autoptr(GError) error = NULL;
+
+    if (!cd_device_set_enabled_finish (CD_DEVICE (object), res, &error))
+        g_warning ("failed to %s to the device: %s", enable ? "enable" : "disable", error->message);
+}
+
 static void
 cc_color_device_notify_enable_device_cb (CcColorDevice *self)
 {
     gboolean enable;
-    gboolean ret;
-    g_autoptr(GError) error = NULL;
 
     enable = gtk_switch_get_active (GTK_SWITCH (self->widget_switch));
     g_debug ("Set %s to %i", cd_device_get_id (self->device), enable);
-    ret = cd_device_set_enabled_sync (self->device, enable, NULL, &error);
-    if (!ret)
-        g_warning ("failed to %s to the device: %s", enable ? "enable" : "disable", error->message);
+    cd_device_set_enabled (self->device, enable, NULL, cc_color_device_set_enabled_cb, GINT_TO_POINTER (enable));
 
     /* if expanded, close */
     cc_color_device_set_expanded (self, FALSE);
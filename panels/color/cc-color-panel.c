@@ -37,8 +37,12 @@ struct _CcColorPanel {
 
     CdClient *client;
     CdDevice *current_device;
-    GPtrArray *devices;
+    GHashTable *devices;
+    guint n_pending_devices;
+    GHashTable *profiles;
+    GHashTable *assigned_profiles;
     GPtrArray *sensors;
+    GCancellable *sensors_cancellable;
     GDBusProxy *proxy;
     GSettings *settings;
     GSettings *settings_colord;
@@ -116,8 +120,38 @@ enum {
 /* max number of devices and profiles to cause auto-expand at startup */
 #define GCM_PREFS_MAX_DEVICES_PROFILES_EXPANDED 5
 
+/* a profile on its way to a device, carried across the colord calls */
+typedef struct {
+    CcColorPanel *self;
+    CdDevice *device;
+    CdProfile *profile;
+} GcmPrefsDeviceProfile;
+
+static GcmPrefsDeviceProfile *
+gcm_prefs_device_profile_new (CcColorPanel *self, CdDevice *device, CdProfile *profile)
+{
+    GcmPrefsDeviceProfile *data = g_new0 (GcmPrefsDeviceProfile, 1);
+
+    data->self = self;
+    data->device = g_object_ref (device);
+    data->profile = g_object_ref (profile);
+
+    return data;
+}
+
+static void
+gcm_prefs_device_profile_free (GcmPrefsDeviceProfile *data)
+{
+    g_object_unref (data->device);
+    g_object_unref (data->profile);
+    g_free (data);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (GcmPrefsDeviceProfile, gcm_prefs_device_profile_free)
+
 static void gcm_prefs_profile_add_cb (CcColorPanel *self);
 static void gcm_prefs_refresh_toolbar_buttons (CcColorPanel *self);
+static void gcm_prefs_cache_profile (CcColorPanel *self, CdProfile *profile);
 
 static const char *
 get_profile_prefix_and_kind (CdProfile *profile, guint *kind_out)
@@ -190,42 +224,71 @@ get_warning_icon (GtkListItem *list_item, CdProfile *profile)
     return NULL;
 }
 
-static gboolean
-gcm_prefs_ensure_connected_profile (CcColorPanel *self, CdProfile *profile)
+static void
+gcm_prefs_install_system_wide_cb (GObject *object, GAsyncResult *res, gpointer user_data)
 {
-    gboolean ret;
     g_autoptr(GError) error = NULL;
 
-    if (cd_profile_get_connected (profile))
-        return TRUE;
+    if (!cd_profile_install_system_wide_finish (CD_PROFILE (object), res, &error) &&
+        !g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        g_warning ("failed to set profile system-wide: %s", error->message);
+}
 
-    ret = cd_profile_connect_sync (profile, cc_panel_get_cancellable (CC_PANEL (self)), &error);
-    if (!ret)
-        g_warning ("failed to get profile: %s", error->message);
+static void
+gcm_prefs_default_connect_cb (GObject *object, GAsyncResult *res, gpointer user_data)
+{
+    CdProfile *profile = CD_PROFILE (object);
+    CcColorPanel *self;
+    g_autoptr(GError) error = NULL;
 
-    return ret;
+    if (!cd_profile_connect_finish (profile, res, &error)) {
+        if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            g_warning ("failed to get profile: %s", error->message);
+        return;
+    }
+
+    self = CC_COLOR_PANEL (user_data);
+
+    /* install somewhere out of $HOME */
+    cd_profile_install_system_wide (profile, cc_panel_get_cancellable (CC_PANEL (self)),
+                                    gcm_prefs_install_system_wide_cb, self);
 }
 
 static void
 gcm_prefs_default_cb (CcColorPanel *self)
 {
     g_autoptr(CdProfile) profile = NULL;
-    gboolean ret;
-    g_autoptr(GError) error = NULL;
 
     /* TODO: check if the profile is already systemwide */
     profile = cd_device_get_default_profile (self->current_device);
     if (profile == NULL)
         return;
 
-    if (!gcm_prefs_ensure_connected_profile (self, profile))
+    cd_profile_connect (profile, cc_panel_get_cancellable (CC_PANEL (self)), gcm_prefs_default_connect_cb, self);
+}
+
+#if CD_CHECK_VERSION(0, 1, 12)
+static void
+gcm_prefs_import_profile_cb (GObject *object, GAsyncResult *res, gpointer user_data)
+{
+    CcColorPanel *self;
+    g_autoptr(GError) error = NULL;
+    g_autoptr(CdProfile) profile = NULL;
+
+    profile = cd_client_import_profile_finish (CD_CLIENT (object), res, &error);
+    if (profile == NULL) {
+        if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            g_warning ("failed to get imported profile: %s", error->message);
         return;
+    }
 
-    /* install somewhere out of $HOME */
-    ret = cd_profile_install_system_wide_sync (profile, cc_panel_get_cancellable (CC_PANEL (self)), &error);
-    if (!ret)
-        g_warning ("failed to set profile system-wide: %s", error->message);
+    self = CC_COLOR_PANEL (user_data);
+
+    /* the assign list picks it up once it is connected */
+    gcm_prefs_cache_profile (self, profile);
+    gcm_prefs_profile_add_cb (self);
 }
+#endif
 
 static void
 icc_prefs_imported_cb (GObject *source, GAsyncResult *res, gpointer user_data)
@@ -234,7 +297,6 @@ icc_prefs_imported_cb (GObject *source, GAsyncResult *res, gpointer user_data)
     GtkFileDialog *dialog = GTK_FILE_DIALOG (source);
     g_autoptr(GFile) file = NULL;
     g_autoptr(GError) error = NULL;
-    g_autoptr(CdProfile) profile = NULL;
 
     file = gtk_file_dialog_open_finish (dialog, res, &error);
     if (file == NULL) {
@@ -244,15 +306,12 @@ icc_prefs_imported_cb (GObject *source, GAsyncResult *res, gpointer user_data)
     }
 
 #if CD_CHECK_VERSION(0, 1, 12)
-    profile = cd_client_import_profile_sync (self->client, file, cc_panel_get_cancellable (CC_PANEL (self)), &error);
-    if (profile == NULL) {
-        g_warning ("failed to get imported profile: %s", error->message);
-        return;
-    }
-#endif
-
+    cd_client_import_profile (self->client, file, cc_panel_get_cancellable (CC_PANEL (self)),
+                              gcm_prefs_import_profile_cb, self);
+#else
     /* add to list view */
     gcm_prefs_profile_add_cb (self);
+#endif
 }
 
 static void
@@ -620,81 +679,162 @@ gcm_prefs_combo_sort_func_cb (gconstpointer a, gconstpointer b, gpointer user_da
 }
 
 static gboolean
-gcm_prefs_ensure_connected_profiles (CcColorPanel *self, GPtrArray *profiles)
+gcm_prefs_is_profile_assignable (CcColorPanel *self, CdProfile *profile)
 {
-    guint i;
+    if (self->current_device == NULL)
+        return FALSE;
 
-    for (i = 0; i < profiles->len; i++) {
-        CdProfile *profile = g_ptr_array_index (profiles, i);
+    /* don't add any of the already added profiles */
+    if (g_hash_table_contains (self->assigned_profiles, cd_profile_get_object_path (profile)))
+        return FALSE;
 
-        if (!gcm_prefs_ensure_connected_profile (self, profile))
-            return FALSE;
-    }
+    /* only add correct types */
+    if (!gcm_prefs_is_profile_suitable_for_device (profile, self->current_device))
+        return FALSE;
+
+#if CD_CHECK_VERSION(0, 1, 13)
+    /* ignore profiles from other user accounts */
+    if (!cd_profile_has_access (profile))
+        return FALSE;
+#endif
 
     return TRUE;
 }
 
-static gboolean
-gcm_prefs_profile_exists_in_array (GPtrArray *array, CdProfile *profile)
+static void
+gcm_prefs_update_assign_list (CcColorPanel *self, CdProfile *profile, gboolean present)
 {
-    CdProfile *profile_tmp;
-    guint i;
+    gboolean assignable;
+    gboolean listed;
+    guint position;
 
-    for (i = 0; i < array->len; i++) {
-        profile_tmp = g_ptr_array_index (array, i);
-        if (cd_profile_equal (profile, profile_tmp))
-            return TRUE;
-    }
-    return FALSE;
+    listed = g_list_store_find (self->liststore_assign, profile, &position);
+    assignable = present && gcm_prefs_is_profile_assignable (self, profile);
+
+    if (listed && !assignable)
+        g_list_store_remove (self->liststore_assign, position);
+    else if (!listed && assignable)
+        g_list_store_append (self->liststore_assign, profile);
+}
+
+static CdProfile *
+gcm_prefs_cache_insert_profile (CcColorPanel *self, CdProfile *profile)
+{
+    const gchar *object_path = cd_profile_get_object_path (profile);
+    CdProfile *cached;
+
+    /* another connect for the same profile may have won the race */
+    cached = g_hash_table_lookup (self->profiles, object_path);
+    if (cached != NULL)
+        return cached;
+
+    g_hash_table_insert (self->profiles, g_strdup (object_path), g_object_ref (profile));
+    gcm_prefs_update_assign_list (self, profile, TRUE);
+
+    return profile;
 }
 
 static void
-gcm_prefs_add_profiles_suitable_for_devices (CcColorPanel *self, GPtrArray *profiles)
+gcm_prefs_cache_profile_connect_cb (GObject *object, GAsyncResult *res, gpointer user_data)
 {
-    CdProfile *profile_tmp;
-    gboolean ret;
+    CdProfile *profile = CD_PROFILE (object);
     g_autoptr(GError) error = NULL;
-    g_autoptr(GPtrArray) profile_array = NULL;
-    guint i;
 
-    g_list_store_remove_all (self->liststore_assign);
+    if (!cd_profile_connect_finish (profile, res, &error)) {
+        if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            g_warning ("failed to get profile: %s", error->message);
+        return;
+    }
 
-    gtk_widget_set_visible (self->label_assign_warning, FALSE);
+    gcm_prefs_cache_insert_profile (CC_COLOR_PANEL (user_data), profile);
+}
+
+static void
+gcm_prefs_cache_profile (CcColorPanel *self, CdProfile *profile)
+{
+    if (g_hash_table_contains (self->profiles, cd_profile_get_object_path (profile)))
+        return;
+
+    cd_profile_connect (profile, cc_panel_get_cancellable (CC_PANEL (self)), gcm_prefs_cache_profile_connect_cb, self);
+}
+
+static void
+gcm_prefs_get_profiles_cb (GObject *object, GAsyncResult *res, gpointer user_data)
+{
+    CcColorPanel *self;
+    g_autoptr(GError) error = NULL;
+    g_autoptr(GPtrArray) profiles = NULL;
 
-    /* get profiles */
-    profile_array = cd_client_get_profiles_sync (self->client, cc_panel_get_cancellable (CC_PANEL (self)), &error);
-    if (profile_array == NULL) {
-        g_warning ("failed to get profiles: %s", error->message);
+    profiles = cd_client_get_profiles_finish (CD_CLIENT (object), res, &error);
+    if (profiles == NULL) {
+        if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            g_warning ("failed to get profiles: %s", error->message);
         return;
     }
 
-    if (!gcm_prefs_ensure_connected_profiles (self, profile_array))
+    self = CC_COLOR_PANEL (user_data);
+
+    /* all the connects are in flight at the same time */
+    for (guint i = 0; i < profiles->len; i++)
+        gcm_prefs_cache_profile (self, g_ptr_array_index (profiles, i));
+}
+
+static void
+gcm_prefs_client_profile_added_cb (CdClient *client, CdProfile *profile, CcColorPanel *self)
+{
+    gcm_prefs_cache_profile (self, profile);
+}
+
+static void
+gcm_prefs_client_profile_removed_cb (CdClient *client, CdProfile *profile, CcColorPanel *self)
+{
+    g_autoptr(CdProfile) cached = NULL;
+
+    if (!g_hash_table_steal_extended (self->profiles, cd_profile_get_object_path (profile), NULL,
+                                      (gpointer *) &cached))
         return;
 
-    /* add profiles of the right kind */
-    for (i = 0; i < profile_array->len; i++) {
-        profile_tmp = g_ptr_array_index (profile_array, i);
+    gcm_prefs_update_assign_list (self, cached, FALSE);
+}
 
-        /* don't add any of the already added profiles */
-        if (profiles != NULL) {
-            if (gcm_prefs_profile_exists_in_array (profiles, profile_tmp))
-                continue;
-        }
+static void
+gcm_prefs_client_profile_changed_cb (CdClient *client, CdProfile *profile, CcColorPanel *self)
+{
+    CdProfile *cached;
 
-        /* only add correct types */
-        ret = gcm_prefs_is_profile_suitable_for_device (profile_tmp, self->current_device);
-        if (!ret)
-            continue;
+    /* the cached proxy has already picked up the new properties */
+    cached = g_hash_table_lookup (self->profiles, cd_profile_get_object_path (profile));
+    if (cached != NULL)
+        gcm_prefs_update_assign_list (self, cached, TRUE);
+}
 
-#if CD_CHECK_VERSION(0, 1, 13)
-        /* ignore profiles from other user accounts */
-        if (!cd_profile_has_access (profile_tmp))
-            continue;
-#endif
+static void
+gcm_prefs_add_profiles_suitable_for_devices (CcColorPanel *self, GPtrArray *profiles)
+{
+    g_autoptr(GPtrArray) suitable = NULL;
+    GHashTableIter iter;
+    CdProfile *profile_tmp;
+    guint i;
+
+    g_list_store_remove_all (self->liststore_assign);
 
-        /* add */
-        g_list_store_append (self->liststore_assign, profile_tmp);
+    gtk_widget_set_visible (self->label_assign_warning, FALSE);
+
+    /* index the profiles the device already has */
+    g_hash_table_remove_all (self->assigned_profiles);
+    for (i = 0; profiles != NULL && i < profiles->len; i++) {
+        profile_tmp = g_ptr_array_index (profiles, i);
+        g_hash_table_add (self->assigned_profiles, g_strdup (cd_profile_get_object_path (profile_tmp)));
     }
+
+    /* add profiles of the right kind, any still connecting are added when ready */
+    suitable = g_ptr_array_new ();
+    g_hash_table_iter_init (&iter, self->profiles);
+    while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &profile_tmp)) {
+        if (gcm_prefs_is_profile_assignable (self, profile_tmp))
+            g_ptr_array_add (suitable, profile_tmp);
+    }
+    g_list_store_splice (self->liststore_assign, 0, 0, suitable->pdata, suitable->len);
 }
 
 static void
@@ -721,21 +861,22 @@ profile_exported_cb (GObject *source_object, GAsyncResult *res, gpointer user_da
 }
 
 static void
-gcm_prefs_calib_export_cb (CcColorPanel *self)
+gcm_prefs_calib_export_connect_cb (GObject *object, GAsyncResult *res, gpointer user_data)
 {
-    CdProfile *profile;
-    gboolean ret;
+    CdProfile *profile = CD_PROFILE (object);
+    CcColorPanel *self;
     g_autofree gchar *default_name = NULL;
     g_autoptr(GError) error = NULL;
     g_autoptr(GtkFileDialog) dialog = NULL;
 
-    profile = cc_color_calibrate_get_profile (self->calibrate);
-    ret = cd_profile_connect_sync (profile, NULL, &error);
-    if (!ret) {
-        g_warning ("Failed to get imported profile: %s", error->message);
+    if (!cd_profile_connect_finish (profile, res, &error)) {
+        if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            g_warning ("Failed to get imported profile: %s", error->message);
         return;
     }
 
+    self = CC_COLOR_PANEL (user_data);
+
     dialog = gtk_file_dialog_new ();
     /* TRANSLATORS: this is the dialog to save the ICC profile */
     gtk_file_dialog_set_title (dialog, _("Save Profile"));
@@ -748,6 +889,15 @@ gcm_prefs_calib_export_cb (CcColorPanel *self)
                           profile);
 }
 
+static void
+gcm_prefs_calib_export_cb (CcColorPanel *self)
+{
+    CdProfile *profile;
+
+    profile = cc_color_calibrate_get_profile (self->calibrate);
+    cd_profile_connect (profile, cc_panel_get_cancellable (CC_PANEL (self)), gcm_prefs_calib_export_connect_cb, self);
+}
+
 static void
 gcm_prefs_calib_export_link_cb (CcColorPanel *self, const gchar *url)
 {
@@ -764,19 +914,26 @@ gcm_prefs_profile_add_cb (CcColorPanel *self)
 
     /* add profiles of the right kind */
     profiles = cd_device_get_profiles (self->current_device);
-    gcm_prefs_ensure_connected_profiles (self, profiles);
     gcm_prefs_add_profiles_suitable_for_devices (self, profiles);
 
     /* show the dialog */
     adw_dialog_present (ADW_DIALOG (self->dialog_assign), GTK_WIDGET (self));
 }
 
+static void
+gcm_prefs_remove_profile_cb (GObject *object, GAsyncResult *res, gpointer user_data)
+{
+    g_autoptr(GError) error = NULL;
+
+    if (!cd_device_remove_profile_finish (CD_DEVICE (object), res, &error) &&
+        !g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        g_warning ("failed to remove profile: %s", error->message);
+}
+
 static void
 gcm_prefs_profile_remove_cb (CcColorPanel *self)
 {
     CdProfile *profile;
-    gboolean ret = FALSE;
-    g_autoptr(GError) error = NULL;
     GtkListBoxRow *row;
 
     /* get the selected profile */
@@ -790,10 +947,8 @@ gcm_prefs_profile_remove_cb (CcColorPanel *self)
     }
 
     /* just remove it, the list store will get ::changed */
-    ret = cd_device_remove_profile_sync (self->current_device, profile, cc_panel_get_cancellable (CC_PANEL (self)),
-                                         &error);
-    if (!ret)
-        g_warning ("failed to remove profile: %s", error->message);
+    cd_device_remove_profile (self->current_device, profile, cc_panel_get_cancellable (CC_PANEL (self)),
+                              gcm_prefs_remove_profile_cb, self);
 }
 
 static void
@@ -895,13 +1050,52 @@ gcm_prefs_profile_view_cb (CcColorPanel *self)
     gcm_prefs_profile_view (self, profile);
 }
 
+static void
+gcm_prefs_assign_add_profile_cb (GObject *object, GAsyncResult *res, gpointer user_data)
+{
+    g_autoptr(GcmPrefsDeviceProfile) data = user_data;
+    g_autoptr(GError) error = NULL;
+
+    if (!cd_device_add_profile_finish (data->device, res, &error)) {
+        if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            g_warning ("failed to add: %s", error->message);
+        return;
+    }
+
+    /* make it default */
+    cd_device_make_profile_default (data->device, data->profile, cc_panel_get_cancellable (CC_PANEL (data->self)),
+                                    (GAsyncReadyCallback) gcm_prefs_make_profile_default_cb, data->self);
+}
+
+static void
+gcm_prefs_assign_profile (GcmPrefsDeviceProfile *data)
+{
+    /* just add it, the list store will get ::changed */
+    cd_device_add_profile (data->device, CD_DEVICE_RELATION_HARD, data->profile,
+                           cc_panel_get_cancellable (CC_PANEL (data->self)), gcm_prefs_assign_add_profile_cb, data);
+}
+
+static void
+gcm_prefs_assign_set_enabled_cb (GObject *object, GAsyncResult *res, gpointer user_data)
+{
+    g_autoptr(GcmPrefsDeviceProfile) data = user_data;
+    g_autoptr(GError) error = NULL;
+
+    if (!cd_device_set_enabled_finish (data->device, res, &error)) {
+        if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            g_warning ("failed to enabled device: %s", error->message);
+        return;
+    }
+
+    gcm_prefs_assign_profile (g_steal_pointer (&data));
+}
+
 static void
 gcm_prefs_button_assign_ok_cb (CcColorPanel *self)
 {
     GtkSelectionModel *model;
     CdProfile *profile;
-    gboolean ret = FALSE;
-    g_autoptr(GError) error = NULL;
+    GcmPrefsDeviceProfile *data;
 
     /* hide window */
     adw_dialog_close (ADW_DIALOG (self->dialog_assign));
@@ -915,28 +1109,17 @@ gcm_prefs_button_assign_ok_cb (CcColorPanel *self)
         return;
     }
 
+    data = gcm_prefs_device_profile_new (self, self->current_device, profile);
+
     /* if the device is disabled, enable the device so that we can
      * add color profiles to it */
     if (!cd_device_get_enabled (self->current_device)) {
-        ret =
-            cd_device_set_enabled_sync (self->current_device, TRUE, cc_panel_get_cancellable (CC_PANEL (self)), &error);
-        if (!ret) {
-            g_warning ("failed to enabled device: %s", error->message);
-            return;
-        }
-    }
-
-    /* just add it, the list store will get ::changed */
-    ret = cd_device_add_profile_sync (self->current_device, CD_DEVICE_RELATION_HARD, profile,
-                                      cc_panel_get_cancellable (CC_PANEL (self)), &error);
-    if (!ret) {
-        g_warning ("failed to add: %s", error->message);
+        cd_device_set_enabled (self->current_device, TRUE, cc_panel_get_cancellable (CC_PANEL (self)),
+                               gcm_prefs_assign_set_enabled_cb, data);
         return;
     }
 
-    /* make it default */
-    cd_device_make_profile_default (self->current_device, profile, cc_panel_get_cancellable (CC_PANEL (self)),
-                                    (GAsyncReadyCallback) gcm_prefs_make_profile_default_cb, self);
+    gcm_prefs_assign_profile (data);
 }
 
 static void
@@ -1042,93 +1225,70 @@ gcm_prefs_button_assign_import_cb (CcColorPanel *self)
 }
 
 static void
-gcm_prefs_sensor_coldplug (CcColorPanel *self)
+gcm_prefs_sensor_connect_cb (GObject *object, GAsyncResult *res, gpointer user_data)
 {
-    CdSensor *sensor_tmp;
-    gboolean ret;
+    CdSensor *sensor = CD_SENSOR (object);
+    CcColorPanel *self;
     g_autoptr(GError) error = NULL;
-    g_autoptr(GPtrArray) sensors = NULL;
-    guint i;
 
-    /* unref old */
-    g_clear_pointer (&self->sensors, g_ptr_array_unref);
-
-    /* no present */
-    sensors = cd_client_get_sensors_sync (self->client, NULL, &error);
-    if (sensors == NULL) {
-        g_warning ("%s", error->message);
+    /* cancelled when the sensor list is refreshed again */
+    if (!cd_sensor_connect_finish (sensor, res, &error)) {
+        if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            g_warning ("%s", error->message);
         return;
     }
-    if (sensors->len == 0)
-        return;
-
-    /* save a copy of the sensor list */
-    self->sensors = g_ptr_array_ref (sensors);
 
-    /* connect to each sensor */
-    for (i = 0; i < sensors->len; i++) {
-        sensor_tmp = g_ptr_array_index (sensors, i);
-        ret = cd_sensor_connect_sync (sensor_tmp, NULL, &error);
-        if (!ret) {
-            g_warning ("%s", error->message);
-            return;
-        }
-    }
-}
+    self = CC_COLOR_PANEL (user_data);
 
-static void
-gcm_prefs_client_sensor_changed_cb (CdClient *client, CdSensor *sensor, CcColorPanel *self)
-{
-    gcm_prefs_sensor_coldplug (self);
+    /* only connected sensors can be used for calibration */
+    if (self->sensors == NULL)
+        self->sensors = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+    g_ptr_array_add (self->sensors, g_object_ref (sensor));
     gcm_prefs_set_calibrate_button_sensitivity (self);
 }
 
 static void
-gcm_prefs_add_device_profile (CcColorPanel *self, CdDevice *device, CdProfile *profile, gboolean is_default)
+gcm_prefs_get_sensors_cb (GObject *object, GAsyncResult *res, gpointer user_data)
 {
-    gboolean ret;
+    CcColorPanel *self;
     g_autoptr(GError) error = NULL;
-    GtkWidget *widget;
+    g_autoptr(GPtrArray) sensors = NULL;
+    guint i;
 
-    /* get properties */
-    ret = cd_profile_connect_sync (profile, cc_panel_get_cancellable (CC_PANEL (self)), &error);
-    if (!ret) {
-        g_warning ("failed to get profile: %s", error->message);
+    sensors = cd_client_get_sensors_finish (CD_CLIENT (object), res, &error);
+    if (sensors == NULL) {
+        if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            g_warning ("%s", error->message);
         return;
     }
 
-    /* ignore profiles from other user accounts */
-    if (!cd_profile_has_access (profile)) {
-        /* only print the filename if it exists */
-        if (cd_profile_get_filename (profile) != NULL) {
-            g_warning ("%s is not usable by this user", cd_profile_get_filename (profile));
-        } else {
-            g_warning ("%s is not usable by this user", cd_profile_get_id (profile));
-        }
-        return;
-    }
+    self = CC_COLOR_PANEL (user_data);
 
-    /* add to listbox */
-    widget = cc_color_profile_new (device, profile, is_default);
-    gtk_list_box_append (self->list_box, widget);
-    gtk_size_group_add_widget (self->list_box_size, widget);
+    /* connect to each sensor */
+    for (i = 0; i < sensors->len; i++)
+        cd_sensor_connect (g_ptr_array_index (sensors, i), self->sensors_cancellable, gcm_prefs_sensor_connect_cb,
+                           self);
 }
 
 static void
-gcm_prefs_add_device_profiles (CcColorPanel *self, CdDevice *device)
+gcm_prefs_sensor_coldplug (CcColorPanel *self)
 {
-    CdProfile *profile_tmp;
-    g_autoptr(GPtrArray) profiles = NULL;
-    guint i;
+    /* drop any lookup still in progress */
+    g_cancellable_cancel (self->sensors_cancellable);
+    g_clear_object (&self->sensors_cancellable);
+    self->sensors_cancellable = g_cancellable_new ();
 
-    /* add profiles */
-    profiles = cd_device_get_profiles (device);
-    if (profiles == NULL)
-        return;
-    for (i = 0; i < profiles->len; i++) {
-        profile_tmp = g_ptr_array_index (profiles, i);
-        gcm_prefs_add_device_profile (self, device, profile_tmp, i == 0);
-    }
+    /* unref old */
+    g_clear_pointer (&self->sensors, g_ptr_array_unref);
+
+    cd_client_get_sensors (self->client, self->sensors_cancellable, gcm_prefs_get_sensors_cb, self);
+}
+
+static void
+gcm_prefs_client_sensor_changed_cb (CdClient *client, CdSensor *sensor, CcColorPanel *self)
+{
+    gcm_prefs_sensor_coldplug (self);
+    gcm_prefs_set_calibrate_button_sensitivity (self);
 }
 
 /* find the profile in the array -- for flicker-free changes */
@@ -1148,24 +1308,26 @@ gcm_prefs_find_profile_by_object_path (GPtrArray *profiles, const gchar *object_
 
 /* find the profile in the list view -- for flicker-free changes */
 static gboolean
-gcm_prefs_find_widget_by_object_path (GList *list, const gchar *object_path_device, const gchar *object_path_profile)
+gcm_prefs_find_widget_by_object_path (CcColorPanel *self, const gchar *object_path_device,
+                                      const gchar *object_path_profile)
 {
-    GList *l;
+    GtkWidget *child;
     CdDevice *device_tmp;
     CdProfile *profile_tmp;
 
-    for (l = list; l != NULL; l = l->next) {
-        if (!CC_IS_COLOR_PROFILE (l->data))
+    for (child = gtk_widget_get_first_child (GTK_WIDGET (self->list_box)); child != NULL;
+         child = gtk_widget_get_next_sibling (child)) {
+        if (!CC_IS_COLOR_PROFILE (child))
             continue;
 
         /* correct device ? */
-        device_tmp = cc_color_profile_get_device (CC_COLOR_PROFILE (l->data));
+        device_tmp = cc_color_profile_get_device (CC_COLOR_PROFILE (child));
         if (g_strcmp0 (object_path_device, cd_device_get_object_path (device_tmp)) != 0) {
             continue;
         }
 
         /* this profile */
-        profile_tmp = cc_color_profile_get_profile (CC_COLOR_PROFILE (l->data));
+        profile_tmp = cc_color_profile_get_profile (CC_COLOR_PROFILE (child));
         if (g_strcmp0 (object_path_profile, cd_profile_get_object_path (profile_tmp)) == 0) {
             return TRUE;
         }
@@ -1173,6 +1335,98 @@ gcm_prefs_find_widget_by_object_path (GList *list, const gchar *object_path_devi
     return FALSE;
 }
 
+static void
+gcm_prefs_add_device_profile_row (CcColorPanel *self, CdDevice *device, CdProfile *profile)
+{
+    g_autoptr(GPtrArray) profiles = NULL;
+    g_autoptr(CdProfile) default_profile = NULL;
+    gboolean is_default;
+    GtkWidget *widget;
+
+    /* the device went away while the profile was connecting */
+    if (g_hash_table_lookup (self->devices, cd_device_get_object_path (device)) != device)
+        return;
+
+    /* the profile was removed from the device, or is already shown */
+    profiles = cd_device_get_profiles (device);
+    if (profiles == NULL || !gcm_prefs_find_profile_by_object_path (profiles, cd_profile_get_object_path (profile)))
+        return;
+    if (gcm_prefs_find_widget_by_object_path (self, cd_device_get_object_path (device),
+                                              cd_profile_get_object_path (profile)))
+        return;
+
+    /* ignore profiles from other user accounts */
+    if (!cd_profile_has_access (profile)) {
+        /* only print the filename if it exists */
+        if (cd_profile_get_filename (profile) != NULL) {
+            g_warning ("%s is not usable by this user", cd_profile_get_filename (profile));
+        } else {
+            g_warning ("%s is not usable by this user", cd_profile_get_id (profile));
+        }
+        return;
+    }
+
+    default_profile = cd_device_get_default_profile (device);
+    is_default = default_profile != NULL &&
+        g_strcmp0 (cd_profile_get_object_path (default_profile), cd_profile_get_object_path (profile)) == 0;
+
+    /* add to listbox */
+    widget = cc_color_profile_new (device, profile, is_default);
+    gtk_list_box_append (self->list_box, widget);
+    gtk_size_group_add_widget (self->list_box_size, widget);
+}
+
+static void
+gcm_prefs_device_profile_connect_cb (GObject *object, GAsyncResult *res, gpointer user_data)
+{
+    g_autoptr(GcmPrefsDeviceProfile) data = user_data;
+    g_autoptr(GError) error = NULL;
+    CdProfile *profile;
+
+    /* get properties */
+    if (!cd_profile_connect_finish (data->profile, res, &error)) {
+        if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            g_warning ("failed to get profile: %s", error->message);
+        return;
+    }
+
+    profile = gcm_prefs_cache_insert_profile (data->self, data->profile);
+    gcm_prefs_add_device_profile_row (data->self, data->device, profile);
+}
+
+static void
+gcm_prefs_add_device_profile (CcColorPanel *self, CdDevice *device, CdProfile *profile)
+{
+    CdProfile *cached;
+
+    /* profiles shared between devices only need to be connected once */
+    cached = g_hash_table_lookup (self->profiles, cd_profile_get_object_path (profile));
+    if (cached != NULL) {
+        gcm_prefs_add_device_profile_row (self, device, cached);
+        return;
+    }
+
+    cd_profile_connect (profile, cc_panel_get_cancellable (CC_PANEL (self)), gcm_prefs_device_profile_connect_cb,
+                        gcm_prefs_device_profile_new (self, device, profile));
+}
+
+static void
+gcm_prefs_add_device_profiles (CcColorPanel *self, CdDevice *device)
+{
+    CdProfile *profile_tmp;
+    g_autoptr(GPtrArray) profiles = NULL;
+    guint i;
+
+    /* add profiles, each row shows up as soon as its profile is connected */
+    profiles = cd_device_get_profiles (device);
+    if (profiles == NULL)
+        return;
+    for (i = 0; i < profiles->len; i++) {
+        profile_tmp = g_ptr_array_index (profiles, i);
+        gcm_prefs_add_device_profile (self, device, profile_tmp);
+    }
+}
+
 static void
 gcm_prefs_device_changed_cb (CcColorPanel *self, CdDevice *device)
 {
@@ -1180,8 +1434,7 @@ gcm_prefs_device_changed_cb (CcColorPanel *self, CdDevice *device)
     CdDevice *device_tmp;
     CdProfile *profile_tmp;
     gboolean ret;
-    g_autoptr(GList) list = NULL;
-    GPtrArray *profiles;
+    g_autoptr(GPtrArray) profiles = NULL;
     guint i;
 
     /* remove anything in the list view that's not in Device.Profiles */
@@ -1190,25 +1443,19 @@ gcm_prefs_device_changed_cb (CcColorPanel *self, CdDevice *device)
     while (child) {
         GtkWidget *next = gtk_widget_get_next_sibling (child);
 
-        if (!CC_IS_COLOR_PROFILE (child)) {
-            list = g_list_prepend (list, child);
+        if (!CC_IS_COLOR_PROFILE (child))
             goto next;
-        }
 
         /* correct device ? */
         device_tmp = cc_color_profile_get_device (CC_COLOR_PROFILE (child));
-        if (g_strcmp0 (cd_device_get_id (device), cd_device_get_id (device_tmp)) != 0) {
-            list = g_list_prepend (list, child);
+        if (g_strcmp0 (cd_device_get_id (device), cd_device_get_id (device_tmp)) != 0)
             goto next;
-        }
 
         /* if profile is not in Device.Profiles then remove */
         profile_tmp = cc_color_profile_get_profile (CC_COLOR_PROFILE (child));
         ret = gcm_prefs_find_profile_by_object_path (profiles, cd_profile_get_object_path (profile_tmp));
         if (!ret)
             gtk_list_box_remove (self->list_box, child);
-        else
-            list = g_list_prepend (list, child);
 
     next:
         child = next;
@@ -1217,10 +1464,10 @@ gcm_prefs_device_changed_cb (CcColorPanel *self, CdDevice *device)
     /* add anything in Device.Profiles that's not in the list view */
     for (i = 0; i < profiles->len; i++) {
         profile_tmp = g_ptr_array_index (profiles, i);
-        ret = gcm_prefs_find_widget_by_object_path (list, cd_device_get_object_path (device),
+        ret = gcm_prefs_find_widget_by_object_path (self, cd_device_get_object_path (device),
                                                     cd_profile_get_object_path (profile_tmp));
         if (!ret)
-            gcm_prefs_add_device_profile (self, device, profile_tmp, i == 0);
+            gcm_prefs_add_device_profile (self, device, profile_tmp);
     }
 
     /* resort */
@@ -1261,19 +1508,61 @@ gcm_prefs_device_expanded_changed_cb (CcColorPanel *self, gboolean is_expanded,
 }
 
 static void
-gcm_prefs_add_device (CcColorPanel *self, CdDevice *device)
+gcm_prefs_update_device_list_extra_entry (CcColorPanel *self)
 {
-    gboolean ret;
+    GtkWidget *child;
+    GtkWidget *device_row = NULL;
+    guint n_devices = 0;
+
+    /* wait for the devices still connecting */
+    if (self->n_pending_devices > 0)
+        return;
+
+    /* any devices to show? */
+    for (child = gtk_widget_get_first_child (GTK_WIDGET (self->list_box)); child != NULL;
+         child = gtk_widget_get_next_sibling (child)) {
+        if (!CC_IS_COLOR_DEVICE (child))
+            continue;
+        device_row = child;
+        n_devices++;
+    }
+
+    if (n_devices == 0)
+        adw_view_stack_set_visible_child_name (self->stack, "no-devices-page");
+    else
+        adw_view_stack_set_visible_child_name (self->stack, "color-page");
+
+    /* if we have only one device expand it by default */
+    if (n_devices == 1)
+        cc_color_device_set_expanded (CC_COLOR_DEVICE (device_row), TRUE);
+}
+
+static void
+gcm_prefs_device_connect_cb (GObject *object, GAsyncResult *res, gpointer user_data)
+{
+    CdDevice *device = CD_DEVICE (object);
+    CcColorPanel *self;
     g_autoptr(GError) error = NULL;
     GtkWidget *widget;
+    gboolean ret;
 
     /* get device properties */
-    ret = cd_device_connect_sync (device, cc_panel_get_cancellable (CC_PANEL (self)), &error);
+    ret = cd_device_connect_finish (device, res, &error);
+    if (!ret && g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        return;
+
+    self = CC_COLOR_PANEL (user_data);
+    self->n_pending_devices--;
+
     if (!ret) {
         g_warning ("failed to connect to the device: %s", error->message);
-        return;
+        goto out;
     }
 
+    /* removed or replaced while connecting */
+    if (g_hash_table_lookup (self->devices, cd_device_get_object_path (device)) != device)
+        goto out;
+
     /* add device */
     widget = cc_color_device_new (device);
     g_signal_connect_object (widget, "expanded-changed", G_CALLBACK (gcm_prefs_device_expanded_changed_cb), self,
@@ -1285,9 +1574,25 @@ gcm_prefs_add_device (CcColorPanel *self, CdDevice *device)
     gcm_prefs_add_device_profiles (self, device);
 
     /* watch for changes */
-    g_ptr_array_add (self->devices, g_object_ref (device));
     g_signal_connect_object (device, "changed", G_CALLBACK (gcm_prefs_device_changed_cb), self, G_CONNECT_SWAPPED);
     gtk_list_box_invalidate_sort (self->list_box);
+
+out:
+    /* ensure we're not showing the 'No devices detected' entry */
+    gcm_prefs_update_device_list_extra_entry (self);
+}
+
+static void
+gcm_prefs_add_device (CcColorPanel *self, CdDevice *device)
+{
+    /* already listed, e.g. ::device-added raced with the initial list */
+    if (g_hash_table_contains (self->devices, cd_device_get_object_path (device)))
+        return;
+
+    /* the row is added once the device is connected, all devices connect in parallel */
+    g_hash_table_insert (self->devices, g_strdup (cd_device_get_object_path (device)), g_object_ref (device));
+    self->n_pending_devices++;
+    cd_device_connect (device, cc_panel_get_cancellable (CC_PANEL (self)), gcm_prefs_device_connect_cb, self);
 }
 
 static void
@@ -1295,6 +1600,7 @@ gcm_prefs_remove_device (CcColorPanel *self, CdDevice *device)
 {
     GtkWidget *child;
     CdDevice *device_tmp;
+    g_autoptr(CdDevice) device_added = NULL;
 
     child = gtk_widget_get_first_child (GTK_WIDGET (self->list_box));
     while (child) {
@@ -1310,26 +1616,11 @@ gcm_prefs_remove_device (CcColorPanel *self, CdDevice *device)
 
         child = next;
     }
-    g_signal_handlers_disconnect_by_func (device, G_CALLBACK (gcm_prefs_device_changed_cb), self);
-    g_ptr_array_remove (self->devices, device);
-}
-
-static void
-gcm_prefs_update_device_list_extra_entry (CcColorPanel *self)
-{
-    GtkListBoxRow *first_row;
-
-    /* any devices to show? */
-    first_row = gtk_list_box_get_row_at_index (self->list_box, 0);
-
-    if (first_row == NULL)
-        adw_view_stack_set_visible_child_name (self->stack, "no-devices-page");
-    else
-        adw_view_stack_set_visible_child_name (self->stack, "color-page");
 
-    /* if we have only one device expand it by default */
-    if (first_row != NULL && gtk_list_box_get_row_at_index (self->list_box, 1) == NULL)
-        cc_color_device_set_expanded (CC_COLOR_DEVICE (first_row), TRUE);
+    /* the signal carries a new object, not the one we are watching */
+    if (g_hash_table_steal_extended (self->devices, cd_device_get_object_path (device), NULL,
+                                     (gpointer *) &device_added))
+        g_signal_handlers_disconnect_by_func (device_added, G_CALLBACK (gcm_prefs_device_changed_cb), self);
 }
 
 static void
@@ -1337,9 +1628,6 @@ gcm_prefs_device_added_cb (CdClient *client, CdDevice *device, CcColorPanel *sel
 {
     /* add the device */
     gcm_prefs_add_device (self, device);
-
-    /* ensure we're not showing the 'No devices detected' entry */
-    gcm_prefs_update_device_list_extra_entry (self);
 }
 
 static void
@@ -1355,7 +1643,7 @@ gcm_prefs_device_removed_cb (CdClient *client, CdDevice *device, CcColorPanel *s
 static void
 gcm_prefs_get_devices_cb (GObject *object, GAsyncResult *res, gpointer user_data)
 {
-    CcColorPanel *self = (CcColorPanel *) user_data;
+    CcColorPanel *self;
     CdClient *client = CD_CLIENT (object);
     CdDevice *device;
     g_autoptr(GError) error = NULL;
@@ -1365,9 +1653,13 @@ gcm_prefs_get_devices_cb (GObject *object, GAsyncResult *res, gpointer user_data
     /* get devices and add them */
     devices = cd_client_get_devices_finish (client, res, &error);
     if (devices == NULL) {
-        g_warning ("failed to add connected devices: %s", error->message);
+        if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            g_warning ("failed to add connected devices: %s", error->message);
         return;
     }
+
+    self = CC_COLOR_PANEL (user_data);
+
     for (i = 0; i < devices->len; i++) {
         device = g_ptr_array_index (devices, i);
         gcm_prefs_add_device (self, device);
@@ -1457,11 +1749,14 @@ gcm_prefs_connect_cb (GObject *object, GAsyncResult *res, gpointer user_data)
      * making user_data invalid. */
     self = CC_COLOR_PANEL (user_data);
 
-    /* set calibrate button sensitivity */
+    /* set calibrate button sensitivity once the sensors are connected */
     gcm_prefs_sensor_coldplug (self);
 
     /* get devices */
     cd_client_get_devices (self->client, cc_panel_get_cancellable (CC_PANEL (self)), gcm_prefs_get_devices_cb, self);
+
+    /* fill the profile cache the assign dialog is built from */
+    cd_client_get_profiles (self->client, cc_panel_get_cancellable (CC_PANEL (self)), gcm_prefs_get_profiles_cb, self);
 }
 
 static gboolean
@@ -1524,10 +1819,14 @@ cc_color_panel_dispose (GObject *object)
     g_clear_object (&self->settings_colord);
     g_clear_object (&self->client);
     g_clear_object (&self->current_device);
-    g_clear_pointer (&self->devices, g_ptr_array_unref);
+    g_clear_pointer (&self->devices, g_hash_table_unref);
+    g_clear_pointer (&self->profiles, g_hash_table_unref);
+    g_clear_pointer (&self->assigned_profiles, g_hash_table_unref);
     g_clear_object (&self->calibrate);
     g_clear_object (&self->list_box_size);
     g_clear_pointer (&self->sensors, g_ptr_array_unref);
+    g_cancellable_cancel (self->sensors_cancellable);
+    g_clear_object (&self->sensors_cancellable);
     g_clear_pointer (&self->list_box_filter, g_free);
     g_clear_object (&self->liststore_assign);
 
@@ -1689,7 +1988,9 @@ cc_color_panel_init (CcColorPanel *self)
 
     gtk_widget_init_template (GTK_WIDGET (self));
 
-    self->devices = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+    self->devices = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+    self->profiles = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+    self->assigned_profiles = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 
     /* can do native display calibration using colord-session */
     self->calibrate = cc_color_calibrate_new ();
@@ -1822,6 +2123,11 @@ cc_color_panel_init (CcColorPanel *self)
     self->client = cd_client_new ();
     g_signal_connect_object (self->client, "device-added", G_CALLBACK (gcm_prefs_device_added_cb), self, 0);
     g_signal_connect_object (self->client, "device-removed", G_CALLBACK (gcm_prefs_device_removed_cb), self, 0);
+    g_signal_connect_object (self->client, "profile-added", G_CALLBACK (gcm_prefs_client_profile_added_cb), self, 0);
+    g_signal_connect_object (self->client, "profile-removed", G_CALLBACK (gcm_prefs_client_profile_removed_cb), self,
+                             0);
+    g_signal_connect_object (self->client, "profile-changed", G_CALLBACK (gcm_prefs_client_profile_changed_cb), self,
+                             0);
 
     /* use a listbox for the main UI */
     gtk_list_box_set_filter_func (self->list_box, cc_color_panel_filter_func, self, NULL);
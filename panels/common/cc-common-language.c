@@ -74,59 +74,106 @@ cc_common_language_get_iter_for_language (GtkTreeModel *model, const gchar *lang
     return iter_for_language (model, lang, iter, FALSE);
 }
 
-gboolean
-cc_common_language_has_font (const gchar *locale)
+/* How often, at most, the font configuration is checked for changes */
+#define FONT_COVERAGE_CHECK_INTERVAL (5 * G_USEC_PER_SEC)
+
+static GMutex font_coverage_lock;
+static FcConfig *font_coverage_config = NULL;
+static FcLangSet *font_coverage = NULL;
+static gint64 font_coverage_checked = 0;
+
+/*
+ * Collects the languages of all the installed fonts with a single
+ * FcFontList() call, rather than listing the fonts for each language.
+ */
+static FcLangSet *
+collect_font_coverage (FcConfig *config)
 {
-    const FcCharSet *charset;
+    FcLangSet *coverage;
     FcPattern *pattern;
     FcObjectSet *object_set;
     FcFontSet *font_set;
-    g_autofree gchar *language_code = NULL;
-    gboolean is_displayable;
 
-    is_displayable = FALSE;
-    pattern = NULL;
-    object_set = NULL;
-    font_set = NULL;
+    coverage = FcLangSetCreate ();
+    pattern = FcPatternCreate ();
+    object_set = FcObjectSetBuild (FC_LANG, NULL);
+    font_set = FcFontList (config, pattern, object_set);
 
-    if (!gnome_parse_locale (locale, &language_code, NULL, NULL, NULL))
-        return FALSE;
+    for (int i = 0; font_set != NULL && i < font_set->nfont; i++) {
+        FcLangSet *langs;
 
-    charset = FcLangGetCharSet ((FcChar8 *) language_code);
-    if (!charset) {
-        /* fontconfig does not know about this language */
-        is_displayable = TRUE;
-    } else {
-        /* see if any fonts support rendering it */
-        pattern = FcPatternBuild (NULL, FC_LANG, FcTypeString, language_code, NULL);
+        if (FcPatternGetLangSet (font_set->fonts[i], FC_LANG, 0, &langs) == FcResultMatch) {
+            FcLangSet *merged = FcLangSetUnion (coverage, langs);
+
+            FcLangSetDestroy (coverage);
+            coverage = merged;
+        }
+    }
 
-        if (pattern == NULL)
-            goto done;
+    if (font_set != NULL)
+        FcFontSetDestroy (font_set);
+    FcObjectSetDestroy (object_set);
+    FcPatternDestroy (pattern);
 
-        object_set = FcObjectSetCreate ();
+    return coverage;
+}
 
-        if (object_set == NULL)
-            goto done;
+/* Must be called with font_coverage_lock held */
+static void
+ensure_font_coverage (void)
+{
+    gint64 now = g_get_monotonic_time ();
+    FcConfig *config;
 
-        font_set = FcFontList (NULL, pattern, object_set);
+    if (font_coverage != NULL && now - font_coverage_checked < FONT_COVERAGE_CHECK_INTERVAL)
+        return;
+    font_coverage_checked = now;
 
-        if (font_set == NULL)
-            goto done;
+    /* Picks up fonts being installed or removed */
+    if (font_coverage != NULL && !FcConfigUptoDate (NULL))
+        FcInitBringUptoDate ();
 
-        is_displayable = (font_set->nfont > 0);
+    config = FcConfigReference (NULL);
+    if (font_coverage != NULL && config == font_coverage_config) {
+        FcConfigDestroy (config);
+        return;
     }
 
-done:
-    if (font_set != NULL)
-        FcFontSetDestroy (font_set);
+    g_clear_pointer (&font_coverage, FcLangSetDestroy);
+    g_clear_pointer (&font_coverage_config, FcConfigDestroy);
 
-    if (object_set != NULL)
-        FcObjectSetDestroy (object_set);
+    font_coverage_config = config;
+    font_coverage = collect_font_coverage (config);
+}
 
-    if (pattern != NULL)
-        FcPatternDestroy (pattern);
+/*
+ * Whether the installed fonts can display the language of @locale. The
+ * languages covered by the fonts are collected once and kept until the
+ * font configuration changes. This can be called from any thread.
+ */
+gboolean
+cc_common_language_has_font (const gchar *locale)
+{
+    g_autoptr(GMutexLocker) locker = NULL;
+    g_autofree gchar *language_code = NULL;
+
+    if (!gnome_parse_locale (locale, &language_code, NULL, NULL, NULL))
+        return FALSE;
+
+    /* fontconfig does not know about this language */
+    if (!FcLangGetCharSet ((FcChar8 *) language_code))
+        return TRUE;
+
+    locker = g_mutex_locker_new (&font_coverage_lock);
+    ensure_font_coverage ();
 
-    return is_displayable;
+    return FcLangSetHasLang (font_coverage, (FcChar8 *) language_code) != FcLangDifferentLang;
+}
+
+static gchar *
+get_current_user_object_path (void)
+{
+    return g_strdup_printf ("/org/freedesktop/Accounts/User%d", getuid ());
 }
 
 gchar *
@@ -136,7 +183,7 @@ cc_common_language_get_current_language (void)
     g_autofree gchar *path = NULL;
     const gchar *locale;
 
-    path = g_strdup_printf ("/org/freedesktop/Accounts/User%d", getuid ());
+    path = get_current_user_object_path ();
     language = get_lang_for_user_object_path (path);
     if (language != NULL && *language != '\0')
         return language;
@@ -150,6 +197,21 @@ cc_common_language_get_current_language (void)
     return language;
 }
 
+/**
+ * cc_common_language_declare_dbus_proxies:
+ *
+ * Declares the accounts proxy of the current user, which is looked up
+ * synchronously, so that it is ready by the time the language is needed.
+ */
+void
+cc_common_language_declare_dbus_proxies (void)
+{
+    g_autofree gchar *path = get_current_user_object_path ();
+
+    cc_object_storage_declare_dbus_proxy (G_BUS_TYPE_SYSTEM, G_DBUS_PROXY_FLAGS_NONE, "org.freedesktop.Accounts", path,
+                                          "org.freedesktop.Accounts.User");
+}
+
 static char *
 get_lang_for_user_object_path (const char *path)
 {
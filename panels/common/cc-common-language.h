@@ -40,4 +40,6 @@ GHashTable *cc_common_language_get_initial_languages (void);
 
 void cc_common_language_add_user_languages (GtkTreeModel *model);
 
+void cc_common_language_declare_dbus_proxies (void);
+
 G_END_DECLS
@@ -31,20 +31,25 @@
 #include <string.h>
 
 #include "cc-common-language.h"
+#include "cc-locale-item.h"
 #include "cc-util.h"
 
-#define GNOME_DESKTOP_USE_UNSTABLE_API
-#include <libgnome-desktop/gnome-languages.h>
-
 struct _CcLanguageChooser {
     AdwDialog parent_instance;
 
     GtkSearchEntry *language_filter_entry;
-    GtkListBox *language_listbox;
-    GtkListBoxRow *more_row;
+    GtkListView *language_listview;
+    GtkStack *language_stack;
     GtkSearchBar *search_bar;
     GtkButton *select_button;
 
+    GtkCustomFilter *filter;
+    GListStore *footer_items;
+    GObject *more_item;
+    GtkNoSelection *selection;
+    /* Bound CcLanguageRow widgets, to update their check marks */
+    GHashTable *rows;
+
     gboolean showing_extra;
     gchar *language;
     gchar **filter_words;
@@ -61,102 +66,109 @@ static guint signals[LAST_SIGNAL] = {
 
 G_DEFINE_FINAL_TYPE (CcLanguageChooser, cc_language_chooser, ADW_TYPE_DIALOG)
 
-static void
-add_all_languages (CcLanguageChooser *self)
-{
-    g_auto(GStrv) locale_ids = NULL;
-    g_autoptr(GHashTable) initial = NULL;
-
-    locale_ids = gnome_get_all_locales ();
-    initial = cc_common_language_get_initial_languages ();
-    for (int i = 0; locale_ids[i] != NULL; i++) {
-        CcLanguageRow *row;
-        gboolean is_initial;
-
-        if (!cc_common_language_has_font (locale_ids[i]))
-            continue;
-
-        row = cc_language_row_new (locale_ids[i]);
-        is_initial = (g_hash_table_lookup (initial, locale_ids[i]) != NULL);
-        cc_language_row_set_is_extra (row, !is_initial);
-        gtk_list_box_prepend (self->language_listbox, GTK_WIDGET (row));
-    }
-}
-
 static gboolean
-match_all (gchar **words, const gchar *str)
+language_visible (gpointer item, gpointer user_data)
 {
-    gchar **w;
+    CcLanguageChooser *self = user_data;
+    CcLocaleItem *locale = CC_LOCALE_ITEM (item);
 
-    if (str == NULL)
+    /* The selected language is shown even if it's not an initial one */
+    if (!self->showing_extra && !cc_locale_item_get_is_initial (locale) &&
+        g_strcmp0 (cc_locale_item_get_locale_id (locale), self->language) != 0)
         return FALSE;
 
-    for (w = words; *w; ++w)
-        if (!strstr (str, *w))
-            return FALSE;
+    if (!self->filter_words)
+        return TRUE;
 
-    return TRUE;
+    return cc_locale_item_match_language (locale, self->filter_words);
 }
 
-static gboolean
-language_visible (GtkListBoxRow *row, gpointer user_data)
+static gint
+sort_languages (gconstpointer a, gconstpointer b, gpointer user_data)
 {
-    CcLanguageChooser *self = user_data;
-    g_autofree gchar *language = NULL;
-    g_autofree gchar *country = NULL;
-    g_autofree gchar *language_local = NULL;
-    g_autofree gchar *country_local = NULL;
-    gboolean visible;
+    CcLocaleItem *item_a = CC_LOCALE_ITEM ((gpointer) a);
+    CcLocaleItem *item_b = CC_LOCALE_ITEM ((gpointer) b);
+    int d;
 
-    if (row == self->more_row)
-        return !self->showing_extra;
+    d = g_strcmp0 (cc_locale_item_get_language (item_a), cc_locale_item_get_language (item_b));
+    if (d != 0)
+        return d;
 
-    if (!CC_IS_LANGUAGE_ROW (row))
-        return TRUE;
+    return g_strcmp0 (cc_locale_item_get_country (item_a), cc_locale_item_get_country (item_b));
+}
 
-    if (!self->showing_extra && cc_language_row_get_is_extra (CC_LANGUAGE_ROW (row)))
-        return FALSE;
+static void
+language_factory_setup_cb (GtkSignalListItemFactory *factory, GObject *object, gpointer user_data)
+{
+    GtkListItem *list_item = GTK_LIST_ITEM (object);
 
-    if (!self->filter_words)
-        return TRUE;
+    gtk_list_item_set_child (list_item, GTK_WIDGET (cc_language_row_new ()));
+}
 
-    language = cc_util_normalize_casefold_and_unaccent (cc_language_row_get_language (CC_LANGUAGE_ROW (row)));
-    visible = match_all (self->filter_words, language);
-    if (visible)
-        return TRUE;
+static GtkWidget *
+more_row_new (void)
+{
+    GtkWidget *box;
+    GtkWidget *image;
 
-    country = cc_util_normalize_casefold_and_unaccent (cc_language_row_get_country (CC_LANGUAGE_ROW (row)));
-    visible = match_all (self->filter_words, country);
-    if (visible)
-        return TRUE;
+    box = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 10);
+    gtk_widget_set_tooltip_markup (box, _("More…"));
 
-    language_local =
-        cc_util_normalize_casefold_and_unaccent (cc_language_row_get_language_local (CC_LANGUAGE_ROW (row)));
-    visible = match_all (self->filter_words, language_local);
-    if (visible)
-        return TRUE;
+    image = gtk_image_new_from_icon_name ("view-more-symbolic");
+    gtk_widget_set_hexpand (image, TRUE);
+    gtk_widget_set_halign (image, GTK_ALIGN_CENTER);
+    gtk_widget_set_margin_top (image, 10);
+    gtk_widget_set_margin_bottom (image, 10);
+    gtk_widget_add_css_class (image, "dim-label");
+    gtk_box_append (GTK_BOX (box), image);
 
-    country_local = cc_util_normalize_casefold_and_unaccent (cc_language_row_get_country_local (CC_LANGUAGE_ROW (row)));
-    return match_all (self->filter_words, country_local);
+    return box;
 }
 
-static gint
-sort_languages (GtkListBoxRow *a, GtkListBoxRow *b, gpointer data)
+/* Rows are only bound for the items that are visible */
+static void
+language_factory_bind_cb (GtkSignalListItemFactory *factory, GObject *object, gpointer user_data)
 {
-    int d;
+    CcLanguageChooser *self = CC_LANGUAGE_CHOOSER (user_data);
+    GtkListItem *list_item = GTK_LIST_ITEM (object);
+    GObject *item = gtk_list_item_get_item (list_item);
+    CcLanguageRow *row;
+
+    /* The more row is a one-off, it doesn't reuse a language row */
+    if (item == self->more_item) {
+        gtk_list_item_set_child (list_item, more_row_new ());
+        return;
+    }
 
-    if (!CC_IS_LANGUAGE_ROW (a))
-        return 1;
-    if (!CC_IS_LANGUAGE_ROW (b))
-        return -1;
+    if (!CC_IS_LANGUAGE_ROW (gtk_list_item_get_child (list_item)))
+        gtk_list_item_set_child (list_item, GTK_WIDGET (cc_language_row_new ()));
 
-    d = g_strcmp0 (cc_language_row_get_language (CC_LANGUAGE_ROW (a)),
-                   cc_language_row_get_language (CC_LANGUAGE_ROW (b)));
-    if (d != 0)
-        return d;
+    row = CC_LANGUAGE_ROW (gtk_list_item_get_child (list_item));
+    cc_language_row_set_item (row, CC_LOCALE_ITEM (item));
+    cc_language_row_set_checked (row, g_strcmp0 (cc_locale_item_get_locale_id (CC_LOCALE_ITEM (item)),
+                                                 self->language) == 0);
+    g_hash_table_add (self->rows, row);
+}
+
+static void
+language_factory_unbind_cb (GtkSignalListItemFactory *factory, GObject *object, gpointer user_data)
+{
+    CcLanguageChooser *self = CC_LANGUAGE_CHOOSER (user_data);
+    GtkWidget *child = gtk_list_item_get_child (GTK_LIST_ITEM (object));
+
+    if (CC_IS_LANGUAGE_ROW (child)) {
+        if (self->rows)
+            g_hash_table_remove (self->rows, child);
+        cc_language_row_set_item (CC_LANGUAGE_ROW (child), NULL);
+    }
+}
 
-    return g_strcmp0 (cc_language_row_get_country (CC_LANGUAGE_ROW (a)),
-                      cc_language_row_get_country (CC_LANGUAGE_ROW (b)));
+static void
+update_visible_page (CcLanguageChooser *self)
+{
+    gboolean empty = g_list_model_get_n_items (G_LIST_MODEL (self->selection)) == 0;
+
+    gtk_stack_set_visible_child_name (self->language_stack, empty ? "empty-page" : "languages-page");
 }
 
 static void
@@ -168,71 +180,72 @@ language_filter_entry_search_changed_cb (CcLanguageChooser *self)
 
     filter_contents =
         cc_util_normalize_casefold_and_unaccent (gtk_editable_get_text (GTK_EDITABLE (self->language_filter_entry)));
-    if (!filter_contents) {
-        gtk_list_box_invalidate_filter (self->language_listbox);
-        return;
-    }
-    self->filter_words = g_strsplit_set (g_strstrip (filter_contents), " ", 0);
-    gtk_list_box_invalidate_filter (self->language_listbox);
+    if (filter_contents)
+        self->filter_words = g_strsplit_set (g_strstrip (filter_contents), " ", 0);
+
+    /* The names and their normalized forms are cached by CcLocaleItem */
+    gtk_filter_changed (GTK_FILTER (self->filter), GTK_FILTER_CHANGE_DIFFERENT);
 }
 
 static void
 show_more (CcLanguageChooser *self, gboolean visible)
 {
     gtk_search_bar_set_search_mode (self->search_bar, visible);
-    gtk_widget_grab_focus (visible ? GTK_WIDGET (self->language_filter_entry) : GTK_WIDGET (self->language_listbox));
+    gtk_widget_grab_focus (visible ? GTK_WIDGET (self->language_filter_entry) : GTK_WIDGET (self->language_listview));
+
+    if (self->showing_extra == visible)
+        return;
 
     self->showing_extra = visible;
 
-    gtk_list_box_invalidate_filter (self->language_listbox);
+    if (visible)
+        g_list_store_remove_all (self->footer_items);
+    else
+        g_list_store_append (self->footer_items, self->more_item);
+
+    gtk_filter_changed (GTK_FILTER (self->filter),
+                        visible ? GTK_FILTER_CHANGE_LESS_STRICT : GTK_FILTER_CHANGE_MORE_STRICT);
 }
 
 static void
 set_locale_id (CcLanguageChooser *self, const gchar *locale_id)
 {
-    GtkWidget *child;
-
-    gtk_widget_set_sensitive (GTK_WIDGET (self->select_button), FALSE);
-
-    for (child = gtk_widget_get_first_child (GTK_WIDGET (self->language_listbox)); child;
-         child = gtk_widget_get_next_sibling (child)) {
-        CcLanguageRow *row;
-
-        if (!CC_IS_LANGUAGE_ROW (child))
-            continue;
-
-        row = CC_LANGUAGE_ROW (child);
-        if (g_strcmp0 (locale_id, cc_language_row_get_locale_id (row)) == 0) {
-            cc_language_row_set_checked (row, TRUE);
-            gtk_widget_set_sensitive (GTK_WIDGET (self->select_button), TRUE);
-
-            /* make sure the selected language is shown */
-            if (!self->showing_extra && cc_language_row_get_is_extra (row)) {
-                cc_language_row_set_is_extra (row, FALSE);
-                gtk_list_box_invalidate_filter (self->language_listbox);
-            }
-        } else {
-            cc_language_row_set_checked (row, FALSE);
-        }
-    }
+    GHashTableIter iter;
+    gpointer row;
 
     g_set_str (&self->language, locale_id);
+
+    g_hash_table_iter_init (&iter, self->rows);
+    while (g_hash_table_iter_next (&iter, &row, NULL)) {
+        CcLocaleItem *item = cc_language_row_get_item (CC_LANGUAGE_ROW (row));
+
+        cc_language_row_set_checked (CC_LANGUAGE_ROW (row),
+                                     g_strcmp0 (locale_id, cc_locale_item_get_locale_id (item)) == 0);
+    }
+
+    gtk_widget_set_sensitive (GTK_WIDGET (self->select_button),
+                              locale_id != NULL && cc_locale_item_lookup (locale_id) != NULL);
+
+    /* make sure the selected language is shown */
+    gtk_filter_changed (GTK_FILTER (self->filter), GTK_FILTER_CHANGE_DIFFERENT);
 }
 
 static void
-language_listbox_row_activated_cb (CcLanguageChooser *self, GtkListBoxRow *row)
+language_listview_activate_cb (CcLanguageChooser *self, guint position)
 {
+    g_autoptr(GObject) item = NULL;
     const gchar *new_locale_id;
 
-    if (row == self->more_row) {
-        show_more (self, TRUE);
+    item = g_list_model_get_item (G_LIST_MODEL (self->selection), position);
+    if (!item)
         return;
-    }
 
-    if (!CC_IS_LANGUAGE_ROW (row))
+    if (item == self->more_item) {
+        show_more (self, TRUE);
         return;
+    }
 
-    new_locale_id = cc_language_row_get_locale_id (CC_LANGUAGE_ROW (row));
+    new_locale_id = cc_locale_item_get_locale_id (CC_LOCALE_ITEM (item));
     if (g_strcmp0 (new_locale_id, self->language) == 0) {
         g_signal_emit (self, signals[LANGUAGE_SELECTED], 0);
     } else {
@@ -249,15 +262,38 @@ select_button_clicked_cb (CcLanguageChooser *self)
 void
 cc_language_chooser_init (CcLanguageChooser *self)
 {
+    g_autoptr(GListStore) sections = NULL;
+    GtkFilterListModel *filtered;
+    GtkSortListModel *sorted;
+
     g_resources_register (cc_common_get_resource ());
 
     gtk_widget_init_template (GTK_WIDGET (self));
 
-    gtk_list_box_set_sort_func (self->language_listbox, sort_languages, self, NULL);
-    gtk_list_box_set_filter_func (self->language_listbox, language_visible, self, NULL);
-    add_all_languages (self);
+    self->rows = g_hash_table_new (NULL, NULL);
+
+    self->more_item = g_object_new (G_TYPE_OBJECT, NULL);
+    self->footer_items = g_list_store_new (G_TYPE_OBJECT);
+    g_list_store_append (self->footer_items, self->more_item);
+
+    /* Only the visible languages are sorted */
+    self->filter = gtk_custom_filter_new (language_visible, self, NULL);
+    filtered = gtk_filter_list_model_new (g_object_ref (cc_locale_item_get_all ()),
+                                          GTK_FILTER (g_object_ref (self->filter)));
+    sorted = gtk_sort_list_model_new (G_LIST_MODEL (filtered),
+                                      GTK_SORTER (gtk_custom_sorter_new (sort_languages, NULL, NULL)));
+
+    sections = g_list_store_new (G_TYPE_LIST_MODEL);
+    g_list_store_append (sections, sorted);
+    g_list_store_append (sections, self->footer_items);
+    g_object_unref (sorted);
+
+    self->selection = gtk_no_selection_new (G_LIST_MODEL (gtk_flatten_list_model_new (
+        G_LIST_MODEL (g_steal_pointer (&sections)))));
+    g_signal_connect_object (self->selection, "items-changed", G_CALLBACK (update_visible_page), self,
+                             G_CONNECT_SWAPPED);
 
-    gtk_list_box_invalidate_filter (self->language_listbox);
+    gtk_list_view_set_model (self->language_listview, GTK_SELECTION_MODEL (self->selection));
 }
 
 static void
@@ -265,6 +301,11 @@ cc_language_chooser_dispose (GObject *object)
 {
     CcLanguageChooser *self = CC_LANGUAGE_CHOOSER (object);
 
+    g_clear_object (&self->selection);
+    g_clear_object (&self->filter);
+    g_clear_object (&self->footer_items);
+    g_clear_object (&self->more_item);
+    g_clear_pointer (&self->rows, g_hash_table_unref);
     g_clear_pointer (&self->filter_words, g_strfreev);
     g_clear_pointer (&self->language, g_free);
 
@@ -286,13 +327,16 @@ cc_language_chooser_class_init (CcLanguageChooserClass *klass)
                                                  "/org/gnome/control-center/common/cc-language-chooser.ui");
 
     gtk_widget_class_bind_template_child (widget_class, CcLanguageChooser, language_filter_entry);
-    gtk_widget_class_bind_template_child (widget_class, CcLanguageChooser, language_listbox);
-    gtk_widget_class_bind_template_child (widget_class, CcLanguageChooser, more_row);
+    gtk_widget_class_bind_template_child (widget_class, CcLanguageChooser, language_listview);
+    gtk_widget_class_bind_template_child (widget_class, CcLanguageChooser, language_stack);
     gtk_widget_class_bind_template_child (widget_class, CcLanguageChooser, search_bar);
     gtk_widget_class_bind_template_child (widget_class, CcLanguageChooser, select_button);
 
+    gtk_widget_class_bind_template_callback (widget_class, language_factory_setup_cb);
+    gtk_widget_class_bind_template_callback (widget_class, language_factory_bind_cb);
+    gtk_widget_class_bind_template_callback (widget_class, language_factory_unbind_cb);
     gtk_widget_class_bind_template_callback (widget_class, language_filter_entry_search_changed_cb);
-    gtk_widget_class_bind_template_callback (widget_class, language_listbox_row_activated_cb);
+    gtk_widget_class_bind_template_callback (widget_class, language_listview_activate_cb);
     gtk_widget_class_bind_template_callback (widget_class, select_button_clicked_cb);
 }
 
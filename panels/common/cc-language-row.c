@@ -19,52 +19,24 @@
 #include "cc-language-row.h"
 #include "cc-common-resources.h"
 
-#define GNOME_DESKTOP_USE_UNSTABLE_API
-#include <libgnome-desktop/gnome-languages.h>
-
 struct _CcLanguageRow {
-    GtkListBoxRow parent_instance;
+    AdwBin parent_instance;
 
     GtkImage *check_image;
     GtkLabel *country_label;
     GtkLabel *language_label;
 
-    gchar *locale_id;
-    gchar *language;
-    gchar *language_local;
-    gchar *country;
-    gchar *country_local;
-
-    gboolean is_extra;
+    CcLocaleItem *item;
 };
 
-G_DEFINE_FINAL_TYPE (CcLanguageRow, cc_language_row, GTK_TYPE_LIST_BOX_ROW)
-
-static gchar *
-get_language_label (const gchar *language_code, const gchar *modifier, const gchar *locale_id)
-{
-    g_autofree gchar *language = NULL;
-
-    language = gnome_get_language_from_code (language_code, locale_id);
-
-    if (modifier == NULL)
-        return g_steal_pointer (&language);
-    else {
-        g_autofree gchar *t_mod = gnome_get_translated_modifier (modifier, locale_id);
-        return g_strdup_printf ("%s — %s", language, t_mod);
-    }
-}
+G_DEFINE_FINAL_TYPE (CcLanguageRow, cc_language_row, ADW_TYPE_BIN)
 
 static void
 cc_language_row_dispose (GObject *object)
 {
     CcLanguageRow *self = CC_LANGUAGE_ROW (object);
 
-    g_clear_pointer (&self->locale_id, g_free);
-    g_clear_pointer (&self->country, g_free);
-    g_clear_pointer (&self->country_local, g_free);
-    g_clear_pointer (&self->language, g_free);
-    g_clear_pointer (&self->language_local, g_free);
+    g_clear_object (&self->item);
 
     G_OBJECT_CLASS (cc_language_row_parent_class)->dispose (object);
 }
@@ -93,67 +65,29 @@ cc_language_row_init (CcLanguageRow *self)
 }
 
 CcLanguageRow *
-cc_language_row_new (const gchar *locale_id)
+cc_language_row_new (void)
 {
-    CcLanguageRow *self;
-    g_autofree gchar *language_code = NULL;
-    g_autofree gchar *country_code = NULL;
-    g_autofree gchar *modifier = NULL;
-
-    self = g_object_new (CC_TYPE_LANGUAGE_ROW, NULL);
-    self->locale_id = g_strdup (locale_id);
-
-    gnome_parse_locale (locale_id, &language_code, &country_code, NULL, &modifier);
-
-    self->language = get_language_label (language_code, modifier, locale_id);
-    self->language_local = get_language_label (language_code, modifier, NULL);
-    gtk_label_set_label (self->language_label, self->language);
-
-    if (country_code == NULL) {
-        self->country = NULL;
-        self->country_local = NULL;
-    } else {
-        self->country = gnome_get_country_from_code (country_code, locale_id);
-        self->country_local = gnome_get_country_from_code (country_code, NULL);
-        gtk_label_set_label (self->country_label, self->country);
-    }
-
-    return self;
+    return g_object_new (CC_TYPE_LANGUAGE_ROW, NULL);
 }
 
-const gchar *
-cc_language_row_get_locale_id (CcLanguageRow *self)
-{
-    g_return_val_if_fail (CC_IS_LANGUAGE_ROW (self), NULL);
-    return self->locale_id;
-}
-
-const gchar *
-cc_language_row_get_language (CcLanguageRow *self)
+void
+cc_language_row_set_item (CcLanguageRow *self, CcLocaleItem *item)
 {
-    g_return_val_if_fail (CC_IS_LANGUAGE_ROW (self), NULL);
-    return self->language;
-}
+    g_return_if_fail (CC_IS_LANGUAGE_ROW (self));
+    g_return_if_fail (item == NULL || CC_IS_LOCALE_ITEM (item));
 
-const gchar *
-cc_language_row_get_language_local (CcLanguageRow *self)
-{
-    g_return_val_if_fail (CC_IS_LANGUAGE_ROW (self), NULL);
-    return self->language_local;
-}
+    if (!g_set_object (&self->item, item) || item == NULL)
+        return;
 
-const gchar *
-cc_language_row_get_country (CcLanguageRow *self)
-{
-    g_return_val_if_fail (CC_IS_LANGUAGE_ROW (self), NULL);
-    return self->country;
+    gtk_label_set_label (self->language_label, cc_locale_item_get_language (item));
+    gtk_label_set_label (self->country_label, cc_locale_item_get_country (item));
 }
 
-const gchar *
-cc_language_row_get_country_local (CcLanguageRow *self)
+CcLocaleItem *
+cc_language_row_get_item (CcLanguageRow *self)
 {
     g_return_val_if_fail (CC_IS_LANGUAGE_ROW (self), NULL);
-    return self->country_local;
+    return self->item;
 }
 
 void
@@ -162,17 +96,3 @@ cc_language_row_set_checked (CcLanguageRow *self, gboolean checked)
     g_return_if_fail (CC_IS_LANGUAGE_ROW (self));
     gtk_widget_set_visible (GTK_WIDGET (self->check_image), checked);
 }
-
-void
-cc_language_row_set_is_extra (CcLanguageRow *self, gboolean is_extra)
-{
-    g_return_if_fail (CC_IS_LANGUAGE_ROW (self));
-    self->is_extra = is_extra;
-}
-
-gboolean
-cc_language_row_get_is_extra (CcLanguageRow *self)
-{
-    g_return_val_if_fail (CC_IS_LANGUAGE_ROW (self), FALSE);
-    return self->is_extra;
-}
@@ -18,28 +18,20 @@
 
 #pragma once
 
-#include <gtk/gtk.h>
+#include <adwaita.h>
+
+#include "cc-locale-item.h"
 
 G_BEGIN_DECLS
 
 #define CC_TYPE_LANGUAGE_ROW (cc_language_row_get_type ())
-G_DECLARE_FINAL_TYPE (CcLanguageRow, cc_language_row, CC, LANGUAGE_ROW, GtkListBoxRow);
-CcLanguageRow *cc_language_row_new (const gchar *locale_id);
-
-const gchar *cc_language_row_get_locale_id (CcLanguageRow *row);
-
-const gchar *cc_language_row_get_language (CcLanguageRow *row);
+G_DECLARE_FINAL_TYPE (CcLanguageRow, cc_language_row, CC, LANGUAGE_ROW, AdwBin);
+CcLanguageRow *cc_language_row_new (void);
 
-const gchar *cc_language_row_get_language_local (CcLanguageRow *row);
+void cc_language_row_set_item (CcLanguageRow *row, CcLocaleItem *item);
 
-const gchar *cc_language_row_get_country (CcLanguageRow *row);
-
-const gchar *cc_language_row_get_country_local (CcLanguageRow *row);
+CcLocaleItem *cc_language_row_get_item (CcLanguageRow *row);
 
 void cc_language_row_set_checked (CcLanguageRow *row, gboolean checked);
 
-void cc_language_row_set_is_extra (CcLanguageRow *row, gboolean is_extra);
-
-gboolean cc_language_row_get_is_extra (CcLanguageRow *row);
-
 G_END_DECLS
@@ -0,0 +1,310 @@
+/*
+ * Copyright (C) 2026 The GNOME Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+#include <string.h>
+
+#include "cc-common-language.h"
+#include "cc-locale-item.h"
+#include "cc-util.h"
+
+#define GNOME_DESKTOP_USE_UNSTABLE_API
+#include <libgnome-desktop/gnome-languages.h>
+
+/*
+ * The display names of a locale are looked up the first time a chooser
+ * needs them and kept for the lifetime of the process, together with
+ * their normalized forms, so filtering only does substring matches.
+ */
+struct _CcLocaleItem {
+    GObject parent_instance;
+
+    gchar *locale_id;
+    gboolean is_initial;
+
+    /* Language chooser: names in the locale itself and in the current one */
+    gboolean has_language;
+    gchar *language;
+    gchar *country;
+    gchar *language_keys[4];
+
+    /* Format chooser: the region in its own, the current and the C locale */
+    gboolean has_region;
+    gchar *region;
+    gchar *region_keys[3];
+};
+
+G_DEFINE_FINAL_TYPE (CcLocaleItem, cc_locale_item, G_TYPE_OBJECT)
+
+static GListStore *all_locales = NULL;
+static GHashTable *locales_by_id = NULL;
+
+static void
+clear_keys (gchar **keys, guint n_keys)
+{
+    for (guint i = 0; i < n_keys; i++)
+        g_clear_pointer (&keys[i], g_free);
+}
+
+static void
+cc_locale_item_finalize (GObject *object)
+{
+    CcLocaleItem *self = CC_LOCALE_ITEM (object);
+
+    g_free (self->locale_id);
+    g_free (self->language);
+    g_free (self->country);
+    clear_keys (self->language_keys, G_N_ELEMENTS (self->language_keys));
+    g_free (self->region);
+    clear_keys (self->region_keys, G_N_ELEMENTS (self->region_keys));
+
+    G_OBJECT_CLASS (cc_locale_item_parent_class)->finalize (object);
+}
+
+static void
+cc_locale_item_class_init (CcLocaleItemClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+    object_class->finalize = cc_locale_item_finalize;
+}
+
+static void
+cc_locale_item_init (CcLocaleItem *self)
+{
+}
+
+static gchar *
+get_language_label (const gchar *language_code, const gchar *modifier, const gchar *locale_id)
+{
+    g_autofree gchar *language = NULL;
+
+    language = gnome_get_language_from_code (language_code, locale_id);
+
+    if (modifier == NULL)
+        return g_steal_pointer (&language);
+    else {
+        g_autofree gchar *t_mod = gnome_get_translated_modifier (modifier, locale_id);
+        return g_strdup_printf ("%s — %s", language, t_mod);
+    }
+}
+
+static gchar *
+normalize (const gchar *str)
+{
+    return str ? cc_util_normalize_casefold_and_unaccent (str) : NULL;
+}
+
+static void
+ensure_language (CcLocaleItem *self)
+{
+    g_autofree gchar *language_code = NULL;
+    g_autofree gchar *country_code = NULL;
+    g_autofree gchar *modifier = NULL;
+    g_autofree gchar *language_local = NULL;
+    g_autofree gchar *country_local = NULL;
+
+    if (self->has_language)
+        return;
+    self->has_language = TRUE;
+
+    gnome_parse_locale (self->locale_id, &language_code, &country_code, NULL, &modifier);
+
+    self->language = get_language_label (language_code, modifier, self->locale_id);
+    language_local = get_language_label (language_code, modifier, NULL);
+
+    if (country_code != NULL) {
+        self->country = gnome_get_country_from_code (country_code, self->locale_id);
+        country_local = gnome_get_country_from_code (country_code, NULL);
+    }
+
+    self->language_keys[0] = normalize (self->language);
+    self->language_keys[1] = normalize (self->country);
+    self->language_keys[2] = normalize (language_local);
+    self->language_keys[3] = normalize (country_local);
+}
+
+static void
+ensure_region (CcLocaleItem *self)
+{
+    g_autofree gchar *region_local = NULL;
+    g_autofree gchar *region_untranslated = NULL;
+
+    if (self->has_region)
+        return;
+    self->has_region = TRUE;
+
+    self->region = gnome_get_country_from_locale (self->locale_id, self->locale_id);
+    if (self->region == NULL)
+        return;
+
+    region_local = gnome_get_country_from_locale (self->locale_id, NULL);
+    region_untranslated = gnome_get_country_from_locale (self->locale_id, "C");
+
+    self->region_keys[0] = normalize (self->region);
+    self->region_keys[1] = normalize (region_local);
+    self->region_keys[2] = normalize (region_untranslated);
+}
+
+static gboolean
+match_all (gchar **words, const gchar *str)
+{
+    gchar **w;
+
+    if (str == NULL)
+        return FALSE;
+
+    for (w = words; *w; ++w)
+        if (!strstr (str, *w))
+            return FALSE;
+
+    return TRUE;
+}
+
+static gboolean
+match_any_key (gchar **words, gchar **keys, guint n_keys)
+{
+    for (guint i = 0; i < n_keys; i++)
+        if (match_all (words, keys[i]))
+            return TRUE;
+
+    return FALSE;
+}
+
+static void
+ensure_all_locales (void)
+{
+    g_auto(GStrv) locale_ids = NULL;
+    g_autoptr(GHashTable) initial = NULL;
+    g_autoptr(GPtrArray) items = NULL;
+
+    if (all_locales != NULL)
+        return;
+
+    all_locales = g_list_store_new (CC_TYPE_LOCALE_ITEM);
+    locales_by_id = g_hash_table_new (g_str_hash, g_str_equal);
+
+    locale_ids = gnome_get_all_locales ();
+    initial = cc_common_language_get_initial_languages ();
+    items = g_ptr_array_new_with_free_func (g_object_unref);
+
+    for (guint i = 0; locale_ids[i] != NULL; i++) {
+        CcLocaleItem *item;
+
+        if (!cc_common_language_has_font (locale_ids[i]))
+            continue;
+
+        item = g_object_new (CC_TYPE_LOCALE_ITEM, NULL);
+        item->locale_id = g_strdup (locale_ids[i]);
+        item->is_initial = g_hash_table_contains (initial, locale_ids[i]);
+
+        g_hash_table_insert (locales_by_id, item->locale_id, item);
+        g_ptr_array_add (items, item);
+    }
+
+    g_list_store_splice (all_locales, 0, 0, items->pdata, items->len);
+}
+
+/*
+ * Returns the locales which can be displayed with the installed fonts,
+ * shared by all the choosers in the process. Names are only looked up
+ * once something asks for them.
+ */
+GListModel *
+cc_locale_item_get_all (void)
+{
+    ensure_all_locales ();
+
+    return G_LIST_MODEL (all_locales);
+}
+
+CcLocaleItem *
+cc_locale_item_lookup (const gchar *locale_id)
+{
+    g_return_val_if_fail (locale_id != NULL, NULL);
+
+    ensure_all_locales ();
+
+    return g_hash_table_lookup (locales_by_id, locale_id);
+}
+
+const gchar *
+cc_locale_item_get_locale_id (CcLocaleItem *self)
+{
+    g_return_val_if_fail (CC_IS_LOCALE_ITEM (self), NULL);
+    return self->locale_id;
+}
+
+gboolean
+cc_locale_item_get_is_initial (CcLocaleItem *self)
+{
+    g_return_val_if_fail (CC_IS_LOCALE_ITEM (self), FALSE);
+    return self->is_initial;
+}
+
+const gchar *
+cc_locale_item_get_language (CcLocaleItem *self)
+{
+    g_return_val_if_fail (CC_IS_LOCALE_ITEM (self), NULL);
+
+    ensure_language (self);
+
+    return self->language;
+}
+
+const gchar *
+cc_locale_item_get_country (CcLocaleItem *self)
+{
+    g_return_val_if_fail (CC_IS_LOCALE_ITEM (self), NULL);
+
+    ensure_language (self);
+
+    return self->country;
+}
+
+/* @words must be normalized with cc_util_normalize_casefold_and_unaccent() */
+gboolean
+cc_locale_item_match_language (CcLocaleItem *self, gchar **words)
+{
+    g_return_val_if_fail (CC_IS_LOCALE_ITEM (self), FALSE);
+
+    ensure_language (self);
+
+    return match_any_key (words, self->language_keys, G_N_ELEMENTS (self->language_keys));
+}
+
+/* The name of the region of the locale, or %NULL if it has none */
+const gchar *
+cc_locale_item_get_region (CcLocaleItem *self)
+{
+    g_return_val_if_fail (CC_IS_LOCALE_ITEM (self), NULL);
+
+    ensure_region (self);
+
+    return self->region;
+}
+
+/* @words must be normalized with cc_util_normalize_casefold_and_unaccent() */
+gboolean
+cc_locale_item_match_region (CcLocaleItem *self, gchar **words)
+{
+    g_return_val_if_fail (CC_IS_LOCALE_ITEM (self), FALSE);
+
+    ensure_region (self);
+
+    return match_any_key (words, self->region_keys, G_N_ELEMENTS (self->region_keys));
+}
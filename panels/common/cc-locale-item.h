@@ -0,0 +1,40 @@
+/*
+ * Copyright (C) 2026 The GNOME Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define CC_TYPE_LOCALE_ITEM (cc_locale_item_get_type ())
+G_DECLARE_FINAL_TYPE (CcLocaleItem, cc_locale_item, CC, LOCALE_ITEM, GObject)
+
+GListModel *cc_locale_item_get_all (void);
+CcLocaleItem *cc_locale_item_lookup (const gchar *locale_id);
+
+const gchar *cc_locale_item_get_locale_id (CcLocaleItem *self);
+gboolean cc_locale_item_get_is_initial (CcLocaleItem *self);
+
+const gchar *cc_locale_item_get_language (CcLocaleItem *self);
+const gchar *cc_locale_item_get_country (CcLocaleItem *self);
+gboolean cc_locale_item_match_language (CcLocaleItem *self, gchar **words);
+
+const gchar *cc_locale_item_get_region (CcLocaleItem *self);
+gboolean cc_locale_item_match_region (CcLocaleItem *self, gchar **words);
+
+G_END_DECLS
@@ -23,6 +23,41 @@
 #include "cc-display-config.h"
 #include <math.h>
 
+typedef struct {
+    CcDisplayMonitor *output;
+    gint x1;
+    gint y1;
+    gint x2;
+    gint y2;
+} SnapOutput;
+
+typedef struct {
+    gint pos;
+    guint output;
+} SnapEdge;
+
+/* The useful outputs of a layout, with their vertical (x) and horizontal (y)
+ * edges sorted by position. Only outputs with an edge close to the dragged
+ * output can be snapped to, so those are found with a binary search instead
+ * of walking the whole layout on every motion event. */
+typedef struct {
+    GArray *outputs;
+    GArray *x_edges;
+    GArray *y_edges;
+    GArray *candidates;
+} SnapIndex;
+
+typedef struct {
+    GskRenderNode *node;
+    gint x1;
+    gint y1;
+    gint x2;
+    gint y2;
+    GtkStateFlags state;
+    gboolean primary;
+    gint num;
+} MonitorNode;
+
 struct _CcDisplayArrangement {
     GtkDrawingArea object;
 
@@ -39,6 +74,11 @@ struct _CcDisplayArrangement {
     gdouble drag_anchor_y;
 
     guint major_snap_distance;
+
+    /* Edges of the other outputs while dragging, see snap_index_new() */
+    SnapIndex *snap_index;
+    /* Rendered outputs, see get_monitor_node() */
+    GHashTable *monitor_nodes;
 };
 
 typedef struct _CcDisplayArrangement CcDisplayArrangement;
@@ -267,120 +307,287 @@ maybe_update_snap (SnapData *snap_data, gint mon_x, gint mon_y, gint new_x, gint
     }
 }
 
+static gint
+snap_edge_compare (gconstpointer a, gconstpointer b)
+{
+    const SnapEdge *edge_a = a;
+    const SnapEdge *edge_b = b;
+
+    if (edge_a->pos != edge_b->pos)
+        return edge_a->pos < edge_b->pos ? -1 : 1;
+
+    return edge_a->output < edge_b->output ? -1 : edge_a->output > edge_b->output;
+}
+
+static gint
+snap_candidate_compare (gconstpointer a, gconstpointer b)
+{
+    const guint *candidate_a = a;
+    const guint *candidate_b = b;
+
+    return *candidate_a < *candidate_b ? -1 : *candidate_a > *candidate_b;
+}
+
 static void
-find_best_snapping (CcDisplayConfig *config, CcDisplayMonitor *snap_output, SnapData *snap_data)
+snap_index_sort_edges (SnapIndex *index)
 {
-    GList *outputs, *l;
-    gint x1, y1, x2, y2;
-    gint w, h;
+    g_array_set_size (index->x_edges, 0);
+    g_array_set_size (index->y_edges, 0);
 
-    g_assert (snap_data != NULL);
+    for (guint i = 0; i < index->outputs->len; i++) {
+        SnapOutput *output = &g_array_index (index->outputs, SnapOutput, i);
+        SnapEdge x_edges[] = { { output->x1, i }, { output->x2, i } };
+        SnapEdge y_edges[] = { { output->y1, i }, { output->y2, i } };
 
-    get_scaled_geometry (config, snap_output, &x1, &y1, &w, &h);
-    x2 = x1 + w;
-    y2 = y1 + h;
+        g_array_append_vals (index->x_edges, x_edges, G_N_ELEMENTS (x_edges));
+        g_array_append_vals (index->y_edges, y_edges, G_N_ELEMENTS (y_edges));
+    }
 
-#define OVERLAP(_s1, _s2, _t1, _t2) ((_s1) <= (_t2) && (_t1) <= (_s2))
+    g_array_sort (index->x_edges, snap_edge_compare);
+    g_array_sort (index->y_edges, snap_edge_compare);
+}
 
-    outputs = cc_display_config_get_monitors (config);
-    for (l = outputs; l; l = l->next) {
+static void
+snap_index_free (SnapIndex *index)
+{
+    g_array_unref (index->outputs);
+    g_array_unref (index->x_edges);
+    g_array_unref (index->y_edges);
+    g_array_unref (index->candidates);
+    g_free (index);
+}
+
+/* Builds the index for all useful outputs but @exclude. It has to be rebuilt
+ * whenever one of these outputs changes. */
+static SnapIndex *
+snap_index_new (CcDisplayConfig *config, CcDisplayMonitor *exclude)
+{
+    SnapIndex *index;
+    GList *l;
+
+    index = g_new0 (SnapIndex, 1);
+    index->outputs = g_array_new (FALSE, FALSE, sizeof (SnapOutput));
+    index->x_edges = g_array_new (FALSE, FALSE, sizeof (SnapEdge));
+    index->y_edges = g_array_new (FALSE, FALSE, sizeof (SnapEdge));
+    index->candidates = g_array_new (FALSE, FALSE, sizeof (guint));
+
+    for (l = cc_display_config_get_monitors (config); l; l = l->next) {
         CcDisplayMonitor *output = l->data;
-        gint _x1, _y1, _x2, _y2, _h, _w;
-        gint bottom_snap_pos;
-        gint top_snap_pos;
-        gint left_snap_pos;
-        gint right_snap_pos;
-        gdouble dist_x, dist_y;
-        gdouble tmp;
-
-        if (output == snap_output)
+        SnapOutput snap_output = { output };
+        gint w, h;
+
+        if (output == exclude || !cc_display_monitor_is_useful (output))
             continue;
 
-        if (!cc_display_monitor_is_useful (output))
+        get_scaled_geometry (config, output, &snap_output.x1, &snap_output.y1, &w, &h);
+        snap_output.x2 = snap_output.x1 + w;
+        snap_output.y2 = snap_output.y1 + h;
+
+        g_array_append_val (index->outputs, snap_output);
+    }
+
+    snap_index_sort_edges (index);
+
+    return index;
+}
+
+static void
+snap_index_move_output (SnapIndex *index, CcDisplayMonitor *output, gint x, gint y)
+{
+    for (guint i = 0; i < index->outputs->len; i++) {
+        SnapOutput *snap_output = &g_array_index (index->outputs, SnapOutput, i);
+
+        if (snap_output->output != output)
             continue;
 
-        get_scaled_geometry (config, output, &_x1, &_y1, &_w, &_h);
-        _x2 = _x1 + _w;
-        _y2 = _y1 + _h;
-
-        top_snap_pos = _y1 - h;
-        bottom_snap_pos = _y2;
-        left_snap_pos = _x1 - w;
-        right_snap_pos = _x2;
-
-        dist_y = 9999;
-        /* overlap on the X axis */
-        if (OVERLAP (x1, x2, _x1, _x2)) {
-            get_snap_distance (snap_data, x1, y1, x1, top_snap_pos, NULL, &dist_y);
-            get_snap_distance (snap_data, x1, y1, x1, bottom_snap_pos, NULL, &tmp);
-            dist_y = MIN (dist_y, tmp);
-        }
+        snap_output->x2 += x - snap_output->x1;
+        snap_output->y2 += y - snap_output->y1;
+        snap_output->x1 = x;
+        snap_output->y1 = y;
 
-        dist_x = 9999;
-        /* overlap on the Y axis */
-        if (OVERLAP (y1, y2, _y1, _y2)) {
-            get_snap_distance (snap_data, x1, y1, left_snap_pos, y1, &dist_x, NULL);
-            get_snap_distance (snap_data, x1, y1, right_snap_pos, y1, &tmp, NULL);
-            dist_x = MIN (dist_x, tmp);
-        }
+        snap_index_sort_edges (index);
+        return;
+    }
+}
 
-        /* We only snap horizontally or vertically to an edge of the same monitor */
-        if (dist_y < dist_x) {
-            maybe_update_snap (snap_data, x1, y1, x1, top_snap_pos, SNAP_DIR_Y, SNAP_DIR_Y, 0);
-            maybe_update_snap (snap_data, x1, y1, x1, bottom_snap_pos, SNAP_DIR_Y, SNAP_DIR_Y, 0);
-        } else if (dist_x < 9999) {
-            maybe_update_snap (snap_data, x1, y1, left_snap_pos, y1, SNAP_DIR_X, SNAP_DIR_X, 0);
-            maybe_update_snap (snap_data, x1, y1, right_snap_pos, y1, SNAP_DIR_X, SNAP_DIR_X, 0);
-        }
+/* Adds the outputs with an edge in [pos - range, pos + range] to the candidates */
+static void
+snap_index_add_candidates (SnapIndex *index, GArray *edges, gint pos, gint range)
+{
+    guint lower = 0;
+    guint upper = edges->len;
+
+    while (lower < upper) {
+        guint middle = lower + (upper - lower) / 2;
 
-        /* Left/right edge identical on the top */
-        maybe_update_snap (snap_data, x1, y1, _x1, top_snap_pos, SNAP_DIR_BOTH, SNAP_DIR_Y, 0);
-        maybe_update_snap (snap_data, x1, y1, _x2 - w, top_snap_pos, SNAP_DIR_BOTH, SNAP_DIR_Y, 0);
+        if (g_array_index (edges, SnapEdge, middle).pos < pos - range)
+            lower = middle + 1;
+        else
+            upper = middle;
+    }
 
-        /* Centers aligned on the top */
-        maybe_update_snap (snap_data, x1, y1, _x1 + _w / 2 - w / 2, top_snap_pos, SNAP_DIR_BOTH, SNAP_DIR_Y, 0);
+    for (; lower < edges->len; lower++) {
+        SnapEdge *edge = &g_array_index (edges, SnapEdge, lower);
 
-        /* Left/right edge identical on the bottom */
-        maybe_update_snap (snap_data, x1, y1, _x1, bottom_snap_pos, SNAP_DIR_BOTH, SNAP_DIR_Y, 0);
-        maybe_update_snap (snap_data, x1, y1, _x2 - w, bottom_snap_pos, SNAP_DIR_BOTH, SNAP_DIR_Y, 0);
+        if (edge->pos > pos + range)
+            break;
+
+        g_array_append_val (index->candidates, edge->output);
+    }
+}
+
+static void
+snap_to_output (SnapData *snap_data, SnapOutput *output, gint x1, gint y1, gint w, gint h)
+{
+    gint x2 = x1 + w;
+    gint y2 = y1 + h;
+    gint _x1, _y1, _x2, _y2, _h, _w;
+    gint bottom_snap_pos;
+    gint top_snap_pos;
+    gint left_snap_pos;
+    gint right_snap_pos;
+    gdouble dist_x, dist_y;
+    gdouble tmp;
 
-        /* Centers aligned on the bottom */
-        maybe_update_snap (snap_data, x1, y1, _x1 + _w / 2 - w / 2, bottom_snap_pos, SNAP_DIR_BOTH, SNAP_DIR_Y, 0);
+#define OVERLAP(_s1, _s2, _t1, _t2) ((_s1) <= (_t2) && (_t1) <= (_s2))
+
+    _x1 = output->x1;
+    _y1 = output->y1;
+    _x2 = output->x2;
+    _y2 = output->y2;
+    _w = _x2 - _x1;
+    _h = _y2 - _y1;
+
+    top_snap_pos = _y1 - h;
+    bottom_snap_pos = _y2;
+    left_snap_pos = _x1 - w;
+    right_snap_pos = _x2;
+
+    dist_y = 9999;
+    /* overlap on the X axis */
+    if (OVERLAP (x1, x2, _x1, _x2)) {
+        get_snap_distance (snap_data, x1, y1, x1, top_snap_pos, NULL, &dist_y);
+        get_snap_distance (snap_data, x1, y1, x1, bottom_snap_pos, NULL, &tmp);
+        dist_y = MIN (dist_y, tmp);
+    }
+
+    dist_x = 9999;
+    /* overlap on the Y axis */
+    if (OVERLAP (y1, y2, _y1, _y2)) {
+        get_snap_distance (snap_data, x1, y1, left_snap_pos, y1, &dist_x, NULL);
+        get_snap_distance (snap_data, x1, y1, right_snap_pos, y1, &tmp, NULL);
+        dist_x = MIN (dist_x, tmp);
+    }
+
+    /* We only snap horizontally or vertically to an edge of the same monitor */
+    if (dist_y < dist_x) {
+        maybe_update_snap (snap_data, x1, y1, x1, top_snap_pos, SNAP_DIR_Y, SNAP_DIR_Y, 0);
+        maybe_update_snap (snap_data, x1, y1, x1, bottom_snap_pos, SNAP_DIR_Y, SNAP_DIR_Y, 0);
+    } else if (dist_x < 9999) {
+        maybe_update_snap (snap_data, x1, y1, left_snap_pos, y1, SNAP_DIR_X, SNAP_DIR_X, 0);
+        maybe_update_snap (snap_data, x1, y1, right_snap_pos, y1, SNAP_DIR_X, SNAP_DIR_X, 0);
+    }
+
+    /* Left/right edge identical on the top */
+    maybe_update_snap (snap_data, x1, y1, _x1, top_snap_pos, SNAP_DIR_BOTH, SNAP_DIR_Y, 0);
+    maybe_update_snap (snap_data, x1, y1, _x2 - w, top_snap_pos, SNAP_DIR_BOTH, SNAP_DIR_Y, 0);
+
+    /* Centers aligned on the top */
+    maybe_update_snap (snap_data, x1, y1, _x1 + _w / 2 - w / 2, top_snap_pos, SNAP_DIR_BOTH, SNAP_DIR_Y, 0);
+
+    /* Left/right edge identical on the bottom */
+    maybe_update_snap (snap_data, x1, y1, _x1, bottom_snap_pos, SNAP_DIR_BOTH, SNAP_DIR_Y, 0);
+    maybe_update_snap (snap_data, x1, y1, _x2 - w, bottom_snap_pos, SNAP_DIR_BOTH, SNAP_DIR_Y, 0);
+
+    /* Centers aligned on the bottom */
+    maybe_update_snap (snap_data, x1, y1, _x1 + _w / 2 - w / 2, bottom_snap_pos, SNAP_DIR_BOTH, SNAP_DIR_Y, 0);
+
+    /* Top/bottom edge identical on the left */
+    maybe_update_snap (snap_data, x1, y1, left_snap_pos, _y1, SNAP_DIR_BOTH, SNAP_DIR_X, 0);
+    maybe_update_snap (snap_data, x1, y1, left_snap_pos, _y2 - h, SNAP_DIR_BOTH, SNAP_DIR_X, 0);
+
+    /* Top/bottom edge identical on the right */
+    maybe_update_snap (snap_data, x1, y1, right_snap_pos, _y1, SNAP_DIR_BOTH, SNAP_DIR_X, 0);
+    maybe_update_snap (snap_data, x1, y1, right_snap_pos, _y2 - h, SNAP_DIR_BOTH, SNAP_DIR_X, 0);
+
+    /* If snapping is infinite, then add snapping points with minimal overlap
+     * to prevent detachment.
+     * This is similar to the above but simply re-defines the snapping pos
+     * to have only minimal overlap */
+    if (snap_data->major_snap_distance == G_MAXUINT) {
+        /* Hanging over the left/right edge on the top */
+        maybe_update_snap (snap_data, x1, y1, _x1 - w + MIN_OVERLAP, top_snap_pos, SNAP_DIR_BOTH, SNAP_DIR_Y, 1);
+        maybe_update_snap (snap_data, x1, y1, _x2 - MIN_OVERLAP, top_snap_pos, SNAP_DIR_BOTH, SNAP_DIR_Y, -1);
+
+        /* Left/right edge identical on the bottom */
+        maybe_update_snap (snap_data, x1, y1, _x1 - w + MIN_OVERLAP, bottom_snap_pos, SNAP_DIR_BOTH, SNAP_DIR_Y, 1);
+        maybe_update_snap (snap_data, x1, y1, _x2 - MIN_OVERLAP, bottom_snap_pos, SNAP_DIR_BOTH, SNAP_DIR_Y, -1);
 
         /* Top/bottom edge identical on the left */
-        maybe_update_snap (snap_data, x1, y1, left_snap_pos, _y1, SNAP_DIR_BOTH, SNAP_DIR_X, 0);
-        maybe_update_snap (snap_data, x1, y1, left_snap_pos, _y2 - h, SNAP_DIR_BOTH, SNAP_DIR_X, 0);
+        maybe_update_snap (snap_data, x1, y1, left_snap_pos, _y1 - h + MIN_OVERLAP, SNAP_DIR_BOTH, SNAP_DIR_X, 1);
+        maybe_update_snap (snap_data, x1, y1, left_snap_pos, _y2 - MIN_OVERLAP, SNAP_DIR_BOTH, SNAP_DIR_X, -1);
 
         /* Top/bottom edge identical on the right */
-        maybe_update_snap (snap_data, x1, y1, right_snap_pos, _y1, SNAP_DIR_BOTH, SNAP_DIR_X, 0);
-        maybe_update_snap (snap_data, x1, y1, right_snap_pos, _y2 - h, SNAP_DIR_BOTH, SNAP_DIR_X, 0);
-
-        /* If snapping is infinite, then add snapping points with minimal overlap
-         * to prevent detachment.
-         * This is similar to the above but simply re-defines the snapping pos
-         * to have only minimal overlap */
-        if (snap_data->major_snap_distance == G_MAXUINT) {
-            /* Hanging over the left/right edge on the top */
-            maybe_update_snap (snap_data, x1, y1, _x1 - w + MIN_OVERLAP, top_snap_pos, SNAP_DIR_BOTH, SNAP_DIR_Y, 1);
-            maybe_update_snap (snap_data, x1, y1, _x2 - MIN_OVERLAP, top_snap_pos, SNAP_DIR_BOTH, SNAP_DIR_Y, -1);
-
-            /* Left/right edge identical on the bottom */
-            maybe_update_snap (snap_data, x1, y1, _x1 - w + MIN_OVERLAP, bottom_snap_pos, SNAP_DIR_BOTH, SNAP_DIR_Y, 1);
-            maybe_update_snap (snap_data, x1, y1, _x2 - MIN_OVERLAP, bottom_snap_pos, SNAP_DIR_BOTH, SNAP_DIR_Y, -1);
-
-            /* Top/bottom edge identical on the left */
-            maybe_update_snap (snap_data, x1, y1, left_snap_pos, _y1 - h + MIN_OVERLAP, SNAP_DIR_BOTH, SNAP_DIR_X, 1);
-            maybe_update_snap (snap_data, x1, y1, left_snap_pos, _y2 - MIN_OVERLAP, SNAP_DIR_BOTH, SNAP_DIR_X, -1);
-
-            /* Top/bottom edge identical on the right */
-            maybe_update_snap (snap_data, x1, y1, right_snap_pos, _y1 - h + MIN_OVERLAP, SNAP_DIR_BOTH, SNAP_DIR_X, 1);
-            maybe_update_snap (snap_data, x1, y1, right_snap_pos, _y2 - MIN_OVERLAP, SNAP_DIR_BOTH, SNAP_DIR_X, -1);
-        }
+        maybe_update_snap (snap_data, x1, y1, right_snap_pos, _y1 - h + MIN_OVERLAP, SNAP_DIR_BOTH, SNAP_DIR_X, 1);
+        maybe_update_snap (snap_data, x1, y1, right_snap_pos, _y2 - MIN_OVERLAP, SNAP_DIR_BOTH, SNAP_DIR_X, -1);
     }
 
 #undef OVERLAP
 }
 
+static void
+find_best_snapping (SnapIndex *index, CcDisplayConfig *config, CcDisplayMonitor *snap_output, SnapData *snap_data)
+{
+    gint x1, y1, x2, y2;
+    gint w, h;
+    gdouble scale_x = 1.0;
+    gdouble scale_y = 1.0;
+    gint range;
+    guint i;
+
+    g_assert (snap_data != NULL);
+
+    get_scaled_geometry (config, snap_output, &x1, &y1, &w, &h);
+    x2 = x1 + w;
+    y2 = y1 + h;
+
+    if (snap_data->major_snap_distance == G_MAXUINT) {
+        for (i = 0; i < index->outputs->len; i++) {
+            SnapOutput *output = &g_array_index (index->outputs, SnapOutput, i);
+
+            if (output->output != snap_output)
+                snap_to_output (snap_data, output, x1, y1, w, h);
+        }
+
+        return;
+    }
+
+    /* Every snapping position puts an edge of the output onto an edge of
+     * another output, which must be within the major snap distance. */
+    cairo_matrix_transform_distance (&snap_data->to_widget, &scale_x, &scale_y);
+    range = MIN (snap_data->major_snap_distance / MIN (fabs (scale_x), fabs (scale_y)) + 1, G_MAXINT / 4);
+
+    g_array_set_size (index->candidates, 0);
+    snap_index_add_candidates (index, index->x_edges, x1, range);
+    snap_index_add_candidates (index, index->x_edges, x2, range);
+    snap_index_add_candidates (index, index->y_edges, y1, range);
+    snap_index_add_candidates (index, index->y_edges, y2, range);
+
+    /* Equally good snapping positions are resolved by the order of the outputs */
+    g_array_sort (index->candidates, snap_candidate_compare);
+
+    for (i = 0; i < index->candidates->len; i++) {
+        guint candidate = g_array_index (index->candidates, guint, i);
+        SnapOutput *output = &g_array_index (index->outputs, SnapOutput, candidate);
+
+        if (i > 0 && candidate == g_array_index (index->candidates, guint, i - 1))
+            continue;
+
+        if (output->output != snap_output)
+            snap_to_output (snap_data, output, x1, y1, w, h);
+    }
+}
+
 static void
 cc_display_arrangement_update_matrices (CcDisplayArrangement *self)
 {
@@ -441,6 +648,10 @@ cc_display_arrangement_find_monitor_at (CcDisplayArrangement *self, gint x, gint
 static void
 on_output_changed_cb (CcDisplayArrangement *self, CcDisplayMonitor *output)
 {
+    /* The dragged output is not part of the index */
+    if (!self->drag_active || output != self->selected_output)
+        g_clear_pointer (&self->snap_index, snap_index_free);
+
     if (cc_display_config_count_useful_monitors (self->config) > 2)
         self->major_snap_distance = MAJOR_SNAP_DISTANCE;
     else
@@ -450,131 +661,193 @@ on_output_changed_cb (CcDisplayArrangement *self, CcDisplayMonitor *output)
 }
 
 static void
-cc_display_arrangement_draw (GtkDrawingArea *drawing_area, cairo_t *cr, gint width, gint height, gpointer user_data)
+monitor_node_free (MonitorNode *monitor_node)
+{
+    gsk_render_node_unref (monitor_node->node);
+    g_free (monitor_node);
+}
+
+static void
+draw_monitor (CcDisplayArrangement *self, cairo_t *cr, MonitorNode *monitor_node)
 {
-    CcDisplayArrangement *self = CC_DISPLAY_ARRANGEMENT (drawing_area);
     GtkStyleContext *context = gtk_widget_get_style_context (GTK_WIDGET (self));
-    g_autoptr(GList) outputs = NULL;
-    GList *l;
+    GtkBorder border, padding, margin;
+    gint w, h;
 
-    if (!self->config)
-        return;
+    gtk_style_context_save (context);
 
-    cc_display_arrangement_update_matrices (self);
+    gtk_style_context_add_class (context, "monitor");
+    gtk_style_context_set_state (context, monitor_node->state);
+    if (monitor_node->primary)
+        gtk_style_context_add_class (context, "primary");
 
-    /* Draw in reverse order so that hit detection matches visual. Also pull
-     * the selected output to the back. */
-    outputs = g_list_copy (cc_display_config_get_monitors (self->config));
-    outputs = g_list_remove (outputs, self->selected_output);
-    if (self->selected_output != NULL)
-        outputs = g_list_prepend (outputs, self->selected_output);
-    outputs = g_list_reverse (outputs);
+    w = monitor_node->x2 - monitor_node->x1;
+    h = monitor_node->y2 - monitor_node->y1;
 
-    for (l = outputs; l; l = l->next) {
-        CcDisplayMonitor *output = l->data;
-        GtkStateFlags state = GTK_STATE_FLAG_NORMAL;
-        GtkBorder border, padding, margin;
-        gint x1, y1, x2, y2;
-        gint w, h;
-        gint num;
+    cairo_translate (cr, monitor_node->x1, monitor_node->y1);
 
-        if (!cc_display_monitor_is_useful (output))
-            continue;
+    gtk_style_context_get_margin (context, &margin);
 
-        gtk_style_context_save (context);
-        cairo_save (cr);
+    cairo_translate (cr, margin.left, margin.top);
 
-        gtk_style_context_add_class (context, "monitor");
+    w -= margin.left + margin.right;
+    h -= margin.top + margin.bottom;
 
-        if (output == self->selected_output)
-            state |= GTK_STATE_FLAG_SELECTED;
-        if (output == self->prelit_output)
-            state |= GTK_STATE_FLAG_PRELIGHT;
+    gtk_render_background (context, cr, 0, 0, w, h);
+    gtk_render_frame (context, cr, 0, 0, w, h);
 
-        gtk_style_context_set_state (context, state);
-        if (cc_display_monitor_is_primary (output) || cc_display_config_is_cloning (self->config))
-            gtk_style_context_add_class (context, "primary");
+    gtk_style_context_get_border (context, &border);
+    gtk_style_context_get_padding (context, &padding);
 
-        /* Set in cc-display-panel.c */
-        num = cc_display_monitor_get_ui_number (output);
+    w -= border.left + border.right + padding.left + padding.right;
+    h -= border.top + border.bottom + padding.top + padding.bottom;
 
-        monitor_get_drawing_rect (self, output, &x1, &y1, &x2, &y2);
-        w = x2 - x1;
-        h = y2 - y1;
+    cairo_translate (cr, border.left + padding.left, border.top + padding.top);
+
+    if (monitor_node->num > 0) {
+        PangoLayout *layout;
+        g_autofree gchar *number_str = NULL;
+        PangoRectangle extents;
+        GdkRGBA color;
+        gdouble text_width, text_padding;
+
+        gtk_style_context_add_class (context, "monitor-label");
+        gtk_style_context_remove_class (context, "monitor");
+
+        gtk_style_context_get_border (context, &border);
+        gtk_style_context_get_padding (context, &padding);
+
+        cairo_translate (cr, w / 2, h / 2);
+
+        number_str = g_strdup_printf ("%d", monitor_node->num);
+        layout = gtk_widget_create_pango_layout (GTK_WIDGET (self), number_str);
+        pango_layout_get_extents (layout, NULL, &extents);
 
-        cairo_translate (cr, x1, y1);
+        h = (extents.height - extents.y) / PANGO_SCALE;
+        text_width = (extents.width - extents.x) / PANGO_SCALE;
+        w = MAX (text_width, h - padding.left - padding.right);
+        text_padding = w - text_width;
 
-        gtk_style_context_get_margin (context, &margin);
+        w += border.left + border.right + padding.left + padding.right;
+        h += border.top + border.bottom + padding.top + padding.bottom;
 
-        cairo_translate (cr, margin.left, margin.top);
+        /* Enforce evenness */
+        if ((w % 2) != 0)
+            w++;
+        if ((h % 2) != 0)
+            h++;
 
-        w -= margin.left + margin.right;
-        h -= margin.top + margin.bottom;
+        cairo_translate (cr, -w / 2, -h / 2);
 
         gtk_render_background (context, cr, 0, 0, w, h);
         gtk_render_frame (context, cr, 0, 0, w, h);
 
-        gtk_style_context_get_border (context, &border);
-        gtk_style_context_get_padding (context, &padding);
+        cairo_translate (cr, border.left + padding.left, border.top + padding.top);
+        cairo_translate (cr, extents.x + text_padding / 2, 0);
 
-        w -= border.left + border.right + padding.left + padding.right;
-        h -= border.top + border.bottom + padding.top + padding.bottom;
+        gtk_style_context_get_color (context, &color);
+        gdk_cairo_set_source_rgba (cr, &color);
 
-        cairo_translate (cr, border.left + padding.left, border.top + padding.top);
+        gtk_render_layout (context, cr, 0, 0, layout);
+        g_object_unref (layout);
+    }
+
+    gtk_style_context_restore (context);
+}
 
-        if (num > 0) {
-            PangoLayout *layout;
-            g_autofree gchar *number_str = NULL;
-            PangoRectangle extents;
-            GdkRGBA color;
-            gdouble text_width, text_padding;
+/* Each output is drawn into its own node, which is reused until the output
+ * moves or its state changes. While dragging, only the dragged output needs
+ * to be drawn again. */
+static GskRenderNode *
+get_monitor_node (CcDisplayArrangement *self, CcDisplayMonitor *output, gboolean cloning)
+{
+    MonitorNode *monitor_node;
+    GtkStateFlags state = GTK_STATE_FLAG_NORMAL;
+    gboolean primary;
+    gint x1, y1, x2, y2;
+    gint num;
+    cairo_t *cr;
 
-            gtk_style_context_add_class (context, "monitor-label");
-            gtk_style_context_remove_class (context, "monitor");
+    if (output == self->selected_output)
+        state |= GTK_STATE_FLAG_SELECTED;
+    if (output == self->prelit_output)
+        state |= GTK_STATE_FLAG_PRELIGHT;
 
-            gtk_style_context_get_border (context, &border);
-            gtk_style_context_get_padding (context, &padding);
+    primary = cc_display_monitor_is_primary (output) || cloning;
 
-            cairo_translate (cr, w / 2, h / 2);
+    /* Set in cc-display-panel.c */
+    num = cc_display_monitor_get_ui_number (output);
 
-            number_str = g_strdup_printf ("%d", num);
-            layout = gtk_widget_create_pango_layout (GTK_WIDGET (self), number_str);
-            pango_layout_get_extents (layout, NULL, &extents);
+    monitor_get_drawing_rect (self, output, &x1, &y1, &x2, &y2);
 
-            h = (extents.height - extents.y) / PANGO_SCALE;
-            text_width = (extents.width - extents.x) / PANGO_SCALE;
-            w = MAX (text_width, h - padding.left - padding.right);
-            text_padding = w - text_width;
+    monitor_node = g_hash_table_lookup (self->monitor_nodes, output);
+    if (monitor_node && monitor_node->x1 == x1 && monitor_node->y1 == y1 && monitor_node->x2 == x2
+        && monitor_node->y2 == y2 && monitor_node->state == state && monitor_node->primary == primary
+        && monitor_node->num == num)
+        return monitor_node->node;
 
-            w += border.left + border.right + padding.left + padding.right;
-            h += border.top + border.bottom + padding.top + padding.bottom;
+    monitor_node = g_new0 (MonitorNode, 1);
+    monitor_node->x1 = x1;
+    monitor_node->y1 = y1;
+    monitor_node->x2 = x2;
+    monitor_node->y2 = y2;
+    monitor_node->state = state;
+    monitor_node->primary = primary;
+    monitor_node->num = num;
 
-            /* Enforce evenness */
-            if ((w % 2) != 0)
-                w++;
-            if ((h % 2) != 0)
-                h++;
+    monitor_node->node = gsk_cairo_node_new (&GRAPHENE_RECT_INIT (x1, y1, x2 - x1, y2 - y1));
+    cr = gsk_cairo_node_get_draw_context (monitor_node->node);
+    draw_monitor (self, cr, monitor_node);
+    cairo_destroy (cr);
 
-            cairo_translate (cr, -w / 2, -h / 2);
+    g_hash_table_replace (self->monitor_nodes, output, monitor_node);
 
-            gtk_render_background (context, cr, 0, 0, w, h);
-            gtk_render_frame (context, cr, 0, 0, w, h);
+    return monitor_node->node;
+}
 
-            cairo_translate (cr, border.left + padding.left, border.top + padding.top);
-            cairo_translate (cr, extents.x + text_padding / 2, 0);
+static void
+cc_display_arrangement_snapshot (GtkWidget *widget, GtkSnapshot *snapshot)
+{
+    CcDisplayArrangement *self = CC_DISPLAY_ARRANGEMENT (widget);
+    g_autoptr(GList) outputs = NULL;
+    gboolean cloning;
+    GList *l;
 
-            gtk_style_context_get_color (context, &color);
-            gdk_cairo_set_source_rgba (cr, &color);
+    if (!self->config)
+        return;
 
-            gtk_render_layout (context, cr, 0, 0, layout);
-            g_object_unref (layout);
-        }
+    cc_display_arrangement_update_matrices (self);
 
-        gtk_style_context_restore (context);
-        cairo_restore (cr);
+    /* Draw in reverse order so that hit detection matches visual. Also pull
+     * the selected output to the back. */
+    outputs = g_list_copy (cc_display_config_get_monitors (self->config));
+    outputs = g_list_remove (outputs, self->selected_output);
+    if (self->selected_output != NULL)
+        outputs = g_list_prepend (outputs, self->selected_output);
+    outputs = g_list_reverse (outputs);
+
+    cloning = cc_display_config_is_cloning (self->config);
+
+    for (l = outputs; l; l = l->next) {
+        CcDisplayMonitor *output = l->data;
+
+        if (!cc_display_monitor_is_useful (output))
+            continue;
+
+        gtk_snapshot_append_node (snapshot, get_monitor_node (self, output, cloning));
     }
 }
 
+static void
+cc_display_arrangement_css_changed (GtkWidget *widget, GtkCssStyleChange *change)
+{
+    CcDisplayArrangement *self = CC_DISPLAY_ARRANGEMENT (widget);
+
+    GTK_WIDGET_CLASS (cc_display_arrangement_parent_class)->css_changed (widget, change);
+
+    g_hash_table_remove_all (self->monitor_nodes);
+}
+
 static gboolean
 on_click_gesture_pressed_cb (CcDisplayArrangement *self, gint n_press, gdouble x, gdouble y)
 {
@@ -600,6 +873,7 @@ on_click_gesture_pressed_cb (CcDisplayArrangement *self, gint n_press, gdouble x
     cc_display_arrangement_set_selected_output (self, output);
 
     if (cc_display_config_count_useful_monitors (self->config) > 1) {
+        g_clear_pointer (&self->snap_index, snap_index_free);
         self->drag_active = TRUE;
         self->drag_anchor_x = event_x - mon_x;
         self->drag_anchor_y = event_y - mon_y;
@@ -680,7 +954,10 @@ on_motion_controller_motion_cb (CcDisplayArrangement *self, gdouble x, gdouble y
 
     cc_display_monitor_set_position (self->selected_output, mon_x, mon_y);
 
-    find_best_snapping (self->config, self->selected_output, &snap_data);
+    if (!self->snap_index)
+        self->snap_index = snap_index_new (self->config, self->selected_output);
+
+    find_best_snapping (self->snap_index, self->config, self->selected_output, &snap_data);
 
     cc_display_monitor_set_position (self->selected_output, snap_data.mon_x, snap_data.mon_y);
 
@@ -731,6 +1008,8 @@ cc_display_arrangement_finalize (GObject *object)
     CcDisplayArrangement *self = CC_DISPLAY_ARRANGEMENT (object);
 
     g_clear_object (&self->config);
+    g_clear_pointer (&self->snap_index, snap_index_free);
+    g_clear_pointer (&self->monitor_nodes, g_hash_table_unref);
 
     G_OBJECT_CLASS (cc_display_arrangement_parent_class)->finalize (object);
 }
@@ -739,11 +1018,15 @@ static void
 cc_display_arrangement_class_init (CcDisplayArrangementClass *klass)
 {
     GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+    GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
 
     gobject_class->finalize = cc_display_arrangement_finalize;
     gobject_class->get_property = cc_display_arrangement_get_property;
     gobject_class->set_property = cc_display_arrangement_set_property;
 
+    widget_class->snapshot = cc_display_arrangement_snapshot;
+    widget_class->css_changed = cc_display_arrangement_css_changed;
+
     props[PROP_CONFIG] =
         g_param_spec_object ("config", NULL, NULL, CC_TYPE_DISPLAY_CONFIG, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
 
@@ -754,7 +1037,7 @@ cc_display_arrangement_class_init (CcDisplayArrangementClass *klass)
 
     g_signal_new ("updated", CC_TYPE_DISPLAY_ARRANGEMENT, G_SIGNAL_RUN_LAST, 0, NULL, NULL, NULL, G_TYPE_NONE, 0);
 
-    gtk_widget_class_set_css_name (GTK_WIDGET_CLASS (klass), "display-arrangement");
+    gtk_widget_class_set_css_name (widget_class, "display-arrangement");
 }
 
 static void
@@ -772,9 +1055,8 @@ cc_display_arrangement_init (CcDisplayArrangement *self)
     g_signal_connect_swapped (motion_controller, "motion", G_CALLBACK (on_motion_controller_motion_cb), self);
     gtk_widget_add_controller (GTK_WIDGET (self), motion_controller);
 
-    gtk_drawing_area_set_draw_func (GTK_DRAWING_AREA (self), cc_display_arrangement_draw, self, NULL);
-
     self->major_snap_distance = MAJOR_SNAP_DISTANCE;
+    self->monitor_nodes = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) monitor_node_free);
 }
 
 CcDisplayArrangement *
@@ -805,6 +1087,8 @@ cc_display_arrangement_set_config (CcDisplayArrangement *self, CcDisplayConfig *
         }
     }
     g_clear_object (&self->config);
+    g_clear_pointer (&self->snap_index, snap_index_free);
+    g_hash_table_remove_all (self->monitor_nodes);
 
     self->drag_active = FALSE;
 
@@ -847,7 +1131,7 @@ cc_display_arrangement_set_selected_output (CcDisplayArrangement *self, CcDispla
 }
 
 static gboolean
-try_snap_output (CcDisplayConfig *config, CcDisplayMonitor *output)
+try_snap_output (CcDisplayConfig *config, SnapIndex *index, CcDisplayMonitor *output)
 {
     SnapData snap_data;
     gint x, y, w, h;
@@ -865,10 +1149,11 @@ try_snap_output (CcDisplayConfig *config, CcDisplayMonitor *output)
     cairo_matrix_init_identity (&snap_data.to_widget);
     snap_data.major_snap_distance = G_MAXUINT;
 
-    find_best_snapping (config, output, &snap_data);
+    find_best_snapping (index, config, output, &snap_data);
 
     if (x != snap_data.mon_x || y != snap_data.mon_y) {
         cc_display_monitor_set_position (output, snap_data.mon_x, snap_data.mon_y);
+        snap_index_move_output (index, output, snap_data.mon_x, snap_data.mon_y);
         return TRUE;
     }
 
@@ -878,12 +1163,17 @@ try_snap_output (CcDisplayConfig *config, CcDisplayMonitor *output)
 void
 cc_display_config_snap_outputs (CcDisplayConfig *config)
 {
+    SnapIndex *index;
     GList *l;
 
     if (cc_display_config_count_useful_monitors (config) <= 1)
         return;
 
+    index = snap_index_new (config, NULL);
+
     for (l = cc_display_config_get_monitors (config); l; l = l->next) {
-        try_snap_output (config, l->data);
+        try_snap_output (config, index, l->data);
     }
+
+    snap_index_free (index);
 }
@@ -154,6 +154,9 @@ struct _CcDisplayConfig {
     CcDisplayMonitor *primary;
 
     GHashTable *logical_monitors;
+
+    /* Supported scales of the modes, see intern_scales() */
+    GHashTable *scale_tables;
 };
 
 G_DEFINE_FINAL_TYPE (CcDisplayMode, cc_display_mode, G_TYPE_OBJECT)
@@ -255,7 +258,6 @@ make_output_ui_name (CcDisplayMonitor *output)
 static void
 cc_display_mode_init (CcDisplayMode *self)
 {
-    self->supported_scales = g_array_new (FALSE, FALSE, sizeof (double));
 }
 
 static void
@@ -264,7 +266,7 @@ cc_display_mode_finalize (GObject *object)
     CcDisplayMode *self = CC_DISPLAY_MODE (object);
 
     g_free (self->id);
-    g_array_free (self->supported_scales, TRUE);
+    g_clear_pointer (&self->supported_scales, g_array_unref);
 
     G_OBJECT_CLASS (cc_display_mode_parent_class)->finalize (object);
 }
@@ -311,14 +313,12 @@ is_scale_allowed_by_active_monitors (CcDisplayConfig *self, CcDisplayMode *mode,
 {
     GList *l;
 
+    /* The result is the same for every active monitor */
     for (l = self->monitors; l != NULL; l = l->next) {
         CcDisplayMonitor *m = CC_DISPLAY_MONITOR (l->data);
 
-        if (!cc_display_monitor_is_active (CC_DISPLAY_MONITOR (m)))
-            continue;
-
-        if (!cc_display_mode_is_supported_scale (mode, scale))
-            return FALSE;
+        if (cc_display_monitor_is_active (CC_DISPLAY_MONITOR (m)))
+            return cc_display_mode_is_supported_scale (mode, scale);
     }
 
     return TRUE;
@@ -416,10 +416,30 @@ cc_display_mode_new_virtual (int width, int height, double preferred_scale, GArr
     return self;
 }
 
+/* Monitors advertise the same few lists of scales for most of their modes,
+ * and identical monitors advertise identical lists. Modes share one array
+ * per list, which is never modified. */
+static GArray *
+intern_scales (CcDisplayConfig *self, GArray *scales)
+{
+    g_autoptr(GBytes) key = NULL;
+    GArray *interned;
+
+    key = g_bytes_new (scales->data, scales->len * sizeof (double));
+    interned = g_hash_table_lookup (self->scale_tables, key);
+    if (!interned) {
+        interned = g_array_copy (scales);
+        g_hash_table_insert (self->scale_tables, g_steal_pointer (&key), interned);
+    }
+
+    return g_array_ref (interned);
+}
+
 static CcDisplayMode *
 cc_display_mode_new (CcDisplayMonitor *monitor, GVariant *variant)
 {
     double d;
+    g_autoptr(GArray) scales = NULL;
     g_autoptr(GVariantIter) scales_iter = NULL;
     g_autoptr(GVariant) properties_variant = NULL;
     gboolean is_current;
@@ -434,8 +454,10 @@ cc_display_mode_new (CcDisplayMonitor *monitor, GVariant *variant)
     g_variant_get (variant, "(" MODE_BASE_FORMAT "@a{sv})", &self->id, &self->width, &self->height, &self->refresh_rate,
                    &self->preferred_scale, &scales_iter, &properties_variant);
 
+    scales = g_array_new (FALSE, FALSE, sizeof (double));
     while (g_variant_iter_next (scales_iter, "d", &d))
-        g_array_append_val (self->supported_scales, d);
+        g_array_append_val (scales, d);
+    self->supported_scales = intern_scales (monitor->config, scales);
 
     if (!g_variant_lookup (properties_variant, "is-current", "b", &is_current))
         is_current = FALSE;
@@ -1362,11 +1384,58 @@ construct_monitors (CcDisplayConfig *self, GVariantIter *monitors, GVariantIter
     }
 }
 
+typedef struct {
+    GArray *scales;
+    int width;
+    int height;
+    double scale;
+} ScaledMode;
+
+static guint
+scaled_mode_hash (gconstpointer key)
+{
+    const ScaledMode *scaled_mode = key;
+
+    return g_direct_hash (scaled_mode->scales) ^ (scaled_mode->width * 31 + scaled_mode->height)
+           ^ g_double_hash (&scaled_mode->scale);
+}
+
+static gboolean
+scaled_mode_equal (gconstpointer a, gconstpointer b)
+{
+    const ScaledMode *scaled_mode_a = a;
+    const ScaledMode *scaled_mode_b = b;
+
+    return scaled_mode_a->scales == scaled_mode_b->scales && scaled_mode_a->width == scaled_mode_b->width
+           && scaled_mode_a->height == scaled_mode_b->height && scaled_mode_a->scale == scaled_mode_b->scale;
+}
+
+/* Whether a mode is allowed at a scale only depends on its resolution and
+ * its supported scales, which most modes share with other modes. */
+static gboolean
+is_scaled_mode_allowed_cached (CcDisplayConfig *self, GHashTable *cache, CcDisplayMode *mode, double scale)
+{
+    ScaledMode key = { mode->supported_scales, mode->width, mode->height, scale };
+    gpointer allowed;
+
+    if (!g_hash_table_lookup_extended (cache, &key, NULL, &allowed)) {
+        allowed = GINT_TO_POINTER (is_scaled_mode_allowed (self, mode, scale));
+        g_hash_table_insert (cache, g_memdup2 (&key, sizeof (key)), allowed);
+    }
+
+    return GPOINTER_TO_INT (allowed);
+}
+
 static void
 filter_out_invalid_scaled_modes (CcDisplayConfig *self)
 {
+    g_autoptr(GHashTable) cache = NULL;
+    g_autoptr(GArray) scales = NULL;
     GList *l;
 
+    cache = g_hash_table_new_full (scaled_mode_hash, scaled_mode_equal, g_free, NULL);
+    scales = g_array_new (FALSE, FALSE, sizeof (double));
+
     for (l = self->monitors; l; l = l->next) {
         CcDisplayMonitor *monitor = l->data;
         GList *ll = monitor->modes;
@@ -1380,7 +1449,7 @@ filter_out_invalid_scaled_modes (CcDisplayConfig *self)
             ll = ll->next;
 
             if (monitor->current_mode != CC_DISPLAY_MODE (mode) && monitor->preferred_mode != CC_DISPLAY_MODE (mode)
-                && !is_scaled_mode_allowed (self, mode, 1.0)) {
+                && !is_scaled_mode_allowed_cached (self, cache, mode, 1.0)) {
                 g_clear_object (&mode);
                 monitor->modes = g_list_delete_link (monitor->modes, current);
                 continue;
@@ -1389,15 +1458,20 @@ filter_out_invalid_scaled_modes (CcDisplayConfig *self)
             if (monitor->current_mode == CC_DISPLAY_MODE (mode))
                 current_scale = cc_display_monitor_get_scale (CC_DISPLAY_MONITOR (monitor));
 
-            for (i = mode->supported_scales->len - 1; i >= 0; i--) {
-                float scale = g_array_index (mode->supported_scales, double, i);
+            g_array_set_size (scales, 0);
+            for (i = 0; i < mode->supported_scales->len; i++) {
+                double scale = g_array_index (mode->supported_scales, double, i);
 
-                if (!cc_display_same_scale (scale, current_scale)
-                    && !cc_display_same_scale (scale, mode->preferred_scale)
-                    && !is_scaled_mode_allowed (self, mode, scale)) {
-                    g_array_remove_index (mode->supported_scales, i);
+                if (cc_display_same_scale (scale, current_scale) || cc_display_same_scale (scale, mode->preferred_scale)
+                    || is_scaled_mode_allowed_cached (self, cache, mode, scale)) {
+                    g_array_append_val (scales, scale);
                 }
             }
+
+            if (scales->len != mode->supported_scales->len) {
+                g_array_unref (mode->supported_scales);
+                mode->supported_scales = intern_scales (self, scales);
+            }
         }
     }
 }
@@ -1530,6 +1604,7 @@ cc_display_config_finalize (GObject *object)
 
     g_clear_list (&self->monitors, g_object_unref);
     g_clear_pointer (&self->logical_monitors, g_hash_table_destroy);
+    g_clear_pointer (&self->scale_tables, g_hash_table_unref);
 
     G_OBJECT_CLASS (cc_display_config_parent_class)->finalize (object);
 }
@@ -1566,6 +1641,8 @@ cc_display_config_init (CcDisplayConfig *self)
     self->global_scale_required = FALSE;
     self->layout_mode = CC_DISPLAY_LAYOUT_MODE_LOGICAL;
     self->logical_monitors = g_hash_table_new (NULL, NULL);
+    self->scale_tables = g_hash_table_new_full (g_bytes_hash, g_bytes_equal, (GDestroyNotify) g_bytes_unref,
+                                                (GDestroyNotify) g_array_unref);
 }
 
 GList *
@@ -1885,38 +1962,23 @@ is_mode_better (CcDisplayMode *mode, CcDisplayMode *other_mode)
     return FALSE;
 }
 
-static gboolean
-mode_supports_scale (CcDisplayMode *mode, double scale)
-{
-    g_autoptr(GArray) scales = NULL;
-    int i;
-
-    scales = cc_display_mode_get_supported_scales (mode);
-    for (i = 0; i < scales->len; i++) {
-        if (cc_display_same_scale (scale, g_array_index (scales, double, i)))
-            return TRUE;
-    }
-
-    return FALSE;
-}
-
 static void
 remove_unsupported_scales (CcDisplayMode *mode, GArray *supported_scales)
 {
     g_autoptr(GArray) mode_scales = NULL;
-    int i;
+    int i, j;
 
     mode_scales = cc_display_mode_get_supported_scales (mode);
     i = 0;
     while (i < supported_scales->len) {
-        double scale;
+        double scale = g_array_index (supported_scales, double, i);
 
-        if (i == supported_scales->len)
-            break;
-
-        scale = g_array_index (supported_scales, double, i);
+        for (j = 0; j < mode_scales->len; j++) {
+            if (cc_display_same_scale (scale, g_array_index (mode_scales, double, j)))
+                break;
+        }
 
-        if (mode_supports_scale (mode, scale)) {
+        if (j < mode_scales->len) {
             i++;
             continue;
         }
@@ -1925,38 +1987,53 @@ remove_unsupported_scales (CcDisplayMode *mode, GArray *supported_scales)
     }
 }
 
-static gboolean
-monitor_has_compatible_clone_mode (CcDisplayMonitor *monitor, CcDisplayMode *mode, GArray *supported_scales)
+static guint
+clone_mode_hash (gconstpointer key)
 {
-    GList *l;
+    const CcDisplayMode *mode = key;
 
-    for (l = monitor->modes; l; l = l->next) {
-        CcDisplayMode *other_mode = l->data;
+    return (mode->width * 31 + mode->height) * 2 + !!(mode->flags & MODE_INTERLACED);
+}
 
-        if (other_mode->width != mode->width || other_mode->height != mode->height)
-            continue;
+static gboolean
+clone_mode_equal (gconstpointer a, gconstpointer b)
+{
+    const CcDisplayMode *mode_a = a;
+    const CcDisplayMode *mode_b = b;
 
-        if ((other_mode->flags & MODE_INTERLACED) != (mode->flags & MODE_INTERLACED))
-            continue;
+    return mode_a->width == mode_b->width && mode_a->height == mode_b->height
+           && (mode_a->flags & MODE_INTERLACED) == (mode_b->flags & MODE_INTERLACED);
+}
 
-        remove_unsupported_scales (CC_DISPLAY_MODE (other_mode), supported_scales);
+/* Maps each resolution of the monitor to its first mode with that resolution */
+static GHashTable *
+monitor_get_clone_modes (CcDisplayMonitor *monitor)
+{
+    GHashTable *clone_modes;
+    GList *l;
 
-        return TRUE;
+    clone_modes = g_hash_table_new (clone_mode_hash, clone_mode_equal);
+
+    for (l = monitor->modes; l; l = l->next) {
+        if (!g_hash_table_contains (clone_modes, l->data))
+            g_hash_table_add (clone_modes, l->data);
     }
 
-    return FALSE;
+    return clone_modes;
 }
 
 static gboolean
-monitors_has_compatible_clone_mode (CcDisplayConfig *self, CcDisplayMode *mode, GArray *supported_scales)
+monitors_has_compatible_clone_mode (GPtrArray *monitors_clone_modes, CcDisplayMode *mode, GArray *supported_scales)
 {
-    GList *l;
+    guint i;
 
-    for (l = self->monitors; l; l = l->next) {
-        CcDisplayMonitor *monitor = l->data;
+    for (i = 0; i < monitors_clone_modes->len; i++) {
+        CcDisplayMode *other_mode = g_hash_table_lookup (monitors_clone_modes->pdata[i], mode);
 
-        if (!monitor_has_compatible_clone_mode (monitor, mode, supported_scales))
+        if (!other_mode)
             return FALSE;
+
+        remove_unsupported_scales (CC_DISPLAY_MODE (other_mode), supported_scales);
     }
 
     return TRUE;
@@ -1966,6 +2043,7 @@ GList *
 cc_display_config_generate_cloning_modes (CcDisplayConfig *self)
 {
     CcDisplayMonitor *base_monitor = NULL;
+    g_autoptr(GPtrArray) monitors_clone_modes = NULL;
     GList *l;
     GList *clone_modes = NULL;
     CcDisplayMode *best_mode = NULL;
@@ -1984,18 +2062,27 @@ cc_display_config_generate_cloning_modes (CcDisplayConfig *self)
     if (!base_monitor)
         return NULL;
 
+    /* Look up the resolutions of the base monitor in the other monitors,
+     * instead of going through all their modes for each of them. */
+    monitors_clone_modes = g_ptr_array_new_with_free_func ((GDestroyNotify) g_hash_table_unref);
+    for (l = self->monitors; l; l = l->next)
+        g_ptr_array_add (monitors_clone_modes, monitor_get_clone_modes (l->data));
+
     for (l = base_monitor->modes; l; l = l->next) {
         CcDisplayMode *mode = l->data;
         CcDisplayMode *virtual_mode;
         g_autoptr(GArray) supported_scales = NULL;
+        g_autoptr(GArray) mode_scales = NULL;
 
-        supported_scales = cc_display_mode_get_supported_scales (CC_DISPLAY_MODE (mode));
+        /* The scales of the mode may be shared with other modes */
+        mode_scales = cc_display_mode_get_supported_scales (CC_DISPLAY_MODE (mode));
+        supported_scales = g_array_copy (mode_scales);
 
-        if (!monitors_has_compatible_clone_mode (self, mode, supported_scales))
+        if (!monitors_has_compatible_clone_mode (monitors_clone_modes, mode, supported_scales))
             continue;
 
         virtual_mode = cc_display_mode_new_virtual (mode->width, mode->height, mode->preferred_scale, supported_scales);
-        clone_modes = g_list_append (clone_modes, virtual_mode);
+        clone_modes = g_list_prepend (clone_modes, virtual_mode);
 
         if (!best_mode || is_mode_better (virtual_mode, best_mode))
             best_mode = virtual_mode;
@@ -2004,7 +2091,7 @@ cc_display_config_generate_cloning_modes (CcDisplayConfig *self)
     if (best_mode)
         best_mode->flags |= MODE_PREFERRED;
 
-    return clone_modes;
+    return g_list_reverse (clone_modes);
 }
 
 gboolean
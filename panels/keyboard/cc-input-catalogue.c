@@ -0,0 +1,749 @@
+/*
+ * Copyright (C) 2026 The GNOME Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+#include <locale.h>
+#include <string.h>
+
+#define GNOME_DESKTOP_USE_UNSTABLE_API
+#include <libgnome-desktop/gnome-languages.h>
+
+#include "cc-input-catalogue.h"
+#include "cc-util.h"
+
+#ifdef HAVE_IBUS
+#include "cc-ibus-utils.h"
+#include <ibus.h>
+#endif /* HAVE_IBUS */
+
+/* Bump when the layout of INPUT_CATALOGUE_INDEX_TYPE changes */
+#define INPUT_CATALOGUE_INDEX_VERSION 1
+#define INPUT_CATALOGUE_INDEX_TYPE "(qua(sssssmsas)asa{s(ss)})"
+
+struct _CcInputCatalogueItem {
+    GObject parent_instance;
+
+    CcInputCatalogueItemKind kind;
+    gchar *id;
+    gchar *name;
+    gchar *search_key;
+
+    /* Locales */
+    gchar *untranslated_search_key;
+    GListStore *sources;
+
+    /* Input sources */
+    const gchar *source_type;
+    gboolean is_default;
+    CcInputCatalogueItem *locale;
+};
+
+G_DEFINE_FINAL_TYPE (CcInputCatalogueItem, cc_input_catalogue_item, G_TYPE_OBJECT)
+
+struct _CcInputCatalogue {
+    GListStore *locales;
+    /* Locale ID → CcInputCatalogueItem */
+    GHashTable *locales_by_id;
+    /* Language name → GPtrArray of CcInputCatalogueItem */
+    GHashTable *locales_by_language;
+    CcInputCatalogueItem *other_locale;
+    gboolean cached;
+};
+
+static void
+cc_input_catalogue_item_finalize (GObject *object)
+{
+    CcInputCatalogueItem *self = CC_INPUT_CATALOGUE_ITEM (object);
+
+    if (self->locale)
+        g_object_remove_weak_pointer (G_OBJECT (self->locale), (gpointer *) &self->locale);
+
+    g_free (self->id);
+    g_free (self->name);
+    g_free (self->search_key);
+    g_free (self->untranslated_search_key);
+    g_clear_object (&self->sources);
+
+    G_OBJECT_CLASS (cc_input_catalogue_item_parent_class)->finalize (object);
+}
+
+static void
+cc_input_catalogue_item_class_init (CcInputCatalogueItemClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+    object_class->finalize = cc_input_catalogue_item_finalize;
+}
+
+static void
+cc_input_catalogue_item_init (CcInputCatalogueItem *self)
+{
+}
+
+static gint
+compare_sources (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+    const CcInputCatalogueItem *sa = a;
+    const CcInputCatalogueItem *sb = b;
+
+    /* The default input source always goes first in its group */
+    if (sa->is_default != sb->is_default)
+        return sa->is_default ? -1 : 1;
+
+    return g_strcmp0 (sa->name, sb->name);
+}
+
+static gint
+compare_locales (gconstpointer a, gconstpointer b)
+{
+    const CcInputCatalogueItem *la = *(CcInputCatalogueItem **) a;
+    const CcInputCatalogueItem *lb = *(CcInputCatalogueItem **) b;
+
+    /* The "Other" locale always goes at the end */
+    if (!la->id[0] != !lb->id[0])
+        return !la->id[0] ? 1 : -1;
+
+    return g_strcmp0 (la->name, lb->name);
+}
+
+static CcInputCatalogueItem *
+locale_item_new (const gchar *id, const gchar *name, const gchar *search_key, const gchar *untranslated_search_key)
+{
+    CcInputCatalogueItem *self = g_object_new (CC_TYPE_INPUT_CATALOGUE_ITEM, NULL);
+
+    self->kind = CC_INPUT_CATALOGUE_ITEM_LOCALE;
+    self->id = g_strdup (id);
+    self->name = g_strdup (name);
+    self->search_key = g_strdup (search_key);
+    self->untranslated_search_key = g_strdup (untranslated_search_key);
+    self->sources = g_list_store_new (CC_TYPE_INPUT_CATALOGUE_ITEM);
+
+    return self;
+}
+
+static CcInputCatalogueItem *
+source_item_new (CcInputCatalogueItem *locale, const gchar *type, const gchar *id, const gchar *name,
+                 const gchar *search_key, gboolean is_default)
+{
+    CcInputCatalogueItem *self = g_object_new (CC_TYPE_INPUT_CATALOGUE_ITEM, NULL);
+
+    self->kind = CC_INPUT_CATALOGUE_ITEM_SOURCE;
+    self->source_type = type;
+    self->id = g_strdup (id);
+    self->name = g_strdup (name);
+    self->search_key = g_strdup (search_key);
+    self->is_default = is_default;
+
+    /* The locale owns its sources */
+    self->locale = locale;
+    g_object_add_weak_pointer (G_OBJECT (locale), (gpointer *) &self->locale);
+
+    return self;
+}
+
+CcInputCatalogueItemKind
+cc_input_catalogue_item_get_kind (CcInputCatalogueItem *self)
+{
+    g_return_val_if_fail (CC_IS_INPUT_CATALOGUE_ITEM (self), CC_INPUT_CATALOGUE_ITEM_LOCALE);
+
+    return self->kind;
+}
+
+/* The locale ID for locales, the layout or engine ID for input sources */
+const gchar *
+cc_input_catalogue_item_get_id (CcInputCatalogueItem *self)
+{
+    g_return_val_if_fail (CC_IS_INPUT_CATALOGUE_ITEM (self), NULL);
+
+    return self->id;
+}
+
+const gchar *
+cc_input_catalogue_item_get_name (CcInputCatalogueItem *self)
+{
+    g_return_val_if_fail (CC_IS_INPUT_CATALOGUE_ITEM (self), NULL);
+
+    return self->name;
+}
+
+const gchar *
+cc_input_catalogue_item_get_source_type (CcInputCatalogueItem *self)
+{
+    g_return_val_if_fail (CC_IS_INPUT_CATALOGUE_ITEM (self), NULL);
+
+    return self->source_type;
+}
+
+gboolean
+cc_input_catalogue_item_get_is_default (CcInputCatalogueItem *self)
+{
+    g_return_val_if_fail (CC_IS_INPUT_CATALOGUE_ITEM (self), FALSE);
+
+    return self->is_default;
+}
+
+CcInputCatalogueItem *
+cc_input_catalogue_item_get_locale (CcInputCatalogueItem *self)
+{
+    g_return_val_if_fail (CC_IS_INPUT_CATALOGUE_ITEM (self), NULL);
+
+    return self->locale;
+}
+
+GListModel *
+cc_input_catalogue_item_get_sources (CcInputCatalogueItem *self)
+{
+    g_return_val_if_fail (CC_IS_INPUT_CATALOGUE_ITEM (self), NULL);
+
+    return G_LIST_MODEL (self->sources);
+}
+
+static gboolean
+match_all (gchar **words, const gchar *str)
+{
+    gchar **w;
+
+    if (str == NULL)
+        return FALSE;
+
+    for (w = words; *w; ++w)
+        if (!strstr (str, *w))
+            return FALSE;
+
+    return TRUE;
+}
+
+static gboolean
+locale_matches_name (CcInputCatalogueItem *self, gchar **words)
+{
+    return match_all (words, self->search_key) || match_all (words, self->untranslated_search_key);
+}
+
+/*
+ * @words must be normalized with cc_util_normalize_casefold_and_unaccent().
+ * A locale matches if its name or the name of any of its input sources
+ * contains all the words, an input source if its own name or the name
+ * of its locale does.
+ */
+gboolean
+cc_input_catalogue_item_match (CcInputCatalogueItem *self, gchar **words)
+{
+    g_return_val_if_fail (CC_IS_INPUT_CATALOGUE_ITEM (self), FALSE);
+
+    if (self->kind == CC_INPUT_CATALOGUE_ITEM_SOURCE)
+        return match_all (words, self->search_key) || (self->locale && locale_matches_name (self->locale, words));
+
+    if (locale_matches_name (self, words))
+        return TRUE;
+
+    for (guint i = 0; i < g_list_model_get_n_items (G_LIST_MODEL (self->sources)); i++) {
+        CcInputCatalogueItem *source = g_list_model_get_item (G_LIST_MODEL (self->sources), i);
+        gboolean matches = match_all (words, source->search_key);
+
+        g_object_unref (source);
+        if (matches)
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
+static GList *
+layout_lists_intersection (GList *first_list, GList *second_list)
+{
+    g_autoptr(GHashTable) first_set = NULL;
+    g_autoptr(GList) intersection_list = NULL;
+
+    first_set = g_hash_table_new (g_str_hash, g_str_equal);
+
+    while (first_list != NULL) {
+        char *layout;
+
+        layout = first_list->data;
+        g_hash_table_insert (first_set, layout, layout);
+        first_list = first_list->next;
+    }
+
+    while (second_list != NULL) {
+        char *layout;
+
+        layout = second_list->data;
+        if (g_hash_table_remove (first_set, layout))
+            intersection_list = g_list_prepend (intersection_list, layout);
+
+        second_list = second_list->next;
+    }
+
+    return g_steal_pointer (&intersection_list);
+}
+
+static gchar *
+index_file_get (void)
+{
+    return g_build_filename (g_get_user_cache_dir (), "gnome-control-center", "input-catalogue", NULL);
+}
+
+/*
+ * The index depends on the translations, the installed locales and the
+ * xkeyboard-config layouts. Hashing all of them is much cheaper than
+ * looking up the names of every locale.
+ */
+static guint32
+compute_index_key (GnomeXkbInfo *xkb_info, gchar **locale_ids)
+{
+    g_autoptr(GString) key = NULL;
+    g_autoptr(GList) all_layouts = NULL;
+    GList *l;
+
+    key = g_string_new (setlocale (LC_MESSAGES, NULL));
+
+    for (gchar **locale = locale_ids; *locale; ++locale)
+        g_string_append_printf (key, "\n%s", *locale);
+
+    all_layouts = gnome_xkb_info_get_all_layouts (xkb_info);
+    for (l = all_layouts; l; l = l->next) {
+        const gchar *display_name = NULL;
+
+        gnome_xkb_info_get_layout_info (xkb_info, l->data, &display_name, NULL, NULL, NULL);
+        g_string_append_printf (key, "\n%s=%s", (const gchar *) l->data, display_name ? display_name : "");
+    }
+
+    return g_str_hash (key->str);
+}
+
+static GVariant *
+build_index (GnomeXkbInfo *xkb_info, gchar **locale_ids, guint32 key)
+{
+    g_autoptr(GHashTable) seen_locales = NULL;
+    g_autoptr(GHashTable) layouts_with_locale = NULL;
+    g_autoptr(GList) all_layouts = NULL;
+    GVariantBuilder locales;
+    GVariantBuilder other_layouts;
+    GVariantBuilder layouts;
+    GList *l;
+
+    seen_locales = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    layouts_with_locale = g_hash_table_new (g_str_hash, g_str_equal);
+
+    g_variant_builder_init (&locales, G_VARIANT_TYPE ("a(sssssmsas)"));
+    for (gchar **locale = locale_ids; *locale; ++locale) {
+        g_autofree gchar *lang_code = NULL;
+        g_autofree gchar *country_code = NULL;
+        g_autofree gchar *simple_locale = NULL;
+        g_autofree gchar *language = NULL;
+        g_autofree gchar *name = NULL;
+        g_autofree gchar *untranslated_name = NULL;
+        g_autofree gchar *search_key = NULL;
+        g_autofree gchar *untranslated_search_key = NULL;
+        const gchar *type = NULL;
+        const gchar *default_id = NULL;
+        g_autoptr(GList) language_layouts = NULL;
+        g_autoptr(GList) locale_layouts = NULL;
+        GVariantBuilder locale_layout_ids;
+
+        if (!gnome_parse_locale (*locale, &lang_code, &country_code, NULL, NULL))
+            continue;
+
+        if (country_code != NULL)
+            simple_locale = g_strdup_printf ("%s_%s.UTF-8", lang_code, country_code);
+        else
+            simple_locale = g_strdup_printf ("%s.UTF-8", lang_code);
+
+        if (g_hash_table_contains (seen_locales, simple_locale))
+            continue;
+        g_hash_table_add (seen_locales, g_strdup (simple_locale));
+
+        language = gnome_get_language_from_code (lang_code, NULL);
+        name = gnome_get_language_from_locale (simple_locale, NULL);
+        if (name == NULL)
+            name = g_strdup (simple_locale);
+        search_key = cc_util_normalize_casefold_and_unaccent (name);
+        untranslated_name = gnome_get_language_from_locale (simple_locale, "C");
+        untranslated_search_key = cc_util_normalize_casefold_and_unaccent (untranslated_name ? untranslated_name : "");
+
+        if (gnome_get_input_source_from_locale (simple_locale, &type, &default_id)
+            && g_str_equal (type, INPUT_SOURCE_TYPE_XKB)) {
+            g_hash_table_add (layouts_with_locale, (gpointer) default_id);
+        } else {
+            default_id = NULL;
+        }
+
+        language_layouts = gnome_xkb_info_get_layouts_for_language (xkb_info, lang_code);
+
+        if (country_code != NULL) {
+            g_autoptr(GList) country_layouts = gnome_xkb_info_get_layouts_for_country (xkb_info, country_code);
+            locale_layouts = layout_lists_intersection (language_layouts, country_layouts);
+        } else {
+            locale_layouts = g_steal_pointer (&language_layouts);
+        }
+
+        g_variant_builder_init (&locale_layout_ids, G_VARIANT_TYPE_STRING_ARRAY);
+        for (l = locale_layouts; l; l = l->next) {
+            g_hash_table_add (layouts_with_locale, l->data);
+
+            /* The default input source is stored separately */
+            if (g_strcmp0 (l->data, default_id) != 0)
+                g_variant_builder_add (&locale_layout_ids, "s", l->data);
+        }
+
+        g_variant_builder_add (&locales, "(sssssmsas)", simple_locale, language ? language : "", name, search_key,
+                               untranslated_search_key, default_id, &locale_layout_ids);
+    }
+
+    g_variant_builder_init (&other_layouts, G_VARIANT_TYPE_STRING_ARRAY);
+    g_variant_builder_init (&layouts, G_VARIANT_TYPE ("a{s(ss)}"));
+
+    all_layouts = gnome_xkb_info_get_all_layouts (xkb_info);
+    for (l = all_layouts; l; l = l->next) {
+        const gchar *display_name = NULL;
+        g_autofree gchar *search_key = NULL;
+
+        if (!g_hash_table_contains (layouts_with_locale, l->data))
+            g_variant_builder_add (&other_layouts, "s", l->data);
+
+        gnome_xkb_info_get_layout_info (xkb_info, l->data, &display_name, NULL, NULL, NULL);
+        if (display_name == NULL)
+            display_name = l->data;
+        search_key = cc_util_normalize_casefold_and_unaccent (display_name);
+        g_variant_builder_add (&layouts, "{s(ss)}", l->data, display_name, search_key);
+    }
+
+    return g_variant_ref_sink (g_variant_new (INPUT_CATALOGUE_INDEX_TYPE, (guint16) INPUT_CATALOGUE_INDEX_VERSION, key,
+                                              &locales, &other_layouts, &layouts));
+}
+
+static GVariant *
+load_index (const gchar *index_file, guint32 key)
+{
+    g_autoptr(GMappedFile) mapped = NULL;
+    g_autoptr(GBytes) bytes = NULL;
+    g_autoptr(GVariant) variant = NULL;
+    g_autoptr(GVariant) locales = NULL;
+    guint16 version;
+    guint32 index_key;
+
+    mapped = g_mapped_file_new (index_file, FALSE, NULL);
+    if (!mapped)
+        return NULL;
+
+    /* The file is not trusted, GVariant will substitute defaults for malformed data */
+    bytes = g_mapped_file_get_bytes (mapped);
+    variant = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE (INPUT_CATALOGUE_INDEX_TYPE), bytes, FALSE));
+
+    g_variant_get_child (variant, 0, "q", &version);
+    g_variant_get_child (variant, 1, "u", &index_key);
+    locales = g_variant_get_child_value (variant, 2);
+    if (version != INPUT_CATALOGUE_INDEX_VERSION || index_key != key || g_variant_n_children (locales) == 0) {
+        g_debug ("Input source catalogue %s is out of date", index_file);
+        return NULL;
+    }
+
+    return g_steal_pointer (&variant);
+}
+
+static void
+save_index (GVariant *index, const gchar *index_file)
+{
+    g_autoptr(GError) error = NULL;
+    g_autofree gchar *dir = NULL;
+
+    dir = g_path_get_dirname (index_file);
+    if (g_mkdir_with_parents (dir, 0700) < 0) {
+        g_debug ("Could not create directory '%s': %m", dir);
+        return;
+    }
+
+    if (!g_file_set_contents (index_file, g_variant_get_data (index), g_variant_get_size (index), &error))
+        g_debug ("Could not write input source catalogue: %s", error->message);
+}
+
+/* g_variant_lookup() scans the whole dictionary, so index it once per load */
+static GHashTable *
+layouts_by_id_new (GVariant *layouts)
+{
+    GHashTable *layouts_by_id;
+    GVariantIter iter;
+    GVariant *entry;
+
+    layouts_by_id = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, (GDestroyNotify) g_variant_unref);
+
+    g_variant_iter_init (&iter, layouts);
+    while ((entry = g_variant_iter_next_value (&iter)) != NULL) {
+        const gchar *id;
+
+        g_variant_get (entry, "{&s*}", &id, NULL);
+        g_hash_table_replace (layouts_by_id, (gpointer) id, entry);
+    }
+
+    return layouts_by_id;
+}
+
+static gboolean
+lookup_layout (GHashTable *layouts_by_id, const gchar *id, const gchar **name, const gchar **search_key)
+{
+    GVariant *entry = g_hash_table_lookup (layouts_by_id, id);
+
+    if (entry == NULL)
+        return FALSE;
+
+    g_variant_get (entry, "{&s(&s&s)}", NULL, name, search_key);
+
+    return TRUE;
+}
+
+static void
+add_layouts (CcInputCatalogueItem *locale, GVariant *layout_ids, GHashTable *layouts_by_id, GPtrArray *sources)
+{
+    GVariantIter iter;
+    const gchar *id;
+
+    g_variant_iter_init (&iter, layout_ids);
+    while (g_variant_iter_next (&iter, "&s", &id)) {
+        const gchar *name, *search_key;
+
+        if (!lookup_layout (layouts_by_id, id, &name, &search_key))
+            continue;
+
+        g_ptr_array_add (sources, source_item_new (locale, INPUT_SOURCE_TYPE_XKB, id, name, search_key, FALSE));
+    }
+}
+
+static void
+add_sorted_sources (CcInputCatalogueItem *locale, GPtrArray *sources)
+{
+    g_ptr_array_sort_values_with_data (sources, (GCompareDataFunc) compare_sources, NULL);
+    g_list_store_splice (locale->sources, 0, 0, sources->pdata, sources->len);
+}
+
+static CcInputCatalogue *
+catalogue_new_from_index (GVariant *index)
+{
+    g_autoptr(GVariant) locales = NULL;
+    g_autoptr(GVariant) other_layouts = NULL;
+    g_autoptr(GVariant) layouts = NULL;
+    g_autoptr(GHashTable) layouts_by_id = NULL;
+    g_autoptr(GPtrArray) locale_items = NULL;
+    g_autoptr(GPtrArray) other_sources = NULL;
+    CcInputCatalogue *self;
+    GVariantIter iter;
+    const gchar *id, *language, *name, *search_key, *untranslated_search_key, *default_id;
+    GVariant *layout_ids;
+
+    locales = g_variant_get_child_value (index, 2);
+    other_layouts = g_variant_get_child_value (index, 3);
+    layouts = g_variant_get_child_value (index, 4);
+    layouts_by_id = layouts_by_id_new (layouts);
+
+    self = g_new0 (CcInputCatalogue, 1);
+    self->locales = g_list_store_new (CC_TYPE_INPUT_CATALOGUE_ITEM);
+    self->locales_by_id = g_hash_table_new (g_str_hash, g_str_equal);
+    self->locales_by_language =
+        g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_ptr_array_unref);
+
+    locale_items = g_ptr_array_new_with_free_func (g_object_unref);
+
+    g_variant_iter_init (&iter, locales);
+    while (g_variant_iter_loop (&iter, "(&s&s&s&s&sm&s@as)", &id, &language, &name, &search_key,
+                                &untranslated_search_key, &default_id, &layout_ids)) {
+        g_autoptr(GPtrArray) sources = g_ptr_array_new_with_free_func (g_object_unref);
+        CcInputCatalogueItem *locale;
+        GPtrArray *language_locales;
+
+        locale = locale_item_new (id, name, search_key, untranslated_search_key);
+        g_ptr_array_add (locale_items, locale);
+        g_hash_table_insert (self->locales_by_id, locale->id, locale);
+
+        language_locales = g_hash_table_lookup (self->locales_by_language, language);
+        if (!language_locales) {
+            language_locales = g_ptr_array_new ();
+            g_hash_table_insert (self->locales_by_language, g_strdup (language), language_locales);
+        }
+        g_ptr_array_add (language_locales, locale);
+
+        if (default_id != NULL) {
+            const gchar *default_name, *default_search_key;
+
+            if (lookup_layout (layouts_by_id, default_id, &default_name, &default_search_key))
+                g_ptr_array_add (sources, source_item_new (locale, INPUT_SOURCE_TYPE_XKB, default_id, default_name,
+                                                           default_search_key, TRUE));
+        }
+
+        add_layouts (locale, layout_ids, layouts_by_id, sources);
+        add_sorted_sources (locale, sources);
+    }
+
+    /* Add a "Other" locale to hold the remaining input sources */
+    self->other_locale = locale_item_new ("", C_("Input Source", "Other"), "", "");
+    g_ptr_array_add (locale_items, self->other_locale);
+
+    other_sources = g_ptr_array_new_with_free_func (g_object_unref);
+    add_layouts (self->other_locale, other_layouts, layouts_by_id, other_sources);
+    add_sorted_sources (self->other_locale, other_sources);
+
+    g_ptr_array_sort (locale_items, compare_locales);
+    g_list_store_splice (self->locales, 0, 0, locale_items->pdata, locale_items->len);
+
+    return self;
+}
+
+/*
+ * Builds the catalogue of locales and their keyboard layouts, along with
+ * the normalized names used for searching. The catalogue is stored in
+ * the user cache directory, later calls only read it back. This doesn't
+ * use the main context and can be called from a thread.
+ */
+CcInputCatalogue *
+cc_input_catalogue_new (GnomeXkbInfo *xkb_info)
+{
+    g_autofree gchar *index_file = NULL;
+    g_autoptr(GVariant) index = NULL;
+    g_auto(GStrv) locale_ids = NULL;
+    CcInputCatalogue *self;
+    guint32 key;
+
+    g_return_val_if_fail (GNOME_IS_XKB_INFO (xkb_info), NULL);
+
+    locale_ids = gnome_get_all_locales ();
+    key = compute_index_key (xkb_info, locale_ids);
+
+    index_file = index_file_get ();
+    index = load_index (index_file, key);
+    if (index) {
+        self = catalogue_new_from_index (index);
+        self->cached = TRUE;
+        return self;
+    }
+
+    index = build_index (xkb_info, locale_ids, key);
+    save_index (index, index_file);
+
+    return catalogue_new_from_index (index);
+}
+
+void
+cc_input_catalogue_free (CcInputCatalogue *self)
+{
+    g_clear_object (&self->locales);
+    g_clear_pointer (&self->locales_by_id, g_hash_table_unref);
+    g_clear_pointer (&self->locales_by_language, g_hash_table_unref);
+    g_free (self);
+}
+
+/* Whether the catalogue was read from the user cache rather than built */
+gboolean
+cc_input_catalogue_is_cached (CcInputCatalogue *self)
+{
+    return self->cached;
+}
+
+/* Sorted by name, with the "Other" locale last */
+GListModel *
+cc_input_catalogue_get_locales (CcInputCatalogue *self)
+{
+    return G_LIST_MODEL (self->locales);
+}
+
+#ifdef HAVE_IBUS
+static gboolean
+locale_has_default (CcInputCatalogueItem *locale)
+{
+    g_autoptr(CcInputCatalogueItem) first = g_list_model_get_item (G_LIST_MODEL (locale->sources), 0);
+
+    return first != NULL && first->is_default;
+}
+
+static void
+add_engine (CcInputCatalogueItem *locale, const gchar *engine_id, const gchar *name, const gchar *search_key,
+            gboolean is_default)
+{
+    g_autoptr(CcInputCatalogueItem) source = NULL;
+
+    source = source_item_new (locale, INPUT_SOURCE_TYPE_IBUS, engine_id, name, search_key, is_default);
+    g_list_store_insert_sorted (locale->sources, source, compare_sources, NULL);
+}
+
+static gboolean
+is_default_engine (const gchar *locale, const gchar *engine_id)
+{
+    const gchar *type, *id;
+
+    return gnome_get_input_source_from_locale (locale, &type, &id) && g_str_equal (type, INPUT_SOURCE_TYPE_IBUS)
+           && g_str_equal (id, engine_id);
+}
+#endif /* HAVE_IBUS */
+
+/*
+ * IBus engines aren't part of the cached catalogue, as they show up
+ * later and there are few of them.
+ */
+void
+cc_input_catalogue_add_ibus_engines (CcInputCatalogue *self, GHashTable *ibus_engines)
+{
+#ifdef HAVE_IBUS
+    GHashTableIter iter;
+    const gchar *engine_id;
+    IBusEngineDesc *engine;
+
+    g_hash_table_iter_init (&iter, ibus_engines);
+    while (g_hash_table_iter_next (&iter, (gpointer *) &engine_id, (gpointer *) &engine)) {
+        g_autofree gchar *lang_code = NULL;
+        g_autofree gchar *country_code = NULL;
+        g_autofree gchar *name = NULL;
+        g_autofree gchar *search_key = NULL;
+        const gchar *ibus_locale = ibus_engine_desc_get_language (engine);
+        CcInputCatalogueItem *locale;
+
+        name = engine_get_display_name (engine);
+        search_key = cc_util_normalize_casefold_and_unaccent (name);
+
+        if (gnome_parse_locale (ibus_locale, &lang_code, &country_code, NULL, NULL) && lang_code != NULL
+            && country_code != NULL) {
+            g_autofree gchar *locale_id = g_strdup_printf ("%s_%s.UTF-8", lang_code, country_code);
+
+            locale = g_hash_table_lookup (self->locales_by_id, locale_id);
+            if (locale)
+                add_engine (locale, engine_id, name, search_key, is_default_engine (locale_id, engine_id));
+            else
+                add_engine (self->other_locale, engine_id, name, search_key, FALSE);
+        } else if (lang_code != NULL) {
+            g_autofree gchar *language = NULL;
+            GPtrArray *locales_for_language = NULL;
+
+            /* Most IBus engines only specify the language so we try to
+               add them to all locales for that language. */
+
+            language = gnome_get_language_from_code (lang_code, NULL);
+            if (language)
+                locales_for_language = g_hash_table_lookup (self->locales_by_language, language);
+
+            if (locales_for_language) {
+                for (guint i = 0; i < locales_for_language->len; i++) {
+                    locale = g_ptr_array_index (locales_for_language, i);
+                    add_engine (locale, engine_id, name, search_key,
+                                !locale_has_default (locale) && is_default_engine (locale->id, engine_id));
+                }
+            } else {
+                add_engine (self->other_locale, engine_id, name, search_key, FALSE);
+            }
+        } else {
+            add_engine (self->other_locale, engine_id, name, search_key, FALSE);
+        }
+    }
+#endif /* HAVE_IBUS */
+}
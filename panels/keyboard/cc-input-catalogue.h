@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2026 The GNOME Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+#define GNOME_DESKTOP_USE_UNSTABLE_API
+#include <libgnome-desktop/gnome-xkb-info.h>
+
+G_BEGIN_DECLS
+
+#define INPUT_SOURCE_TYPE_XKB "xkb"
+#define INPUT_SOURCE_TYPE_IBUS "ibus"
+
+typedef enum {
+    CC_INPUT_CATALOGUE_ITEM_LOCALE,
+    CC_INPUT_CATALOGUE_ITEM_SOURCE,
+} CcInputCatalogueItemKind;
+
+#define CC_TYPE_INPUT_CATALOGUE_ITEM (cc_input_catalogue_item_get_type ())
+G_DECLARE_FINAL_TYPE (CcInputCatalogueItem, cc_input_catalogue_item, CC, INPUT_CATALOGUE_ITEM, GObject)
+
+CcInputCatalogueItemKind cc_input_catalogue_item_get_kind (CcInputCatalogueItem *self);
+const gchar *cc_input_catalogue_item_get_id (CcInputCatalogueItem *self);
+const gchar *cc_input_catalogue_item_get_name (CcInputCatalogueItem *self);
+const gchar *cc_input_catalogue_item_get_source_type (CcInputCatalogueItem *self);
+gboolean cc_input_catalogue_item_get_is_default (CcInputCatalogueItem *self);
+CcInputCatalogueItem *cc_input_catalogue_item_get_locale (CcInputCatalogueItem *self);
+GListModel *cc_input_catalogue_item_get_sources (CcInputCatalogueItem *self);
+gboolean cc_input_catalogue_item_match (CcInputCatalogueItem *self, gchar **words);
+
+typedef struct _CcInputCatalogue CcInputCatalogue;
+
+CcInputCatalogue *cc_input_catalogue_new (GnomeXkbInfo *xkb_info);
+void cc_input_catalogue_free (CcInputCatalogue *self);
+gboolean cc_input_catalogue_is_cached (CcInputCatalogue *self);
+GListModel *cc_input_catalogue_get_locales (CcInputCatalogue *self);
+void cc_input_catalogue_add_ibus_engines (CcInputCatalogue *self, GHashTable *ibus_engines);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (CcInputCatalogue, cc_input_catalogue_free)
+
+G_END_DECLS
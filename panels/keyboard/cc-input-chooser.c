@@ -20,26 +20,14 @@
 #include <glib/gi18n.h>
 #include <locale.h>
 
-#define GNOME_DESKTOP_USE_UNSTABLE_API
-#include <libgnome-desktop/gnome-languages.h>
-
 #include "cc-common-language.h"
+#include "cc-input-catalogue.h"
 #include "cc-input-chooser.h"
 #include "cc-input-source-ibus.h"
 #include "cc-input-source-xkb.h"
 #include "cc-util.h"
 #include "shell/cc-panel.h"
 
-#ifdef HAVE_IBUS
-#include "cc-ibus-utils.h"
-#include <ibus.h>
-#endif /* HAVE_IBUS */
-
-#define INPUT_SOURCE_TYPE_XKB "xkb"
-#define INPUT_SOURCE_TYPE_IBUS "ibus"
-
-#define FILTER_TIMEOUT 150 /* ms */
-
 typedef enum {
     ROW_TRAVEL_DIRECTION_NONE,
     ROW_TRAVEL_DIRECTION_FORWARD,
@@ -57,16 +45,27 @@ struct _CcInputChooser {
 
     GtkButton *add_button;
     GtkSearchEntry *filter_entry;
-    GtkListBox *input_sources_listbox;
+    GtkListView *input_sources_view;
     GtkStack *input_sources_stack;
-    GtkListBoxRow *more_row;
-    GtkWidget *no_results;
     GtkSearchBar *search_bar;
 
     GnomeXkbInfo *xkb_info;
     GHashTable *ibus_engines;
-    GHashTable *locales;
-    GHashTable *locales_by_language;
+    CcInputCatalogue *catalogue;
+    GHashTable *initial_locales;
+    GCancellable *cancellable;
+
+    /* The back row, the filtered locales or input sources, and the more row */
+    GListStore *header_items;
+    GListStore *footer_items;
+    GObject *back_item;
+    GObject *more_item;
+    GtkCustomFilter *filter;
+    GtkFilterListModel *filtered_items;
+    GtkSingleSelection *selection;
+
+    /* The locale whose input sources are shown, or NULL for the locales */
+    CcInputCatalogueItem *current_locale;
     gboolean showing_extra;
     gchar **filter_words;
 };
@@ -82,37 +81,6 @@ static guint signals[SIGNAL_LAST] = {
     0,
 };
 
-typedef struct {
-    gchar *id;
-    gchar *name;
-    gchar *unaccented_name;
-    gchar *untranslated_name;
-    GtkListBoxRow *default_input_source_row;
-    GtkListBoxRow *locale_row;
-    GtkListBoxRow *back_row;
-    GHashTable *layout_rows_by_id;
-    GHashTable *engine_rows_by_id;
-} LocaleInfo;
-
-static void on_input_sources_listbox_row_activated_cb (CcInputChooser *self, GtkListBoxRow *row);
-
-static void
-locale_info_free (gpointer data)
-{
-    LocaleInfo *info = data;
-
-    g_free (info->id);
-    g_free (info->name);
-    g_free (info->unaccented_name);
-    g_free (info->untranslated_name);
-    g_clear_object (&info->default_input_source_row);
-    g_clear_object (&info->locale_row);
-    g_clear_object (&info->back_row);
-    g_hash_table_destroy (info->layout_rows_by_id);
-    g_hash_table_destroy (info->engine_rows_by_id);
-    g_free (info);
-}
-
 static void
 set_row_widget_margins (GtkWidget *widget)
 {
@@ -161,140 +129,102 @@ padded_label_new (const gchar *text, RowLabelPosition position, RowTravelDirecti
     return widget;
 }
 
-static GtkListBoxRow *
+static GtkWidget *
 more_row_new (void)
 {
-    GtkWidget *row;
     GtkWidget *box;
     GtkWidget *arrow;
 
-    row = gtk_list_box_row_new ();
     box = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 0);
-    gtk_list_box_row_set_child (GTK_LIST_BOX_ROW (row), box);
-    gtk_widget_set_tooltip_text (row, _("More…"));
+    gtk_widget_set_tooltip_text (box, _("More…"));
 
     arrow = gtk_image_new_from_icon_name ("view-more-symbolic");
     gtk_widget_set_hexpand (arrow, TRUE);
     set_row_widget_margins (arrow);
     gtk_box_append (GTK_BOX (box), arrow);
 
-    return GTK_LIST_BOX_ROW (row);
+    return box;
 }
 
 static GtkWidget *
-no_results_widget_new (void)
-{
-    return padded_label_new (_("No input sources found"), ROW_LABEL_POSITION_CENTER, ROW_TRAVEL_DIRECTION_NONE, TRUE);
-}
-
-static GtkListBoxRow *
 back_row_new (const gchar *text)
 {
-    GtkWidget *row;
-    GtkWidget *widget;
-
-    row = gtk_list_box_row_new ();
-    widget = padded_label_new (text, ROW_LABEL_POSITION_CENTER, ROW_TRAVEL_DIRECTION_BACKWARD, TRUE);
-    gtk_list_box_row_set_child (GTK_LIST_BOX_ROW (row), widget);
-
-    return GTK_LIST_BOX_ROW (row);
+    return padded_label_new (text, ROW_LABEL_POSITION_CENTER, ROW_TRAVEL_DIRECTION_BACKWARD, TRUE);
 }
 
-static GtkListBoxRow *
+static GtkWidget *
 locale_row_new (const gchar *text)
 {
-    GtkWidget *row;
-    GtkWidget *widget;
+    return padded_label_new (text, ROW_LABEL_POSITION_CENTER, ROW_TRAVEL_DIRECTION_NONE, FALSE);
+}
 
-    row = gtk_list_box_row_new ();
-    widget = padded_label_new (text, ROW_LABEL_POSITION_CENTER, ROW_TRAVEL_DIRECTION_NONE, FALSE);
-    gtk_list_box_row_set_child (GTK_LIST_BOX_ROW (row), widget);
+static void
+on_preview_button_clicked_cb (GtkButton *button, CcInputChooser *self)
+{
+    g_autoptr(CcInputSource) source = NULL;
+    const gchar *id = g_object_get_data (G_OBJECT (button), "id");
 
-    return GTK_LIST_BOX_ROW (row);
+    source = CC_INPUT_SOURCE (cc_input_source_xkb_new_from_id (self->xkb_info, id));
+    cc_input_source_launch_previewer (source);
 }
 
-static GtkListBoxRow *
-input_source_row_new (CcInputChooser *self, const gchar *type, const gchar *id)
+static GtkWidget *
+input_source_row_new (CcInputChooser *self, CcInputCatalogueItem *item)
 {
-    GtkWidget *row = NULL;
+    const gchar *type = cc_input_catalogue_item_get_source_type (item);
+    const gchar *name = cc_input_catalogue_item_get_name (item);
     GtkWidget *widget;
 
+    widget = padded_label_new (name, ROW_LABEL_POSITION_START, ROW_TRAVEL_DIRECTION_NONE, FALSE);
+
     if (g_str_equal (type, INPUT_SOURCE_TYPE_XKB)) {
-        const gchar *display_name;
-        CcInputSource *source;
-        GtkWidget *box;
         GtkWidget *preview_button;
 
-        gnome_xkb_info_get_layout_info (self->xkb_info, id, &display_name, NULL, NULL, NULL);
-
-        row = gtk_list_box_row_new ();
-        box = gtk_box_new (0, GTK_ORIENTATION_HORIZONTAL);
-        widget = padded_label_new (display_name, ROW_LABEL_POSITION_START, ROW_TRAVEL_DIRECTION_NONE, FALSE);
-        gtk_box_append (GTK_BOX (box), widget);
-
         preview_button = gtk_button_new_from_icon_name ("view-reveal-symbolic");
         gtk_widget_set_tooltip_text (preview_button, _("View Keyboard Layout"));
         gtk_widget_add_css_class (preview_button, "flat");
-        gtk_box_append (GTK_BOX (box), preview_button);
+        gtk_box_append (GTK_BOX (widget), preview_button);
 
-        source = CC_INPUT_SOURCE (cc_input_source_xkb_new_from_id (self->xkb_info, id));
-        g_signal_connect_swapped (preview_button, "clicked", (GCallback) cc_input_source_launch_previewer, source);
-
-        gtk_list_box_row_set_child (GTK_LIST_BOX_ROW (row), box);
-        g_object_set_data (G_OBJECT (row), "name", (gpointer) display_name);
-        g_object_set_data_full (G_OBJECT (row), "source", source, g_object_unref);
-        g_object_set_data_full (G_OBJECT (row), "unaccented-name",
-                                cc_util_normalize_casefold_and_unaccent (display_name), g_free);
+        g_object_set_data_full (G_OBJECT (preview_button), "id", g_strdup (cc_input_catalogue_item_get_id (item)),
+                                g_free);
+        g_signal_connect (preview_button, "clicked", G_CALLBACK (on_preview_button_clicked_cb), self);
     } else if (g_str_equal (type, INPUT_SOURCE_TYPE_IBUS)) {
-#ifdef HAVE_IBUS
-        gchar *display_name;
         GtkWidget *image;
 
-        display_name = engine_get_display_name (g_hash_table_lookup (self->ibus_engines, id));
-
-        row = gtk_list_box_row_new ();
-        widget = padded_label_new (display_name, ROW_LABEL_POSITION_START, ROW_TRAVEL_DIRECTION_NONE, FALSE);
-        gtk_list_box_row_set_child (GTK_LIST_BOX_ROW (row), widget);
-
         image = gtk_image_new_from_icon_name ("system-run-symbolic");
         set_row_widget_margins (image);
         gtk_box_append (GTK_BOX (widget), image);
-
-        g_object_set_data_full (G_OBJECT (row), "name", display_name, g_free);
-        g_object_set_data_full (G_OBJECT (row), "unaccented-name",
-                                cc_util_normalize_casefold_and_unaccent (display_name), g_free);
-#else
-        widget = NULL;
-#endif /* HAVE_IBUS */
     }
 
-    if (row) {
-        g_object_set_data (G_OBJECT (row), "type", (gpointer) type);
-        g_object_set_data (G_OBJECT (row), "id", (gpointer) id);
+    return widget;
+}
 
-        return GTK_LIST_BOX_ROW (row);
+/* Rows are only created for the items that are visible */
+static void
+on_factory_bind_cb (GtkSignalListItemFactory *factory, GObject *object, gpointer user_data)
+{
+    CcInputChooser *self = CC_INPUT_CHOOSER (user_data);
+    GtkListItem *list_item = GTK_LIST_ITEM (object);
+    GObject *item = gtk_list_item_get_item (list_item);
+    GtkWidget *child;
+
+    if (item == self->more_item) {
+        child = more_row_new ();
+    } else if (item == self->back_item) {
+        child = back_row_new (cc_input_catalogue_item_get_name (self->current_locale));
+    } else if (cc_input_catalogue_item_get_kind (CC_INPUT_CATALOGUE_ITEM (item)) == CC_INPUT_CATALOGUE_ITEM_LOCALE) {
+        child = locale_row_new (cc_input_catalogue_item_get_name (CC_INPUT_CATALOGUE_ITEM (item)));
+    } else {
+        child = input_source_row_new (self, CC_INPUT_CATALOGUE_ITEM (item));
     }
 
-    return NULL;
+    gtk_list_item_set_child (list_item, child);
 }
 
 static void
-add_input_source_rows_for_locale (CcInputChooser *self, LocaleInfo *info)
+on_factory_unbind_cb (GtkSignalListItemFactory *factory, GObject *object, gpointer user_data)
 {
-    GtkWidget *row;
-    GHashTableIter iter;
-    const gchar *id;
-
-    if (info->default_input_source_row)
-        gtk_list_box_append (self->input_sources_listbox, GTK_WIDGET (info->default_input_source_row));
-
-    g_hash_table_iter_init (&iter, info->layout_rows_by_id);
-    while (g_hash_table_iter_next (&iter, (gpointer *) &id, (gpointer *) &row))
-        gtk_list_box_append (self->input_sources_listbox, row);
-
-    g_hash_table_iter_init (&iter, info->engine_rows_by_id);
-    while (g_hash_table_iter_next (&iter, (gpointer *) &id, (gpointer *) &row))
-        gtk_list_box_append (self->input_sources_listbox, row);
+    gtk_list_item_set_child (GTK_LIST_ITEM (object), NULL);
 }
 
 static void
@@ -305,235 +235,83 @@ cc_input_chooser_emit_source_selected (CcInputChooser *self)
     adw_dialog_close (ADW_DIALOG (self));
 }
 
-static void
-on_back_row_click_released_cb (CcInputChooser *self, int n_press, double x, double y, GtkGestureClick *click)
+static gboolean
+is_current_locale (const gchar *locale)
 {
-    GtkWidget *widget;
-    GtkListBoxRow *row;
-
-    widget = gtk_event_controller_get_widget (GTK_EVENT_CONTROLLER (click));
-    row = GTK_LIST_BOX_ROW (widget);
-    if (row)
-        on_input_sources_listbox_row_activated_cb (self, row);
+    return g_strcmp0 (setlocale (LC_CTYPE, NULL), locale) == 0;
 }
 
-static void
-show_input_sources_for_locale (CcInputChooser *self, LocaleInfo *info)
+static gboolean
+filter_item (gpointer item, gpointer user_data)
 {
-    gtk_list_box_remove_all (self->input_sources_listbox);
+    CcInputChooser *self = user_data;
+    CcInputCatalogueItem *entry = CC_INPUT_CATALOGUE_ITEM (item);
 
-    if (!info->back_row) {
-        GtkEventController *controller;
+    if (cc_input_catalogue_item_get_kind (entry) == CC_INPUT_CATALOGUE_ITEM_LOCALE) {
+        const gchar *id = cc_input_catalogue_item_get_id (entry);
 
-        info->back_row = g_object_ref_sink (back_row_new (info->name));
-        g_object_set_data (G_OBJECT (info->back_row), "back", GINT_TO_POINTER (TRUE));
-        g_object_set_data (G_OBJECT (info->back_row), "locale-info", info);
+        if (g_list_model_get_n_items (cc_input_catalogue_item_get_sources (entry)) == 0)
+            return FALSE;
 
-        controller = GTK_EVENT_CONTROLLER (gtk_gesture_click_new ());
-        gtk_gesture_single_set_button (GTK_GESTURE_SINGLE (controller), 0);
-        g_signal_connect_swapped (controller, "released", G_CALLBACK (on_back_row_click_released_cb), self);
-        gtk_widget_add_controller (GTK_WIDGET (info->back_row), controller);
+        if (!self->showing_extra && !g_hash_table_contains (self->initial_locales, id) && !is_current_locale (id))
+            return FALSE;
     }
-    gtk_list_box_append (self->input_sources_listbox, GTK_WIDGET (info->back_row));
 
-    add_input_source_rows_for_locale (self, info);
+    if (!self->filter_words)
+        return TRUE;
 
-    gtk_list_box_invalidate_filter (self->input_sources_listbox);
-    gtk_list_box_set_selection_mode (self->input_sources_listbox, GTK_SELECTION_SINGLE);
-    gtk_list_box_set_activate_on_single_click (self->input_sources_listbox, FALSE);
-    gtk_list_box_unselect_all (self->input_sources_listbox);
-}
-
-static gboolean
-is_current_locale (const gchar *locale)
-{
-    return g_strcmp0 (setlocale (LC_CTYPE, NULL), locale) == 0;
+    return cc_input_catalogue_item_match (entry, self->filter_words);
 }
 
 static void
-show_locale_rows (CcInputChooser *self)
+update_more_row (CcInputChooser *self)
 {
-    g_autoptr(GHashTable) initial = NULL;
-    LocaleInfo *info;
-    GHashTableIter iter;
-
-    gtk_list_box_remove_all (self->input_sources_listbox);
-
-    if (!self->showing_extra)
-        initial = cc_common_language_get_initial_languages ();
-
-    g_hash_table_iter_init (&iter, self->locales);
-    while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &info)) {
-        if (!info->default_input_source_row && !g_hash_table_size (info->layout_rows_by_id)
-            && !g_hash_table_size (info->engine_rows_by_id))
-            continue;
-
-        if (!info->locale_row) {
-            info->locale_row = g_object_ref_sink (locale_row_new (info->name));
-            gtk_widget_set_visible (GTK_WIDGET (info->locale_row), TRUE);
-            g_object_set_data (G_OBJECT (info->locale_row), "locale-info", info);
-
-            if (!self->showing_extra && !g_hash_table_contains (initial, info->id) && !is_current_locale (info->id))
-                g_object_set_data (G_OBJECT (info->locale_row), "is-extra", GINT_TO_POINTER (TRUE));
-        }
-        gtk_list_box_append (self->input_sources_listbox, GTK_WIDGET (info->locale_row));
-    }
-
-    gtk_list_box_append (self->input_sources_listbox, GTK_WIDGET (self->more_row));
-    gtk_list_box_invalidate_filter (self->input_sources_listbox);
-    gtk_list_box_set_selection_mode (self->input_sources_listbox, GTK_SELECTION_NONE);
-    gtk_list_box_set_activate_on_single_click (self->input_sources_listbox, TRUE);
-}
+    gboolean show_more_row = self->current_locale == NULL && !self->showing_extra;
 
-static gint
-list_sort (GtkListBoxRow *a, GtkListBoxRow *b, gpointer data)
-{
-    CcInputChooser *self = data;
-    LocaleInfo *ia;
-    LocaleInfo *ib;
-    const gchar *la;
-    const gchar *lb;
-    gint retval;
-
-    /* Always goes at the end */
-    if (a == self->more_row)
-        return 1;
-    if (b == self->more_row)
-        return -1;
-
-    ia = g_object_get_data (G_OBJECT (a), "locale-info");
-    ib = g_object_get_data (G_OBJECT (b), "locale-info");
-
-    /* The "Other" locale always goes at the end */
-    if (!ia->id[0] && ib->id[0])
-        return 1;
-    else if (ia->id[0] && !ib->id[0])
-        return -1;
-
-    retval = g_strcmp0 (ia->name, ib->name);
-    if (retval)
-        return retval;
-
-    la = g_object_get_data (G_OBJECT (a), "name");
-    lb = g_object_get_data (G_OBJECT (b), "name");
-
-    /* Only input sources have a "name" property and they should always
-       go after their respective heading */
-    if (la && !lb)
-        return 1;
-    else if (!la && lb)
-        return -1;
-    else if (!la && !lb)
-        return 0; /* Shouldn't happen */
-
-    /* The default input source always goes first in its group */
-    if (g_object_get_data (G_OBJECT (a), "default"))
-        return -1;
-    if (g_object_get_data (G_OBJECT (b), "default"))
-        return 1;
-
-    return g_strcmp0 (la, lb);
+    if (show_more_row && g_list_model_get_n_items (G_LIST_MODEL (self->footer_items)) == 0)
+        g_list_store_append (self->footer_items, self->more_item);
+    else if (!show_more_row)
+        g_list_store_remove_all (self->footer_items);
 }
 
-static gboolean
-match_all (gchar **words, const gchar *str)
+static void
+show_input_sources_for_locale (CcInputChooser *self, CcInputCatalogueItem *locale)
 {
-    gchar **w;
+    g_set_object (&self->current_locale, locale);
 
-    for (w = words; *w; ++w)
-        if (!strstr (str, *w))
-            return FALSE;
+    g_list_store_remove_all (self->header_items);
+    g_list_store_append (self->header_items, self->back_item);
+    update_more_row (self);
 
-    return TRUE;
+    gtk_filter_list_model_set_model (self->filtered_items, cc_input_catalogue_item_get_sources (locale));
+    gtk_single_selection_set_selected (self->selection, GTK_INVALID_LIST_POSITION);
+    gtk_list_view_set_single_click_activate (self->input_sources_view, FALSE);
+    gtk_list_view_scroll_to (self->input_sources_view, 0, GTK_LIST_SCROLL_NONE, NULL);
 }
 
-static gboolean
-match_default_source_in_table (gchar **words, GtkListBoxRow *row)
-{
-    const gchar *source_name;
-    source_name = g_object_get_data (G_OBJECT (row), "unaccented-name");
-    if (source_name && match_all (words, source_name))
-        return TRUE;
-    return FALSE;
-}
-
-static gboolean
-match_source_in_table (gchar **words, GHashTable *table)
-{
-    GHashTableIter iter;
-    gpointer row;
-    const gchar *source_name;
-
-    g_hash_table_iter_init (&iter, table);
-    while (g_hash_table_iter_next (&iter, NULL, &row)) {
-        source_name = g_object_get_data (G_OBJECT (row), "unaccented-name");
-        if (source_name && match_all (words, source_name))
-            return TRUE;
-    }
-    return FALSE;
-}
-
-static gboolean
-list_filter (GtkListBoxRow *row, gpointer user_data)
+static void
+show_locale_rows (CcInputChooser *self)
 {
-    CcInputChooser *self = user_data;
-    LocaleInfo *info;
-    gboolean is_extra;
-    const gchar *source_name;
-
-    if (row == self->more_row)
-        return !self->showing_extra;
-
-    is_extra = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (row), "is-extra"));
+    g_clear_object (&self->current_locale);
 
-    if (!self->showing_extra && is_extra)
-        return FALSE;
-
-    if (!self->filter_words)
-        return TRUE;
-
-    info = g_object_get_data (G_OBJECT (row), "locale-info");
-
-    if (row == info->back_row)
-        return TRUE;
+    g_list_store_remove_all (self->header_items);
+    update_more_row (self);
 
-    if (match_all (self->filter_words, info->unaccented_name))
-        return TRUE;
-
-    if (match_all (self->filter_words, info->untranslated_name))
-        return TRUE;
-
-    source_name = g_object_get_data (G_OBJECT (row), "unaccented-name");
-    if (source_name) {
-        if (match_all (self->filter_words, source_name))
-            return TRUE;
-    } else {
-        if (info->default_input_source_row
-            && match_default_source_in_table (self->filter_words, info->default_input_source_row)) {
-            return TRUE;
-        }
-        if (match_source_in_table (self->filter_words, info->layout_rows_by_id))
-            return TRUE;
-        if (match_source_in_table (self->filter_words, info->engine_rows_by_id))
-            return TRUE;
-    }
-
-    return FALSE;
+    gtk_filter_list_model_set_model (self->filtered_items, cc_input_catalogue_get_locales (self->catalogue));
+    gtk_single_selection_set_selected (self->selection, GTK_INVALID_LIST_POSITION);
+    gtk_list_view_set_single_click_activate (self->input_sources_view, TRUE);
 }
 
-static gboolean
-strvs_differ (gchar **av, gchar **bv)
+static void
+update_visible_page (CcInputChooser *self)
 {
-    gchar **a, **b;
+    gboolean empty;
 
-    for (a = av, b = bv; *a && *b; ++a, ++b)
-        if (!g_str_equal (*a, *b))
-            return TRUE;
-
-    if (*a == NULL && *b == NULL)
-        return FALSE;
+    if (self->catalogue == NULL)
+        return;
 
-    return TRUE;
+    empty = g_list_model_get_n_items (G_LIST_MODEL (self->selection)) == 0;
+    gtk_stack_set_visible_child_name (self->input_sources_stack, empty ? "no-results-page" : "input-sources-page");
 }
 
 static void
@@ -541,30 +319,30 @@ show_more (CcInputChooser *self)
 {
     gtk_search_bar_set_search_mode (self->search_bar, TRUE);
 
+    if (self->showing_extra)
+        return;
+
     self->showing_extra = TRUE;
 
-    gtk_list_box_invalidate_filter (self->input_sources_listbox);
+    update_more_row (self);
+    gtk_filter_changed (GTK_FILTER (self->filter), GTK_FILTER_CHANGE_LESS_STRICT);
 }
 
 static void
 on_filter_entry_search_changed_cb (CcInputChooser *self)
 {
-    g_auto(GStrv) previous_words = NULL;
     g_autofree gchar *filter_contents = NULL;
 
     filter_contents =
         cc_util_normalize_casefold_and_unaccent (gtk_editable_get_text (GTK_EDITABLE (self->filter_entry)));
 
-    previous_words = self->filter_words;
+    g_clear_pointer (&self->filter_words, g_strfreev);
     self->filter_words = g_strsplit_set (g_strstrip (filter_contents), " ", 0);
 
     show_more (self);
 
-    if (!self->filter_words[0]) {
-        gtk_list_box_set_placeholder (self->input_sources_listbox, NULL);
-    } else if (previous_words == NULL || strvs_differ (self->filter_words, previous_words)) {
-        gtk_list_box_set_placeholder (self->input_sources_listbox, self->no_results);
-    }
+    /* The search keys are precomputed, filtering doesn't look up any name */
+    gtk_filter_changed (GTK_FILTER (self->filter), GTK_FILTER_CHANGE_DIFFERENT);
 }
 
 static void
@@ -574,54 +352,50 @@ on_add_button_clicked_cb (CcInputChooser *self)
 }
 
 static void
-on_input_sources_listbox_row_activated_cb (CcInputChooser *self, GtkListBoxRow *row)
+on_input_sources_view_activate_cb (CcInputChooser *self, guint position)
 {
-    gpointer data;
+    g_autoptr(GObject) item = NULL;
 
-    if (!row)
+    item = g_list_model_get_item (G_LIST_MODEL (self->selection), position);
+    if (!item)
         return;
 
-    if (row == self->more_row) {
+    if (item == self->more_item) {
         show_more (self);
         return;
     }
 
-    data = g_object_get_data (G_OBJECT (row), "back");
-    if (data) {
+    if (item == self->back_item) {
         show_locale_rows (self);
         return;
     }
 
-    data = g_object_get_data (G_OBJECT (row), "name");
-    if (data) {
+    if (cc_input_catalogue_item_get_kind (CC_INPUT_CATALOGUE_ITEM (item)) == CC_INPUT_CATALOGUE_ITEM_SOURCE) {
+        gtk_single_selection_set_selected (self->selection, position);
         if (gtk_widget_is_sensitive (GTK_WIDGET (self->add_button)))
             cc_input_chooser_emit_source_selected (self);
         return;
     }
 
-    data = g_object_get_data (G_OBJECT (row), "locale-info");
-    if (data) {
-        show_input_sources_for_locale (self, (LocaleInfo *) data);
-        return;
-    }
+    show_input_sources_for_locale (self, CC_INPUT_CATALOGUE_ITEM (item));
 }
 
 static void
-on_input_sources_listbox_selected_rows_changed_cb (CcInputChooser *self)
+on_selected_item_changed_cb (CcInputChooser *self)
 {
-    gboolean sensitive = TRUE;
-    GtkListBoxRow *row;
+    GObject *item;
+    gboolean sensitive = FALSE;
+
+    item = gtk_single_selection_get_selected_item (self->selection);
 
-    if (!self->input_sources_listbox) {
-        /* The rows are changing because the GtkListBox is being destroyed.
-         * during CcInputChooser dispose. We must bail.
-         */
+    /* The back row only needs a single click, like the locales */
+    if (item != NULL && item == self->back_item) {
+        show_locale_rows (self);
         return;
     }
 
-    row = gtk_list_box_get_selected_row (self->input_sources_listbox);
-    if (!row || g_object_get_data (G_OBJECT (row), "back"))
-        sensitive = FALSE;
+    if (CC_IS_INPUT_CATALOGUE_ITEM (item))
+        sensitive = cc_input_catalogue_item_get_kind (CC_INPUT_CATALOGUE_ITEM (item)) == CC_INPUT_CATALOGUE_ITEM_SOURCE;
 
     gtk_widget_set_sensitive (GTK_WIDGET (self->add_button), sensitive);
 }
@@ -638,329 +412,45 @@ on_stop_search_cb (CcInputChooser *self)
 }
 
 static void
-add_default_row (CcInputChooser *self, LocaleInfo *info, const gchar *type, const gchar *id)
-{
-    info->default_input_source_row = input_source_row_new (self, type, id);
-    if (info->default_input_source_row) {
-        g_object_ref_sink (GTK_WIDGET (info->default_input_source_row));
-        g_object_set_data (G_OBJECT (info->default_input_source_row), "default", GINT_TO_POINTER (TRUE));
-        g_object_set_data (G_OBJECT (info->default_input_source_row), "locale-info", info);
-    }
-}
-
-static void
-add_rows_to_table (CcInputChooser *self, LocaleInfo *info, GList *list, const gchar *type, const gchar *default_id)
-{
-    GHashTable *table;
-    GtkListBoxRow *row;
-    const gchar *id;
-
-    if (g_str_equal (type, INPUT_SOURCE_TYPE_XKB))
-        table = info->layout_rows_by_id;
-    else if (g_str_equal (type, INPUT_SOURCE_TYPE_IBUS))
-        table = info->engine_rows_by_id;
-    else
-        return;
-
-    while (list) {
-        id = (const gchar *) list->data;
-
-        /* The widget for the default input source lives elsewhere */
-        if (g_strcmp0 (id, default_id)) {
-            row = input_source_row_new (self, type, id);
-            if (row) {
-                g_object_set_data (G_OBJECT (row), "locale-info", info);
-                g_hash_table_replace (table, (gpointer) id, g_object_ref_sink (row));
-            }
-        }
-        list = list->next;
-    }
-}
-
-static void
-add_row (CcInputChooser *self, LocaleInfo *info, const gchar *type, const gchar *id)
+on_catalogue_loaded_cb (GObject *source_object, GAsyncResult *result, gpointer user_data)
 {
-    GList tmp = { 0 };
-    tmp.data = (gpointer) id;
-    add_rows_to_table (self, info, &tmp, type, NULL);
-}
-
-static void
-add_row_other (CcInputChooser *self, const gchar *type, const gchar *id)
-{
-    LocaleInfo *info = g_hash_table_lookup (self->locales, "");
-    add_row (self, info, type, id);
-}
-
-#ifdef HAVE_IBUS
-static gboolean
-maybe_set_as_default (CcInputChooser *self, LocaleInfo *info, const gchar *engine_id)
-{
-    const gchar *type, *id;
-
-    if (!gnome_get_input_source_from_locale (info->id, &type, &id))
-        return FALSE;
-
-    if (g_str_equal (type, INPUT_SOURCE_TYPE_IBUS) && g_str_equal (id, engine_id)
-        && info->default_input_source_row == NULL) {
-        add_default_row (self, info, type, id);
-        return TRUE;
-    }
-
-    return FALSE;
-}
-
-static void
-get_ibus_locale_infos (CcInputChooser *self)
-{
-    GHashTableIter iter;
-    LocaleInfo *info;
-    const gchar *engine_id;
-    IBusEngineDesc *engine;
-
-    if (!self->ibus_engines)
+    CcInputChooser *self = CC_INPUT_CHOOSER (source_object);
+    g_autoptr(GError) error = NULL;
+    CcInputCatalogue *catalogue;
+
+    /* An unpropagated catalogue is freed along with the task */
+    catalogue = g_task_propagate_pointer (G_TASK (result), &error);
+    if (catalogue == NULL) {
+        if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            g_warning ("Failed to load the input sources: %s", error->message);
         return;
-
-    g_hash_table_iter_init (&iter, self->ibus_engines);
-    while (g_hash_table_iter_next (&iter, (gpointer *) &engine_id, (gpointer *) &engine)) {
-        g_autofree gchar *lang_code = NULL;
-        g_autofree gchar *country_code = NULL;
-        const gchar *ibus_locale = ibus_engine_desc_get_language (engine);
-
-        if (gnome_parse_locale (ibus_locale, &lang_code, &country_code, NULL, NULL) && lang_code != NULL
-            && country_code != NULL) {
-            g_autofree gchar *locale = g_strdup_printf ("%s_%s.UTF-8", lang_code, country_code);
-
-            info = g_hash_table_lookup (self->locales, locale);
-            if (info) {
-                const gchar *type, *id;
-
-                if (gnome_get_input_source_from_locale (locale, &type, &id)
-                    && g_str_equal (type, INPUT_SOURCE_TYPE_IBUS) && g_str_equal (id, engine_id)) {
-                    add_default_row (self, info, type, id);
-                } else {
-                    add_row (self, info, INPUT_SOURCE_TYPE_IBUS, engine_id);
-                }
-            } else {
-                add_row_other (self, INPUT_SOURCE_TYPE_IBUS, engine_id);
-            }
-        } else if (lang_code != NULL) {
-            GHashTableIter iter;
-            GHashTable *locales_for_language;
-            g_autofree gchar *language = NULL;
-
-            /* Most IBus engines only specify the language so we try to
-               add them to all locales for that language. */
-
-            language = gnome_get_language_from_code (lang_code, NULL);
-            if (language)
-                locales_for_language = g_hash_table_lookup (self->locales_by_language, language);
-            else
-                locales_for_language = NULL;
-
-            if (locales_for_language) {
-                g_hash_table_iter_init (&iter, locales_for_language);
-                while (g_hash_table_iter_next (&iter, (gpointer *) &info, NULL))
-                    if (!maybe_set_as_default (self, info, engine_id))
-                        add_row (self, info, INPUT_SOURCE_TYPE_IBUS, engine_id);
-            } else {
-                add_row_other (self, INPUT_SOURCE_TYPE_IBUS, engine_id);
-            }
-        } else {
-            add_row_other (self, INPUT_SOURCE_TYPE_IBUS, engine_id);
-        }
-    }
-}
-#endif /* HAVE_IBUS */
-
-static void
-add_locale_to_table (GHashTable *table, const gchar *lang_code, LocaleInfo *info)
-{
-    GHashTable *set;
-    g_autofree gchar *language = NULL;
-
-    language = gnome_get_language_from_code (lang_code, NULL);
-
-    set = g_hash_table_lookup (table, language);
-    if (!set) {
-        set = g_hash_table_new (NULL, NULL);
-        g_hash_table_replace (table, g_strdup (language), set);
-    }
-    g_hash_table_add (set, info);
-}
-
-static void
-add_ids_to_set (GHashTable *set, GList *list)
-{
-    while (list) {
-        g_hash_table_add (set, list->data);
-        list = list->next;
-    }
-}
-
-static GList *
-layout_lists_intersection (GList *first_list, GList *second_list)
-{
-    g_autoptr(GHashTable) first_set = NULL;
-    g_autoptr(GList) intersection_list = NULL;
-
-    first_set = g_hash_table_new (g_str_hash, g_str_equal);
-
-    while (first_list != NULL) {
-        char *layout;
-
-        layout = first_list->data;
-        g_hash_table_insert (first_set, layout, layout);
-        first_list = first_list->next;
-    }
-
-    while (second_list != NULL) {
-        char *layout;
-
-        layout = second_list->data;
-        if (g_hash_table_remove (first_set, layout))
-            intersection_list = g_list_prepend (intersection_list, layout);
-
-        second_list = second_list->next;
     }
 
-    return g_steal_pointer (&intersection_list);
-}
+    self->catalogue = catalogue;
+    if (self->ibus_engines)
+        cc_input_catalogue_add_ibus_engines (self->catalogue, self->ibus_engines);
 
-static void
-get_locale_infos (CcInputChooser *self)
-{
-    g_autoptr(GHashTable) layouts_with_locale = NULL;
-    LocaleInfo *info;
-    g_auto(GStrv) locale_ids = NULL;
-    gchar **locale;
-    g_autoptr(GList) all_layouts = NULL;
-    GList *l;
-
-    self->locales = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, locale_info_free);
-    self->locales_by_language =
-        g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_hash_table_unref);
-
-    layouts_with_locale = g_hash_table_new (g_str_hash, g_str_equal);
-
-    locale_ids = gnome_get_all_locales ();
-    for (locale = locale_ids; *locale; ++locale) {
-        g_autofree gchar *lang_code = NULL;
-        g_autofree gchar *country_code = NULL;
-        g_autofree gchar *simple_locale = NULL;
-        g_autofree gchar *tmp = NULL;
-        const gchar *type = NULL;
-        const gchar *id = NULL;
-        g_autoptr(GList) language_layouts = NULL;
-        g_autoptr(GList) locale_layouts = NULL;
-
-        if (!gnome_parse_locale (*locale, &lang_code, &country_code, NULL, NULL))
-            continue;
-
-        if (country_code != NULL)
-            simple_locale = g_strdup_printf ("%s_%s.UTF-8", lang_code, country_code);
-        else
-            simple_locale = g_strdup_printf ("%s.UTF-8", lang_code);
-
-        if (g_hash_table_contains (self->locales, simple_locale))
-            continue;
-
-        info = g_new0 (LocaleInfo, 1);
-        info->id = g_strdup (simple_locale);
-        info->name = gnome_get_language_from_locale (simple_locale, NULL);
-        info->unaccented_name = cc_util_normalize_casefold_and_unaccent (info->name);
-        tmp = gnome_get_language_from_locale (simple_locale, "C");
-        info->untranslated_name = cc_util_normalize_casefold_and_unaccent (tmp);
-
-        g_hash_table_replace (self->locales, g_strdup (simple_locale), info);
-        add_locale_to_table (self->locales_by_language, lang_code, info);
-
-        if (gnome_get_input_source_from_locale (simple_locale, &type, &id)
-            && g_str_equal (type, INPUT_SOURCE_TYPE_XKB)) {
-            add_default_row (self, info, type, id);
-            g_hash_table_add (layouts_with_locale, (gpointer) id);
-        }
-
-        /* We don't own these ids */
-        info->layout_rows_by_id = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_object_unref);
-        info->engine_rows_by_id = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_object_unref);
-
-        language_layouts = gnome_xkb_info_get_layouts_for_language (self->xkb_info, lang_code);
-
-        if (country_code != NULL) {
-            g_autoptr(GList) country_layouts = gnome_xkb_info_get_layouts_for_country (self->xkb_info, country_code);
-            locale_layouts = layout_lists_intersection (language_layouts, country_layouts);
-        } else {
-            locale_layouts = g_steal_pointer (&language_layouts);
-        }
-
-        add_rows_to_table (self, info, locale_layouts, INPUT_SOURCE_TYPE_XKB, id);
-        add_ids_to_set (layouts_with_locale, locale_layouts);
-    }
-
-    /* Add a "Other" locale to hold the remaining input sources */
-    info = g_new0 (LocaleInfo, 1);
-    info->id = g_strdup ("");
-    info->name = g_strdup (C_("Input Source", "Other"));
-    info->unaccented_name = g_strdup ("");
-    info->untranslated_name = g_strdup ("");
-    g_hash_table_replace (self->locales, g_strdup (info->id), info);
-
-    info->layout_rows_by_id = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_object_unref);
-    info->engine_rows_by_id = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_object_unref);
-
-    all_layouts = gnome_xkb_info_get_all_layouts (self->xkb_info);
-    for (l = all_layouts; l; l = l->next)
-        if (!g_hash_table_contains (layouts_with_locale, l->data))
-            add_row_other (self, INPUT_SOURCE_TYPE_XKB, l->data);
-}
-
-/*
-static gboolean
-on_filter_entry_key_release_event_cb (CcInputChooser *self, GdkEventKey *event)
-{
-  if (event->keyval == GDK_KEY_Escape) {
-    self->showing_extra = FALSE;
-    gtk_entry_set_text (GTK_ENTRY (self->filter_entry), "");
-    gtk_widget_set_visible (GTK_WIDGET (self->filter_entry), FALSE);
-    g_clear_pointer (&self->filter_words, g_strfreev);
     show_locale_rows (self);
-  }
-
-  return FALSE;
+    update_visible_page (self);
 }
- */
 
 static void
-on_locale_infos_loaded_cb (GObject *source_object, GAsyncResult *result, gpointer user_data)
+cc_input_chooser_load_catalogue_thread (GTask *task, gpointer source_object, gpointer task_data,
+                                        GCancellable *cancellable)
 {
-    CcInputChooser *self = CC_INPUT_CHOOSER (source_object);
+    GnomeXkbInfo *xkb_info = task_data;
 
-    gtk_stack_set_visible_child_name (self->input_sources_stack, "input-sources-page");
+    g_task_return_pointer (task, cc_input_catalogue_new (xkb_info), (GDestroyNotify) cc_input_catalogue_free);
 }
 
 static void
-cc_input_chooser_load_locale_infos_thread (GTask *task, gpointer source_object, gpointer task_data,
-                                           GCancellable *cancellable)
-{
-    CcInputChooser *self = CC_INPUT_CHOOSER (source_object);
-
-    get_locale_infos (self);
-#ifdef HAVE_IBUS
-    get_ibus_locale_infos (self);
-#endif /* HAVE_IBUS */
-    show_locale_rows (self);
-
-    g_task_return_pointer (task, NULL, NULL);
-}
-
-static void
-cc_input_chooser_load_locale_infos_async (CcInputChooser *self, GCancellable *cancellable, GAsyncReadyCallback callback,
-                                          gpointer user_data)
+cc_input_chooser_load_catalogue_async (CcInputChooser *self, GCancellable *cancellable, GAsyncReadyCallback callback,
+                                       gpointer user_data)
 {
     g_autoptr(GTask) task = g_task_new (self, cancellable, callback, user_data);
 
-    g_task_run_in_thread (task, cc_input_chooser_load_locale_infos_thread);
+    g_task_set_task_data (task, g_object_ref (self->xkb_info), g_object_unref);
+    g_task_run_in_thread (task, cc_input_chooser_load_catalogue_thread);
 }
 
 static void
@@ -968,12 +458,21 @@ cc_input_chooser_dispose (GObject *object)
 {
     CcInputChooser *self = CC_INPUT_CHOOSER (object);
 
-    g_clear_object (&self->more_row);
-    g_clear_object (&self->no_results);
+    g_cancellable_cancel (self->cancellable);
+    g_clear_object (&self->cancellable);
+
+    g_clear_object (&self->selection);
+    g_clear_object (&self->filtered_items);
+    g_clear_object (&self->filter);
+    g_clear_object (&self->header_items);
+    g_clear_object (&self->footer_items);
+    g_clear_object (&self->back_item);
+    g_clear_object (&self->more_item);
+    g_clear_object (&self->current_locale);
     g_clear_object (&self->xkb_info);
     g_clear_pointer (&self->ibus_engines, g_hash_table_unref);
-    g_clear_pointer (&self->locales, g_hash_table_unref);
-    g_clear_pointer (&self->locales_by_language, g_hash_table_unref);
+    g_clear_pointer (&self->catalogue, cc_input_catalogue_free);
+    g_clear_pointer (&self->initial_locales, g_hash_table_unref);
     g_clear_pointer (&self->filter_words, g_strfreev);
 
     G_OBJECT_CLASS (cc_input_chooser_parent_class)->dispose (object);
@@ -995,24 +494,52 @@ cc_input_chooser_class_init (CcInputChooserClass *klass)
 
     gtk_widget_class_bind_template_child (widget_class, CcInputChooser, add_button);
     gtk_widget_class_bind_template_child (widget_class, CcInputChooser, filter_entry);
-    gtk_widget_class_bind_template_child (widget_class, CcInputChooser, input_sources_listbox);
+    gtk_widget_class_bind_template_child (widget_class, CcInputChooser, input_sources_view);
     gtk_widget_class_bind_template_child (widget_class, CcInputChooser, input_sources_stack);
     gtk_widget_class_bind_template_child (widget_class, CcInputChooser, search_bar);
 
-    gtk_widget_class_bind_template_callback (widget_class, on_input_sources_listbox_row_activated_cb);
-    gtk_widget_class_bind_template_callback (widget_class, on_input_sources_listbox_selected_rows_changed_cb);
+    gtk_widget_class_bind_template_callback (widget_class, on_factory_bind_cb);
+    gtk_widget_class_bind_template_callback (widget_class, on_factory_unbind_cb);
+    gtk_widget_class_bind_template_callback (widget_class, on_input_sources_view_activate_cb);
     gtk_widget_class_bind_template_callback (widget_class, on_filter_entry_search_changed_cb);
     gtk_widget_class_bind_template_callback (widget_class, on_add_button_clicked_cb);
     gtk_widget_class_bind_template_callback (widget_class, on_stop_search_cb);
-    // gtk_widget_class_bind_template_callback (widget_class, on_filter_entry_key_release_event_cb);
 }
 
 void
 cc_input_chooser_init (CcInputChooser *self)
 {
+    g_autoptr(GListStore) sections = NULL;
+
     gtk_widget_init_template (GTK_WIDGET (self));
 
     gtk_search_bar_set_key_capture_widget (self->search_bar, GTK_WIDGET (self));
+
+    self->back_item = g_object_new (G_TYPE_OBJECT, NULL);
+    self->more_item = g_object_new (G_TYPE_OBJECT, NULL);
+    self->header_items = g_list_store_new (G_TYPE_OBJECT);
+    self->footer_items = g_list_store_new (G_TYPE_OBJECT);
+
+    self->filter = gtk_custom_filter_new (filter_item, self, NULL);
+    self->filtered_items = gtk_filter_list_model_new (NULL, GTK_FILTER (g_object_ref (self->filter)));
+
+    sections = g_list_store_new (G_TYPE_LIST_MODEL);
+    g_list_store_append (sections, self->header_items);
+    g_list_store_append (sections, self->filtered_items);
+    g_list_store_append (sections, self->footer_items);
+
+    self->selection = gtk_single_selection_new (G_LIST_MODEL (gtk_flatten_list_model_new (
+        G_LIST_MODEL (g_steal_pointer (&sections)))));
+    gtk_single_selection_set_autoselect (self->selection, FALSE);
+    gtk_single_selection_set_can_unselect (self->selection, TRUE);
+    g_signal_connect_object (self->selection, "notify::selected-item", G_CALLBACK (on_selected_item_changed_cb), self,
+                             G_CONNECT_SWAPPED);
+    g_signal_connect_object (self->selection, "items-changed", G_CALLBACK (update_visible_page), self,
+                             G_CONNECT_SWAPPED);
+
+    gtk_list_view_set_model (self->input_sources_view, GTK_SELECTION_MODEL (self->selection));
+
+    self->initial_locales = cc_common_language_get_initial_languages ();
 }
 
 CcInputChooser *
@@ -1026,13 +553,8 @@ cc_input_chooser_new (GnomeXkbInfo *xkb_info, GHashTable *ibus_engines)
     if (ibus_engines)
         self->ibus_engines = g_hash_table_ref (ibus_engines);
 
-    self->more_row = g_object_ref_sink (more_row_new ());
-    self->no_results = g_object_ref_sink (no_results_widget_new ());
-
-    gtk_list_box_set_filter_func (self->input_sources_listbox, list_filter, self, NULL);
-    gtk_list_box_set_sort_func (self->input_sources_listbox, list_sort, self, NULL);
-
-    cc_input_chooser_load_locale_infos_async (self, NULL, on_locale_infos_loaded_cb, NULL);
+    self->cancellable = g_cancellable_new ();
+    cc_input_chooser_load_catalogue_async (self, self->cancellable, on_catalogue_loaded_cb, NULL);
 
     return self;
 }
@@ -1048,28 +570,30 @@ cc_input_chooser_set_ibus_engines (CcInputChooser *self, GHashTable *ibus_engine
     g_return_if_fail (self->ibus_engines == NULL);
 
     self->ibus_engines = ibus_engines;
-    get_ibus_locale_infos (self);
-    show_locale_rows (self);
+
+    /* Otherwise they are added once the catalogue is loaded */
+    if (self->catalogue) {
+        cc_input_catalogue_add_ibus_engines (self->catalogue, self->ibus_engines);
+        gtk_filter_changed (GTK_FILTER (self->filter), GTK_FILTER_CHANGE_LESS_STRICT);
+    }
 #endif /* HAVE_IBUS */
 }
 
 CcInputSource *
 cc_input_chooser_get_source (CcInputChooser *self)
 {
-    GtkListBoxRow *selected;
+    GObject *selected;
     const gchar *t, *i;
 
     g_return_val_if_fail (CC_IS_INPUT_CHOOSER (self), FALSE);
 
-    selected = gtk_list_box_get_selected_row (self->input_sources_listbox);
-    if (!selected)
+    selected = gtk_single_selection_get_selected_item (self->selection);
+    if (!CC_IS_INPUT_CATALOGUE_ITEM (selected)
+        || cc_input_catalogue_item_get_kind (CC_INPUT_CATALOGUE_ITEM (selected)) != CC_INPUT_CATALOGUE_ITEM_SOURCE)
         return NULL;
 
-    t = g_object_get_data (G_OBJECT (selected), "type");
-    i = g_object_get_data (G_OBJECT (selected), "id");
-
-    if (!t || !i)
-        return FALSE;
+    t = cc_input_catalogue_item_get_source_type (CC_INPUT_CATALOGUE_ITEM (selected));
+    i = cc_input_catalogue_item_get_id (CC_INPUT_CATALOGUE_ITEM (selected));
 
     if (g_strcmp0 (t, "xkb") == 0)
         return CC_INPUT_SOURCE (cc_input_source_xkb_new_from_id (self->xkb_info, i));
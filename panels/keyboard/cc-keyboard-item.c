@@ -669,6 +669,26 @@ cc_keyboard_item_load_from_gsettings_path (CcKeyboardItem *item, const char *pat
     return TRUE;
 }
 
+/* Most shortcuts are keys of a handful of schemas, so share a settings
+ * object between all the items of each schema, across all the managers. */
+static GSettings *
+get_settings_for_schema (const char *schema)
+{
+    static GHashTable *schema_settings = NULL;
+    GSettings *settings;
+
+    if (!schema_settings)
+        schema_settings = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+
+    settings = g_hash_table_lookup (schema_settings, schema);
+    if (!settings) {
+        settings = g_settings_new (schema);
+        g_hash_table_insert (schema_settings, g_strdup (schema), settings);
+    }
+
+    return g_object_ref (settings);
+}
+
 gboolean
 cc_keyboard_item_load_from_gsettings (CcKeyboardItem *item, const char *description, const char *schema,
                                       const char *key)
@@ -680,7 +700,7 @@ cc_keyboard_item_load_from_gsettings (CcKeyboardItem *item, const char *descript
     item->key = g_strdup (key);
     item->description = g_strdup (description);
 
-    item->settings = g_settings_new (item->schema);
+    item->settings = get_settings_for_schema (item->schema);
     item->editable = g_settings_is_writable (item->settings, item->key);
 
     g_list_free_full (item->key_combos, g_free);
@@ -45,6 +45,11 @@ struct _CcKeyboardManager {
 
     GSettings *binding_settings;
     GSettings *global_shortcuts_settings;
+
+    /* CcKeyCombo -> GPtrArray of CcKeyboardItem, see combo_index_key() */
+    GHashTable *combo_index;
+    /* CcKeyboardItem -> GArray of the CcKeyCombo it is indexed under */
+    GHashTable *indexed_items;
 };
 
 G_DEFINE_FINAL_TYPE (CcKeyboardManager, cc_keyboard_manager, G_TYPE_OBJECT)
@@ -82,76 +87,114 @@ free_key_array (GPtrArray *keys)
     }
 }
 
+/*
+ * A combo with a keyval conflicts with any other one with the same keyval
+ * and modifiers, whatever its keycode. Keycodes are only compared for combos
+ * without a keyval, so they are left out of the key of the former.
+ */
+static CcKeyCombo
+combo_index_key (const CcKeyCombo *combo)
+{
+    CcKeyCombo key = { 0 };
+
+    key.keyval = combo->keyval;
+    key.keycode = combo->keyval == 0 ? combo->keycode : 0;
+    key.mask = combo->mask;
+
+    return key;
+}
+
+static guint
+combo_index_hash (gconstpointer data)
+{
+    const CcKeyCombo *key = data;
+
+    return (key->keyval * 31 + key->keycode) * 31 + key->mask;
+}
+
 static gboolean
-find_conflict (CcUniquenessData *data, CcKeyboardItem *item)
+combo_index_equal (gconstpointer a, gconstpointer b)
 {
-    GList *l;
-    gboolean is_conflict = FALSE;
+    const CcKeyCombo *key_a = a;
+    const CcKeyCombo *key_b = b;
 
-    if (data->orig_item && cc_keyboard_item_equal (data->orig_item, item))
-        return FALSE;
+    return key_a->keyval == key_b->keyval && key_a->keycode == key_b->keycode && key_a->mask == key_b->mask;
+}
 
-    for (l = cc_keyboard_item_get_key_combos (item); l; l = l->next) {
-        CcKeyCombo *combo = l->data;
+static void item_key_combos_changed_cb (CcKeyboardItem *item, GParamSpec *pspec, CcKeyboardManager *self);
 
-        if (data->new_mask != combo->mask)
-            continue;
+static void
+unindex_item (CcKeyboardManager *self, CcKeyboardItem *item)
+{
+    GArray *keys;
 
-        if (data->new_keyval != 0)
-            is_conflict = data->new_keyval == combo->keyval;
-        else
-            is_conflict = combo->keyval == 0 && data->new_keycode == combo->keycode;
+    keys = g_hash_table_lookup (self->indexed_items, item);
+    if (!keys)
+        return;
 
-        if (is_conflict)
-            break;
-    }
+    for (guint i = 0; i < keys->len; i++) {
+        CcKeyCombo *key = &g_array_index (keys, CcKeyCombo, i);
+        GPtrArray *items;
+
+        items = g_hash_table_lookup (self->combo_index, key);
+        if (!items)
+            continue;
 
-    if (is_conflict)
-        data->conflict_item = item;
+        g_ptr_array_remove (items, item);
+        if (items->len == 0)
+            g_hash_table_remove (self->combo_index, key);
+    }
 
-    return is_conflict;
+    g_signal_handlers_disconnect_by_func (item, item_key_combos_changed_cb, self);
+    g_hash_table_remove (self->indexed_items, item);
 }
 
-static gboolean
-compare_keys_for_uniqueness (CcKeyboardItem *current_item, CcUniquenessData *data)
+static void
+index_item (CcKeyboardManager *self, CcKeyboardItem *item)
 {
-    CcKeyboardItem *reverse_item;
+    GArray *keys;
+    GList *l;
 
-    /* No conflict for: blanks or ourselves */
-    if (!current_item || data->orig_item == current_item)
-        return FALSE;
+    unindex_item (self, item);
 
-    reverse_item = cc_keyboard_item_get_reverse_item (current_item);
+    keys = g_array_new (FALSE, FALSE, sizeof (CcKeyCombo));
 
-    /* When the current item is the reversed shortcut of a main item, simply ignore it */
-    if (reverse_item && cc_keyboard_item_is_hidden (current_item))
-        return FALSE;
+    for (l = cc_keyboard_item_get_key_combos (item); l; l = l->next) {
+        CcKeyCombo key = combo_index_key (l->data);
+        GPtrArray *items;
 
-    if (find_conflict (data, current_item))
-        return TRUE;
+        items = g_hash_table_lookup (self->combo_index, &key);
+        if (!items) {
+            items = g_ptr_array_new ();
+            g_hash_table_insert (self->combo_index, g_memdup2 (&key, sizeof (key)), items);
+        }
 
-    /* Also check for the reverse item if any */
-    if (reverse_item && find_conflict (data, reverse_item))
-        return TRUE;
+        g_ptr_array_add (items, item);
+        g_array_append_val (keys, key);
+    }
 
-    return FALSE;
+    g_hash_table_insert (self->indexed_items, item, keys);
+    g_signal_connect (item, "notify::key-combos", G_CALLBACK (item_key_combos_changed_cb), self);
 }
 
-static gboolean
-check_for_uniqueness (gpointer key, GPtrArray *keys_array, CcUniquenessData *data)
+static void
+item_key_combos_changed_cb (CcKeyboardItem *item, GParamSpec *pspec, CcKeyboardManager *self)
 {
-    guint i;
-
-    for (i = 0; i < keys_array->len; i++) {
-        CcKeyboardItem *item;
+    index_item (self, item);
+}
 
-        item = keys_array->pdata[i];
+static void
+clear_index (CcKeyboardManager *self)
+{
+    GHashTableIter iter;
+    gpointer item;
 
-        if (compare_keys_for_uniqueness (item, data))
-            return TRUE;
-    }
+    g_hash_table_iter_init (&iter, self->indexed_items);
+    while (g_hash_table_iter_next (&iter, &item, NULL))
+        g_signal_handlers_disconnect_by_func (item, item_key_combos_changed_cb, self);
 
-    return FALSE;
+    g_hash_table_remove_all (self->indexed_items);
+    g_hash_table_remove_all (self->combo_index);
 }
 
 static GHashTable *
@@ -316,6 +359,7 @@ append_section (CcKeyboardManager *self, const gchar *title, const gchar *id, Bi
         cc_keyboard_item_set_hidden (item, keys_list[i].hidden);
 
         g_ptr_array_add (keys_array, item);
+        index_item (self, item);
     }
 
     g_hash_table_destroy (reverse_items);
@@ -334,74 +378,62 @@ append_section (CcKeyboardManager *self, const gchar *title, const gchar *id, Bi
 static void
 append_sections_from_file (CcKeyboardManager *self, const gchar *path, const char *datadir, gchar **wm_keybindings)
 {
-    KeyList *keylist;
-    KeyListEntry *keys;
+    g_autoptr(GVariant) keylist = NULL;
+    g_autoptr(GVariant) entries = NULL;
+    g_autoptr(GArray) keys = NULL;
+    const char *name, *group_name, *package, *wm_name;
     KeyListEntry key = { 0 };
+    GVariantIter iter;
     const char *title;
     int group;
-    guint i;
 
-    keylist = parse_keylist_from_file (path);
+    keylist = load_keylist_from_file (path);
 
     if (keylist == NULL)
         return;
 
+    g_variant_get (keylist, "(m&sm&sm&sm&s@a(ssmsmsbb))", &name, &group_name, &package, &wm_name, &entries);
+
 #define const_strv(s) ((const gchar *const *) s)
 
     /* If there's no keys to add, or the settings apply to a window manager
      * that's not the one we're running */
-    if (keylist->entries->len == 0
-        || (keylist->wm_name != NULL && !g_strv_contains (const_strv (wm_keybindings), keylist->wm_name))
-        || keylist->name == NULL) {
-        g_free (keylist->name);
-        g_free (keylist->package);
-        g_free (keylist->wm_name);
-        g_array_free (keylist->entries, TRUE);
-        g_free (keylist);
+    if (g_variant_n_children (entries) == 0
+        || (wm_name != NULL && !g_strv_contains (const_strv (wm_keybindings), wm_name)) || name == NULL)
         return;
-    }
 
 #undef const_strv
 
+    /* The strings are owned by the cached keylist */
+    keys = g_array_sized_new (FALSE, TRUE, sizeof (KeyListEntry), g_variant_n_children (entries) + 1);
+    key.type = CC_KEYBOARD_ITEM_TYPE_GSETTINGS;
+
+    g_variant_iter_init (&iter, entries);
+    while (g_variant_iter_next (&iter, "(&s&sm&sm&sbb)", &key.name, &key.schema, &key.description, &key.reverse_entry,
+                                &key.is_reversed, &key.hidden))
+        g_array_append_val (keys, key);
+
     /* Empty KeyListEntry to end the array */
-    key.name = NULL;
-    g_array_append_val (keylist->entries, key);
+    memset (&key, 0, sizeof (key));
+    g_array_append_val (keys, key);
 
-    keys = (KeyListEntry *) (gpointer) g_array_free (keylist->entries, FALSE);
-    if (keylist->package) {
+    if (package) {
         g_autofree gchar *localedir = NULL;
 
         localedir = g_build_filename (datadir, "locale", NULL);
-        bindtextdomain (keylist->package, localedir);
+        bindtextdomain (package, localedir);
 
-        title = dgettext (keylist->package, keylist->name);
+        title = dgettext (package, name);
     } else {
-        title = _(keylist->name);
+        title = _(name);
     }
 
-    if (keylist->group && strcmp (keylist->group, "system") == 0)
+    if (group_name && strcmp (group_name, "system") == 0)
         group = BINDING_GROUP_SYSTEM;
     else
         group = BINDING_GROUP_APPS;
 
-    append_section (self, title, keylist->name, group, keys);
-
-    g_free (keylist->name);
-    g_free (keylist->package);
-    g_free (keylist->wm_name);
-    g_free (keylist->schema);
-    g_free (keylist->group);
-
-    for (i = 0; keys[i].name != NULL; i++) {
-        KeyListEntry *entry = &keys[i];
-        g_free (entry->schema);
-        g_free (entry->description);
-        g_free (entry->name);
-        g_free (entry->reverse_entry);
-    }
-
-    g_free (keylist);
-    g_free (keys);
+    append_section (self, title, name, group, (KeyListEntry *) (gpointer) keys->data);
 }
 
 static void
@@ -526,6 +558,7 @@ reload_sections (CcKeyboardManager *self)
 
     /* Clear previous models and hash tables */
     gtk_list_store_clear (GTK_LIST_STORE (self->sections_store));
+    clear_index (self);
 
     g_clear_pointer (&self->kb_system_sections, g_hash_table_destroy);
     self->kb_system_sections = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) free_key_array);
@@ -582,6 +615,9 @@ cc_keyboard_manager_finalize (GObject *object)
 {
     CcKeyboardManager *self = (CcKeyboardManager *) object;
 
+    clear_index (self);
+    g_clear_pointer (&self->combo_index, g_hash_table_destroy);
+    g_clear_pointer (&self->indexed_items, g_hash_table_destroy);
     g_clear_pointer (&self->kb_system_sections, g_hash_table_destroy);
     g_clear_pointer (&self->kb_apps_sections, g_hash_table_destroy);
     g_clear_pointer (&self->kb_user_sections, g_hash_table_destroy);
@@ -658,6 +694,11 @@ cc_keyboard_manager_init (CcKeyboardManager *self)
 
     /* Setup the section models */
     self->sections_store = gtk_list_store_new (SECTION_N_COLUMNS, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_INT);
+
+    /* Conflict lookups */
+    self->combo_index =
+        g_hash_table_new_full (combo_index_hash, combo_index_equal, g_free, (GDestroyNotify) g_ptr_array_unref);
+    self->indexed_items = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) g_array_unref);
 }
 
 CcKeyboardManager *
@@ -756,6 +797,7 @@ cc_keyboard_manager_add_custom_shortcut (CcKeyboardManager *self, CcKeyboardItem
     }
 
     g_ptr_array_add (keys_array, item);
+    index_item (self, item);
 
     settings_paths = g_settings_get_strv (self->binding_settings, "custom-keybindings");
 
@@ -792,6 +834,8 @@ cc_keyboard_manager_remove_custom_shortcut (CcKeyboardManager *self, CcKeyboardI
     /* Shortcut not a custom shortcut */
     g_assert (cc_keyboard_item_get_item_type (item) == CC_KEYBOARD_ITEM_TYPE_GSETTINGS_PATH);
 
+    unindex_item (self, item);
+
     settings = cc_keyboard_item_get_settings (item);
     g_settings_delay (settings);
     g_settings_reset (settings, "name");
@@ -890,33 +934,37 @@ cc_keyboard_manager_get_global_shortcuts (CcKeyboardManager *self, const char *a
 CcKeyboardItem *
 cc_keyboard_manager_get_collision (CcKeyboardManager *self, CcKeyboardItem *item, CcKeyCombo *combo)
 {
-    CcUniquenessData data;
-    BindingGroupType i;
+    CcKeyCombo key;
+    GPtrArray *items;
+    guint i;
 
     g_return_val_if_fail (CC_IS_KEYBOARD_MANAGER (self), NULL);
 
-    data.orig_item = item;
-    data.new_keyval = combo->keyval;
-    data.new_mask = combo->mask;
-    data.new_keycode = combo->keycode;
-    data.conflict_item = NULL;
-
+    /* Any number of shortcuts can be disabled */
     if (combo->keyval == 0 && combo->keycode == 0)
         return NULL;
 
-    /* Any number of shortcuts can be disabled */
-    for (i = BINDING_GROUP_SYSTEM; i <= BINDING_GROUP_USER && !data.conflict_item; i++) {
-        GHashTable *table;
+    key = combo_index_key (combo);
+    items = g_hash_table_lookup (self->combo_index, &key);
+    if (!items)
+        return NULL;
 
-        table = get_hash_for_group (self, i);
+    for (i = 0; i < items->len; i++) {
+        CcKeyboardItem *candidate = g_ptr_array_index (items, i);
+
+        /* No conflict with ourselves */
+        if (item && (candidate == item || cc_keyboard_item_equal (item, candidate)))
+            continue;
 
-        if (!table)
+        /* The reversed shortcut of a main item is only checked along with
+         * it, so it doesn't conflict with the main item being edited */
+        if (item && cc_keyboard_item_is_hidden (candidate) && cc_keyboard_item_get_reverse_item (candidate) == item)
             continue;
 
-        g_hash_table_find (table, (GHRFunc) check_for_uniqueness, &data);
+        return candidate;
     }
 
-    return data.conflict_item;
+    return NULL;
 }
 
 /**
@@ -23,11 +23,21 @@
 #include <config.h>
 
 #include <glib/gi18n.h>
+#include <glib/gstdio.h>
 
 #include "keyboard-shortcuts.h"
 
 #define CUSTOM_KEYS_BASENAME "/org/gnome/settings-daemon/plugins/media-keys/custom-keybindings"
 
+typedef struct {
+    gint64 mtime;
+    gint64 size;
+    GVariant *keylist;
+} CachedKeyList;
+
+/* path -> CachedKeyList, shared by all the keyboard managers */
+static GHashTable *keylist_cache = NULL;
+
 static char *
 replace_pictures_folder (const char *description)
 {
@@ -311,6 +321,90 @@ parse_keylist_from_file (const gchar *path)
     return keylist;
 }
 
+static void
+keylist_free (KeyList *keylist)
+{
+    for (guint i = 0; i < keylist->entries->len; i++) {
+        KeyListEntry *entry = &g_array_index (keylist->entries, KeyListEntry, i);
+
+        g_free (entry->schema);
+        g_free (entry->description);
+        g_free (entry->name);
+        g_free (entry->reverse_entry);
+    }
+
+    g_array_free (keylist->entries, TRUE);
+    g_free (keylist->name);
+    g_free (keylist->group);
+    g_free (keylist->package);
+    g_free (keylist->wm_name);
+    g_free (keylist->schema);
+    g_free (keylist);
+}
+
+static GVariant *
+keylist_to_variant (KeyList *keylist)
+{
+    GVariantBuilder entries;
+
+    g_variant_builder_init (&entries, G_VARIANT_TYPE ("a(ssmsmsbb)"));
+    for (guint i = 0; i < keylist->entries->len; i++) {
+        KeyListEntry *entry = &g_array_index (keylist->entries, KeyListEntry, i);
+
+        g_variant_builder_add (&entries, "(ssmsmsbb)", entry->name, entry->schema, entry->description,
+                               entry->reverse_entry, entry->is_reversed, entry->hidden);
+    }
+
+    return g_variant_new (KEYLIST_VARIANT_TYPE, keylist->name, keylist->group, keylist->package, keylist->wm_name,
+                          &entries);
+}
+
+static void
+cached_keylist_free (CachedKeyList *cached)
+{
+    g_variant_unref (cached->keylist);
+    g_free (cached);
+}
+
+/*
+ * Like parse_keylist_from_file(), but returns the KeyList serialized as
+ * a KEYLIST_VARIANT_TYPE. Files are only parsed again when they change.
+ */
+GVariant *
+load_keylist_from_file (const gchar *path)
+{
+    CachedKeyList *cached;
+    KeyList *keylist;
+    GStatBuf buf;
+
+    if (g_stat (path, &buf) != 0)
+        return NULL;
+
+    if (!keylist_cache)
+        keylist_cache =
+            g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) cached_keylist_free);
+
+    cached = g_hash_table_lookup (keylist_cache, path);
+    if (cached && cached->mtime == buf.st_mtime && cached->size == buf.st_size)
+        return g_variant_ref (cached->keylist);
+
+    keylist = parse_keylist_from_file (path);
+    if (!keylist) {
+        g_hash_table_remove (keylist_cache, path);
+        return NULL;
+    }
+
+    cached = g_new0 (CachedKeyList, 1);
+    cached->mtime = buf.st_mtime;
+    cached->size = buf.st_size;
+    cached->keylist = g_variant_ref_sink (keylist_to_variant (keylist));
+    g_hash_table_insert (keylist_cache, g_strdup (path), cached);
+
+    keylist_free (keylist);
+
+    return g_variant_ref (cached->keylist);
+}
+
 /*
  * Stolen from GtkCellRendererAccel:
  * https://git.gnome.org/browse/gtk+/tree/gtk/gtkcellrendereraccel.c#n261
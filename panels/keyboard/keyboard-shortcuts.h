@@ -49,14 +49,6 @@ typedef struct {
     gboolean hidden;
 } KeyListEntry;
 
-typedef struct {
-    CcKeyboardItem *orig_item;
-    CcKeyboardItem *conflict_item;
-    guint new_keyval;
-    GdkModifierType new_mask;
-    guint new_keycode;
-} CcUniquenessData;
-
 enum {
     SECTION_DESCRIPTION_COLUMN,
     SECTION_ID_COLUMN,
@@ -74,6 +66,11 @@ gboolean is_valid_accel (const CcKeyCombo *combo);
 
 KeyList *parse_keylist_from_file (const gchar *path);
 
+/* A KeyList as (name, group, package, wm_name, [(name, schema, description, reverse_entry, is_reversed, hidden)]) */
+#define KEYLIST_VARIANT_TYPE "(msmsmsmsa(ssmsmsbb))"
+
+GVariant *load_keylist_from_file (const gchar *path);
+
 gchar *convert_keysym_state_to_string (const CcKeyCombo *combo);
 
 void normalize_keyval_and_mask (guint keyval, GdkModifierType mask, guint group, guint *out_keyval,
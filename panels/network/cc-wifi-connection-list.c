@@ -54,6 +54,17 @@ struct _CcWifiConnectionList {
      */
     GHashTable *ap_ssid_cache;
     GHashTable *ssid_to_row;
+
+    /* Only valid while update_connections() reconciles the rows. SSID rows
+     * which have not been claimed again by an AP yet, and for every row the
+     * set of APs which have been (re-)assigned to it during the update.
+     */
+    GHashTable *stale_ssid_rows;
+    GHashTable *claimed_aps;
+
+    /* Rows with AP property changes, flushed once per frame */
+    GHashTable *pending_rows;
+    guint pending_rows_tick_id;
 };
 
 static void on_device_ap_added_cb (CcWifiConnectionList *self, NMAccessPoint *ap, NMDeviceWifi *device);
@@ -177,14 +188,73 @@ clear_widget (CcWifiConnectionList *self)
     g_hash_table_remove_all (self->ap_ssid_cache);
 }
 
+static void
+remove_row (CcWifiConnectionList *self, CcWifiConnectionRow *row)
+{
+    g_signal_emit_by_name (self, "remove-row", row);
+    gtk_list_box_remove (self->listbox, GTK_WIDGET (row));
+}
+
+static void
+row_attach_access_point (CcWifiConnectionList *self, CcWifiConnectionRow *row, NMAccessPoint *ap)
+{
+    if (self->claimed_aps) {
+        GHashTable *claimed = g_hash_table_lookup (self->claimed_aps, row);
+
+        if (!claimed) {
+            claimed = g_hash_table_new (g_direct_hash, g_direct_equal);
+            g_hash_table_insert (self->claimed_aps, row, claimed);
+        }
+        g_hash_table_add (claimed, ap);
+
+        /* Rows keep their APs during an update, so don't add it twice */
+        if (cc_wifi_connection_row_has_access_point (row, ap))
+            return;
+    }
+
+    cc_wifi_connection_row_add_access_point (row, ap);
+}
+
+/* Drops the APs of a reused row which were not assigned to it again.
+ * Returns TRUE if the row is left without any AP. */
+static gboolean
+row_prune_access_points (CcWifiConnectionList *self, CcWifiConnectionRow *row)
+{
+    const GPtrArray *aps;
+    GHashTable *claimed;
+    gboolean empty;
+    gint i;
+
+    aps = cc_wifi_connection_row_get_access_points (row);
+    empty = aps->len == 0;
+    claimed = g_hash_table_lookup (self->claimed_aps, row);
+
+    for (i = aps->len - 1; i >= 0; i--) {
+        NMAccessPoint *ap = g_ptr_array_index (aps, i);
+
+        if (claimed && g_hash_table_contains (claimed, ap))
+            continue;
+
+        empty = cc_wifi_connection_row_remove_access_point (row, ap);
+    }
+
+    return empty;
+}
+
 static void
 update_connections (CcWifiConnectionList *self)
 {
     const GPtrArray *aps;
     const GPtrArray *acs_client;
     g_autoptr(GPtrArray) acs = NULL;
+    g_autoptr(GPtrArray) old_connections = NULL;
+    g_autoptr(GHashTable) old_rows = NULL;
+    g_autoptr(GHashTable) reused_rows = NULL;
+    GHashTableIter iter;
+    CcWifiConnectionRow *row;
     NMActiveConnection *ac;
     NMConnection *ac_con = NULL;
+    NMConnection *con;
     gint i;
 
     /* We don't want full UI rebuilds during some UI interactions, so allow freezing the list. */
@@ -196,7 +266,32 @@ update_connections (CcWifiConnectionList *self)
         return;
     self->updating = TRUE;
 
-    clear_widget (self);
+    /* Rather than tearing down all rows, remember the existing ones keyed by
+     * their connection or SSID and hand them out again below. Only rows which
+     * are not claimed again are removed in the end. */
+    old_rows = g_hash_table_new (g_direct_hash, g_direct_equal);
+    reused_rows = g_hash_table_new (g_direct_hash, g_direct_equal);
+    for (i = 0; i < self->connections_row->len; i++) {
+        row = g_ptr_array_index (self->connections_row, i);
+        if (row) {
+            g_hash_table_insert (old_rows, g_ptr_array_index (self->connections, i), row);
+            g_hash_table_add (reused_rows, row);
+        }
+    }
+
+    g_hash_table_iter_init (&iter, self->ssid_to_row);
+    while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &row))
+        g_hash_table_add (reused_rows, row);
+
+    self->stale_ssid_rows = g_steal_pointer (&self->ssid_to_row);
+    self->ssid_to_row = g_hash_table_new_full (g_bytes_hash, g_bytes_equal, (GDestroyNotify) g_bytes_unref, NULL);
+    self->claimed_aps =
+        g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) g_hash_table_unref);
+
+    aps = nm_device_wifi_get_access_points (self->device);
+    for (i = 0; i < aps->len; i++)
+        g_signal_handlers_disconnect_by_data (g_ptr_array_index (aps, i), self);
+    g_hash_table_remove_all (self->ap_ssid_cache);
 
     /* Copy the new connections; also create a row if we show unavailable
      * connections */
@@ -215,25 +310,77 @@ update_connections (CcWifiConnectionList *self)
         g_ptr_array_add (acs, g_object_ref (ac_con));
     }
 
-    for (i = 0; i < acs->len; i++) {
-        NMConnection *con;
+    /* Keep the old connections alive until their rows have been matched */
+    old_connections = g_steal_pointer (&self->connections);
+    self->connections = g_ptr_array_new_with_free_func (g_object_unref);
+    g_ptr_array_set_size (self->connections_row, 0);
 
+    for (i = 0; i < acs->len; i++) {
         con = g_ptr_array_index (acs, i);
         if (connection_ignored (con))
             continue;
 
+        row = NULL;
+        g_hash_table_steal_extended (old_rows, con, NULL, (gpointer *) &row);
+
+        /* Rows of unavailable connections may be dropped again after the APs have been assigned */
+        if (!row && (!self->hide_unavailable || con == ac_con))
+            row = cc_wifi_connection_list_row_add (self, con, NULL, TRUE);
+
         g_ptr_array_add (self->connections, g_object_ref (con));
-        if (self->hide_unavailable && con != ac_con)
-            g_ptr_array_add (self->connections_row, NULL);
-        else
-            g_ptr_array_add (self->connections_row, cc_wifi_connection_list_row_add (self, con, NULL, TRUE));
+        g_ptr_array_add (self->connections_row, row);
     }
 
     /* Coldplug all known APs again */
-    aps = nm_device_wifi_get_access_points (self->device);
     for (i = 0; i < aps->len; i++)
         on_device_ap_added_cb (self, g_ptr_array_index (aps, i), self->device);
 
+    /* Reconcile the reused rows with their new set of APs */
+    for (i = 0; i < self->connections_row->len; i++) {
+        row = g_ptr_array_index (self->connections_row, i);
+        if (!row)
+            continue;
+
+        con = g_ptr_array_index (self->connections, i);
+        if (row_prune_access_points (self, row) && self->hide_unavailable && con != ac_con) {
+            g_ptr_array_index (self->connections_row, i) = NULL;
+            remove_row (self, row);
+        }
+    }
+
+    g_hash_table_iter_init (&iter, self->ssid_to_row);
+    while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &row))
+        row_prune_access_points (self, row);
+
+    /* The active connection or its state may have changed since the reused
+     * rows were last updated */
+    for (i = 0; i < self->connections_row->len; i++) {
+        row = g_ptr_array_index (self->connections_row, i);
+        if (row && g_hash_table_contains (reused_rows, row))
+            cc_wifi_connection_row_update (row);
+    }
+
+    g_hash_table_iter_init (&iter, self->ssid_to_row);
+    while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &row)) {
+        if (g_hash_table_contains (reused_rows, row))
+            cc_wifi_connection_row_update (row);
+    }
+
+    /* Anything left over does not exist anymore */
+    g_hash_table_iter_init (&iter, old_rows);
+    while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &row))
+        remove_row (self, row);
+
+    g_hash_table_iter_init (&iter, self->stale_ssid_rows);
+    while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &row))
+        remove_row (self, row);
+
+    g_clear_pointer (&self->stale_ssid_rows, g_hash_table_unref);
+    g_clear_pointer (&self->claimed_aps, g_hash_table_unref);
+
+    /* Reused rows may have moved */
+    gtk_list_box_invalidate_sort (self->listbox);
+
     self->updating = FALSE;
 }
 
@@ -255,6 +402,45 @@ on_row_show_qr_code_cb (CcWifiConnectionList *self, CcWifiConnectionRow *row)
     g_signal_emit_by_name (self, "show_qr_code", row);
 }
 
+static gboolean
+flush_pending_rows_cb (GtkWidget *widget, GdkFrameClock *frame_clock, gpointer user_data)
+{
+    CcWifiConnectionList *self = CC_WIFI_CONNECTION_LIST (widget);
+    g_autoptr(GHashTable) rows = NULL;
+    GHashTableIter iter;
+    CcWifiConnectionRow *row;
+
+    self->pending_rows_tick_id = 0;
+
+    rows = g_steal_pointer (&self->pending_rows);
+    self->pending_rows = g_hash_table_new_full (g_direct_hash, g_direct_equal, g_object_unref, NULL);
+
+    g_hash_table_iter_init (&iter, rows);
+    while (g_hash_table_iter_next (&iter, (gpointer *) &row, NULL)) {
+        /* The row may have been removed in the meantime */
+        if (gtk_widget_get_parent (GTK_WIDGET (row)) != GTK_WIDGET (self->listbox))
+            continue;
+
+        cc_wifi_connection_row_update_strength (row);
+    }
+
+    return G_SOURCE_REMOVE;
+}
+
+/* During a scan NM emits a stream of strength and flag changes for every AP.
+ * Collect the affected rows and update them once per frame instead. */
+static void
+queue_row_update (CcWifiConnectionList *self, CcWifiConnectionRow *row)
+{
+    if (!g_hash_table_contains (self->pending_rows, row))
+        g_hash_table_add (self->pending_rows, g_object_ref (row));
+
+    if (self->pending_rows_tick_id == 0) {
+        self->pending_rows_tick_id =
+            gtk_widget_add_tick_callback (GTK_WIDGET (self), flush_pending_rows_cb, NULL, NULL);
+    }
+}
+
 static void
 on_access_point_property_changed (CcWifiConnectionList *self, GParamSpec *pspec, NMAccessPoint *ap)
 {
@@ -278,7 +464,7 @@ on_access_point_property_changed (CcWifiConnectionList *self, GParamSpec *pspec,
     for (i = 0; i < self->connections_row->len; i++) {
         row = g_ptr_array_index (self->connections_row, i);
         if (row && cc_wifi_connection_row_has_access_point (row, ap)) {
-            cc_wifi_connection_row_update (row);
+            queue_row_update (self, row);
             has_connection = TRUE;
         }
     }
@@ -294,7 +480,7 @@ on_access_point_property_changed (CcWifiConnectionList *self, GParamSpec *pspec,
     if (!row)
         g_assert_not_reached ();
     else
-        cc_wifi_connection_row_update (row);
+        queue_row_update (self, row);
 }
 
 static void
@@ -344,7 +530,7 @@ on_device_ap_added_cb (CcWifiConnectionList *self, NMAccessPoint *ap, NMDeviceWi
         row = g_ptr_array_index (self->connections_row, j);
         if (!row)
             row = cc_wifi_connection_list_row_add (self, g_ptr_array_index (connections, i), NULL, TRUE);
-        cc_wifi_connection_row_add_access_point (row, ap);
+        row_attach_access_point (self, row, ap);
         g_ptr_array_index (self->connections_row, j) = row;
     }
 
@@ -372,12 +558,21 @@ on_device_ap_added_cb (CcWifiConnectionList *self, NMAccessPoint *ap, NMDeviceWi
     g_hash_table_insert (self->ap_ssid_cache, ap, g_bytes_ref (ssid));
 
     row = g_hash_table_lookup (self->ssid_to_row, ssid);
+    if (!row && self->stale_ssid_rows) {
+        /* Reuse the row the SSID had before the update */
+        row = g_hash_table_lookup (self->stale_ssid_rows, ssid);
+        if (row) {
+            g_hash_table_remove (self->stale_ssid_rows, ssid);
+            g_hash_table_insert (self->ssid_to_row, g_bytes_ref (ssid), row);
+        }
+    }
+
     if (!row) {
         row = cc_wifi_connection_list_row_add (self, NULL, ap, FALSE);
 
         g_hash_table_insert (self->ssid_to_row, g_bytes_ref (ssid), row);
     } else {
-        cc_wifi_connection_row_add_access_point (row, ap);
+        row_attach_access_point (self, row, ap);
     }
 }
 
@@ -435,8 +630,8 @@ on_client_connection_added_cb (CcWifiConnectionList *self, NMConnection *connect
     if (connection_ignored (connection))
         return;
 
-    /* The approach we take to handle connection changes is to do a full rebuild.
-     * It happens seldom enough to make this feasible.
+    /* The approach we take to handle connection changes is to do a full
+     * update; existing rows are reused, so this is cheap enough.
      */
     update_connections (self);
 }
@@ -447,8 +642,8 @@ on_client_connection_removed_cb (CcWifiConnectionList *self, NMConnection *conne
     if (!g_ptr_array_find (self->connections, connection, NULL))
         return;
 
-    /* The approach we take to handle connection changes is to do a full rebuild.
-     * It happens seldom enough to make this feasible.
+    /* The approach we take to handle connection changes is to do a full
+     * update; existing rows are reused, so this is cheap enough.
      */
     update_connections (self);
 }
@@ -505,6 +700,12 @@ cc_wifi_connection_list_dispose (GObject *object)
     /* Drop all external references */
     clear_widget (self);
 
+    if (self->pending_rows_tick_id != 0) {
+        gtk_widget_remove_tick_callback (GTK_WIDGET (self), self->pending_rows_tick_id);
+        self->pending_rows_tick_id = 0;
+    }
+    g_clear_pointer (&self->pending_rows, g_hash_table_unref);
+
     G_OBJECT_CLASS (cc_wifi_connection_list_parent_class)->dispose (object);
 }
 
@@ -553,8 +754,8 @@ cc_wifi_connection_list_constructed (GObject *object)
     on_device_state_changed_cb (self, NULL, self->device);
 
     /* Simulate a change notification on the available connections.
-     * This uses the implementation detail that the list is rebuild
-     * completely in this case. */
+     * This uses the implementation detail that all rows are reconciled
+     * in this case. */
     update_connections (self);
 }
 
@@ -702,6 +903,7 @@ cc_wifi_connection_list_init (CcWifiConnectionList *self)
     self->connections_row = g_ptr_array_new ();
     self->ssid_to_row = g_hash_table_new_full (g_bytes_hash, g_bytes_equal, (GDestroyNotify) g_bytes_unref, NULL);
     self->ap_ssid_cache = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) g_bytes_unref);
+    self->pending_rows = g_hash_table_new_full (g_direct_hash, g_direct_equal, g_object_unref, NULL);
 }
 
 CcWifiConnectionList *
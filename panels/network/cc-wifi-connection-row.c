@@ -41,6 +41,9 @@ struct _CcWifiConnectionRow {
     GtkButton *forget_button;
     GtkButton *qr_code_button;
     GtkImage *strength_icon;
+
+    /* Coarse signal strength used for sorting, see update_strength_bucket() */
+    gint strength_bucket;
 };
 
 enum {
@@ -65,6 +68,11 @@ typedef enum {
     NM_AP_SEC_OWE_TM
 } NMAccessPointSecurity;
 
+/* Signal strength is sorted in buckets of this size, and a row only moves
+ * to another bucket once the strength is this far past the bucket edge. */
+#define STRENGTH_BUCKET_SIZE 10
+#define STRENGTH_HYSTERESIS 3
+
 G_DEFINE_FINAL_TYPE (CcWifiConnectionRow, cc_wifi_connection_row, ADW_TYPE_ACTION_ROW)
 
 static GParamSpec *props[PROP_LAST];
@@ -142,6 +150,19 @@ get_connection_security (NMConnection *con)
         return NM_AP_SEC_UNKNOWN;
 }
 
+static void
+update_strength_bucket (CcWifiConnectionRow *self, gint strength)
+{
+    gint lower = self->strength_bucket * STRENGTH_BUCKET_SIZE;
+    gint upper = lower + STRENGTH_BUCKET_SIZE;
+
+    if (self->strength_bucket >= 0 && strength > lower - STRENGTH_HYSTERESIS
+        && strength < upper + STRENGTH_HYSTERESIS)
+        return;
+
+    self->strength_bucket = strength / STRENGTH_BUCKET_SIZE;
+}
+
 static void
 update_ui (CcWifiConnectionRow *self)
 {
@@ -219,6 +240,8 @@ update_ui (CcWifiConnectionRow *self)
         strength = nm_access_point_get_strength (best_ap);
     }
 
+    update_strength_bucket (self, strength);
+
     gtk_widget_set_visible (GTK_WIDGET (self->connecting_spinner), connecting);
     adw_action_row_set_subtitle (ADW_ACTION_ROW (self), active ? _("Connected") : "");
     gtk_widget_set_visible (GTK_WIDGET (self->options_button), active || connecting || self->known_connection);
@@ -471,6 +494,7 @@ cc_wifi_connection_row_init (CcWifiConnectionRow *self)
     gtk_widget_init_template (GTK_WIDGET (self));
 
     self->aps = g_ptr_array_new_with_free_func (g_object_unref);
+    self->strength_bucket = -1;
 
     g_object_bind_property (self, "checked", self->checkbutton, "active",
                             G_BINDING_BIDIRECTIONAL | G_BINDING_SYNC_CREATE);
@@ -623,3 +647,28 @@ cc_wifi_connection_row_update (CcWifiConnectionRow *self)
 
     gtk_list_box_row_changed (GTK_LIST_BOX_ROW (self));
 }
+
+/* Like cc_wifi_connection_row_update(), but only re-sorts the row if the
+ * signal strength moved to another bucket. Meant for the frequent access
+ * point property changes during a scan. */
+void
+cc_wifi_connection_row_update_strength (CcWifiConnectionRow *self)
+{
+    gint old_bucket;
+
+    g_return_if_fail (CC_IS_WIFI_CONNECTION_ROW (self));
+
+    old_bucket = self->strength_bucket;
+    update_ui (self);
+
+    if (self->strength_bucket != old_bucket)
+        gtk_list_box_row_changed (GTK_LIST_BOX_ROW (self));
+}
+
+guint
+cc_wifi_connection_row_get_strength_bucket (CcWifiConnectionRow *self)
+{
+    g_return_val_if_fail (CC_IS_WIFI_CONNECTION_ROW (self), 0);
+
+    return MAX (self->strength_bucket, 0);
+}
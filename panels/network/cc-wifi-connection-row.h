@@ -45,4 +45,6 @@ gboolean cc_wifi_connection_row_remove_access_point (CcWifiConnectionRow *row, N
 gboolean cc_wifi_connection_row_has_access_point (CcWifiConnectionRow *row, NMAccessPoint *ap);
 
 void cc_wifi_connection_row_update (CcWifiConnectionRow *row);
+void cc_wifi_connection_row_update_strength (CcWifiConnectionRow *row);
+guint cc_wifi_connection_row_get_strength_bucket (CcWifiConnectionRow *row);
 G_END_DECLS
@@ -848,7 +848,6 @@ ap_sort (gconstpointer a, gconstpointer b, gpointer data)
     CcWifiConnectionRow *b_row = CC_WIFI_CONNECTION_ROW ((gpointer) b);
     NMActiveConnection *active_connection;
     gboolean a_configured, b_configured;
-    NMAccessPoint *apa, *apb;
     guint sa, sb;
 
     /* Show the connected AP first */
@@ -871,20 +870,10 @@ ap_sort (gconstpointer a, gconstpointer b, gpointer data)
             return 1;
     }
 
-    /* Show higher strength networks above lower strength ones */
-
-    apa = cc_wifi_connection_row_best_access_point (a_row);
-    apb = cc_wifi_connection_row_best_access_point (b_row);
-
-    if (apa)
-        sa = nm_access_point_get_strength (apa);
-    else
-        sa = 0;
-
-    if (apb)
-        sb = nm_access_point_get_strength (apb);
-    else
-        sb = 0;
+    /* Show higher strength networks above lower strength ones. Compare the
+     * coarse strength so rows don't jump around on every small fluctuation. */
+    sa = cc_wifi_connection_row_get_strength_bucket (a_row);
+    sb = cc_wifi_connection_row_get_strength_bucket (b_row);
 
     if (sa > sb)
         return -1;
@@ -47,7 +47,14 @@ struct _CcNotificationsPanel {
 
     GCancellable *cancellable;
 
+    /* Canonical app ID → GtkListBoxRow */
     GHashTable *known_applications;
+    /* Canonical app IDs from the settings without an installed app */
+    GHashTable *ignored_app_ids;
+
+    GAppInfoMonitor *app_info_monitor;
+    GtkAdjustment *vadjustment;
+    guint bind_rows_id;
 
     GDBusProxy *perm_store;
 };
@@ -59,14 +66,18 @@ struct _CcNotificationsPanelClass {
 typedef struct {
     char *canonical_app_id;
     GAppInfo *app_info;
+    /* Only created once the row is shown or opened */
     GSettings *settings;
+    gboolean bound;
 
-    /* Temporary pointer, to pass from the loading thread
-       to the app */
-    CcNotificationsPanel *self;
+    /* Whether the desktop file declares X-GNOME-UsesNotifications */
+    gboolean declared;
+    /* Whether the app is listed in application-children */
+    gboolean has_settings;
 } Application;
 
 static void build_app_store (CcNotificationsPanel *self);
+static void bind_visible_rows_on_map (CcNotificationsPanel *self);
 static void select_app (CcNotificationsPanel *self, GtkListBoxRow *row);
 static int sort_apps (gconstpointer one, gconstpointer two, gpointer user_data);
 
@@ -77,8 +88,12 @@ cc_notifications_panel_dispose (GObject *object)
 {
     CcNotificationsPanel *self = CC_NOTIFICATIONS_PANEL (object);
 
+    g_clear_handle_id (&self->bind_rows_id, g_source_remove);
+    g_clear_object (&self->app_info_monitor);
+    g_clear_object (&self->vadjustment);
     g_clear_object (&self->master_settings);
     g_clear_pointer (&self->known_applications, g_hash_table_unref);
+    g_clear_pointer (&self->ignored_app_ids, g_hash_table_unref);
 
     G_OBJECT_CLASS (cc_notifications_panel_parent_class)->dispose (object);
 }
@@ -117,7 +132,8 @@ cc_notifications_panel_init (CcNotificationsPanel *self)
 
     gtk_widget_init_template (GTK_WIDGET (self));
 
-    self->known_applications = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_free);
+    self->known_applications = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    self->ignored_app_ids = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 
     self->master_settings = g_settings_new (MASTER_SCHEMA);
 
@@ -126,6 +142,8 @@ cc_notifications_panel_init (CcNotificationsPanel *self)
                      G_SETTINGS_BIND_DEFAULT);
 
     gtk_list_box_set_sort_func (self->app_listbox, (GtkListBoxSortFunc) sort_apps, NULL, NULL);
+    g_signal_connect_object (self->app_listbox, "map", G_CALLBACK (bind_visible_rows_on_map), self,
+                             G_CONNECT_SWAPPED);
 
     build_app_store (self);
 
@@ -191,14 +209,106 @@ application_free (Application *app)
 {
     g_free (app->canonical_app_id);
     g_object_unref (app->app_info);
-    g_object_unref (app->settings);
-    g_object_unref (app->self);
+    g_clear_object (&app->settings);
 
-    g_slice_free (Application, app);
+    g_free (app);
 }
 
 G_DEFINE_AUTOPTR_CLEANUP_FUNC (Application, application_free)
 
+static GSettings *
+application_get_settings (Application *app)
+{
+    if (app->settings == NULL) {
+        g_autofree gchar *path = g_strconcat (APP_PREFIX, app->canonical_app_id, "/", NULL);
+
+        app->settings = g_settings_new_with_path (APP_SCHEMA, path);
+    }
+
+    return app->settings;
+}
+
+static void
+bind_row (GtkListBoxRow *row)
+{
+    Application *app = g_object_get_qdata (G_OBJECT (row), application_quark ());
+
+    if (app->bound)
+        return;
+
+    g_settings_bind_with_mapping (application_get_settings (app), "enable", row, "secondary-label",
+                                  G_SETTINGS_BIND_GET | G_SETTINGS_BIND_NO_SENSITIVITY, on_off_label_mapping_get, NULL,
+                                  NULL, NULL);
+    app->bound = TRUE;
+}
+
+/*
+ * Only rows around the visible part of the list get their settings,
+ * the others are bound as they are scrolled into view.
+ */
+static gboolean
+bind_visible_rows (gpointer user_data)
+{
+    CcNotificationsPanel *self = CC_NOTIFICATIONS_PANEL (user_data);
+    GtkWidget *listbox = GTK_WIDGET (self->app_listbox);
+    GtkWidget *viewport;
+    GtkListBoxRow *first, *last;
+    graphene_point_t top, bottom;
+    gint viewport_height, listbox_height;
+    gint i;
+
+    self->bind_rows_id = 0;
+
+    viewport = gtk_widget_get_ancestor (listbox, GTK_TYPE_SCROLLED_WINDOW);
+    if (viewport == NULL || !gtk_widget_get_mapped (listbox))
+        return G_SOURCE_REMOVE;
+
+    /* Look one screen ahead in both directions, so that scrolling doesn't show unset labels */
+    viewport_height = gtk_widget_get_height (viewport);
+    listbox_height = gtk_widget_get_height (listbox);
+    if (!gtk_widget_compute_point (viewport, listbox, &GRAPHENE_POINT_INIT (0, -viewport_height), &top)
+        || !gtk_widget_compute_point (viewport, listbox, &GRAPHENE_POINT_INIT (0, 2 * viewport_height), &bottom))
+        return G_SOURCE_REMOVE;
+
+    if (bottom.y < 0 || top.y >= listbox_height)
+        return G_SOURCE_REMOVE;
+
+    first = gtk_list_box_get_row_at_y (self->app_listbox, MAX (top.y, 0));
+    last = gtk_list_box_get_row_at_y (self->app_listbox, MIN (bottom.y, listbox_height - 1));
+    if (first == NULL || last == NULL)
+        return G_SOURCE_REMOVE;
+
+    for (i = gtk_list_box_row_get_index (first); i <= gtk_list_box_row_get_index (last); i++)
+        bind_row (gtk_list_box_get_row_at_index (self->app_listbox, i));
+
+    return G_SOURCE_REMOVE;
+}
+
+static void
+queue_bind_visible_rows (CcNotificationsPanel *self)
+{
+    /* Wait for the list to be allocated */
+    if (self->bind_rows_id == 0)
+        self->bind_rows_id = g_idle_add (bind_visible_rows, self);
+}
+
+static void
+bind_visible_rows_on_map (CcNotificationsPanel *self)
+{
+    GtkWidget *scrolled_window;
+
+    scrolled_window = gtk_widget_get_ancestor (GTK_WIDGET (self->app_listbox), GTK_TYPE_SCROLLED_WINDOW);
+    if (self->vadjustment == NULL && scrolled_window != NULL) {
+        self->vadjustment = g_object_ref (gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (scrolled_window)));
+        g_signal_connect_object (self->vadjustment, "value-changed", G_CALLBACK (queue_bind_visible_rows), self,
+                                 G_CONNECT_SWAPPED);
+        g_signal_connect_object (self->vadjustment, "changed", G_CALLBACK (queue_bind_visible_rows), self,
+                                 G_CONNECT_SWAPPED);
+    }
+
+    queue_bind_visible_rows (self);
+}
+
 static void
 add_application (CcNotificationsPanel *self, Application *app)
 {
@@ -209,8 +319,10 @@ add_application (CcNotificationsPanel *self, Application *app)
     g_autofree gchar *escaped_app_name = NULL;
 
     app_name = g_app_info_get_name (app->app_info);
-    if (app_name == NULL || *app_name == '\0')
+    if (app_name == NULL || *app_name == '\0') {
+        application_free (app);
         return;
+    }
     escaped_app_name = g_markup_escape_text (app_name, -1);
 
     icon = g_app_info_get_icon (app->app_info);
@@ -231,11 +343,37 @@ add_application (CcNotificationsPanel *self, Application *app)
     gtk_image_set_icon_size (GTK_IMAGE (w), GTK_ICON_SIZE_LARGE);
     adw_action_row_add_prefix (ADW_ACTION_ROW (row), w);
 
-    g_settings_bind_with_mapping (app->settings, "enable", row, "secondary-label",
-                                  G_SETTINGS_BIND_GET | G_SETTINGS_BIND_NO_SENSITIVITY, on_off_label_mapping_get, NULL,
-                                  NULL, NULL);
+    g_hash_table_insert (self->known_applications, g_strdup (app->canonical_app_id), row);
 
-    g_hash_table_add (self->known_applications, g_strdup (app->canonical_app_id));
+    queue_bind_visible_rows (self);
+}
+
+static Application *
+lookup_application (CcNotificationsPanel *self, const char *canonical_app_id)
+{
+    GtkListBoxRow *row = g_hash_table_lookup (self->known_applications, canonical_app_id);
+
+    return row != NULL ? g_object_get_qdata (G_OBJECT (row), application_quark ()) : NULL;
+}
+
+/* Removes the apps that are neither declared by their desktop file nor in the settings anymore */
+static void
+remove_stale_applications (CcNotificationsPanel *self)
+{
+    GHashTableIter iter;
+    gpointer row;
+
+    g_hash_table_iter_init (&iter, self->known_applications);
+    while (g_hash_table_iter_next (&iter, NULL, &row)) {
+        Application *app = g_object_get_qdata (G_OBJECT (row), application_quark ());
+
+        if (app->declared || app->has_settings)
+            continue;
+
+        g_debug ("Removing application %s", app->canonical_app_id);
+        g_hash_table_iter_remove (&iter);
+        gtk_list_box_remove (self->app_listbox, GTK_WIDGET (row));
+    }
 }
 
 static gboolean
@@ -270,8 +408,16 @@ maybe_add_app_id (CcNotificationsPanel *self, const char *canonical_app_id)
     if (*canonical_app_id == '\0')
         return;
 
-    if (g_hash_table_contains (self->known_applications, canonical_app_id))
+    app = lookup_application (self, canonical_app_id);
+    if (app != NULL) {
+        app->has_settings = TRUE;
+        return;
+    }
+
+    /* Already looked at, and not shown */
+    if (g_hash_table_contains (self->ignored_app_ids, canonical_app_id))
         return;
+    g_hash_table_add (self->ignored_app_ids, g_strdup (canonical_app_id));
 
     path = g_strconcat (APP_PREFIX, canonical_app_id, "/", NULL);
     settings = g_settings_new_with_path (APP_SCHEMA, path);
@@ -296,10 +442,13 @@ maybe_add_app_id (CcNotificationsPanel *self, const char *canonical_app_id)
         return;
     }
 
-    app = g_slice_new (Application);
+    g_hash_table_remove (self->ignored_app_ids, canonical_app_id);
+
+    app = g_new0 (Application, 1);
     app->canonical_app_id = g_strdup (canonical_app_id);
     app->settings = g_object_ref (settings);
     app->app_info = g_object_ref (app_info);
+    app->has_settings = TRUE;
 
     g_debug ("Adding application '%s' (canonical app ID: %s)", full_app_id, canonical_app_id);
 
@@ -330,16 +479,16 @@ app_info_get_id (GAppInfo *app_info)
     return g_steal_pointer (&ret);
 }
 
-static void
-process_app_info (CcNotificationsPanel *self, GAppInfo *app_info)
+static char *
+app_info_get_canonical_id (GAppInfo *app_info)
 {
-    Application *app;
     g_autofree gchar *app_id = NULL;
-    g_autofree gchar *path = NULL;
-    g_autoptr(GSettings) settings = NULL;
     guint i;
 
     app_id = app_info_get_id (app_info);
+    if (app_id == NULL)
+        return NULL;
+
     g_strcanon (app_id,
                 "0123456789"
                 "abcdefghijklmnopqrstuvwxyz"
@@ -349,19 +498,33 @@ process_app_info (CcNotificationsPanel *self, GAppInfo *app_info)
     for (i = 0; app_id[i] != '\0'; i++)
         app_id[i] = g_ascii_tolower (app_id[i]);
 
-    path = g_strconcat (APP_PREFIX, app_id, "/", NULL);
-    settings = g_settings_new_with_path (APP_SCHEMA, path);
+    return g_steal_pointer (&app_id);
+}
 
-    app = g_slice_new (Application);
-    app->canonical_app_id = g_steal_pointer (&app_id);
-    app->settings = g_object_ref (settings);
-    app->app_info = g_object_ref (app_info);
-    app->self = g_object_ref (self);
+static void
+process_app_info (CcNotificationsPanel *self, GAppInfo *app_info, GHashTable *declared_app_ids)
+{
+    Application *app;
+    g_autofree gchar *app_id = NULL;
+
+    app_id = app_info_get_canonical_id (app_info);
+    if (app_id == NULL)
+        return;
+
+    g_hash_table_add (declared_app_ids, g_strdup (app_id));
 
-    if (g_hash_table_contains (self->known_applications, app->canonical_app_id))
+    app = lookup_application (self, app_id);
+    if (app != NULL) {
+        app->declared = TRUE;
         return;
+    }
 
-    g_debug ("Processing queued application %s", app->canonical_app_id);
+    g_debug ("Processing queued application %s", app_id);
+
+    app = g_new0 (Application, 1);
+    app->canonical_app_id = g_steal_pointer (&app_id);
+    app->app_info = g_object_ref (app_info);
+    app->declared = TRUE;
 
     add_application (self, app);
 }
@@ -369,14 +532,18 @@ process_app_info (CcNotificationsPanel *self, GAppInfo *app_info)
 static void
 load_apps (CcNotificationsPanel *self)
 {
-    GList *iter, *apps;
+    g_autoptr(GHashTable) declared_app_ids = NULL;
+    GHashTableIter iter;
+    gpointer row;
+    GList *iter_apps, *apps;
 
+    declared_app_ids = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
     apps = g_app_info_get_all ();
 
-    for (iter = apps; iter; iter = iter->next) {
+    for (iter_apps = apps; iter_apps; iter_apps = iter_apps->next) {
         GDesktopAppInfo *app;
 
-        app = iter->data;
+        app = iter_apps->data;
         if (g_desktop_app_info_get_boolean (app, "X-GNOME-UsesNotifications")) {
             if (!g_desktop_app_info_get_show_in (app, NULL)) {
                 g_debug ("Skipped app '%s', not shown in current desktop (NotShowIn/OnlyShowIn)",
@@ -389,7 +556,7 @@ load_apps (CcNotificationsPanel *self)
                 continue;
             }
 
-            process_app_info (self, G_APP_INFO (app));
+            process_app_info (self, G_APP_INFO (app), declared_app_ids);
             g_debug ("Processing app '%s'", g_app_info_get_id (G_APP_INFO (app)));
         } else {
             g_debug ("Skipped app '%s', doesn't use notifications", g_app_info_get_id (G_APP_INFO (app)));
@@ -397,29 +564,77 @@ load_apps (CcNotificationsPanel *self)
     }
 
     g_list_free_full (apps, g_object_unref);
+
+    /* Apps that aren't installed anymore, or that don't declare notifications anymore */
+    g_hash_table_iter_init (&iter, self->known_applications);
+    while (g_hash_table_iter_next (&iter, NULL, &row)) {
+        Application *app = g_object_get_qdata (G_OBJECT (row), application_quark ());
+        g_autoptr(GDesktopAppInfo) app_info = NULL;
+
+        if (!g_hash_table_contains (declared_app_ids, app->canonical_app_id))
+            app->declared = FALSE;
+
+        app_info = g_desktop_app_info_new (g_app_info_get_id (app->app_info));
+        if (app_info == NULL)
+            app->declared = app->has_settings = FALSE;
+    }
+
+    remove_stale_applications (self);
 }
 
 static void
 children_changed (CcNotificationsPanel *self, const char *key)
 {
-    int i;
+    g_autoptr(GHashTable) children = NULL;
     g_auto(GStrv) new_app_ids = NULL;
+    GHashTableIter iter;
+    gpointer row;
+    int i;
 
     g_settings_get (self->master_settings, "application-children", "^as", &new_app_ids);
-    for (i = 0; new_app_ids[i]; i++)
+
+    children = g_hash_table_new (g_str_hash, g_str_equal);
+    for (i = 0; new_app_ids[i]; i++) {
+        g_hash_table_add (children, new_app_ids[i]);
         maybe_add_app_id (self, new_app_ids[i]);
+    }
+
+    g_hash_table_iter_init (&iter, self->known_applications);
+    while (g_hash_table_iter_next (&iter, NULL, &row)) {
+        Application *app = g_object_get_qdata (G_OBJECT (row), application_quark ());
+
+        if (!g_hash_table_contains (children, app->canonical_app_id))
+            app->has_settings = FALSE;
+    }
+
+    remove_stale_applications (self);
+}
+
+static void
+installed_apps_changed (CcNotificationsPanel *self)
+{
+    /* Previously unknown apps might have been installed */
+    g_hash_table_remove_all (self->ignored_app_ids);
+
+    load_apps (self);
+    children_changed (self, NULL);
 }
 
 static void
 build_app_store (CcNotificationsPanel *self)
 {
+    /* Scan applications that statically declare to show notifications */
+    load_apps (self);
+
     /* Build application entries for known applications */
     children_changed (self, NULL);
     g_signal_connect_object (self->master_settings, "changed::application-children", G_CALLBACK (children_changed),
                              self, G_CONNECT_SWAPPED);
 
-    /* Scan applications that statically declare to show notifications */
-    load_apps (self);
+    /* Only the apps that changed are added or removed */
+    self->app_info_monitor = g_app_info_monitor_get ();
+    g_signal_connect_object (self->app_info_monitor, "changed", G_CALLBACK (installed_apps_changed), self,
+                             G_CONNECT_SWAPPED);
 }
 
 static void
@@ -435,7 +650,7 @@ select_app (CcNotificationsPanel *self, GtkListBoxRow *row)
     if (g_str_has_suffix (app_id, ".desktop"))
         app_id[strlen (app_id) - strlen (".desktop")] = '\0';
 
-    page = cc_app_notifications_page_new (app_id, g_app_info_get_name (app->app_info), app->settings,
+    page = cc_app_notifications_page_new (app_id, g_app_info_get_name (app->app_info), application_get_settings (app),
                                           self->master_settings, self->perm_store);
     cc_panel_push_subpage (CC_PANEL (self), ADW_NAVIGATION_PAGE (page));
 }
@@ -206,6 +206,31 @@ kind_to_description (UpDeviceKind kind)
 
 CcBatteryRow *
 cc_battery_row_new (UpDevice *device, gboolean primary)
+{
+    CcBatteryRow *self;
+
+    self = g_object_new (CC_TYPE_BATTERY_ROW, NULL);
+    self->primary = primary;
+
+    /* Handle "primary" row differently */
+    gtk_widget_set_visible (GTK_WIDGET (self->battery_box), !primary);
+    gtk_widget_set_visible (GTK_WIDGET (self->percentage_label), !primary);
+    gtk_widget_set_visible (GTK_WIDGET (self->primary_bottom_box), primary);
+    /*
+    gtk_accessible_update_relation (GTK_ACCESSIBLE (self->levelbar),
+                                    GTK_ACCESSIBLE_RELATION_LABELLED_BY, primary ? self->primary_percentage_label
+                                                                                 : self->percentage_label,
+                                    NULL);
+     */
+
+    cc_battery_row_update (self, device);
+
+    return self;
+}
+
+/* Refreshes the row in place after properties of @device changed */
+void
+cc_battery_row_update (CcBatteryRow *self, UpDevice *device)
 {
     g_autofree gchar *details = NULL;
     gdouble percentage;
@@ -215,13 +240,13 @@ cc_battery_row_new (UpDevice *device, gboolean primary)
     g_autofree gchar *icon_name = NULL;
     g_autofree gchar *model = NULL;
     const gchar *name;
-    CcBatteryRow *self;
     guint64 time_empty, time_full, time;
     gdouble energy_full, energy_rate;
     gboolean is_kind_battery;
     UpDeviceLevel battery_level;
 
-    self = g_object_new (CC_TYPE_BATTERY_ROW, NULL);
+    g_return_if_fail (CC_IS_BATTERY_ROW (self));
+    g_return_if_fail (UP_IS_DEVICE (device));
 
     g_object_get (device, "kind", &kind, "state", &state, "model", &model, "percentage", &percentage, "icon-name",
                   &icon_name, "time-to-empty", &time_empty, "time-to-full", &time_full, "energy-full", &energy_full,
@@ -270,21 +295,7 @@ cc_battery_row_new (UpDevice *device, gboolean primary)
     details = get_details_string (percentage, state, time);
     gtk_label_set_text (self->details_label, details);
 
-    /* Handle "primary" row differently */
-    gtk_widget_set_visible (GTK_WIDGET (self->battery_box), !primary);
-    gtk_widget_set_visible (GTK_WIDGET (self->percentage_label), !primary);
-    gtk_widget_set_visible (GTK_WIDGET (self->primary_bottom_box), primary);
-    /*
-    gtk_accessible_update_relation (GTK_ACCESSIBLE (self->levelbar),
-                                    GTK_ACCESSIBLE_RELATION_LABELLED_BY, primary ? self->primary_percentage_label
-                                                                                 : self->percentage_label,
-                                    NULL);
-     */
-
     self->kind = kind;
-    self->primary = primary;
-
-    return self;
 }
 
 gboolean
@@ -28,6 +28,7 @@ G_BEGIN_DECLS
 #define CC_TYPE_BATTERY_ROW (cc_battery_row_get_type ())
 G_DECLARE_FINAL_TYPE (CcBatteryRow, cc_battery_row, CC, BATTERY_ROW, GtkListBoxRow);
 CcBatteryRow *cc_battery_row_new (UpDevice *device, gboolean primary);
+void cc_battery_row_update (CcBatteryRow *self, UpDevice *device);
 
 gboolean cc_battery_row_get_primary (CcBatteryRow *row);
 UpDeviceKind cc_battery_row_get_kind (CcBatteryRow *row);
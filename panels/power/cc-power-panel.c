@@ -48,6 +48,9 @@ typedef enum {
     ACTION_AUTOMATIC,
 } ActionAvailability;
 
+/* Services that are slow to start shouldn't leave sections hidden forever */
+#define DBUS_CALL_TIMEOUT_MSEC (15 * 1000)
+
 struct _CcPowerPanel {
     CcPanel parent_instance;
 
@@ -87,8 +90,17 @@ struct _CcPowerPanel {
     GSettings *gsd_settings;
     GSettings *session_settings;
     GSettings *interface_settings;
+    GDBusConnection *system_bus;
     UpClient *up_client;
+    UpDevice *display_device;
     GPtrArray *devices;
+
+    /* UPower object path -> CcBatteryRow */
+    GHashTable *battery_rows;
+    /* Devices whose rows need to be refreshed on the next frame */
+    GHashTable *pending_devices;
+    gboolean rows_need_rebuild;
+    guint update_tick_id;
     gboolean has_batteries;
     char *chassis_type;
 
@@ -98,6 +110,7 @@ struct _CcPowerPanel {
 
     GDBusProxy *iio_proxy;
     guint iio_proxy_watch_id;
+    gboolean has_iio_proxy;
     GDBusProxy *shell_brightness_proxy;
     gboolean has_brightness_control;
 
@@ -128,6 +141,8 @@ add_battery (CcPowerPanel *self, UpDevice *device, gboolean primary)
 
     gtk_list_box_append (self->battery_listbox, GTK_WIDGET (row));
     gtk_widget_set_visible (GTK_WIDGET (self->battery_section), TRUE);
+
+    g_hash_table_insert (self->battery_rows, g_strdup (up_device_get_object_path (device)), row);
 }
 
 static void
@@ -137,41 +152,49 @@ add_device (CcPowerPanel *self, UpDevice *device)
 
     gtk_list_box_append (self->device_listbox, GTK_WIDGET (row));
     gtk_widget_set_visible (GTK_WIDGET (self->device_section), TRUE);
+
+    g_hash_table_insert (self->battery_rows, g_strdup (up_device_get_object_path (device)), row);
 }
 
 static void
 update_power_saver_low_battery_row_visibility (CcPowerPanel *self)
 {
-    g_autoptr(UpDevice) composite = NULL;
     UpDeviceKind kind = UP_DEVICE_KIND_UNKNOWN;
 
-    if (self->up_client) {
-        composite = up_client_get_display_device (self->up_client);
-        g_object_get (composite, "kind", &kind, NULL);
-    }
+    if (self->display_device)
+        g_object_get (self->display_device, "kind", &kind, NULL);
     gtk_widget_set_visible (GTK_WIDGET (self->power_saver_low_battery_row),
                             self->power_profiles_proxy && kind == UP_DEVICE_KIND_BATTERY);
 }
 
 static void
-battery_health_radio_changed_cb (CcPowerPanel *self)
+enable_charge_threshold_cb (GObject *source_object, GAsyncResult *res, gpointer user_data)
 {
-    guint i;
-    g_autoptr(GDBusConnection) connection = NULL;
     g_autoptr(GVariant) variant = NULL;
     g_autoptr(GError) error = NULL;
+
+    variant = g_dbus_connection_call_finish (G_DBUS_CONNECTION (source_object), res, &error);
+    if (!variant) {
+        if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            g_debug ("Failed to call %s(): %s", "EnableChargeThreshold", error->message);
+    }
+}
+
+static void
+battery_health_radio_changed_cb (CcPowerPanel *self)
+{
+    guint i;
     gboolean enabled;
 
     enabled = gtk_check_button_get_active (GTK_CHECK_BUTTON (self->preserve_battery_radio));
     g_debug ("Setting preserve battery health enabled %s", enabled ? "on" : "off");
 
-    connection = g_bus_get_sync (G_BUS_TYPE_SYSTEM, cc_panel_get_cancellable (CC_PANEL (self)), &error);
-    if (!connection) {
-        if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
-            g_warning ("system bus not available: %s", error->message);
+    if (!self->system_bus) {
+        g_warning ("system bus not available");
         return;
     }
 
+    /* The calls for all batteries are in flight at the same time */
     for (i = 0; self->devices != NULL && i < self->devices->len; i++) {
         UpDevice *device = (UpDevice *) g_ptr_array_index (self->devices, i);
         UpDeviceKind kind;
@@ -182,14 +205,11 @@ battery_health_radio_changed_cb (CcPowerPanel *self)
                       &is_charge_threshold_supported, "charge-threshold-enabled", &is_charge_threshold_enabled, NULL);
         if (kind == UP_DEVICE_KIND_BATTERY && is_power_supply && is_charge_threshold_supported) {
             g_debug ("%s charge limit for %s", enabled ? "Enable" : "Disable", up_device_get_object_path (device));
-            variant = g_dbus_connection_call_sync (connection, "org.freedesktop.UPower",
-                                                   up_device_get_object_path (device), "org.freedesktop.UPower.Device",
-                                                   "EnableChargeThreshold", g_variant_new ("(b)", enabled), NULL,
-                                                   G_DBUS_CALL_FLAGS_NONE, -1, NULL, &error);
-            if (!variant) {
-                if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
-                    g_debug ("Failed to call %s(): %s", "EnableChargeThreshold", error->message);
-            }
+            g_dbus_connection_call (self->system_bus, "org.freedesktop.UPower", up_device_get_object_path (device),
+                                    "org.freedesktop.UPower.Device", "EnableChargeThreshold",
+                                    g_variant_new ("(b)", enabled), NULL, G_DBUS_CALL_FLAGS_NONE,
+                                    DBUS_CALL_TIMEOUT_MSEC, cc_panel_get_cancellable (CC_PANEL (self)),
+                                    enable_charge_threshold_cb, NULL);
         }
     }
 }
@@ -228,61 +248,91 @@ power_saving_group_visibility_cb (CcPowerPanel *self)
 }
 
 static void
-up_client_changed (CcPowerPanel *self)
+update_charge_threshold_section (CcPowerPanel *self, gboolean on_ups)
+{
+    gboolean charge_threshold_supported = FALSE;
+    gboolean charge_threshold_enabled = FALSE;
+
+    for (guint i = 0; !on_ups && self->devices != NULL && i < self->devices->len; i++) {
+        UpDevice *device = (UpDevice *) g_ptr_array_index (self->devices, i);
+        UpDeviceKind kind;
+        gboolean is_power_supply = FALSE;
+        gboolean is_charge_threshold_supported = FALSE;
+        gboolean is_charge_threshold_enabled = FALSE;
+
+        g_object_get (device, "kind", &kind, "power-supply", &is_power_supply, NULL);
+        if (kind != UP_DEVICE_KIND_BATTERY || !is_power_supply)
+            continue;
+
+        g_object_get (device, "charge-threshold-enabled", &is_charge_threshold_enabled, "charge-threshold-supported",
+                      &is_charge_threshold_supported, NULL);
+
+        /* If any of the batteries support setting charge thresholds show a switch */
+        if (is_charge_threshold_supported)
+            charge_threshold_supported = TRUE;
+
+        if (is_charge_threshold_enabled)
+            charge_threshold_enabled = TRUE;
+    }
+
+    if (charge_threshold_supported) {
+        /* Block the signal handler to prevent infinite feedback loop when
+         * updating UI state on systems with multiple batteries */
+        g_signal_handlers_block_by_func (self->preserve_battery_radio, battery_health_radio_changed_cb, self);
+
+        if (charge_threshold_enabled) {
+            gtk_check_button_set_active (self->preserve_battery_radio, TRUE);
+        } else {
+            gtk_check_button_set_active (self->maximize_charge_radio, TRUE);
+        }
+
+        g_signal_handlers_unblock_by_func (self->preserve_battery_radio, battery_health_radio_changed_cb, self);
+    }
+
+    gtk_widget_set_visible (GTK_WIDGET (self->battery_charging_section), charge_threshold_supported);
+}
+
+static gboolean
+is_on_ups (CcPowerPanel *self)
+{
+    UpDeviceKind kind = UP_DEVICE_KIND_UNKNOWN;
+
+    if (self->display_device)
+        g_object_get (self->display_device, "kind", &kind, NULL);
+
+    return kind == UP_DEVICE_KIND_UPS;
+}
+
+/* Recreates all rows, needed when devices appear, disappear or move between sections */
+static void
+rebuild_battery_rows (CcPowerPanel *self)
 {
     gint i;
     UpDeviceKind kind = UP_DEVICE_KIND_UNKNOWN;
     guint n_batteries;
     gboolean on_ups;
-    gboolean charge_threshold_supported;
-    gboolean charge_threshold_enabled;
-    g_autoptr(UpDevice) composite = NULL;
 
     gtk_list_box_remove_all (self->battery_listbox);
     gtk_widget_set_visible (GTK_WIDGET (self->battery_section), FALSE);
 
-    gtk_widget_set_visible (GTK_WIDGET (self->battery_charging_section), FALSE);
     gtk_list_box_remove_all (self->device_listbox);
     gtk_widget_set_visible (GTK_WIDGET (self->device_section), FALSE);
 
-    charge_threshold_supported = FALSE;
-    charge_threshold_enabled = FALSE;
-    on_ups = FALSE;
-    n_batteries = 0;
-    if (self->up_client) {
-        composite = up_client_get_display_device (self->up_client);
-        g_object_get (composite, "kind", &kind, NULL);
-    }
+    g_hash_table_remove_all (self->battery_rows);
 
-    if (kind == UP_DEVICE_KIND_UPS) {
-        on_ups = TRUE;
-    } else {
-        gboolean is_extra_battery = FALSE;
+    on_ups = is_on_ups (self);
+    n_batteries = 0;
 
+    if (!on_ups) {
         /* Count the batteries */
         for (i = 0; self->devices != NULL && i < self->devices->len; i++) {
             UpDevice *device = (UpDevice *) g_ptr_array_index (self->devices, i);
             gboolean is_power_supply = FALSE;
-            gboolean is_charge_threshold_supported = FALSE;
-            gboolean is_charge_threshold_enabled = FALSE;
 
             g_object_get (device, "kind", &kind, "power-supply", &is_power_supply, NULL);
             if (kind == UP_DEVICE_KIND_BATTERY && is_power_supply) {
+                g_object_set_data (G_OBJECT (device), "is-main-battery", GINT_TO_POINTER (n_batteries == 0));
                 n_batteries++;
-                if (is_extra_battery == FALSE) {
-                    is_extra_battery = TRUE;
-                    g_object_set_data (G_OBJECT (device), "is-main-battery", GINT_TO_POINTER (TRUE));
-                }
-
-                g_object_get (device, "charge-threshold-enabled", &is_charge_threshold_enabled,
-                              "charge-threshold-supported", &is_charge_threshold_supported, NULL);
-
-                /* If any of the batteries support setting charge thresholds show a switch */
-                if (is_charge_threshold_supported)
-                    charge_threshold_supported = TRUE;
-
-                if (is_charge_threshold_enabled)
-                    charge_threshold_enabled = TRUE;
             }
         }
     }
@@ -297,7 +347,7 @@ up_client_changed (CcPowerPanel *self)
         adw_preferences_group_set_title (self->battery_section, _("Battery Level"));
 
     if (!on_ups && n_batteries > 1)
-        add_battery (self, composite, TRUE);
+        add_battery (self, self->display_device, TRUE);
 
     for (i = 0; self->devices != NULL && i < self->devices->len; i++) {
         UpDevice *device = (UpDevice *) g_ptr_array_index (self->devices, i);
@@ -315,26 +365,78 @@ up_client_changed (CcPowerPanel *self)
             add_device (self, device);
         }
     }
+}
 
-    if (charge_threshold_supported) {
-        /* Block the signal handler to prevent infinite feedback loop when
-         * updating UI state on systems with multiple batteries */
-        g_signal_handlers_block_by_func (self->preserve_battery_radio, battery_health_radio_changed_cb, self);
-
-        if (charge_threshold_enabled) {
-            gtk_check_button_set_active (self->preserve_battery_radio, TRUE);
-        } else {
-            gtk_check_button_set_active (self->maximize_charge_radio, TRUE);
-        }
+static void
+up_client_changed (CcPowerPanel *self)
+{
+    if (self->rows_need_rebuild) {
+        rebuild_battery_rows (self);
+    } else {
+        GHashTableIter iter;
+        UpDevice *device;
 
-        g_signal_handlers_unblock_by_func (self->preserve_battery_radio, battery_health_radio_changed_cb, self);
+        g_hash_table_iter_init (&iter, self->pending_devices);
+        while (g_hash_table_iter_next (&iter, (gpointer *) &device, NULL)) {
+            CcBatteryRow *row = g_hash_table_lookup (self->battery_rows, up_device_get_object_path (device));
 
-        gtk_widget_set_visible (GTK_WIDGET (self->battery_charging_section), TRUE);
+            if (row != NULL)
+                cc_battery_row_update (row, device);
+        }
     }
 
+    self->rows_need_rebuild = FALSE;
+    g_hash_table_remove_all (self->pending_devices);
+
+    update_charge_threshold_section (self, is_on_ups (self));
     update_power_saver_low_battery_row_visibility (self);
 }
 
+static gboolean
+update_tick_cb (GtkWidget *widget, GdkFrameClock *frame_clock, gpointer user_data)
+{
+    CcPowerPanel *self = CC_POWER_PANEL (widget);
+
+    self->update_tick_id = 0;
+    up_client_changed (self);
+
+    return G_SOURCE_REMOVE;
+}
+
+/* Changes are applied once per frame, however many devices changed meanwhile */
+static void
+queue_update (CcPowerPanel *self, UpDevice *device, gboolean rebuild)
+{
+    if (rebuild)
+        self->rows_need_rebuild = TRUE;
+    else if (device != NULL)
+        g_hash_table_add (self->pending_devices, g_object_ref (device));
+
+    if (self->update_tick_id == 0)
+        self->update_tick_id = gtk_widget_add_tick_callback (GTK_WIDGET (self), update_tick_cb, NULL, NULL);
+}
+
+static void
+device_notify_cb (CcPowerPanel *self, GParamSpec *pspec, UpDevice *device)
+{
+    /* These decide which section the row lives in */
+    gboolean rebuild = g_str_equal (pspec->name, "kind") || g_str_equal (pspec->name, "power-supply");
+
+    queue_update (self, device, rebuild);
+}
+
+static void
+display_device_notify_cb (CcPowerPanel *self, GParamSpec *pspec, UpDevice *device)
+{
+    queue_update (self, device, g_str_equal (pspec->name, "kind"));
+}
+
+static void
+watch_device (CcPowerPanel *self, UpDevice *device)
+{
+    g_signal_connect_object (G_OBJECT (device), "notify", G_CALLBACK (device_notify_cb), self, G_CONNECT_SWAPPED);
+}
+
 static void
 up_client_device_removed (CcPowerPanel *self, const char *object_path)
 {
@@ -347,20 +449,22 @@ up_client_device_removed (CcPowerPanel *self, const char *object_path)
         UpDevice *device = g_ptr_array_index (self->devices, i);
 
         if (g_strcmp0 (object_path, up_device_get_object_path (device)) == 0) {
+            g_signal_handlers_disconnect_by_func (device, device_notify_cb, self);
+            g_hash_table_remove (self->pending_devices, device);
             g_ptr_array_remove_index (self->devices, i);
             break;
         }
     }
 
-    up_client_changed (self);
+    queue_update (self, NULL, TRUE);
 }
 
 static void
 up_client_device_added (CcPowerPanel *self, UpDevice *device)
 {
     g_ptr_array_add (self->devices, g_object_ref (device));
-    g_signal_connect_object (G_OBJECT (device), "notify", G_CALLBACK (up_client_changed), self, G_CONNECT_SWAPPED);
-    up_client_changed (self);
+    watch_device (self, device);
+    queue_update (self, NULL, TRUE);
 }
 
 static void
@@ -431,29 +535,48 @@ als_enabled_setting_changed (CcPowerPanel *self)
 }
 
 static void
-iio_proxy_appeared_cb (GDBusConnection *connection, const gchar *name, const gchar *name_owner, gpointer user_data)
+iio_proxy_ready_cb (GObject *source_object, GAsyncResult *res, gpointer user_data)
 {
-    CcPowerPanel *self = CC_POWER_PANEL (user_data);
+    CcPowerPanel *self;
+    g_autoptr(GDBusProxy) proxy = NULL;
     g_autoptr(GError) error = NULL;
 
-    self->iio_proxy =
-        cc_object_storage_create_dbus_proxy_sync (G_BUS_TYPE_SYSTEM, G_DBUS_PROXY_FLAGS_NONE, "net.hadess.SensorProxy",
-                                                  "/net/hadess/SensorProxy", "net.hadess.SensorProxy", NULL, &error);
-    if (error != NULL) {
+    proxy = cc_object_storage_create_dbus_proxy_finish (res, &error);
+    if (!proxy) {
         if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
             g_warning ("Could not create IIO sensor proxy: %s", error->message);
         return;
     }
 
+    self = CC_POWER_PANEL (user_data);
+
+    /* The sensor may have vanished and reappeared meanwhile */
+    if (!self->has_iio_proxy || self->iio_proxy != NULL)
+        return;
+
+    self->iio_proxy = g_steal_pointer (&proxy);
+
     g_signal_connect_object (G_OBJECT (self->iio_proxy), "g-properties-changed", G_CALLBACK (als_enabled_state_changed),
                              self, G_CONNECT_SWAPPED);
     als_enabled_state_changed (self);
 }
 
+static void
+iio_proxy_appeared_cb (GDBusConnection *connection, const gchar *name, const gchar *name_owner, gpointer user_data)
+{
+    CcPowerPanel *self = CC_POWER_PANEL (user_data);
+
+    self->has_iio_proxy = TRUE;
+    cc_object_storage_create_dbus_proxy (G_BUS_TYPE_SYSTEM, G_DBUS_PROXY_FLAGS_NONE, "net.hadess.SensorProxy",
+                                         "/net/hadess/SensorProxy", "net.hadess.SensorProxy",
+                                         cc_panel_get_cancellable (CC_PANEL (self)), iio_proxy_ready_cb, self);
+}
+
 static void
 iio_proxy_vanished_cb (GDBusConnection *connection, const gchar *name, gpointer user_data)
 {
     CcPowerPanel *self = CC_POWER_PANEL (user_data);
+    self->has_iio_proxy = FALSE;
     g_clear_object (&self->iio_proxy);
     als_enabled_state_changed (self);
 }
@@ -582,6 +705,9 @@ setup_can_power_actions (CcPowerPanel *self)
         return;
     }
 
+    /* Kept for the charge threshold calls, which are made asynchronously */
+    self->system_bus = g_object_ref (connection);
+
     if (g_settings_get_boolean (lockdown_settings, "disable-log-out"))
         self->can_shutdown = ACTION_UNAVAILABLE;
     else
@@ -684,10 +810,30 @@ setup_suspend_delay_rows (CcPowerPanel *self)
 }
 
 static void
-setup_power_saving (CcPowerPanel *self)
+shell_brightness_proxy_ready_cb (GObject *source_object, GAsyncResult *res, gpointer user_data)
 {
+    CcPowerPanel *self;
+    g_autoptr(GDBusProxy) proxy = NULL;
     g_autoptr(GError) error = NULL;
 
+    proxy = cc_object_storage_create_dbus_proxy_finish (res, &error);
+    if (!proxy) {
+        if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            g_warning ("Could not create Shell Brightness proxy: %s", error->message);
+        return;
+    }
+
+    self = CC_POWER_PANEL (user_data);
+    self->shell_brightness_proxy = g_steal_pointer (&proxy);
+
+    g_signal_connect_object (self->shell_brightness_proxy, "g-properties-changed",
+                             G_CALLBACK (shell_brightness_changed_cb), self, G_CONNECT_SWAPPED);
+    shell_brightness_changed_cb (self);
+}
+
+static void
+setup_power_saving (CcPowerPanel *self)
+{
     /* ambient light sensor */
     self->iio_proxy_watch_id =
         g_bus_watch_name (G_BUS_TYPE_SYSTEM, "net.hadess.SensorProxy", G_BUS_NAME_WATCHER_FLAGS_NONE,
@@ -695,16 +841,10 @@ setup_power_saving (CcPowerPanel *self)
     g_signal_connect_object (self->gsd_settings, "changed", G_CALLBACK (als_enabled_setting_changed), self,
                              G_CONNECT_SWAPPED);
 
-    self->shell_brightness_proxy = cc_object_storage_create_dbus_proxy_sync (
+    cc_object_storage_create_dbus_proxy (
         G_BUS_TYPE_SESSION, G_DBUS_PROXY_FLAGS_DO_NOT_CONNECT_SIGNALS | G_DBUS_PROXY_FLAGS_DO_NOT_AUTO_START,
-        "org.gnome.Shell.Brightness", "/org/gnome/Shell/Brightness", "org.gnome.Shell.Brightness", NULL, &error);
-    if (!self->shell_brightness_proxy) {
-        g_warning ("Could not create Shell Brightness proxy: %s", error->message);
-    } else {
-        g_signal_connect_object (self->shell_brightness_proxy, "g-properties-changed",
-                                 G_CALLBACK (shell_brightness_changed_cb), self, G_CONNECT_SWAPPED);
-        shell_brightness_changed_cb (self);
-    }
+        "org.gnome.Shell.Brightness", "/org/gnome/Shell/Brightness", "org.gnome.Shell.Brightness",
+        cc_panel_get_cancellable (CC_PANEL (self)), shell_brightness_proxy_ready_cb, self);
 
     g_settings_bind (self->gsd_settings, "idle-dim", self->dim_screen_row, "active", G_SETTINGS_BIND_DEFAULT);
 
@@ -914,7 +1054,7 @@ set_active_profile_cb (GObject *source_object, GAsyncResult *res, gpointer user_
     g_autoptr(GVariant) variant = NULL;
     g_autoptr(GError) error = NULL;
 
-    variant = g_dbus_connection_call_finish (G_DBUS_CONNECTION (source_object), res, &error);
+    variant = g_dbus_proxy_call_finish (G_DBUS_PROXY (source_object), res, &error);
     if (!variant) {
         if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
             g_warning ("Could not set active profile: %s", error->message);
@@ -926,8 +1066,6 @@ power_profile_button_toggled_cb (CcPowerProfileRow *row, gpointer user_data)
 {
     CcPowerPanel *self = user_data;
     CcPowerProfile profile;
-    g_autoptr(GDBusConnection) connection = NULL;
-    g_autoptr(GError) error = NULL;
 
     if (!cc_power_profile_row_get_active (row))
         return;
@@ -936,25 +1074,18 @@ power_profile_button_toggled_cb (CcPowerProfileRow *row, gpointer user_data)
 
     profile = cc_power_profile_row_get_profile (row);
 
-    connection = g_bus_get_sync (G_BUS_TYPE_SYSTEM, cc_panel_get_cancellable (CC_PANEL (self)), &error);
-    if (!connection) {
-        if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
-            g_warning ("system bus not available: %s", error->message);
-        return;
-    }
-
-    g_dbus_connection_call (connection, "org.freedesktop.UPower.PowerProfiles", "/org/freedesktop/UPower/PowerProfiles",
-                            "org.freedesktop.DBus.Properties", "Set",
-                            g_variant_new ("(ssv)", "org.freedesktop.UPower.PowerProfiles", "ActiveProfile",
-                                           g_variant_new_string (cc_power_profile_to_str (profile))),
-                            NULL, G_DBUS_CALL_FLAGS_NONE, -1, cc_panel_get_cancellable (CC_PANEL (self)),
-                            set_active_profile_cb, NULL);
+    g_dbus_proxy_call (self->power_profiles_proxy, "org.freedesktop.DBus.Properties.Set",
+                       g_variant_new ("(ssv)", "org.freedesktop.UPower.PowerProfiles", "ActiveProfile",
+                                      g_variant_new_string (cc_power_profile_to_str (profile))),
+                       G_DBUS_CALL_FLAGS_NONE, DBUS_CALL_TIMEOUT_MSEC, cc_panel_get_cancellable (CC_PANEL (self)),
+                       set_active_profile_cb, NULL);
 }
 
 static void
-setup_power_profiles (CcPowerPanel *self)
+power_profiles_get_all_cb (GObject *source_object, GAsyncResult *res, gpointer user_data)
 {
-    g_autoptr(GDBusConnection) connection = NULL;
+    CcPowerPanel *self;
+    GDBusProxy *proxy = G_DBUS_PROXY (source_object);
     g_autoptr(GVariant) variant = NULL;
     g_autoptr(GVariant) props = NULL;
     guint i, num_children;
@@ -964,32 +1095,15 @@ setup_power_profiles (CcPowerPanel *self)
     g_autoptr(GVariant) profiles = NULL;
     GtkCheckButton *last_button;
 
-    self->power_profiles_proxy = cc_object_storage_create_dbus_proxy_sync (
-        G_BUS_TYPE_SYSTEM, G_DBUS_PROXY_FLAGS_NONE, "org.freedesktop.UPower.PowerProfiles",
-        "/org/freedesktop/UPower/PowerProfiles", "org.freedesktop.UPower.PowerProfiles", NULL, &error);
-
-    if (!self->power_profiles_proxy) {
-        g_debug ("Could not create Power Profiles proxy: %s", error->message);
-        return;
-    }
-
-    connection = g_bus_get_sync (G_BUS_TYPE_SYSTEM, cc_panel_get_cancellable (CC_PANEL (self)), &error);
-    if (!connection) {
+    variant = g_dbus_proxy_call_finish (proxy, res, &error);
+    if (!variant) {
         if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
-            g_warning ("system bus not available: %s", error->message);
+            g_debug ("Failed to get properties for Power Profiles: %s", error->message);
         return;
     }
 
-    variant = g_dbus_connection_call_sync (connection, "org.freedesktop.UPower.PowerProfiles",
-                                           "/org/freedesktop/UPower/PowerProfiles", "org.freedesktop.DBus.Properties",
-                                           "GetAll", g_variant_new ("(s)", "org.freedesktop.UPower.PowerProfiles"),
-                                           NULL, G_DBUS_CALL_FLAGS_NONE, -1, NULL, &error);
-
-    if (!variant) {
-        g_debug ("Failed to get properties for Power Profiles: %s", error->message);
-        g_clear_object (&self->power_profiles_proxy);
-        return;
-    }
+    self = CC_POWER_PANEL (user_data);
+    self->power_profiles_proxy = g_object_ref (proxy);
 
     gtk_widget_set_visible (GTK_WIDGET (self->power_profile_section), TRUE);
 
@@ -1000,7 +1114,7 @@ setup_power_profiles (CcPowerPanel *self)
 
     last_button = NULL;
     profiles = g_variant_lookup_value (props, "Profiles", NULL);
-    num_children = g_variant_n_children (profiles);
+    num_children = profiles ? g_variant_n_children (profiles) : 0;
     for (i = 0; i < num_children; i++) {
         g_autoptr(GVariant) profile_variant;
         const char *name;
@@ -1049,6 +1163,40 @@ setup_power_profiles (CcPowerPanel *self)
     update_power_saver_low_battery_row_visibility (self);
 }
 
+static void
+power_profiles_proxy_ready_cb (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+    CcPowerPanel *self;
+    g_autoptr(GDBusProxy) proxy = NULL;
+    g_autoptr(GError) error = NULL;
+
+    proxy = cc_object_storage_create_dbus_proxy_finish (res, &error);
+    if (!proxy) {
+        if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            g_debug ("Could not create Power Profiles proxy: %s", error->message);
+        return;
+    }
+
+    self = CC_POWER_PANEL (user_data);
+
+    /* The proxy is only kept once the daemon has answered */
+    g_dbus_proxy_call (proxy, "org.freedesktop.DBus.Properties.GetAll",
+                       g_variant_new ("(s)", "org.freedesktop.UPower.PowerProfiles"), G_DBUS_CALL_FLAGS_NONE,
+                       DBUS_CALL_TIMEOUT_MSEC, cc_panel_get_cancellable (CC_PANEL (self)), power_profiles_get_all_cb,
+                       self);
+}
+
+static void
+setup_power_profiles (CcPowerPanel *self)
+{
+    cc_object_storage_create_dbus_proxy (G_BUS_TYPE_SYSTEM, G_DBUS_PROXY_FLAGS_NONE,
+                                         "org.freedesktop.UPower.PowerProfiles",
+                                         "/org/freedesktop/UPower/PowerProfiles",
+                                         "org.freedesktop.UPower.PowerProfiles",
+                                         cc_panel_get_cancellable (CC_PANEL (self)), power_profiles_proxy_ready_cb,
+                                         self);
+}
+
 static void
 switch_to_single_page_layout (CcPowerPanel *self)
 {
@@ -1132,7 +1280,14 @@ cc_power_panel_dispose (GObject *object)
     g_clear_object (&self->session_settings);
     g_clear_object (&self->interface_settings);
     g_clear_pointer (&self->devices, g_ptr_array_unref);
+    g_clear_pointer (&self->battery_rows, g_hash_table_unref);
+    g_clear_pointer (&self->pending_devices, g_hash_table_unref);
+    if (self->update_tick_id != 0)
+        gtk_widget_remove_tick_callback (GTK_WIDGET (self), self->update_tick_id);
+    self->update_tick_id = 0;
+    g_clear_object (&self->display_device);
     g_clear_object (&self->up_client);
+    g_clear_object (&self->system_bus);
     g_clear_object (&self->iio_proxy);
     g_clear_object (&self->power_profiles_proxy);
     if (self->iio_proxy_watch_id != 0)
@@ -1212,6 +1367,10 @@ cc_power_panel_init (CcPowerPanel *self)
 
     self->up_client = up_client_new ();
     self->devices = self->up_client ? up_client_get_devices2 (self->up_client) : g_ptr_array_new ();
+    self->battery_rows = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    self->pending_devices = g_hash_table_new_full (g_direct_hash, g_direct_equal, g_object_unref, NULL);
+    if (self->up_client)
+        self->display_device = up_client_get_display_device (self->up_client);
     self->has_batteries = devices_have_batteries (self->devices);
 
     setup_can_power_actions (self);
@@ -1241,9 +1400,12 @@ cc_power_panel_init (CcPowerPanel *self)
                                  G_CONNECT_SWAPPED);
     }
 
-    for (i = 0; self->devices != NULL && i < self->devices->len; i++) {
-        UpDevice *device = g_ptr_array_index (self->devices, i);
-        g_signal_connect_object (G_OBJECT (device), "notify", G_CALLBACK (up_client_changed), self, G_CONNECT_SWAPPED);
-    }
+    for (i = 0; self->devices != NULL && i < self->devices->len; i++)
+        watch_device (self, g_ptr_array_index (self->devices, i));
+    if (self->display_device)
+        g_signal_connect_object (G_OBJECT (self->display_device), "notify", G_CALLBACK (display_device_notify_cb), self,
+                                 G_CONNECT_SWAPPED);
+
+    self->rows_need_rebuild = TRUE;
     up_client_changed (self);
 }
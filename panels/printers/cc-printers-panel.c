@@ -1070,3 +1070,10 @@ Please check your installation");
 
     pp_cups_connection_test_async (self->cups, cc_panel_get_cancellable (CC_PANEL (self)), connection_test_cb, self);
 }
+
+void
+cc_printers_panel_static_init_func (void)
+{
+    cc_object_storage_declare_dbus_proxy (G_BUS_TYPE_SYSTEM, G_DBUS_PROXY_FLAGS_NONE, CUPS_DBUS_NAME, CUPS_DBUS_PATH,
+                                          CUPS_DBUS_INTERFACE);
+}
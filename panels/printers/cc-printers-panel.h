@@ -24,4 +24,7 @@ G_BEGIN_DECLS
 
 #define CC_TYPE_PRINTERS_PANEL (cc_printers_panel_get_type ())
 G_DECLARE_FINAL_TYPE (CcPrintersPanel, cc_printers_panel, CC, PRINTERS_PANEL, CcPanel);
+
+void cc_printers_panel_static_init_func (void);
+
 G_END_DECLS
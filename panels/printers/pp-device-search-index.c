@@ -0,0 +1,307 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 8 -*-
+ *
+ * Copyright 2026  The GNOME Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "cc-util.h"
+#include "pp-device-search-index.h"
+
+/*
+ * Every substring of up to MAX_GRAM_LENGTH characters of the search keys
+ * is indexed. Search words which are not longer than that are answered
+ * directly from the table, longer words are narrowed down to the devices
+ * containing their rarest trigram and then verified against the keys.
+ */
+#define MAX_GRAM_LENGTH 3
+
+typedef struct {
+    PpPrintDevice *device;
+    gchar *name_key;
+    gchar *location_key;
+} IndexEntry;
+
+struct _PpDeviceSearchIndex {
+    /* PpPrintDevice * -> IndexEntry * */
+    GHashTable *entries;
+    /* n-gram -> set of PpPrintDevice * */
+    GHashTable *grams;
+};
+
+static void
+index_entry_free (IndexEntry *entry)
+{
+    g_clear_object (&entry->device);
+    g_free (entry->name_key);
+    g_free (entry->location_key);
+    g_free (entry);
+}
+
+static void
+collect_grams (const gchar *key, GHashTable *grams)
+{
+    const gchar *start;
+
+    if (key == NULL)
+        return;
+
+    for (start = key; *start != '\0'; start = g_utf8_next_char (start)) {
+        const gchar *end = start;
+
+        for (gint n = 0; n < MAX_GRAM_LENGTH && *end != '\0'; n++) {
+            end = g_utf8_next_char (end);
+            g_hash_table_add (grams, g_strndup (start, end - start));
+        }
+    }
+}
+
+static GHashTable *
+entry_get_grams (IndexEntry *entry)
+{
+    GHashTable *grams;
+
+    grams = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    collect_grams (entry->name_key, grams);
+    collect_grams (entry->location_key, grams);
+
+    return grams;
+}
+
+static gboolean
+entry_matches (IndexEntry *entry, const gchar *word)
+{
+    return (entry->name_key != NULL && strstr (entry->name_key, word) != NULL)
+           || (entry->location_key != NULL && strstr (entry->location_key, word) != NULL);
+}
+
+PpDeviceSearchIndex *
+pp_device_search_index_new (void)
+{
+    PpDeviceSearchIndex *self;
+
+    self = g_new0 (PpDeviceSearchIndex, 1);
+    self->entries = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) index_entry_free);
+    self->grams = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_hash_table_unref);
+
+    return self;
+}
+
+void
+pp_device_search_index_free (PpDeviceSearchIndex *self)
+{
+    if (self == NULL)
+        return;
+
+    g_clear_pointer (&self->grams, g_hash_table_unref);
+    g_clear_pointer (&self->entries, g_hash_table_unref);
+    g_free (self);
+}
+
+void
+pp_device_search_index_add (PpDeviceSearchIndex *self, PpPrintDevice *device)
+{
+    g_autoptr(GHashTable) grams = NULL;
+    GHashTableIter iter;
+    IndexEntry *entry;
+    gchar *gram;
+
+    g_return_if_fail (self != NULL);
+    g_return_if_fail (PP_IS_PRINT_DEVICE (device));
+
+    /* Properties of the device may have changed since it was added */
+    if (g_hash_table_contains (self->entries, device))
+        pp_device_search_index_remove (self, device);
+
+    entry = g_new0 (IndexEntry, 1);
+    entry->device = g_object_ref (device);
+    entry->name_key = cc_util_normalize_casefold_and_unaccent (pp_print_device_get_device_name (device));
+    entry->location_key = cc_util_normalize_casefold_and_unaccent (pp_print_device_get_device_location (device));
+    g_hash_table_insert (self->entries, device, entry);
+
+    grams = entry_get_grams (entry);
+    g_hash_table_iter_init (&iter, grams);
+    while (g_hash_table_iter_next (&iter, (gpointer *) &gram, NULL)) {
+        GHashTable *devices;
+
+        devices = g_hash_table_lookup (self->grams, gram);
+        if (devices == NULL) {
+            devices = g_hash_table_new (g_direct_hash, g_direct_equal);
+            g_hash_table_insert (self->grams, g_strdup (gram), devices);
+        }
+
+        g_hash_table_add (devices, device);
+    }
+}
+
+void
+pp_device_search_index_remove (PpDeviceSearchIndex *self, PpPrintDevice *device)
+{
+    g_autoptr(GHashTable) grams = NULL;
+    GHashTableIter iter;
+    IndexEntry *entry;
+    gchar *gram;
+
+    g_return_if_fail (self != NULL);
+
+    entry = g_hash_table_lookup (self->entries, device);
+    if (entry == NULL)
+        return;
+
+    grams = entry_get_grams (entry);
+    g_hash_table_iter_init (&iter, grams);
+    while (g_hash_table_iter_next (&iter, (gpointer *) &gram, NULL)) {
+        GHashTable *devices;
+
+        devices = g_hash_table_lookup (self->grams, gram);
+        if (devices == NULL)
+            continue;
+
+        g_hash_table_remove (devices, device);
+        if (g_hash_table_size (devices) == 0)
+            g_hash_table_remove (self->grams, gram);
+    }
+
+    g_hash_table_remove (self->entries, device);
+}
+
+guint
+pp_device_search_index_get_n_devices (PpDeviceSearchIndex *self)
+{
+    g_return_val_if_fail (self != NULL, 0);
+
+    return g_hash_table_size (self->entries);
+}
+
+/*
+ * Returns the subset of @candidates (or of all indexed devices if
+ * @candidates is NULL) which contain @word in their name or location.
+ */
+static GHashTable *
+match_word (PpDeviceSearchIndex *self, const gchar *word, GHashTable *candidates)
+{
+    GHashTable *matches;
+    GHashTable *smallest = NULL;
+    GHashTable *other = NULL;
+    GHashTableIter iter;
+    gboolean verify = FALSE;
+    gpointer device;
+
+    matches = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+    if (g_utf8_strlen (word, -1) <= MAX_GRAM_LENGTH) {
+        smallest = g_hash_table_lookup (self->grams, word);
+    } else {
+        const gchar *start;
+
+        verify = TRUE;
+        for (start = word; *start != '\0'; start = g_utf8_next_char (start)) {
+            g_autofree gchar *trigram = NULL;
+            GHashTable *devices;
+            const gchar *end = start;
+            gint n;
+
+            for (n = 0; n < MAX_GRAM_LENGTH && *end != '\0'; n++)
+                end = g_utf8_next_char (end);
+
+            if (n < MAX_GRAM_LENGTH)
+                break;
+
+            trigram = g_strndup (start, end - start);
+            devices = g_hash_table_lookup (self->grams, trigram);
+            if (devices == NULL) {
+                smallest = NULL;
+                break;
+            }
+
+            if (smallest == NULL || g_hash_table_size (devices) < g_hash_table_size (smallest))
+                smallest = devices;
+        }
+    }
+
+    if (smallest == NULL)
+        return matches;
+
+    /* Walk the smaller of the two sets and probe the other one */
+    if (candidates != NULL) {
+        if (g_hash_table_size (candidates) < g_hash_table_size (smallest)) {
+            other = smallest;
+            smallest = candidates;
+        } else {
+            other = candidates;
+        }
+    }
+
+    g_hash_table_iter_init (&iter, smallest);
+    while (g_hash_table_iter_next (&iter, &device, NULL)) {
+        if (other != NULL && !g_hash_table_contains (other, device))
+            continue;
+
+        if (verify && !entry_matches (g_hash_table_lookup (self->entries, device), word))
+            continue;
+
+        g_hash_table_add (matches, device);
+    }
+
+    return matches;
+}
+
+/*
+ * Returns a set of the indexed devices whose name or location contains
+ * every space separated word of @text. The devices are not referenced and
+ * are only valid as long as they stay in @self.
+ */
+GHashTable *
+pp_device_search_index_lookup (PpDeviceSearchIndex *self, const gchar *text)
+{
+    g_autofree gchar *normalized = NULL;
+    g_auto(GStrv) words = NULL;
+    GHashTable *result = NULL;
+
+    g_return_val_if_fail (self != NULL, NULL);
+
+    normalized = cc_util_normalize_casefold_and_unaccent (text != NULL ? text : "");
+    words = g_strsplit_set (normalized, " ", -1);
+
+    for (gint i = 0; words[i] != NULL; i++) {
+        GHashTable *matches;
+
+        if (words[i][0] == '\0')
+            continue;
+
+        matches = match_word (self, words[i], result);
+        g_clear_pointer (&result, g_hash_table_unref);
+        result = matches;
+
+        if (g_hash_table_size (result) == 0)
+            break;
+    }
+
+    if (result == NULL) {
+        GHashTableIter iter;
+        gpointer device;
+
+        result = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+        g_hash_table_iter_init (&iter, self->entries);
+        while (g_hash_table_iter_next (&iter, &device, NULL))
+            g_hash_table_add (result, device);
+    }
+
+    return result;
+}
@@ -0,0 +1,38 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 8 -*-
+ *
+ * Copyright 2026  The GNOME Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <glib.h>
+
+#include "pp-print-device.h"
+
+G_BEGIN_DECLS
+
+typedef struct _PpDeviceSearchIndex PpDeviceSearchIndex;
+
+PpDeviceSearchIndex *pp_device_search_index_new (void);
+void pp_device_search_index_free (PpDeviceSearchIndex *self);
+void pp_device_search_index_add (PpDeviceSearchIndex *self, PpPrintDevice *device);
+void pp_device_search_index_remove (PpDeviceSearchIndex *self, PpPrintDevice *device);
+guint pp_device_search_index_get_n_devices (PpDeviceSearchIndex *self);
+GHashTable *pp_device_search_index_lookup (PpDeviceSearchIndex *self, const gchar *text);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (PpDeviceSearchIndex, pp_device_search_index_free)
+
+G_END_DECLS
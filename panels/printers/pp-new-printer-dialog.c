@@ -29,6 +29,7 @@
 #include <gtk/gtk.h>
 
 #include "pp-cups.h"
+#include "pp-device-search-index.h"
 #include "pp-host.h"
 #include "pp-new-printer-dialog.h"
 #include "pp-new-printer.h"
@@ -82,6 +83,7 @@ struct _PpNewPrinterDialog {
 
     GtkListStore *devices_liststore;
     GtkTreeModelFilter *devices_model_filter;
+    PpDeviceSearchIndex *search_index;
 
     /* headerbar */
     AdwWindowTitle *header_title;
@@ -361,6 +363,7 @@ remove_device_from_list (PpNewPrinterDialog *self, const gchar *device_name)
         gtk_tree_model_get (GTK_TREE_MODEL (self->devices_liststore), &iter, DEVICE_COLUMN, &device, -1);
 
         if (g_strcmp0 (pp_print_device_get_device_name (device), device_name) == 0) {
+            pp_device_search_index_remove (self->search_index, device);
             gtk_list_store_remove (self->devices_liststore, &iter);
             break;
         }
@@ -961,53 +964,34 @@ search_for_remote_printers (THostSearchData *data)
 static void
 search_address (const gchar *text, PpNewPrinterDialog *self, gboolean delay_search)
 {
+    g_autoptr(GHashTable) matches = NULL;
+    g_auto(GStrv) words = NULL;
     GtkTreeIter iter;
-    gboolean found = FALSE;
-    gboolean subfound;
+    gboolean found;
     gboolean next_set;
     gboolean cont;
-    g_autofree gchar *lowercase_text = NULL;
-    gchar **words;
-    gint words_length = 0;
-    gint i;
+    gint words_length;
     gint acquisition_method;
 
-    lowercase_text = g_ascii_strdown (text, -1);
-    words = g_strsplit_set (lowercase_text, " ", -1);
-
-    if (words) {
-        words_length = g_strv_length (words);
-
-        cont = gtk_tree_model_get_iter_first (GTK_TREE_MODEL (self->devices_liststore), &iter);
-        while (cont) {
-            g_autoptr(PpPrintDevice) device = NULL;
-            g_autofree gchar *lowercase_name = NULL;
-            g_autofree gchar *lowercase_location = NULL;
-
-            gtk_tree_model_get (GTK_TREE_MODEL (self->devices_liststore), &iter, DEVICE_COLUMN, &device, -1);
+    words = g_strsplit_set (text, " ", -1);
+    words_length = g_strv_length (words);
 
-            lowercase_name = g_ascii_strdown (pp_print_device_get_device_name (device), -1);
-            if (pp_print_device_get_device_location (device))
-                lowercase_location = g_ascii_strdown (pp_print_device_get_device_location (device), -1);
-            else
-                lowercase_location = NULL;
+    matches = pp_device_search_index_lookup (self->search_index, text);
+    found = g_hash_table_size (matches) > 0;
 
-            subfound = TRUE;
-            for (i = 0; words[i]; i++) {
-                if (!g_strrstr (lowercase_name, words[i])
-                    && (!lowercase_location || !g_strrstr (lowercase_location, words[i])))
-                    subfound = FALSE;
-            }
+    cont = gtk_tree_model_get_iter_first (GTK_TREE_MODEL (self->devices_liststore), &iter);
+    while (cont) {
+        g_autoptr(PpPrintDevice) device = NULL;
+        gboolean visible;
 
-            if (subfound)
-                found = TRUE;
+        gtk_tree_model_get (GTK_TREE_MODEL (self->devices_liststore), &iter, DEVICE_COLUMN, &device,
+                            DEVICE_VISIBLE_COLUMN, &visible, -1);
 
-            gtk_list_store_set (GTK_LIST_STORE (self->devices_liststore), &iter, DEVICE_VISIBLE_COLUMN, subfound, -1);
+        /* Every change of the column refilters the row, so only touch rows which change */
+        if (visible != g_hash_table_contains (matches, device))
+            gtk_list_store_set (GTK_LIST_STORE (self->devices_liststore), &iter, DEVICE_VISIBLE_COLUMN, !visible, -1);
 
-            cont = gtk_tree_model_iter_next (GTK_TREE_MODEL (self->devices_liststore), &iter);
-        }
-
-        g_strfreev (words);
+        cont = gtk_tree_model_iter_next (GTK_TREE_MODEL (self->devices_liststore), &iter);
     }
 
     /*
@@ -1029,6 +1013,7 @@ search_address (const gchar *text, PpNewPrinterDialog *self, gboolean delay_sear
                 || acquisition_method == ACQUISITION_METHOD_SNMP || acquisition_method == ACQUISITION_METHOD_JETDIRECT
                 || acquisition_method == ACQUISITION_METHOD_LPD
                 || acquisition_method == ACQUISITION_METHOD_SAMBA_HOST) {
+                pp_device_search_index_remove (self->search_index, device);
                 if (!gtk_list_store_remove (self->devices_liststore, &iter))
                     break;
                 else
@@ -1122,6 +1107,18 @@ get_local_scheme_description_from_uri (gchar *device_uri)
     return description;
 }
 
+static void
+unindex_device_at_iter (PpNewPrinterDialog *self, GtkTreeIter *iter)
+{
+    g_autoptr(PpPrintDevice) device = NULL;
+
+    if (iter == NULL)
+        return;
+
+    gtk_tree_model_get (GTK_TREE_MODEL (self->devices_liststore), iter, DEVICE_COLUMN, &device, -1);
+    pp_device_search_index_remove (self->search_index, device);
+}
+
 static void
 set_device (PpNewPrinterDialog *self, PpPrintDevice *device, GtkTreeIter *iter)
 {
@@ -1156,6 +1153,8 @@ set_device (PpNewPrinterDialog *self, PpPrintDevice *device, GtkTreeIter *iter)
 
             if (iter == NULL)
                 gtk_list_store_append (self->devices_liststore, &titer);
+            else
+                unindex_device_at_iter (self, iter);
 
             gtk_list_store_set (
                 self->devices_liststore, iter == NULL ? &titer : iter, DEVICE_GICON_COLUMN,
@@ -1163,9 +1162,12 @@ set_device (PpNewPrinterDialog *self, PpPrintDevice *device, GtkTreeIter *iter)
                 DEVICE_NAME_COLUMN, pp_print_device_get_device_name (device), DEVICE_DISPLAY_NAME_COLUMN,
                 pp_print_device_get_display_name (device), DEVICE_DESCRIPTION_COLUMN, description,
                 DEVICE_VISIBLE_COLUMN, TRUE, DEVICE_COLUMN, device, -1);
+            pp_device_search_index_add (self->search_index, device);
         } else if (pp_print_device_is_authenticated_server (device) && pp_print_device_get_host_name (device) != NULL) {
             if (iter == NULL)
                 gtk_list_store_append (self->devices_liststore, &titer);
+            else
+                unindex_device_at_iter (self, iter);
 
             gtk_list_store_set (self->devices_liststore, iter == NULL ? &titer : iter, DEVICE_GICON_COLUMN,
                                 self->authenticated_server_icon, DEVICE_NAME_COLUMN,
@@ -1175,6 +1177,7 @@ set_device (PpNewPrinterDialog *self, PpPrintDevice *device, GtkTreeIter *iter)
                                 DEVICE_DESCRIPTION_COLUMN,
                                 _("Server requires authentication"), SERVER_NEEDS_AUTHENTICATION_COLUMN, TRUE,
                                   DEVICE_VISIBLE_COLUMN, TRUE, DEVICE_COLUMN, device, -1);
+            pp_device_search_index_add (self->search_index, device);
         }
     }
 }
@@ -1427,6 +1430,7 @@ pp_new_printer_dialog_new (PPDList *ppd_list, UserResponseCallback user_callback
     self->list = ppd_list_copy (ppd_list);
 
     self->local_cups_devices = g_ptr_array_new_with_free_func (g_object_unref);
+    self->search_index = pp_device_search_index_new ();
 
     /* GCancellable for cancelling of async operations */
     self->cancellable = g_cancellable_new ();
@@ -1476,6 +1480,7 @@ pp_new_printer_dialog_dispose (GObject *object)
     g_clear_object (&self->cancellable);
     g_clear_pointer (&self->list, ppd_list_free);
     g_clear_pointer (&self->local_cups_devices, g_ptr_array_unref);
+    g_clear_pointer (&self->search_index, pp_device_search_index_free);
     g_clear_object (&self->new_device);
     g_clear_object (&self->local_printer_icon);
     g_clear_object (&self->remote_printer_icon);
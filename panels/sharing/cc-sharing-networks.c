@@ -42,6 +42,9 @@ struct _CcSharingNetworks {
     CcSharingStatus status;
 
     GList *networks; /* list of CcSharingNetwork */
+
+    GCancellable *cancellable;
+    GCancellable *list_cancellable;
 };
 
 G_DEFINE_FINAL_TYPE (CcSharingNetworks, cc_sharing_networks, ADW_TYPE_PREFERENCES_GROUP)
@@ -58,6 +61,7 @@ static GParamSpec *properties[N_PROPS];
 
 static void cc_sharing_networks_class_init (CcSharingNetworksClass *klass);
 static void cc_sharing_networks_init (CcSharingNetworks *self);
+static void cc_sharing_networks_dispose (GObject *object);
 static void cc_sharing_networks_finalize (GObject *object);
 
 static void cc_sharing_update_networks_box (CcSharingNetworks *self);
@@ -68,6 +72,27 @@ typedef struct {
     char *carrier_type;
 } CcSharingNetwork;
 
+/* An enable or disable call whose result is already shown */
+typedef struct {
+    CcSharingNetworks *self;
+    CcSharingNetwork *network;
+    gint position;
+    gboolean enable;
+} NetworkOperation;
+
+static CcSharingNetwork *
+cc_sharing_network_new (const char *uuid, const char *network_name, const char *carrier_type)
+{
+    CcSharingNetwork *net;
+
+    net = g_new0 (CcSharingNetwork, 1);
+    net->uuid = g_strdup (uuid);
+    net->network_name = g_strdup (network_name);
+    net->carrier_type = g_strdup (carrier_type);
+
+    return net;
+}
+
 static void
 cc_sharing_network_free (gpointer data)
 {
@@ -79,6 +104,52 @@ cc_sharing_network_free (gpointer data)
     g_free (net);
 }
 
+static void
+network_operation_free (NetworkOperation *operation)
+{
+    g_clear_pointer (&operation->network, cc_sharing_network_free);
+    g_free (operation);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (NetworkOperation, network_operation_free)
+
+static GList *
+cc_sharing_networks_find (CcSharingNetworks *self, const char *uuid)
+{
+    for (GList *l = self->networks; l != NULL; l = l->next) {
+        CcSharingNetwork *net = l->data;
+
+        if (g_strcmp0 (net->uuid, uuid) == 0)
+            return l;
+    }
+
+    return NULL;
+}
+
+/* Takes @uuid out of the cached list, for the operation to put it back on failure */
+static NetworkOperation *
+network_operation_new_disable (CcSharingNetworks *self, const char *uuid)
+{
+    NetworkOperation *operation;
+    GList *l;
+
+    operation = g_new0 (NetworkOperation, 1);
+    operation->self = self;
+    operation->enable = FALSE;
+
+    l = cc_sharing_networks_find (self, uuid);
+    if (l != NULL) {
+        operation->position = g_list_position (self->networks, l);
+        operation->network = l->data;
+        self->networks = g_list_delete_link (self->networks, l);
+    } else {
+        operation->position = -1;
+        operation->network = cc_sharing_network_new (uuid, NULL, NULL);
+    }
+
+    return operation;
+}
+
 static void
 cc_sharing_networks_update_status (CcSharingNetworks *self)
 {
@@ -98,23 +169,33 @@ cc_sharing_networks_update_status (CcSharingNetworks *self)
 }
 
 static void
-cc_sharing_update_networks (CcSharingNetworks *self)
+list_networks_cb (GObject *source_object, GAsyncResult *res, gpointer user_data)
 {
+    CcSharingNetworks *self;
     g_autoptr(GVariant) networks = NULL;
     char *uuid, *network_name, *carrier_type;
     GVariantIter iter;
     g_autoptr(GError) error = NULL;
 
-    g_list_free_full (self->networks, cc_sharing_network_free);
-    self->networks = NULL;
+    if (!gsd_sharing_call_list_networks_finish (GSD_SHARING (source_object), &networks, res, &error)) {
+        if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            return;
 
-    if (!gsd_sharing_call_list_networks_sync (self->proxy, self->service_name, &networks, NULL, &error)) {
+        self = CC_SHARING_NETWORKS (user_data);
         g_warning ("couldn't list networks: %s", error->message);
         g_dbus_proxy_set_cached_property (G_DBUS_PROXY (self->proxy), "SharingStatus",
                                           g_variant_new_uint32 (GSD_SHARING_STATUS_OFFLINE));
+        g_list_free_full (self->networks, cc_sharing_network_free);
+        self->networks = NULL;
+        cc_sharing_update_networks_box (self);
         return;
     }
 
+    self = CC_SHARING_NETWORKS (user_data);
+
+    g_list_free_full (self->networks, cc_sharing_network_free);
+    self->networks = NULL;
+
     g_variant_iter_init (&iter, networks);
     while (g_variant_iter_next (&iter, "(sss)", &uuid, &network_name, &carrier_type)) {
         CcSharingNetwork *net;
@@ -126,50 +207,117 @@ cc_sharing_update_networks (CcSharingNetworks *self)
         self->networks = g_list_prepend (self->networks, net);
     }
     self->networks = g_list_reverse (self->networks);
+
+    cc_sharing_update_networks_box (self);
 }
 
 static void
-cc_sharing_networks_remove_network (CcSharingNetworks *self, GtkWidget *button)
+cc_sharing_update_networks (CcSharingNetworks *self)
 {
-    GtkWidget *row;
+    /* Only the most recent listing is of interest */
+    g_cancellable_cancel (self->list_cancellable);
+    g_clear_object (&self->list_cancellable);
+    self->list_cancellable = g_cancellable_new ();
+
+    gsd_sharing_call_list_networks (self->proxy, self->service_name, self->list_cancellable, list_networks_cb, self);
+}
+
+static void
+network_operation_done (NetworkOperation *operation, gboolean ret, GError *error)
+{
+    CcSharingNetworks *self = operation->self;
+    GList *l;
+
+    if (ret || g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        return;
+
+    g_warning ("Failed to %s service %s: %s", operation->enable ? "enable" : "disable", self->service_name,
+               error->message);
+
+    /* Undo the change that was shown when the call was made */
+    l = cc_sharing_networks_find (self, operation->network->uuid);
+    if (operation->enable && l != NULL) {
+        cc_sharing_network_free (l->data);
+        self->networks = g_list_delete_link (self->networks, l);
+    } else if (!operation->enable && l == NULL) {
+        self->networks = g_list_insert (self->networks, g_steal_pointer (&operation->network), operation->position);
+    }
+
+    cc_sharing_update_networks_box (self);
+}
+
+static void
+enable_service_cb (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+    g_autoptr(NetworkOperation) operation = user_data;
     g_autoptr(GError) error = NULL;
     gboolean ret;
+
+    ret = gsd_sharing_call_enable_service_finish (GSD_SHARING (source_object), res, &error);
+    network_operation_done (operation, ret, error);
+}
+
+static void
+disable_service_cb (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+    g_autoptr(NetworkOperation) operation = user_data;
+    g_autoptr(GError) error = NULL;
+    gboolean ret;
+
+    ret = gsd_sharing_call_disable_service_finish (GSD_SHARING (source_object), res, &error);
+    network_operation_done (operation, ret, error);
+}
+
+static void
+cc_sharing_networks_remove_network (CcSharingNetworks *self, GtkWidget *button)
+{
+    NetworkOperation *operation;
+    GtkWidget *row;
     const char *uuid;
 
     row = g_object_get_data (G_OBJECT (button), "row");
     uuid = g_object_get_data (G_OBJECT (row), "uuid");
 
-    ret = gsd_sharing_call_disable_service_sync (self->proxy, self->service_name, uuid, NULL, &error);
-    if (!ret)
-        g_warning ("Failed to remove service %s: %s", self->service_name, error->message);
+    operation = network_operation_new_disable (self, uuid);
+    gsd_sharing_call_disable_service (self->proxy, self->service_name, uuid, self->cancellable, disable_service_cb,
+                                      operation);
 
-    cc_sharing_update_networks (self);
-    cc_sharing_update_networks_box (self);
+    gtk_list_box_remove (GTK_LIST_BOX (self->listbox), row);
+    cc_sharing_networks_update_status (self);
 }
 
 static gboolean
 cc_sharing_networks_enable_network (CcSharingNetworks *self, gboolean state, GtkSwitch *widget)
 {
-    g_autoptr(GError) error = NULL;
-    gboolean ret;
+    const char *current_network;
+    NetworkOperation *operation;
+
+    current_network = gsd_sharing_get_current_network (self->proxy);
 
     if (state) {
-        ret = gsd_sharing_call_enable_service_sync (self->proxy, self->service_name, NULL, &error);
-    } else {
-        ret = gsd_sharing_call_disable_service_sync (self->proxy, self->service_name,
-                                                     gsd_sharing_get_current_network (self->proxy), NULL, &error);
-    }
+        const char *network_name = gsd_sharing_get_current_network_name (self->proxy);
+        const char *carrier_type = gsd_sharing_get_carrier_type (self->proxy);
+
+        operation = g_new0 (NetworkOperation, 1);
+        operation->self = self;
+        operation->enable = TRUE;
+        operation->network = cc_sharing_network_new (current_network, network_name, carrier_type);
 
-    if (ret) {
-        gtk_switch_set_state (widget, state);
+        if (cc_sharing_networks_find (self, current_network) == NULL) {
+            self->networks = g_list_append (self->networks,
+                                            cc_sharing_network_new (current_network, network_name, carrier_type));
+        }
+
+        gsd_sharing_call_enable_service (self->proxy, self->service_name, self->cancellable, enable_service_cb,
+                                         operation);
     } else {
-        g_warning ("Failed to %s service %s: %s", state ? "enable" : "disable", self->service_name, error->message);
-        g_signal_handlers_block_by_func (widget, cc_sharing_networks_enable_network, self);
-        gtk_switch_set_active (widget, !state);
-        g_signal_handlers_unblock_by_func (widget, cc_sharing_networks_enable_network, self);
+        operation = network_operation_new_disable (self, current_network);
+        gsd_sharing_call_disable_service (self->proxy, self->service_name, current_network, self->cancellable,
+                                          disable_service_cb, operation);
     }
 
-    cc_sharing_update_networks (self);
+    /* Show the new state right away, it is reverted if the call fails */
+    gtk_switch_set_state (widget, state);
     cc_sharing_networks_update_status (self);
 
     return TRUE;
@@ -312,7 +460,6 @@ static void
 current_network_changed (CcSharingNetworks *self)
 {
     cc_sharing_update_networks (self);
-    cc_sharing_update_networks_box (self);
 }
 
 static void
@@ -328,8 +475,8 @@ cc_sharing_networks_constructed (GObject *object)
     gtk_list_box_insert (GTK_LIST_BOX (self->listbox), self->current_row, -1);
     g_object_set_data (G_OBJECT (self), "switch", self->current_switch);
 
-    cc_sharing_update_networks (self);
     cc_sharing_update_networks_box (self);
+    cc_sharing_update_networks (self);
 
     g_signal_connect_object (self->proxy, "notify::current-network", G_CALLBACK (current_network_changed), self,
                              G_CONNECT_SWAPPED);
@@ -339,6 +486,8 @@ static void
 cc_sharing_networks_init (CcSharingNetworks *self)
 {
     gtk_widget_init_template (GTK_WIDGET (self));
+
+    self->cancellable = g_cancellable_new ();
 }
 
 GtkWidget *
@@ -387,6 +536,19 @@ cc_sharing_networks_get_property (GObject *object, guint prop_id, GValue *value,
     }
 }
 
+static void
+cc_sharing_networks_dispose (GObject *object)
+{
+    CcSharingNetworks *self = CC_SHARING_NETWORKS (object);
+
+    g_cancellable_cancel (self->cancellable);
+    g_clear_object (&self->cancellable);
+    g_cancellable_cancel (self->list_cancellable);
+    g_clear_object (&self->list_cancellable);
+
+    G_OBJECT_CLASS (cc_sharing_networks_parent_class)->dispose (object);
+}
+
 static void
 cc_sharing_networks_finalize (GObject *object)
 {
@@ -418,6 +580,7 @@ cc_sharing_networks_class_init (CcSharingNetworksClass *klass)
 
     object_class->set_property = cc_sharing_networks_set_property;
     object_class->get_property = cc_sharing_networks_get_property;
+    object_class->dispose = cc_sharing_networks_dispose;
     object_class->finalize = cc_sharing_networks_finalize;
     object_class->constructed = cc_sharing_networks_constructed;
 
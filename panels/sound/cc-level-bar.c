@@ -15,86 +15,118 @@
  * along with this program; if not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <pulse/pulseaudio.h>
+#include <math.h>
 
 #include "cc-level-bar.h"
-#include "gvc-mixer-stream-private.h"
+#include "cc-level-monitor.h"
 
 struct _CcLevelBar {
     GtkWidget parent_instance;
 
     GtkLevelBar *level_bar;
-    pa_stream *level_stream;
+
+    CcLevelMonitorSource source;
+    gboolean has_source;
+    gboolean subscribed;
+    guint tick_id;
+    gint64 last_frame_time;
 };
 
 G_DEFINE_FINAL_TYPE (CcLevelBar, cc_level_bar, GTK_TYPE_WIDGET)
 
 #define SMOOTHING 0.3
+/* Rate at which peaks are sampled, SMOOTHING applies per sample */
+#define SAMPLE_RATE 25
+
+/* Changes smaller than this are not visible and are not redrawn */
+#define LEVEL_EPSILON 0.001
 
 static void
-update_level (CcLevelBar *self, gdouble value)
+update_level (CcLevelBar *self, gdouble value, gdouble n_samples)
 {
     /* Use Exponential Moving Average (EMA) to smooth out value changes and
-     * reduce fluctuation and jitter.
+     * reduce fluctuation and jitter. Frames don't line up with samples, so
+     * the weight is scaled by the number of samples since the last frame.
      */
+    double smoothing = 1.0 - pow (1.0 - SMOOTHING, n_samples);
     double prev_ema = gtk_level_bar_get_value (self->level_bar);
-    double ema = (value * SMOOTHING) + (prev_ema * (1.0 - SMOOTHING));
+    double ema = (value * smoothing) + (prev_ema * (1.0 - smoothing));
 
     ema = CLAMP (ema, 0.0, 1.0);
+    if (value == 0.0 && ema < LEVEL_EPSILON)
+        ema = 0.0;
+
+    if (fabs (ema - prev_ema) < LEVEL_EPSILON && ema != 0.0)
+        return;
 
     gtk_level_bar_set_value (self->level_bar, ema);
 }
 
-static void
-read_cb (pa_stream *stream, size_t length, void *userdata)
+static gboolean
+tick_cb (GtkWidget *widget, GdkFrameClock *frame_clock, gpointer user_data)
 {
-    CcLevelBar *self = userdata;
-    const void *data;
-    gdouble value;
+    CcLevelBar *self = CC_LEVEL_BAR (widget);
+    gint64 frame_time = gdk_frame_clock_get_frame_time (frame_clock);
+    gdouble n_samples = 1.0;
+    gdouble peak;
 
-    if (pa_stream_peek (stream, &data, &length) < 0) {
-        g_warning ("Failed to read data from stream");
-        return;
-    }
+    if (self->last_frame_time != 0)
+        n_samples = MIN ((frame_time - self->last_frame_time) * SAMPLE_RATE / (gdouble) G_USEC_PER_SEC, 1.0);
+    self->last_frame_time = frame_time;
 
-    if (!data) {
-        pa_stream_drop (stream);
-        return;
-    }
+    peak = cc_level_monitor_get_peak (cc_level_monitor_get_default (), &self->source);
+    update_level (self, peak, n_samples);
 
-    assert (length > 0);
-    assert (length % sizeof (float) == 0);
+    return G_SOURCE_CONTINUE;
+}
 
-    value = ((const float *) data)[length / sizeof (float) - 1];
+static void
+start_monitoring (CcLevelBar *self)
+{
+    if (self->subscribed || !self->has_source || !gtk_widget_get_mapped (GTK_WIDGET (self)))
+        return;
 
-    pa_stream_drop (stream);
+    cc_level_monitor_subscribe (cc_level_monitor_get_default (), &self->source);
+    self->subscribed = TRUE;
 
-    update_level (self, value);
+    self->last_frame_time = 0;
+    self->tick_id = gtk_widget_add_tick_callback (GTK_WIDGET (self), tick_cb, NULL, NULL);
 }
 
 static void
-suspended_cb (pa_stream *stream, void *userdata)
+stop_monitoring (CcLevelBar *self)
 {
-    CcLevelBar *self = userdata;
+    if (self->tick_id != 0) {
+        gtk_widget_remove_tick_callback (GTK_WIDGET (self), self->tick_id);
+        self->tick_id = 0;
+    }
 
-    if (pa_stream_is_suspended (stream)) {
-        g_debug ("Stream suspended");
-        gtk_level_bar_set_value (self->level_bar, 0.0);
+    if (self->subscribed) {
+        cc_level_monitor_unsubscribe (cc_level_monitor_get_default (), &self->source);
+        self->subscribed = FALSE;
     }
+
+    gtk_level_bar_set_value (self->level_bar, 0.0);
 }
 
 static void
-close_stream (pa_stream *stream)
+cc_level_bar_map (GtkWidget *widget)
 {
-    if (stream == NULL)
-        return;
+    CcLevelBar *self = CC_LEVEL_BAR (widget);
 
-    /* Stop receiving data */
-    pa_stream_set_read_callback (stream, NULL, NULL);
-    pa_stream_set_suspended_callback (stream, NULL, NULL);
+    GTK_WIDGET_CLASS (cc_level_bar_parent_class)->map (widget);
 
-    /* Disconnect from the stream */
-    pa_stream_disconnect (stream);
+    start_monitoring (self);
+}
+
+static void
+cc_level_bar_unmap (GtkWidget *widget)
+{
+    CcLevelBar *self = CC_LEVEL_BAR (widget);
+
+    stop_monitoring (self);
+
+    GTK_WIDGET_CLASS (cc_level_bar_parent_class)->unmap (widget);
 }
 
 static void
@@ -102,8 +134,7 @@ cc_level_bar_dispose (GObject *object)
 {
     CcLevelBar *self = CC_LEVEL_BAR (object);
 
-    close_stream (self->level_stream);
-    g_clear_pointer (&self->level_stream, pa_stream_unref);
+    stop_monitoring (self);
 
     gtk_widget_unparent (GTK_WIDGET (self->level_bar));
 
@@ -118,6 +149,9 @@ cc_level_bar_class_init (CcLevelBarClass *klass)
 
     object_class->dispose = cc_level_bar_dispose;
 
+    widget_class->map = cc_level_bar_map;
+    widget_class->unmap = cc_level_bar_unmap;
+
     gtk_widget_class_set_layout_manager_type (widget_class, GTK_TYPE_BIN_LAYOUT);
 }
 
@@ -137,58 +171,15 @@ cc_level_bar_init (CcLevelBar *self)
 void
 cc_level_bar_set_stream (CcLevelBar *self, GvcMixerStream *stream, CcStreamType type)
 {
-    pa_context *context;
-    pa_sample_spec sample_spec;
-    pa_proplist *proplist;
-    pa_buffer_attr attr;
-    g_autofree gchar *device = NULL;
-
     g_return_if_fail (CC_IS_LEVEL_BAR (self));
 
-    close_stream (self->level_stream);
-    g_clear_pointer (&self->level_stream, pa_stream_unref);
+    stop_monitoring (self);
 
-    if (stream == NULL) {
-        gtk_level_bar_set_value (self->level_bar, 0.0);
-        return;
-    }
-
-    context = gvc_mixer_stream_get_pa_context (stream);
-
-    if (pa_context_get_server_protocol_version (context) < 13) {
-        g_warning ("Unsupported version of PulseAudio");
-        return;
-    }
-
-    sample_spec.channels = 1;
-    sample_spec.format = PA_SAMPLE_FLOAT32;
-    sample_spec.rate = 25;
-
-    proplist = pa_proplist_new ();
-    pa_proplist_sets (proplist, PA_PROP_APPLICATION_ID, "org.gnome.VolumeControl");
-    self->level_stream = pa_stream_new_with_proplist (context, "Peak detect", &sample_spec, NULL, proplist);
-    pa_proplist_free (proplist);
-    if (self->level_stream == NULL) {
-        g_warning ("Failed to create monitoring stream");
+    self->has_source = stream != NULL;
+    if (stream == NULL)
         return;
-    }
 
-    pa_stream_set_read_callback (self->level_stream, read_cb, self);
-    pa_stream_set_suspended_callback (self->level_stream, suspended_cb, self);
-
-    if (type == CC_STREAM_TYPE_INPUT) {
-        guint sink_idx = gvc_mixer_stream_get_id (stream);
-        pa_stream_set_monitor_stream (self->level_stream, sink_idx);
-    }
-
-    memset (&attr, 0, sizeof (attr));
-    attr.fragsize = sizeof (float);
-    attr.maxlength = (uint32_t) -1;
-    device = g_strdup_printf ("%u", gvc_mixer_stream_get_index (stream));
-    if (pa_stream_connect_record (
-            self->level_stream, device, &attr,
-            (pa_stream_flags_t) (PA_STREAM_DONT_MOVE | PA_STREAM_PEAK_DETECT | PA_STREAM_ADJUST_LATENCY))
-        < 0) {
-        g_warning ("Failed to connect monitoring stream");
-    }
+    /* The stream is only monitored while the bar is visible */
+    cc_level_monitor_source_init (&self->source, stream, type);
+    start_monitoring (self);
 }
@@ -0,0 +1,325 @@
+/*
+ * Copyright (C) 2026 The GNOME Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <pulse/pulseaudio.h>
+
+#include "cc-level-monitor.h"
+#include "gvc-mixer-stream-private.h"
+
+/*
+ * Peak levels are measured with one record stream per monitored
+ * sink, source or sink input, however many level bars show it. The
+ * stream is closed as soon as no mapped bar shows it anymore.
+ */
+
+typedef struct {
+    CcLevelMonitorSource source;
+    guint n_subscribers;
+    gdouble peak;
+    gpointer handle;
+} MonitorEntry;
+
+struct _CcLevelMonitor {
+    GObject parent_instance;
+
+    const CcLevelMonitorBackend *backend;
+
+    /* CcLevelMonitorSource -> MonitorEntry */
+    GHashTable *entries;
+};
+
+G_DEFINE_FINAL_TYPE (CcLevelMonitor, cc_level_monitor, G_TYPE_OBJECT)
+
+static guint
+source_hash (gconstpointer data)
+{
+    const CcLevelMonitorSource *source = data;
+
+    return g_direct_hash (source->context) ^ (source->index * 31 + source->id) ^ source->type;
+}
+
+static gboolean
+source_equal (gconstpointer a, gconstpointer b)
+{
+    const CcLevelMonitorSource *source_a = a;
+    const CcLevelMonitorSource *source_b = b;
+
+    return source_a->context == source_b->context && source_a->type == source_b->type
+           && source_a->index == source_b->index && source_a->id == source_b->id;
+}
+
+/* PulseAudio backend */
+
+typedef struct {
+    CcLevelMonitor *monitor;
+    CcLevelMonitorSource source;
+    pa_stream *stream;
+} PulseHandle;
+
+static void
+pulse_read_cb (pa_stream *stream, size_t length, void *userdata)
+{
+    PulseHandle *handle = userdata;
+    const void *data;
+    gdouble value;
+
+    if (pa_stream_peek (stream, &data, &length) < 0) {
+        g_warning ("Failed to read data from stream");
+        return;
+    }
+
+    if (!data) {
+        pa_stream_drop (stream);
+        return;
+    }
+
+    assert (length > 0);
+    assert (length % sizeof (float) == 0);
+
+    value = ((const float *) data)[length / sizeof (float) - 1];
+
+    pa_stream_drop (stream);
+
+    cc_level_monitor_push_peak (handle->monitor, &handle->source, value);
+}
+
+static void
+pulse_suspended_cb (pa_stream *stream, void *userdata)
+{
+    PulseHandle *handle = userdata;
+
+    if (pa_stream_is_suspended (stream)) {
+        g_debug ("Stream suspended");
+        cc_level_monitor_push_peak (handle->monitor, &handle->source, 0.0);
+    }
+}
+
+static gpointer
+pulse_open (CcLevelMonitor *monitor, const CcLevelMonitorSource *source)
+{
+    pa_context *context = source->context;
+    pa_sample_spec sample_spec;
+    pa_proplist *proplist;
+    pa_buffer_attr attr;
+    g_autofree gchar *device = NULL;
+    PulseHandle *handle;
+
+    if (pa_context_get_server_protocol_version (context) < 13) {
+        g_warning ("Unsupported version of PulseAudio");
+        return NULL;
+    }
+
+    sample_spec.channels = 1;
+    sample_spec.format = PA_SAMPLE_FLOAT32;
+    sample_spec.rate = 25;
+
+    handle = g_new0 (PulseHandle, 1);
+    handle->monitor = monitor;
+    handle->source = *source;
+
+    proplist = pa_proplist_new ();
+    pa_proplist_sets (proplist, PA_PROP_APPLICATION_ID, "org.gnome.VolumeControl");
+    handle->stream = pa_stream_new_with_proplist (context, "Peak detect", &sample_spec, NULL, proplist);
+    pa_proplist_free (proplist);
+    if (handle->stream == NULL) {
+        g_warning ("Failed to create monitoring stream");
+        g_free (handle);
+        return NULL;
+    }
+
+    pa_stream_set_read_callback (handle->stream, pulse_read_cb, handle);
+    pa_stream_set_suspended_callback (handle->stream, pulse_suspended_cb, handle);
+
+    if (source->type == CC_STREAM_TYPE_INPUT)
+        pa_stream_set_monitor_stream (handle->stream, source->id);
+
+    memset (&attr, 0, sizeof (attr));
+    attr.fragsize = sizeof (float);
+    attr.maxlength = (uint32_t) -1;
+    device = g_strdup_printf ("%u", source->index);
+    if (pa_stream_connect_record (
+            handle->stream, device, &attr,
+            (pa_stream_flags_t) (PA_STREAM_DONT_MOVE | PA_STREAM_PEAK_DETECT | PA_STREAM_ADJUST_LATENCY))
+        < 0) {
+        g_warning ("Failed to connect monitoring stream");
+    }
+
+    return handle;
+}
+
+static void
+pulse_close (CcLevelMonitor *monitor, gpointer data)
+{
+    PulseHandle *handle = data;
+
+    /* Stop receiving data */
+    pa_stream_set_read_callback (handle->stream, NULL, NULL);
+    pa_stream_set_suspended_callback (handle->stream, NULL, NULL);
+
+    /* Disconnect from the stream */
+    pa_stream_disconnect (handle->stream);
+    pa_stream_unref (handle->stream);
+    g_free (handle);
+}
+
+static const CcLevelMonitorBackend pulse_backend = {
+    pulse_open,
+    pulse_close,
+};
+
+static void
+cc_level_monitor_finalize (GObject *object)
+{
+    CcLevelMonitor *self = CC_LEVEL_MONITOR (object);
+    GHashTableIter iter;
+    MonitorEntry *entry;
+
+    g_hash_table_iter_init (&iter, self->entries);
+    while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &entry)) {
+        if (entry->handle)
+            self->backend->close (self, entry->handle);
+    }
+    g_clear_pointer (&self->entries, g_hash_table_unref);
+
+    G_OBJECT_CLASS (cc_level_monitor_parent_class)->finalize (object);
+}
+
+static void
+cc_level_monitor_class_init (CcLevelMonitorClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+    object_class->finalize = cc_level_monitor_finalize;
+}
+
+static void
+cc_level_monitor_init (CcLevelMonitor *self)
+{
+    self->entries = g_hash_table_new_full (source_hash, source_equal, NULL, g_free);
+}
+
+/**
+ * cc_level_monitor_get_default:
+ *
+ * Returns: (transfer none): the monitor shared by all level bars
+ */
+CcLevelMonitor *
+cc_level_monitor_get_default (void)
+{
+    static CcLevelMonitor *default_monitor = NULL;
+
+    if (!default_monitor)
+        default_monitor = cc_level_monitor_new (&pulse_backend);
+
+    return default_monitor;
+}
+
+CcLevelMonitor *
+cc_level_monitor_new (const CcLevelMonitorBackend *backend)
+{
+    CcLevelMonitor *self;
+
+    g_return_val_if_fail (backend != NULL, NULL);
+
+    self = g_object_new (CC_TYPE_LEVEL_MONITOR, NULL);
+    self->backend = backend;
+
+    return self;
+}
+
+void
+cc_level_monitor_source_init (CcLevelMonitorSource *source, GvcMixerStream *stream, CcStreamType type)
+{
+    g_return_if_fail (GVC_IS_MIXER_STREAM (stream));
+
+    source->context = gvc_mixer_stream_get_pa_context (stream);
+    source->type = type;
+    source->index = gvc_mixer_stream_get_index (stream);
+    source->id = gvc_mixer_stream_get_id (stream);
+}
+
+void
+cc_level_monitor_subscribe (CcLevelMonitor *self, const CcLevelMonitorSource *source)
+{
+    MonitorEntry *entry;
+
+    g_return_if_fail (CC_IS_LEVEL_MONITOR (self));
+    g_return_if_fail (source != NULL);
+
+    entry = g_hash_table_lookup (self->entries, source);
+    if (!entry) {
+        entry = g_new0 (MonitorEntry, 1);
+        entry->source = *source;
+        g_hash_table_insert (self->entries, &entry->source, entry);
+
+        entry->handle = self->backend->open (self, source);
+    }
+
+    entry->n_subscribers++;
+}
+
+void
+cc_level_monitor_unsubscribe (CcLevelMonitor *self, const CcLevelMonitorSource *source)
+{
+    MonitorEntry *entry;
+
+    g_return_if_fail (CC_IS_LEVEL_MONITOR (self));
+    g_return_if_fail (source != NULL);
+
+    entry = g_hash_table_lookup (self->entries, source);
+    g_return_if_fail (entry != NULL);
+
+    if (--entry->n_subscribers > 0)
+        return;
+
+    if (entry->handle)
+        self->backend->close (self, entry->handle);
+    g_hash_table_remove (self->entries, source);
+}
+
+/* Returns the last peak measured from @source, between 0.0 and 1.0 */
+gdouble
+cc_level_monitor_get_peak (CcLevelMonitor *self, const CcLevelMonitorSource *source)
+{
+    MonitorEntry *entry;
+
+    g_return_val_if_fail (CC_IS_LEVEL_MONITOR (self), 0.0);
+
+    entry = g_hash_table_lookup (self->entries, source);
+
+    return entry ? entry->peak : 0.0;
+}
+
+guint
+cc_level_monitor_get_n_sources (CcLevelMonitor *self)
+{
+    g_return_val_if_fail (CC_IS_LEVEL_MONITOR (self), 0);
+
+    return g_hash_table_size (self->entries);
+}
+
+void
+cc_level_monitor_push_peak (CcLevelMonitor *self, const CcLevelMonitorSource *source, gdouble peak)
+{
+    MonitorEntry *entry;
+
+    g_return_if_fail (CC_IS_LEVEL_MONITOR (self));
+
+    entry = g_hash_table_lookup (self->entries, source);
+    if (entry)
+        entry->peak = CLAMP (peak, 0.0, 1.0);
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2026 The GNOME Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "cc-sound-enums.h"
+
+#include <glib-object.h>
+#include <gvc-mixer-stream.h>
+
+G_BEGIN_DECLS
+
+/* Identifies the stream a peak level is measured from */
+typedef struct {
+    gpointer context; /* pa_context */
+    CcStreamType type;
+    guint index;
+    guint id;
+} CcLevelMonitorSource;
+
+#define CC_TYPE_LEVEL_MONITOR (cc_level_monitor_get_type ())
+G_DECLARE_FINAL_TYPE (CcLevelMonitor, cc_level_monitor, CC, LEVEL_MONITOR, GObject);
+
+typedef struct {
+    /* Starts measuring @source, reporting through cc_level_monitor_push_peak() */
+    gpointer (*open) (CcLevelMonitor *monitor, const CcLevelMonitorSource *source);
+    /* Stops measuring, with the value returned by open() */
+    void (*close) (CcLevelMonitor *monitor, gpointer handle);
+} CcLevelMonitorBackend;
+
+CcLevelMonitor *cc_level_monitor_get_default (void);
+CcLevelMonitor *cc_level_monitor_new (const CcLevelMonitorBackend *backend);
+void cc_level_monitor_source_init (CcLevelMonitorSource *source, GvcMixerStream *stream, CcStreamType type);
+void cc_level_monitor_subscribe (CcLevelMonitor *self, const CcLevelMonitorSource *source);
+void cc_level_monitor_unsubscribe (CcLevelMonitor *self, const CcLevelMonitorSource *source);
+gdouble cc_level_monitor_get_peak (CcLevelMonitor *self, const CcLevelMonitorSource *source);
+guint cc_level_monitor_get_n_sources (CcLevelMonitor *self);
+void cc_level_monitor_push_peak (CcLevelMonitor *self, const CcLevelMonitorSource *source, gdouble peak);
+
+G_END_DECLS
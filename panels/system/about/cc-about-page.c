@@ -23,6 +23,7 @@
 #include <config.h>
 
 #include "cc-about-page.h"
+#include "cc-about-probes.h"
 #include "cc-hostname-entry.h"
 #include "cc-hostname.h"
 #include "info-cleanup.h"
@@ -49,6 +50,18 @@
 
 #include <locale.h>
 
+typedef enum {
+    PROBE_HARDWARE_MODEL,
+    PROBE_FIRMWARE_VERSION,
+    PROBE_MEMORY,
+    PROBE_PROCESSOR,
+    PROBE_GRAPHICS,
+    PROBE_DISK,
+    PROBE_KERNEL,
+    PROBE_VIRTUALIZATION,
+    N_PROBES
+} AboutProbe;
+
 struct _CcAboutPage {
     AdwNavigationPage parent_instance;
 
@@ -74,10 +87,18 @@ struct _CcAboutPage {
 
     /* Cached version string */
     char *gnome_version_str;
+
+    GCancellable *cancellable;
+    GVariant *probe_values[N_PROBES];
+    gboolean is_virtualized;
 };
 
 G_DEFINE_FINAL_TYPE (CcAboutPage, cc_about_page, ADW_TYPE_NAVIGATION_PAGE)
 
+/* libgtop keeps global state that isn't thread-safe, and the memory and
+ * processor probes run in different threads */
+static GMutex libgtop_lock;
+
 #if !defined(DISTRIBUTOR_LOGO) || defined(DARK_MODE_DISTRIBUTOR_LOGO)
 static gboolean
 use_dark_theme (CcAboutPage *self)
@@ -333,7 +354,7 @@ get_graphics_hardware_list (void)
         if (!renderer)
             renderer = get_renderer_from_helper (NULL);
         if (!renderer)
-            renderer = g_strdup (_("Unknown"));
+            return NULL;
 
         gpu_data = g_new0 (GpuData, 1);
         gpu_data->name = g_strdup (renderer);
@@ -345,29 +366,43 @@ get_graphics_hardware_list (void)
 }
 
 static void
-create_graphics_rows (CcAboutPage *self, GSList *devices)
+add_graphics_row (CcAboutPage *self, const char *label, const char *name)
+{
+    GtkWidget *gpu_entry;
+
+    gpu_entry = adw_action_row_new ();
+    adw_preferences_row_set_title (ADW_PREFERENCES_ROW (gpu_entry), label);
+    adw_action_row_set_subtitle (ADW_ACTION_ROW (gpu_entry), name);
+    adw_action_row_set_subtitle_selectable (ADW_ACTION_ROW (gpu_entry), TRUE);
+    gtk_widget_add_css_class (gpu_entry, "property");
+
+    adw_preferences_group_add (self->hardware_group, gpu_entry);
+}
+
+/* @devices is an array of (name, is_default), default GPU first */
+static void
+create_graphics_rows (CcAboutPage *self, GVariant *devices)
 {
-    GSList *l;
+    GVariantIter iter;
+    const char *name;
+    gboolean is_default;
     guint i = 0;
 
-    for (l = devices; l != NULL; l = l->next) {
-        GpuData *data = l->data;
-        const char *name = data->name;
+    if (devices == NULL || g_variant_n_children (devices) == 0) {
+        add_graphics_row (self, _("Graphics"), _("Unknown"));
+        return;
+    }
+
+    g_variant_iter_init (&iter, devices);
+    while (g_variant_iter_next (&iter, "(&sb)", &name, &is_default)) {
         g_autofree char *label = NULL;
-        GtkWidget *gpu_entry;
 
-        if (data->is_default)
+        if (is_default)
             label = g_strdup (_("Graphics"));
         else
             label = g_strdup_printf (_("Graphics %d"), ++i);
 
-        gpu_entry = adw_action_row_new ();
-        adw_preferences_row_set_title (ADW_PREFERENCES_ROW (gpu_entry), label);
-        adw_action_row_set_subtitle (ADW_ACTION_ROW (gpu_entry), name);
-        adw_action_row_set_subtitle_selectable (ADW_ACTION_ROW (gpu_entry), TRUE);
-        gtk_widget_add_css_class (gpu_entry, "property");
-
-        adw_preferences_group_add (self->hardware_group, gpu_entry);
+        add_graphics_row (self, label, name);
     }
 }
 
@@ -532,6 +567,7 @@ get_cpu_info ()
 {
     g_autoptr(GHashTable) counts = NULL;
     g_autoptr(GString) cpu = NULL;
+    g_autoptr(GMutexLocker) locker = NULL;
     const glibtop_sysinfo *info;
     GHashTableIter iter;
     gpointer key, value;
@@ -539,6 +575,7 @@ get_cpu_info ()
     int j;
 
     counts = g_hash_table_new (g_str_hash, g_str_equal);
+    locker = g_mutex_locker_new (&libgtop_lock);
     info = glibtop_get_sysinfo ();
 
     /* count duplicates */
@@ -610,6 +647,7 @@ set_virtualization_label (CcAboutPage *self, const char *virt)
         return;
     }
 
+    self->is_virtualized = TRUE;
     gtk_widget_set_visible (GTK_WIDGET (self->firmware_version_row), FALSE);
 
     gtk_widget_set_visible (GTK_WIDGET (self->virtualization_row), TRUE);
@@ -625,41 +663,40 @@ set_virtualization_label (CcAboutPage *self, const char *virt)
     adw_action_row_set_subtitle (self->virtualization_row, display_name ? display_name : virt);
 }
 
-static void
-cc_about_page_setup_virt (CcAboutPage *self)
+static char *
+get_virtualization (void)
 {
     g_autoptr(GError) error = NULL;
-    g_autoptr(GDBusProxy) systemd_proxy = NULL;
+    g_autoptr(GDBusConnection) bus = NULL;
     g_autoptr(GVariant) variant = NULL;
-    GVariant *inner;
+    g_autoptr(GVariant) inner = NULL;
 
-    systemd_proxy =
-        g_dbus_proxy_new_for_bus_sync (G_BUS_TYPE_SYSTEM, G_DBUS_PROXY_FLAGS_NONE, NULL, "org.freedesktop.systemd1",
-                                       "/org/freedesktop/systemd1", "org.freedesktop.systemd1", NULL, &error);
-
-    if (systemd_proxy == NULL) {
+    bus = g_bus_get_sync (G_BUS_TYPE_SYSTEM, NULL, &error);
+    if (bus == NULL) {
         g_debug ("systemd not available, bailing: %s", error->message);
-        set_virtualization_label (self, NULL);
-        return;
+        return NULL;
     }
 
-    variant = g_dbus_proxy_call_sync (systemd_proxy, "org.freedesktop.DBus.Properties.Get",
-                                      g_variant_new ("(ss)", "org.freedesktop.systemd1.Manager", "Virtualization"),
-                                      G_DBUS_CALL_FLAGS_NONE, -1, NULL, &error);
+    variant = g_dbus_connection_call_sync (
+        bus, "org.freedesktop.systemd1", "/org/freedesktop/systemd1", "org.freedesktop.DBus.Properties", "Get",
+        g_variant_new ("(ss)", "org.freedesktop.systemd1.Manager", "Virtualization"), G_VARIANT_TYPE ("(v)"),
+        G_DBUS_CALL_FLAGS_NONE, -1, NULL, &error);
     if (variant == NULL) {
         g_debug ("Failed to get property '%s': %s", "Virtualization", error->message);
-        set_virtualization_label (self, NULL);
-        return;
+        return NULL;
     }
 
     g_variant_get (variant, "(v)", &inner);
-    set_virtualization_label (self, g_variant_get_string (inner, NULL));
+    if (!g_variant_is_of_type (inner, G_VARIANT_TYPE_STRING))
+        return NULL;
+
+    return g_variant_dup_string (inner, NULL);
 }
 
 static void
 get_gnome_shell_version_cb (GObject *source, GAsyncResult *res, gpointer user_data)
 {
-    CcAboutPage *self = CC_ABOUT_PAGE (user_data);
+    CcAboutPage *self = user_data;
     g_autoptr(GDBusProxy) proxy = NULL;
     g_autoptr(GVariant) variant = NULL;
     g_autoptr(GError) error = NULL;
@@ -689,12 +726,13 @@ static void
 get_gnome_version_string (CcAboutPage *self)
 {
     g_dbus_proxy_new_for_bus (G_BUS_TYPE_SESSION, G_DBUS_PROXY_FLAGS_NONE, NULL, "org.gnome.Shell", "/org/gnome/Shell",
-                              "org.gnome.Shell", NULL, get_gnome_shell_version_cb, self);
+                              "org.gnome.Shell", self->cancellable, get_gnome_shell_version_cb, self);
 }
 
 guint64
 get_ram_size_libgtop (void)
 {
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&libgtop_lock);
     glibtop_mem mem;
 
     glibtop_get_mem (&mem);
@@ -743,6 +781,25 @@ system_details_window_title_print_padding (const gchar *title, GString *dst_stri
         g_string_append (dst_string, " ");
 }
 
+static const char *
+get_probe_string (CcAboutPage *self, AboutProbe probe)
+{
+    GVariant *value = self->probe_values[probe];
+
+    return value ? g_variant_get_string (value, NULL) : NULL;
+}
+
+static char *
+get_memory_text (CcAboutPage *self)
+{
+    GVariant *value = self->probe_values[PROBE_MEMORY];
+
+    if (value == NULL)
+        return NULL;
+
+    return g_format_size_full (g_variant_get_uint64 (value), G_FORMAT_SIZE_IEC_UNITS);
+}
+
 static void
 on_copy_row_activated_cb (GtkWidget *widget, CcAboutPage *self)
 {
@@ -750,18 +807,14 @@ on_copy_row_activated_cb (GtkWidget *widget, CcAboutPage *self)
     GdkDisplay *display;
     g_autofree gchar *date_string = NULL;
     g_autoptr(GDateTime) date = NULL;
-    guint64 ram_size;
     g_autofree char *memory_text = NULL;
-    g_autofree char *cpu_text = NULL;
     g_autofree char *os_type_text = NULL;
     g_autofree char *os_name_text = NULL;
     g_autofree char *os_build_text = NULL;
-    g_autofree char *hardware_model_text = NULL;
-    g_autofree char *firmware_version_text = NULL;
-    g_autofree char *kernel_version_text = NULL;
-    g_autoslist (GpuData) graphics_hardware_list = NULL;
-    GSList *l;
-    g_autofree gchar *disk_capacity_string = NULL;
+    GVariant *graphics_hardware_list;
+    GVariantIter iter;
+    const char *name;
+    gboolean is_default;
     g_autoptr(GString) result_str;
     locale_t untranslated_locale;
 
@@ -787,43 +840,42 @@ on_copy_row_activated_cb (GtkWidget *widget, CcAboutPage *self)
 
     g_string_append (result_str, "- ");
     system_details_window_title_print_padding ("**Hardware Model:**", result_str, 0);
-    hardware_model_text = get_hardware_model_string ();
-    g_string_append_printf (result_str, "%s\n", hardware_model_text);
+    g_string_append_printf (result_str, "%s\n", get_probe_string (self, PROBE_HARDWARE_MODEL));
 
     g_string_append (result_str, "- ");
     system_details_window_title_print_padding ("**Memory:**", result_str, 0);
-    ram_size = get_ram_size_dmi ();
-    if (ram_size == 0)
-        ram_size = get_ram_size_libgtop ();
-    memory_text = g_format_size_full (ram_size, G_FORMAT_SIZE_IEC_UNITS);
+    memory_text = get_memory_text (self);
     g_string_append_printf (result_str, "%s\n", memory_text);
 
     g_string_append (result_str, "- ");
     system_details_window_title_print_padding ("**Processor:**", result_str, 0);
-    cpu_text = get_cpu_info ();
-    g_string_append_printf (result_str, "%s\n", cpu_text);
+    g_string_append_printf (result_str, "%s\n", get_probe_string (self, PROBE_PROCESSOR));
 
-    graphics_hardware_list = get_graphics_hardware_list ();
+    graphics_hardware_list = self->probe_values[PROBE_GRAPHICS];
     guint i = 0;
 
-    for (l = graphics_hardware_list; l != NULL; l = l->next) {
-        GpuData *data = l->data;
-        const char *name = data->name;
-        g_autofree char *label = NULL;
-
-        if (data->is_default)
-            label = g_strdup ("**Graphics:**");
-        else
-            label = g_strdup_printf ("**Graphics %d:**", ++i);
+    if (graphics_hardware_list == NULL || g_variant_n_children (graphics_hardware_list) == 0) {
         g_string_append (result_str, "- ");
-        system_details_window_title_print_padding (label, result_str, 0);
-        g_string_append_printf (result_str, "%s\n", name);
+        system_details_window_title_print_padding ("**Graphics:**", result_str, 0);
+        g_string_append (result_str, "Unknown\n");
+    } else {
+        g_variant_iter_init (&iter, graphics_hardware_list);
+        while (g_variant_iter_next (&iter, "(&sb)", &name, &is_default)) {
+            g_autofree char *label = NULL;
+
+            if (is_default)
+                label = g_strdup ("**Graphics:**");
+            else
+                label = g_strdup_printf ("**Graphics %d:**", ++i);
+            g_string_append (result_str, "- ");
+            system_details_window_title_print_padding (label, result_str, 0);
+            g_string_append_printf (result_str, "%s\n", name);
+        }
     }
 
     g_string_append (result_str, "- ");
     system_details_window_title_print_padding ("**Disk Capacity:**", result_str, 0);
-    disk_capacity_string = get_primary_disk_info ();
-    g_string_append_printf (result_str, "%s\n", disk_capacity_string);
+    g_string_append_printf (result_str, "%s\n", get_probe_string (self, PROBE_DISK));
 
     g_string_append (result_str, "\n");
 
@@ -831,8 +883,7 @@ on_copy_row_activated_cb (GtkWidget *widget, CcAboutPage *self)
 
     g_string_append (result_str, "- ");
     system_details_window_title_print_padding ("**Firmware Version:**", result_str, 0);
-    firmware_version_text = get_firmware_version_string ();
-    g_string_append_printf (result_str, "%s\n", firmware_version_text);
+    g_string_append_printf (result_str, "%s\n", get_probe_string (self, PROBE_FIRMWARE_VERSION));
 
     g_string_append (result_str, "- ");
     system_details_window_title_print_padding ("**OS Name:**", result_str, 0);
@@ -857,8 +908,7 @@ on_copy_row_activated_cb (GtkWidget *widget, CcAboutPage *self)
 
     g_string_append (result_str, "- ");
     system_details_window_title_print_padding ("**Kernel Version:**", result_str, 0);
-    kernel_version_text = get_kernel_version_string ();
-    g_string_append_printf (result_str, "%s\n", kernel_version_text);
+    g_string_append_printf (result_str, "%s\n", get_probe_string (self, PROBE_KERNEL));
 
     display = gdk_display_get_default ();
     clip_board = gdk_display_get_clipboard (display);
@@ -871,45 +921,160 @@ on_copy_row_activated_cb (GtkWidget *widget, CcAboutPage *self)
     adw_toast_overlay_add_toast (self->toast_overlay, adw_toast_new (_("Details copied to clipboard")));
 }
 
-static void
-cc_about_page_setup_overview (CcAboutPage *self)
+static GVariant *
+take_string_variant (char *str)
 {
-    guint64 ram_size;
-    g_autofree char *memory_text = NULL;
-    g_autofree char *cpu_text = NULL;
-    g_autofree char *os_type_text = NULL;
-    g_autofree char *os_name_text = NULL;
-    g_autofree char *os_build_text = NULL;
-    g_autofree char *hardware_model_text = NULL;
-    g_autofree char *firmware_version_text = NULL;
-    g_autofree char *kernel_version_text = NULL;
-    g_autoslist (GpuData) graphics_hardware_list = NULL;
-    g_autofree gchar *disk_capacity_string = NULL;
+    if (str == NULL)
+        return NULL;
+
+    return g_variant_new_take_string (str);
+}
 
-    hardware_model_text = get_hardware_model_string ();
-    adw_action_row_set_subtitle (self->hardware_model_row, hardware_model_text);
-    gtk_widget_set_visible (GTK_WIDGET (self->hardware_model_row), hardware_model_text != NULL);
+static GVariant *
+probe_hardware_model (void)
+{
+    return take_string_variant (get_hardware_model_string ());
+}
+
+static GVariant *
+probe_firmware_version (void)
+{
+    return take_string_variant (get_firmware_version_string ());
+}
 
-    firmware_version_text = get_firmware_version_string ();
-    adw_action_row_set_subtitle (self->firmware_version_row, firmware_version_text);
-    gtk_widget_set_visible (GTK_WIDGET (self->firmware_version_row), firmware_version_text != NULL);
+static GVariant *
+probe_memory (void)
+{
+    guint64 ram_size;
 
     ram_size = get_ram_size_dmi ();
     if (ram_size == 0)
         ram_size = get_ram_size_libgtop ();
-    memory_text = g_format_size_full (ram_size, G_FORMAT_SIZE_IEC_UNITS);
-    adw_action_row_set_subtitle (self->memory_row, memory_text);
 
-    cpu_text = get_cpu_info ();
-    adw_action_row_set_subtitle (self->processor_row, cpu_text);
+    return g_variant_new_uint64 (ram_size);
+}
+
+static GVariant *
+probe_processor (void)
+{
+    return take_string_variant (get_cpu_info ());
+}
+
+static GVariant *
+probe_graphics (void)
+{
+    g_autoslist (GpuData) graphics_hardware_list = NULL;
+    GVariantBuilder builder;
 
     graphics_hardware_list = get_graphics_hardware_list ();
-    create_graphics_rows (self, graphics_hardware_list);
 
-    disk_capacity_string = get_primary_disk_info ();
-    if (disk_capacity_string == NULL)
-        disk_capacity_string = g_strdup (_("Unknown"));
-    adw_action_row_set_subtitle (self->disk_row, disk_capacity_string);
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(sb)"));
+    for (GSList *l = graphics_hardware_list; l != NULL; l = l->next) {
+        GpuData *data = l->data;
+
+        g_variant_builder_add (&builder, "(sb)", data->name, data->is_default);
+    }
+
+    return g_variant_builder_end (&builder);
+}
+
+static GVariant *
+probe_disk (void)
+{
+    return take_string_variant (get_primary_disk_info ());
+}
+
+static GVariant *
+probe_kernel (void)
+{
+    return take_string_variant (get_kernel_version_string ());
+}
+
+static GVariant *
+probe_virtualization (void)
+{
+    return take_string_variant (get_virtualization ());
+}
+
+/* Hardware facts don't change until the next boot and are cached */
+static const CcAboutProbe about_probes[N_PROBES] = {
+    [PROBE_HARDWARE_MODEL] = { "hardware-model", "s", probe_hardware_model, FALSE },
+    [PROBE_FIRMWARE_VERSION] = { "firmware-version", "s", probe_firmware_version, FALSE },
+    [PROBE_MEMORY] = { "memory", "t", probe_memory, TRUE },
+    [PROBE_PROCESSOR] = { "processor", "s", probe_processor, TRUE },
+    [PROBE_GRAPHICS] = { "graphics", "a(sb)", probe_graphics, TRUE },
+    [PROBE_DISK] = { "disk", "s", probe_disk, TRUE },
+    [PROBE_KERNEL] = { "kernel", "s", probe_kernel, FALSE },
+    [PROBE_VIRTUALIZATION] = { "virtualization", "s", probe_virtualization, FALSE },
+};
+
+static void
+set_optional_row (AdwActionRow *row, const char *text)
+{
+    adw_action_row_set_subtitle (row, text);
+    gtk_widget_set_visible (GTK_WIDGET (row), text != NULL);
+}
+
+static void
+probe_result_cb (guint probe, GVariant *value, gpointer user_data)
+{
+    CcAboutPage *self = CC_ABOUT_PAGE (user_data);
+    g_autofree char *memory_text = NULL;
+    const char *text;
+
+    g_clear_pointer (&self->probe_values[probe], g_variant_unref);
+    self->probe_values[probe] = value ? g_variant_ref (value) : NULL;
+
+    text = value && g_variant_is_of_type (value, G_VARIANT_TYPE_STRING) ? g_variant_get_string (value, NULL) : NULL;
+
+    switch ((AboutProbe) probe) {
+    case PROBE_HARDWARE_MODEL:
+        set_optional_row (self->hardware_model_row, text);
+        break;
+
+    case PROBE_FIRMWARE_VERSION:
+        /* The firmware of a virtual machine isn't interesting */
+        set_optional_row (self->firmware_version_row, self->is_virtualized ? NULL : text);
+        break;
+
+    case PROBE_MEMORY:
+        memory_text = get_memory_text (self);
+        adw_action_row_set_subtitle (self->memory_row, memory_text);
+        break;
+
+    case PROBE_PROCESSOR:
+        adw_action_row_set_subtitle (self->processor_row, text);
+        break;
+
+    case PROBE_GRAPHICS:
+        create_graphics_rows (self, value);
+        break;
+
+    case PROBE_DISK:
+        adw_action_row_set_subtitle (self->disk_row, text ? text : _("Unknown"));
+        break;
+
+    case PROBE_KERNEL:
+        set_optional_row (self->kernel_row, text);
+        break;
+
+    case PROBE_VIRTUALIZATION:
+        set_virtualization_label (self, text);
+        break;
+
+    default:
+        g_assert_not_reached ();
+    }
+}
+
+static void
+cc_about_page_setup_overview (CcAboutPage *self)
+{
+    g_autofree char *os_type_text = NULL;
+    g_autofree char *os_name_text = NULL;
+    g_autofree char *os_build_text = NULL;
+    g_autofree char *boot_id = NULL;
+    g_autofree char *cache_file = NULL;
 
     os_name_text = get_os_name ();
     adw_action_row_set_subtitle (self->os_name_row, os_name_text);
@@ -923,9 +1088,20 @@ cc_about_page_setup_overview (CcAboutPage *self)
 
     get_gnome_version_string (self);
 
-    kernel_version_text = get_kernel_version_string ();
-    adw_action_row_set_subtitle (self->kernel_row, kernel_version_text);
-    gtk_widget_set_visible (GTK_WIDGET (self->kernel_row), kernel_version_text != NULL);
+    /* Optional rows are shown once their probe has returned something */
+    gtk_widget_set_visible (GTK_WIDGET (self->hardware_model_row), FALSE);
+    gtk_widget_set_visible (GTK_WIDGET (self->firmware_version_row), FALSE);
+    gtk_widget_set_visible (GTK_WIDGET (self->kernel_row), FALSE);
+    gtk_widget_set_visible (GTK_WIDGET (self->virtualization_row), FALSE);
+
+    /* The hostnamed proxy is shared by the probe threads, make sure it's
+     * created here rather than racing in one of them.
+     */
+    cc_hostname_get_default ();
+
+    boot_id = cc_about_probes_get_boot_id ();
+    cache_file = cc_about_probes_get_cache_file ();
+    cc_about_probes_run (about_probes, N_PROBES, cache_file, boot_id, self->cancellable, probe_result_cb, self);
 }
 
 static void
@@ -933,6 +1109,10 @@ cc_about_page_finalize (GObject *object)
 {
     CcAboutPage *self = CC_ABOUT_PAGE (object);
 
+    g_cancellable_cancel (self->cancellable);
+    g_clear_object (&self->cancellable);
+    for (guint i = 0; i < N_PROBES; i++)
+        g_clear_pointer (&self->probe_values[i], g_variant_unref);
     g_clear_pointer (&self->gnome_version_str, g_free);
 
     G_OBJECT_CLASS (cc_about_page_parent_class)->finalize (object);
@@ -978,8 +1158,8 @@ cc_about_page_init (CcAboutPage *self)
 
     gtk_widget_init_template (GTK_WIDGET (self));
 
+    self->cancellable = g_cancellable_new ();
     cc_about_page_setup_overview (self);
-    cc_about_page_setup_virt (self);
 
     style_manager = adw_style_manager_get_default ();
     g_signal_connect_object (style_manager, "notify::dark", G_CALLBACK (setup_os_logo), self, G_CONNECT_SWAPPED);
@@ -0,0 +1,239 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*-
+ *
+ * Copyright (C) 2026 The GNOME Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cc-about-probes.h"
+
+/*
+ * Every probe runs in its own worker thread and reports back in the main
+ * context as soon as it's done. Results of cacheable probes are written
+ * to disk along with the boot ID, so that they can be reported right away
+ * until the next reboot.
+ */
+
+#define CACHE_VERSION 1
+#define CACHE_TYPE "(qsa{sv})"
+
+typedef struct {
+    const CcAboutProbe *probes;
+    guint n_probes;
+    char *cache_file;
+    char *boot_id;
+    GCancellable *cancellable;
+    CcAboutProbeResultFunc callback;
+    gpointer user_data;
+
+    GVariantDict *cache;
+    gboolean cache_changed;
+    guint n_pending;
+} RunData;
+
+static void
+run_data_free (RunData *data)
+{
+    g_clear_pointer (&data->cache_file, g_free);
+    g_clear_pointer (&data->boot_id, g_free);
+    g_clear_object (&data->cancellable);
+    g_clear_pointer (&data->cache, g_variant_dict_unref);
+    g_free (data);
+}
+
+static GVariant *
+load_cache (const char *cache_file, const char *boot_id)
+{
+    g_autoptr(GError) error = NULL;
+    g_autoptr(GVariant) variant = NULL;
+    g_autoptr(GVariant) values = NULL;
+    const char *cached_boot_id;
+    char *contents;
+    gsize length;
+    guint16 version;
+
+    if (!g_file_get_contents (cache_file, &contents, &length, &error)) {
+        if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+            g_debug ("Failed to read '%s': %s", cache_file, error->message);
+        return NULL;
+    }
+
+    variant = g_variant_ref_sink (g_variant_new_from_data (G_VARIANT_TYPE (CACHE_TYPE), contents, length, FALSE,
+                                                           g_free, contents));
+
+    g_variant_get (variant, "(q&s@a{sv})", &version, &cached_boot_id, &values);
+    if (version != CACHE_VERSION || g_strcmp0 (cached_boot_id, boot_id) != 0) {
+        g_debug ("Ignoring system details cached during a previous boot");
+        return NULL;
+    }
+
+    return g_steal_pointer (&values);
+}
+
+static void
+save_cache (RunData *data)
+{
+    g_autoptr(GError) error = NULL;
+    g_autoptr(GVariant) variant = NULL;
+    g_autofree char *dir = NULL;
+
+    variant = g_variant_ref_sink (
+        g_variant_new ("(qs@a{sv})", CACHE_VERSION, data->boot_id, g_variant_dict_end (data->cache)));
+
+    dir = g_path_get_dirname (data->cache_file);
+    if (g_mkdir_with_parents (dir, 0700) < 0) {
+        g_warning ("Failed to create directory %s", dir);
+        return;
+    }
+
+    if (!g_file_set_contents_full (data->cache_file, g_variant_get_data (variant), g_variant_get_size (variant),
+                                   G_FILE_SET_CONTENTS_CONSISTENT, 0600, &error))
+        g_warning ("Failed to save system details: %s", error->message);
+}
+
+static void
+probe_finished (RunData *data)
+{
+    if (--data->n_pending > 0)
+        return;
+
+    if (data->cache_changed && data->cache_file != NULL && data->boot_id != NULL
+        && !g_cancellable_is_cancelled (data->cancellable))
+        save_cache (data);
+
+    run_data_free (data);
+}
+
+static void
+probe_thread (GTask *task, gpointer source_object, gpointer task_data, GCancellable *cancellable)
+{
+    const CcAboutProbe *probe = task_data;
+    GVariant *value;
+
+    value = probe->func ();
+    if (value != NULL && !g_variant_is_of_type (value, G_VARIANT_TYPE (probe->type))) {
+        g_warning ("Probe '%s' returned a value of type '%s' instead of '%s'", probe->name,
+                   g_variant_get_type_string (value), probe->type);
+        g_clear_pointer (&value, g_variant_unref);
+    }
+
+    g_task_return_pointer (task, value ? g_variant_ref_sink (value) : NULL, (GDestroyNotify) g_variant_unref);
+}
+
+static void
+probe_done_cb (GObject *source, GAsyncResult *result, gpointer user_data)
+{
+    RunData *data = user_data;
+    const CcAboutProbe *probe = g_task_get_task_data (G_TASK (result));
+    g_autoptr(GVariant) value = NULL;
+    g_autoptr(GError) error = NULL;
+
+    value = g_task_propagate_pointer (G_TASK (result), &error);
+    if (error != NULL) {
+        /* Cancelled, the caller is gone */
+        probe_finished (data);
+        return;
+    }
+
+    if (probe->cacheable && value != NULL) {
+        g_variant_dict_insert_value (data->cache, probe->name, value);
+        data->cache_changed = TRUE;
+    }
+
+    data->callback (probe - data->probes, value, data->user_data);
+
+    probe_finished (data);
+}
+
+char *
+cc_about_probes_get_boot_id (void)
+{
+    g_autoptr(GError) error = NULL;
+    g_autofree char *boot_id = NULL;
+
+    if (!g_file_get_contents ("/proc/sys/kernel/random/boot_id", &boot_id, NULL, &error)) {
+        g_debug ("Failed to get the boot ID: %s", error->message);
+        return NULL;
+    }
+
+    return g_strstrip (g_steal_pointer (&boot_id));
+}
+
+char *
+cc_about_probes_get_cache_file (void)
+{
+    return g_build_filename (g_get_user_cache_dir (), "gnome-control-center", "system-details", NULL);
+}
+
+/*
+ * Runs @probes in parallel and calls @callback in the current main context
+ * with the result of each of them. Results found in @cache_file are reported
+ * before returning, the others as soon as they are available. @callback isn't
+ * called anymore once @cancellable is cancelled.
+ *
+ * @probes must stay valid until all probes are finished. Results are only
+ * cached if both @cache_file and @boot_id are set.
+ */
+void
+cc_about_probes_run (const CcAboutProbe *probes, guint n_probes, const char *cache_file, const char *boot_id,
+                     GCancellable *cancellable, CcAboutProbeResultFunc callback, gpointer user_data)
+{
+    g_autoptr(GVariant) cached = NULL;
+    RunData *data;
+
+    g_return_if_fail (probes != NULL || n_probes == 0);
+    g_return_if_fail (callback != NULL);
+
+    data = g_new0 (RunData, 1);
+    data->probes = probes;
+    data->n_probes = n_probes;
+    data->cache_file = g_strdup (cache_file);
+    data->boot_id = g_strdup (boot_id);
+    data->cancellable = cancellable ? g_object_ref (cancellable) : g_cancellable_new ();
+    data->callback = callback;
+    data->user_data = user_data;
+    data->cache = g_variant_dict_new (NULL);
+
+    if (cache_file != NULL && boot_id != NULL)
+        cached = load_cache (cache_file, boot_id);
+
+    /* Hold a reference until every probe is started */
+    data->n_pending = 1;
+
+    for (guint i = 0; i < n_probes; i++) {
+        const CcAboutProbe *probe = &probes[i];
+        g_autoptr(GTask) task = NULL;
+
+        if (probe->cacheable && cached != NULL) {
+            g_autoptr(GVariant) value = NULL;
+
+            value = g_variant_lookup_value (cached, probe->name, G_VARIANT_TYPE (probe->type));
+            if (value != NULL) {
+                g_variant_dict_insert_value (data->cache, probe->name, value);
+                callback (i, value, user_data);
+                continue;
+            }
+        }
+
+        task = g_task_new (NULL, data->cancellable, probe_done_cb, data);
+        g_task_set_source_tag (task, cc_about_probes_run);
+        g_task_set_task_data (task, (gpointer) probe, NULL);
+
+        data->n_pending++;
+        g_task_run_in_thread (task, probe_thread);
+    }
+
+    probe_finished (data);
+}
@@ -0,0 +1,44 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*-
+ *
+ * Copyright (C) 2026 The GNOME Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+/* Called in a worker thread, returns NULL if the information is not available */
+typedef GVariant *(*CcAboutProbeFunc) (void);
+
+typedef struct {
+    const char *name;
+    const char *type;
+    CcAboutProbeFunc func;
+    /* Whether the result stays valid until the next boot */
+    gboolean cacheable;
+} CcAboutProbe;
+
+typedef void (*CcAboutProbeResultFunc) (guint probe, GVariant *value, gpointer user_data);
+
+char *cc_about_probes_get_boot_id (void);
+char *cc_about_probes_get_cache_file (void);
+void cc_about_probes_run (const CcAboutProbe *probes, guint n_probes, const char *cache_file, const char *boot_id,
+                          GCancellable *cancellable, CcAboutProbeResultFunc callback, gpointer user_data);
+
+G_END_DECLS
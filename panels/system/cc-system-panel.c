@@ -23,6 +23,7 @@
 
 #include <glib/gi18n-lib.h>
 
+#include "cc-common-language.h"
 #include "cc-list-row.h"
 #include "cc-system-panel.h"
 #include "cc-system-resources.h"
@@ -151,17 +152,35 @@ cc_system_panel_class_init (CcSystemPanelClass *klass)
 }
 
 static void
-cc_system_panel_init (CcSystemPanel *self)
+remote_desktop_service_state_cb (GObject *source_object, GAsyncResult *res, gpointer user_data)
 {
+    CcSystemPanel *self;
     CcServiceState service_state;
+    g_autoptr(GError) error = NULL;
 
-    g_resources_register (cc_system_get_resource ());
-    gtk_widget_init_template (GTK_WIDGET (self));
+    service_state = cc_get_service_state_finish (res, &error);
+    if (error) {
+        if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            return;
+        g_warning ("%s", error->message);
+    }
+
+    self = CC_SYSTEM_PANEL (user_data);
 
-    service_state = cc_get_service_state (REMOTE_DESKTOP_SERVICE, G_BUS_TYPE_SYSTEM);
     /* Hide the remote-desktop page if the g-r-d service is either "masked", "static", or "not-found". */
     gtk_widget_set_visible (GTK_WIDGET (self->remote_desktop_row),
                             service_state == CC_SERVICE_STATE_ENABLED || service_state == CC_SERVICE_STATE_DISABLED);
+}
+
+static void
+cc_system_panel_init (CcSystemPanel *self)
+{
+    g_resources_register (cc_system_get_resource ());
+    gtk_widget_init_template (GTK_WIDGET (self));
+
+    gtk_widget_set_visible (GTK_WIDGET (self->remote_desktop_row), FALSE);
+    cc_get_service_state (REMOTE_DESKTOP_SERVICE, G_BUS_TYPE_SYSTEM, cc_panel_get_cancellable (CC_PANEL (self)),
+                          remote_desktop_service_state_cb, self);
     gtk_widget_set_visible (GTK_WIDGET (self->software_updates_group), show_software_updates_group (self));
 
     cc_panel_add_static_subpage (CC_PANEL (self), "about", CC_TYPE_ABOUT_PAGE);
@@ -170,3 +189,9 @@ cc_system_panel_init (CcSystemPanel *self)
     cc_panel_add_static_subpage (CC_PANEL (self), "remote-desktop", CC_TYPE_REMOTE_DESKTOP_PAGE);
     cc_panel_add_static_subpage (CC_PANEL (self), "users", CC_TYPE_USERS_PAGE);
 }
+
+void
+cc_system_panel_static_init_func (void)
+{
+    cc_common_language_declare_dbus_proxies ();
+}
@@ -22,31 +22,35 @@
 
 #include "cc-systemd-service.h"
 
-CcServiceState
-cc_get_service_state (const char *service, GBusType bus_type)
-{
-    g_autoptr(GError) error = NULL;
-    g_autoptr(GDBusConnection) connection = NULL;
-    g_autoptr(GVariant) unit_path_variant = NULL;
-    const gchar *state = NULL;
+#define SYSTEMD_BUS_NAME "org.freedesktop.systemd1"
+#define SYSTEMD_OBJECT_PATH "/org/freedesktop/systemd1"
+#define SYSTEMD_MANAGER_INTERFACE "org.freedesktop.systemd1.Manager"
+#define SYSTEMD_UNIT_INTERFACE "org.freedesktop.systemd1.Unit"
 
-    connection = g_bus_get_sync (bus_type, NULL, &error);
-    if (!connection) {
-        g_warning ("Failed connecting to D-Bus system bus: %s", error->message);
-        return CC_SERVICE_STATE_NOT_FOUND;
-    }
+typedef struct {
+    char *service;
+    gboolean enable;
+    GDBusConnection *connection;
+} ServiceOperation;
 
-    unit_path_variant = g_dbus_connection_call_sync (connection, "org.freedesktop.systemd1",
-                                                     "/org/freedesktop/systemd1", "org.freedesktop.systemd1.Manager",
-                                                     "GetUnitFileState", g_variant_new ("(s)", service),
-                                                     (GVariantType *) "(s)", G_DBUS_CALL_FLAGS_NONE, -1, NULL, &error);
-    if (error) {
-        g_warning ("Failed to get service state %s", error->message);
+typedef struct {
+    char *service;
+    CcServiceChangedFunc func;
+    gpointer user_data;
+    GDestroyNotify user_data_free_func;
+    GCancellable *cancellable;
+    GDBusConnection *connection;
+    guint unit_files_changed_id;
+    guint properties_changed_id;
+} ServiceWatch;
 
-        return CC_SERVICE_STATE_NOT_FOUND;
-    }
+/* watch id -> ServiceWatch */
+static GHashTable *watches = NULL;
+static guint next_watch_id = 1;
 
-    g_variant_get_child (unit_path_variant, 0, "&s", &state);
+static CcServiceState
+parse_service_state (const char *state)
+{
     if (g_strcmp0 (state, "enabled") == 0)
         return CC_SERVICE_STATE_ENABLED;
     if (g_strcmp0 (state, "disabled") == 0)
@@ -59,75 +63,330 @@ cc_get_service_state (const char *service, GBusType bus_type)
     return CC_SERVICE_STATE_NOT_FOUND;
 }
 
-gboolean
-cc_enable_service (const char *service, GBusType bus_type, GError **error)
+static void
+get_unit_file_state_cb (GObject *source_object, GAsyncResult *res, gpointer user_data)
 {
+    g_autoptr(GTask) task = user_data;
+    g_autoptr(GVariant) result = NULL;
+    GError *error = NULL;
+    const char *state;
+
+    result = g_dbus_connection_call_finish (G_DBUS_CONNECTION (source_object), res, &error);
+    if (!result) {
+        g_prefix_error_literal (&error, "Failed to get service state: ");
+        g_task_return_error (task, error);
+        return;
+    }
+
+    g_variant_get (result, "(&s)", &state);
+    g_task_return_int (task, parse_service_state (state));
+}
+
+static void
+get_state_bus_ready_cb (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+    g_autoptr(GTask) task = user_data;
     g_autoptr(GDBusConnection) connection = NULL;
-    g_autoptr(GVariant) start_result = NULL;
-    g_autoptr(GVariant) enable_result = NULL;
-    const char *service_list[] = { service, NULL };
+    GError *error = NULL;
 
-    connection = g_bus_get_sync (bus_type, NULL, error);
+    connection = g_bus_get_finish (res, &error);
     if (!connection) {
-        g_prefix_error_literal (error, "Failed connecting to D-Bus system bus: ");
-        return FALSE;
+        g_prefix_error_literal (&error, "Failed connecting to D-Bus: ");
+        g_task_return_error (task, error);
+        return;
     }
 
-    start_result = g_dbus_connection_call_sync (connection, "org.freedesktop.systemd1", "/org/freedesktop/systemd1",
-                                                "org.freedesktop.systemd1.Manager", "StartUnit",
-                                                g_variant_new ("(ss)", service, "replace"), (GVariantType *) "(o)",
-                                                G_DBUS_CALL_FLAGS_NONE, -1, NULL, error);
+    g_dbus_connection_call (connection, SYSTEMD_BUS_NAME, SYSTEMD_OBJECT_PATH, SYSTEMD_MANAGER_INTERFACE,
+                            "GetUnitFileState", g_variant_new ("(s)", (const char *) g_task_get_task_data (task)),
+                            G_VARIANT_TYPE ("(s)"), G_DBUS_CALL_FLAGS_NONE, -1, g_task_get_cancellable (task),
+                            get_unit_file_state_cb, g_steal_pointer (&task));
+}
+
+void
+cc_get_service_state (const char *service, GBusType bus_type, GCancellable *cancellable,
+                      GAsyncReadyCallback callback, gpointer user_data)
+{
+    g_autoptr(GTask) task = NULL;
+
+    g_return_if_fail (service != NULL);
+
+    task = g_task_new (NULL, cancellable, callback, user_data);
+    g_task_set_source_tag (task, cc_get_service_state);
+    g_task_set_task_data (task, g_strdup (service), g_free);
+
+    g_bus_get (bus_type, cancellable, get_state_bus_ready_cb, g_steal_pointer (&task));
+}
+
+CcServiceState
+cc_get_service_state_finish (GAsyncResult *result, GError **error)
+{
+    gssize state;
 
-    if (!start_result) {
-        g_prefix_error_literal (error, "Failed to start service: ");
-        return FALSE;
+    g_return_val_if_fail (g_task_is_valid (result, NULL), CC_SERVICE_STATE_NOT_FOUND);
+
+    state = g_task_propagate_int (G_TASK (result), error);
+    if (state < 0)
+        return CC_SERVICE_STATE_NOT_FOUND;
+
+    return state;
+}
+
+static void
+service_operation_free (ServiceOperation *operation)
+{
+    g_free (operation->service);
+    g_clear_object (&operation->connection);
+    g_free (operation);
+}
+
+static void
+operation_unit_files_cb (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+    g_autoptr(GTask) task = user_data;
+    ServiceOperation *operation = g_task_get_task_data (task);
+    g_autoptr(GVariant) result = NULL;
+    GError *error = NULL;
+
+    result = g_dbus_connection_call_finish (G_DBUS_CONNECTION (source_object), res, &error);
+    if (!result) {
+        g_prefix_error_literal (&error,
+                                operation->enable ? "Failed to enable service: " : "Failed to disable service: ");
+        g_task_return_error (task, error);
+        return;
+    }
+
+    g_task_return_boolean (task, TRUE);
+}
+
+static void
+operation_unit_cb (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+    g_autoptr(GTask) task = user_data;
+    ServiceOperation *operation = g_task_get_task_data (task);
+    g_autoptr(GVariant) result = NULL;
+    const char *service_list[] = { operation->service, NULL };
+    GError *error = NULL;
+
+    result = g_dbus_connection_call_finish (G_DBUS_CONNECTION (source_object), res, &error);
+    if (!result) {
+        g_prefix_error_literal (&error, operation->enable ? "Failed to start service: " : "Failed to stop service: ");
+        g_task_return_error (task, error);
+        return;
     }
 
-    enable_result = g_dbus_connection_call_sync (connection, "org.freedesktop.systemd1", "/org/freedesktop/systemd1",
-                                                 "org.freedesktop.systemd1.Manager", "EnableUnitFiles",
-                                                 g_variant_new ("(^asbb)", service_list, FALSE, FALSE),
-                                                 (GVariantType *) "(ba(sss))", G_DBUS_CALL_FLAGS_NONE, -1, NULL, error);
+    /* Only change the unit files once the unit is in the wanted state, so
+     * that a service failing to start isn't left enabled */
+    if (operation->enable) {
+        g_dbus_connection_call (operation->connection, SYSTEMD_BUS_NAME, SYSTEMD_OBJECT_PATH, SYSTEMD_MANAGER_INTERFACE,
+                                "EnableUnitFiles", g_variant_new ("(^asbb)", service_list, FALSE, FALSE),
+                                G_VARIANT_TYPE ("(ba(sss))"), G_DBUS_CALL_FLAGS_NONE, -1,
+                                g_task_get_cancellable (task), operation_unit_files_cb, g_steal_pointer (&task));
+    } else {
+        g_dbus_connection_call (operation->connection, SYSTEMD_BUS_NAME, SYSTEMD_OBJECT_PATH, SYSTEMD_MANAGER_INTERFACE,
+                                "DisableUnitFiles", g_variant_new ("(^asb)", service_list, FALSE),
+                                G_VARIANT_TYPE ("(a(sss))"), G_DBUS_CALL_FLAGS_NONE, -1, g_task_get_cancellable (task),
+                                operation_unit_files_cb, g_steal_pointer (&task));
+    }
+}
+
+static void
+operation_bus_ready_cb (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+    g_autoptr(GTask) task = user_data;
+    ServiceOperation *operation = g_task_get_task_data (task);
+    GError *error = NULL;
 
-    if (!enable_result) {
-        g_prefix_error_literal (error, "Failed to enable service: ");
-        return FALSE;
+    operation->connection = g_bus_get_finish (res, &error);
+    if (!operation->connection) {
+        g_prefix_error_literal (&error, "Failed connecting to D-Bus: ");
+        g_task_return_error (task, error);
+        return;
     }
 
-    return TRUE;
+    g_dbus_connection_call (operation->connection, SYSTEMD_BUS_NAME, SYSTEMD_OBJECT_PATH, SYSTEMD_MANAGER_INTERFACE,
+                            operation->enable ? "StartUnit" : "StopUnit",
+                            g_variant_new ("(ss)", operation->service, "replace"), G_VARIANT_TYPE ("(o)"),
+                            G_DBUS_CALL_FLAGS_NONE, -1, g_task_get_cancellable (task), operation_unit_cb,
+                            g_steal_pointer (&task));
+}
+
+static void
+run_service_operation (const char *service, GBusType bus_type, gboolean enable, GCancellable *cancellable,
+                       GAsyncReadyCallback callback, gpointer user_data, gpointer source_tag)
+{
+    g_autoptr(GTask) task = NULL;
+    ServiceOperation *operation;
+
+    operation = g_new0 (ServiceOperation, 1);
+    operation->service = g_strdup (service);
+    operation->enable = enable;
+
+    task = g_task_new (NULL, cancellable, callback, user_data);
+    g_task_set_source_tag (task, source_tag);
+    g_task_set_task_data (task, operation, (GDestroyNotify) service_operation_free);
+
+    g_bus_get (bus_type, cancellable, operation_bus_ready_cb, g_steal_pointer (&task));
+}
+
+void
+cc_enable_service (const char *service, GBusType bus_type, GCancellable *cancellable, GAsyncReadyCallback callback,
+                   gpointer user_data)
+{
+    g_return_if_fail (service != NULL);
+
+    run_service_operation (service, bus_type, TRUE, cancellable, callback, user_data, cc_enable_service);
+}
+
+gboolean
+cc_enable_service_finish (GAsyncResult *result, GError **error)
+{
+    g_return_val_if_fail (g_task_is_valid (result, NULL), FALSE);
+
+    return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+void
+cc_disable_service (const char *service, GBusType bus_type, GCancellable *cancellable, GAsyncReadyCallback callback,
+                    gpointer user_data)
+{
+    g_return_if_fail (service != NULL);
+
+    run_service_operation (service, bus_type, FALSE, cancellable, callback, user_data, cc_disable_service);
 }
 
 gboolean
-cc_disable_service (const char *service, GBusType bus_type, GError **error)
+cc_disable_service_finish (GAsyncResult *result, GError **error)
+{
+    g_return_val_if_fail (g_task_is_valid (result, NULL), FALSE);
+
+    return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+static void
+service_watch_free (ServiceWatch *watch)
+{
+    g_cancellable_cancel (watch->cancellable);
+    g_clear_object (&watch->cancellable);
+
+    if (watch->unit_files_changed_id != 0)
+        g_dbus_connection_signal_unsubscribe (watch->connection, watch->unit_files_changed_id);
+    if (watch->properties_changed_id != 0)
+        g_dbus_connection_signal_unsubscribe (watch->connection, watch->properties_changed_id);
+    g_clear_object (&watch->connection);
+
+    if (watch->user_data_free_func != NULL)
+        watch->user_data_free_func (watch->user_data);
+
+    g_free (watch->service);
+    g_free (watch);
+}
+
+static void
+service_changed_cb (GDBusConnection *connection, const char *sender_name, const char *object_path,
+                    const char *interface_name, const char *signal_name, GVariant *parameters, gpointer user_data)
+{
+    ServiceWatch *watch = user_data;
+
+    watch->func (watch->service, watch->user_data);
+}
+
+static void
+load_unit_cb (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+    g_autoptr(GVariant) result = NULL;
+    g_autoptr(GError) error = NULL;
+    ServiceWatch *watch;
+    const char *unit_path;
+
+    result = g_dbus_connection_call_finish (G_DBUS_CONNECTION (source_object), res, &error);
+    if (!result) {
+        if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            g_warning ("Failed to load unit: %s", error->message);
+        return;
+    }
+
+    watch = user_data;
+
+    /* Covers the unit starting and stopping */
+    g_variant_get (result, "(&o)", &unit_path);
+    watch->properties_changed_id = g_dbus_connection_signal_subscribe (
+        watch->connection, SYSTEMD_BUS_NAME, "org.freedesktop.DBus.Properties", "PropertiesChanged", unit_path,
+        SYSTEMD_UNIT_INTERFACE, G_DBUS_SIGNAL_FLAGS_NONE, service_changed_cb, watch, NULL);
+}
+
+static void
+watch_bus_ready_cb (GObject *source_object, GAsyncResult *res, gpointer user_data)
 {
     g_autoptr(GDBusConnection) connection = NULL;
-    g_autoptr(GVariant) stop_result = NULL;
-    g_autoptr(GVariant) disable_result = NULL;
-    const char *service_list[] = { service, NULL };
+    g_autoptr(GError) error = NULL;
+    ServiceWatch *watch;
 
-    connection = g_bus_get_sync (bus_type, NULL, error);
+    connection = g_bus_get_finish (res, &error);
     if (!connection) {
-        g_prefix_error_literal (error, "Failed connecting to D-Bus system bus: ");
-        return FALSE;
+        if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            g_warning ("Failed connecting to D-Bus: %s", error->message);
+        return;
     }
 
-    stop_result = g_dbus_connection_call_sync (connection, "org.freedesktop.systemd1", "/org/freedesktop/systemd1",
-                                               "org.freedesktop.systemd1.Manager", "StopUnit",
-                                               g_variant_new ("(ss)", service, "replace"), (GVariantType *) "(o)",
-                                               G_DBUS_CALL_FLAGS_NONE, -1, NULL, error);
-    if (!stop_result) {
-        g_prefix_error_literal (error, "Failed to stop service: ");
-        return FALSE;
-    }
+    watch = user_data;
+    watch->connection = g_steal_pointer (&connection);
 
-    disable_result = g_dbus_connection_call_sync (connection, "org.freedesktop.systemd1", "/org/freedesktop/systemd1",
-                                                  "org.freedesktop.systemd1.Manager", "DisableUnitFiles",
-                                                  g_variant_new ("(^asb)", service_list, FALSE, FALSE),
-                                                  (GVariantType *) "(a(sss))", G_DBUS_CALL_FLAGS_NONE, -1, NULL, error);
+    /* Covers the unit being enabled or disabled */
+    watch->unit_files_changed_id = g_dbus_connection_signal_subscribe (
+        watch->connection, SYSTEMD_BUS_NAME, SYSTEMD_MANAGER_INTERFACE, "UnitFilesChanged", SYSTEMD_OBJECT_PATH, NULL,
+        G_DBUS_SIGNAL_FLAGS_NONE, service_changed_cb, watch, NULL);
 
-    if (!disable_result) {
-        g_prefix_error_literal (error, "Failed to disable service: ");
-        return FALSE;
+    /* systemd only emits signals once a client has subscribed. The
+     * subscription goes away along with the connection. */
+    if (g_object_get_data (G_OBJECT (watch->connection), "cc-systemd-subscribed") == NULL) {
+        g_object_set_data (G_OBJECT (watch->connection), "cc-systemd-subscribed", GINT_TO_POINTER (TRUE));
+        g_dbus_connection_call (watch->connection, SYSTEMD_BUS_NAME, SYSTEMD_OBJECT_PATH, SYSTEMD_MANAGER_INTERFACE,
+                                "Subscribe", NULL, NULL, G_DBUS_CALL_FLAGS_NONE, -1, NULL, NULL, NULL);
     }
 
-    return TRUE;
+    g_dbus_connection_call (watch->connection, SYSTEMD_BUS_NAME, SYSTEMD_OBJECT_PATH, SYSTEMD_MANAGER_INTERFACE,
+                            "LoadUnit", g_variant_new ("(s)", watch->service), G_VARIANT_TYPE ("(o)"),
+                            G_DBUS_CALL_FLAGS_NONE, -1, watch->cancellable, load_unit_cb, watch);
+}
+
+/*
+ * Calls @func whenever @service is enabled, disabled, started or stopped,
+ * so that callers can refresh its state with cc_get_service_state().
+ * Returns an id to pass to cc_unwatch_service().
+ */
+guint
+cc_watch_service (const char *service, GBusType bus_type, CcServiceChangedFunc func, gpointer user_data,
+                  GDestroyNotify user_data_free_func)
+{
+    ServiceWatch *watch;
+    guint watch_id;
+
+    g_return_val_if_fail (service != NULL, 0);
+    g_return_val_if_fail (func != NULL, 0);
+
+    if (watches == NULL)
+        watches = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) service_watch_free);
+
+    watch = g_new0 (ServiceWatch, 1);
+    watch->service = g_strdup (service);
+    watch->func = func;
+    watch->user_data = user_data;
+    watch->user_data_free_func = user_data_free_func;
+    watch->cancellable = g_cancellable_new ();
+
+    watch_id = next_watch_id++;
+    g_hash_table_insert (watches, GUINT_TO_POINTER (watch_id), watch);
+
+    g_bus_get (bus_type, watch->cancellable, watch_bus_ready_cb, watch);
+
+    return watch_id;
+}
+
+void
+cc_unwatch_service (guint watch_id)
+{
+    g_return_if_fail (watch_id > 0);
+
+    if (watches == NULL || !g_hash_table_remove (watches, GUINT_TO_POINTER (watch_id)))
+        g_warning ("Invalid service watch id %u", watch_id);
 }
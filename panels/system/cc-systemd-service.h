@@ -31,8 +31,20 @@ typedef enum {
     CC_SERVICE_STATE_NOT_FOUND
 } CcServiceState;
 
-CcServiceState cc_get_service_state (const char *service, GBusType bus_type);
+typedef void (*CcServiceChangedFunc) (const char *service, gpointer user_data);
 
-gboolean cc_enable_service (const char *service, GBusType bus_type, GError **error);
+void cc_get_service_state (const char *service, GBusType bus_type, GCancellable *cancellable,
+                           GAsyncReadyCallback callback, gpointer user_data);
+CcServiceState cc_get_service_state_finish (GAsyncResult *result, GError **error);
 
-gboolean cc_disable_service (const char *service, GBusType bus_type, GError **error);
+void cc_enable_service (const char *service, GBusType bus_type, GCancellable *cancellable,
+                        GAsyncReadyCallback callback, gpointer user_data);
+gboolean cc_enable_service_finish (GAsyncResult *result, GError **error);
+
+void cc_disable_service (const char *service, GBusType bus_type, GCancellable *cancellable,
+                         GAsyncReadyCallback callback, gpointer user_data);
+gboolean cc_disable_service_finish (GAsyncResult *result, GError **error);
+
+guint cc_watch_service (const char *service, GBusType bus_type, CcServiceChangedFunc func, gpointer user_data,
+                        GDestroyNotify user_data_free_func);
+void cc_unwatch_service (guint watch_id);
@@ -35,6 +35,7 @@
 #include <string.h>
 
 #include "cc-tz-dialog.h"
+#include "cc-util.h"
 #include "tz.h"
 
 struct _CcTzDialog {
@@ -52,6 +53,11 @@ struct _CcTzDialog {
     GListStore *tz_store;
     GtkFilterListModel *tz_filtered_model;
     GtkNoSelection *tz_selection_model;
+    GtkSorter *match_sorter;
+
+    /* Normalized search text, and the words it is made of */
+    char *search_query;
+    GStrv search_words;
 
     CcTzItem *selected_item;
 };
@@ -68,80 +74,54 @@ static guint signals[N_SIGNALS];
 static gboolean
 match_tz_item (CcTzItem *item, CcTzDialog *self)
 {
-    g_auto(GStrv) strv = NULL;
-    g_autofree char *country = NULL;
-    g_autofree char *name = NULL;
-    g_autofree char *zone = NULL;
-    g_autofree char *name_fold = NULL;
-    g_autofree char *zone_fold = NULL;
-    g_autofree char *country_fold = NULL;
-    const char *search_terms;
-
     g_assert (CC_IS_TZ_ITEM (item));
     g_assert (CC_IS_TZ_DIALOG (self));
 
-    search_terms = gtk_editable_get_text (GTK_EDITABLE (self->location_entry));
-
-    if (!search_terms || !*search_terms)
+    if (!*self->search_query)
         return TRUE;
 
-    g_object_get (item, "country", &country, "name", &name, "zone", &zone, NULL);
-
-    if (!name || !zone || !country)
-        return FALSE;
-
-    /* Prepare case-folded versions for UTF-8 safe comparison */
-    name_fold = g_utf8_casefold (name, -1);
-    zone_fold = g_utf8_casefold (zone, -1);
-    country_fold = g_utf8_casefold (country, -1);
-
-    /* Search for each word separated by spaces */
-    strv = g_strsplit (search_terms, " ", 0);
-
     /*
      * List the item only if the value contain each word.
      * ie, for a search "as kol" it will match "Asia/Kolkata"
      * not "Asia/Karachi"
      */
-    for (guint i = 0; strv[i]; i++) {
-        g_autofree char *str_fold = NULL;
-        const char *str = strv[i];
+    return cc_tz_item_matches (item, (const char *const *) self->search_words);
+}
 
-        if (!str || !*str)
-            continue;
+/* Exact city names first, then the cities starting with the search */
+static int
+compare_tz_match (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+    CcTzDialog *self = user_data;
+    CcTzItemMatch match_a, match_b;
 
-        str_fold = g_utf8_casefold (str, -1);
+    match_a = cc_tz_item_get_match ((CcTzItem *) a, self->search_query);
+    match_b = cc_tz_item_get_match ((CcTzItem *) b, self->search_query);
 
-        if (!g_strstr_len (name_fold, -1, str_fold) && !g_strstr_len (zone_fold, -1, str_fold)
-            && !g_strstr_len (country_fold, -1, str_fold))
-            return FALSE;
-    }
-
-    return TRUE;
+    return (match_a > match_b) - (match_a < match_b);
 }
 
 static void
 load_tz (CcTzDialog *self)
 {
+    g_autoptr(GPtrArray) items = NULL;
     GPtrArray *locations;
 
     g_assert (CC_IS_TZ_DIALOG (self));
 
-    self->tz_db = tz_load_db ();
+    /* The database is shared with the rest of the process, and never freed */
+    self->tz_db = tz_db_get_default ();
     g_assert (self->tz_db);
 
     locations = tz_get_locations (self->tz_db);
     g_assert (locations);
 
-    for (guint i = 0; i < locations->len; i++) {
-        g_autoptr(CcTzItem) item = NULL;
-        TzLocation *location;
-
-        location = locations->pdata[i];
-        item = cc_tz_item_new (location);
+    items = g_ptr_array_new_full (locations->len, g_object_unref);
+    for (guint i = 0; i < locations->len; i++)
+        g_ptr_array_add (items, cc_tz_item_new (locations->pdata[i]));
 
-        g_list_store_append (self->tz_store, item);
-    }
+    /* Add all items at once, so that the models only update once */
+    g_list_store_splice (self->tz_store, 0, 0, items->pdata, items->len);
 }
 
 static void
@@ -162,13 +142,41 @@ tz_selection_model_changed_cb (CcTzDialog *self)
 static void
 tz_dialog_search_changed_cb (CcTzDialog *self)
 {
+    g_autofree char *old_query = NULL;
+    GtkFilterChange change;
     GtkFilter *filter;
+    const char *search_terms;
 
     g_assert (CC_IS_TZ_DIALOG (self));
 
+    search_terms = gtk_editable_get_text (GTK_EDITABLE (self->location_entry));
+
+    old_query = g_steal_pointer (&self->search_query);
+    self->search_query = cc_util_normalize_casefold_and_unaccent (search_terms ? search_terms : "");
+    g_strstrip (self->search_query);
+
+    if (g_str_equal (self->search_query, old_query))
+        return;
+
+    g_strfreev (self->search_words);
+    self->search_words = g_strsplit (self->search_query, " ", 0);
+
+    /*
+     * Extending the search can only remove items, so only the ones
+     * currently shown have to be checked again, and the other way
+     * around when shortening it.
+     */
+    if (g_str_has_prefix (self->search_query, old_query))
+        change = GTK_FILTER_CHANGE_MORE_STRICT;
+    else if (g_str_has_prefix (old_query, self->search_query))
+        change = GTK_FILTER_CHANGE_LESS_STRICT;
+    else
+        change = GTK_FILTER_CHANGE_DIFFERENT;
+
     filter = gtk_filter_list_model_get_filter (self->tz_filtered_model);
+    gtk_filter_changed (filter, change);
 
-    gtk_filter_changed (filter, GTK_FILTER_CHANGE_DIFFERENT);
+    gtk_sorter_changed (self->match_sorter, GTK_SORTER_CHANGE_DIFFERENT);
 }
 
 static void
@@ -221,7 +229,8 @@ cc_tz_dialog_finalize (GObject *object)
     CcTzDialog *self = (CcTzDialog *) object;
 
     g_clear_object (&self->tz_store);
-    g_clear_pointer (&self->tz_db, tz_db_free);
+    g_clear_pointer (&self->search_query, g_free);
+    g_clear_pointer (&self->search_words, g_strfreev);
 
     G_OBJECT_CLASS (cc_tz_dialog_parent_class)->finalize (object);
 }
@@ -259,23 +268,30 @@ static void
 cc_tz_dialog_init (CcTzDialog *self)
 {
     GtkSortListModel *tz_sorted_model;
+    GtkMultiSorter *sorter;
     GtkExpression *expression;
-    GtkSorter *sorter;
     GtkFilter *filter;
 
     gtk_widget_init_template (GTK_WIDGET (self));
 
+    self->search_query = g_strdup ("");
+    self->search_words = g_new0 (char *, 1);
+
     self->tz_store = g_list_store_new (CC_TYPE_TZ_ITEM);
     load_tz (self);
 
-    /* Sort items by name */
+    filter = (GtkFilter *) gtk_custom_filter_new ((GtkCustomFilterFunc) match_tz_item, self, NULL);
+    self->tz_filtered_model = gtk_filter_list_model_new (G_LIST_MODEL (g_object_ref (self->tz_store)), filter);
+
+    /* Sort the matching items by how well they match, then by name */
+    sorter = gtk_multi_sorter_new ();
+    self->match_sorter = GTK_SORTER (gtk_custom_sorter_new (compare_tz_match, self, NULL));
+    gtk_multi_sorter_append (sorter, self->match_sorter);
     expression = gtk_property_expression_new (CC_TYPE_TZ_ITEM, NULL, "name");
-    sorter = GTK_SORTER (gtk_string_sorter_new (expression));
-    tz_sorted_model = gtk_sort_list_model_new (G_LIST_MODEL (self->tz_store), sorter);
+    gtk_multi_sorter_append (sorter, GTK_SORTER (gtk_string_sorter_new (expression)));
 
-    filter = (GtkFilter *) gtk_custom_filter_new ((GtkCustomFilterFunc) match_tz_item, self, NULL);
-    self->tz_filtered_model = gtk_filter_list_model_new (G_LIST_MODEL (tz_sorted_model), filter);
-    self->tz_selection_model = gtk_no_selection_new (G_LIST_MODEL (self->tz_filtered_model));
+    tz_sorted_model = gtk_sort_list_model_new (G_LIST_MODEL (self->tz_filtered_model), GTK_SORTER (sorter));
+    self->tz_selection_model = gtk_no_selection_new (G_LIST_MODEL (tz_sorted_model));
 
     g_signal_connect_object (self->tz_selection_model, "items-changed", G_CALLBACK (tz_selection_model_changed_cb),
                              self, G_CONNECT_SWAPPED);
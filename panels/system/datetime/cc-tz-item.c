@@ -30,11 +30,13 @@
 #endif
 
 #include <glib/gi18n.h>
+#include <string.h>
 #define GNOME_DESKTOP_USE_UNSTABLE_API
 #include <libgnome-desktop/gnome-languages.h>
 #include <libgnome-desktop/gnome-wall-clock.h>
 
 #include "cc-tz-item.h"
+#include "cc-util.h"
 
 #define DEFAULT_TZ "Europe/London"
 #define GETTEXT_PACKAGE_TIMEZONES GETTEXT_PACKAGE "-timezones"
@@ -54,6 +56,11 @@ struct _CcTzItem {
     char *time;
     char *offset; /* eg: UTC+530 */
     char *zone;
+
+    /* Normalized for searching */
+    char *name_key;
+    char *zone_key;
+    char *country_key;
 };
 
 G_DEFINE_FINAL_TYPE (CcTzItem, cc_tz_item, G_TYPE_OBJECT)
@@ -70,6 +77,26 @@ enum {
 
 static GParamSpec *properties[N_PROPS];
 
+/* Many locations share a country, and looking its name up means going
+ * through the iso-codes translations, so only do it once per country. */
+static const char *
+get_country_name (const char *country_code)
+{
+    static GHashTable *country_names = NULL;
+    char *country_name;
+
+    if (!country_names)
+        country_names = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
+    country_name = g_hash_table_lookup (country_names, country_code);
+    if (!country_name) {
+        country_name = gnome_get_country_from_code (country_code, NULL);
+        g_hash_table_insert (country_names, g_strdup (country_code), country_name);
+    }
+
+    return country_name;
+}
+
 /* Adapted from cc-datetime-panel.c */
 static void
 generate_city_name (CcTzItem *self, TzLocation *loc)
@@ -83,7 +110,7 @@ generate_city_name (CcTzItem *self, TzLocation *loc)
     split_translated = g_regex_split_simple ("[\\x{2044}\\x{2215}\\x{29f8}\\x{ff0f}/]", self->zone, 0, 0);
 
     length = g_strv_length (split_translated);
-    self->country = gnome_get_country_from_code (loc->country, NULL);
+    self->country = g_strdup (get_country_name (loc->country));
     self->name = g_strdup (split_translated[length - 1]);
 }
 
@@ -169,6 +196,9 @@ cc_tz_item_finalize (GObject *object)
     g_clear_pointer (&self->time, g_free);
     g_clear_pointer (&self->offset, g_free);
     g_clear_pointer (&self->zone, g_free);
+    g_clear_pointer (&self->name_key, g_free);
+    g_clear_pointer (&self->zone_key, g_free);
+    g_clear_pointer (&self->country_key, g_free);
 
     G_OBJECT_CLASS (cc_tz_item_parent_class)->finalize (object);
 }
@@ -221,6 +251,10 @@ cc_tz_item_new (TzLocation *location)
     self->tz_info = tz_info_from_location (location);
     generate_city_name (self, location);
 
+    self->name_key = cc_util_normalize_casefold_and_unaccent (self->name);
+    self->zone_key = cc_util_normalize_casefold_and_unaccent (self->zone);
+    self->country_key = cc_util_normalize_casefold_and_unaccent (self->country);
+
     self->tz = g_time_zone_new_offset (self->tz_info->utc_offset);
 
     offset = g_string_new (g_time_zone_get_identifier (self->tz));
@@ -248,3 +282,51 @@ cc_tz_item_get_location (CcTzItem *self)
 
     return self->tz_location;
 }
+
+/*
+ * Returns %TRUE if every word of @words, as normalized by
+ * cc_util_normalize_casefold_and_unaccent(), is part of the name,
+ * zone or country of @self.
+ */
+gboolean
+cc_tz_item_matches (CcTzItem *self, const char *const *words)
+{
+    g_return_val_if_fail (CC_IS_TZ_ITEM (self), FALSE);
+
+    if (!self->name_key || !self->zone_key || !self->country_key)
+        return FALSE;
+
+    for (guint i = 0; words[i]; i++) {
+        if (!*words[i])
+            continue;
+
+        if (!strstr (self->name_key, words[i]) && !strstr (self->zone_key, words[i])
+            && !strstr (self->country_key, words[i]))
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+/*
+ * Returns how well the city name of @self matches @query, which must
+ * be normalized: %CC_TZ_ITEM_MATCH_EXACT if it is the same,
+ * %CC_TZ_ITEM_MATCH_PREFIX if it starts with it and
+ * %CC_TZ_ITEM_MATCH_OTHER otherwise.
+ */
+CcTzItemMatch
+cc_tz_item_get_match (CcTzItem *self, const char *query)
+{
+    g_return_val_if_fail (CC_IS_TZ_ITEM (self), CC_TZ_ITEM_MATCH_OTHER);
+
+    if (!self->name_key || !query || !*query)
+        return CC_TZ_ITEM_MATCH_OTHER;
+
+    if (g_str_equal (self->name_key, query))
+        return CC_TZ_ITEM_MATCH_EXACT;
+
+    if (g_str_has_prefix (self->name_key, query))
+        return CC_TZ_ITEM_MATCH_PREFIX;
+
+    return CC_TZ_ITEM_MATCH_OTHER;
+}
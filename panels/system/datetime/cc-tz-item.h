@@ -30,9 +30,17 @@
 
 G_BEGIN_DECLS
 
+typedef enum {
+    CC_TZ_ITEM_MATCH_EXACT,
+    CC_TZ_ITEM_MATCH_PREFIX,
+    CC_TZ_ITEM_MATCH_OTHER,
+} CcTzItemMatch;
+
 #define CC_TYPE_TZ_ITEM (cc_tz_item_get_type ())
 G_DECLARE_FINAL_TYPE (CcTzItem, cc_tz_item, CC, TZ_ITEM, GObject);
 CcTzItem *cc_tz_item_new (TzLocation *location);
 TzLocation *cc_tz_item_get_location (CcTzItem *self);
+gboolean cc_tz_item_matches (CcTzItem *self, const char *const *words);
+CcTzItemMatch cc_tz_item_get_match (CcTzItem *self, const char *query);
 
 G_END_DECLS
@@ -25,6 +25,7 @@
 #include "cc-system-resources.h"
 #include <ctype.h>
 #include <glib.h>
+#include <glib/gstdio.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -32,13 +33,21 @@
 #include <time.h>
 #include <unistd.h>
 
+/* Bump when the layout of TZ_INDEX_TYPE changes */
+#define TZ_INDEX_VERSION 1
+#define TZ_INDEX_TYPE "(qttua(ssmsdd)a{ss})"
+
 /* Forward declarations for private functions */
 
 static float convert_pos (gchar *pos, int digits);
 static int compare_country_names (const void *a, const void *b);
 static void sort_locations_by_country (GPtrArray *locations);
 static gchar *tz_data_file_get (void);
-static void load_backward_tz (TzDB *tz_db);
+static gchar *tz_index_file_get (void);
+static void load_backward_tz (TzDB *tz_db, GBytes *bytes);
+static TzDB *tz_parse_db (const gchar *tz_data_file, GBytes *backward);
+static TzDB *tz_load_index (const gchar *index_file, GStatBuf *tz_stat, guint backward_hash);
+static void tz_save_index (TzDB *tz_db, const gchar *index_file, GStatBuf *tz_stat, guint backward_hash);
 
 /* ---------------- *
  * Public interface *
@@ -47,87 +56,59 @@ TzDB *
 tz_load_db (void)
 {
     g_autofree gchar *tz_data_file = NULL;
+    g_autofree gchar *index_file = NULL;
+    g_autoptr(GBytes) backward = NULL;
+    GStatBuf tz_stat;
+    guint backward_hash;
     TzDB *tz_db;
-    FILE *tzfile;
-    char buf[4096];
 
     tz_data_file = tz_data_file_get ();
     if (!tz_data_file) {
         g_warning ("Could not get the TimeZone data file name");
         return NULL;
     }
-    tzfile = fopen (tz_data_file, "r");
-    if (!tzfile) {
+    if (g_stat (tz_data_file, &tz_stat) != 0) {
         g_warning ("Could not open *%s*\n", tz_data_file);
         return NULL;
     }
 
-    tz_db = g_new0 (TzDB, 1);
-    tz_db->locations = g_ptr_array_new ();
-
-    while (fgets (buf, sizeof (buf), tzfile)) {
-        g_auto(GStrv) tmpstrarr = NULL;
-        g_autofree gchar *latstr = NULL;
-        g_autofree gchar *lngstr = NULL;
-        gchar *p;
-        TzLocation *loc;
-
-        if (*buf == '#')
-            continue;
-
-        g_strchomp (buf);
-        tmpstrarr = g_strsplit (buf, "\t", 6);
-
-        latstr = g_strdup (tmpstrarr[1]);
-        p = latstr + 1;
-        while (*p != '-' && *p != '+')
-            p++;
-        lngstr = g_strdup (p);
-        *p = '\0';
-
-        loc = g_new0 (TzLocation, 1);
-        loc->country = g_strdup (tmpstrarr[0]);
-        loc->zone = g_strdup (tmpstrarr[2]);
-        loc->latitude = convert_pos (latstr, 2);
-        loc->longitude = convert_pos (lngstr, 3);
+    backward = g_resources_lookup_data ("/org/gnome/control-center/system/datetime/backward",
+                                        G_RESOURCE_LOOKUP_FLAGS_NONE, NULL);
+    backward_hash = g_bytes_hash (backward);
 
-#ifdef __sun
-        if (tmpstrarr[3] && *tmpstrarr[3] == '-' && tmpstrarr[4])
-            loc->comment = g_strdup (tmpstrarr[4]);
+    /* The index is only valid for the zone.tab and backward file it was built from */
+    index_file = tz_index_file_get ();
+    tz_db = tz_load_index (index_file, &tz_stat, backward_hash);
+    if (tz_db)
+        return tz_db;
 
-        if (tmpstrarr[3] && *tmpstrarr[3] != '-' && !islower (loc->zone)) {
-            TzLocation *locgrp;
+    tz_db = tz_parse_db (tz_data_file, backward);
+    if (tz_db)
+        tz_save_index (tz_db, index_file, &tz_stat, backward_hash);
 
-            /* duplicate entry */
-            locgrp = g_new0 (TzLocation, 1);
-            locgrp->country = g_strdup (tmpstrarr[0]);
-            locgrp->zone = g_strdup (tmpstrarr[3]);
-            locgrp->latitude = convert_pos (latstr, 2);
-            locgrp->longitude = convert_pos (lngstr, 3);
-            locgrp->comment = (tmpstrarr[4]) ? g_strdup (tmpstrarr[4]) : NULL;
+    return tz_db;
+}
 
-            g_ptr_array_add (tz_db->locations, (gpointer) locgrp);
-        }
-#else
-        loc->comment = (tmpstrarr[3]) ? g_strdup (tmpstrarr[3]) : NULL;
-#endif
+/*
+ * Returns the database shared by the whole process. It is loaded on first
+ * use and must neither be modified nor freed.
+ */
+TzDB *
+tz_db_get_default (void)
+{
+    static gsize initialized = 0;
+    static TzDB *default_db = NULL;
 
-        g_ptr_array_add (tz_db->locations, (gpointer) loc);
+    if (g_once_init_enter (&initialized)) {
+        default_db = tz_load_db ();
+        g_once_init_leave (&initialized, 1);
     }
 
-    fclose (tzfile);
-
-    /* now sort by country */
-    sort_locations_by_country (tz_db->locations);
-
-    /* Load up the hashtable of backward links */
-    load_backward_tz (tz_db);
-
-    return tz_db;
+    return default_db;
 }
 
 static void
-tz_location_free (TzLocation *loc, void *user_data)
+tz_location_free (TzLocation *loc)
 {
     g_free (loc->country);
     g_free (loc->zone);
@@ -139,9 +120,9 @@ tz_location_free (TzLocation *loc, void *user_data)
 void
 tz_db_free (TzDB *db)
 {
-    g_ptr_array_foreach (db->locations, (GFunc) tz_location_free, NULL);
-    g_ptr_array_free (db->locations, TRUE);
+    g_ptr_array_unref (db->locations);
     g_hash_table_destroy (db->backward);
+    g_clear_pointer (&db->index, g_variant_unref);
     g_free (db);
 }
 
@@ -382,6 +363,187 @@ tz_data_file_get (void)
     return file;
 }
 
+static gchar *
+tz_index_file_get (void)
+{
+    return g_build_filename (g_get_user_cache_dir (), "gnome-control-center", "tz-index", NULL);
+}
+
+static TzDB *
+tz_parse_db (const gchar *tz_data_file, GBytes *backward)
+{
+    TzDB *tz_db;
+    FILE *tzfile;
+    char buf[4096];
+
+    tzfile = fopen (tz_data_file, "r");
+    if (!tzfile) {
+        g_warning ("Could not open *%s*\n", tz_data_file);
+        return NULL;
+    }
+
+    tz_db = g_new0 (TzDB, 1);
+    tz_db->locations = g_ptr_array_new_with_free_func ((GDestroyNotify) tz_location_free);
+
+    while (fgets (buf, sizeof (buf), tzfile)) {
+        g_auto(GStrv) tmpstrarr = NULL;
+        g_autofree gchar *latstr = NULL;
+        g_autofree gchar *lngstr = NULL;
+        gchar *p;
+        TzLocation *loc;
+
+        if (*buf == '#')
+            continue;
+
+        g_strchomp (buf);
+        tmpstrarr = g_strsplit (buf, "\t", 6);
+
+        latstr = g_strdup (tmpstrarr[1]);
+        p = latstr + 1;
+        while (*p != '-' && *p != '+')
+            p++;
+        lngstr = g_strdup (p);
+        *p = '\0';
+
+        loc = g_new0 (TzLocation, 1);
+        loc->country = g_strdup (tmpstrarr[0]);
+        loc->zone = g_strdup (tmpstrarr[2]);
+        loc->latitude = convert_pos (latstr, 2);
+        loc->longitude = convert_pos (lngstr, 3);
+
+#ifdef __sun
+        if (tmpstrarr[3] && *tmpstrarr[3] == '-' && tmpstrarr[4])
+            loc->comment = g_strdup (tmpstrarr[4]);
+
+        if (tmpstrarr[3] && *tmpstrarr[3] != '-' && !islower (loc->zone)) {
+            TzLocation *locgrp;
+
+            /* duplicate entry */
+            locgrp = g_new0 (TzLocation, 1);
+            locgrp->country = g_strdup (tmpstrarr[0]);
+            locgrp->zone = g_strdup (tmpstrarr[3]);
+            locgrp->latitude = convert_pos (latstr, 2);
+            locgrp->longitude = convert_pos (lngstr, 3);
+            locgrp->comment = (tmpstrarr[4]) ? g_strdup (tmpstrarr[4]) : NULL;
+
+            g_ptr_array_add (tz_db->locations, (gpointer) locgrp);
+        }
+#else
+        loc->comment = (tmpstrarr[3]) ? g_strdup (tmpstrarr[3]) : NULL;
+#endif
+
+        g_ptr_array_add (tz_db->locations, (gpointer) loc);
+    }
+
+    fclose (tzfile);
+
+    /* now sort by country */
+    sort_locations_by_country (tz_db->locations);
+
+    /* Load up the hashtable of backward links */
+    load_backward_tz (tz_db, backward);
+
+    return tz_db;
+}
+
+static TzDB *
+tz_load_index (const gchar *index_file, GStatBuf *tz_stat, guint backward_hash)
+{
+    g_autoptr(GMappedFile) mapped = NULL;
+    g_autoptr(GVariant) locations = NULL;
+    g_autoptr(GVariant) backward = NULL;
+    g_autoptr(GBytes) bytes = NULL;
+    GVariantIter iter;
+    GVariant *variant;
+    const gchar *alias, *real;
+    const gchar *country, *zone, *comment;
+    gdouble latitude, longitude;
+    guint64 mtime, size;
+    guint16 version;
+    guint32 hash;
+    TzDB *tz_db;
+
+    mapped = g_mapped_file_new (index_file, FALSE, NULL);
+    if (!mapped)
+        return NULL;
+
+    /* The file is not trusted, GVariant will substitute defaults for malformed data */
+    bytes = g_mapped_file_get_bytes (mapped);
+    variant = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE (TZ_INDEX_TYPE), bytes, FALSE));
+
+    g_variant_get (variant, "(qttu@a(ssmsdd)@a{ss})", &version, &mtime, &size, &hash, &locations, &backward);
+    if (version != TZ_INDEX_VERSION || mtime != (guint64) tz_stat->st_mtime || size != (guint64) tz_stat->st_size
+        || hash != backward_hash || g_variant_n_children (locations) == 0) {
+        g_debug ("Timezone index %s is out of date", index_file);
+        g_variant_unref (variant);
+        return NULL;
+    }
+
+    /* The strings point into the mapped index, which the database keeps alive */
+    tz_db = g_new0 (TzDB, 1);
+    tz_db->index = variant;
+    tz_db->locations = g_ptr_array_new_full (g_variant_n_children (locations), g_free);
+    tz_db->backward = g_hash_table_new (g_str_hash, g_str_equal);
+
+    g_variant_iter_init (&iter, locations);
+    while (g_variant_iter_next (&iter, "(&s&sm&sdd)", &country, &zone, &comment, &latitude, &longitude)) {
+        TzLocation *loc;
+
+        loc = g_new0 (TzLocation, 1);
+        loc->country = (gchar *) country;
+        loc->zone = (gchar *) zone;
+        loc->comment = (gchar *) comment;
+        loc->latitude = latitude;
+        loc->longitude = longitude;
+
+        g_ptr_array_add (tz_db->locations, loc);
+    }
+
+    g_variant_iter_init (&iter, backward);
+    while (g_variant_iter_next (&iter, "{&s&s}", &alias, &real))
+        g_hash_table_insert (tz_db->backward, (gpointer) alias, (gpointer) real);
+
+    return tz_db;
+}
+
+static void
+tz_save_index (TzDB *tz_db, const gchar *index_file, GStatBuf *tz_stat, guint backward_hash)
+{
+    g_autoptr(GError) error = NULL;
+    g_autoptr(GVariant) variant = NULL;
+    g_autofree gchar *dir = NULL;
+    GVariantBuilder locations;
+    GVariantBuilder backward;
+    GHashTableIter iter;
+    gpointer alias, real;
+
+    g_variant_builder_init (&locations, G_VARIANT_TYPE ("a(ssmsdd)"));
+    for (guint i = 0; i < tz_db->locations->len; i++) {
+        TzLocation *loc = g_ptr_array_index (tz_db->locations, i);
+
+        g_variant_builder_add (&locations, "(ssmsdd)", loc->country, loc->zone, loc->comment, loc->latitude,
+                               loc->longitude);
+    }
+
+    g_variant_builder_init (&backward, G_VARIANT_TYPE ("a{ss}"));
+    g_hash_table_iter_init (&iter, tz_db->backward);
+    while (g_hash_table_iter_next (&iter, &alias, &real))
+        g_variant_builder_add (&backward, "{ss}", alias, real);
+
+    variant = g_variant_ref_sink (g_variant_new (TZ_INDEX_TYPE, (guint16) TZ_INDEX_VERSION, (guint64) tz_stat->st_mtime,
+                                               (guint64) tz_stat->st_size, (guint32) backward_hash, &locations,
+                                               &backward));
+
+    dir = g_path_get_dirname (index_file);
+    if (g_mkdir_with_parents (dir, 0700) < 0) {
+        g_debug ("Could not create directory '%s': %m", dir);
+        return;
+    }
+
+    if (!g_file_set_contents (index_file, g_variant_get_data (variant), g_variant_get_size (variant), &error))
+        g_debug ("Could not write timezone index: %s", error->message);
+}
+
 static float
 convert_pos (gchar *pos, int digits)
 {
@@ -441,17 +603,14 @@ sort_locations_by_country (GPtrArray *locations)
 }
 
 static void
-load_backward_tz (TzDB *tz_db)
+load_backward_tz (TzDB *tz_db, GBytes *bytes)
 {
     g_auto(GStrv) lines = NULL;
-    g_autoptr(GBytes) bytes = NULL;
     const char *contents;
     guint i;
 
     tz_db->backward = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
 
-    bytes = g_resources_lookup_data ("/org/gnome/control-center/system/datetime/backward", G_RESOURCE_LOOKUP_FLAGS_NONE,
-                                     NULL);
     contents = (const char *) g_bytes_get_data (bytes, NULL);
 
     lines = g_strsplit (contents, "\n", -1);
@@ -40,6 +40,9 @@ typedef struct _TzInfo TzInfo;
 struct _TzDB {
     GPtrArray *locations;
     GHashTable *backward;
+
+    /* Owns the strings of the locations and aliases when loaded from the index cache */
+    GVariant *index;
 };
 
 struct _TzLocation {
@@ -64,6 +67,7 @@ struct _TzInfo {
 };
 
 TzDB *tz_load_db (void);
+TzDB *tz_db_get_default (void);
 void tz_db_free (TzDB *db);
 char *tz_info_get_clean_name (TzDB *tz_db, const char *tz);
 GPtrArray *tz_get_locations (TzDB *db);
@@ -23,14 +23,12 @@
 #include <config.h>
 
 #include <adwaita.h>
-#include <errno.h>
 #include <glib/gi18n.h>
-#include <langinfo.h>
 #include <locale.h>
-#include <string.h>
 
 #include "cc-common-language.h"
 #include "cc-format-preview.h"
+#include "cc-locale-item.h"
 #include "cc-util.h"
 
 #define GNOME_DESKTOP_USE_UNSTABLE_API
@@ -42,19 +40,21 @@ struct _CcFormatChooser {
     AdwOverlaySplitView *split_view;
     GtkSearchEntry *region_filter_entry;
     GtkStack *region_list_stack;
-    AdwPreferencesGroup *common_region_group;
-    GtkListBox *common_region_listbox;
-    AdwPreferencesGroup *region_group;
-    GtkListBox *region_listbox;
+    GtkListView *region_listview;
     GtkWidget *close_sidebar_button;
     GtkLabel *preview_title_label;
     CcFormatPreview *format_preview;
-    gboolean adding;
-    gboolean showing_extra;
-    gboolean no_results;
+
+    /* The common formats followed by all of them, one section each */
+    GtkFilter *common_filter;
+    GtkFilter *region_filter;
+    GtkFilterListModel *common_regions;
+    GtkNoSelection *selection;
+    /* Bound rows and section headers, to update them in place */
+    GHashTable *rows;
+    GHashTable *headers;
+
     gchar *region;
-    gchar *region_group_title;
-    gchar *preview_region;
     gchar **filter_words;
 };
 
@@ -68,72 +68,50 @@ enum {
 static guint signals[LAST_SIGNAL];
 
 static void
-update_check_button_for_list (GtkListBox *list_box, const gchar *locale_id)
+update_row_check (GtkWidget *row, const gchar *locale_id)
 {
-    GtkWidget *child;
-
-    for (child = gtk_widget_get_first_child (GTK_WIDGET (list_box)); child;
-         child = gtk_widget_get_next_sibling (child)) {
-        if (!GTK_IS_LIST_BOX_ROW (child))
-            continue;
+    GtkWidget *check = g_object_get_data (G_OBJECT (row), "check");
+    CcLocaleItem *item = g_object_get_data (G_OBJECT (row), "locale-item");
 
-        GtkWidget *check = g_object_get_data (G_OBJECT (child), "check");
-        const gchar *region = g_object_get_data (G_OBJECT (child), "locale-id");
-        if (check == NULL || region == NULL)
-            continue;
-
-        gtk_widget_set_visible (check, g_strcmp0 (locale_id, region) == 0);
-    }
+    gtk_widget_set_visible (check, item != NULL && g_strcmp0 (locale_id, cc_locale_item_get_locale_id (item)) == 0);
 }
 
 static void
-set_locale_id (CcFormatChooser *self, const gchar *locale_id)
+set_preview_region (CcFormatChooser *self, const gchar *locale_id)
 {
+    CcLocaleItem *item = locale_id ? cc_locale_item_lookup (locale_id) : NULL;
     g_autofree gchar *locale_name = NULL;
 
-    g_set_str (&self->region, locale_id);
-
-    update_check_button_for_list (self->region_listbox, locale_id);
-    update_check_button_for_list (self->common_region_listbox, locale_id);
     cc_format_preview_set_region (self->format_preview, locale_id);
 
-    locale_name = gnome_get_country_from_locale (locale_id, locale_id);
-    gtk_label_set_label (self->preview_title_label, locale_name);
+    if (item)
+        gtk_label_set_label (self->preview_title_label, cc_locale_item_get_region (item));
+    else {
+        locale_name = gnome_get_country_from_locale (locale_id, locale_id);
+        gtk_label_set_label (self->preview_title_label, locale_name);
+    }
 }
 
-static gint
-sort_regions (GtkListBoxRow *row1, GtkListBoxRow *row2, gpointer user_data)
+static void
+set_locale_id (CcFormatChooser *self, const gchar *locale_id)
 {
-    const gchar *la;
-    const gchar *lb;
+    GHashTableIter iter;
+    gpointer row;
 
-    if (g_object_get_data (G_OBJECT (row1), "locale-id") == NULL)
-        return 1;
-    if (g_object_get_data (G_OBJECT (row2), "locale-id") == NULL)
-        return -1;
+    g_set_str (&self->region, locale_id);
 
-    la = g_object_get_data (G_OBJECT (row1), "locale-name");
-    lb = g_object_get_data (G_OBJECT (row2), "locale-name");
+    g_hash_table_iter_init (&iter, self->rows);
+    while (g_hash_table_iter_next (&iter, &row, NULL))
+        update_row_check (row, locale_id);
 
-    return g_strcmp0 (la, lb);
+    set_preview_region (self, locale_id);
 }
 
-static GtkWidget *
-padded_label_new (const char *text)
+static gint
+sort_regions (gconstpointer a, gconstpointer b, gpointer user_data)
 {
-    GtkWidget *widget, *label;
-
-    widget = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 12);
-    g_object_set (widget, "margin-start", 9, NULL);
-    g_object_set (widget, "margin-end", 9, NULL);
-
-    label = gtk_label_new (text);
-    g_object_set (label, "margin-top", 12, NULL);
-    g_object_set (label, "margin-bottom", 12, NULL);
-    gtk_label_set_ellipsize (GTK_LABEL (label), PANGO_ELLIPSIZE_END);
-    gtk_box_append (GTK_BOX (widget), label);
-
-    return widget;
+    return g_strcmp0 (cc_locale_item_get_region (CC_LOCALE_ITEM ((gpointer) a)),
+                      cc_locale_item_get_region (CC_LOCALE_ITEM ((gpointer) b)));
 }
 
 static void
@@ -154,13 +132,8 @@ collapsed_cb (CcFormatChooser *self)
     if (!self->region)
         return;
 
-    if (!adw_overlay_split_view_get_collapsed (self->split_view)) {
-        g_autofree gchar *locale_name = NULL;
-
-        cc_format_preview_set_region (self->format_preview, self->region);
-        locale_name = gnome_get_country_from_locale (self->region, self->region);
-        gtk_label_set_label (self->preview_title_label, locale_name);
-    }
+    if (!adw_overlay_split_view_get_collapsed (self->split_view))
+        set_preview_region (self, self->region);
 }
 
 static void
@@ -173,41 +146,36 @@ static void
 preview_button_clicked_cb (CcFormatChooser *self, GtkWidget *button)
 {
     GtkWidget *row;
-    const gchar *region;
-    const gchar *locale_name;
+    CcLocaleItem *item;
 
     g_assert (CC_IS_FORMAT_CHOOSER (self));
     g_assert (GTK_IS_WIDGET (button));
 
-    row = gtk_widget_get_ancestor (button, GTK_TYPE_LIST_BOX_ROW);
-    g_assert (row);
+    row = gtk_widget_get_parent (button);
+    item = g_object_get_data (G_OBJECT (row), "locale-item");
+    g_assert (item);
 
-    region = g_object_get_data (G_OBJECT (row), "locale-id");
-    cc_format_preview_set_region (self->format_preview, region);
-    locale_name = g_object_get_data (G_OBJECT (row), "locale-name");
-    gtk_label_set_label (self->preview_title_label, locale_name);
+    cc_format_preview_set_region (self->format_preview, cc_locale_item_get_locale_id (item));
+    gtk_label_set_label (self->preview_title_label, cc_locale_item_get_region (item));
 
     adw_overlay_split_view_set_show_sidebar (self->split_view, TRUE);
 }
 
-static GtkWidget *
-region_widget_new (CcFormatChooser *self, const gchar *locale_id)
+static void
+region_factory_setup_cb (GtkSignalListItemFactory *factory, GObject *object, gpointer user_data)
 {
-    gchar *locale_name;
-    gchar *locale_current_name;
-    gchar *locale_untranslated_name;
-    GtkWidget *row, *check, *box, *button;
+    CcFormatChooser *self = CC_FORMAT_CHOOSER (user_data);
+    GtkWidget *box, *label, *check, *button;
 
-    locale_name = gnome_get_country_from_locale (locale_id, locale_id);
-    if (!locale_name)
-        return NULL;
+    box = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 12);
+    gtk_widget_set_margin_start (box, 9);
+    gtk_widget_set_margin_end (box, 9);
 
-    locale_current_name = gnome_get_country_from_locale (locale_id, NULL);
-    locale_untranslated_name = gnome_get_country_from_locale (locale_id, "C");
-
-    row = gtk_list_box_row_new ();
-    box = padded_label_new (locale_name);
-    gtk_list_box_row_set_child (GTK_LIST_BOX_ROW (row), box);
+    label = gtk_label_new (NULL);
+    gtk_widget_set_margin_top (label, 12);
+    gtk_widget_set_margin_bottom (label, 12);
+    gtk_label_set_ellipsize (GTK_LABEL (label), PANGO_ELLIPSIZE_END);
+    gtk_box_append (GTK_BOX (box), label);
 
     check = gtk_image_new_from_icon_name ("object-select-symbolic");
     gtk_widget_set_halign (check, GTK_ALIGN_START);
@@ -225,157 +193,153 @@ region_widget_new (CcFormatChooser *self, const gchar *locale_id)
     g_object_bind_property (self->split_view, "collapsed", button, "visible", G_BINDING_SYNC_CREATE);
     gtk_box_append (GTK_BOX (box), button);
 
-    g_object_set_data (G_OBJECT (row), "check", check);
-    g_object_set_data_full (G_OBJECT (row), "locale-id", g_strdup (locale_id), g_free);
-    g_object_set_data_full (G_OBJECT (row), "locale-name", locale_name, g_free);
-    g_object_set_data_full (G_OBJECT (row), "locale-current-name", locale_current_name, g_free);
-    g_object_set_data_full (G_OBJECT (row), "locale-untranslated-name", locale_untranslated_name, g_free);
+    g_object_set_data (G_OBJECT (box), "label", label);
+    g_object_set_data (G_OBJECT (box), "check", check);
 
-    return row;
+    gtk_list_item_set_child (GTK_LIST_ITEM (object), box);
 }
 
+/* Rows are only bound for the items that are visible */
 static void
-add_regions (CcFormatChooser *self, gchar **locale_ids, GHashTable *initial)
+region_factory_bind_cb (GtkSignalListItemFactory *factory, GObject *object, gpointer user_data)
 {
-    g_autoptr(GList) initial_locales = NULL;
-    GtkWidget *widget;
-    GList *l;
+    CcFormatChooser *self = CC_FORMAT_CHOOSER (user_data);
+    GtkListItem *list_item = GTK_LIST_ITEM (object);
+    CcLocaleItem *item = gtk_list_item_get_item (list_item);
+    GtkWidget *row = gtk_list_item_get_child (list_item);
 
-    self->adding = TRUE;
-    initial_locales = g_hash_table_get_keys (initial);
+    gtk_label_set_label (g_object_get_data (G_OBJECT (row), "label"), cc_locale_item_get_region (item));
+    g_object_set_data (G_OBJECT (row), "locale-item", item);
+    update_row_check (row, self->region);
 
-    /* Populate Common Locales */
-    for (l = initial_locales; l != NULL; l = l->next) {
-        if (!cc_common_language_has_font (l->data))
-            continue;
+    g_hash_table_add (self->rows, row);
+}
 
-        widget = region_widget_new (self, l->data);
-        if (!widget)
-            continue;
+static void
+region_factory_unbind_cb (GtkSignalListItemFactory *factory, GObject *object, gpointer user_data)
+{
+    CcFormatChooser *self = CC_FORMAT_CHOOSER (user_data);
+    GtkWidget *row = gtk_list_item_get_child (GTK_LIST_ITEM (object));
 
-        gtk_list_box_append (self->common_region_listbox, widget);
-    }
+    if (self->rows)
+        g_hash_table_remove (self->rows, row);
+    g_object_set_data (G_OBJECT (row), "locale-item", NULL);
+}
 
-    /* Populate All locales */
-    while (*locale_ids) {
-        gchar *locale_id;
+static void
+update_header (CcFormatChooser *self, GtkListHeader *header)
+{
+    GtkWidget *label = gtk_list_header_get_child (header);
+    guint n_common = g_list_model_get_n_items (G_LIST_MODEL (self->common_regions));
 
-        locale_id = *locale_ids;
-        locale_ids++;
+    /* The all formats title is hidden while searching, with the common ones */
+    if (gtk_list_header_get_start (header) < n_common)
+        gtk_label_set_label (GTK_LABEL (label), _("Common Formats"));
+    else
+        gtk_label_set_label (GTK_LABEL (label), self->filter_words ? "" : _("All Formats"));
 
-        if (!cc_common_language_has_font (locale_id))
-            continue;
+    gtk_widget_set_visible (label, !g_str_equal (gtk_label_get_label (GTK_LABEL (label)), ""));
+}
 
-        widget = region_widget_new (self, locale_id);
-        if (!widget)
-            continue;
+static void
+region_header_setup_cb (GtkSignalListItemFactory *factory, GObject *object, gpointer user_data)
+{
+    GtkWidget *label;
 
-        gtk_list_box_append (self->region_listbox, widget);
-    }
+    label = gtk_label_new (NULL);
+    gtk_label_set_xalign (GTK_LABEL (label), 0);
+    gtk_widget_add_css_class (label, "heading");
+    gtk_widget_set_margin_top (label, 18);
+    gtk_widget_set_margin_bottom (label, 6);
+    gtk_widget_set_margin_start (label, 9);
 
-    self->adding = FALSE;
+    gtk_list_header_set_child (GTK_LIST_HEADER (object), label);
 }
 
 static void
-add_all_regions (CcFormatChooser *self)
+region_header_bind_cb (GtkSignalListItemFactory *factory, GObject *object, gpointer user_data)
 {
-    g_auto(GStrv) locale_ids = NULL;
-    g_autoptr(GHashTable) initial = NULL;
+    CcFormatChooser *self = CC_FORMAT_CHOOSER (user_data);
 
-    locale_ids = gnome_get_all_locales ();
-    initial = cc_common_language_get_initial_languages ();
-    add_regions (self, locale_ids, initial);
+    update_header (self, GTK_LIST_HEADER (object));
+    g_hash_table_add (self->headers, object);
 }
 
-static gboolean
-match_all (gchar **words, const gchar *str)
+static void
+region_header_unbind_cb (GtkSignalListItemFactory *factory, GObject *object, gpointer user_data)
 {
-    gchar **w;
-
-    for (w = words; *w; ++w)
-        if (!strstr (str, *w))
-            return FALSE;
+    CcFormatChooser *self = CC_FORMAT_CHOOSER (user_data);
 
-    return TRUE;
+    if (self->headers)
+        g_hash_table_remove (self->headers, object);
 }
 
 static gboolean
-region_visible (GtkListBoxRow *row, gpointer user_data)
+common_region_visible (gpointer item, gpointer user_data)
 {
     CcFormatChooser *self = user_data;
-    g_autofree gchar *locale_name = NULL;
-    g_autofree gchar *locale_current_name = NULL;
-    g_autofree gchar *locale_untranslated_name = NULL;
-    gboolean match = TRUE;
 
-    if (!self->filter_words)
-        goto end;
+    /* The common formats are shown only if search is empty */
+    return !self->filter_words && cc_locale_item_get_is_initial (item) && cc_locale_item_get_region (item) != NULL;
+}
 
-    locale_name = cc_util_normalize_casefold_and_unaccent (g_object_get_data (G_OBJECT (row), "locale-name"));
-    if (match_all (self->filter_words, locale_name))
-        goto end;
+static gboolean
+region_visible (gpointer item, gpointer user_data)
+{
+    CcFormatChooser *self = user_data;
 
-    locale_current_name =
-        cc_util_normalize_casefold_and_unaccent (g_object_get_data (G_OBJECT (row), "locale-current-name"));
-    if (match_all (self->filter_words, locale_current_name))
-        goto end;
+    if (cc_locale_item_get_region (item) == NULL)
+        return FALSE;
 
-    locale_untranslated_name =
-        cc_util_normalize_casefold_and_unaccent (g_object_get_data (G_OBJECT (row), "locale-untranslated-name"));
+    if (!self->filter_words)
+        return TRUE;
 
-    match = match_all (self->filter_words, locale_untranslated_name);
+    return cc_locale_item_match_region (item, self->filter_words);
+}
 
-end:
-    if (match)
-        self->no_results = FALSE;
-    return match;
+static void
+update_visible_page (CcFormatChooser *self)
+{
+    if (g_list_model_get_n_items (G_LIST_MODEL (self->selection)) == 0)
+        gtk_stack_set_visible_child_name (self->region_list_stack, "empty_results_page");
+    else
+        gtk_stack_set_visible_child_name (self->region_list_stack, "region_list_page");
 }
 
 static void
 filter_changed (CcFormatChooser *self)
 {
     g_autofree gchar *filter_contents = NULL;
-    gboolean search_is_empty;
+    GHashTableIter iter;
+    gpointer header;
 
     g_clear_pointer (&self->filter_words, g_strfreev);
 
     filter_contents =
         cc_util_normalize_casefold_and_unaccent (gtk_editable_get_text (GTK_EDITABLE (self->region_filter_entry)));
+    if (filter_contents && *g_strstrip (filter_contents) != '\0')
+        self->filter_words = g_strsplit_set (filter_contents, " ", 0);
 
-    /* The popular listbox and the region group title are shown only if search is empty */
-    search_is_empty = filter_contents == NULL || *filter_contents == '\0';
-    gtk_widget_set_visible (GTK_WIDGET (self->common_region_group), search_is_empty);
-    if (search_is_empty)
-        adw_preferences_group_set_title (self->region_group, self->region_group_title);
-    else
-        adw_preferences_group_set_title (self->region_group, "");
-
-    /* Reset cached search state */
-    self->no_results = TRUE;
-
-    if (!filter_contents) {
-        gtk_list_box_invalidate_filter (self->region_listbox);
-        gtk_list_box_set_placeholder (self->region_listbox, NULL);
-        return;
-    }
-    self->filter_words = g_strsplit_set (g_strstrip (filter_contents), " ", 0);
-    gtk_list_box_invalidate_filter (self->region_listbox);
+    /* The names and their normalized forms are cached by CcLocaleItem */
+    gtk_filter_changed (self->common_filter, GTK_FILTER_CHANGE_DIFFERENT);
+    gtk_filter_changed (self->region_filter, GTK_FILTER_CHANGE_DIFFERENT);
 
-    if (self->no_results)
-        gtk_stack_set_visible_child_name (self->region_list_stack, "empty_results_page");
-    else
-        gtk_stack_set_visible_child_name (self->region_list_stack, "region_list_page");
+    g_hash_table_iter_init (&iter, self->headers);
+    while (g_hash_table_iter_next (&iter, &header, NULL))
+        update_header (self, header);
 }
 
 static void
-row_activated (CcFormatChooser *self, GtkListBoxRow *row)
+row_activated (CcFormatChooser *self, guint position)
 {
+    g_autoptr(CcLocaleItem) item = NULL;
     const gchar *new_locale_id;
 
-    if (self->adding)
+    item = g_list_model_get_item (G_LIST_MODEL (self->selection), position);
+    if (!item)
         return;
 
-    new_locale_id = g_object_get_data (G_OBJECT (row), "locale-id");
+    new_locale_id = cc_locale_item_get_locale_id (item);
     if (g_strcmp0 (new_locale_id, self->region) == 0)
         g_signal_emit (self, signals[LANGUAGE_SELECTED], 0);
     else
@@ -393,9 +357,14 @@ cc_format_chooser_dispose (GObject *object)
 {
     CcFormatChooser *self = CC_FORMAT_CHOOSER (object);
 
+    g_clear_object (&self->selection);
+    g_clear_object (&self->common_regions);
+    g_clear_object (&self->common_filter);
+    g_clear_object (&self->region_filter);
+    g_clear_pointer (&self->rows, g_hash_table_unref);
+    g_clear_pointer (&self->headers, g_hash_table_unref);
     g_clear_pointer (&self->filter_words, g_strfreev);
     g_clear_pointer (&self->region, g_free);
-    g_clear_pointer (&self->region_group_title, g_free);
 
     G_OBJECT_CLASS (cc_format_chooser_parent_class)->dispose (object);
 }
@@ -418,10 +387,7 @@ cc_format_chooser_class_init (CcFormatChooserClass *klass)
 
     gtk_widget_class_bind_template_child (widget_class, CcFormatChooser, split_view);
     gtk_widget_class_bind_template_child (widget_class, CcFormatChooser, region_filter_entry);
-    gtk_widget_class_bind_template_child (widget_class, CcFormatChooser, common_region_group);
-    gtk_widget_class_bind_template_child (widget_class, CcFormatChooser, common_region_listbox);
-    gtk_widget_class_bind_template_child (widget_class, CcFormatChooser, region_group);
-    gtk_widget_class_bind_template_child (widget_class, CcFormatChooser, region_listbox);
+    gtk_widget_class_bind_template_child (widget_class, CcFormatChooser, region_listview);
     gtk_widget_class_bind_template_child (widget_class, CcFormatChooser, region_list_stack);
     gtk_widget_class_bind_template_child (widget_class, CcFormatChooser, format_preview);
     gtk_widget_class_bind_template_child (widget_class, CcFormatChooser, preview_title_label);
@@ -432,22 +398,55 @@ cc_format_chooser_class_init (CcFormatChooserClass *klass)
     gtk_widget_class_bind_template_callback (widget_class, row_activated);
     gtk_widget_class_bind_template_callback (widget_class, on_stop_search);
     gtk_widget_class_bind_template_callback (widget_class, collapsed_cb);
+    gtk_widget_class_bind_template_callback (widget_class, region_factory_setup_cb);
+    gtk_widget_class_bind_template_callback (widget_class, region_factory_bind_cb);
+    gtk_widget_class_bind_template_callback (widget_class, region_factory_unbind_cb);
+    gtk_widget_class_bind_template_callback (widget_class, region_header_setup_cb);
+    gtk_widget_class_bind_template_callback (widget_class, region_header_bind_cb);
+    gtk_widget_class_bind_template_callback (widget_class, region_header_unbind_cb);
+}
+
+static GListModel *
+sorted_regions_new (GtkFilter *filter)
+{
+    GtkFilterListModel *filtered;
+
+    filtered = gtk_filter_list_model_new (g_object_ref (cc_locale_item_get_all ()), g_object_ref (filter));
+
+    return G_LIST_MODEL (gtk_sort_list_model_new (G_LIST_MODEL (filtered),
+                                                  GTK_SORTER (gtk_custom_sorter_new (sort_regions, NULL, NULL))));
 }
 
 void
 cc_format_chooser_init (CcFormatChooser *self)
 {
+    g_autoptr(GListStore) sections = NULL;
+    g_autoptr(GListModel) common_sorted = NULL;
+    g_autoptr(GListModel) all_sorted = NULL;
+
     gtk_widget_init_template (GTK_WIDGET (self));
 
-    gtk_list_box_set_sort_func (self->common_region_listbox, sort_regions, self, NULL);
-    gtk_list_box_set_sort_func (self->region_listbox, sort_regions, self, NULL);
-    gtk_list_box_set_filter_func (self->region_listbox, region_visible, self, NULL);
+    self->rows = g_hash_table_new (NULL, NULL);
+    self->headers = g_hash_table_new (NULL, NULL);
+
+    self->common_filter = GTK_FILTER (gtk_custom_filter_new (common_region_visible, self, NULL));
+    self->region_filter = GTK_FILTER (gtk_custom_filter_new (region_visible, self, NULL));
+
+    common_sorted = sorted_regions_new (self->common_filter);
+    self->common_regions = g_object_ref (GTK_FILTER_LIST_MODEL (
+        gtk_sort_list_model_get_model (GTK_SORT_LIST_MODEL (common_sorted))));
+    all_sorted = sorted_regions_new (self->region_filter);
+
+    sections = g_list_store_new (G_TYPE_LIST_MODEL);
+    g_list_store_append (sections, common_sorted);
+    g_list_store_append (sections, all_sorted);
 
-    add_all_regions (self);
-    gtk_list_box_invalidate_filter (self->region_listbox);
+    self->selection = gtk_no_selection_new (G_LIST_MODEL (gtk_flatten_list_model_new (
+        G_LIST_MODEL (g_steal_pointer (&sections)))));
+    g_signal_connect_object (self->selection, "items-changed", G_CALLBACK (update_visible_page), self,
+                             G_CONNECT_SWAPPED);
 
-    /* Store group title so we can hide it during search */
-    g_set_str (&self->region_group_title, adw_preferences_group_get_title (self->region_group));
+    gtk_list_view_set_model (self->region_listview, GTK_SELECTION_MODEL (self->selection));
 }
 
 CcFormatChooser *
@@ -73,8 +73,14 @@ struct _CcDesktopSharingPage {
 
     guint desktop_sharing_name_watch;
     guint store_credentials_id;
+    gboolean storing_credentials;
+    /* The latest credentials, stored once the store in flight finished */
+    gchar *queued_username;
+    gchar *queued_password;
     GTlsCertificate *certificate;
 
+    SecretCollection *collection;
+
     GSettings *rdp_settings;
     GCancellable *cancellable;
 };
@@ -124,56 +130,129 @@ check_schema_available (CcDesktopSharingPage *self, const gchar *schema_id)
     return TRUE;
 }
 
-static gboolean
-store_credentials_timeout (gpointer user_data)
+static void on_credentials_stored (GObject *source_object, GAsyncResult *res, gpointer user_data);
+
+static void
+start_storing_credentials (CcDesktopSharingPage *self, const char *username, const char *password)
+{
+    /* The store isn't cancelled along with the page, edits made right before closing it aren't lost */
+    self->storing_credentials = TRUE;
+    cc_grd_store_rdp_credentials (username, password, NULL, on_credentials_stored, g_object_ref (self));
+}
+
+static void
+on_credentials_stored (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+    g_autoptr(CcDesktopSharingPage) self = user_data;
+    g_autofree gchar *username = g_steal_pointer (&self->queued_username);
+    g_autofree gchar *password = g_steal_pointer (&self->queued_password);
+    g_autoptr(GError) error = NULL;
+
+    if (!cc_grd_store_rdp_credentials_finish (res, &error))
+        g_warning ("Failed to store RDP credentials: %s", error->message);
+
+    self->storing_credentials = FALSE;
+
+    if (username != NULL)
+        start_storing_credentials (self, username, password);
+}
+
+static void
+store_credentials (CcDesktopSharingPage *self)
 {
-    CcDesktopSharingPage *self = (CcDesktopSharingPage *) user_data;
     const char *username, *password;
 
     username = gtk_editable_get_text (GTK_EDITABLE (self->username_entry));
     password = gtk_editable_get_text (GTK_EDITABLE (self->password_entry));
 
-    if (username && password) {
-        cc_grd_store_rdp_credentials (username, password, self->cancellable);
+    if (!username || !password)
+        return;
+
+    /* Only one store is in flight, it is followed by one with the latest values */
+    if (self->storing_credentials) {
+        g_free (self->queued_username);
+        g_free (self->queued_password);
+        self->queued_username = g_strdup (username);
+        self->queued_password = g_strdup (password);
+        return;
     }
 
+    start_storing_credentials (self, username, password);
+}
+
+static gboolean
+store_credentials_timeout (gpointer user_data)
+{
+    CcDesktopSharingPage *self = (CcDesktopSharingPage *) user_data;
+
     self->store_credentials_id = 0;
+    store_credentials (self);
 
     return G_SOURCE_REMOVE;
 }
 
-static gboolean
-is_desktop_sharing_enabled (CcDesktopSharingPage *self)
+static void
+on_service_disabled (GObject *source_object, GAsyncResult *res, gpointer user_data)
 {
-    if (!g_settings_get_boolean (self->rdp_settings, "enable"))
-        return FALSE;
+    g_autoptr(GError) error = NULL;
 
-    return cc_get_service_state (REMOTE_DESKTOP_SERVICE, G_BUS_TYPE_SESSION) == CC_SERVICE_STATE_ENABLED;
+    if (!cc_disable_service_finish (res, &error)) {
+        if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            g_warning ("Failed to disable remote desktop service: %s", error->message);
+    }
 }
 
 static void
 disable_gnome_desktop_sharing_service (CcDesktopSharingPage *self)
 {
+    g_settings_set_boolean (self->rdp_settings, "enable", FALSE);
+
+    cc_disable_service (REMOTE_DESKTOP_SERVICE, G_BUS_TYPE_SESSION, self->cancellable, on_service_disabled, NULL);
+}
+
+static void
+on_service_enabled (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+    CcDesktopSharingPage *self;
     g_autoptr(GError) error = NULL;
 
-    g_settings_set_boolean (self->rdp_settings, "enable", FALSE);
+    if (cc_enable_service_finish (res, &error))
+        return;
+
+    if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        return;
 
-    if (!cc_disable_service (REMOTE_DESKTOP_SERVICE, G_BUS_TYPE_SESSION, &error))
-        g_warning ("Failed to enable remote desktop service: %s", error->message);
+    self = (CcDesktopSharingPage *) user_data;
+
+    g_warning ("Failed to enable remote desktop service: %s", error->message);
+    disable_gnome_desktop_sharing_service (self);
 }
 
 static void
-enable_gnome_desktop_sharing_service (CcDesktopSharingPage *self)
+on_service_state_before_enable (GObject *source_object, GAsyncResult *res, gpointer user_data)
 {
+    CcDesktopSharingPage *self;
+    CcServiceState state;
     g_autoptr(GError) error = NULL;
 
-    if (is_desktop_sharing_enabled (self))
+    state = cc_get_service_state_finish (res, &error);
+    if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
         return;
 
-    if (!cc_enable_service (REMOTE_DESKTOP_SERVICE, G_BUS_TYPE_SESSION, &error)) {
-        g_warning ("Failed to enable remote desktop service: %s", error->message);
-        disable_gnome_desktop_sharing_service (self);
-    }
+    self = (CcDesktopSharingPage *) user_data;
+
+    /* The switch may have been turned off meanwhile */
+    if (state == CC_SERVICE_STATE_ENABLED || !g_settings_get_boolean (self->rdp_settings, "enable"))
+        return;
+
+    cc_enable_service (REMOTE_DESKTOP_SERVICE, G_BUS_TYPE_SESSION, self->cancellable, on_service_enabled, self);
+}
+
+static void
+enable_gnome_desktop_sharing_service (CcDesktopSharingPage *self)
+{
+    cc_get_service_state (REMOTE_DESKTOP_SERVICE, G_BUS_TYPE_SESSION, self->cancellable,
+                          on_service_state_before_enable, self);
 }
 
 static void
@@ -353,17 +432,37 @@ on_password_copy_clicked (CcDesktopSharingPage *self, GtkButton *button)
 }
 
 static void
-load_credentials (CcDesktopSharingPage *self)
+set_login_details_sensitive (CcDesktopSharingPage *self)
+{
+    gtk_widget_set_sensitive (self->login_details_group, TRUE);
+    gtk_widget_set_sensitive (GTK_WIDGET (self->generate_password_button_row), TRUE);
+}
+
+static void
+on_credentials_loaded (GObject *source_object, GAsyncResult *res, gpointer user_data)
 {
+    CcDesktopSharingPage *self;
     g_autofree gchar *username = NULL;
     g_autofree gchar *password = NULL;
+    g_autoptr(GError) error = NULL;
 
-    username = cc_grd_lookup_rdp_username (self->cancellable);
-    password = cc_grd_lookup_rdp_password (self->cancellable);
+    if (!cc_grd_lookup_rdp_credentials_finish (res, &username, &password, &error)) {
+        if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            return;
+        g_warning ("Failed to get RDP credentials: %s", error->message);
+    }
+
+    self = (CcDesktopSharingPage *) user_data;
+
+    /* Values coming from the keyring don't need to be stored again */
+    g_signal_handlers_block_by_func (self->username_entry, on_credentials_changed, self);
+    g_signal_handlers_block_by_func (self->password_entry, on_credentials_changed, self);
     if (username != NULL)
         gtk_editable_set_text (GTK_EDITABLE (self->username_entry), username);
     if (password != NULL)
         gtk_editable_set_text (GTK_EDITABLE (self->password_entry), password);
+    g_signal_handlers_unblock_by_func (self->username_entry, on_credentials_changed, self);
+    g_signal_handlers_unblock_by_func (self->password_entry, on_credentials_changed, self);
 
     /* No credentials available. Let's create them. */
     if (username == NULL) {
@@ -372,30 +471,43 @@ load_credentials (CcDesktopSharingPage *self)
             username = g_strdup (pw->pw_name);
         else
             g_warning ("Failed to get username: %s", g_strerror (errno));
+
+        if (username != NULL)
+            gtk_editable_set_text (GTK_EDITABLE (self->username_entry), username);
     }
-    gtk_editable_set_text (GTK_EDITABLE (self->username_entry), username);
 
     if (password == NULL) {
         g_autofree gchar *pw = cc_generate_password ();
         if (pw != NULL)
             gtk_editable_set_text (GTK_EDITABLE (self->password_entry), pw);
     }
+
+    set_login_details_sensitive (self);
+}
+
+static void
+load_credentials (CcDesktopSharingPage *self)
+{
+    cc_grd_lookup_rdp_credentials (self->cancellable, on_credentials_loaded, self);
 }
 
 static void
 unlock_gnome_keyring_cb (GObject *source_object, GAsyncResult *res, gpointer user_data)
 {
-    CcDesktopSharingPage *self = CC_DESKTOP_SHARING_PAGE (user_data);
+    CcDesktopSharingPage *self;
     g_autoptr(GList) unlocked = NULL;
+    g_autoptr(GError) error = NULL;
+
+    secret_service_unlock_finish (NULL, res, &unlocked, &error);
+    if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        return;
 
-    secret_service_unlock_finish (NULL, res, &unlocked, NULL);
     /* If the keyring is locked,  */
     if (unlocked == NULL)
         return;
 
+    self = CC_DESKTOP_SHARING_PAGE (user_data);
     adw_banner_set_revealed (self->keyring_infobar, FALSE);
-    gtk_widget_set_sensitive (self->login_details_group, TRUE);
-    gtk_widget_set_sensitive (GTK_WIDGET (self->generate_password_button_row), TRUE);
 
     load_credentials (self);
 }
@@ -403,62 +515,100 @@ unlock_gnome_keyring_cb (GObject *source_object, GAsyncResult *res, gpointer use
 static void
 unlock_gnome_keyring (CcDesktopSharingPage *self)
 {
-    g_autoptr(SecretService) service = NULL;
     g_autoptr(GList) collections_to_unlock = NULL;
+
+    if (self->collection == NULL) {
+        g_debug ("Can't unlock secret collection: Not loaded yet");
+        return;
+    }
+
+    collections_to_unlock = g_list_append (collections_to_unlock, self->collection);
+    secret_service_unlock (NULL, collections_to_unlock, self->cancellable,
+                           (GAsyncReadyCallback) unlock_gnome_keyring_cb, self);
+}
+
+static void
+on_default_collection_ready (GObject *source_object, GAsyncResult *result, gpointer user_data)
+{
+    CcDesktopSharingPage *self;
     g_autoptr(SecretCollection) collection = NULL;
+    gboolean locked = TRUE;
     g_autoptr(GError) error = NULL;
 
-    service = secret_service_get_sync (SECRET_SERVICE_LOAD_COLLECTIONS, NULL, &error);
-    if (!service) {
-        g_debug ("Can't connect to secret service: %s", error->message);
+    collection = secret_collection_for_alias_finish (result, &error);
+    if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
         return;
-    }
 
-    collection = secret_collection_for_alias_sync (service, SECRET_COLLECTION_DEFAULT, SECRET_COLLECTION_LOAD_ITEMS,
-                                                   NULL, &error);
+    self = CC_DESKTOP_SHARING_PAGE (user_data);
+
     if (!collection) {
         g_debug ("Can't load secret collection: %s", error ? error->message : "No such collection");
+        set_login_details_sensitive (self);
         return;
     }
 
-    collections_to_unlock = g_list_append (collections_to_unlock, collection);
-    secret_service_unlock (NULL, collections_to_unlock, self->cancellable,
-                           (GAsyncReadyCallback) unlock_gnome_keyring_cb, self);
+    g_set_object (&self->collection, collection);
+
+    locked = secret_collection_get_locked (collection);
+    g_debug ("Secret collection locked: %s", locked ? "yes" : "no");
+
+    adw_banner_set_revealed (self->keyring_infobar, locked);
+
+    /* The login details are made sensitive once the credentials are loaded */
+    if (!locked)
+        load_credentials (self);
 }
 
 static void
 setup_login_details_group (GObject *source_object, GAsyncResult *result, gpointer user_data)
 {
-    CcDesktopSharingPage *self = CC_DESKTOP_SHARING_PAGE (user_data);
-    g_autoptr(SecretCollection) collection = NULL;
-    gboolean locked = TRUE;
+    CcDesktopSharingPage *self;
     g_autoptr(SecretService) service = NULL;
     g_autoptr(GError) error = NULL;
 
     service = secret_service_get_finish (result, &error);
+    if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        return;
+
+    self = CC_DESKTOP_SHARING_PAGE (user_data);
+
     if (!service) {
         g_debug ("Can't connect to secret service: %s", error->message);
+        set_login_details_sensitive (self);
         return;
     }
 
-    collection = secret_collection_for_alias_sync (service, SECRET_COLLECTION_DEFAULT, SECRET_COLLECTION_LOAD_ITEMS,
-                                                   NULL, &error);
-    if (!collection) {
-        const char *msg = error ? error->message : "No such collection";
+    /* Only the locked state of the collection is needed, not its items */
+    secret_collection_for_alias (service, SECRET_COLLECTION_DEFAULT, SECRET_COLLECTION_NONE, self->cancellable,
+                                 on_default_collection_ready, self);
+}
+
+static void
+on_initial_service_state (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+    CcDesktopSharingPage *self;
+    CcServiceState state;
+    gboolean enabled;
+    g_autoptr(GError) error = NULL;
 
-        g_debug ("Can't load secret collection: %s", msg);
+    state = cc_get_service_state_finish (res, &error);
+    if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
         return;
-    }
 
-    locked = secret_collection_get_locked (collection);
-    g_debug ("Secret collection locked: %s", locked ? "yes" : "no");
+    /* Without a known state, leave the switch to the settings, so that
+     * the service isn't turned off behind the user's back */
+    if (error) {
+        g_warning ("Failed to get remote desktop service state: %s", error->message);
+        return;
+    }
+    if (state == CC_SERVICE_STATE_NOT_FOUND)
+        return;
 
-    adw_banner_set_revealed (self->keyring_infobar, locked);
-    gtk_widget_set_sensitive (self->login_details_group, !locked);
-    gtk_widget_set_sensitive (GTK_WIDGET (self->generate_password_button_row), !locked);
+    self = (CcDesktopSharingPage *) user_data;
 
-    if (!locked)
-        load_credentials (self);
+    /* Desktop sharing is only on if the service is enabled too */
+    enabled = g_settings_get_boolean (self->rdp_settings, "enable") && state == CC_SERVICE_STATE_ENABLED;
+    adw_switch_row_set_active (self->desktop_sharing_row, enabled);
 }
 
 static void
@@ -473,16 +623,16 @@ setup_desktop_sharing_page (CcDesktopSharingPage *self)
 
     /* Initialize credentials only when keyring is accessible.
      * See https://gitlab.gnome.org/GNOME/gnome-control-center/-/issues/3547 */
-    secret_service_get (SECRET_SERVICE_LOAD_COLLECTIONS, self->cancellable,
-                        (GAsyncReadyCallback) setup_login_details_group, self);
+    gtk_widget_set_sensitive (self->login_details_group, FALSE);
+    gtk_widget_set_sensitive (GTK_WIDGET (self->generate_password_button_row), FALSE);
+    secret_service_get (SECRET_SERVICE_NONE, self->cancellable, (GAsyncReadyCallback) setup_login_details_group,
+                        self);
 
     g_signal_connect_swapped (self->username_entry, "notify::text", G_CALLBACK (on_credentials_changed), self);
     g_signal_connect_swapped (self->password_entry, "notify::text", G_CALLBACK (on_credentials_changed), self);
     g_signal_connect_object (self->desktop_sharing_row, "notify::active",
                              G_CALLBACK (on_desktop_sharing_active_changed), self, G_CONNECT_SWAPPED);
 
-    adw_switch_row_set_active (self->desktop_sharing_row, is_desktop_sharing_enabled (self));
-
     g_settings_bind (self->rdp_settings, "enable", self->desktop_sharing_row, "active", G_SETTINGS_BIND_DEFAULT);
     g_settings_bind (self->rdp_settings, "view-only", self->remote_control_row, "active",
                      G_SETTINGS_BIND_DEFAULT | G_SETTINGS_BIND_INVERT_BOOLEAN);
@@ -490,6 +640,9 @@ setup_desktop_sharing_page (CcDesktopSharingPage *self)
                             G_BINDING_SYNC_CREATE);
     g_object_bind_property (self->password_entry, "sensitive", self->generate_password_button_row, "sensitive",
                             G_BINDING_SYNC_CREATE);
+
+    cc_get_service_state (REMOTE_DESKTOP_SERVICE, G_BUS_TYPE_SESSION, self->cancellable, on_initial_service_state,
+                          self);
 }
 
 static void
@@ -524,11 +677,16 @@ cc_desktop_sharing_page_dispose (GObject *object)
 {
     CcDesktopSharingPage *self = (CcDesktopSharingPage *) object;
 
+    /* Don't lose edits that are still waiting to be stored */
+    if (self->store_credentials_id != 0 && self->username_entry != NULL)
+        store_credentials (self);
+    g_clear_handle_id (&self->store_credentials_id, g_source_remove);
+
     g_cancellable_cancel (self->cancellable);
     g_clear_object (&self->cancellable);
 
-    g_clear_handle_id (&self->store_credentials_id, g_source_remove);
     g_clear_object (&self->certificate);
+    g_clear_object (&self->collection);
 
     g_clear_object (&self->rdp_server);
     g_clear_object (&self->rdp_settings);
@@ -36,77 +36,128 @@ cc_grd_rdp_credentials_get_schema (void)
     return &grd_rdp_credentials_schema;
 }
 
+static void
+store_credentials_cb (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+    g_autoptr(GTask) task = user_data;
+    GError *error = NULL;
+
+    if (!secret_password_store_finish (res, &error))
+        g_task_return_error (task, error);
+    else
+        g_task_return_boolean (task, TRUE);
+}
+
 void
-cc_grd_store_rdp_credentials (const gchar *username, const gchar *password, GCancellable *cancellable)
+cc_grd_store_rdp_credentials (const gchar *username, const gchar *password, GCancellable *cancellable,
+                              GAsyncReadyCallback callback, gpointer user_data)
 {
+    g_autoptr(GTask) task = NULL;
     GVariantBuilder builder;
     g_autofree gchar *credentials = NULL;
 
+    task = g_task_new (NULL, cancellable, callback, user_data);
+    g_task_set_source_tag (task, cc_grd_store_rdp_credentials);
+
     g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
     g_variant_builder_add (&builder, "{sv}", "username", g_variant_new_string (username));
     g_variant_builder_add (&builder, "{sv}", "password", g_variant_new_string (password));
     credentials = g_variant_print (g_variant_builder_end (&builder), TRUE);
 
-    secret_password_store_sync (cc_grd_rdp_credentials_get_schema (), SECRET_COLLECTION_DEFAULT,
-                                "GNOME Remote Desktop RDP credentials", credentials, NULL, NULL, NULL);
+    secret_password_store (cc_grd_rdp_credentials_get_schema (), SECRET_COLLECTION_DEFAULT,
+                           "GNOME Remote Desktop RDP credentials", credentials, cancellable, store_credentials_cb,
+                           g_steal_pointer (&task), NULL);
 }
 
-gchar *
-cc_grd_lookup_rdp_username (GCancellable *cancellable)
+gboolean
+cc_grd_store_rdp_credentials_finish (GAsyncResult *result, GError **error)
 {
-    g_autoptr(GError) error = NULL;
-    gchar *username = NULL;
+    g_return_val_if_fail (g_task_is_valid (result, NULL), FALSE);
+
+    return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+typedef struct {
+    gchar *username;
+    gchar *password;
+} RdpCredentials;
+
+static void
+rdp_credentials_free (RdpCredentials *credentials)
+{
+    g_free (credentials->username);
+    g_free (credentials->password);
+    g_free (credentials);
+}
+
+static void
+lookup_credentials_cb (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+    g_autoptr(GTask) task = user_data;
     g_autofree gchar *secret = NULL;
     g_autoptr(GVariant) variant = NULL;
+    RdpCredentials *credentials;
+    GError *error = NULL;
 
-    secret = secret_password_lookup_sync (cc_grd_rdp_credentials_get_schema (), cancellable, &error, NULL);
+    secret = secret_password_lookup_finish (res, &error);
     if (error) {
-        g_warning ("Failed to get username: %s", error->message);
-        return NULL;
+        g_task_return_error (task, error);
+        return;
     }
 
+    credentials = g_new0 (RdpCredentials, 1);
+
     if (secret == NULL) {
         g_debug ("No RDP credentials available");
-        return NULL;
+    } else {
+        variant = g_variant_parse (NULL, secret, NULL, NULL, &error);
+        if (variant == NULL) {
+            g_warning ("Invalid credentials format in the keyring: %s", error->message);
+            g_clear_error (&error);
+        } else {
+            g_variant_lookup (variant, "username", "s", &credentials->username);
+            g_variant_lookup (variant, "password", "s", &credentials->password);
+        }
     }
 
-    variant = g_variant_parse (NULL, secret, NULL, NULL, &error);
-    if (variant == NULL) {
-        g_warning ("Invalid credentials format in the keyring: %s", error->message);
-        return NULL;
-    }
+    g_task_return_pointer (task, credentials, (GDestroyNotify) rdp_credentials_free);
+}
 
-    g_variant_lookup (variant, "username", "s", &username);
+/*
+ * Looks up the stored credentials with a single search for the RDP
+ * credentials schema, without loading the other items of the keyring.
+ */
+void
+cc_grd_lookup_rdp_credentials (GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+    g_autoptr(GTask) task = NULL;
+
+    task = g_task_new (NULL, cancellable, callback, user_data);
+    g_task_set_source_tag (task, cc_grd_lookup_rdp_credentials);
 
-    return username;
+    secret_password_lookup (cc_grd_rdp_credentials_get_schema (), cancellable, lookup_credentials_cb,
+                            g_steal_pointer (&task), NULL);
 }
 
-gchar *
-cc_grd_lookup_rdp_password (GCancellable *cancellable)
+/* Missing credentials aren't an error, @out_username and @out_password are set to NULL */
+gboolean
+cc_grd_lookup_rdp_credentials_finish (GAsyncResult *result, gchar **out_username, gchar **out_password,
+                                      GError **error)
 {
-    g_autoptr(GError) error = NULL;
-    g_autofree gchar *secret = NULL;
-    gchar *password = NULL;
-    g_autoptr(GVariant) variant = NULL;
+    RdpCredentials *credentials;
 
-    secret = secret_password_lookup_sync (cc_grd_rdp_credentials_get_schema (), cancellable, &error, NULL);
-    if (error) {
-        g_warning ("Failed to get password: %s", error->message);
-        return NULL;
-    }
+    g_return_val_if_fail (g_task_is_valid (result, NULL), FALSE);
 
-    if (secret == NULL) {
-        g_debug ("No RDP credentials available");
-        return NULL;
-    }
+    credentials = g_task_propagate_pointer (G_TASK (result), error);
+    if (credentials == NULL)
+        return FALSE;
 
-    variant = g_variant_parse (NULL, secret, NULL, NULL, &error);
-    if (variant == NULL) {
-        g_warning ("Invalid credentials format in the keyring: %s", error->message);
-        return NULL;
-    }
+    if (out_username)
+        *out_username = g_steal_pointer (&credentials->username);
+    if (out_password)
+        *out_password = g_steal_pointer (&credentials->password);
 
-    g_variant_lookup (variant, "password", "s", &password);
+    rdp_credentials_free (credentials);
 
-    return password;
+    return TRUE;
 }
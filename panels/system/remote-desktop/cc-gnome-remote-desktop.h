@@ -25,9 +25,12 @@ G_BEGIN_DECLS
 
 const SecretSchema *cc_grd_rdp_credentials_get_schema (void);
 
-void cc_grd_store_rdp_credentials (const gchar *username, const gchar *password, GCancellable *cancellable);
+void cc_grd_store_rdp_credentials (const gchar *username, const gchar *password, GCancellable *cancellable,
+                                   GAsyncReadyCallback callback, gpointer user_data);
+gboolean cc_grd_store_rdp_credentials_finish (GAsyncResult *result, GError **error);
 
-gchar *cc_grd_lookup_rdp_username (GCancellable *cancellable);
-gchar *cc_grd_lookup_rdp_password (GCancellable *cancellable);
+void cc_grd_lookup_rdp_credentials (GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data);
+gboolean cc_grd_lookup_rdp_credentials_finish (GAsyncResult *result, gchar **out_username, gchar **out_password,
+                                               GError **error);
 
 G_END_DECLS
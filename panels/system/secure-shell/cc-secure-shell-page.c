@@ -99,7 +99,8 @@ cc_secure_shell_page_init (CcSecureShellPage *self)
 
     self->cancellable = g_cancellable_new ();
 
-    cc_secure_shell_get_enabled (self->secure_shell_row);
+    cc_secure_shell_get_enabled (self->cancellable, self->secure_shell_row);
+    cc_secure_shell_watch_enabled (self->cancellable, self->secure_shell_row);
     g_signal_connect_object (self->secure_shell_row, "notify::active", G_CALLBACK (secure_shell_row_activate), self,
                              G_CONNECT_SWAPPED);
 
@@ -44,51 +44,195 @@ typedef struct {
 
 G_DEFINE_AUTOPTR_CLEANUP_FUNC (CallbackData, g_free)
 
+typedef struct {
+    AdwSwitchRow *widget;
+    guint n_pending;
+    gboolean enabled;
+} GetEnabledData;
+
+static void
+get_state_cb (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+    GetEnabledData *data = user_data;
+    CcServiceState state;
+    g_autoptr(GError) error = NULL;
+
+    state = cc_get_service_state_finish (res, &error);
+    if (error && !g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        g_warning ("%s", error->message);
+
+    data->enabled |= state == CC_SERVICE_STATE_ENABLED;
+
+    if (--data->n_pending > 0)
+        return;
+
+    if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+        /* Don't let the state change trigger a new enable or disable */
+        if (adw_switch_row_get_active (data->widget) != data->enabled) {
+            g_object_set_data (G_OBJECT (data->widget), "set-from-dbus", GINT_TO_POINTER (1));
+            adw_switch_row_set_active (data->widget, data->enabled);
+        }
+        gtk_widget_set_sensitive (GTK_WIDGET (data->widget), TRUE);
+    }
+
+    g_object_unref (data->widget);
+    g_free (data);
+}
+
 void
-cc_secure_shell_get_enabled (AdwSwitchRow *widget)
+cc_secure_shell_get_enabled (GCancellable *cancellable, AdwSwitchRow *widget)
 {
-    gboolean sshd_enabled;
+    GetEnabledData *data;
 
     /* disable the switch until the current state is known */
     gtk_widget_set_sensitive (GTK_WIDGET (widget), FALSE);
 
-    sshd_enabled = cc_get_service_state (SSHD_SERVICE, G_BUS_TYPE_SYSTEM) == CC_SERVICE_STATE_ENABLED;
+    data = g_new0 (GetEnabledData, 1);
+    data->widget = g_object_ref (widget);
+
+    data->n_pending++;
+    cc_get_service_state (SSHD_SERVICE, G_BUS_TYPE_SYSTEM, cancellable, get_state_cb, data);
 
 #ifdef HAVE_SSH_SOCKET_ACTIVATION
-    sshd_enabled |= cc_get_service_state (SSHD_SOCKET, G_BUS_TYPE_SYSTEM) == CC_SERVICE_STATE_ENABLED;
+    data->n_pending++;
+    cc_get_service_state (SSHD_SOCKET, G_BUS_TYPE_SYSTEM, cancellable, get_state_cb, data);
 #endif
-
-    adw_switch_row_set_active (widget, sshd_enabled);
-    gtk_widget_set_sensitive (GTK_WIDGET (widget), TRUE);
 }
 
 static void
-enable_ssh_service (GError **error)
+service_operation_cb (GObject *source_object, GAsyncResult *res, gpointer user_data)
 {
+    g_autoptr(CallbackData) callback_data = user_data;
+    g_autoptr(GError) error = NULL;
+    gboolean success;
+
+    if (g_async_result_is_tagged (res, cc_enable_service))
+        success = cc_enable_service_finish (res, &error);
+    else
+        success = cc_disable_service_finish (res, &error);
+
+    if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        return;
+    if (!success)
+        g_warning ("%s", error->message);
+
+    /* Switch state should match service state */
+    cc_secure_shell_get_enabled (callback_data->cancellable, callback_data->widget);
+}
+
 #ifdef HAVE_SSH_SOCKET_ACTIVATION
-    g_autoptr(GError) local_error = NULL;
+static void
+enable_socket_cb (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+    g_autoptr(CallbackData) callback_data = user_data;
+    g_autoptr(GError) error = NULL;
 
-    if (cc_enable_service (SSHD_SOCKET, G_BUS_TYPE_SYSTEM, &local_error)) {
+    if (cc_enable_service_finish (res, &error)) {
         /* If the socket is available, we want to disable the service */
-        cc_disable_service (SSHD_SERVICE, G_BUS_TYPE_SYSTEM, NULL);
+        cc_disable_service (SSHD_SERVICE, G_BUS_TYPE_SYSTEM, callback_data->cancellable, service_operation_cb,
+                            g_steal_pointer (&callback_data));
+        return;
+    }
+
+    if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        return;
+
+    g_warning ("Failed to enable '%s' socket: %s", SSHD_SOCKET, error->message);
+
+    /* Switch state should match service state */
+    cc_secure_shell_get_enabled (callback_data->cancellable, callback_data->widget);
+}
+#endif
+
+static void
+enable_ssh_service (CallbackData *callback_data)
+{
+#ifdef HAVE_SSH_SOCKET_ACTIVATION
+    cc_enable_service (SSHD_SOCKET, G_BUS_TYPE_SYSTEM, callback_data->cancellable, enable_socket_cb, callback_data);
+#else
+    cc_enable_service (SSHD_SERVICE, G_BUS_TYPE_SYSTEM, callback_data->cancellable, service_operation_cb,
+                       callback_data);
+#endif
+}
+
+#ifdef HAVE_SSH_SOCKET_ACTIVATION
+static void
+disable_service_cb (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+    g_autoptr(CallbackData) callback_data = user_data;
+    g_autoptr(GError) error = NULL;
+
+    if (!cc_disable_service_finish (res, &error)) {
+        if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+            g_warning ("%s", error->message);
+            cc_secure_shell_get_enabled (callback_data->cancellable, callback_data->widget);
+        }
         return;
     }
 
-    g_warning ("Failed to enable '%s' socket: %s. Enabling '%s' service instead.", SSHD_SOCKET, local_error->message,
-               SSHD_SERVICE);
+    cc_disable_service (SSHD_SOCKET, G_BUS_TYPE_SYSTEM, callback_data->cancellable, service_operation_cb,
+                        g_steal_pointer (&callback_data));
+}
 #endif
 
-    cc_enable_service (SSHD_SERVICE, G_BUS_TYPE_SYSTEM, error);
+static void
+disable_ssh_service (CallbackData *callback_data)
+{
+#ifdef HAVE_SSH_SOCKET_ACTIVATION
+    cc_disable_service (SSHD_SERVICE, G_BUS_TYPE_SYSTEM, callback_data->cancellable, disable_service_cb,
+                        callback_data);
+#else
+    cc_disable_service (SSHD_SERVICE, G_BUS_TYPE_SYSTEM, callback_data->cancellable, service_operation_cb,
+                        callback_data);
+#endif
 }
 
 static void
-disable_ssh_service (GError **error)
+service_changed_cb (const char *service, gpointer user_data)
 {
-    if (!cc_disable_service (SSHD_SERVICE, G_BUS_TYPE_SYSTEM, error))
+    CallbackData *callback_data = user_data;
+
+    /* Changes made from here are picked up once the operation is done */
+    if (!gtk_widget_get_sensitive (GTK_WIDGET (callback_data->widget)))
         return;
 
+    cc_secure_shell_get_enabled (callback_data->cancellable, callback_data->widget);
+}
+
+static void
+watch_data_free (CallbackData *callback_data)
+{
+    g_clear_object (&callback_data->cancellable);
+    g_free (callback_data);
+}
+
+static void
+watch_service (GCancellable *cancellable, AdwSwitchRow *widget, const char *service)
+{
+    CallbackData *callback_data;
+    g_autofree char *key = NULL;
+    guint watch_id;
+
+    callback_data = g_new0 (CallbackData, 1);
+    callback_data->widget = widget;
+    callback_data->cancellable = g_object_ref (cancellable);
+
+    watch_id = cc_watch_service (service, G_BUS_TYPE_SYSTEM, service_changed_cb, callback_data,
+                                 (GDestroyNotify) watch_data_free);
+
+    /* The watch goes away along with the row */
+    key = g_strdup_printf ("%s-watch-id", service);
+    g_object_set_data_full (G_OBJECT (widget), key, GUINT_TO_POINTER (watch_id), (GDestroyNotify) cc_unwatch_service);
+}
+
+/* Keeps @widget in sync with changes made outside of Settings */
+void
+cc_secure_shell_watch_enabled (GCancellable *cancellable, AdwSwitchRow *widget)
+{
+    watch_service (cancellable, widget, SSHD_SERVICE);
+
 #ifdef HAVE_SSH_SOCKET_ACTIVATION
-    cc_disable_service (SSHD_SOCKET, G_BUS_TYPE_SYSTEM, error);
+    watch_service (cancellable, widget, SSHD_SOCKET);
 #endif
 }
 
@@ -103,12 +247,14 @@ on_permission_acquired (GObject *source_object, GAsyncResult *res, gpointer user
         g_warning ("Cannot acquire '%s' permission: %s", "org.gnome.controlcenter.remote-login-helper", error->message);
     } else {
         if (g_permission_get_allowed (permission)) {
+            /* Until the operation is done */
+            gtk_widget_set_sensitive (GTK_WIDGET (callback_data->widget), FALSE);
+
             if (adw_switch_row_get_active (callback_data->widget))
-                enable_ssh_service (&error);
+                enable_ssh_service (g_steal_pointer (&callback_data));
             else
-                disable_ssh_service (&error);
+                disable_ssh_service (g_steal_pointer (&callback_data));
 
-            /* Switch state should match service state */
             return;
         } else {
             g_warning ("Permission: %s not granted", "org.gnome.controlcenter.remote-login-helper");
@@ -117,7 +263,7 @@ on_permission_acquired (GObject *source_object, GAsyncResult *res, gpointer user
 
     /* If permission could not be acquired, or permission was not granted,
      * switch might be out of sync, update switch state */
-    cc_secure_shell_get_enabled (callback_data->widget);
+    cc_secure_shell_get_enabled (callback_data->cancellable, callback_data->widget);
 }
 
 void
@@ -23,5 +23,6 @@
 
 #include <adwaita.h>
 
-void cc_secure_shell_get_enabled (AdwSwitchRow *widget);
+void cc_secure_shell_get_enabled (GCancellable *cancellable, AdwSwitchRow *widget);
+void cc_secure_shell_watch_enabled (GCancellable *cancellable, AdwSwitchRow *widget);
 void cc_secure_shell_set_enabled (GCancellable *cancellable, AdwSwitchRow *row);
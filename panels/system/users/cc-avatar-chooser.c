@@ -31,6 +31,7 @@
 #include <gtk/gtk.h>
 
 #include "cc-avatar-chooser.h"
+#include "cc-avatar-gallery.h"
 #include "cc-crop-area.h"
 #include "user-utils.h"
 
@@ -43,7 +44,8 @@ struct _CcAvatarChooser {
     GtkWidget *crop_area;
     GtkWidget *flowbox;
 
-    GListStore *faces;
+    CcAvatarGallery *gallery;
+    GCancellable *cancellable;
 
     ActUser *user;
 };
@@ -51,32 +53,48 @@ struct _CcAvatarChooser {
 G_DEFINE_FINAL_TYPE (CcAvatarChooser, cc_avatar_chooser, GTK_TYPE_POPOVER)
 
 static void
-crop_dialog_response (CcAvatarChooser *self, gint response_id, GtkWidget *dialog)
+crop_pixbuf_ready_cb (GObject *source_object, GAsyncResult *res, gpointer user_data)
 {
+    g_autoptr(CcAvatarChooser) self = CC_AVATAR_CHOOSER (user_data);
+    GtkWidget *crop_area = GTK_WIDGET (source_object);
     g_autoptr(GdkPixbuf) pb = NULL;
-    g_autoptr(GdkPixbuf) pb2 = NULL;
     g_autoptr(GdkTexture) texture = NULL;
+    g_autoptr(GError) error = NULL;
 
-    if (response_id != GTK_RESPONSE_ACCEPT) {
-        self->crop_area = NULL;
-        gtk_window_destroy (GTK_WINDOW (dialog));
+    pb = cc_crop_area_create_pixbuf_finish (CC_CROP_AREA (crop_area), res, &error);
+    if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        return;
+
+    /* The dialog was dismissed while cropping */
+    if (self->crop_area != crop_area)
         return;
+
+    if (pb == NULL) {
+        g_warning ("Crop operation failed: %s", error->message);
+    } else {
+        texture = gdk_texture_new_for_pixbuf (pb);
+        set_user_icon_data (self->user, texture, IMAGE_SOURCE_VALUE_CUSTOM);
     }
 
-    pb = cc_crop_area_create_pixbuf (CC_CROP_AREA (self->crop_area));
-    if (!pb) {
-        g_warning ("Crop operation failed");
+    self->crop_area = NULL;
+    gtk_window_destroy (GTK_WINDOW (gtk_widget_get_root (crop_area)));
+}
+
+static void
+crop_dialog_response (CcAvatarChooser *self, gint response_id, GtkWidget *dialog)
+{
+    if (response_id != GTK_RESPONSE_ACCEPT) {
         self->crop_area = NULL;
         gtk_window_destroy (GTK_WINDOW (dialog));
         return;
     }
-    pb2 = gdk_pixbuf_scale_simple (pb, AVATAR_PIXEL_SIZE, AVATAR_PIXEL_SIZE, GDK_INTERP_BILINEAR);
-    texture = gdk_texture_new_for_pixbuf (pb2);
 
-    set_user_icon_data (self->user, texture, IMAGE_SOURCE_VALUE_CUSTOM);
+    /* Large pictures take a moment to crop, don't let the user select twice */
+    gtk_widget_set_sensitive (gtk_dialog_get_widget_for_response (GTK_DIALOG (dialog), GTK_RESPONSE_ACCEPT), FALSE);
+    gtk_widget_set_sensitive (self->crop_area, FALSE);
 
-    self->crop_area = NULL;
-    gtk_window_destroy (GTK_WINDOW (dialog));
+    cc_crop_area_create_pixbuf_async (CC_CROP_AREA (self->crop_area), AVATAR_PIXEL_SIZE, self->cancellable,
+                                      crop_pixbuf_ready_cb, g_object_ref (self));
 }
 
 static void
@@ -193,29 +211,49 @@ face_widget_activated (CcAvatarChooser *self, GtkFlowBoxChild *child)
     gtk_popover_popdown (GTK_POPOVER (self));
 }
 
+static void
+face_texture_loaded_cb (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+    g_autoptr(AdwAvatar) avatar = ADW_AVATAR (user_data);
+    g_autoptr(GdkTexture) texture = NULL;
+    g_autoptr(GError) error = NULL;
+
+    texture = cc_avatar_gallery_load_texture_finish (res, &error);
+    if (texture == NULL) {
+        if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            adw_avatar_set_icon_name (avatar, "image-missing");
+        return;
+    }
+
+    adw_avatar_set_custom_image (avatar, GDK_PAINTABLE (texture));
+}
+
+static void
+face_widget_mapped (CcAvatarChooser *self, GtkWidget *avatar)
+{
+    GFile *file = g_object_get_data (G_OBJECT (avatar), "file");
+
+    /* Only decode what is displayed, once, and off the main thread */
+    g_signal_handlers_disconnect_by_func (avatar, face_widget_mapped, self);
+    cc_avatar_gallery_load_texture_async (self->gallery, file,
+                                          AVATAR_CHOOSER_PIXEL_SIZE * gtk_widget_get_scale_factor (avatar),
+                                          self->cancellable, face_texture_loaded_cb, g_object_ref (avatar));
+}
+
 static GtkWidget *
 create_face_widget (gpointer item, gpointer user_data)
 {
-    g_autofree gchar *image_path = NULL;
-    g_autoptr(GdkTexture) source_image = NULL;
+    CcAvatarChooser *self = CC_AVATAR_CHOOSER (user_data);
     GtkWidget *child = NULL;
     GtkWidget *avatar = NULL;
 
-    image_path = g_file_get_path (G_FILE (item));
-
     avatar = adw_avatar_new (AVATAR_CHOOSER_PIXEL_SIZE, NULL, false);
     child = gtk_flow_box_child_new ();
     gtk_flow_box_child_set_child (GTK_FLOW_BOX_CHILD (child), avatar);
 
-    if (image_path) {
-        source_image = gdk_texture_new_from_filename (image_path, NULL);
-        g_object_set_data_full (G_OBJECT (avatar), "filename", g_steal_pointer (&image_path), g_free);
-    }
-    if (source_image == NULL) {
-        adw_avatar_set_icon_name (ADW_AVATAR (avatar), "image-missing");
-    } else {
-        adw_avatar_set_custom_image (ADW_AVATAR (avatar), GDK_PAINTABLE (source_image));
-    }
+    g_object_set_data_full (G_OBJECT (avatar), "filename", g_file_get_path (G_FILE (item)), g_free);
+    g_object_set_data_full (G_OBJECT (avatar), "file", g_object_ref (item), g_object_unref);
+    g_signal_connect_object (avatar, "map", G_CALLBACK (face_widget_mapped), self, G_CONNECT_SWAPPED);
 
     g_object_set (child, "accessible-role", GTK_ACCESSIBLE_ROLE_BUTTON, NULL);
     gtk_accessible_update_property (GTK_ACCESSIBLE (child), GTK_ACCESSIBLE_PROPERTY_LABEL,
@@ -262,89 +300,20 @@ get_system_facesdirs (void)
     return (GStrv) g_ptr_array_steal (facesdirs, NULL);
 }
 
-static gboolean
-add_faces_from_dirs (GListStore *faces, GStrv facesdirs, gboolean add_all)
-{
-    gboolean added_faces = FALSE;
-
-    for (guint i = 0; facesdirs[i] != NULL; i++) {
-        g_autoptr(GFile) dir = NULL;
-        g_autoptr(GFileEnumerator) enumerator = NULL;
-
-        dir = g_file_new_for_path (facesdirs[i]);
-
-        enumerator = g_file_enumerate_children (
-            dir,
-            G_FILE_ATTRIBUTE_STANDARD_NAME "," G_FILE_ATTRIBUTE_STANDARD_TYPE "," G_FILE_ATTRIBUTE_STANDARD_IS_SYMLINK
-                                           "," G_FILE_ATTRIBUTE_STANDARD_SYMLINK_TARGET
-                                           "," G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME,
-            G_FILE_QUERY_INFO_NONE, NULL, NULL);
-        if (enumerator == NULL) {
-            continue;
-        }
-
-        while (TRUE) {
-            GFile *file;
-            GFileType type;
-            const gchar *target;
-            const gchar *display_name;
-            const gchar *last_dot;
-            g_autoptr(GFileInfo) info = g_file_enumerator_next_file (enumerator, NULL, NULL);
-            if (info == NULL) {
-                break;
-            }
-
-            type = g_file_info_get_file_type (info);
-            if (type != G_FILE_TYPE_REGULAR && type != G_FILE_TYPE_SYMBOLIC_LINK) {
-                continue;
-            }
-
-            target = g_file_info_get_attribute_byte_string (info, G_FILE_ATTRIBUTE_STANDARD_SYMLINK_TARGET);
-            if (target != NULL && g_str_has_prefix (target, "legacy/")) {
-                continue;
-            }
-
-            file = g_file_get_child (dir, g_file_info_get_name (info));
-
-            display_name = g_file_info_get_display_name (info);
-            last_dot = g_strrstr (display_name, ".");
-            if (last_dot) {
-                g_object_set_data_full (G_OBJECT (file), "a11y_label",
-                                        g_strndup (display_name, last_dot - display_name), g_free);
-            } else {
-                g_object_set_data_full (G_OBJECT (file), "a11y_label", g_strdup (display_name), g_free);
-            }
-
-            g_list_store_append (faces, file);
-
-            added_faces = TRUE;
-        }
-
-        g_file_enumerator_close (enumerator, NULL, NULL);
-
-        if (added_faces && !add_all)
-            break;
-    }
-    return added_faces;
-}
-
 static void
 setup_photo_popup (CcAvatarChooser *self)
 {
-    g_auto(GStrv) settings_facesdirs = NULL;
+    g_auto(GStrv) settings_facesdirs = get_settings_facesdirs ();
+    g_auto(GStrv) system_facesdirs = get_system_facesdirs ();
 
-    self->faces = g_list_store_new (G_TYPE_FILE);
-    gtk_flow_box_bind_model (GTK_FLOW_BOX (self->flowbox), G_LIST_MODEL (self->faces), create_face_widget, self, NULL);
+    self->cancellable = g_cancellable_new ();
+    self->gallery = cc_avatar_gallery_new ((const gchar *const *) settings_facesdirs,
+                                           (const gchar *const *) system_facesdirs);
+    gtk_flow_box_bind_model (GTK_FLOW_BOX (self->flowbox), cc_avatar_gallery_get_faces (self->gallery),
+                             create_face_widget, self, NULL);
 
     g_signal_connect_object (self->flowbox, "child-activated", G_CALLBACK (face_widget_activated), self,
                              G_CONNECT_SWAPPED);
-
-    settings_facesdirs = get_settings_facesdirs ();
-
-    if (!add_faces_from_dirs (self->faces, settings_facesdirs, TRUE)) {
-        g_auto(GStrv) system_facesdirs = get_system_facesdirs ();
-        add_faces_from_dirs (self->faces, system_facesdirs, FALSE);
-    }
 }
 
 CcAvatarChooser *
@@ -358,6 +327,9 @@ cc_avatar_chooser_dispose (GObject *object)
 {
     CcAvatarChooser *self = CC_AVATAR_CHOOSER (object);
 
+    g_cancellable_cancel (self->cancellable);
+    g_clear_object (&self->cancellable);
+    g_clear_object (&self->gallery);
     g_clear_object (&self->user);
 
     G_OBJECT_CLASS (cc_avatar_chooser_parent_class)->dispose (object);
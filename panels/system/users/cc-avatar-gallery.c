@@ -0,0 +1,576 @@
+/*
+ * Copyright (C) 2026 The GNOME Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "cc-avatar-gallery.h"
+
+/* Number of faces appended to the model at once */
+#define FACES_BATCH_SIZE 64
+
+#define FACES_ATTRIBUTES                                                                                               \
+    G_FILE_ATTRIBUTE_STANDARD_NAME "," G_FILE_ATTRIBUTE_STANDARD_TYPE "," G_FILE_ATTRIBUTE_STANDARD_IS_SYMLINK        \
+                                   "," G_FILE_ATTRIBUTE_STANDARD_SYMLINK_TARGET "," G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME
+
+struct _CcAvatarGallery {
+    GObject parent_instance;
+
+    GListStore *faces;
+    /* Path → GFile in faces */
+    GHashTable *faces_by_path;
+    GPtrArray *monitors;
+
+    /* Path → CachedTexture, shared with the decoding threads */
+    GMutex textures_lock;
+    GHashTable *textures;
+
+    GStrv facesdirs;
+    GStrv fallback_dirs;
+    guint dir_index;
+    gboolean in_fallback;
+    gboolean has_faces;
+    gboolean loading;
+
+    GCancellable *cancellable;
+};
+
+G_DEFINE_FINAL_TYPE (CcAvatarGallery, cc_avatar_gallery, G_TYPE_OBJECT)
+
+enum {
+    PROP_0,
+    PROP_LOADING,
+    N_PROPS
+};
+
+static GParamSpec *properties[N_PROPS];
+
+/* A downscaled face. Every face of the gallery keeps its texture until it
+ * is removed, so scrolling back and reopening the chooser never decodes again. */
+typedef struct {
+    guint64 mtime;
+    gint size;
+    GdkTexture *texture;
+} CachedTexture;
+
+static void load_next_dir (CcAvatarGallery *self);
+
+static void
+cached_texture_free (CachedTexture *cached)
+{
+    g_object_unref (cached->texture);
+    g_free (cached);
+}
+
+static GFile *
+face_new_from_info (GFile *dir, GFileInfo *info)
+{
+    GFile *file;
+    GFileType type;
+    const gchar *target;
+    const gchar *display_name;
+    const gchar *last_dot;
+
+    type = g_file_info_get_file_type (info);
+    if (type != G_FILE_TYPE_REGULAR && type != G_FILE_TYPE_SYMBOLIC_LINK)
+        return NULL;
+
+    target = g_file_info_get_attribute_byte_string (info, G_FILE_ATTRIBUTE_STANDARD_SYMLINK_TARGET);
+    if (target != NULL && g_str_has_prefix (target, "legacy/"))
+        return NULL;
+
+    file = g_file_get_child (dir, g_file_info_get_name (info));
+
+    display_name = g_file_info_get_display_name (info);
+    last_dot = g_strrstr (display_name, ".");
+    if (last_dot) {
+        g_object_set_data_full (G_OBJECT (file), "a11y_label", g_strndup (display_name, last_dot - display_name),
+                                g_free);
+    } else {
+        g_object_set_data_full (G_OBJECT (file), "a11y_label", g_strdup (display_name), g_free);
+    }
+
+    return file;
+}
+
+static gboolean
+find_face (CcAvatarGallery *self, GFile *file, guint *position)
+{
+    g_autofree gchar *path = g_file_get_path (file);
+    GFile *face;
+
+    face = g_hash_table_lookup (self->faces_by_path, path);
+    if (face == NULL)
+        return FALSE;
+
+    return g_list_store_find (self->faces, face, position);
+}
+
+static void
+add_face (CcAvatarGallery *self, GFile *face)
+{
+    guint position;
+
+    /* Rewritten faces are replaced in place so that their thumbnail is reloaded */
+    if (find_face (self, face, &position)) {
+        g_hash_table_replace (self->faces_by_path, g_file_get_path (face), face);
+        g_list_store_splice (self->faces, position, 1, (gpointer *) &face, 1);
+        return;
+    }
+
+    g_hash_table_replace (self->faces_by_path, g_file_get_path (face), face);
+    g_list_store_append (self->faces, face);
+}
+
+static void
+remove_face (CcAvatarGallery *self, GFile *file)
+{
+    g_autofree gchar *path = g_file_get_path (file);
+    guint position;
+
+    if (!find_face (self, file, &position))
+        return;
+
+    g_list_store_remove (self->faces, position);
+    g_hash_table_remove (self->faces_by_path, path);
+
+    g_mutex_lock (&self->textures_lock);
+    g_hash_table_remove (self->textures, path);
+    g_mutex_unlock (&self->textures_lock);
+}
+
+static void
+face_info_cb (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+    GFile *file = G_FILE (source_object);
+    CcAvatarGallery *self;
+    g_autoptr(GFileInfo) info = NULL;
+    g_autoptr(GFile) dir = NULL;
+    g_autoptr(GFile) face = NULL;
+    g_autoptr(GError) error = NULL;
+
+    info = g_file_query_info_finish (file, res, &error);
+    if (info == NULL) {
+        if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED) &&
+            !g_error_matches (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND))
+            g_warning ("Failed to query avatar image: %s", error->message);
+        return;
+    }
+
+    self = CC_AVATAR_GALLERY (user_data);
+
+    dir = g_file_get_parent (file);
+    face = face_new_from_info (dir, info);
+    if (face != NULL)
+        add_face (self, face);
+}
+
+static void
+faces_dir_changed_cb (CcAvatarGallery *self, GFile *file, GFile *other_file, GFileMonitorEvent event_type)
+{
+    switch (event_type) {
+    case G_FILE_MONITOR_EVENT_RENAMED:
+        remove_face (self, file);
+        g_file_query_info_async (other_file, FACES_ATTRIBUTES, G_FILE_QUERY_INFO_NONE, G_PRIORITY_DEFAULT,
+                                 self->cancellable, face_info_cb, self);
+        break;
+    case G_FILE_MONITOR_EVENT_CREATED:
+    case G_FILE_MONITOR_EVENT_MOVED_IN:
+    case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
+        g_file_query_info_async (file, FACES_ATTRIBUTES, G_FILE_QUERY_INFO_NONE, G_PRIORITY_DEFAULT,
+                                 self->cancellable, face_info_cb, self);
+        break;
+    case G_FILE_MONITOR_EVENT_DELETED:
+    case G_FILE_MONITOR_EVENT_MOVED_OUT:
+        remove_face (self, file);
+        break;
+    default:
+        break;
+    }
+}
+
+static void
+watch_dir (CcAvatarGallery *self, GFile *dir)
+{
+    g_autoptr(GFileMonitor) monitor = NULL;
+    g_autoptr(GError) error = NULL;
+
+    monitor = g_file_monitor_directory (dir, G_FILE_MONITOR_WATCH_MOVES, self->cancellable, &error);
+    if (monitor == NULL) {
+        g_debug ("Not watching avatar directory: %s", error->message);
+        return;
+    }
+
+    g_signal_connect_object (monitor, "changed", G_CALLBACK (faces_dir_changed_cb), self, G_CONNECT_SWAPPED);
+    g_ptr_array_add (self->monitors, g_steal_pointer (&monitor));
+}
+
+static void
+set_loading (CcAvatarGallery *self, gboolean loading)
+{
+    if (self->loading == loading)
+        return;
+
+    self->loading = loading;
+    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_LOADING]);
+}
+
+static void
+next_files_cb (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+    GFileEnumerator *enumerator = G_FILE_ENUMERATOR (source_object);
+    CcAvatarGallery *self;
+    g_autoptr(GPtrArray) batch = NULL;
+    g_autoptr(GError) error = NULL;
+    GFile *dir;
+    GList *infos;
+
+    infos = g_file_enumerator_next_files_finish (enumerator, res, &error);
+    if (error != NULL && g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        return;
+
+    self = CC_AVATAR_GALLERY (user_data);
+
+    if (infos == NULL) {
+        if (error != NULL)
+            g_warning ("Failed to list avatar images: %s", error->message);
+        load_next_dir (self);
+        return;
+    }
+
+    /* Append the whole batch with a single ::items-changed */
+    dir = g_file_enumerator_get_container (enumerator);
+    batch = g_ptr_array_new_with_free_func (g_object_unref);
+    for (GList *l = infos; l != NULL; l = l->next) {
+        g_autofree gchar *path = NULL;
+        GFile *face = face_new_from_info (dir, l->data);
+
+        if (face == NULL)
+            continue;
+
+        path = g_file_get_path (face);
+        if (g_hash_table_contains (self->faces_by_path, path)) {
+            g_object_unref (face);
+            continue;
+        }
+
+        g_hash_table_insert (self->faces_by_path, g_steal_pointer (&path), face);
+        g_ptr_array_add (batch, face);
+    }
+    g_list_free_full (infos, g_object_unref);
+
+    g_list_store_splice (self->faces, g_list_model_get_n_items (G_LIST_MODEL (self->faces)), 0, batch->pdata,
+                         batch->len);
+    self->has_faces |= batch->len > 0;
+
+    g_file_enumerator_next_files_async (enumerator, FACES_BATCH_SIZE, G_PRIORITY_DEFAULT_IDLE, self->cancellable,
+                                        next_files_cb, self);
+}
+
+static void
+enumerate_children_cb (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+    GFile *dir = G_FILE (source_object);
+    CcAvatarGallery *self;
+    g_autoptr(GFileEnumerator) enumerator = NULL;
+    g_autoptr(GError) error = NULL;
+
+    enumerator = g_file_enumerate_children_finish (dir, res, &error);
+    if (enumerator == NULL && g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        return;
+
+    self = CC_AVATAR_GALLERY (user_data);
+
+    /* Missing directories are expected, most of the data dirs have no faces */
+    if (enumerator == NULL) {
+        load_next_dir (self);
+        return;
+    }
+
+    watch_dir (self, dir);
+    g_file_enumerator_next_files_async (enumerator, FACES_BATCH_SIZE, G_PRIORITY_DEFAULT_IDLE, self->cancellable,
+                                        next_files_cb, self);
+}
+
+static void
+load_next_dir (CcAvatarGallery *self)
+{
+    g_autoptr(GFile) dir = NULL;
+    GStrv dirs;
+
+    /* All the configured directories are used, but only the first system
+     * directory with faces, and only if none of the configured ones had any */
+    if (self->in_fallback && self->has_faces) {
+        set_loading (self, FALSE);
+        return;
+    }
+
+    dirs = self->in_fallback ? self->fallback_dirs : self->facesdirs;
+    if (dirs == NULL || dirs[self->dir_index] == NULL) {
+        if (!self->in_fallback && !self->has_faces && self->fallback_dirs != NULL) {
+            self->in_fallback = TRUE;
+            self->dir_index = 0;
+            load_next_dir (self);
+            return;
+        }
+
+        set_loading (self, FALSE);
+        return;
+    }
+
+    dir = g_file_new_for_path (dirs[self->dir_index++]);
+    g_file_enumerate_children_async (dir, FACES_ATTRIBUTES, G_FILE_QUERY_INFO_NONE, G_PRIORITY_DEFAULT_IDLE,
+                                     self->cancellable, enumerate_children_cb, self);
+}
+
+static void
+cc_avatar_gallery_get_property (GObject *object, guint prop_id, GValue *value, GParamSpec *pspec)
+{
+    CcAvatarGallery *self = CC_AVATAR_GALLERY (object);
+
+    switch (prop_id) {
+    case PROP_LOADING:
+        g_value_set_boolean (value, self->loading);
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+cc_avatar_gallery_dispose (GObject *object)
+{
+    CcAvatarGallery *self = CC_AVATAR_GALLERY (object);
+
+    g_cancellable_cancel (self->cancellable);
+    g_clear_object (&self->cancellable);
+    g_clear_pointer (&self->monitors, g_ptr_array_unref);
+
+    G_OBJECT_CLASS (cc_avatar_gallery_parent_class)->dispose (object);
+}
+
+static void
+cc_avatar_gallery_finalize (GObject *object)
+{
+    CcAvatarGallery *self = CC_AVATAR_GALLERY (object);
+
+    g_clear_object (&self->faces);
+    g_clear_pointer (&self->faces_by_path, g_hash_table_unref);
+    g_clear_pointer (&self->textures, g_hash_table_unref);
+    g_mutex_clear (&self->textures_lock);
+    g_clear_pointer (&self->facesdirs, g_strfreev);
+    g_clear_pointer (&self->fallback_dirs, g_strfreev);
+
+    G_OBJECT_CLASS (cc_avatar_gallery_parent_class)->finalize (object);
+}
+
+static void
+cc_avatar_gallery_class_init (CcAvatarGalleryClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+    object_class->get_property = cc_avatar_gallery_get_property;
+    object_class->dispose = cc_avatar_gallery_dispose;
+    object_class->finalize = cc_avatar_gallery_finalize;
+
+    properties[PROP_LOADING] =
+        g_param_spec_boolean ("loading", NULL, NULL, FALSE, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
+
+    g_object_class_install_properties (object_class, N_PROPS, properties);
+}
+
+static void
+cc_avatar_gallery_init (CcAvatarGallery *self)
+{
+    self->faces = g_list_store_new (G_TYPE_FILE);
+    self->faces_by_path = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    self->monitors = g_ptr_array_new_with_free_func (g_object_unref);
+    g_mutex_init (&self->textures_lock);
+    self->textures = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) cached_texture_free);
+    self->cancellable = g_cancellable_new ();
+}
+
+/**
+ * cc_avatar_gallery_new:
+ * @facesdirs: (nullable): directories whose faces are all shown
+ * @fallback_dirs: (nullable): directories tried in order when @facesdirs has no faces
+ *
+ * Lists the faces found in the given directories. The directories are read
+ * asynchronously and the faces are appended in batches, then kept up to date
+ * as files are added, rewritten and removed.
+ */
+CcAvatarGallery *
+cc_avatar_gallery_new (const gchar *const *facesdirs, const gchar *const *fallback_dirs)
+{
+    CcAvatarGallery *self = g_object_new (CC_TYPE_AVATAR_GALLERY, NULL);
+
+    self->facesdirs = g_strdupv ((GStrv) facesdirs);
+    self->fallback_dirs = g_strdupv ((GStrv) fallback_dirs);
+
+    set_loading (self, TRUE);
+    load_next_dir (self);
+
+    return self;
+}
+
+GListModel *
+cc_avatar_gallery_get_faces (CcAvatarGallery *self)
+{
+    g_return_val_if_fail (CC_IS_AVATAR_GALLERY (self), NULL);
+
+    return G_LIST_MODEL (self->faces);
+}
+
+gboolean
+cc_avatar_gallery_get_loading (CcAvatarGallery *self)
+{
+    g_return_val_if_fail (CC_IS_AVATAR_GALLERY (self), FALSE);
+
+    return self->loading;
+}
+
+typedef struct {
+    GFile *file;
+    gint size;
+} LoadTextureData;
+
+static void
+load_texture_data_free (LoadTextureData *data)
+{
+    g_object_unref (data->file);
+    g_free (data);
+}
+
+static GdkTexture *
+lookup_cached_texture (CcAvatarGallery *self, const gchar *path, guint64 mtime, gint size)
+{
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&self->textures_lock);
+    CachedTexture *cached;
+
+    cached = g_hash_table_lookup (self->textures, path);
+    if (cached == NULL || cached->mtime != mtime || cached->size != size)
+        return NULL;
+
+    return g_object_ref (cached->texture);
+}
+
+static void
+insert_cached_texture (CcAvatarGallery *self, const gchar *path, guint64 mtime, gint size, GdkTexture *texture)
+{
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&self->textures_lock);
+    CachedTexture *cached;
+
+    cached = g_new0 (CachedTexture, 1);
+    cached->mtime = mtime;
+    cached->size = size;
+    cached->texture = g_object_ref (texture);
+    g_hash_table_replace (self->textures, g_strdup (path), cached);
+}
+
+static void
+load_texture_thread (GTask *task, gpointer source_object, gpointer task_data, GCancellable *cancellable)
+{
+    CcAvatarGallery *self = source_object;
+    LoadTextureData *data = task_data;
+    g_autofree gchar *path = g_file_get_path (data->file);
+    g_autoptr(GFileInfo) info = NULL;
+    g_autoptr(GdkPixbuf) pixbuf = NULL;
+    g_autoptr(GdkPixbuf) oriented = NULL;
+    g_autoptr(GdkTexture) texture = NULL;
+    GError *error = NULL;
+    guint64 mtime;
+    gint width, height;
+    gdouble scale;
+
+    info = g_file_query_info (data->file, G_FILE_ATTRIBUTE_TIME_MODIFIED "," G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC,
+                              G_FILE_QUERY_INFO_NONE, cancellable, &error);
+    if (info == NULL) {
+        g_task_return_error (task, error);
+        return;
+    }
+
+    mtime = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED) * G_USEC_PER_SEC +
+            g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
+
+    texture = lookup_cached_texture (self, path, mtime, data->size);
+    if (texture != NULL) {
+        g_task_return_pointer (task, g_steal_pointer (&texture), g_object_unref);
+        return;
+    }
+
+    /* The avatar is cropped to a circle, so the shorter side has to cover it */
+    if (gdk_pixbuf_get_file_info (path, &width, &height) == NULL) {
+        g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_INVALID_DATA, "Unknown image format for %s", path);
+        return;
+    }
+    scale = MIN (1.0, (gdouble) data->size / MAX (1, MIN (width, height)));
+
+    /* Let the loader decode at the target size rather than scaling afterwards */
+    pixbuf = gdk_pixbuf_new_from_file_at_scale (path, MAX (1, (gint) (width * scale + 0.5)),
+                                                MAX (1, (gint) (height * scale + 0.5)), TRUE, &error);
+    if (pixbuf == NULL) {
+        g_task_return_error (task, error);
+        return;
+    }
+
+    oriented = gdk_pixbuf_apply_embedded_orientation (pixbuf);
+    texture = gdk_texture_new_for_pixbuf (oriented);
+    insert_cached_texture (self, path, mtime, data->size, texture);
+
+    g_task_return_pointer (task, g_steal_pointer (&texture), g_object_unref);
+}
+
+/**
+ * cc_avatar_gallery_load_texture_async:
+ * @self: a #CcAvatarGallery
+ * @file: the face to load
+ * @size: the size in pixels the face is displayed at
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: called when the texture is ready
+ * @user_data: data for @callback
+ *
+ * Decodes @file in a thread, downscaled so that it covers @size pixels. The
+ * textures are kept by @self for as long as the file keeps the same
+ * modification time, or until it is removed from the gallery.
+ */
+void
+cc_avatar_gallery_load_texture_async (CcAvatarGallery *self, GFile *file, gint size, GCancellable *cancellable,
+                                      GAsyncReadyCallback callback, gpointer user_data)
+{
+    g_autoptr(GTask) task = NULL;
+    LoadTextureData *data;
+
+    g_return_if_fail (CC_IS_AVATAR_GALLERY (self));
+    g_return_if_fail (G_IS_FILE (file));
+    g_return_if_fail (size > 0);
+
+    data = g_new0 (LoadTextureData, 1);
+    data->file = g_object_ref (file);
+    data->size = size;
+
+    task = g_task_new (self, cancellable, callback, user_data);
+    g_task_set_source_tag (task, cc_avatar_gallery_load_texture_async);
+    g_task_set_task_data (task, data, (GDestroyNotify) load_texture_data_free);
+    g_task_run_in_thread (task, load_texture_thread);
+}
+
+GdkTexture *
+cc_avatar_gallery_load_texture_finish (GAsyncResult *result, GError **error)
+{
+    g_return_val_if_fail (g_task_is_valid (result, NULL), NULL);
+
+    return g_task_propagate_pointer (G_TASK (result), error);
+}
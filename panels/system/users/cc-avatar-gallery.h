@@ -0,0 +1,35 @@
+/*
+ * Copyright (C) 2026 The GNOME Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <gtk/gtk.h>
+
+G_BEGIN_DECLS
+
+#define CC_TYPE_AVATAR_GALLERY (cc_avatar_gallery_get_type ())
+G_DECLARE_FINAL_TYPE (CcAvatarGallery, cc_avatar_gallery, CC, AVATAR_GALLERY, GObject)
+
+CcAvatarGallery *cc_avatar_gallery_new (const gchar *const *facesdirs, const gchar *const *fallback_dirs);
+GListModel *cc_avatar_gallery_get_faces (CcAvatarGallery *self);
+gboolean cc_avatar_gallery_get_loading (CcAvatarGallery *self);
+
+void cc_avatar_gallery_load_texture_async (CcAvatarGallery *self, GFile *file, gint size, GCancellable *cancellable,
+                                           GAsyncReadyCallback callback, gpointer user_data);
+GdkTexture *cc_avatar_gallery_load_texture_finish (GAsyncResult *result, GError **error);
+
+G_END_DECLS
@@ -49,15 +49,28 @@ typedef enum {
     RIGHT
 } Location;
 
+/* Largest side of the texture used to display big pictures */
+#define PREVIEW_SIZE 2048
+
 struct _CcCropArea {
     GtkWidget parent_instance;
 
     GdkPaintable *paintable;
 
+    /* Downscaled copy of the paintable, drawn instead of it once ready */
+    GdkTexture *preview;
+    GCancellable *preview_cancellable;
+
+    /* The picture as drawn for the current image rectangle */
+    GskRenderNode *image_node;
+    GdkRectangle image_node_rect;
+
     double scale; /* scale factor to go from paintable size to widget size */
 
     const char *current_cursor;
     Location active_region;
+    double drag_startx;
+    double drag_starty;
     double drag_offx;
     double drag_offy;
 
@@ -72,6 +85,14 @@ struct _CcCropArea {
 
 G_DEFINE_FINAL_TYPE (CcCropArea, cc_crop_area, GTK_TYPE_WIDGET);
 
+enum {
+    PROP_0,
+    PROP_PREVIEW,
+    N_PROPS
+};
+
+static GParamSpec *props[N_PROPS] = { NULL, };
+
 static void
 update_image_and_crop (CcCropArea *area)
 {
@@ -268,14 +289,15 @@ on_drag_begin (CcCropArea *area, double start_x, double start_y)
 
     area->active_region = find_location (&crop, start_x, start_y);
 
+    area->drag_startx = start_x;
+    area->drag_starty = start_y;
     area->drag_offx = 0.0;
     area->drag_offy = 0.0;
 }
 
 static void
-on_drag_update (CcCropArea *area, double offset_x, double offset_y, GtkGestureDrag *gesture)
+on_drag_update (CcCropArea *area, double offset_x, double offset_y)
 {
-    double start_x, start_y;
     int x, y, delta_x, delta_y;
     int clamped_delta_x, clamped_delta_y;
     int left, right, top, bottom;
@@ -285,11 +307,9 @@ on_drag_update (CcCropArea *area, double offset_x, double offset_y, GtkGestureDr
     int size_x, size_y;
     int min_size, max_size, wanted_size, new_size;
 
-    gtk_gesture_drag_get_start_point (gesture, &start_x, &start_y);
-
     /* Get the x, y, dx, dy in paintable coords */
-    x = (start_x + offset_x - area->image.x) / area->scale;
-    y = (start_y + offset_y - area->image.y) / area->scale;
+    x = (area->drag_startx + offset_x - area->image.x) / area->scale;
+    y = (area->drag_starty + offset_y - area->image.y) / area->scale;
     delta_x = (offset_x - area->drag_offx) / area->scale;
     delta_y = (offset_y - area->drag_offy) / area->scale;
 
@@ -441,11 +461,39 @@ on_drag_cancel (CcCropArea *area, GdkEventSequence *sequence)
 #define CORNER_LINE_LENGTH 15.0
 #define CORNER_SIZE (CORNER_LINE_LENGTH + CORNER_LINE_WIDTH / 2)
 
+static GskRenderNode *
+get_image_node (CcCropArea *area)
+{
+    g_autoptr(GtkSnapshot) snapshot = NULL;
+
+    /* Dragging only moves the overlay, the picture is drawn once per size */
+    if (area->image_node != NULL && gdk_rectangle_equal (&area->image_node_rect, &area->image))
+        return area->image_node;
+
+    g_clear_pointer (&area->image_node, gsk_render_node_unref);
+    area->image_node_rect = area->image;
+
+    snapshot = gtk_snapshot_new ();
+    if (area->preview != NULL)
+        gtk_snapshot_append_scaled_texture (snapshot, area->preview, GSK_SCALING_FILTER_TRILINEAR,
+                                            &GRAPHENE_RECT_INIT (0, 0, area->image.width, area->image.height));
+    else
+        gdk_paintable_snapshot (area->paintable, snapshot, area->image.width, area->image.height);
+    area->image_node = gtk_snapshot_free_to_node (g_steal_pointer (&snapshot));
+
+    return area->image_node;
+}
+
 static void
 cc_crop_area_snapshot (GtkWidget *widget, GtkSnapshot *snapshot)
 {
     CcCropArea *area = CC_CROP_AREA (widget);
-    cairo_t *cr;
+    g_autoptr(GskPathBuilder) builder = NULL;
+    g_autoptr(GskPath) corners = NULL;
+    g_autoptr(GskStroke) stroke = NULL;
+    GskRenderNode *image_node;
+    GskRoundedRect circle;
+    graphene_size_t radius;
     GdkRectangle crop;
 
     if (area->paintable == NULL)
@@ -458,60 +506,99 @@ cc_crop_area_snapshot (GtkWidget *widget, GtkSnapshot *snapshot)
     /* First draw the picture */
     gtk_snapshot_translate (snapshot, &GRAPHENE_POINT_INIT (area->image.x, area->image.y));
 
-    gdk_paintable_snapshot (area->paintable, snapshot, area->image.width, area->image.height);
-
-    /* Draw the cropping UI on top with cairo */
-    cr = gtk_snapshot_append_cairo (snapshot, &GRAPHENE_RECT_INIT (0, 0, area->image.width, area->image.height));
+    image_node = get_image_node (area);
+    if (image_node != NULL)
+        gtk_snapshot_append_node (snapshot, image_node);
 
     get_scaled_crop (area, &crop);
     crop.x -= area->image.x;
     crop.y -= area->image.y;
 
-    /* Draw the circle as an ellipse, to prevent rounding from jitter of the edges */
-    cairo_save (cr);
-    cairo_translate (cr, crop.x + crop.width / 2.0, crop.y + crop.height / 2.0);
-    cairo_scale (cr, crop.width / 2.0, crop.height / 2.0);
-    cairo_arc (cr, 0, 0, 1, 0, 2 * G_PI);
-    cairo_restore (cr);
-    cairo_save (cr);
-    cairo_rectangle (cr, 0, 0, area->image.width, area->image.height);
-    cairo_set_source_rgba (cr, 0, 0, 0, 0.4);
-    cairo_set_fill_rule (cr, CAIRO_FILL_RULE_EVEN_ODD);
-    cairo_fill (cr);
-    cairo_restore (cr);
+    /* Dim everything outside of the circle. It's drawn as an ellipse, to
+     * prevent rounding from jitter of the edges */
+    radius = GRAPHENE_SIZE_INIT (crop.width / 2.0, crop.height / 2.0);
+    gsk_rounded_rect_init (&circle, &GRAPHENE_RECT_INIT (crop.x, crop.y, crop.width, crop.height), &radius, &radius,
+                           &radius, &radius);
+
+    gtk_snapshot_push_mask (snapshot, GSK_MASK_MODE_INVERTED_ALPHA);
+    gtk_snapshot_push_rounded_clip (snapshot, &circle);
+    gtk_snapshot_append_color (snapshot, &(GdkRGBA) { 0, 0, 0, 1 }, &circle.bounds);
+    gtk_snapshot_pop (snapshot);
+    gtk_snapshot_pop (snapshot);
+    gtk_snapshot_append_color (snapshot, &(GdkRGBA) { 0, 0, 0, 0.4 },
+                               &GRAPHENE_RECT_INIT (0, 0, area->image.width, area->image.height));
+    gtk_snapshot_pop (snapshot);
 
     /* draw the four corners */
-    cairo_set_source_rgb (cr, 1, 1, 1);
-    cairo_set_line_width (cr, CORNER_LINE_WIDTH);
+    builder = gsk_path_builder_new ();
 
     /* top left corner */
-    cairo_move_to (cr, crop.x + CORNER_LINE_WIDTH / 2, crop.y + CORNER_SIZE);
-    cairo_rel_line_to (cr, 0, -CORNER_LINE_LENGTH);
-    cairo_rel_line_to (cr, CORNER_LINE_LENGTH, 0);
+    gsk_path_builder_move_to (builder, crop.x + CORNER_LINE_WIDTH / 2, crop.y + CORNER_SIZE);
+    gsk_path_builder_rel_line_to (builder, 0, -CORNER_LINE_LENGTH);
+    gsk_path_builder_rel_line_to (builder, CORNER_LINE_LENGTH, 0);
     /* top right corner */
-    cairo_rel_move_to (cr, crop.width - 2 * CORNER_SIZE, 0);
-    cairo_rel_line_to (cr, CORNER_LINE_LENGTH, 0);
-    cairo_rel_line_to (cr, 0, CORNER_LINE_LENGTH);
+    gsk_path_builder_rel_move_to (builder, crop.width - 2 * CORNER_SIZE, 0);
+    gsk_path_builder_rel_line_to (builder, CORNER_LINE_LENGTH, 0);
+    gsk_path_builder_rel_line_to (builder, 0, CORNER_LINE_LENGTH);
     /* bottom right corner */
-    cairo_rel_move_to (cr, 0, crop.height - 2 * CORNER_SIZE);
-    cairo_rel_line_to (cr, 0, CORNER_LINE_LENGTH);
-    cairo_rel_line_to (cr, -CORNER_LINE_LENGTH, 0);
+    gsk_path_builder_rel_move_to (builder, 0, crop.height - 2 * CORNER_SIZE);
+    gsk_path_builder_rel_line_to (builder, 0, CORNER_LINE_LENGTH);
+    gsk_path_builder_rel_line_to (builder, -CORNER_LINE_LENGTH, 0);
     /* bottom left corner */
-    cairo_rel_move_to (cr, -(crop.width - 2 * CORNER_SIZE), 0);
-    cairo_rel_line_to (cr, -CORNER_LINE_LENGTH, 0);
-    cairo_rel_line_to (cr, 0, -CORNER_LINE_LENGTH);
+    gsk_path_builder_rel_move_to (builder, -(crop.width - 2 * CORNER_SIZE), 0);
+    gsk_path_builder_rel_line_to (builder, -CORNER_LINE_LENGTH, 0);
+    gsk_path_builder_rel_line_to (builder, 0, -CORNER_LINE_LENGTH);
 
-    cairo_stroke (cr);
+    corners = gsk_path_builder_free_to_path (g_steal_pointer (&builder));
+    stroke = gsk_stroke_new (CORNER_LINE_WIDTH);
+    gtk_snapshot_append_stroke (snapshot, corners, stroke, &(GdkRGBA) { 1, 1, 1, 1 });
 
     gtk_snapshot_restore (snapshot);
 }
 
+static void
+cc_crop_area_size_allocate (GtkWidget *widget, int width, int height, int baseline)
+{
+    CcCropArea *area = CC_CROP_AREA (widget);
+
+    GTK_WIDGET_CLASS (cc_crop_area_parent_class)->size_allocate (widget, width, height, baseline);
+
+    g_clear_pointer (&area->image_node, gsk_render_node_unref);
+}
+
+static void
+cc_crop_area_get_property (GObject *object, guint prop_id, GValue *value, GParamSpec *pspec)
+{
+    CcCropArea *area = CC_CROP_AREA (object);
+
+    switch (prop_id) {
+    case PROP_PREVIEW:
+        g_value_set_object (value, area->preview);
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+cc_crop_area_dispose (GObject *object)
+{
+    CcCropArea *area = CC_CROP_AREA (object);
+
+    g_cancellable_cancel (area->preview_cancellable);
+    g_clear_object (&area->preview_cancellable);
+
+    G_OBJECT_CLASS (cc_crop_area_parent_class)->dispose (object);
+}
+
 static void
 cc_crop_area_finalize (GObject *object)
 {
     CcCropArea *area = CC_CROP_AREA (object);
 
     g_clear_object (&area->paintable);
+    g_clear_object (&area->preview);
+    g_clear_pointer (&area->image_node, gsk_render_node_unref);
 
     G_OBJECT_CLASS (cc_crop_area_parent_class)->finalize (object);
 }
@@ -522,8 +609,23 @@ cc_crop_area_class_init (CcCropAreaClass *klass)
     GObjectClass *object_class = G_OBJECT_CLASS (klass);
     GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
 
+    object_class->get_property = cc_crop_area_get_property;
+    object_class->dispose = cc_crop_area_dispose;
     object_class->finalize = cc_crop_area_finalize;
 
+    /**
+     * CcCropArea:preview:
+     *
+     * The downscaled copy of a large paintable, drawn instead of it once it
+     * is ready. %NULL while it is being created, or if the paintable is
+     * small enough to be drawn directly.
+     */
+    props[PROP_PREVIEW] = g_param_spec_object ("preview", NULL, NULL, GDK_TYPE_TEXTURE,
+                                               G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
+
+    g_object_class_install_properties (object_class, N_PROPS, props);
+
+    widget_class->size_allocate = cc_crop_area_size_allocate;
     widget_class->snapshot = cc_crop_area_snapshot;
 }
 
@@ -565,42 +667,130 @@ cc_crop_area_new (void)
     return g_object_new (CC_TYPE_CROP_AREA, NULL);
 }
 
-/**
- * cc_crop_area_create_pixbuf:
- * @area: A crop area
- *
- * Renders the area's paintable, with the cropping applied by the user, into a
- * GdkPixbuf.
- *
- * Returns: (transfer full): The cropped picture
- */
-GdkPixbuf *
-cc_crop_area_create_pixbuf (CcCropArea *area)
+typedef struct {
+    GdkTexture *texture;
+    GdkRectangle crop;
+    int size;
+} CropData;
+
+static void
+crop_data_free (CropData *data)
+{
+    g_object_unref (data->texture);
+    g_free (data);
+}
+
+static GdkTexture *
+render_paintable (GdkPaintable *paintable, GError **error)
 {
     g_autoptr(GtkSnapshot) snapshot = NULL;
     g_autoptr(GskRenderNode) node = NULL;
     g_autoptr(GskRenderer) renderer = NULL;
-    g_autoptr(GdkTexture) texture = NULL;
-    g_autoptr(GError) error = NULL;
-    graphene_rect_t viewport;
+    GdkTexture *texture;
+    int width, height;
 
-    g_return_val_if_fail (CC_IS_CROP_AREA (area), NULL);
+    width = gdk_paintable_get_intrinsic_width (paintable);
+    height = gdk_paintable_get_intrinsic_height (paintable);
 
     snapshot = gtk_snapshot_new ();
-    gdk_paintable_snapshot (area->paintable, snapshot, gdk_paintable_get_intrinsic_width (area->paintable),
-                            gdk_paintable_get_intrinsic_height (area->paintable));
+    gdk_paintable_snapshot (paintable, snapshot, width, height);
     node = gtk_snapshot_free_to_node (g_steal_pointer (&snapshot));
 
     renderer = gsk_gl_renderer_new ();
-    if (!gsk_renderer_realize (renderer, NULL, &error)) {
-        g_warning ("Couldn't realize GL renderer: %s", error->message);
+    if (!gsk_renderer_realize (renderer, NULL, error))
         return NULL;
-    }
-    viewport = GRAPHENE_RECT_INIT (area->crop.x, area->crop.y, area->crop.width, area->crop.height);
-    texture = gsk_renderer_render_texture (renderer, node, &viewport);
+    texture = gsk_renderer_render_texture (renderer, node, &GRAPHENE_RECT_INIT (0, 0, width, height));
     gsk_renderer_unrealize (renderer);
 
-    return gdk_pixbuf_get_from_texture (texture);
+    return texture;
+}
+
+static void
+create_pixbuf_thread (GTask *task, gpointer source_object, gpointer task_data, GCancellable *cancellable)
+{
+    CropData *data = task_data;
+    g_autoptr(GdkPixbuf) pixbuf = NULL;
+    g_autoptr(GdkPixbuf) cropped = NULL;
+    GdkRectangle bounds, crop;
+
+    pixbuf = gdk_pixbuf_get_from_texture (data->texture);
+
+    bounds = (GdkRectangle) { 0, 0, gdk_pixbuf_get_width (pixbuf), gdk_pixbuf_get_height (pixbuf) };
+    if (!gdk_rectangle_intersect (&data->crop, &bounds, &crop)) {
+        g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT, "Crop area is outside of the picture");
+        return;
+    }
+
+    cropped = gdk_pixbuf_new_subpixbuf (pixbuf, crop.x, crop.y, crop.width, crop.height);
+    g_task_return_pointer (task, gdk_pixbuf_scale_simple (cropped, data->size, data->size, GDK_INTERP_BILINEAR),
+                           g_object_unref);
+}
+
+/**
+ * cc_crop_area_create_pixbuf_async:
+ * @area: A crop area
+ * @size: The width and height of the resulting picture
+ * @cancellable: (nullable): A #GCancellable
+ * @callback: Called when the picture is ready
+ * @user_data: Data for @callback
+ *
+ * Crops the area's paintable as chosen by the user and scales it to @size in a
+ * thread, so that large pictures don't block the UI.
+ */
+void
+cc_crop_area_create_pixbuf_async (CcCropArea *area, int size, GCancellable *cancellable, GAsyncReadyCallback callback,
+                                  gpointer user_data)
+{
+    g_autoptr(GTask) task = NULL;
+    g_autoptr(GdkTexture) texture = NULL;
+    g_autoptr(GError) error = NULL;
+    CropData *data;
+
+    g_return_if_fail (CC_IS_CROP_AREA (area));
+    g_return_if_fail (size > 0);
+
+    task = g_task_new (area, cancellable, callback, user_data);
+    g_task_set_source_tag (task, cc_crop_area_create_pixbuf_async);
+
+    if (area->paintable == NULL) {
+        g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_NOT_INITIALIZED, "No picture to crop");
+        return;
+    }
+
+    if (GDK_IS_TEXTURE (area->paintable)) {
+        texture = g_object_ref (GDK_TEXTURE (area->paintable));
+    } else {
+        texture = render_paintable (area->paintable, &error);
+        if (texture == NULL) {
+            g_prefix_error (&error, "Couldn't realize GL renderer: ");
+            g_task_return_error (task, g_steal_pointer (&error));
+            return;
+        }
+    }
+
+    data = g_new0 (CropData, 1);
+    data->texture = g_steal_pointer (&texture);
+    data->crop = area->crop;
+    data->size = size;
+    g_task_set_task_data (task, data, (GDestroyNotify) crop_data_free);
+
+    g_task_run_in_thread (task, create_pixbuf_thread);
+}
+
+/**
+ * cc_crop_area_create_pixbuf_finish:
+ * @area: A crop area
+ * @result: The result passed to the callback
+ * @error: Return location for an error
+ *
+ * Returns: (transfer full): The cropped picture, or %NULL on error
+ */
+GdkPixbuf *
+cc_crop_area_create_pixbuf_finish (CcCropArea *area, GAsyncResult *result, GError **error)
+{
+    g_return_val_if_fail (g_task_is_valid (result, area), NULL);
+
+    return g_task_propagate_pointer (G_TASK (result), error);
 }
 
 /**
@@ -619,6 +809,64 @@ cc_crop_area_get_paintable (CcCropArea *area)
     return area->paintable;
 }
 
+static void
+create_preview_thread (GTask *task, gpointer source_object, gpointer task_data, GCancellable *cancellable)
+{
+    GdkTexture *texture = task_data;
+    g_autoptr(GdkPixbuf) pixbuf = NULL;
+    g_autoptr(GdkPixbuf) scaled = NULL;
+    int width, height;
+    double scale;
+
+    width = gdk_texture_get_width (texture);
+    height = gdk_texture_get_height (texture);
+    scale = PREVIEW_SIZE / (double) MAX (width, height);
+
+    pixbuf = gdk_pixbuf_get_from_texture (texture);
+    if (g_task_return_error_if_cancelled (task))
+        return;
+
+    scaled = gdk_pixbuf_scale_simple (pixbuf, MAX (1, width * scale), MAX (1, height * scale), GDK_INTERP_BILINEAR);
+    g_task_return_pointer (task, gdk_texture_new_for_pixbuf (scaled), g_object_unref);
+}
+
+static void
+create_preview_cb (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+    CcCropArea *area;
+    g_autoptr(GdkTexture) preview = NULL;
+    g_autoptr(GError) error = NULL;
+
+    preview = g_task_propagate_pointer (G_TASK (res), &error);
+    if (preview == NULL) {
+        if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            g_warning ("Failed to scale down picture: %s", error->message);
+        return;
+    }
+
+    area = CC_CROP_AREA (source_object);
+    g_set_object (&area->preview, preview);
+    g_clear_pointer (&area->image_node, gsk_render_node_unref);
+    g_object_notify_by_pspec (G_OBJECT (area), props[PROP_PREVIEW]);
+
+    gtk_widget_queue_draw (GTK_WIDGET (area));
+}
+
+/**
+ * cc_crop_area_get_preview:
+ * @area: A crop area
+ *
+ * Returns: (transfer none) (nullable): The downscaled copy of the paintable,
+ *   see [property@CcCropArea:preview]
+ */
+GdkTexture *
+cc_crop_area_get_preview (CcCropArea *area)
+{
+    g_return_val_if_fail (CC_IS_CROP_AREA (area), NULL);
+
+    return area->preview;
+}
+
 void
 cc_crop_area_set_paintable (CcCropArea *area, GdkPaintable *paintable)
 {
@@ -627,6 +875,27 @@ cc_crop_area_set_paintable (CcCropArea *area, GdkPaintable *paintable)
 
     g_set_object (&area->paintable, paintable);
 
+    g_cancellable_cancel (area->preview_cancellable);
+    g_clear_object (&area->preview_cancellable);
+    if (area->preview != NULL) {
+        g_clear_object (&area->preview);
+        g_object_notify_by_pspec (G_OBJECT (area), props[PROP_PREVIEW]);
+    }
+    g_clear_pointer (&area->image_node, gsk_render_node_unref);
+
+    /* Scaling a camera picture down on every frame is slow, do it once instead */
+    if (GDK_IS_TEXTURE (paintable) &&
+        MAX (gdk_texture_get_width (GDK_TEXTURE (paintable)), gdk_texture_get_height (GDK_TEXTURE (paintable))) >
+            PREVIEW_SIZE) {
+        g_autoptr(GTask) task = NULL;
+
+        area->preview_cancellable = g_cancellable_new ();
+        task = g_task_new (area, area->preview_cancellable, create_preview_cb, NULL);
+        g_task_set_source_tag (task, cc_crop_area_set_paintable);
+        g_task_set_task_data (task, g_object_ref (paintable), g_object_unref);
+        g_task_run_in_thread (task, create_preview_thread);
+    }
+
     area->scale = 0.0;
     area->image.x = 0;
     area->image.y = 0;
@@ -30,8 +30,11 @@ G_DECLARE_FINAL_TYPE (CcCropArea, cc_crop_area, CC, CROP_AREA, GtkWidget);
 GtkWidget *cc_crop_area_new (void);
 GdkPaintable *cc_crop_area_get_paintable (CcCropArea *area);
 void cc_crop_area_set_paintable (CcCropArea *area, GdkPaintable *paintable);
+GdkTexture *cc_crop_area_get_preview (CcCropArea *area);
 void cc_crop_area_set_min_size (CcCropArea *area, int width, int height);
-GdkPixbuf *cc_crop_area_create_pixbuf (CcCropArea *area);
+void cc_crop_area_create_pixbuf_async (CcCropArea *area, int size, GCancellable *cancellable, GAsyncReadyCallback callback,
+                                       gpointer user_data);
+GdkPixbuf *cc_crop_area_create_pixbuf_finish (CcCropArea *area, GAsyncResult *result, GError **error);
 
 G_END_DECLS
 
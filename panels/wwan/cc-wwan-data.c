@@ -31,10 +31,10 @@
 
 #define _GNU_SOURCE
 #include <glib/gi18n.h>
-#include <nma-mobile-providers.h>
 #include <string.h>
 
 #include "cc-wwan-data.h"
+#include "cc-wwan-provider-index.h"
 
 /**
  * @short_description: Device Internet Data Object
@@ -79,17 +79,17 @@ struct _CcWwanData {
 
     NMClient *nm_client;
     NMDevice *nm_device;
-    NMAMobileProvidersDatabase *apn_db;
-    NMAMobileProvider *apn_provider;
+    GCancellable *cancellable;
     CcWwanDataApn *default_apn;
     CcWwanDataApn *old_default_apn;
     GListStore *apn_list;
     NMActiveConnection *active_connection;
 
     gint priority;
-    gboolean data_enabled;     /* autoconnect enabled */
-    gboolean home_only;        /* Data roaming */
-    gboolean apn_list_updated; /* APN list updated from mobile-provider-info */
+    gboolean data_enabled;      /* autoconnect enabled */
+    gboolean home_only;         /* Data roaming */
+    gboolean apn_list_updated;  /* APN list updated from mobile-provider-info */
+    gboolean apn_list_updating; /* Looking up the APNs in mobile-provider-info */
 };
 
 G_DEFINE_FINAL_TYPE (CcWwanData, cc_wwan_data, G_TYPE_OBJECT)
@@ -134,7 +134,7 @@ struct _CcWwanDataApn {
     GObject parent_instance;
 
     /* Set if the APN is from the mobile-provider-info database */
-    NMAMobileAccessMethod *access_method;
+    CcWwanProviderApn *access_method;
 
     /* Set if the APN is saved in NetworkManager */
     NMConnection *nm_connection;
@@ -200,7 +200,7 @@ wwan_data_get_nm_connection (CcWwanDataApn *apn)
 }
 
 static gboolean
-wwan_data_apn_are_same (CcWwanDataApn *apn, NMAMobileAccessMethod *access_method)
+wwan_data_apn_are_same (CcWwanDataApn *apn, CcWwanProviderApn *access_method)
 {
     NMConnection *connection;
     NMSetting *setting;
@@ -211,55 +211,89 @@ wwan_data_apn_are_same (CcWwanDataApn *apn, NMAMobileAccessMethod *access_method
     connection = NM_CONNECTION (apn->remote_connection);
     setting = NM_SETTING (nm_connection_get_setting_gsm (connection));
 
-    if (g_strcmp0 (nma_mobile_access_method_get_3gpp_apn (access_method),
-                   nm_setting_gsm_get_apn (NM_SETTING_GSM (setting)))
+    if (g_strcmp0 (cc_wwan_provider_apn_get_apn (access_method), nm_setting_gsm_get_apn (NM_SETTING_GSM (setting)))
         != 0)
         return FALSE;
 
-    if (g_strcmp0 (nma_mobile_access_method_get_username (access_method),
+    if (g_strcmp0 (cc_wwan_provider_apn_get_username (access_method),
                    nm_setting_gsm_get_username (NM_SETTING_GSM (setting)))
         != 0)
         return FALSE;
 
-    if (g_strcmp0 (nma_mobile_access_method_get_password (access_method), cc_wwan_data_apn_get_password (apn)) != 0)
+    if (g_strcmp0 (cc_wwan_provider_apn_get_password (access_method), cc_wwan_data_apn_get_password (apn)) != 0)
         return FALSE;
 
     return TRUE;
 }
 
-static CcWwanDataApn *
-wwan_data_find_matching_apn (CcWwanData *self, NMAMobileAccessMethod *access_method)
+/* Returns APN name → GPtrArray of the saved CcWwanDataApn using it */
+static GHashTable *
+wwan_data_get_saved_apns_by_name (CcWwanData *self)
 {
-    CcWwanDataApn *apn;
+    GHashTable *apns_by_name;
     guint i, n_items;
 
+    apns_by_name = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, (GDestroyNotify) g_ptr_array_unref);
     n_items = g_list_model_get_n_items (G_LIST_MODEL (self->apn_list));
 
     for (i = 0; i < n_items; i++) {
-        apn = g_list_model_get_item (G_LIST_MODEL (self->apn_list), i);
+        g_autoptr(CcWwanDataApn) apn = g_list_model_get_item (G_LIST_MODEL (self->apn_list), i);
+        NMSettingGsm *setting;
+        GPtrArray *apns;
+        const gchar *apn_name;
 
-        if (apn->access_method == access_method)
-            return apn;
+        if (!apn->remote_connection)
+            continue;
 
-        if (wwan_data_apn_are_same (apn, access_method))
-            return apn;
+        setting = nm_connection_get_setting_gsm (NM_CONNECTION (apn->remote_connection));
+        if (!setting)
+            continue;
+
+        apn_name = nm_setting_gsm_get_apn (setting);
+        if (!apn_name)
+            apn_name = "";
 
-        g_object_unref (apn);
+        apns = g_hash_table_lookup (apns_by_name, apn_name);
+        if (!apns) {
+            apns = g_ptr_array_new ();
+            g_hash_table_insert (apns_by_name, (gpointer) apn_name, apns);
+        }
+        g_ptr_array_add (apns, apn);
+    }
+
+    return apns_by_name;
+}
+
+static CcWwanDataApn *
+wwan_data_find_matching_apn (GHashTable *apns_by_name, CcWwanProviderApn *access_method)
+{
+    const gchar *apn_name = cc_wwan_provider_apn_get_apn (access_method);
+    GPtrArray *apns;
+
+    apns = g_hash_table_lookup (apns_by_name, apn_name ? apn_name : "");
+    if (!apns)
+        return NULL;
+
+    for (guint i = 0; i < apns->len; i++) {
+        CcWwanDataApn *apn = apns->pdata[i];
+
+        if (wwan_data_apn_are_same (apn, access_method))
+            return g_object_ref (apn);
     }
 
     return NULL;
 }
 
 static gboolean
-wwan_data_nma_method_is_mms (NMAMobileAccessMethod *method)
+wwan_data_provider_apn_is_mms (CcWwanProviderApn *method)
 {
     const char *str;
 
-    str = nma_mobile_access_method_get_3gpp_apn (method);
+    str = cc_wwan_provider_apn_get_apn (method);
     if (str && strcasestr (str, "mms"))
         return TRUE;
 
-    str = nma_mobile_access_method_get_name (method);
+    str = cc_wwan_provider_apn_get_name (method);
     if (str && strcasestr (str, "mms"))
         return TRUE;
 
@@ -267,54 +301,70 @@ wwan_data_nma_method_is_mms (NMAMobileAccessMethod *method)
 }
 
 static void
-wwan_data_update_apn_list_db (CcWwanData *self)
+wwan_data_provider_apns_ready_cb (GObject *object, GAsyncResult *result, gpointer user_data)
 {
-    GSList *apn_methods = NULL, *l;
+    CcWwanData *self;
+    g_autoptr(GPtrArray) apn_methods = NULL;
+    g_autoptr(GHashTable) apns_by_name = NULL;
     g_autoptr(GError) error = NULL;
-    guint i = 0;
+    guint i, position = 0;
 
-    if (!self->sim || !self->operator_code || self->apn_list_updated)
-        return;
-
-    if (!self->apn_list)
+    apn_methods = cc_wwan_provider_index_lookup_finish (result, &error);
+    if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
         return;
 
-    if (!self->apn_db)
-        self->apn_db = nma_mobile_providers_database_new_sync (NULL, NULL, NULL, &error);
+    self = CC_WWAN_DATA (user_data);
+    self->apn_list_updating = FALSE;
 
     if (error) {
         g_warning ("%s", error->message);
         return;
     }
 
-    if (!self->apn_provider)
-        self->apn_provider = nma_mobile_providers_database_lookup_3gpp_mcc_mnc (self->apn_db, self->operator_code);
-
-    if (self->apn_provider)
-        apn_methods = nma_mobile_provider_get_methods (self->apn_provider);
+    if (!self->apn_list)
+        return;
 
     self->apn_list_updated = TRUE;
 
-    for (l = apn_methods; l; l = l->next, i++) {
+    apns_by_name = wwan_data_get_saved_apns_by_name (self);
+
+    for (i = 0; i < apn_methods->len; i++) {
+        CcWwanProviderApn *method = apn_methods->pdata[i];
         g_autoptr(CcWwanDataApn) apn = NULL;
 
         /* We don’t list MMS APNs */
-        if (wwan_data_nma_method_is_mms (l->data))
+        if (wwan_data_provider_apn_is_mms (method))
             continue;
 
-        apn = wwan_data_find_matching_apn (self, l->data);
+        apn = wwan_data_find_matching_apn (apns_by_name, method);
 
         /* Prepend the item in order */
         if (!apn) {
             apn = cc_wwan_data_apn_new ();
-            apn->access_method = l->data;
-            g_list_store_insert (self->apn_list, i, apn);
+            g_list_store_insert (self->apn_list, position++, apn);
         }
 
-        apn->access_method = l->data;
+        g_clear_pointer (&apn->access_method, cc_wwan_provider_apn_unref);
+        apn->access_method = cc_wwan_provider_apn_ref (method);
     }
 }
 
+static void
+wwan_data_update_apn_list_db (CcWwanData *self)
+{
+    if (!self->sim || !self->operator_code || self->apn_list_updated || self->apn_list_updating)
+        return;
+
+    if (!self->apn_list)
+        return;
+
+    self->apn_list_updating = TRUE;
+
+    /* Parsing the provider database takes a while, it's indexed in a thread */
+    cc_wwan_provider_index_lookup_async (NULL, self->operator_code, self->cancellable,
+                                         wwan_data_provider_apns_ready_cb, self);
+}
+
 static void
 wwan_data_update_apn_list (CcWwanData *self)
 {
@@ -413,6 +463,8 @@ cc_wwan_data_dispose (GObject *object)
 {
     CcWwanData *self = (CcWwanData *) object;
 
+    g_cancellable_cancel (self->cancellable);
+    g_clear_object (&self->cancellable);
     g_clear_pointer (&self->sim_id, g_free);
     g_clear_pointer (&self->operator_code, g_free);
     g_clear_error (&self->error);
@@ -421,7 +473,6 @@ cc_wwan_data_dispose (GObject *object)
     g_clear_object (&self->mm_object);
     g_clear_object (&self->nm_client);
     g_clear_object (&self->active_connection);
-    g_clear_object (&self->apn_db);
 
     G_OBJECT_CLASS (cc_wwan_data_parent_class)->dispose (object);
 }
@@ -446,6 +497,7 @@ cc_wwan_data_class_init (CcWwanDataClass *klass)
 static void
 cc_wwan_data_init (CcWwanData *self)
 {
+    self->cancellable = g_cancellable_new ();
     self->home_only = TRUE;
     self->priority = CC_WWAN_APN_PRIORITY_LOW;
 }
@@ -590,10 +642,10 @@ wwan_data_update_apn (CcWwanData *self, CcWwanDataApn *apn, NMConnection *connec
                   (gint64) route_metric, NULL);
 
     if (apn->access_method && !apn->remote_connection) {
-        name = nma_mobile_access_method_get_name (apn->access_method);
-        username = nma_mobile_access_method_get_username (apn->access_method);
-        password = nma_mobile_access_method_get_password (apn->access_method);
-        apn_name = nma_mobile_access_method_get_3gpp_apn (apn->access_method);
+        name = cc_wwan_provider_apn_get_name (apn->access_method);
+        username = cc_wwan_provider_apn_get_username (apn->access_method);
+        password = cc_wwan_provider_apn_get_password (apn->access_method);
+        apn_name = cc_wwan_provider_apn_get_apn (apn->access_method);
     } else {
         return;
     }
@@ -1034,7 +1086,7 @@ cc_wwan_data_apn_finalize (GObject *object)
     CcWwanDataApn *apn = CC_WWAN_DATA_APN (object);
 
     wwan_data_apn_reset (apn);
-    g_clear_pointer (&apn->access_method, nma_mobile_access_method_unref);
+    g_clear_pointer (&apn->access_method, cc_wwan_provider_apn_unref);
 
     G_OBJECT_CLASS (cc_wwan_data_parent_class)->finalize (object);
 }
@@ -1074,7 +1126,7 @@ cc_wwan_data_apn_get_name (CcWwanDataApn *apn)
         return nm_connection_get_id (NM_CONNECTION (apn->remote_connection));
 
     if (apn->access_method)
-        return nma_mobile_access_method_get_name (apn->access_method);
+        return cc_wwan_provider_apn_get_name (apn->access_method);
 
     return "";
 }
@@ -1128,7 +1180,7 @@ cc_wwan_data_apn_get_apn (CcWwanDataApn *apn)
     }
 
     if (apn->access_method)
-        return nma_mobile_access_method_get_3gpp_apn (apn->access_method);
+        return cc_wwan_provider_apn_get_apn (apn->access_method);
 
     return NULL;
 }
@@ -1184,7 +1236,7 @@ cc_wwan_data_apn_get_username (CcWwanDataApn *apn)
     }
 
     if (apn->access_method)
-        return nma_mobile_access_method_get_username (apn->access_method);
+        return cc_wwan_provider_apn_get_username (apn->access_method);
 
     return NULL;
 }
@@ -1253,7 +1305,7 @@ cc_wwan_data_apn_get_password (CcWwanDataApn *apn)
     }
 
     if (apn->access_method)
-        return nma_mobile_access_method_get_password (apn->access_method);
+        return cc_wwan_provider_apn_get_password (apn->access_method);
 
     return NULL;
 }
@@ -0,0 +1,477 @@
+/* cc-wwan-provider-index.c
+ *
+ * Copyright 2026 The GNOME Project
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#undef G_LOG_DOMAIN
+#define G_LOG_DOMAIN "cc-wwan-provider-index"
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <glib/gstdio.h>
+#include <nma-mobile-providers.h>
+#include <string.h>
+
+#include "cc-wwan-provider-index.h"
+
+/**
+ * @short_description: Mobile broadband provider lookup
+ *
+ * mobile-broadband-provider-info ships a few megabytes of XML, and
+ * parsing it takes long enough to be noticed.  The APNs of every
+ * MCC/MNC are extracted from it once and kept in the user cache as
+ * a GVariant array sorted by MCC/MNC, which is mapped and binary
+ * searched from a thread.  The index is rebuilt whenever the
+ * database is modified.
+ */
+
+/* Bump when the layout of PROVIDER_INDEX_TYPE changes */
+#define PROVIDER_INDEX_VERSION 1
+/* Version, database path, database mtime, sorted MCC/MNC → APNs (name, APN, username, password) */
+#define PROVIDER_INDEX_TYPE "(qsta(sa(msmsmsms)))"
+
+#define PROVIDER_INDEX_ENTRIES 3
+
+struct _CcWwanProviderApn {
+    gatomicrefcount ref_count;
+
+    gchar *name;
+    gchar *apn;
+    gchar *username;
+    gchar *password;
+};
+
+G_DEFINE_BOXED_TYPE (CcWwanProviderApn, cc_wwan_provider_apn, cc_wwan_provider_apn_ref, cc_wwan_provider_apn_unref)
+
+/* Shared by every lookup, protected by index_lock */
+static GMutex index_lock;
+static GVariant *shared_index;
+
+CcWwanProviderApn *
+cc_wwan_provider_apn_ref (CcWwanProviderApn *apn)
+{
+    g_return_val_if_fail (apn != NULL, NULL);
+
+    g_atomic_ref_count_inc (&apn->ref_count);
+
+    return apn;
+}
+
+void
+cc_wwan_provider_apn_unref (CcWwanProviderApn *apn)
+{
+    g_return_if_fail (apn != NULL);
+
+    if (!g_atomic_ref_count_dec (&apn->ref_count))
+        return;
+
+    g_free (apn->name);
+    g_free (apn->apn);
+    g_free (apn->username);
+    g_free (apn->password);
+    g_free (apn);
+}
+
+const gchar *
+cc_wwan_provider_apn_get_name (CcWwanProviderApn *apn)
+{
+    g_return_val_if_fail (apn != NULL, NULL);
+
+    return apn->name;
+}
+
+const gchar *
+cc_wwan_provider_apn_get_apn (CcWwanProviderApn *apn)
+{
+    g_return_val_if_fail (apn != NULL, NULL);
+
+    return apn->apn;
+}
+
+const gchar *
+cc_wwan_provider_apn_get_username (CcWwanProviderApn *apn)
+{
+    g_return_val_if_fail (apn != NULL, NULL);
+
+    return apn->username;
+}
+
+const gchar *
+cc_wwan_provider_apn_get_password (CcWwanProviderApn *apn)
+{
+    g_return_val_if_fail (apn != NULL, NULL);
+
+    return apn->password;
+}
+
+static gchar *
+index_file_get (void)
+{
+    return g_build_filename (g_get_user_cache_dir (), "gnome-control-center", "wwan-providers", NULL);
+}
+
+static gboolean
+get_database_mtime (const gchar *database, guint64 *mtime, GCancellable *cancellable, GError **error)
+{
+    g_autoptr(GFile) file = g_file_new_for_path (database);
+    g_autoptr(GFileInfo) info = NULL;
+
+    info = g_file_query_info (file, G_FILE_ATTRIBUTE_TIME_MODIFIED "," G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC,
+                              G_FILE_QUERY_INFO_NONE, cancellable, error);
+    if (!info)
+        return FALSE;
+
+    *mtime = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED) * G_USEC_PER_SEC +
+             g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
+
+    return TRUE;
+}
+
+static gint
+compare_entries (gconstpointer a, gconstpointer b)
+{
+    const gchar *mcc_mnc_a, *mcc_mnc_b;
+
+    g_variant_get_child (*(GVariant **) a, 0, "&s", &mcc_mnc_a);
+    g_variant_get_child (*(GVariant **) b, 0, "&s", &mcc_mnc_b);
+
+    return strcmp (mcc_mnc_a, mcc_mnc_b);
+}
+
+static GVariant *
+build_provider_methods (NMAMobileProvider *provider)
+{
+    GVariantBuilder methods;
+
+    g_variant_builder_init (&methods, G_VARIANT_TYPE ("a(msmsmsms)"));
+    for (GSList *l = nma_mobile_provider_get_methods (provider); l; l = l->next) {
+        if (nma_mobile_access_method_get_family (l->data) != NMA_MOBILE_FAMILY_3GPP)
+            continue;
+
+        g_variant_builder_add (&methods, "(msmsmsms)", nma_mobile_access_method_get_name (l->data),
+                               nma_mobile_access_method_get_3gpp_apn (l->data),
+                               nma_mobile_access_method_get_username (l->data),
+                               nma_mobile_access_method_get_password (l->data));
+    }
+
+    return g_variant_ref_sink (g_variant_builder_end (&methods));
+}
+
+static GVariant *
+build_index (const gchar *database, guint64 mtime, GCancellable *cancellable, GError **error)
+{
+    NMAMobileProvidersDatabase *db;
+    g_autoptr(GHashTable) seen = NULL;
+    g_autoptr(GPtrArray) entries = NULL;
+    GVariantBuilder builder;
+    GHashTableIter iter;
+    gpointer value;
+
+    db = nma_mobile_providers_database_new_sync (NULL, database, cancellable, error);
+    if (!db)
+        return NULL;
+
+    seen = g_hash_table_new (g_str_hash, g_str_equal);
+    entries = g_ptr_array_new_with_free_func ((GDestroyNotify) g_variant_unref);
+
+    g_hash_table_iter_init (&iter, nma_mobile_providers_database_get_countries (db));
+    while (g_hash_table_iter_next (&iter, NULL, &value)) {
+        for (GSList *l = nma_country_info_get_providers (value); l; l = l->next) {
+            const gchar **mcc_mncs = nma_mobile_provider_get_3gpp_mcc_mnc (l->data);
+            g_autoptr(GVariant) methods = NULL;
+
+            if (!mcc_mncs)
+                continue;
+
+            methods = build_provider_methods (l->data);
+
+            /* Like the database, the first provider found for an MCC/MNC wins */
+            for (guint i = 0; mcc_mncs[i]; i++) {
+                if (!g_hash_table_add (seen, (gpointer) mcc_mncs[i]))
+                    continue;
+
+                g_ptr_array_add (entries, g_variant_ref_sink (g_variant_new ("(s@a(msmsmsms))", mcc_mncs[i], methods)));
+            }
+        }
+    }
+
+    g_ptr_array_sort (entries, compare_entries);
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(sa(msmsmsms))"));
+    for (guint i = 0; i < entries->len; i++)
+        g_variant_builder_add_value (&builder, entries->pdata[i]);
+
+    g_clear_pointer (&seen, g_hash_table_unref);
+    g_object_unref (db);
+
+    return g_variant_ref_sink (
+        g_variant_new (PROVIDER_INDEX_TYPE, (guint16) PROVIDER_INDEX_VERSION, database, mtime, &builder));
+}
+
+static gboolean
+index_is_current (GVariant *index, const gchar *database, guint64 mtime)
+{
+    const gchar *index_database;
+    guint16 version;
+    guint64 index_mtime;
+
+    g_variant_get_child (index, 0, "q", &version);
+    g_variant_get_child (index, 1, "&s", &index_database);
+    g_variant_get_child (index, 2, "t", &index_mtime);
+
+    return version == PROVIDER_INDEX_VERSION && g_str_equal (index_database, database) && index_mtime == mtime;
+}
+
+static GVariant *
+load_index (const gchar *index_file, const gchar *database, guint64 mtime)
+{
+    g_autoptr(GMappedFile) mapped = NULL;
+    g_autoptr(GBytes) bytes = NULL;
+    g_autoptr(GVariant) variant = NULL;
+
+    mapped = g_mapped_file_new (index_file, FALSE, NULL);
+    if (!mapped)
+        return NULL;
+
+    /* The file is not trusted, GVariant will substitute defaults for malformed data */
+    bytes = g_mapped_file_get_bytes (mapped);
+    variant = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE (PROVIDER_INDEX_TYPE), bytes, FALSE));
+
+    if (!index_is_current (variant, database, mtime)) {
+        g_debug ("Mobile provider index %s is out of date", index_file);
+        return NULL;
+    }
+
+    return g_steal_pointer (&variant);
+}
+
+static void
+save_index (GVariant *index, const gchar *index_file)
+{
+    g_autoptr(GError) error = NULL;
+    g_autofree gchar *dir = NULL;
+
+    dir = g_path_get_dirname (index_file);
+    if (g_mkdir_with_parents (dir, 0700) < 0) {
+        g_debug ("Could not create directory '%s': %m", dir);
+        return;
+    }
+
+    if (!g_file_set_contents (index_file, g_variant_get_data (index), g_variant_get_size (index), &error))
+        g_debug ("Could not write mobile provider index: %s", error->message);
+}
+
+static GVariant *
+get_index (const gchar *database, GCancellable *cancellable, GError **error)
+{
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&index_lock);
+    g_autofree gchar *index_file = NULL;
+    g_autoptr(GVariant) index = NULL;
+    guint64 mtime;
+
+    if (!get_database_mtime (database, &mtime, cancellable, error))
+        return NULL;
+
+    if (shared_index && index_is_current (shared_index, database, mtime))
+        return g_variant_ref (shared_index);
+
+    index_file = index_file_get ();
+    index = load_index (index_file, database, mtime);
+    if (!index) {
+        index = build_index (database, mtime, cancellable, error);
+        if (!index)
+            return NULL;
+
+        save_index (index, index_file);
+    }
+
+    g_clear_pointer (&shared_index, g_variant_unref);
+    shared_index = g_variant_ref (index);
+
+    return g_steal_pointer (&index);
+}
+
+/* Returns the position of the first entry not sorting before @mcc_mnc */
+static gsize
+find_entry (GVariant *entries, const gchar *mcc_mnc)
+{
+    gsize low = 0, high = g_variant_n_children (entries);
+
+    while (low < high) {
+        gsize mid = low + (high - low) / 2;
+        g_autoptr(GVariant) entry = g_variant_get_child_value (entries, mid);
+        const gchar *key;
+
+        g_variant_get_child (entry, 0, "&s", &key);
+        if (strcmp (key, mcc_mnc) < 0)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    return low;
+}
+
+static GVariant *
+lookup_entry (GVariant *entries, const gchar *mcc_mnc)
+{
+    g_autoptr(GVariant) entry = NULL;
+    gsize position;
+    const gchar *key;
+
+    position = find_entry (entries, mcc_mnc);
+    if (position >= g_variant_n_children (entries))
+        return NULL;
+
+    entry = g_variant_get_child_value (entries, position);
+    g_variant_get_child (entry, 0, "&s", &key);
+    if (strcmp (key, mcc_mnc) != 0)
+        return NULL;
+
+    return g_variant_get_child_value (entry, 1);
+}
+
+static GVariant *
+lookup_methods (GVariant *entries, const gchar *mcc_mnc)
+{
+    g_autofree gchar *padded = NULL;
+    g_autofree gchar *unpadded = NULL;
+    GVariant *methods;
+    gsize len = strlen (mcc_mnc);
+
+    /* Like the database, a 2-digit MNC is the same as that MNC padded with a
+     * zero to 3 digits, and the 3-digit entry wins if both exist */
+    if (len == 5) {
+        padded = g_strdup_printf ("%.3s0%s", mcc_mnc, mcc_mnc + 3);
+        unpadded = g_strdup (mcc_mnc);
+    } else if (len == 6 && mcc_mnc[3] == '0') {
+        padded = g_strdup (mcc_mnc);
+        unpadded = g_strdup_printf ("%.3s%s", mcc_mnc, mcc_mnc + 4);
+    } else {
+        return lookup_entry (entries, mcc_mnc);
+    }
+
+    methods = lookup_entry (entries, padded);
+    if (methods)
+        return methods;
+
+    return lookup_entry (entries, unpadded);
+}
+
+typedef struct {
+    gchar *database;
+    gchar *mcc_mnc;
+} LookupData;
+
+static void
+lookup_data_free (LookupData *data)
+{
+    g_free (data->database);
+    g_free (data->mcc_mnc);
+    g_free (data);
+}
+
+static void
+lookup_thread (GTask *task, gpointer source_object, gpointer task_data, GCancellable *cancellable)
+{
+    LookupData *data = task_data;
+    g_autoptr(GVariant) index = NULL;
+    g_autoptr(GVariant) entries = NULL;
+    g_autoptr(GVariant) methods = NULL;
+    g_autoptr(GPtrArray) apns = NULL;
+    GError *error = NULL;
+    GVariantIter iter;
+    const gchar *name, *apn_name, *username, *password;
+
+    index = get_index (data->database, cancellable, &error);
+    if (!index) {
+        g_task_return_error (task, error);
+        return;
+    }
+
+    apns = g_ptr_array_new_with_free_func ((GDestroyNotify) cc_wwan_provider_apn_unref);
+
+    entries = g_variant_get_child_value (index, PROVIDER_INDEX_ENTRIES);
+    methods = lookup_methods (entries, data->mcc_mnc);
+    if (!methods) {
+        g_task_return_pointer (task, g_steal_pointer (&apns), (GDestroyNotify) g_ptr_array_unref);
+        return;
+    }
+
+    g_variant_iter_init (&iter, methods);
+    while (g_variant_iter_next (&iter, "(m&sm&sm&sm&s)", &name, &apn_name, &username, &password)) {
+        CcWwanProviderApn *apn = g_new0 (CcWwanProviderApn, 1);
+
+        g_atomic_ref_count_init (&apn->ref_count);
+        apn->name = g_strdup (name);
+        apn->apn = g_strdup (apn_name);
+        apn->username = g_strdup (username);
+        apn->password = g_strdup (password);
+        g_ptr_array_add (apns, apn);
+    }
+
+    g_task_return_pointer (task, g_steal_pointer (&apns), (GDestroyNotify) g_ptr_array_unref);
+}
+
+/**
+ * cc_wwan_provider_index_lookup_async:
+ * @database: (nullable): The serviceproviders.xml to use, or %NULL for the system one
+ * @mcc_mnc: The MCC/MNC of the operator
+ * @cancellable: (nullable): A #GCancellable
+ * @callback: Called once the APNs are known
+ * @user_data: Data for @callback
+ *
+ * Looks up the 3GPP APNs of the operator in a thread.  The first
+ * lookup may have to index the provider database.
+ */
+void
+cc_wwan_provider_index_lookup_async (const gchar *database, const gchar *mcc_mnc, GCancellable *cancellable,
+                                     GAsyncReadyCallback callback, gpointer user_data)
+{
+    g_autoptr(GTask) task = NULL;
+    LookupData *data;
+
+    g_return_if_fail (mcc_mnc != NULL);
+
+    data = g_new0 (LookupData, 1);
+    data->database = g_strdup (database ? database : MOBILE_BROADBAND_PROVIDER_INFO_DATABASE);
+    data->mcc_mnc = g_strdup (mcc_mnc);
+
+    task = g_task_new (NULL, cancellable, callback, user_data);
+    g_task_set_source_tag (task, cc_wwan_provider_index_lookup_async);
+    g_task_set_task_data (task, data, (GDestroyNotify) lookup_data_free);
+    g_task_run_in_thread (task, lookup_thread);
+}
+
+/**
+ * cc_wwan_provider_index_lookup_finish:
+ * @result: The result passed to the callback
+ * @error: Return location for an error
+ *
+ * Returns: (transfer container) (element-type CcWwanProviderApn): The APNs
+ *   of the operator, in database order, or %NULL on error
+ */
+GPtrArray *
+cc_wwan_provider_index_lookup_finish (GAsyncResult *result, GError **error)
+{
+    g_return_val_if_fail (g_task_is_valid (result, NULL), NULL);
+
+    return g_task_propagate_pointer (G_TASK (result), error);
+}
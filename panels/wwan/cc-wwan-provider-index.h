@@ -0,0 +1,44 @@
+/* cc-wwan-provider-index.h
+ *
+ * Copyright 2026 The GNOME Project
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+typedef struct _CcWwanProviderApn CcWwanProviderApn;
+
+#define CC_TYPE_WWAN_PROVIDER_APN (cc_wwan_provider_apn_get_type ())
+GType cc_wwan_provider_apn_get_type (void) G_GNUC_CONST;
+CcWwanProviderApn *cc_wwan_provider_apn_ref (CcWwanProviderApn *apn);
+void cc_wwan_provider_apn_unref (CcWwanProviderApn *apn);
+const gchar *cc_wwan_provider_apn_get_name (CcWwanProviderApn *apn);
+const gchar *cc_wwan_provider_apn_get_apn (CcWwanProviderApn *apn);
+const gchar *cc_wwan_provider_apn_get_username (CcWwanProviderApn *apn);
+const gchar *cc_wwan_provider_apn_get_password (CcWwanProviderApn *apn);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (CcWwanProviderApn, cc_wwan_provider_apn_unref)
+
+void cc_wwan_provider_index_lookup_async (const gchar *database, const gchar *mcc_mnc, GCancellable *cancellable,
+                                          GAsyncReadyCallback callback, gpointer user_data);
+GPtrArray *cc_wwan_provider_index_lookup_finish (GAsyncResult *result, GError **error);
+
+G_END_DECLS
@@ -24,6 +24,17 @@ struct _CcObjectStorage {
     GObject parent_instance;
 
     GHashTable *id_to_object;
+
+    /* D-Bus proxies being created in the background, by key */
+    GHashTable *pending_proxies;
+    GMutex pending_lock;
+    GCond pending_cond;
+
+    /* D-Bus proxies panels will need, warmed up when idle */
+    GPtrArray *declared_proxies;
+    guint warm_up_id;
+
+    CcObjectStorageProxyStats proxy_stats;
 };
 
 G_DEFINE_FINAL_TYPE (CcObjectStorage, cc_object_storage, G_TYPE_OBJECT)
@@ -31,6 +42,38 @@ G_DEFINE_FINAL_TYPE (CcObjectStorage, cc_object_storage, G_TYPE_OBJECT)
 /* Singleton instance */
 static CcObjectStorage *_instance = NULL;
 
+/* A D-Bus proxy being created in a thread. Synchronous callers wait for it
+ * on pending_cond, asynchronous ones are queued as waiters. */
+typedef struct {
+    GDBusProxy *proxy;
+    GError *error;
+    gboolean done;
+    GPtrArray *waiters;
+} PendingProxy;
+
+static PendingProxy *
+pending_proxy_new (void)
+{
+    PendingProxy *pending = g_atomic_rc_box_new0 (PendingProxy);
+    pending->waiters = g_ptr_array_new_with_free_func (g_object_unref);
+
+    return pending;
+}
+
+static void
+pending_proxy_clear (PendingProxy *pending)
+{
+    g_clear_object (&pending->proxy);
+    g_clear_error (&pending->error);
+    g_clear_pointer (&pending->waiters, g_ptr_array_unref);
+}
+
+static void
+pending_proxy_unref (PendingProxy *pending)
+{
+    g_atomic_rc_box_release_full (pending, (GDestroyNotify) pending_proxy_clear);
+}
+
 /* GTask API to create a new D-Bus proxy */
 typedef struct {
     GBusType bus_type;
@@ -38,7 +81,9 @@ typedef struct {
     gchar *name;
     gchar *path;
     gchar *interface;
-    gboolean cached;
+    PendingProxy *pending;
+    /* Completes a waiter as soon as its cancellable fires */
+    GSource *cancelled_source;
 } TaskData;
 
 static TaskData *
@@ -50,7 +95,8 @@ task_data_new (GBusType bus_type, GDBusProxyFlags flags, const gchar *name, cons
     data->name = g_strdup (name);
     data->path = g_strdup (path);
     data->interface = g_strdup (interface);
-    data->cached = FALSE;
+    data->pending = NULL;
+    data->cancelled_source = NULL;
 
     return data;
 }
@@ -61,25 +107,163 @@ task_data_free (TaskData *data)
     g_free (data->name);
     g_free (data->path);
     g_free (data->interface);
+    g_clear_pointer (&data->pending, pending_proxy_unref);
+    g_clear_pointer (&data->cancelled_source, g_source_unref);
     g_slice_free (TaskData, data);
 }
 
+static gchar *
+get_proxy_key (const gchar *name, const gchar *path, const gchar *interface)
+{
+    return g_strdup_printf ("CcObjectStorage::dbus-proxy(%s,%s,%s)", name, path, interface);
+}
+
 static void
 create_dbus_proxy_in_thread_cb (GTask *task, gpointer source_object, gpointer task_data, GCancellable *cancellable)
 {
+    CcObjectStorage *self = source_object;
     g_autoptr(GDBusProxy) proxy = NULL;
     g_autoptr(GError) local_error = NULL;
     TaskData *data = task_data;
 
     proxy = g_dbus_proxy_new_for_bus_sync (data->bus_type, data->flags, NULL, data->name, data->path, data->interface,
-                                           cancellable, &local_error);
+                                           NULL, &local_error);
 
-    if (local_error) {
-        g_task_return_error (task, g_steal_pointer (&local_error));
-        return;
+    /* Wake up the synchronous callers waiting for it */
+    g_mutex_lock (&self->pending_lock);
+    data->pending->proxy = g_steal_pointer (&proxy);
+    data->pending->error = g_steal_pointer (&local_error);
+    data->pending->done = TRUE;
+    g_cond_broadcast (&self->pending_cond);
+    g_mutex_unlock (&self->pending_lock);
+
+    g_task_return_boolean (task, TRUE);
+}
+
+static void
+pending_proxy_cancelled_cb (GCancellable *cancellable, CcObjectStorage *self)
+{
+    /* Wake up the synchronous callers so they can give up */
+    g_mutex_lock (&self->pending_lock);
+    g_cond_broadcast (&self->pending_cond);
+    g_mutex_unlock (&self->pending_lock);
+}
+
+static void
+on_pending_proxy_created_cb (GObject *source_object, GAsyncResult *result, gpointer user_data)
+{
+    CcObjectStorage *self = CC_OBJECT_STORAGE (source_object);
+    g_autofree gchar *key = NULL;
+    PendingProxy *pending;
+    TaskData *data;
+
+    data = g_task_get_task_data (G_TASK (result));
+    pending = data->pending;
+    key = get_proxy_key (data->name, data->path, data->interface);
+
+    if (pending->proxy) {
+        g_debug ("Finished creating D-Bus proxy for %s in the background", key);
+
+        self->proxy_stats.created++;
+
+        /* A synchronous caller may have waited for it and stored it already */
+        if (!g_hash_table_contains (self->id_to_object, key))
+            g_hash_table_insert (self->id_to_object, g_strdup (key), g_object_ref (pending->proxy));
+    } else {
+        g_debug ("Failed to create D-Bus proxy for %s in the background: %s", key, pending->error->message);
     }
 
-    g_task_return_pointer (task, g_object_ref (g_steal_pointer (&proxy)), g_object_unref);
+    for (guint i = 0; i < pending->waiters->len; i++) {
+        GTask *waiter = g_ptr_array_index (pending->waiters, i);
+        TaskData *waiter_data = g_task_get_task_data (waiter);
+
+        if (waiter_data->cancelled_source) {
+            g_source_destroy (waiter_data->cancelled_source);
+            g_clear_pointer (&waiter_data->cancelled_source, g_source_unref);
+        }
+
+        if (pending->proxy)
+            g_task_return_pointer (waiter, g_object_ref (pending->proxy), g_object_unref);
+        else
+            g_task_return_error (waiter, g_error_copy (pending->error));
+    }
+    g_ptr_array_set_size (pending->waiters, 0);
+
+    g_hash_table_remove (self->pending_proxies, key);
+}
+
+static gboolean
+waiter_cancelled_cb (GCancellable *cancellable, gpointer user_data)
+{
+    GTask *task = G_TASK (user_data);
+    CcObjectStorage *self = g_task_get_source_object (task);
+    TaskData *data = g_task_get_task_data (task);
+    g_autofree gchar *key = NULL;
+    PendingProxy *pending;
+    guint index;
+
+    g_clear_pointer (&data->cancelled_source, g_source_unref);
+
+    /* Answer it now rather than once the shared proxy is created */
+    key = get_proxy_key (data->name, data->path, data->interface);
+    pending = g_hash_table_lookup (self->pending_proxies, key);
+    if (pending && g_ptr_array_find (pending->waiters, task, &index)) {
+        g_task_return_error_if_cancelled (task);
+        g_ptr_array_remove_index (pending->waiters, index);
+    }
+
+    return G_SOURCE_REMOVE;
+}
+
+static PendingProxy *
+start_pending_proxy (CcObjectStorage *self, const gchar *key, GBusType bus_type, GDBusProxyFlags flags,
+                     const gchar *name, const gchar *path, const gchar *interface)
+{
+    g_autoptr(GTask) task = NULL;
+    PendingProxy *pending;
+    TaskData *data;
+
+    pending = pending_proxy_new ();
+    g_hash_table_insert (self->pending_proxies, g_strdup (key), pending);
+
+    data = task_data_new (bus_type, flags, name, path, interface);
+    data->pending = g_atomic_rc_box_acquire (pending);
+
+    task = g_task_new (self, NULL, on_pending_proxy_created_cb, NULL);
+    g_task_set_source_tag (task, start_pending_proxy);
+    g_task_set_task_data (task, data, (GDestroyNotify) task_data_free);
+    g_task_run_in_thread (task, create_dbus_proxy_in_thread_cb);
+
+    return pending;
+}
+
+static gboolean
+warm_up_next_dbus_proxy_cb (gpointer user_data)
+{
+    CcObjectStorage *self = CC_OBJECT_STORAGE (user_data);
+
+    /* Start one proxy per idle iteration, to keep the UI responsive */
+    while (self->declared_proxies->len > 0) {
+        TaskData *data = g_ptr_array_index (self->declared_proxies, 0);
+        g_autofree gchar *key = get_proxy_key (data->name, data->path, data->interface);
+        gboolean started = FALSE;
+
+        if (!g_hash_table_contains (self->id_to_object, key) && !g_hash_table_contains (self->pending_proxies, key)) {
+            g_debug ("Warming up D-Bus proxy for %s", key);
+
+            start_pending_proxy (self, key, data->bus_type, data->flags, data->name, data->path, data->interface);
+            started = TRUE;
+        }
+
+        g_ptr_array_remove_index (self->declared_proxies, 0);
+
+        if (started)
+            return G_SOURCE_CONTINUE;
+    }
+
+    self->warm_up_id = 0;
+
+    return G_SOURCE_REMOVE;
 }
 
 static void
@@ -89,7 +273,16 @@ cc_object_storage_finalize (GObject *object)
 
     g_debug ("Destroying cached objects");
 
+    g_debug ("D-Bus proxies: %u hits, %u misses, %u created in the background, %" G_GINT64_FORMAT " µs blocked",
+             self->proxy_stats.hits, self->proxy_stats.misses, self->proxy_stats.created,
+             self->proxy_stats.blocked_time);
+
+    g_clear_handle_id (&self->warm_up_id, g_source_remove);
     g_clear_pointer (&self->id_to_object, g_hash_table_destroy);
+    g_clear_pointer (&self->pending_proxies, g_hash_table_destroy);
+    g_clear_pointer (&self->declared_proxies, g_ptr_array_unref);
+    g_mutex_clear (&self->pending_lock);
+    g_cond_clear (&self->pending_cond);
 
     G_OBJECT_CLASS (cc_object_storage_parent_class)->finalize (object);
 }
@@ -106,6 +299,11 @@ static void
 cc_object_storage_init (CcObjectStorage *self)
 {
     self->id_to_object = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+    self->pending_proxies =
+        g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) pending_proxy_unref);
+    self->declared_proxies = g_ptr_array_new_with_free_func ((GDestroyNotify) task_data_free);
+    g_mutex_init (&self->pending_lock);
+    g_cond_init (&self->pending_cond);
 }
 
 /**
@@ -194,7 +392,8 @@ cc_object_storage_get_object (const gchar *key)
  * stores it in the cache, and returns the newly created proxy.
  *
  * If a proxy with that signature is already created, it will be used
- * instead of creating a new one.
+ * instead of creating a new one. If it is being created in the background,
+ * this waits for it until @cancellable is cancelled.
  *
  * Returns: (transfer full)(nullable): the new #GDBusProxy.
  */
@@ -206,6 +405,8 @@ cc_object_storage_create_dbus_proxy_sync (GBusType bus_type, GDBusProxyFlags fla
     g_autoptr(GDBusProxy) proxy = NULL;
     g_autoptr(GError) local_error = NULL;
     g_autofree gchar *key = NULL;
+    PendingProxy *pending;
+    gint64 blocked_time;
 
     g_assert (CC_IS_OBJECT_STORAGE (_instance));
     g_assert (name && *name);
@@ -213,17 +414,56 @@ cc_object_storage_create_dbus_proxy_sync (GBusType bus_type, GDBusProxyFlags fla
     g_assert (interface && *interface);
     g_assert (!error || !*error);
 
-    key = g_strdup_printf ("CcObjectStorage::dbus-proxy(%s,%s,%s)", name, path, interface);
+    key = get_proxy_key (name, path, interface);
 
     g_debug ("Creating D-Bus proxy for %s", key);
 
     /* Check if a DBus proxy with that signature is already available; if it is,
      * return that instead of a new one.
      */
-    if (g_hash_table_contains (_instance->id_to_object, key))
+    if (g_hash_table_contains (_instance->id_to_object, key)) {
+        _instance->proxy_stats.hits++;
         return cc_object_storage_get_object (key);
+    }
+
+    blocked_time = g_get_monotonic_time ();
+
+    pending = g_hash_table_lookup (_instance->pending_proxies, key);
+    if (pending) {
+        gulong cancelled_id = 0;
+
+        /* It is already on its way, which is still faster than starting over */
+        if (cancellable) {
+            cancelled_id = g_cancellable_connect (cancellable, G_CALLBACK (pending_proxy_cancelled_cb), _instance,
+                                                  NULL);
+        }
+
+        g_mutex_lock (&_instance->pending_lock);
+        while (!pending->done && !g_cancellable_is_cancelled (cancellable))
+            g_cond_wait (&_instance->pending_cond, &_instance->pending_lock);
+        g_mutex_unlock (&_instance->pending_lock);
+
+        /* Must not be called with the lock held, the handler takes it */
+        g_cancellable_disconnect (cancellable, cancelled_id);
+
+        if (!g_cancellable_set_error_if_cancelled (cancellable, &local_error)) {
+            _instance->proxy_stats.hits++;
+
+            if (pending->proxy)
+                proxy = g_object_ref (pending->proxy);
+            else
+                local_error = g_error_copy (pending->error);
+        }
+    } else {
+        _instance->proxy_stats.misses++;
 
-    proxy = g_dbus_proxy_new_for_bus_sync (bus_type, flags, NULL, name, path, interface, cancellable, &local_error);
+        proxy = g_dbus_proxy_new_for_bus_sync (bus_type, flags, NULL, name, path, interface, cancellable, &local_error);
+    }
+
+    blocked_time = g_get_monotonic_time () - blocked_time;
+    _instance->proxy_stats.blocked_time += blocked_time;
+
+    g_debug ("Blocked %" G_GINT64_FORMAT " µs on D-Bus proxy %s", blocked_time, key);
 
     if (local_error) {
         g_propagate_error (error, g_steal_pointer (&local_error));
@@ -249,11 +489,8 @@ cc_object_storage_create_dbus_proxy_sync (GBusType bus_type, GDBusProxyFlags fla
  * Asynchronously create a #GDBusProxy with @name, @path and @interface.
  *
  * If a proxy with that signature is already created, it will be used instead of
- * creating a new one.
- *
- * It is a programming error to create the an identical proxy while asynchronously
- * creating one. Not cancelling this operation will result in an assertion failure
- * when calling cc_object_storage_create_dbus_proxy_finish().
+ * creating a new one. Creating a proxy that is already being created, be it by
+ * another call to this function or in the background, waits for that one.
  */
 void
 cc_object_storage_create_dbus_proxy (GBusType bus_type, GDBusProxyFlags flags, const gchar *name, const gchar *path,
@@ -262,7 +499,7 @@ cc_object_storage_create_dbus_proxy (GBusType bus_type, GDBusProxyFlags flags, c
 {
     g_autoptr(GTask) task = NULL;
     g_autofree gchar *key = NULL;
-    TaskData *data = NULL;
+    PendingProxy *pending;
 
     g_assert (CC_IS_OBJECT_STORAGE (_instance));
     g_assert (name && *name);
@@ -270,30 +507,41 @@ cc_object_storage_create_dbus_proxy (GBusType bus_type, GDBusProxyFlags flags, c
     g_assert (interface && *interface);
     g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
 
-    data = task_data_new (bus_type, flags, name, path, interface);
-
     task = g_task_new (_instance, cancellable, callback, user_data);
     g_task_set_source_tag (task, cc_object_storage_create_dbus_proxy);
-    g_task_set_task_data (task, data, (GDestroyNotify) task_data_free);
+    g_task_set_task_data (task, task_data_new (bus_type, flags, name, path, interface),
+                          (GDestroyNotify) task_data_free);
 
     /* Check if the D-Bus proxy is already created */
-    key = g_strdup_printf ("CcObjectStorage::dbus-proxy(%s,%s,%s)", name, path, interface);
+    key = get_proxy_key (name, path, interface);
 
     g_debug ("Asynchronously creating D-Bus proxy for %s", key);
 
     if (g_hash_table_contains (_instance->id_to_object, key)) {
-        /* Mark this GTask as already cached, so we can call the right assertions
-         * on the callback
-         * */
-        data->cached = TRUE;
-
         g_debug ("Found in cache the D-Bus proxy %s", key);
 
+        _instance->proxy_stats.hits++;
+
         g_task_return_pointer (task, cc_object_storage_get_object (key), g_object_unref);
         return;
     }
 
-    g_task_run_in_thread (task, create_dbus_proxy_in_thread_cb);
+    pending = g_hash_table_lookup (_instance->pending_proxies, key);
+    if (pending) {
+        _instance->proxy_stats.hits++;
+    } else {
+        _instance->proxy_stats.misses++;
+        pending = start_pending_proxy (_instance, key, bus_type, flags, name, path, interface);
+    }
+
+    if (cancellable) {
+        TaskData *data = g_task_get_task_data (task);
+
+        data->cancelled_source = g_cancellable_source_new (cancellable);
+        g_task_attach_source (task, data->cancelled_source, (GSourceFunc) waiter_cancelled_cb);
+    }
+
+    g_ptr_array_add (pending->waiters, g_steal_pointer (&task));
 }
 
 /**
@@ -303,11 +551,7 @@ cc_object_storage_create_dbus_proxy (GBusType bus_type, GDBusProxyFlags flags, c
  *
  * Finishes a D-Bus proxy creation started by cc_object_storage_create_dbus_proxy().
  *
- * Synchronously create a #GDBusProxy with @name, @path and @interface,
- * stores it in the cache, and returns the newly created proxy.
- *
- * If a proxy with that signature is already created, it will be used
- * instead of creating a new one.
+ * The proxy is stored in the cache by the time this is called.
  *
  * Returns: (transfer full)(nullable): the new #GDBusProxy.
  */
@@ -328,40 +572,77 @@ cc_object_storage_create_dbus_proxy_finish (GAsyncResult *result, GError **error
     task_data = g_task_get_task_data (task);
     g_assert (task_data != NULL);
 
-    key = g_strdup_printf ("CcObjectStorage::dbus-proxy(%s,%s,%s)", task_data->name, task_data->path,
-                           task_data->interface);
+    key = get_proxy_key (task_data->name, task_data->path, task_data->interface);
 
     g_debug ("Finished creating D-Bus proxy for %s", key);
 
     /* Retrieve the newly created proxy */
     proxy = g_task_propagate_pointer (task, &local_error);
 
-    /* If the proxy is not cached, do the normal caching routine */
     if (local_error) {
         g_propagate_error (error, g_steal_pointer (&local_error));
         return NULL;
     }
 
-    /* Either we have the object stored right when trying to create it - in which case,
-     * task_data->cached == TRUE and cc_object_storage_has_object (key) == TRUE - or we
-     * didn't have a cached proxy before, and we shouldn't have it now.
-     *
-     * This is to force consumers of this code to *never* try to create the same D-Bus
-     * proxy asynchronously multiple times. Trying to do so is considered a programming
-     * error.
-     */
-    g_assert (task_data->cached == cc_object_storage_has_object (key));
+    return g_steal_pointer (&proxy);
+}
 
-    /* If the proxy is already cached, destroy the newly created and used the cached proxy
-     * instead.
-     */
-    if (cc_object_storage_has_object (key))
-        return cc_object_storage_get_object (key);
+/**
+ * cc_object_storage_declare_dbus_proxy:
+ * @bus_type: the bus the proxy is on
+ * @flags: the D-Bus proxy flags
+ * @name: the D-Bus name
+ * @path: the D-Bus object path
+ * @interface: the D-Bus interface name
+ *
+ * Declares that a #GDBusProxy with @name, @path and @interface will be
+ * needed, so that it can be created in the background before anybody asks
+ * for it. See cc_object_storage_warm_dbus_proxies().
+ *
+ * Panels usually declare their proxies from their static init function.
+ */
+void
+cc_object_storage_declare_dbus_proxy (GBusType bus_type, GDBusProxyFlags flags, const gchar *name, const gchar *path,
+                                      const gchar *interface)
+{
+    g_assert (CC_IS_OBJECT_STORAGE (_instance));
+    g_assert (name && *name);
+    g_assert (path && *path);
+    g_assert (interface && *interface);
 
-    /* Store the newly created D-Bus proxy */
-    cc_object_storage_add_object (key, proxy);
+    g_ptr_array_add (_instance->declared_proxies, task_data_new (bus_type, flags, name, path, interface));
+}
 
-    return g_steal_pointer (&proxy);
+/**
+ * cc_object_storage_warm_dbus_proxies:
+ *
+ * Creates the D-Bus proxies declared with cc_object_storage_declare_dbus_proxy()
+ * in the background, one at a time whenever the main loop is idle.
+ */
+void
+cc_object_storage_warm_dbus_proxies (void)
+{
+    g_assert (CC_IS_OBJECT_STORAGE (_instance));
+
+    if (_instance->warm_up_id != 0 || _instance->declared_proxies->len == 0)
+        return;
+
+    _instance->warm_up_id = g_idle_add_full (G_PRIORITY_LOW, warm_up_next_dbus_proxy_cb, _instance, NULL);
+}
+
+/**
+ * cc_object_storage_get_proxy_stats:
+ * @stats: (out): return location for the statistics
+ *
+ * Retrieves how D-Bus proxy requests were served so far.
+ */
+void
+cc_object_storage_get_proxy_stats (CcObjectStorageProxyStats *stats)
+{
+    g_assert (CC_IS_OBJECT_STORAGE (_instance));
+    g_assert (stats != NULL);
+
+    *stats = _instance->proxy_stats;
 }
 
 /**
@@ -29,6 +29,20 @@ G_BEGIN_DECLS
 #define CC_OBJECT_MMMANAGER "CcObjectStorage::mm-manager"
 #define CC_OBJECT_PWQ_SETTINGS "CcObjectStorage::pw-quality-settings"
 
+/**
+ * CcObjectStorageProxyStats:
+ * @hits: D-Bus proxy requests served by a stored or already pending proxy
+ * @misses: D-Bus proxy requests that had to create a new proxy
+ * @created: D-Bus proxies created in the background
+ * @blocked_time: microseconds synchronous requests spent waiting for a proxy
+ */
+typedef struct {
+    guint hits;
+    guint misses;
+    guint created;
+    gint64 blocked_time;
+} CcObjectStorageProxyStats;
+
 #define CC_TYPE_OBJECT_STORAGE (cc_object_storage_get_type ())
 G_DECLARE_FINAL_TYPE (CcObjectStorage, cc_object_storage, CC, OBJECT_STORAGE, GObject);
 gboolean cc_object_storage_has_object (const gchar *key);
@@ -47,6 +61,13 @@ void cc_object_storage_create_dbus_proxy (GBusType bus_type, GDBusProxyFlags fla
 
 gpointer cc_object_storage_create_dbus_proxy_finish (GAsyncResult *result, GError **error);
 
+void cc_object_storage_declare_dbus_proxy (GBusType bus_type, GDBusProxyFlags flags, const gchar *name,
+                                           const gchar *path, const gchar *interface);
+
+void cc_object_storage_warm_dbus_proxies (void);
+
+void cc_object_storage_get_proxy_stats (CcObjectStorageProxyStats *stats);
+
 void cc_object_storage_initialize (void);
 
 void cc_object_storage_destroy (void);
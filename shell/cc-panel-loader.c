@@ -65,10 +65,15 @@ extern GType cc_wwan_panel_get_type (void);
 #endif /* BUILD_WWAN */
 
 /* Static init functions */
+#ifdef BUILD_BLUETOOTH
+extern void cc_bluetooth_panel_static_init_func (void);
+#endif /* BUILD_BLUETOOTH */
 #ifdef BUILD_NETWORK
 extern void cc_wifi_panel_static_init_func (void);
 #endif /* BUILD_NETWORK */
+extern void cc_printers_panel_static_init_func (void);
 extern void cc_sharing_panel_static_init_func (void);
+extern void cc_system_panel_static_init_func (void);
 #ifdef BUILD_WACOM
 extern void cc_wacom_panel_static_init_func (void);
 #endif /* BUILD_WACOM */
@@ -88,7 +93,7 @@ static CcPanelLoaderVtable default_panels[] = {
     PANEL_TYPE ("applications", cc_applications_panel_get_type, NULL),
     PANEL_TYPE ("background", cc_background_panel_get_type, NULL),
 #ifdef BUILD_BLUETOOTH
-    PANEL_TYPE ("bluetooth", cc_bluetooth_panel_get_type, NULL),
+    PANEL_TYPE ("bluetooth", cc_bluetooth_panel_get_type, cc_bluetooth_panel_static_init_func),
 #endif
     PANEL_TYPE ("color", cc_color_panel_get_type, NULL),
     PANEL_TYPE ("display", cc_display_panel_get_type, NULL),
@@ -102,12 +107,12 @@ static CcPanelLoaderVtable default_panels[] = {
     PANEL_TYPE ("notifications", cc_notifications_panel_get_type, NULL),
     PANEL_TYPE ("online-accounts", cc_online_accounts_panel_get_type, NULL),
     PANEL_TYPE ("power", cc_power_panel_get_type, NULL),
-    PANEL_TYPE ("printers", cc_printers_panel_get_type, NULL),
+    PANEL_TYPE ("printers", cc_printers_panel_get_type, cc_printers_panel_static_init_func),
     PANEL_TYPE ("privacy", cc_privacy_panel_get_type, NULL),
     PANEL_TYPE ("search", cc_search_panel_get_type, NULL),
     PANEL_TYPE ("sharing", cc_sharing_panel_get_type, cc_sharing_panel_static_init_func),
     PANEL_TYPE ("sound", cc_sound_panel_get_type, NULL),
-    PANEL_TYPE ("system", cc_system_panel_get_type, NULL),
+    PANEL_TYPE ("system", cc_system_panel_get_type, cc_system_panel_static_init_func),
     PANEL_TYPE ("universal-access", cc_ua_panel_get_type, NULL),
 #ifdef BUILD_WACOM
     PANEL_TYPE ("wacom", cc_wacom_panel_get_type, cc_wacom_panel_static_init_func),
@@ -35,6 +35,7 @@
 #include <time.h>
 
 #include "cc-application.h"
+#include "cc-object-storage.h"
 #include "cc-panel-list.h"
 #include "cc-panel-loader.h"
 #include "cc-panel.h"
@@ -674,6 +675,10 @@ cc_window_constructed (GObject *object)
      * activated from commandline parameter or from DBus method */
     g_idle_add_once ((GSourceOnceFunc) maybe_load_last_panel, self);
 
+    /* Then create the D-Bus proxies the panels declared in their static
+     * init functions, so opening them does not block on D-Bus */
+    cc_object_storage_warm_dbus_proxies ();
+
     G_OBJECT_CLASS (cc_window_parent_class)->constructed (object);
 }
 
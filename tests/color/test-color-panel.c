@@ -0,0 +1,240 @@
+/*
+ * Copyright (C) 2026 The GNOME Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define G_LOG_DOMAIN "test-color-panel"
+
+#include <adwaita.h>
+
+#include "cc-color-device.h"
+#include "cc-color-panel.h"
+#include "cc-color-profile.h"
+#include "cc-object-storage.h"
+
+/* Must match test-color-panel.py */
+#define N_DEVICES 20
+#define N_PROFILES_PER_DEVICE 5
+
+#define COLORD_BUS_NAME "org.freedesktop.ColorManager"
+#define COLORD_OBJECT_PATH "/org/freedesktop/ColorManager"
+
+typedef struct {
+    GtkWindow *window;
+    CcPanel *panel;
+    GDBusConnection *bus;
+} ColorPanelFixture;
+
+static void
+fixture_set_up (ColorPanelFixture *fixture, gconstpointer user_data)
+{
+    g_autoptr(GError) error = NULL;
+
+    fixture->bus = g_bus_get_sync (G_BUS_TYPE_SYSTEM, NULL, &error);
+    g_assert_no_error (error);
+
+    fixture->window = GTK_WINDOW (gtk_window_new ());
+    fixture->panel = g_object_ref_sink (g_object_new (CC_TYPE_COLOR_PANEL, NULL));
+    gtk_window_set_child (fixture->window, GTK_WIDGET (fixture->panel));
+    gtk_window_present (fixture->window);
+}
+
+static void
+fixture_tear_down (ColorPanelFixture *fixture, gconstpointer user_data)
+{
+    g_clear_pointer (&fixture->window, gtk_window_destroy);
+    g_clear_object (&fixture->panel);
+    g_clear_object (&fixture->bus);
+}
+
+static guint
+count_rows (GtkWidget *widget, GType type)
+{
+    GtkWidget *child;
+    guint n_rows = G_TYPE_CHECK_INSTANCE_TYPE (widget, type) ? 1 : 0;
+
+    for (child = gtk_widget_get_first_child (widget); child != NULL; child = gtk_widget_get_next_sibling (child))
+        n_rows += count_rows (child, type);
+
+    return n_rows;
+}
+
+static guint
+count_device_rows (ColorPanelFixture *fixture)
+{
+    return count_rows (GTK_WIDGET (fixture->panel), CC_TYPE_COLOR_DEVICE);
+}
+
+static guint
+count_profile_rows (ColorPanelFixture *fixture)
+{
+    return count_rows (GTK_WIDGET (fixture->panel), CC_TYPE_COLOR_PROFILE);
+}
+
+static void
+wait_for_rows (ColorPanelFixture *fixture, guint n_devices, guint n_profiles)
+{
+    while (count_device_rows (fixture) != n_devices || count_profile_rows (fixture) != n_profiles)
+        g_main_context_iteration (NULL, TRUE);
+}
+
+static void
+flush_colord (ColorPanelFixture *fixture)
+{
+    g_autoptr(GVariant) result = NULL;
+    g_autoptr(GError) error = NULL;
+
+    /* The mock answers in order, so the replies to the panel are queued once this one is back */
+    result = g_dbus_connection_call_sync (fixture->bus, COLORD_BUS_NAME, COLORD_OBJECT_PATH, COLORD_BUS_NAME,
+                                          "GetSensors", NULL, NULL, G_DBUS_CALL_FLAGS_NONE, -1, NULL, &error);
+    g_assert_no_error (error);
+
+    while (g_main_context_iteration (NULL, FALSE))
+        ;
+}
+
+static void
+emit_device_signal (ColorPanelFixture *fixture, const char *name, const char *device_id)
+{
+    g_autofree gchar *object_path = g_strdup_printf (COLORD_OBJECT_PATH "/devices/%s", device_id);
+    g_autoptr(GVariant) result = NULL;
+    g_autoptr(GError) error = NULL;
+    GVariantBuilder args;
+
+    g_variant_builder_init (&args, G_VARIANT_TYPE ("av"));
+    g_variant_builder_add (&args, "v", g_variant_new_object_path (object_path));
+
+    result = g_dbus_connection_call_sync (fixture->bus, COLORD_BUS_NAME, COLORD_OBJECT_PATH,
+                                          "org.freedesktop.DBus.Mock", "EmitSignal",
+                                          g_variant_new ("(sssav)", COLORD_BUS_NAME, name, "o", &args), NULL,
+                                          G_DBUS_CALL_FLAGS_NONE, -1, NULL, &error);
+    g_assert_no_error (error);
+}
+
+static void
+test_rows_created (ColorPanelFixture *fixture, gconstpointer user_data)
+{
+    g_autoptr(GTimer) timer = g_timer_new ();
+
+    /* The profile shared by every device gets a row under each of them */
+    wait_for_rows (fixture, N_DEVICES, N_DEVICES * N_PROFILES_PER_DEVICE);
+    g_test_minimized_result (g_timer_elapsed (timer, NULL), "Time to load %u devices with %u profiles each",
+                             N_DEVICES, N_PROFILES_PER_DEVICE);
+
+    /* Nothing is added twice once everything settled */
+    flush_colord (fixture);
+    g_assert_cmpuint (count_device_rows (fixture), ==, N_DEVICES);
+    g_assert_cmpuint (count_profile_rows (fixture), ==, N_DEVICES * N_PROFILES_PER_DEVICE);
+}
+
+static void
+test_device_removed (ColorPanelFixture *fixture, gconstpointer user_data)
+{
+    wait_for_rows (fixture, N_DEVICES, N_DEVICES * N_PROFILES_PER_DEVICE);
+
+    /* The device goes away along with its profile rows */
+    emit_device_signal (fixture, "DeviceRemoved", "dev0");
+    wait_for_rows (fixture, N_DEVICES - 1, (N_DEVICES - 1) * N_PROFILES_PER_DEVICE);
+}
+
+typedef struct {
+    ColorPanelFixture *fixture;
+    gboolean stalled;
+    guint n_ticks;
+    GTimer *frame_timer;
+    gdouble longest_frame;
+} StallData;
+
+static void
+stall_cb (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+    StallData *data = user_data;
+    g_autoptr(GVariant) result = NULL;
+    g_autoptr(GError) error = NULL;
+
+    result = g_dbus_connection_call_finish (G_DBUS_CONNECTION (source_object), res, &error);
+    g_assert_no_error (error);
+
+    data->stalled = FALSE;
+}
+
+static gboolean
+stall_tick_cb (gpointer user_data)
+{
+    StallData *data = user_data;
+
+    if (!data->stalled)
+        return G_SOURCE_CONTINUE;
+
+    /* The panel keeps its rows and keeps running while the daemon is busy */
+    g_assert_cmpuint (count_device_rows (data->fixture), >=, N_DEVICES);
+    data->n_ticks++;
+
+    data->longest_frame = MAX (data->longest_frame, g_timer_elapsed (data->frame_timer, NULL));
+    g_timer_start (data->frame_timer);
+
+    return G_SOURCE_CONTINUE;
+}
+
+static void
+test_stalled_daemon (ColorPanelFixture *fixture, gconstpointer user_data)
+{
+    g_autoptr(GTimer) frame_timer = g_timer_new ();
+    StallData data = { fixture, TRUE, 0, frame_timer, 0.0 };
+    guint tick_id;
+
+    wait_for_rows (fixture, N_DEVICES, N_DEVICES * N_PROFILES_PER_DEVICE);
+
+    /* The new device has to be connected while the daemon is busy */
+    emit_device_signal (fixture, "DeviceAdded", "hotplug");
+    g_dbus_connection_call (fixture->bus, COLORD_BUS_NAME, COLORD_OBJECT_PATH, COLORD_BUS_NAME, "Stall", NULL, NULL,
+                            G_DBUS_CALL_FLAGS_NONE, -1, NULL, stall_cb, &data);
+    tick_id = g_timeout_add (10, stall_tick_cb, &data);
+
+    /* The profiles of the new device only show up once its row is there */
+    while (data.stalled || count_device_rows (fixture) != N_DEVICES + 1
+           || count_profile_rows (fixture) != N_DEVICES * N_PROFILES_PER_DEVICE + 1) {
+        if (count_profile_rows (fixture) > N_DEVICES * N_PROFILES_PER_DEVICE)
+            g_assert_cmpuint (count_device_rows (fixture), ==, N_DEVICES + 1);
+        g_main_context_iteration (NULL, TRUE);
+    }
+    g_source_remove (tick_id);
+
+    g_test_message ("%u ticks while the daemon was busy", data.n_ticks);
+    g_assert_cmpuint (data.n_ticks, >, 0);
+
+    if (g_test_perf ())
+        g_test_minimized_result (data.longest_frame, "Longest frame while the daemon was busy");
+}
+
+int
+main (int argc, char **argv)
+{
+    g_setenv ("GSETTINGS_BACKEND", "memory", TRUE);
+    g_setenv ("LC_ALL", "C", TRUE);
+
+    gtk_test_init (&argc, &argv, NULL);
+    adw_init ();
+    cc_object_storage_initialize ();
+
+    g_test_add ("/color-panel/rows-created", ColorPanelFixture, NULL, fixture_set_up, test_rows_created,
+                fixture_tear_down);
+    g_test_add ("/color-panel/device-removed", ColorPanelFixture, NULL, fixture_set_up, test_device_removed,
+                fixture_tear_down);
+    g_test_add ("/color-panel/stalled-daemon", ColorPanelFixture, NULL, fixture_set_up, test_stalled_daemon,
+                fixture_tear_down);
+
+    return g_test_run ();
+}
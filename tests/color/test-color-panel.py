@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+# Copyright © 2026 The GNOME Project
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+import os
+import subprocess
+import sys
+import unittest
+
+try:
+    import dbus
+    import dbusmock
+except ImportError:
+    sys.stderr.write('You need python-dbusmock (http://pypi.python.org/pypi/python-dbusmock) for this test suite.\n')
+    sys.exit(1)
+
+# Add the shared directory to the search path
+sys.path.append(os.path.join(os.path.dirname(__file__), '..', 'shared'))
+
+from gtest import GTest
+from x11session import X11SessionTestCase
+
+BUILDDIR = os.environ.get('BUILDDIR', os.path.join(os.path.dirname(__file__)))
+
+COLORD_BUS_NAME = 'org.freedesktop.ColorManager'
+COLORD_OBJECT_PATH = '/org/freedesktop/ColorManager'
+COLORD_DEVICE_INTERFACE = 'org.freedesktop.ColorManager.Device'
+COLORD_PROFILE_INTERFACE = 'org.freedesktop.ColorManager.Profile'
+
+# Must match test-color-panel.c
+N_DEVICES = 20
+N_PROFILES_PER_DEVICE = 5
+
+STALL_SECONDS = 3
+
+
+def device_path(device_id):
+    return COLORD_OBJECT_PATH + '/devices/' + device_id
+
+
+def profile_path(profile_id):
+    return COLORD_OBJECT_PATH + '/profiles/' + profile_id
+
+
+class PanelTestCase(X11SessionTestCase, GTest):
+    g_test_exe = os.path.join(BUILDDIR, 'test-color-panel')
+
+    @classmethod
+    def add_profile(klass, profile_id):
+        klass.colord_obj.AddObject(profile_path(profile_id), COLORD_PROFILE_INTERFACE, {
+            'Id': profile_id,
+            'Title': 'Profile ' + profile_id,
+            'Kind': 'display-device',
+            'Colorspace': 'rgb',
+            'Scope': 'temp',
+            'Owner': dbus.UInt32(os.getuid()),
+            'Created': dbus.UInt64(0),
+            'HasVcgt': True,
+            'IsSystemWide': False,
+            'Metadata': dbus.Dictionary({}, signature='ss'),
+            'Warnings': dbus.Array([], signature='s'),
+        }, [])
+
+        return profile_path(profile_id)
+
+    @classmethod
+    def add_device(klass, device_id, profiles):
+        klass.colord_obj.AddObject(device_path(device_id), COLORD_DEVICE_INTERFACE, {
+            'Id': device_id,
+            'Kind': 'display',
+            'Model': 'Monitor ' + device_id,
+            'Vendor': 'Mock',
+            'Serial': device_id,
+            'Colorspace': 'rgb',
+            'Mode': 'physical',
+            'Scope': 'temp',
+            'Owner': dbus.UInt32(os.getuid()),
+            'Created': dbus.UInt64(0),
+            'Modified': dbus.UInt64(0),
+            'Enabled': True,
+            'Embedded': False,
+            'Profiles': dbus.Array(profiles, signature='o'),
+            'Metadata': dbus.Dictionary({}, signature='ss'),
+        }, [])
+
+        return device_path(device_id)
+
+    @classmethod
+    def setUpClass(klass):
+        super().setUpClass()
+
+        klass.colord, klass.colord_obj = klass.spawn_server(
+            COLORD_BUS_NAME, COLORD_OBJECT_PATH, COLORD_BUS_NAME, system_bus=True, stdout=subprocess.DEVNULL)
+        klass.colord_obj.AddProperties(COLORD_BUS_NAME, {
+            'DaemonVersion': '1.4.7',
+            'SystemVendor': 'Mock',
+            'SystemModel': 'Mock',
+        })
+
+        # Every device has profiles of its own, plus one shared by all of them
+        shared = klass.add_profile('shared')
+        profiles = [shared]
+        devices = []
+        for i in range(N_DEVICES):
+            device_profiles = [klass.add_profile('dev%d_%d' % (i, j)) for j in range(N_PROFILES_PER_DEVICE - 1)]
+            devices.append(klass.add_device('dev%d' % i, device_profiles + [shared]))
+            profiles += device_profiles
+
+        # Listed by nobody until the test emits DeviceAdded for it
+        klass.add_device('hotplug', [klass.add_profile('hotplug_0')])
+
+        klass.colord_obj.AddMethods(COLORD_BUS_NAME, [
+            ('GetDevices', '', 'ao', 'ret = %r' % devices),
+            ('GetProfiles', '', 'ao', 'ret = %r' % profiles),
+            ('GetSensors', '', 'ao', 'ret = dbus.Array([], signature="o")'),
+            # Blocking the mock's main loop simulates a daemon that is slow to answer
+            ('Stall', '', '', 'import time; time.sleep(%d)' % STALL_SECONDS),
+        ])
+
+    @classmethod
+    def tearDownClass(klass):
+        klass.colord.terminate()
+        klass.colord.wait()
+
+        super().tearDownClass()
+
+
+if __name__ == '__main__':
+    # avoid writing to stderr
+    unittest.main(testRunner=unittest.TextTestRunner(stream=sys.stdout, verbosity=2))
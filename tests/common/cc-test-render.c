@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2026 The GNOME Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define G_LOG_DOMAIN "cc-test-render"
+
+#include "cc-test-render.h"
+
+/**
+ * cc_test_renderer_new:
+ *
+ * Creates a realized renderer that rasterizes on the CPU, so that frame times
+ * measured by benchmarks don't depend on the GL driver.
+ *
+ * Returns: (transfer full): A realized renderer, to unrealize after use
+ */
+GskRenderer *
+cc_test_renderer_new (void)
+{
+    g_autoptr(GError) error = NULL;
+    GskRenderer *renderer;
+
+    renderer = gsk_cairo_renderer_new ();
+    gsk_renderer_realize (renderer, NULL, &error);
+    g_assert_no_error (error);
+
+    return renderer;
+}
+
+/**
+ * cc_test_wait_for_allocation:
+ * @widget: A widget in a presented window
+ *
+ * Iterates the main context until @widget has been given a size.
+ */
+void
+cc_test_wait_for_allocation (GtkWidget *widget)
+{
+    g_autoptr(GTimer) timer = g_timer_new ();
+
+    while (gtk_widget_get_width (widget) == 0) {
+        g_assert_cmpfloat (g_timer_elapsed (timer, NULL), <, CC_TEST_TIMEOUT_SECONDS);
+        g_main_context_iteration (NULL, TRUE);
+    }
+}
+
+/**
+ * cc_test_render_widget:
+ * @renderer: A renderer from cc_test_renderer_new()
+ * @widget: An allocated widget
+ *
+ * Snapshots @widget outside of the frame clock, and renders the result with
+ * @renderer.
+ *
+ * Returns: (transfer full): The render node of the frame
+ */
+GskRenderNode *
+cc_test_render_widget (GskRenderer *renderer, GtkWidget *widget)
+{
+    g_autoptr(GtkSnapshot) snapshot = gtk_snapshot_new ();
+    g_autoptr(GdkTexture) texture = NULL;
+    GskRenderNode *node;
+
+    GTK_WIDGET_GET_CLASS (widget)->snapshot (widget, snapshot);
+    node = gtk_snapshot_free_to_node (g_steal_pointer (&snapshot));
+    g_assert_nonnull (node);
+
+    texture = gsk_renderer_render_texture (
+        renderer, node, &GRAPHENE_RECT_INIT (0, 0, gtk_widget_get_width (widget), gtk_widget_get_height (widget)));
+
+    return node;
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2026 The GNOME Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <fontconfig/fontconfig.h>
+#include <locale.h>
+
+#include "cc-common-language.h"
+
+#define GNOME_DESKTOP_USE_UNSTABLE_API
+#include <libgnome-desktop/gnome-languages.h>
+
+#define N_THREADS 4
+
+/* One FcFontList() call per locale, as cc_common_language_has_font() used to do */
+static gboolean
+has_font_per_locale (const gchar *locale)
+{
+    g_autofree gchar *language_code = NULL;
+    FcPattern *pattern;
+    FcObjectSet *object_set;
+    FcFontSet *font_set;
+    gboolean is_displayable;
+
+    if (!gnome_parse_locale (locale, &language_code, NULL, NULL, NULL))
+        return FALSE;
+
+    if (!FcLangGetCharSet ((FcChar8 *) language_code))
+        return TRUE;
+
+    pattern = FcPatternBuild (NULL, FC_LANG, FcTypeString, language_code, NULL);
+    object_set = FcObjectSetCreate ();
+    font_set = FcFontList (NULL, pattern, object_set);
+    is_displayable = font_set != NULL && font_set->nfont > 0;
+
+    if (font_set != NULL)
+        FcFontSetDestroy (font_set);
+    FcObjectSetDestroy (object_set);
+    FcPatternDestroy (pattern);
+
+    return is_displayable;
+}
+
+static void
+test_font_coverage (void)
+{
+    g_auto(GStrv) locale_ids = gnome_get_all_locales ();
+
+    for (guint i = 0; locale_ids[i] != NULL; i++) {
+        g_test_message ("%s", locale_ids[i]);
+        g_assert_cmpint (cc_common_language_has_font (locale_ids[i]), ==, has_font_per_locale (locale_ids[i]));
+    }
+}
+
+static gpointer
+count_displayable_thread (gpointer user_data)
+{
+    gchar **locale_ids = user_data;
+    guint n_displayable = 0;
+
+    for (guint i = 0; locale_ids[i] != NULL; i++)
+        if (cc_common_language_has_font (locale_ids[i]))
+            n_displayable++;
+
+    return GUINT_TO_POINTER (n_displayable);
+}
+
+static void
+test_font_coverage_threads (void)
+{
+    g_auto(GStrv) locale_ids = gnome_get_all_locales ();
+    GThread *threads[N_THREADS];
+    guint n_displayable;
+
+    n_displayable = GPOINTER_TO_UINT (count_displayable_thread (locale_ids));
+
+    for (guint i = 0; i < N_THREADS; i++)
+        threads[i] = g_thread_new ("font-coverage", count_displayable_thread, locale_ids);
+    for (guint i = 0; i < N_THREADS; i++)
+        g_assert_cmpuint (GPOINTER_TO_UINT (g_thread_join (threads[i])), ==, n_displayable);
+}
+
+static void
+test_font_coverage_benchmark (void)
+{
+    g_auto(GStrv) locale_ids = gnome_get_all_locales ();
+    g_autoptr(GTimer) timer = g_timer_new ();
+    guint n_locales = g_strv_length (locale_ids);
+
+    for (guint i = 0; locale_ids[i] != NULL; i++)
+        has_font_per_locale (locale_ids[i]);
+    g_test_minimized_result (g_timer_elapsed (timer, NULL), "Per-locale font coverage of %u locales", n_locales);
+
+    g_timer_start (timer);
+    for (guint i = 0; locale_ids[i] != NULL; i++)
+        cc_common_language_has_font (locale_ids[i]);
+    g_test_minimized_result (g_timer_elapsed (timer, NULL), "Batched font coverage of %u locales", n_locales);
+}
+
+int
+main (int argc, char **argv)
+{
+    setlocale (LC_ALL, "");
+    g_test_init (&argc, &argv, NULL);
+
+    /* First, so that the coverage isn't cached yet */
+    if (g_test_perf ())
+        g_test_add_func ("/common/language-font/benchmark", test_font_coverage_benchmark);
+    g_test_add_func ("/common/language-font/coverage", test_font_coverage);
+    g_test_add_func ("/common/language-font/threads", test_font_coverage_threads);
+
+    return g_test_run ();
+}
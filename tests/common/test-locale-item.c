@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2026 The GNOME Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <locale.h>
+
+#include "cc-locale-item.h"
+#include "cc-util.h"
+
+static gchar **
+split_words (const gchar *text)
+{
+    g_autofree gchar *normalized = cc_util_normalize_casefold_and_unaccent (text);
+
+    return g_strsplit_set (g_strstrip (normalized), " ", 0);
+}
+
+static void
+test_locale_items (void)
+{
+    GListModel *locales = cc_locale_item_get_all ();
+
+    /* The list is shared by every chooser */
+    g_assert_true (locales == cc_locale_item_get_all ());
+
+    for (guint i = 0; i < g_list_model_get_n_items (locales); i++) {
+        g_autoptr(CcLocaleItem) item = g_list_model_get_item (locales, i);
+        const gchar *language = cc_locale_item_get_language (item);
+        const gchar *region = cc_locale_item_get_region (item);
+
+        g_assert_true (cc_locale_item_lookup (cc_locale_item_get_locale_id (item)) == item);
+
+        /* The names are only looked up once */
+        g_assert_nonnull (language);
+        g_assert_true (cc_locale_item_get_language (item) == language);
+        g_assert_true (cc_locale_item_get_region (item) == region);
+
+        if (!g_str_equal (language, "")) {
+            g_auto(GStrv) words = split_words (language);
+
+            g_assert_true (cc_locale_item_match_language (item, words));
+        }
+
+        if (region && !g_str_equal (region, "")) {
+            g_auto(GStrv) words = split_words (region);
+
+            g_assert_true (cc_locale_item_match_region (item, words));
+        }
+    }
+}
+
+static void
+test_locale_items_no_match (void)
+{
+    GListModel *locales = cc_locale_item_get_all ();
+    g_auto(GStrv) words = split_words ("zzzzqqqq");
+
+    for (guint i = 0; i < g_list_model_get_n_items (locales); i++) {
+        g_autoptr(CcLocaleItem) item = g_list_model_get_item (locales, i);
+
+        g_assert_false (cc_locale_item_match_language (item, words));
+        g_assert_false (cc_locale_item_match_region (item, words));
+    }
+}
+
+static void
+test_locale_items_benchmark (void)
+{
+    const gchar *queries[] = { "e", "en", "eng", "engl", "english", "u", "un", "uni", "unit", "united" };
+    g_autoptr(GTimer) timer = g_timer_new ();
+    GListModel *locales;
+    guint n_items;
+    guint n_matches = 0;
+
+    /* The first call lists the locales and checks their fonts */
+    locales = cc_locale_item_get_all ();
+    n_items = g_list_model_get_n_items (locales);
+    g_test_minimized_result (g_timer_elapsed (timer, NULL), "Listing %u locales", n_items);
+
+    /* Looking up every name, as the first search does */
+    g_timer_start (timer);
+    for (guint i = 0; i < n_items; i++) {
+        g_autoptr(CcLocaleItem) item = g_list_model_get_item (locales, i);
+
+        cc_locale_item_get_language (item);
+        cc_locale_item_get_region (item);
+    }
+    g_test_minimized_result (g_timer_elapsed (timer, NULL), "Display names of %u locales", n_items);
+
+    /* Typing a query character by character filters every locale each time */
+    g_timer_start (timer);
+    for (guint i = 0; i < G_N_ELEMENTS (queries); i++) {
+        g_auto(GStrv) words = split_words (queries[i]);
+
+        for (guint j = 0; j < n_items; j++) {
+            g_autoptr(CcLocaleItem) item = g_list_model_get_item (locales, j);
+
+            if (cc_locale_item_match_language (item, words))
+                n_matches++;
+            if (cc_locale_item_match_region (item, words))
+                n_matches++;
+        }
+    }
+    g_test_minimized_result (g_timer_elapsed (timer, NULL) / G_N_ELEMENTS (queries),
+                             "Search over %u locales, %u matches", n_items, n_matches);
+}
+
+int
+main (int argc, char **argv)
+{
+    setlocale (LC_ALL, "");
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/common/locale-item", test_locale_items);
+    g_test_add_func ("/common/locale-item/no-match", test_locale_items_no_match);
+    if (g_test_perf ())
+        g_test_add_func ("/common/locale-item/benchmark", test_locale_items_benchmark);
+
+    return g_test_run ();
+}
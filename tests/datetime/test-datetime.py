@@ -49,6 +49,14 @@ class TimezoneGfxTestCase(X11SessionTestCase, GTest):
     g_test_exe = os.path.join(BUILDDIR, 'test-timezone-gfx')
 
 
+class TimezoneIndexTestCase(X11SessionTestCase, GTest):
+    g_test_exe = os.path.join(BUILDDIR, 'test-timezone-index')
+
+
+class TimezoneSearchTestCase(X11SessionTestCase, GTest):
+    g_test_exe = os.path.join(BUILDDIR, 'test-timezone-search')
+
+
 if __name__ == '__main__':
     _test = unittest.TextTestRunner(stream=sys.stdout, verbosity=2)
     unittest.main(testRunner=_test)
@@ -0,0 +1,360 @@
+/*
+ * Copyright (C) 2026 The GNOME Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define G_LOG_DOMAIN "test-display-arrangement"
+
+#include <gtk/gtk.h>
+#include <math.h>
+
+#include "cc-display-arrangement.h"
+#include "cc-test-render.h"
+
+/* A wall of 4x4 full HD outputs */
+#define N_COLUMNS 4
+#define N_ROWS 4
+#define N_OUTPUTS (N_COLUMNS * N_ROWS)
+#define OUTPUT_WIDTH 1920
+#define OUTPUT_HEIGHT 1080
+#define WIDGET_WIDTH 800
+#define WIDGET_HEIGHT 600
+#define N_BENCHMARK_MOTIONS 60
+#define BENCHMARK_RADIUS 30
+
+typedef struct {
+    GtkWindow *window;
+    CcDisplayConfig *config;
+    CcDisplayArrangement *arrangement;
+    GtkGesture *click_gesture;
+    GtkEventController *motion_controller;
+    GskRenderer *renderer;
+} ArrangementFixture;
+
+static CcDisplayConfig *
+create_config (void)
+{
+    g_autoptr(GDBusConnection) connection = NULL;
+    g_autoptr(GError) error = NULL;
+    GVariantBuilder monitors;
+    GVariantBuilder logical_monitors;
+    GVariant *state;
+
+    g_variant_builder_init (&monitors, G_VARIANT_TYPE ("a((ssss)a(siiddada{sv})a{sv})"));
+    g_variant_builder_init (&logical_monitors, G_VARIANT_TYPE ("a(iiduba(ssss)a{sv})"));
+
+    for (guint i = 0; i < N_OUTPUTS; i++) {
+        g_autofree gchar *connector = g_strdup_printf ("DP-%u", i + 1);
+        g_autofree gchar *serial = g_strdup_printf ("%04u", i);
+
+        g_variant_builder_add_parsed (&monitors,
+                                      "((%s, 'GNOME', 'Wall', %s),"
+                                      " [('1920x1080@60', %i, %i, 60.0, 1.0, [1.0],"
+                                      "   {'is-current': <true>, 'is-preferred': <true>})],"
+                                      " @a{sv} {})",
+                                      connector, serial, OUTPUT_WIDTH, OUTPUT_HEIGHT);
+        g_variant_builder_add_parsed (&logical_monitors,
+                                      "(%i, %i, 1.0, @u 0, %b, [(%s, 'GNOME', 'Wall', %s)], @a{sv} {})",
+                                      (i % N_COLUMNS) * OUTPUT_WIDTH, (i / N_COLUMNS) * OUTPUT_HEIGHT, i == 0,
+                                      connector, serial);
+    }
+
+    state = g_variant_new ("(u@a((ssss)a(siiddada{sv})a{sv})@a(iiduba(ssss)a{sv})@a{sv})", 1,
+                           g_variant_builder_end (&monitors), g_variant_builder_end (&logical_monitors),
+                           g_variant_new_array (G_VARIANT_TYPE ("{sv}"), NULL, 0));
+
+    connection = g_bus_get_sync (G_BUS_TYPE_SESSION, NULL, &error);
+    g_assert_no_error (error);
+
+    return g_object_new (CC_TYPE_DISPLAY_CONFIG, "state", state, "connection", connection, NULL);
+}
+
+static void
+fixture_set_up (ArrangementFixture *fixture, gconstpointer user_data)
+{
+    g_autoptr(GListModel) controllers = NULL;
+
+    fixture->config = create_config ();
+    g_assert_cmpint (cc_display_config_count_useful_monitors (fixture->config), ==, N_OUTPUTS);
+
+    fixture->window = GTK_WINDOW (gtk_window_new ());
+    fixture->arrangement = cc_display_arrangement_new (fixture->config);
+    gtk_widget_set_size_request (GTK_WIDGET (fixture->arrangement), WIDGET_WIDTH, WIDGET_HEIGHT);
+    gtk_window_set_child (fixture->window, GTK_WIDGET (fixture->arrangement));
+    gtk_window_set_resizable (fixture->window, FALSE);
+    gtk_window_present (fixture->window);
+
+    cc_test_wait_for_allocation (GTK_WIDGET (fixture->arrangement));
+
+    /* Drive the drags through the controllers of the widget */
+    controllers = gtk_widget_observe_controllers (GTK_WIDGET (fixture->arrangement));
+    for (guint i = 0; i < g_list_model_get_n_items (controllers); i++) {
+        g_autoptr(GtkEventController) controller = g_list_model_get_item (controllers, i);
+
+        if (GTK_IS_GESTURE_CLICK (controller))
+            fixture->click_gesture = GTK_GESTURE (controller);
+        else if (GTK_IS_EVENT_CONTROLLER_MOTION (controller))
+            fixture->motion_controller = controller;
+    }
+    g_assert_nonnull (fixture->click_gesture);
+    g_assert_nonnull (fixture->motion_controller);
+
+    fixture->renderer = cc_test_renderer_new ();
+}
+
+static void
+fixture_tear_down (ArrangementFixture *fixture, gconstpointer user_data)
+{
+    gsk_renderer_unrealize (fixture->renderer);
+    g_clear_object (&fixture->renderer);
+    g_clear_pointer (&fixture->window, gtk_window_destroy);
+    g_clear_object (&fixture->config);
+}
+
+static CcDisplayMonitor *
+get_output (ArrangementFixture *fixture, guint n)
+{
+    return g_list_nth_data (cc_display_config_get_monitors (fixture->config), n);
+}
+
+/* The wall is centered in the widget, with 0.66 outputs of margin on each side,
+ * see cc_display_arrangement_update_matrices() */
+static gdouble
+get_layout_scale (ArrangementFixture *fixture)
+{
+    gdouble width = gtk_widget_get_width (GTK_WIDGET (fixture->arrangement));
+    gdouble height = gtk_widget_get_height (GTK_WIDGET (fixture->arrangement));
+
+    return MIN (width / ((N_COLUMNS + 2 * 0.66) * OUTPUT_WIDTH), height / ((N_ROWS + 2 * 0.66) * OUTPUT_HEIGHT));
+}
+
+static void
+layout_to_widget (ArrangementFixture *fixture, gdouble x, gdouble y, gdouble *widget_x, gdouble *widget_y)
+{
+    gdouble scale = get_layout_scale (fixture);
+
+    *widget_x = gtk_widget_get_width (GTK_WIDGET (fixture->arrangement)) / 2.0
+                + scale * (x - N_COLUMNS * OUTPUT_WIDTH / 2.0);
+    *widget_y = gtk_widget_get_height (GTK_WIDGET (fixture->arrangement)) / 2.0
+                + scale * (y - N_ROWS * OUTPUT_HEIGHT / 2.0);
+}
+
+static GskRenderNode *
+render_frame (ArrangementFixture *fixture)
+{
+    return cc_test_render_widget (fixture->renderer, GTK_WIDGET (fixture->arrangement));
+}
+
+static void
+draw_frame (ArrangementFixture *fixture)
+{
+    g_autoptr(GskRenderNode) node = render_frame (fixture);
+}
+
+static void
+press (ArrangementFixture *fixture, gdouble x, gdouble y)
+{
+    gdouble widget_x, widget_y;
+
+    layout_to_widget (fixture, x, y, &widget_x, &widget_y);
+    g_signal_emit_by_name (fixture->click_gesture, "pressed", 1, widget_x, widget_y);
+}
+
+static void
+motion (ArrangementFixture *fixture, gdouble x, gdouble y)
+{
+    gdouble widget_x, widget_y;
+
+    layout_to_widget (fixture, x, y, &widget_x, &widget_y);
+    g_signal_emit_by_name (fixture->motion_controller, "motion", widget_x, widget_y);
+}
+
+static void
+release (ArrangementFixture *fixture, gdouble x, gdouble y)
+{
+    gdouble widget_x, widget_y;
+
+    layout_to_widget (fixture, x, y, &widget_x, &widget_y);
+    g_signal_emit_by_name (fixture->click_gesture, "released", 1, widget_x, widget_y);
+}
+
+static void
+assert_position (CcDisplayMonitor *output, gint x, gint y)
+{
+    gint output_x, output_y;
+
+    cc_display_monitor_get_geometry (output, &output_x, &output_y, NULL, NULL);
+    g_assert_cmpint (output_x, ==, x);
+    g_assert_cmpint (output_y, ==, y);
+}
+
+static void
+test_snap (ArrangementFixture *fixture, gconstpointer user_data)
+{
+    CcDisplayMonitor *output = get_output (fixture, N_OUTPUTS - 1);
+    gdouble center_x = (N_COLUMNS - 0.5) * OUTPUT_WIDTH;
+    gdouble center_y = (N_ROWS - 0.5) * OUTPUT_HEIGHT;
+
+    draw_frame (fixture);
+
+    /* Close to its slot, the bottom right output snaps back into it */
+    press (fixture, center_x, center_y);
+    g_assert_true (cc_display_arrangement_get_selected_output (fixture->arrangement) == output);
+    motion (fixture, center_x + 100, center_y + 40);
+    release (fixture, center_x + 100, center_y + 40);
+    assert_position (output, (N_COLUMNS - 1) * OUTPUT_WIDTH, (N_ROWS - 1) * OUTPUT_HEIGHT);
+
+    /* Half way between two columns, it only snaps to the row */
+    draw_frame (fixture);
+    press (fixture, center_x, center_y);
+    motion (fixture, center_x - OUTPUT_WIDTH / 2, center_y + 40);
+    release (fixture, center_x - OUTPUT_WIDTH / 2, center_y + 40);
+    assert_position (output, (N_COLUMNS - 1.5) * OUTPUT_WIDTH, (N_ROWS - 1) * OUTPUT_HEIGHT);
+}
+
+static gboolean
+is_attached (ArrangementFixture *fixture, CcDisplayMonitor *output)
+{
+    gint x, y, w, h;
+
+    cc_display_monitor_get_geometry (output, &x, &y, &w, &h);
+
+    for (GList *l = cc_display_config_get_monitors (fixture->config); l; l = l->next) {
+        gint other_x, other_y, other_w, other_h;
+
+        if (l->data == output)
+            continue;
+
+        cc_display_monitor_get_geometry (l->data, &other_x, &other_y, &other_w, &other_h);
+
+        if ((x == other_x + other_w || x + w == other_x) && y < other_y + other_h && other_y < y + h)
+            return TRUE;
+        if ((y == other_y + other_h || y + h == other_y) && x < other_x + other_w && other_x < x + w)
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
+static void
+test_snap_outputs (ArrangementFixture *fixture, gconstpointer user_data)
+{
+    CcDisplayMonitor *output = get_output (fixture, N_OUTPUTS - 1);
+
+    /* The outputs of the wall already touch each other */
+    cc_display_config_snap_outputs (fixture->config);
+    for (guint i = 0; i < N_OUTPUTS; i++)
+        assert_position (get_output (fixture, i), (i % N_COLUMNS) * OUTPUT_WIDTH, (i / N_COLUMNS) * OUTPUT_HEIGHT);
+
+    /* A detached output is moved back to the wall */
+    cc_display_monitor_set_position (output, 10000, 10000);
+    g_assert_false (is_attached (fixture, output));
+    cc_display_config_snap_outputs (fixture->config);
+    g_assert_true (is_attached (fixture, output));
+}
+
+static void
+test_render_nodes (ArrangementFixture *fixture, gconstpointer user_data)
+{
+    g_autoptr(GskRenderNode) node = NULL;
+    g_autoptr(GskRenderNode) drag_node = NULL;
+    g_autoptr(GHashTable) output_nodes = g_hash_table_new (NULL, NULL);
+    gdouble center_x = (N_COLUMNS - 0.5) * OUTPUT_WIDTH;
+    gdouble center_y = (N_ROWS - 0.5) * OUTPUT_HEIGHT;
+    guint n_reused = 0;
+
+    node = render_frame (fixture);
+    g_assert_cmpint (gsk_render_node_get_node_type (node), ==, GSK_CONTAINER_NODE);
+    g_assert_cmpuint (gsk_container_node_get_n_children (node), ==, N_OUTPUTS);
+    for (guint i = 0; i < N_OUTPUTS; i++)
+        g_hash_table_add (output_nodes, gsk_container_node_get_child (node, i));
+
+    /* Only the dragged output is drawn again */
+    press (fixture, center_x, center_y);
+    motion (fixture, center_x + 500, center_y + 500);
+    drag_node = render_frame (fixture);
+    release (fixture, center_x + 500, center_y + 500);
+
+    g_assert_cmpuint (gsk_container_node_get_n_children (drag_node), ==, N_OUTPUTS);
+    for (guint i = 0; i < N_OUTPUTS; i++) {
+        if (g_hash_table_contains (output_nodes, gsk_container_node_get_child (drag_node, i)))
+            n_reused++;
+    }
+    g_assert_cmpuint (n_reused, ==, N_OUTPUTS - 1);
+}
+
+static void
+test_drag_benchmark (ArrangementFixture *fixture, gconstpointer user_data)
+{
+    g_autoptr(GTimer) timer = g_timer_new ();
+    gdouble snapping_time = 0;
+    gdouble drawing_time = 0;
+
+    for (guint i = 0; i < N_OUTPUTS; i++) {
+        CcDisplayMonitor *output = get_output (fixture, i);
+        gdouble center_x = (i % N_COLUMNS + 0.5) * OUTPUT_WIDTH;
+        gdouble center_y = (i / N_COLUMNS + 0.5) * OUTPUT_HEIGHT;
+        gdouble radius;
+        gdouble x = center_x;
+        gdouble y = center_y;
+
+        draw_frame (fixture);
+        radius = BENCHMARK_RADIUS / get_layout_scale (fixture);
+        press (fixture, center_x, center_y);
+
+        /* Circle around the slot of the output, snapping in and out of it */
+        for (guint j = 0; j < N_BENCHMARK_MOTIONS; j++) {
+            gdouble angle = 2 * G_PI * j / N_BENCHMARK_MOTIONS;
+
+            x = center_x + radius * cos (angle);
+            y = center_y + radius * sin (angle);
+
+            g_timer_start (timer);
+            motion (fixture, x, y);
+            snapping_time += g_timer_elapsed (timer, NULL);
+
+            g_timer_start (timer);
+            draw_frame (fixture);
+            drawing_time += g_timer_elapsed (timer, NULL);
+        }
+
+        release (fixture, x, y);
+        cc_display_monitor_set_position (output, (i % N_COLUMNS) * OUTPUT_WIDTH, (i / N_COLUMNS) * OUTPUT_HEIGHT);
+    }
+
+    g_test_minimized_result (snapping_time / (N_OUTPUTS * N_BENCHMARK_MOTIONS), "Snapping a dragged output");
+    g_test_minimized_result (drawing_time / (N_OUTPUTS * N_BENCHMARK_MOTIONS), "Drawing a drag frame");
+
+    g_timer_start (timer);
+    cc_display_config_snap_outputs (fixture->config);
+    g_test_minimized_result (g_timer_elapsed (timer, NULL), "Snapping the whole layout");
+}
+
+int
+main (int argc, char **argv)
+{
+    gtk_test_init (&argc, &argv, NULL);
+
+    g_test_add ("/display-arrangement/snap", ArrangementFixture, NULL, fixture_set_up, test_snap, fixture_tear_down);
+    g_test_add ("/display-arrangement/snap-outputs", ArrangementFixture, NULL, fixture_set_up, test_snap_outputs,
+                fixture_tear_down);
+    g_test_add ("/display-arrangement/render-nodes", ArrangementFixture, NULL, fixture_set_up, test_render_nodes,
+                fixture_tear_down);
+    if (g_test_perf ())
+        g_test_add ("/display-arrangement/benchmark", ArrangementFixture, NULL, fixture_set_up, test_drag_benchmark,
+                    fixture_tear_down);
+
+    return g_test_run ();
+}
@@ -0,0 +1,266 @@
+/*
+ * Copyright (C) 2026 The GNOME Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define G_LOG_DOMAIN "test-display-config"
+
+#include <gio/gio.h>
+
+#include "cc-display-config.h"
+
+#define N_BENCHMARK_MONITORS 4
+#define N_BENCHMARK_RUNS 20
+
+typedef struct {
+    int width;
+    int height;
+} Resolution;
+
+/* What high-end monitors advertise, every resolution at every refresh rate */
+static const Resolution resolutions[] = {
+    { 7680, 4320 }, { 5120, 2880 }, { 3840, 2160 }, { 3440, 1440 }, { 2560, 1440 },
+    { 2560, 1080 }, { 1920, 1200 }, { 1920, 1080 }, { 1680, 1050 }, { 1600, 900 },
+    { 1280, 1024 }, { 1280, 720 },  { 1024, 768 },  { 800, 600 },   { 640, 480 },
+};
+
+static const double refresh_rates[] = {
+    240.0, 165.0, 144.0, 120.0, 100.0, 75.0, 60.0, 59.94, 50.0, 30.0, 29.97, 25.0, 24.0, 23.976,
+};
+
+static const double scales[] = { 1.0, 1.25, 1.5, 1.75, 2.0, 2.25, 2.5, 2.75, 3.0, 3.5, 4.0 };
+
+typedef struct {
+    GVariantBuilder monitors;
+    GVariantBuilder logical_monitors;
+    int x;
+} StateBuilder;
+
+static void
+state_builder_init (StateBuilder *builder)
+{
+    g_variant_builder_init (&builder->monitors, G_VARIANT_TYPE ("a((ssss)a(siiddada{sv})a{sv})"));
+    g_variant_builder_init (&builder->logical_monitors, G_VARIANT_TYPE ("a(iiduba(ssss)a{sv})"));
+    builder->x = 0;
+}
+
+/* Adds a monitor with the resolutions from @first on, laid out right of the
+ * previous ones. Like mutter, it supports the scales leaving at least 600
+ * logical pixels of height, up to @max_scale. */
+static void
+state_builder_add_monitor (StateBuilder *builder, const gchar *model, guint first, double max_scale)
+{
+    g_autofree gchar *connector = g_strdup_printf ("DP-%d", builder->x);
+    g_autofree gchar *serial = g_strdup_printf ("%08d", builder->x);
+    GVariantBuilder modes;
+
+    g_variant_builder_init (&modes, G_VARIANT_TYPE ("a(siiddada{sv})"));
+
+    for (guint i = first; i < G_N_ELEMENTS (resolutions); i++) {
+        const Resolution *resolution = &resolutions[i];
+        double mode_scales[G_N_ELEMENTS (scales)];
+        guint n_scales = 0;
+
+        for (guint j = 0; j < G_N_ELEMENTS (scales); j++) {
+            if (scales[j] <= max_scale && resolution->height / scales[j] >= 600)
+                mode_scales[n_scales++] = scales[j];
+        }
+        if (n_scales == 0)
+            mode_scales[n_scales++] = 1.0;
+
+        for (guint j = 0; j < G_N_ELEMENTS (refresh_rates); j++) {
+            g_autofree gchar *id = NULL;
+            gboolean current = i == first && j == 0;
+
+            id = g_strdup_printf ("%dx%d@%.3f", resolution->width, resolution->height, refresh_rates[j]);
+            g_variant_builder_add (
+                &modes, "(siidd@ad@a{sv})", id, resolution->width, resolution->height, refresh_rates[j],
+                resolution->height >= 2160 ? 2.0 : 1.0,
+                g_variant_new_fixed_array (G_VARIANT_TYPE_DOUBLE, mode_scales, n_scales, sizeof (double)),
+                g_variant_new_parsed ("{'is-current': <%b>, 'is-preferred': <%b>}", current, current));
+        }
+    }
+
+    g_variant_builder_add (&builder->monitors, "((ssss)@a(siiddada{sv})@a{sv})", connector, "GNOME", model, serial,
+                           g_variant_builder_end (&modes), g_variant_new_array (G_VARIANT_TYPE ("{sv}"), NULL, 0));
+    g_variant_builder_add_parsed (&builder->logical_monitors,
+                                  "(%i, 0, 1.0, @u 0, %b, [(%s, 'GNOME', %s, %s)], @a{sv} {})", builder->x,
+                                  builder->x == 0, connector, model, serial);
+
+    builder->x += resolutions[first].width;
+}
+
+static GVariant *
+state_builder_end (StateBuilder *builder)
+{
+    return g_variant_ref_sink (
+        g_variant_new ("(u@a((ssss)a(siiddada{sv})a{sv})@a(iiduba(ssss)a{sv})@a{sv})", 1,
+                       g_variant_builder_end (&builder->monitors), g_variant_builder_end (&builder->logical_monitors),
+                       g_variant_new_array (G_VARIANT_TYPE ("{sv}"), NULL, 0)));
+}
+
+static CcDisplayConfig *
+create_config (GVariant *state)
+{
+    g_autoptr(GDBusConnection) connection = NULL;
+    g_autoptr(GError) error = NULL;
+
+    connection = g_bus_get_sync (G_BUS_TYPE_SESSION, NULL, &error);
+    g_assert_no_error (error);
+
+    return g_object_new (CC_TYPE_DISPLAY_CONFIG, "state", state, "connection", connection, NULL);
+}
+
+static void
+test_shared_scales (void)
+{
+    g_autoptr(GVariant) state = NULL;
+    g_autoptr(CcDisplayConfig) config = NULL;
+    g_autoptr(GArray) high_scales = NULL;
+    CcDisplayMode *high_mode;
+    StateBuilder builder;
+    GList *first_modes, *second_modes;
+    GList *l, *ll;
+
+    state_builder_init (&builder);
+    state_builder_add_monitor (&builder, "Wall", 0, 4.0);
+    state_builder_add_monitor (&builder, "Wall", 0, 4.0);
+    state = state_builder_end (&builder);
+
+    config = create_config (state);
+    g_assert_false (cc_display_config_is_cloning (config));
+
+    first_modes = cc_display_monitor_get_modes (g_list_nth_data (cc_display_config_get_monitors (config), 0));
+    second_modes = cc_display_monitor_get_modes (g_list_nth_data (cc_display_config_get_monitors (config), 1));
+    g_assert_cmpuint (g_list_length (first_modes), ==, G_N_ELEMENTS (resolutions) * G_N_ELEMENTS (refresh_rates));
+    g_assert_cmpuint (g_list_length (second_modes), ==, g_list_length (first_modes));
+
+    /* Identical monitors and modes with the same resolution share their scales */
+    for (l = first_modes, ll = second_modes; l && ll; l = l->next, ll = ll->next) {
+        g_autoptr(GArray) first_scales = cc_display_mode_get_supported_scales (l->data);
+        g_autoptr(GArray) second_scales = cc_display_mode_get_supported_scales (ll->data);
+        g_autoptr(GArray) next_scales = NULL;
+        int width, height, next_width, next_height;
+
+        g_assert_true (first_scales == second_scales);
+
+        if (!l->next)
+            continue;
+
+        cc_display_mode_get_resolution (l->data, &width, &height);
+        cc_display_mode_get_resolution (l->next->data, &next_width, &next_height);
+        next_scales = cc_display_mode_get_supported_scales (l->next->data);
+        if (width == next_width && height == next_height)
+            g_assert_true (first_scales == next_scales);
+    }
+
+    /* 2160 / 3.5 is less than 600 */
+    high_mode = g_list_nth_data (first_modes, 2 * G_N_ELEMENTS (refresh_rates));
+    high_scales = cc_display_mode_get_supported_scales (high_mode);
+    g_assert_cmpuint (high_scales->len, ==, 9);
+    g_assert_cmpfloat (g_array_index (high_scales, double, 8), ==, 3.0);
+}
+
+static void
+test_cloning_modes (void)
+{
+    g_autoptr(GVariant) state = NULL;
+    g_autoptr(CcDisplayConfig) config = NULL;
+    g_autolist(CcDisplayMode) clone_modes = NULL;
+    CcDisplayMode *preferred_mode = NULL;
+    StateBuilder builder;
+    guint i = 0;
+    GList *l;
+
+    /* The second monitor lacks the four largest resolutions and scales above 2 */
+    state_builder_init (&builder);
+    state_builder_add_monitor (&builder, "Large", 0, 4.0);
+    state_builder_add_monitor (&builder, "Small", 4, 2.0);
+    state = state_builder_end (&builder);
+
+    config = create_config (state);
+    clone_modes = cc_display_config_generate_cloning_modes (config);
+    g_assert_cmpuint (g_list_length (clone_modes), ==, (G_N_ELEMENTS (resolutions) - 4) * G_N_ELEMENTS (refresh_rates));
+
+    /* In the order of the first monitor */
+    for (l = clone_modes; l; l = l->next, i++) {
+        const Resolution *resolution = &resolutions[4 + i / G_N_ELEMENTS (refresh_rates)];
+        g_autoptr(GArray) mode_scales = cc_display_mode_get_supported_scales (l->data);
+        int width, height;
+
+        g_assert_true (cc_display_mode_is_clone_mode (l->data));
+        cc_display_mode_get_resolution (l->data, &width, &height);
+        g_assert_cmpint (width, ==, resolution->width);
+        g_assert_cmpint (height, ==, resolution->height);
+
+        g_assert_cmpuint (mode_scales->len, >, 0);
+        g_assert_cmpfloat (g_array_index (mode_scales, double, mode_scales->len - 1), <=, 2.0);
+
+        if (cc_display_mode_is_preferred (l->data)) {
+            g_assert_null (preferred_mode);
+            preferred_mode = l->data;
+        }
+    }
+
+    /* 2560x1440 supports up to 2.25, but the second monitor only up to 2 */
+    g_assert_true (preferred_mode == clone_modes->data);
+    {
+        g_autoptr(GArray) preferred_scales = cc_display_mode_get_supported_scales (preferred_mode);
+
+        g_assert_cmpuint (preferred_scales->len, ==, 5);
+    }
+}
+
+static void
+test_parse_benchmark (void)
+{
+    g_autoptr(GVariant) state = NULL;
+    g_autoptr(GTimer) timer = NULL;
+    g_autoptr(CcDisplayConfig) config = NULL;
+    StateBuilder builder;
+
+    state_builder_init (&builder);
+    for (guint i = 0; i < N_BENCHMARK_MONITORS; i++)
+        state_builder_add_monitor (&builder, "Wall", 0, 4.0);
+    state = state_builder_end (&builder);
+
+    timer = g_timer_new ();
+    for (guint i = 0; i < N_BENCHMARK_RUNS; i++) {
+        g_autoptr(CcDisplayConfig) run_config = create_config (state);
+    }
+    g_test_minimized_result (g_timer_elapsed (timer, NULL) / N_BENCHMARK_RUNS,
+                             "Parsing the state of %u monitors with %zu modes each", N_BENCHMARK_MONITORS,
+                             G_N_ELEMENTS (resolutions) * G_N_ELEMENTS (refresh_rates));
+
+    config = create_config (state);
+    g_timer_start (timer);
+    for (guint i = 0; i < N_BENCHMARK_RUNS; i++) {
+        g_autolist(CcDisplayMode) clone_modes = cc_display_config_generate_cloning_modes (config);
+    }
+    g_test_minimized_result (g_timer_elapsed (timer, NULL) / N_BENCHMARK_RUNS, "Generating the cloning modes");
+}
+
+gint
+main (gint argc, gchar **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/display-config/shared-scales", test_shared_scales);
+    g_test_add_func ("/display-config/cloning-modes", test_cloning_modes);
+    if (g_test_perf ())
+        g_test_add_func ("/display-config/benchmark", test_parse_benchmark);
+
+    return g_test_run ();
+}
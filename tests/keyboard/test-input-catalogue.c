@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2026 The GNOME Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <locale.h>
+
+#include "cc-input-catalogue.h"
+#include "cc-util.h"
+
+#define N_WARM_LOADS 10
+
+static gchar *
+get_index_file (void)
+{
+    return g_build_filename (g_get_user_cache_dir (), "gnome-control-center", "input-catalogue", NULL);
+}
+
+static void
+assert_items_equal (GListModel *a, GListModel *b)
+{
+    g_assert_cmpuint (g_list_model_get_n_items (a), ==, g_list_model_get_n_items (b));
+
+    for (guint i = 0; i < g_list_model_get_n_items (a); i++) {
+        g_autoptr(CcInputCatalogueItem) item_a = g_list_model_get_item (a, i);
+        g_autoptr(CcInputCatalogueItem) item_b = g_list_model_get_item (b, i);
+
+        g_assert_cmpint (cc_input_catalogue_item_get_kind (item_a), ==, cc_input_catalogue_item_get_kind (item_b));
+        g_assert_cmpstr (cc_input_catalogue_item_get_id (item_a), ==, cc_input_catalogue_item_get_id (item_b));
+        g_assert_cmpstr (cc_input_catalogue_item_get_name (item_a), ==, cc_input_catalogue_item_get_name (item_b));
+
+        if (cc_input_catalogue_item_get_kind (item_a) == CC_INPUT_CATALOGUE_ITEM_LOCALE) {
+            assert_items_equal (cc_input_catalogue_item_get_sources (item_a),
+                                cc_input_catalogue_item_get_sources (item_b));
+        } else {
+            g_assert_cmpstr (cc_input_catalogue_item_get_source_type (item_a), ==,
+                             cc_input_catalogue_item_get_source_type (item_b));
+            g_assert_cmpint (cc_input_catalogue_item_get_is_default (item_a), ==,
+                             cc_input_catalogue_item_get_is_default (item_b));
+        }
+    }
+}
+
+static void
+test_catalogue (void)
+{
+    g_autoptr(GnomeXkbInfo) xkb_info = gnome_xkb_info_new ();
+    g_autofree gchar *index_file = get_index_file ();
+    g_autoptr(CcInputCatalogue) built = NULL;
+    g_autoptr(CcInputCatalogue) cached = NULL;
+    g_autoptr(CcInputCatalogue) corrupt = NULL;
+
+    /* The first load builds the catalogue and writes the index */
+    g_assert_false (g_file_test (index_file, G_FILE_TEST_EXISTS));
+    built = cc_input_catalogue_new (xkb_info);
+    g_assert_false (cc_input_catalogue_is_cached (built));
+    g_assert_true (g_file_test (index_file, G_FILE_TEST_EXISTS));
+    g_assert_cmpuint (g_list_model_get_n_items (cc_input_catalogue_get_locales (built)), >, 0);
+
+    /* The second one only reads it back */
+    cached = cc_input_catalogue_new (xkb_info);
+    g_assert_true (cc_input_catalogue_is_cached (cached));
+    assert_items_equal (cc_input_catalogue_get_locales (built), cc_input_catalogue_get_locales (cached));
+
+    /* A damaged index is ignored and rebuilt */
+    g_assert_true (g_file_set_contents (index_file, "garbage", -1, NULL));
+    corrupt = cc_input_catalogue_new (xkb_info);
+    g_assert_false (cc_input_catalogue_is_cached (corrupt));
+    assert_items_equal (cc_input_catalogue_get_locales (built), cc_input_catalogue_get_locales (corrupt));
+}
+
+static void
+test_catalogue_search (void)
+{
+    g_autoptr(GnomeXkbInfo) xkb_info = gnome_xkb_info_new ();
+    g_autoptr(CcInputCatalogue) catalogue = cc_input_catalogue_new (xkb_info);
+    GListModel *locales = cc_input_catalogue_get_locales (catalogue);
+
+    /* Every locale but "Other" is found by its own name, along with its input sources */
+    for (guint i = 0; i < g_list_model_get_n_items (locales); i++) {
+        g_autoptr(CcInputCatalogueItem) locale = g_list_model_get_item (locales, i);
+        GListModel *sources = cc_input_catalogue_item_get_sources (locale);
+        g_autofree gchar *name = NULL;
+        g_auto(GStrv) words = NULL;
+
+        if (g_str_equal (cc_input_catalogue_item_get_id (locale), ""))
+            continue;
+
+        name = cc_util_normalize_casefold_and_unaccent (cc_input_catalogue_item_get_name (locale));
+        words = g_strsplit_set (g_strstrip (name), " ", 0);
+        g_assert_true (cc_input_catalogue_item_match (locale, words));
+
+        for (guint j = 0; j < g_list_model_get_n_items (sources); j++) {
+            g_autoptr(CcInputCatalogueItem) source = g_list_model_get_item (sources, j);
+
+            g_assert_true (cc_input_catalogue_item_get_locale (source) == locale);
+            g_assert_true (cc_input_catalogue_item_match (source, words));
+        }
+    }
+}
+
+static void
+test_catalogue_benchmark (void)
+{
+    g_autoptr(GnomeXkbInfo) xkb_info = gnome_xkb_info_new ();
+    g_autofree gchar *index_file = get_index_file ();
+    g_autoptr(GTimer) timer = g_timer_new ();
+    g_autoptr(CcInputCatalogue) cold = NULL;
+    GListModel *locales;
+    const gchar *queries[] = { "e", "en", "eng", "engl", "english", "german", "ru", "jap" };
+    gdouble cold_time;
+    gdouble warm_time;
+    guint n_matches = 0;
+
+    g_remove (index_file);
+
+    g_timer_start (timer);
+    cold = cc_input_catalogue_new (xkb_info);
+    cold_time = g_timer_elapsed (timer, NULL);
+    g_assert_false (cc_input_catalogue_is_cached (cold));
+    locales = cc_input_catalogue_get_locales (cold);
+
+    g_timer_start (timer);
+    for (guint i = 0; i < N_WARM_LOADS; i++) {
+        g_autoptr(CcInputCatalogue) warm = cc_input_catalogue_new (xkb_info);
+
+        g_assert_true (cc_input_catalogue_is_cached (warm));
+    }
+    warm_time = g_timer_elapsed (timer, NULL) / N_WARM_LOADS;
+
+    g_test_minimized_result (cold_time, "Cold load of %u locales", g_list_model_get_n_items (locales));
+    g_test_minimized_result (warm_time, "Warm load of %u locales", g_list_model_get_n_items (locales));
+
+    /* Typing a query character by character filters every locale each time */
+    g_timer_start (timer);
+    for (guint i = 0; i < G_N_ELEMENTS (queries); i++) {
+        g_auto(GStrv) words = g_strsplit (queries[i], " ", 0);
+
+        for (guint j = 0; j < g_list_model_get_n_items (locales); j++) {
+            g_autoptr(CcInputCatalogueItem) locale = g_list_model_get_item (locales, j);
+
+            if (cc_input_catalogue_item_match (locale, words))
+                n_matches++;
+        }
+    }
+    g_test_minimized_result (g_timer_elapsed (timer, NULL) / G_N_ELEMENTS (queries),
+                             "Search over %u locales, %u matches", g_list_model_get_n_items (locales), n_matches);
+}
+
+gint
+main (gint argc, gchar **argv)
+{
+    setlocale (LC_ALL, "");
+    g_test_init (&argc, &argv, G_TEST_OPTION_ISOLATE_DIRS, NULL);
+
+    g_test_add_func ("/keyboard/input-catalogue", test_catalogue);
+    g_test_add_func ("/keyboard/input-catalogue/search", test_catalogue_search);
+    if (g_test_perf ())
+        g_test_add_func ("/keyboard/input-catalogue/benchmark", test_catalogue_benchmark);
+
+    return g_test_run ();
+}
@@ -0,0 +1,217 @@
+#include "cc-keyboard-manager.h"
+#include <gdk/gdk.h>
+#include <gtk/gtk.h>
+#include <locale.h>
+
+#define APP_ID "org.gnome.Settings.Test"
+#define N_BENCHMARK_BINDINGS 5000
+#define N_BENCHMARK_LOOKUPS 1000
+#define N_LOAD_ROUNDS 10
+
+static const char *modifiers[] = {
+    "", "<Shift>", "<Control>", "<Alt>", "<Super>", "<Shift><Control>", "<Shift><Alt>", "<Shift><Super>",
+};
+
+static GVariant *
+build_global_shortcuts (guint n_shortcuts)
+{
+    g_auto(GVariantBuilder) builder = G_VARIANT_BUILDER_INIT (G_VARIANT_TYPE ("a(sa{sv})"));
+    guint keyval = GDK_KEY_space;
+    guint n = 0;
+
+    /* Walk the keysyms which have a name, pairing each with every modifier */
+    while (n < n_shortcuts) {
+        const char *name = gdk_keyval_name (keyval++);
+
+        if (!name || g_str_has_prefix (name, "0x") || gdk_keyval_to_lower (keyval - 1) != keyval - 1)
+            continue;
+
+        for (guint i = 0; i < G_N_ELEMENTS (modifiers) && n < n_shortcuts; i++, n++) {
+            g_auto(GVariantDict) dict = G_VARIANT_DICT_INIT (NULL);
+            g_autofree char *id = g_strdup_printf ("shortcut-%u", n);
+            g_autofree char *accel = g_strconcat (modifiers[i], name, NULL);
+            const char *shortcuts[] = { accel, NULL };
+
+            g_variant_dict_insert (&dict, "description", "s", id);
+            g_variant_dict_insert_value (&dict, "shortcuts", g_variant_new_strv (shortcuts, -1));
+            g_variant_builder_add (&builder, "(s@a{sv})", id, g_variant_dict_end (&dict));
+        }
+    }
+
+    return g_variant_ref_sink (g_variant_builder_end (&builder));
+}
+
+static void
+shortcut_added_cb (CcKeyboardManager *manager, CcKeyboardItem *item, const char *section_id, const char *title,
+                   GPtrArray *items)
+{
+    if (g_str_equal (section_id, APP_ID))
+        g_ptr_array_add (items, item);
+}
+
+static CcKeyboardManager *
+create_manager (guint n_shortcuts, GPtrArray *items)
+{
+    g_autoptr(GVariant) shortcuts = build_global_shortcuts (n_shortcuts);
+    CcKeyboardManager *manager;
+
+    manager = cc_keyboard_manager_new ();
+    g_signal_connect (manager, "shortcut-added", G_CALLBACK (shortcut_added_cb), items);
+    cc_keyboard_manager_load_global_shortcuts (manager, APP_ID, shortcuts);
+    g_signal_handlers_disconnect_by_func (manager, shortcut_added_cb, items);
+
+    return manager;
+}
+
+static void
+test_collision (void)
+{
+    g_autoptr(GPtrArray) items = g_ptr_array_new ();
+    g_autoptr(CcKeyboardManager) manager = NULL;
+    CcKeyboardItem *first, *second;
+    CcKeyCombo combo, unused = { GDK_KEY_F35, 0, GDK_SUPER_MASK | GDK_HYPER_MASK };
+
+    manager = create_manager (64, items);
+    g_assert_cmpuint (items->len, ==, 64);
+
+    first = g_ptr_array_index (items, 0);
+    second = g_ptr_array_index (items, 1);
+    combo = cc_keyboard_item_get_primary_combo (first);
+
+    /* An item doesn't collide with itself */
+    g_assert_true (cc_keyboard_manager_get_collision (manager, NULL, &combo) == first);
+    g_assert_true (cc_keyboard_manager_get_collision (manager, second, &combo) == first);
+    g_assert_null (cc_keyboard_manager_get_collision (manager, first, &combo));
+    g_assert_null (cc_keyboard_manager_get_collision (manager, NULL, &unused));
+
+    /* Keycodes don't matter when there's a keyval */
+    combo.keycode = 1234;
+    g_assert_true (cc_keyboard_manager_get_collision (manager, NULL, &combo) == first);
+
+    /* Changing a binding updates the index */
+    cc_keyboard_item_add_key_combo (second, &unused);
+    g_assert_true (cc_keyboard_manager_get_collision (manager, NULL, &unused) == second);
+    cc_keyboard_item_disable (second);
+    g_assert_null (cc_keyboard_manager_get_collision (manager, NULL, &unused));
+
+    cc_keyboard_item_disable (first);
+    g_assert_null (cc_keyboard_manager_get_collision (manager, NULL, &combo));
+}
+
+/* How conflicts were found before, by going through every binding */
+static CcKeyboardItem *
+find_collision_linear (GPtrArray *items, CcKeyCombo *combo)
+{
+    for (guint i = 0; i < items->len; i++) {
+        CcKeyboardItem *item = g_ptr_array_index (items, i);
+
+        for (GList *l = cc_keyboard_item_get_key_combos (item); l; l = l->next) {
+            CcKeyCombo *item_combo = l->data;
+
+            if (item_combo->mask == combo->mask && item_combo->keyval == combo->keyval)
+                return item;
+        }
+    }
+
+    return NULL;
+}
+
+static void
+test_collision_benchmark (void)
+{
+    g_autoptr(GPtrArray) items = g_ptr_array_new ();
+    g_autoptr(CcKeyboardManager) manager = NULL;
+    g_autoptr(GTimer) timer = g_timer_new ();
+    g_autoptr(GArray) combos = NULL;
+    guint n_indexed = 0, n_linear = 0;
+
+    manager = create_manager (N_BENCHMARK_BINDINGS, items);
+    g_assert_cmpuint (items->len, ==, N_BENCHMARK_BINDINGS);
+
+    /* Half of the lookups hit an existing binding, as when typing a new one */
+    combos = g_array_new (FALSE, FALSE, sizeof (CcKeyCombo));
+    for (guint i = 0; i < N_BENCHMARK_LOOKUPS; i++) {
+        CcKeyboardItem *item = g_ptr_array_index (items, g_test_rand_int_range (0, items->len));
+        CcKeyCombo combo = cc_keyboard_item_get_primary_combo (item);
+
+        if (i % 2)
+            combo.mask |= GDK_HYPER_MASK;
+        g_array_append_val (combos, combo);
+    }
+
+    g_timer_start (timer);
+    for (guint i = 0; i < combos->len; i++)
+        n_indexed += cc_keyboard_manager_get_collision (manager, NULL, &g_array_index (combos, CcKeyCombo, i)) != NULL;
+    g_test_minimized_result (g_timer_elapsed (timer, NULL), "%u indexed lookups in %u bindings", combos->len,
+                             items->len);
+
+    g_timer_start (timer);
+    for (guint i = 0; i < combos->len; i++)
+        n_linear += find_collision_linear (items, &g_array_index (combos, CcKeyCombo, i)) != NULL;
+    g_test_minimized_result (g_timer_elapsed (timer, NULL), "%u linear lookups in %u bindings", combos->len,
+                             items->len);
+
+    g_assert_cmpuint (n_indexed, ==, n_linear);
+    g_assert_cmpuint (n_indexed, ==, N_BENCHMARK_LOOKUPS / 2);
+}
+
+static void
+count_shortcut_cb (CcKeyboardManager *manager, CcKeyboardItem *item, const char *section_id, const char *title,
+                   guint *n_shortcuts)
+{
+    (*n_shortcuts)++;
+}
+
+static void
+test_load_benchmark (void)
+{
+    g_autoptr(GTimer) timer = g_timer_new ();
+    guint n_cold = 0, n_warm = 0;
+    gdouble warm_time = 0.0;
+
+    /* The first manager parses the keybinding files */
+    {
+        g_autoptr(CcKeyboardManager) manager = cc_keyboard_manager_new ();
+
+        g_signal_connect (manager, "shortcut-added", G_CALLBACK (count_shortcut_cb), &n_cold);
+
+        g_timer_start (timer);
+        cc_keyboard_manager_load_shortcuts (manager);
+        g_test_minimized_result (g_timer_elapsed (timer, NULL), "Cold load of %u shortcuts", n_cold);
+    }
+
+    /* The next ones, like when opening the panel again, reuse them */
+    for (guint i = 0; i < N_LOAD_ROUNDS; i++) {
+        g_autoptr(CcKeyboardManager) manager = cc_keyboard_manager_new ();
+
+        n_warm = 0;
+        g_signal_connect (manager, "shortcut-added", G_CALLBACK (count_shortcut_cb), &n_warm);
+
+        g_timer_start (timer);
+        cc_keyboard_manager_load_shortcuts (manager);
+        warm_time += g_timer_elapsed (timer, NULL);
+    }
+    g_test_minimized_result (warm_time / N_LOAD_ROUNDS, "Warm load of %u shortcuts", n_warm);
+
+    g_assert_cmpuint (n_cold, ==, n_warm);
+}
+
+int
+main (int argc, char **argv)
+{
+    g_setenv ("GSETTINGS_BACKEND", "memory", TRUE);
+    g_setenv ("GDK_BACKEND", "x11", TRUE);
+    g_setenv ("LC_ALL", "C", TRUE);
+
+    gtk_test_init (&argc, &argv, NULL);
+
+    /* Runs first, so that nothing is cached yet */
+    if (g_test_perf ())
+        g_test_add_func ("/keyboard/manager/load-benchmark", test_load_benchmark);
+
+    g_test_add_func ("/keyboard/manager/collision", test_collision);
+    if (g_test_perf ())
+        g_test_add_func ("/keyboard/manager/collision-benchmark", test_collision_benchmark);
+
+    return g_test_run ();
+}
@@ -41,6 +41,14 @@ class PanelTestCase(X11SessionTestCase, GTest):
     g_test_exe = os.path.join(BUILDDIR, 'test-keyboard-shortcuts')
 
 
+class InputCatalogueTestCase(X11SessionTestCase, GTest):
+    g_test_exe = os.path.join(BUILDDIR, 'test-input-catalogue')
+
+
+class ManagerTestCase(X11SessionTestCase, GTest):
+    g_test_exe = os.path.join(BUILDDIR, 'test-keyboard-manager')
+
+
 if __name__ == '__main__':
     # avoid writing to stderr
     unittest.main(testRunner=unittest.TextTestRunner(stream=sys.stdout, verbosity=2))
@@ -432,6 +432,10 @@ class WifiAp(ExportedObj):
         self.__notify(PP_STRENGTH)
         return True
 
+    def set_strength(self, strength):
+        self.strength = strength
+        self.__notify(PP_STRENGTH)
+
     # Properties interface
     def __get_props(self):
         props = {}
@@ -541,6 +545,13 @@ class WifiDevice(Device):
                 return
         raise ApNotFoundException("AP %s not found" % path)
 
+    def set_ap_strengths(self, strengths):
+        aps = {ap.path: ap for ap in self.aps}
+        for path, strength in strengths:
+            if path not in aps:
+                raise ApNotFoundException("AP %s not found" % path)
+            aps[path].set_strength(strength)
+
 
 ###################################################################
 IFACE_WIMAX_NSP = 'org.freedesktop.NetworkManager.WiMax.Nsp'
@@ -1018,6 +1029,14 @@ class NetworkManager(ExportedObj):
                 return
         raise UnknownDeviceException("Device not found")
 
+    @dbus.service.method(IFACE_TEST, in_signature='sa(oy)', out_signature='')
+    def SetWifiApStrengths(self, ifname, strengths):
+        for d in self.devices:
+            if d.iface == ifname:
+                d.set_ap_strengths(strengths)
+                return
+        raise UnknownDeviceException("Device not found")
+
     @dbus.service.method(IFACE_TEST, in_signature='ss', out_signature='o')
     def AddWimaxNsp(self, ifname, name):
         for d in self.devices:
@@ -0,0 +1,369 @@
+/*
+ * Copyright (C) 2026 The GNOME Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define G_LOG_DOMAIN "test-wifi-connection-list"
+
+#include "nm-macros-internal.h"
+
+#include <NetworkManager.h>
+#include <nm-client.h>
+
+#include "nm-test-libnm-utils.h"
+
+#include <adwaita.h>
+#include <gtk/gtk.h>
+
+#include "cc-wifi-connection-list.h"
+#include "cc-wifi-connection-row.h"
+
+typedef struct {
+    NMTstcServiceInfo *sinfo;
+    NMClient *client;
+
+    NMDevice *main_wifi;
+} WifiListFixture;
+
+static void
+fixture_set_up (WifiListFixture *fixture, gconstpointer user_data)
+{
+    g_autoptr(GError) error = NULL;
+
+    /* Bring up the libnm service. */
+    fixture->sinfo = nmtstc_service_init ();
+
+    fixture->client = nm_client_new (NULL, &error);
+    g_assert_no_error (error);
+
+    fixture->main_wifi = nmtstc_service_add_device (fixture->sinfo, fixture->client, "AddWifiDevice", "wlan1000");
+}
+
+static void
+fixture_tear_down (WifiListFixture *fixture, gconstpointer user_data)
+{
+    g_clear_object (&fixture->client);
+    g_clear_pointer (&fixture->sinfo, nmtstc_service_cleanup);
+}
+
+static GList *
+list_rows (GtkListBox *listbox)
+{
+    GList *rows = NULL;
+
+    for (gint i = 0; gtk_list_box_get_row_at_index (listbox, i); i++)
+        rows = g_list_prepend (rows, gtk_list_box_get_row_at_index (listbox, i));
+
+    return g_list_reverse (rows);
+}
+
+static gchar *
+add_wifi_ap (WifiListFixture *fixture, const gchar *ssid, const gchar *hwaddr)
+{
+    g_autoptr(GVariant) ret = NULL;
+    g_autoptr(GError) error = NULL;
+    gchar *path;
+
+    ret = g_dbus_proxy_call_sync (fixture->sinfo->proxy, "AddWifiAp", g_variant_new ("(sss)", "wlan1000", ssid, hwaddr),
+                                  G_DBUS_CALL_FLAGS_NO_AUTO_START, 3000, NULL, &error);
+    g_assert_no_error (error);
+    g_variant_get (ret, "(o)", &path);
+
+    /* Wait for libnm to pick up the AP */
+    while (!nm_device_wifi_get_access_point_by_path (NM_DEVICE_WIFI (fixture->main_wifi), path))
+        g_main_context_iteration (NULL, TRUE);
+
+    return path;
+}
+
+static void
+remove_wifi_ap (WifiListFixture *fixture, const gchar *path)
+{
+    g_autoptr(GVariant) ret = NULL;
+    g_autoptr(GError) error = NULL;
+
+    ret = g_dbus_proxy_call_sync (fixture->sinfo->proxy, "RemoveWifiAp", g_variant_new ("(so)", "wlan1000", path),
+                                  G_DBUS_CALL_FLAGS_NO_AUTO_START, 3000, NULL, &error);
+    g_assert_no_error (error);
+
+    while (nm_device_wifi_get_access_point_by_path (NM_DEVICE_WIFI (fixture->main_wifi), path))
+        g_main_context_iteration (NULL, TRUE);
+}
+
+static void
+count_row_cb (CcWifiConnectionList *list, GtkWidget *row, guint *count)
+{
+    *count += 1;
+}
+
+static void
+test_scan_cycle (WifiListFixture *fixture, gconstpointer user_data)
+{
+    g_autoptr(GPtrArray) ap_paths = g_ptr_array_new_with_free_func (g_free);
+    g_autoptr(GList) rows_before = NULL;
+    g_autoptr(GList) rows_after = NULL;
+    CcWifiConnectionList *list;
+    GtkListBox *listbox;
+    guint created = 0;
+    guint removed = 0;
+    guint i;
+
+    for (i = 0; i < 20; i++) {
+        g_autofree gchar *ssid = g_strdup_printf ("test-ssid-%02u", i);
+        g_autofree gchar *hwaddr = g_strdup_printf ("52:54:00:ab:dc:%02x", i);
+
+        g_ptr_array_add (ap_paths, add_wifi_ap (fixture, ssid, hwaddr));
+    }
+
+    list = cc_wifi_connection_list_new (fixture->client, NM_DEVICE_WIFI (fixture->main_wifi), TRUE, TRUE, FALSE, FALSE,
+                                        TRUE);
+    g_object_ref_sink (list);
+    listbox = cc_wifi_connection_list_get_list_box (list);
+    rows_before = list_rows (listbox);
+    g_assert_cmpuint (g_list_length (rows_before), ==, 20);
+    g_clear_pointer (&rows_before, g_list_free);
+
+    g_signal_connect (list, "add-row", G_CALLBACK (count_row_cb), &created);
+    g_signal_connect (list, "remove-row", G_CALLBACK (count_row_cb), &removed);
+
+    /* Simulate a scan cycle, some APs go away and new ones show up */
+    for (i = 0; i < 5; i++)
+        remove_wifi_ap (fixture, g_ptr_array_index (ap_paths, i));
+
+    for (i = 20; i < 25; i++) {
+        g_autofree gchar *ssid = g_strdup_printf ("test-ssid-%02u", i);
+        g_autofree gchar *hwaddr = g_strdup_printf ("52:54:00:ab:dc:%02x", i);
+
+        g_ptr_array_add (ap_paths, add_wifi_ap (fixture, ssid, hwaddr));
+    }
+
+    g_assert_cmpuint (created, ==, 5);
+    g_assert_cmpuint (removed, ==, 5);
+
+    /* A full update must reuse all existing rows */
+    rows_before = list_rows (listbox);
+    cc_wifi_connection_list_freeze (list);
+    cc_wifi_connection_list_thaw (list);
+    rows_after = list_rows (listbox);
+
+    g_assert_cmpuint (created, ==, 5);
+    g_assert_cmpuint (removed, ==, 5);
+    g_assert_cmpuint (g_list_length (rows_after), ==, 20);
+    for (GList *l = rows_before; l; l = l->next)
+        g_assert_nonnull (g_list_find (rows_after, l->data));
+
+    g_object_unref (list);
+}
+
+static void
+set_wifi_ap_strengths (WifiListFixture *fixture, GPtrArray *ap_paths, const guint8 *strengths)
+{
+    g_autoptr(GVariant) ret = NULL;
+    g_autoptr(GError) error = NULL;
+    GVariantBuilder builder;
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(oy)"));
+    for (guint i = 0; i < ap_paths->len; i++)
+        g_variant_builder_add (&builder, "(oy)", g_ptr_array_index (ap_paths, i), strengths[i]);
+
+    ret = g_dbus_proxy_call_sync (fixture->sinfo->proxy, "SetWifiApStrengths",
+                                  g_variant_new ("(sa(oy))", "wlan1000", &builder), G_DBUS_CALL_FLAGS_NO_AUTO_START,
+                                  3000, NULL, &error);
+    g_assert_no_error (error);
+
+    /* Wait for libnm to deliver all changes */
+    for (guint i = 0; i < ap_paths->len; i++) {
+        NMAccessPoint *ap;
+
+        ap = nm_device_wifi_get_access_point_by_path (NM_DEVICE_WIFI (fixture->main_wifi),
+                                                      g_ptr_array_index (ap_paths, i));
+        while (nm_access_point_get_strength (ap) != strengths[i])
+            g_main_context_iteration (NULL, TRUE);
+    }
+}
+
+typedef struct {
+    GtkListBoxRow *moved_row;
+    guint n_compares;
+    guint n_moved_compares;
+} SortCount;
+
+static gint
+count_sort_cb (GtkListBoxRow *a, GtkListBoxRow *b, gpointer user_data)
+{
+    SortCount *count = user_data;
+
+    if (a == count->moved_row || b == count->moved_row)
+        count->n_moved_compares += 1;
+    else
+        count->n_compares += 1;
+
+    return (gint) cc_wifi_connection_row_get_strength_bucket (CC_WIFI_CONNECTION_ROW (b))
+           - (gint) cc_wifi_connection_row_get_strength_bucket (CC_WIFI_CONNECTION_ROW (a));
+}
+
+#define N_STRENGTH_APS 20
+
+static void
+test_strength_changes (WifiListFixture *fixture, gconstpointer user_data)
+{
+    g_autoptr(GPtrArray) ap_paths = g_ptr_array_new_with_free_func (g_free);
+    guint8 strengths[N_STRENGTH_APS];
+    SortCount count = { NULL, 0, 0 };
+    CcWifiConnectionList *list;
+    GtkWindow *window;
+    GtkListBox *listbox;
+    NMAccessPoint *moved_ap;
+    guint i;
+
+    for (i = 0; i < N_STRENGTH_APS; i++) {
+        g_autofree gchar *ssid = g_strdup_printf ("strength-ssid-%02u", i);
+        g_autofree gchar *hwaddr = g_strdup_printf ("52:54:00:ad:dc:%02x", i);
+
+        g_ptr_array_add (ap_paths, add_wifi_ap (fixture, ssid, hwaddr));
+        strengths[i] = 45;
+    }
+    set_wifi_ap_strengths (fixture, ap_paths, strengths);
+
+    list = cc_wifi_connection_list_new (fixture->client, NM_DEVICE_WIFI (fixture->main_wifi), TRUE, TRUE, FALSE, FALSE,
+                                        TRUE);
+    listbox = cc_wifi_connection_list_get_list_box (list);
+    gtk_list_box_set_sort_func (listbox, count_sort_cb, &count, NULL);
+
+    /* Property changes are only flushed on the frame clock */
+    window = GTK_WINDOW (gtk_window_new ());
+    gtk_window_set_child (window, GTK_WIDGET (list));
+    gtk_window_present (window);
+
+    /* The last row moves to the top, all others fluctuate within their bucket */
+    count.moved_row = gtk_list_box_get_row_at_index (listbox, N_STRENGTH_APS - 1);
+    moved_ap = cc_wifi_connection_row_best_access_point (CC_WIFI_CONNECTION_ROW (count.moved_row));
+    for (i = 0; i < N_STRENGTH_APS; i++) {
+        if (g_str_equal (g_ptr_array_index (ap_paths, i), nm_object_get_path (NM_OBJECT (moved_ap))))
+            strengths[i] = 85;
+        else
+            strengths[i] = 45 + (i % 5) - 2;
+    }
+
+    count.n_compares = 0;
+    count.n_moved_compares = 0;
+    set_wifi_ap_strengths (fixture, ap_paths, strengths);
+
+    /* All pending rows are flushed at once */
+    while (gtk_list_box_get_row_at_index (listbox, 0) != count.moved_row)
+        g_main_context_iteration (NULL, TRUE);
+
+    g_assert_cmpuint (count.n_compares, ==, 0);
+    g_assert_cmpuint (count.n_moved_compares, >, 0);
+
+    gtk_window_destroy (window);
+}
+
+#define N_SCAN_APS 500
+#define N_SCAN_ROUNDS 10
+
+static gboolean
+quit_loop_cb (gpointer user_data)
+{
+    gboolean *done = user_data;
+
+    *done = TRUE;
+
+    return G_SOURCE_REMOVE;
+}
+
+static void
+test_scan_replay (WifiListFixture *fixture, gconstpointer user_data)
+{
+    g_autoptr(GPtrArray) ap_paths = g_ptr_array_new_with_free_func (g_free);
+    g_autoptr(GRand) grand = g_rand_new_with_seed (42);
+    g_autoptr(GTimer) timer = g_timer_new ();
+    guint8 strengths[N_SCAN_APS];
+    SortCount count = { NULL, 0, 0 };
+    CcWifiConnectionList *list;
+    GtkWindow *window;
+    GtkListBox *listbox;
+    guint n_events = 0;
+    gdouble loop_time = 0;
+    guint i, scan_round;
+
+    for (i = 0; i < N_SCAN_APS; i++) {
+        g_autofree gchar *ssid = g_strdup_printf ("scan-ssid-%03u", i);
+        g_autofree gchar *hwaddr = g_strdup_printf ("52:54:00:ac:%02x:%02x", i / 256, i % 256);
+
+        g_ptr_array_add (ap_paths, add_wifi_ap (fixture, ssid, hwaddr));
+        strengths[i] = g_rand_int_range (grand, 5, 95);
+    }
+
+    list = cc_wifi_connection_list_new (fixture->client, NM_DEVICE_WIFI (fixture->main_wifi), TRUE, TRUE, FALSE, FALSE,
+                                        TRUE);
+    listbox = cc_wifi_connection_list_get_list_box (list);
+    gtk_list_box_set_sort_func (listbox, count_sort_cb, &count, NULL);
+
+    window = GTK_WINDOW (gtk_window_new ());
+    gtk_window_set_child (window, GTK_WIDGET (list));
+    gtk_window_present (window);
+
+    count.n_compares = 0;
+
+    /* Replay a scan: every round all APs report a slightly fluctuating
+     * strength, and a few of them a real change. */
+    for (scan_round = 0; scan_round < N_SCAN_ROUNDS; scan_round++) {
+        gboolean done = FALSE;
+
+        for (i = 0; i < N_SCAN_APS; i++) {
+            if (g_rand_int_range (grand, 0, 20) == 0)
+                strengths[i] = g_rand_int_range (grand, 5, 95);
+            else
+                strengths[i] = CLAMP (strengths[i] + g_rand_int_range (grand, -2, 3), 0, 100);
+        }
+        n_events += N_SCAN_APS;
+
+        g_timer_start (timer);
+        set_wifi_ap_strengths (fixture, ap_paths, strengths);
+
+        /* Let a few frames pass for the changes to be flushed */
+        g_timeout_add (100, quit_loop_cb, &done);
+        while (!done)
+            g_main_context_iteration (NULL, TRUE);
+        loop_time += g_timer_elapsed (timer, NULL);
+    }
+
+    g_test_message ("%u strength changes caused %u sort comparisons", n_events, count.n_compares);
+    g_test_minimized_result (loop_time, "Main loop time for %u scan rounds over %u APs", N_SCAN_ROUNDS, N_SCAN_APS);
+
+    gtk_window_destroy (window);
+}
+
+int
+main (int argc, char **argv)
+{
+    g_setenv ("GSETTINGS_BACKEND", "memory", TRUE);
+    g_setenv ("LIBNM_USE_SESSION_BUS", "1", TRUE);
+    g_setenv ("LC_ALL", "C", TRUE);
+
+    gtk_test_init (&argc, &argv, NULL);
+    adw_init ();
+
+    g_test_add ("/wifi-connection-list/scan-cycle", WifiListFixture, NULL, fixture_set_up, test_scan_cycle,
+                fixture_tear_down);
+    g_test_add ("/wifi-connection-list/strength-changes", WifiListFixture, NULL, fixture_set_up,
+                test_strength_changes, fixture_tear_down);
+    if (g_test_perf ())
+        g_test_add ("/wifi-connection-list/scan-replay", WifiListFixture, NULL, fixture_set_up, test_scan_replay,
+                    fixture_tear_down);
+
+    return g_test_run ();
+}
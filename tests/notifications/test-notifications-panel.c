@@ -0,0 +1,290 @@
+/*
+ * Copyright (C) 2026 The GNOME Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define G_LOG_DOMAIN "test-notifications-panel"
+
+#include <adwaita.h>
+#include <glib/gstdio.h>
+
+#include "cc-list-row.h"
+#include "cc-notifications-panel.h"
+
+#define N_APPS 50
+#define N_BENCHMARK_APPS 1000
+#define TIMEOUT_SECONDS 10
+
+typedef struct {
+    GtkWindow *window;
+    CcPanel *panel;
+} NotificationsPanelFixture;
+
+static gchar *data_dir;
+static guint n_apps;
+
+static void
+write_app (const char *name)
+{
+    g_autofree gchar *basename = NULL;
+    g_autofree gchar *path = NULL;
+    g_autofree gchar *contents = NULL;
+    g_autoptr(GError) error = NULL;
+
+    basename = g_strdup_printf ("org.gnome.Test.%s.desktop", name);
+    path = g_build_filename (data_dir, "applications", basename, NULL);
+    contents = g_strdup_printf ("[Desktop Entry]\n"
+                                "Type=Application\n"
+                                "Name=Test App %s\n"
+                                "Exec=true\n"
+                                "X-GNOME-UsesNotifications=true\n",
+                                name);
+
+    g_file_set_contents (path, contents, -1, &error);
+    g_assert_no_error (error);
+}
+
+static void
+remove_app (const char *name)
+{
+    g_autofree gchar *basename = g_strdup_printf ("org.gnome.Test.%s.desktop", name);
+    g_autofree gchar *path = g_build_filename (data_dir, "applications", basename, NULL);
+
+    g_assert_cmpint (g_remove (path), ==, 0);
+}
+
+static void
+remove_data_dir (void)
+{
+    g_autofree gchar *apps_dir = g_build_filename (data_dir, "applications", NULL);
+    g_autoptr(GDir) dir = g_dir_open (apps_dir, 0, NULL);
+    const gchar *name;
+
+    while (dir != NULL && (name = g_dir_read_name (dir)) != NULL) {
+        g_autofree gchar *path = g_build_filename (apps_dir, name, NULL);
+
+        g_remove (path);
+    }
+
+    g_rmdir (apps_dir);
+    g_rmdir (data_dir);
+}
+
+static void
+wait_for_frames (guint n_frames)
+{
+    for (guint i = 0; i < n_frames; i++) {
+        g_usleep (G_USEC_PER_SEC / 60);
+        while (g_main_context_iteration (NULL, FALSE))
+            ;
+    }
+}
+
+static void
+collect_rows (GtkWidget *widget, GPtrArray *rows)
+{
+    GtkWidget *child;
+
+    if (CC_IS_LIST_ROW (widget)
+        && g_str_has_prefix (adw_preferences_row_get_title (ADW_PREFERENCES_ROW (widget)), "Test App "))
+        g_ptr_array_add (rows, widget);
+
+    for (child = gtk_widget_get_first_child (widget); child != NULL; child = gtk_widget_get_next_sibling (child))
+        collect_rows (child, rows);
+}
+
+/* The rows of the synthetic apps, in list order */
+static GPtrArray *
+get_rows (NotificationsPanelFixture *fixture)
+{
+    GPtrArray *rows = g_ptr_array_new ();
+
+    collect_rows (GTK_WIDGET (fixture->panel), rows);
+
+    return rows;
+}
+
+static GtkWidget *
+find_row (NotificationsPanelFixture *fixture, const char *title)
+{
+    g_autoptr(GPtrArray) rows = get_rows (fixture);
+
+    for (guint i = 0; i < rows->len; i++) {
+        if (g_strcmp0 (adw_preferences_row_get_title (g_ptr_array_index (rows, i)), title) == 0)
+            return g_ptr_array_index (rows, i);
+    }
+
+    return NULL;
+}
+
+static gboolean
+row_is_bound (GtkWidget *row)
+{
+    g_autofree gchar *label = NULL;
+
+    g_object_get (row, "secondary-label", &label, NULL);
+
+    return label != NULL && *label != '\0';
+}
+
+static guint
+count_bound_rows (NotificationsPanelFixture *fixture)
+{
+    g_autoptr(GPtrArray) rows = get_rows (fixture);
+    guint n_bound = 0;
+
+    for (guint i = 0; i < rows->len; i++) {
+        if (row_is_bound (g_ptr_array_index (rows, i)))
+            n_bound++;
+    }
+
+    return n_bound;
+}
+
+static void
+fixture_set_up (NotificationsPanelFixture *fixture, gconstpointer user_data)
+{
+    fixture->window = GTK_WINDOW (gtk_window_new ());
+    gtk_window_set_default_size (fixture->window, 600, 400);
+    fixture->panel = g_object_ref_sink (g_object_new (CC_TYPE_NOTIFICATIONS_PANEL, NULL));
+    gtk_window_set_child (fixture->window, GTK_WIDGET (fixture->panel));
+    gtk_window_present (fixture->window);
+}
+
+static void
+fixture_tear_down (NotificationsPanelFixture *fixture, gconstpointer user_data)
+{
+    g_clear_pointer (&fixture->window, gtk_window_destroy);
+    g_clear_object (&fixture->panel);
+}
+
+static void
+test_lazy_settings (NotificationsPanelFixture *fixture, gconstpointer user_data)
+{
+    g_autoptr(GPtrArray) rows = NULL;
+    GtkWidget *scrolled_window;
+    GtkAdjustment *vadjustment;
+    GtkWidget *last_row;
+
+    wait_for_frames (5);
+
+    rows = get_rows (fixture);
+    g_assert_cmpuint (rows->len, ==, n_apps);
+
+    /* Only the rows around the visible part of the list are bound */
+    g_assert_true (row_is_bound (g_ptr_array_index (rows, 0)));
+    last_row = g_ptr_array_index (rows, rows->len - 1);
+    g_assert_false (row_is_bound (last_row));
+    g_assert_cmpuint (count_bound_rows (fixture), <, n_apps);
+
+    /* Scrolling to the end binds the last row */
+    scrolled_window = gtk_widget_get_ancestor (last_row, GTK_TYPE_SCROLLED_WINDOW);
+    g_assert_nonnull (scrolled_window);
+    vadjustment = gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (scrolled_window));
+    gtk_adjustment_set_value (vadjustment, gtk_adjustment_get_upper (vadjustment));
+
+    wait_for_frames (5);
+    g_assert_true (row_is_bound (last_row));
+}
+
+static void
+test_incremental_refresh (NotificationsPanelFixture *fixture, gconstpointer user_data)
+{
+    g_autoptr(GTimer) timer = NULL;
+    GtkWidget *first_row;
+
+    wait_for_frames (5);
+    first_row = find_row (fixture, "Test App 0000");
+    g_assert_nonnull (first_row);
+
+    /* Installing an app adds its row, and keeps the other ones */
+    write_app ("New");
+    timer = g_timer_new ();
+    while (find_row (fixture, "Test App New") == NULL) {
+        g_assert_cmpfloat (g_timer_elapsed (timer, NULL), <, TIMEOUT_SECONDS);
+        wait_for_frames (1);
+    }
+    g_assert_true (find_row (fixture, "Test App 0000") == first_row);
+
+    /* Removing it removes the row */
+    remove_app ("New");
+    g_timer_start (timer);
+    while (find_row (fixture, "Test App New") != NULL) {
+        g_assert_cmpfloat (g_timer_elapsed (timer, NULL), <, TIMEOUT_SECONDS);
+        wait_for_frames (1);
+    }
+    g_assert_true (find_row (fixture, "Test App 0000") == first_row);
+}
+
+static void
+test_benchmark (void)
+{
+    NotificationsPanelFixture fixture = { 0 };
+    g_autoptr(GPtrArray) rows = NULL;
+    g_autoptr(GTimer) timer = g_timer_new ();
+
+    fixture_set_up (&fixture, NULL);
+    wait_for_frames (1);
+    g_test_minimized_result (g_timer_elapsed (timer, NULL), "Opening the panel with %u apps", n_apps);
+
+    rows = get_rows (&fixture);
+    g_assert_cmpuint (rows->len, ==, n_apps);
+    g_test_message ("%u of %u rows have their settings", count_bound_rows (&fixture), n_apps);
+
+    fixture_tear_down (&fixture, NULL);
+}
+
+int
+main (int argc, char **argv)
+{
+    g_autofree gchar *apps_dir = NULL;
+    g_autoptr(GError) error = NULL;
+    int ret;
+
+    g_setenv ("GSETTINGS_BACKEND", "memory", TRUE);
+    g_setenv ("XDG_CURRENT_DESKTOP", "GNOME", TRUE);
+    g_setenv ("LC_ALL", "C", TRUE);
+
+    /* The synthetic apps are found before the installed ones */
+    data_dir = g_dir_make_tmp ("test-notifications-panel-XXXXXX", &error);
+    g_assert_no_error (error);
+    apps_dir = g_build_filename (data_dir, "applications", NULL);
+    g_assert_cmpint (g_mkdir (apps_dir, 0755), ==, 0);
+    g_setenv ("XDG_DATA_HOME", data_dir, TRUE);
+
+    gtk_test_init (&argc, &argv, NULL);
+    adw_init ();
+
+    n_apps = g_test_perf () ? N_BENCHMARK_APPS : N_APPS;
+    for (guint i = 0; i < n_apps; i++) {
+        g_autofree gchar *name = g_strdup_printf ("%04u", i);
+
+        write_app (name);
+    }
+
+    g_test_add ("/notifications-panel/lazy-settings", NotificationsPanelFixture, NULL, fixture_set_up,
+                test_lazy_settings, fixture_tear_down);
+    g_test_add ("/notifications-panel/incremental-refresh", NotificationsPanelFixture, NULL, fixture_set_up,
+                test_incremental_refresh, fixture_tear_down);
+    if (g_test_perf ())
+        g_test_add_func ("/notifications-panel/benchmark", test_benchmark);
+
+    ret = g_test_run ();
+
+    remove_data_dir ();
+    g_free (data_dir);
+
+    return ret;
+}
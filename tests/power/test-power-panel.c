@@ -0,0 +1,354 @@
+/*
+ * Copyright (C) 2026 The GNOME Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define G_LOG_DOMAIN "test-power-panel"
+
+#include <adwaita.h>
+#include <libupower-glib/upower.h>
+
+#include "cc-battery-row.h"
+#include "cc-object-storage.h"
+#include "cc-power-panel.h"
+#include "cc-power-profile-row.h"
+
+/* Must match test-power-panel.py */
+#define N_PERIPHERALS 50
+
+typedef struct {
+    GtkWindow *window;
+    CcPanel *panel;
+    UpClient *client;
+    GDBusConnection *bus;
+    gboolean profiles_stalled;
+} PowerPanelFixture;
+
+static void
+fixture_set_up (PowerPanelFixture *fixture, gconstpointer user_data)
+{
+    g_autoptr(GError) error = NULL;
+
+    fixture->bus = g_bus_get_sync (G_BUS_TYPE_SYSTEM, NULL, &error);
+    g_assert_no_error (error);
+
+    fixture->client = up_client_new ();
+    g_assert_nonnull (fixture->client);
+
+    fixture->window = GTK_WINDOW (gtk_window_new ());
+    fixture->panel = g_object_ref_sink (g_object_new (CC_TYPE_POWER_PANEL, NULL));
+    gtk_window_set_child (fixture->window, GTK_WIDGET (fixture->panel));
+    gtk_window_present (fixture->window);
+}
+
+static void
+stall_cb (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+    PowerPanelFixture *fixture = user_data;
+    g_autoptr(GVariant) result = NULL;
+    g_autoptr(GError) error = NULL;
+
+    result = g_dbus_connection_call_finish (G_DBUS_CONNECTION (source_object), res, &error);
+    g_assert_no_error (error);
+
+    fixture->profiles_stalled = FALSE;
+}
+
+static void
+fixture_set_up_stalled_profiles (PowerPanelFixture *fixture, gconstpointer user_data)
+{
+    g_autoptr(GDBusConnection) bus = NULL;
+    g_autoptr(GError) error = NULL;
+
+    bus = g_bus_get_sync (G_BUS_TYPE_SYSTEM, NULL, &error);
+    g_assert_no_error (error);
+
+    /* Keeps the mock daemon busy, so every call the panel makes is held up */
+    fixture->profiles_stalled = TRUE;
+    g_dbus_connection_call (bus, "org.freedesktop.UPower.PowerProfiles", "/org/freedesktop/UPower/PowerProfiles",
+                            "org.freedesktop.UPower.PowerProfiles", "Stall", NULL, NULL, G_DBUS_CALL_FLAGS_NONE, -1,
+                            NULL, stall_cb, fixture);
+
+    fixture_set_up (fixture, user_data);
+}
+
+static void
+fixture_tear_down (PowerPanelFixture *fixture, gconstpointer user_data)
+{
+    /* Don't leave the daemon busy for the following tests */
+    while (fixture->profiles_stalled)
+        g_main_context_iteration (NULL, TRUE);
+
+    g_clear_pointer (&fixture->window, gtk_window_destroy);
+    g_clear_object (&fixture->panel);
+    g_clear_object (&fixture->client);
+    g_clear_object (&fixture->bus);
+}
+
+static void
+collect_rows (GtkWidget *widget, GHashTable *rows)
+{
+    GtkWidget *child;
+
+    if (CC_IS_BATTERY_ROW (widget))
+        g_hash_table_add (rows, widget);
+
+    for (child = gtk_widget_get_first_child (widget); child != NULL; child = gtk_widget_get_next_sibling (child))
+        collect_rows (child, rows);
+}
+
+static GHashTable *
+get_rows (PowerPanelFixture *fixture)
+{
+    GHashTable *rows = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+    collect_rows (GTK_WIDGET (fixture->panel), rows);
+
+    return rows;
+}
+
+static guint
+count_profile_rows (GtkWidget *widget)
+{
+    GtkWidget *child;
+    guint n_rows = CC_IS_POWER_PROFILE_ROW (widget) ? 1 : 0;
+
+    for (child = gtk_widget_get_first_child (widget); child != NULL; child = gtk_widget_get_next_sibling (child))
+        n_rows += count_profile_rows (child);
+
+    return n_rows;
+}
+
+static void
+wait_for_rows (PowerPanelFixture *fixture, guint n_rows)
+{
+    while (TRUE) {
+        g_autoptr(GHashTable) rows = get_rows (fixture);
+
+        if (g_hash_table_size (rows) == n_rows)
+            break;
+        g_main_context_iteration (NULL, TRUE);
+    }
+}
+
+static gboolean
+panel_updated_cb (GtkWidget *widget, GdkFrameClock *frame_clock, gpointer user_data)
+{
+    gboolean *updated = user_data;
+
+    *updated = TRUE;
+
+    return G_SOURCE_REMOVE;
+}
+
+static void
+wait_for_panel_update (PowerPanelFixture *fixture)
+{
+    gboolean updated = FALSE;
+
+    /* Tick callbacks run in the order they were added, so the panel applied
+     * the changes it queued before this one runs */
+    gtk_widget_add_tick_callback (GTK_WIDGET (fixture->panel), panel_updated_cb, &updated, NULL);
+    while (!updated)
+        g_main_context_iteration (NULL, TRUE);
+}
+
+static void
+set_device_properties (PowerPanelFixture *fixture, UpDevice *device, GVariant *properties)
+{
+    g_autoptr(GVariant) result = NULL;
+    g_autoptr(GError) error = NULL;
+
+    result = g_dbus_connection_call_sync (fixture->bus, "org.freedesktop.UPower", "/org/freedesktop/UPower",
+                                          "org.freedesktop.DBus.Mock", "SetDeviceProperties",
+                                          g_variant_new ("(o@a{sv})", up_device_get_object_path (device), properties),
+                                          NULL, G_DBUS_CALL_FLAGS_NONE, -1, NULL, &error);
+    g_assert_no_error (error);
+}
+
+static gdouble
+get_percentage (UpDevice *device)
+{
+    gdouble percentage;
+
+    g_object_get (device, "percentage", &percentage, NULL);
+
+    return percentage;
+}
+
+static UpDeviceKind
+get_kind (UpDevice *device)
+{
+    UpDeviceKind kind;
+
+    g_object_get (device, "kind", &kind, NULL);
+
+    return kind;
+}
+
+static GPtrArray *
+get_peripherals (PowerPanelFixture *fixture)
+{
+    g_autoptr(GPtrArray) devices = up_client_get_devices2 (fixture->client);
+    GPtrArray *peripherals = g_ptr_array_new_with_free_func (g_object_unref);
+
+    for (guint i = 0; i < devices->len; i++) {
+        UpDevice *device = g_ptr_array_index (devices, i);
+
+        if (get_kind (device) == UP_DEVICE_KIND_MOUSE)
+            g_ptr_array_add (peripherals, g_object_ref (device));
+    }
+
+    return peripherals;
+}
+
+static void
+test_rows_created (PowerPanelFixture *fixture, gconstpointer user_data)
+{
+    g_autoptr(GHashTable) rows = NULL;
+
+    /* One row per peripheral and one for the laptop battery */
+    wait_for_rows (fixture, N_PERIPHERALS + 1);
+
+    /* Nothing is added twice once everything settled */
+    wait_for_panel_update (fixture);
+    rows = get_rows (fixture);
+    g_assert_cmpuint (g_hash_table_size (rows), ==, N_PERIPHERALS + 1);
+}
+
+static void
+test_rows_updated_in_place (PowerPanelFixture *fixture, gconstpointer user_data)
+{
+    g_autoptr(GPtrArray) peripherals = NULL;
+    g_autoptr(GHashTable) rows_before = NULL;
+    g_autoptr(GHashTable) rows_after = NULL;
+    g_autoptr(GTimer) timer = NULL;
+    GHashTableIter iter;
+    gpointer row;
+    guint n_created = 0;
+
+    wait_for_rows (fixture, N_PERIPHERALS + 1);
+    rows_before = get_rows (fixture);
+
+    peripherals = get_peripherals (fixture);
+    g_assert_cmpuint (peripherals->len, ==, N_PERIPHERALS);
+
+    /* Every peripheral reports a new charge level */
+    for (guint i = 0; i < peripherals->len; i++) {
+        GVariantBuilder builder;
+
+        g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
+        g_variant_builder_add (&builder, "{sv}", "Percentage", g_variant_new_double (10.0 + i));
+        set_device_properties (fixture, g_ptr_array_index (peripherals, i), g_variant_builder_end (&builder));
+    }
+
+    timer = g_timer_new ();
+    for (guint i = 0; i < peripherals->len; i++) {
+        while (get_percentage (g_ptr_array_index (peripherals, i)) != 10.0 + i)
+            g_main_context_iteration (NULL, TRUE);
+    }
+    wait_for_panel_update (fixture);
+    if (g_test_perf ())
+        g_test_minimized_result (g_timer_elapsed (timer, NULL), "Main loop time for %u changed devices",
+                                 peripherals->len);
+
+    rows_after = get_rows (fixture);
+    g_assert_cmpuint (g_hash_table_size (rows_after), ==, g_hash_table_size (rows_before));
+
+    g_hash_table_iter_init (&iter, rows_after);
+    while (g_hash_table_iter_next (&iter, &row, NULL)) {
+        if (!g_hash_table_contains (rows_before, row))
+            n_created++;
+    }
+    g_test_message ("%u rows created for %u changed devices", n_created, peripherals->len);
+    g_assert_cmpuint (n_created, ==, 0);
+}
+
+static void
+test_kind_change_rebuilds (PowerPanelFixture *fixture, gconstpointer user_data)
+{
+    g_autoptr(GPtrArray) peripherals = NULL;
+    g_autoptr(GHashTable) rows_before = NULL;
+    g_autoptr(GHashTable) rows_after = NULL;
+    GVariantBuilder builder;
+    GHashTableIter iter;
+    gpointer row;
+
+    wait_for_rows (fixture, N_PERIPHERALS + 1);
+    rows_before = get_rows (fixture);
+
+    peripherals = get_peripherals (fixture);
+    g_assert_cmpuint (peripherals->len, >, 0);
+
+    /* Moving a device to another section recreates the rows */
+    g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
+    g_variant_builder_add (&builder, "{sv}", "Type", g_variant_new_uint32 (UP_DEVICE_KIND_KEYBOARD));
+    set_device_properties (fixture, g_ptr_array_index (peripherals, 0), g_variant_builder_end (&builder));
+    while (get_kind (g_ptr_array_index (peripherals, 0)) != UP_DEVICE_KIND_KEYBOARD)
+        g_main_context_iteration (NULL, TRUE);
+    wait_for_panel_update (fixture);
+
+    rows_after = get_rows (fixture);
+    g_assert_cmpuint (g_hash_table_size (rows_after), ==, g_hash_table_size (rows_before));
+    g_hash_table_iter_init (&iter, rows_after);
+    while (g_hash_table_iter_next (&iter, &row, NULL))
+        g_assert_false (g_hash_table_contains (rows_before, row));
+
+    /* Restore the mock for the following tests */
+    g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
+    g_variant_builder_add (&builder, "{sv}", "Type", g_variant_new_uint32 (UP_DEVICE_KIND_MOUSE));
+    set_device_properties (fixture, g_ptr_array_index (peripherals, 0), g_variant_builder_end (&builder));
+}
+
+static void
+test_stalled_profiles_daemon (PowerPanelFixture *fixture, gconstpointer user_data)
+{
+    g_autoptr(GTimer) timer = g_timer_new ();
+
+    /* The rest of the panel doesn't wait for power-profiles-daemon */
+    wait_for_rows (fixture, N_PERIPHERALS + 1);
+    if (g_test_perf ())
+        g_test_minimized_result (g_timer_elapsed (timer, NULL), "Time to show the devices while the daemon is busy");
+    g_assert_true (fixture->profiles_stalled);
+    g_assert_cmpuint (count_profile_rows (GTK_WIDGET (fixture->panel)), ==, 0);
+
+    /* The profiles show up once the daemon answers */
+    while (count_profile_rows (GTK_WIDGET (fixture->panel)) == 0)
+        g_main_context_iteration (NULL, TRUE);
+    g_assert_false (fixture->profiles_stalled);
+    g_assert_cmpuint (count_profile_rows (GTK_WIDGET (fixture->panel)), ==, 3);
+}
+
+int
+main (int argc, char **argv)
+{
+    g_setenv ("GSETTINGS_BACKEND", "memory", TRUE);
+    g_setenv ("LC_ALL", "C", TRUE);
+
+    gtk_test_init (&argc, &argv, NULL);
+    adw_init ();
+    cc_object_storage_initialize ();
+
+    g_test_add ("/power-panel/rows-created", PowerPanelFixture, NULL, fixture_set_up, test_rows_created,
+                fixture_tear_down);
+    g_test_add ("/power-panel/rows-updated-in-place", PowerPanelFixture, NULL, fixture_set_up,
+                test_rows_updated_in_place, fixture_tear_down);
+    g_test_add ("/power-panel/kind-change-rebuilds", PowerPanelFixture, NULL, fixture_set_up,
+                test_kind_change_rebuilds, fixture_tear_down);
+    g_test_add ("/power-panel/stalled-profiles-daemon", PowerPanelFixture, NULL, fixture_set_up_stalled_profiles,
+                test_stalled_profiles_daemon, fixture_tear_down);
+
+    return g_test_run ();
+}
@@ -0,0 +1,81 @@
+#!/usr/bin/env python3
+# Copyright © 2026 The GNOME Project
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+import os
+import subprocess
+import sys
+import unittest
+
+try:
+    import dbus
+    import dbusmock
+except ImportError:
+    sys.stderr.write('You need python-dbusmock (http://pypi.python.org/pypi/python-dbusmock) for this test suite.\n')
+    sys.exit(1)
+
+# Add the shared directory to the search path
+sys.path.append(os.path.join(os.path.dirname(__file__), '..', 'shared'))
+
+from gtest import GTest
+from x11session import X11SessionTestCase
+
+BUILDDIR = os.environ.get('BUILDDIR', os.path.join(os.path.dirname(__file__)))
+
+# Must match test-power-panel.c
+N_PERIPHERALS = 50
+
+PROFILES_STALL_SECONDS = 5
+UP_DEVICE_KIND_MOUSE = 5
+
+
+class PanelTestCase(X11SessionTestCase, GTest):
+    g_test_exe = os.path.join(BUILDDIR, 'test-power-panel')
+
+    @classmethod
+    def setUpClass(klass):
+        super().setUpClass()
+
+        klass.upower, klass.upower_obj = klass.spawn_server_template(
+            'upower', {'DaemonVersion': '0.99', 'OnBattery': True}, stdout=subprocess.DEVNULL)
+        klass.upower_obj.AddDischargingBattery('mock_BAT', 'Mock Battery', 30.0, 1200)
+
+        # Wireless peripherals report their charge level every now and then
+        for i in range(N_PERIPHERALS):
+            path = klass.upower_obj.AddDischargingBattery('mock_MOUSE%d' % i, 'Mouse %d' % i, 50.0, 0)
+            klass.upower_obj.SetDeviceProperties(path, {
+                'Type': dbus.UInt32(UP_DEVICE_KIND_MOUSE),
+                'PowerSupply': dbus.Boolean(False),
+            })
+
+        # Blocking the mock's main loop simulates a daemon that is slow to answer
+        klass.ppd, klass.ppd_obj = klass.spawn_server_template(
+            'upower_power_profiles_daemon', {}, stdout=subprocess.DEVNULL)
+        klass.ppd_obj.AddMethod('org.freedesktop.UPower.PowerProfiles', 'Stall', '', '',
+                                'import time; time.sleep(%d)' % PROFILES_STALL_SECONDS)
+
+    @classmethod
+    def tearDownClass(klass):
+        klass.ppd.terminate()
+        klass.ppd.wait()
+        klass.upower.terminate()
+        klass.upower.wait()
+
+        super().tearDownClass()
+
+
+if __name__ == '__main__':
+    # avoid writing to stderr
+    unittest.main(testRunner=unittest.TextTestRunner(stream=sys.stdout, verbosity=2))
@@ -0,0 +1,142 @@
+#include "config.h"
+
+#include <glib.h>
+#include <locale.h>
+#include <string.h>
+
+#include "pp-device-search-index.h"
+
+#define N_BENCHMARK_DEVICES 2000
+
+static PpPrintDevice *
+new_device (const gchar *name, const gchar *location)
+{
+    return g_object_new (PP_TYPE_PRINT_DEVICE, "device-name", name, "display-name", name, "device-location", location,
+                         NULL);
+}
+
+static gboolean
+lookup_contains (PpDeviceSearchIndex *search_index, const gchar *text, PpPrintDevice *device)
+{
+    g_autoptr(GHashTable) matches = pp_device_search_index_lookup (search_index, text);
+
+    return g_hash_table_contains (matches, device);
+}
+
+static void
+test_lookup (void)
+{
+    g_autoptr(PpDeviceSearchIndex) search_index = pp_device_search_index_new ();
+    g_autoptr(PpPrintDevice) laser = new_device ("HP-LaserJet-4250", "Reception");
+    g_autoptr(PpPrintDevice) inkjet = new_device ("Canon-Pixma", "Küche");
+    g_autoptr(PpPrintDevice) server = new_device ("print-server.example.com", NULL);
+    g_autoptr(GHashTable) all = NULL;
+
+    pp_device_search_index_add (search_index, laser);
+    pp_device_search_index_add (search_index, inkjet);
+    pp_device_search_index_add (search_index, server);
+    g_assert_cmpuint (pp_device_search_index_get_n_devices (search_index), ==, 3);
+
+    all = pp_device_search_index_lookup (search_index, "");
+    g_assert_cmpuint (g_hash_table_size (all), ==, 3);
+
+    /* Short words are answered from the n-gram table */
+    g_assert_true (lookup_contains (search_index, "h", laser));
+    g_assert_true (lookup_contains (search_index, "hp", laser));
+    g_assert_false (lookup_contains (search_index, "hp", inkjet));
+
+    /* Longer words are verified against the keys */
+    g_assert_true (lookup_contains (search_index, "laserjet", laser));
+    g_assert_true (lookup_contains (search_index, "LASERJET", laser));
+    g_assert_false (lookup_contains (search_index, "laserjot", laser));
+    g_assert_true (lookup_contains (search_index, "example.com", server));
+
+    /* Words may match either the name or the location */
+    g_assert_true (lookup_contains (search_index, "4250 reception", laser));
+    g_assert_false (lookup_contains (search_index, "4250 kitchen", laser));
+    g_assert_true (lookup_contains (search_index, "pixma  ", inkjet));
+
+    /* Keys are unaccented */
+    g_assert_true (lookup_contains (search_index, "kuche", inkjet));
+    g_assert_true (lookup_contains (search_index, "küche", inkjet));
+
+    pp_device_search_index_remove (search_index, inkjet);
+    g_assert_cmpuint (pp_device_search_index_get_n_devices (search_index), ==, 2);
+    g_assert_false (lookup_contains (search_index, "pixma", inkjet));
+
+    /* Re-adding a device refreshes its keys */
+    g_object_set (laser, "device-location", "Basement", NULL);
+    pp_device_search_index_add (search_index, laser);
+    g_assert_cmpuint (pp_device_search_index_get_n_devices (search_index), ==, 2);
+    g_assert_false (lookup_contains (search_index, "reception", laser));
+    g_assert_true (lookup_contains (search_index, "basement", laser));
+}
+
+static void
+test_lookup_benchmark (void)
+{
+    const gchar *query = "floor-12 laserjet 1234";
+    g_autoptr(PpDeviceSearchIndex) search_index = pp_device_search_index_new ();
+    g_autoptr(GPtrArray) devices = g_ptr_array_new_with_free_func (g_object_unref);
+    g_autoptr(GTimer) timer = g_timer_new ();
+    gdouble indexed_time;
+    gdouble linear_time;
+    guint n_matches = 0;
+
+    for (guint i = 0; i < N_BENCHMARK_DEVICES; i++) {
+        g_autofree gchar *name = g_strdup_printf ("HP-LaserJet-%04u-Floor-%u", i, i % 40);
+        g_autofree gchar *location = g_strdup_printf ("Building %u, Room %u", i % 7, i);
+
+        g_ptr_array_add (devices, new_device (name, location));
+    }
+
+    g_timer_start (timer);
+    for (guint i = 0; i < devices->len; i++)
+        pp_device_search_index_add (search_index, g_ptr_array_index (devices, i));
+    g_test_minimized_result (g_timer_elapsed (timer, NULL), "Indexing %u devices", devices->len);
+
+    /* Simulate typing the query one character at a time */
+    g_timer_start (timer);
+    for (gsize len = 1; len <= strlen (query); len++) {
+        g_autofree gchar *text = g_strndup (query, len);
+        g_autoptr(GHashTable) matches = pp_device_search_index_lookup (search_index, text);
+
+        n_matches += g_hash_table_size (matches);
+    }
+    indexed_time = g_timer_elapsed (timer, NULL);
+
+    /* The previous implementation: lowercase every device on every keystroke */
+    g_timer_start (timer);
+    for (gsize len = 1; len <= strlen (query); len++) {
+        g_autofree gchar *text = g_ascii_strdown (query, len);
+        g_auto(GStrv) words = g_strsplit_set (text, " ", -1);
+
+        for (guint i = 0; i < devices->len; i++) {
+            PpPrintDevice *device = g_ptr_array_index (devices, i);
+            g_autofree gchar *name = g_ascii_strdown (pp_print_device_get_device_name (device), -1);
+            g_autofree gchar *location = g_ascii_strdown (pp_print_device_get_device_location (device), -1);
+
+            for (gint j = 0; words[j] != NULL; j++)
+                if (!g_strrstr (name, words[j]) && !g_strrstr (location, words[j]))
+                    break;
+        }
+    }
+    linear_time = g_timer_elapsed (timer, NULL);
+
+    g_assert_cmpuint (n_matches, >, 0);
+    g_test_minimized_result (indexed_time, "Indexed search over %u devices", devices->len);
+    g_test_minimized_result (linear_time, "Linear search over %u devices", devices->len);
+}
+
+int
+main (int argc, char **argv)
+{
+    setlocale (LC_ALL, "");
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/printers/device-search-index/lookup", test_lookup);
+    if (g_test_perf ())
+        g_test_add_func ("/printers/device-search-index/benchmark", test_lookup_benchmark);
+
+    return g_test_run ();
+}
@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2026 The GNOME Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define G_LOG_DOMAIN "test-sharing-networks"
+
+#include <adwaita.h>
+
+#include "cc-sharing-networks.h"
+#include "cc-sharing-resources.h"
+#include "org.gnome.SettingsDaemon.Sharing.h"
+
+#define SHARING_BUS_NAME "org.gnome.SettingsDaemon.Sharing"
+#define SHARING_OBJECT_PATH "/org/gnome/SettingsDaemon/Sharing"
+
+typedef struct {
+    GtkWindow *window;
+    GtkWidget *networks;
+    GsdSharing *proxy;
+    GDBusConnection *bus;
+} SharingNetworksFixture;
+
+static void
+call_mock (SharingNetworksFixture *fixture, const char *method, GVariant *parameters)
+{
+    g_autoptr(GVariant) result = NULL;
+    g_autoptr(GError) error = NULL;
+
+    result = g_dbus_connection_call_sync (fixture->bus, SHARING_BUS_NAME, SHARING_OBJECT_PATH, SHARING_BUS_NAME, method,
+                                          parameters, NULL, G_DBUS_CALL_FLAGS_NONE, -1, NULL, &error);
+    g_assert_no_error (error);
+}
+
+static guint
+count_mock_calls (SharingNetworksFixture *fixture, const char *method)
+{
+    g_autoptr(GVariant) result = NULL;
+    g_autoptr(GVariant) calls = NULL;
+    g_autoptr(GError) error = NULL;
+
+    result = g_dbus_connection_call_sync (fixture->bus, SHARING_BUS_NAME, SHARING_OBJECT_PATH,
+                                          "org.freedesktop.DBus.Mock", "GetMethodCalls", g_variant_new ("(s)", method),
+                                          G_VARIANT_TYPE ("(a(tav))"), G_DBUS_CALL_FLAGS_NONE, -1, NULL, &error);
+    g_assert_no_error (error);
+
+    calls = g_variant_get_child_value (result, 0);
+
+    return g_variant_n_children (calls);
+}
+
+static GtkWidget *
+find_network_row (GtkWidget *widget, const char *uuid)
+{
+    GtkWidget *child;
+
+    if (g_strcmp0 (g_object_get_data (G_OBJECT (widget), "uuid"), uuid) == 0 && gtk_widget_get_visible (widget))
+        return widget;
+
+    for (child = gtk_widget_get_first_child (widget); child != NULL; child = gtk_widget_get_next_sibling (child)) {
+        GtkWidget *row = find_network_row (child, uuid);
+
+        if (row != NULL)
+            return row;
+    }
+
+    return NULL;
+}
+
+static GtkWidget *
+find_remove_button (GtkWidget *widget, GtkWidget *row)
+{
+    GtkWidget *child;
+
+    if (GTK_IS_BUTTON (widget) && g_object_get_data (G_OBJECT (widget), "row") == row)
+        return widget;
+
+    for (child = gtk_widget_get_first_child (widget); child != NULL; child = gtk_widget_get_next_sibling (child)) {
+        GtkWidget *button = find_remove_button (child, row);
+
+        if (button != NULL)
+            return button;
+    }
+
+    return NULL;
+}
+
+static void
+flush_mock (SharingNetworksFixture *fixture)
+{
+    /* The mock answers in order, so the replies to the widget are queued once this one is back */
+    count_mock_calls (fixture, "ListNetworks");
+
+    while (g_main_context_iteration (NULL, FALSE))
+        ;
+}
+
+static void
+wait_for_network_row (SharingNetworksFixture *fixture, const char *uuid, gboolean present)
+{
+    while ((find_network_row (fixture->networks, uuid) != NULL) != present)
+        g_main_context_iteration (NULL, TRUE);
+}
+
+static void
+fixture_set_up (SharingNetworksFixture *fixture, gconstpointer user_data)
+{
+    g_autoptr(GError) error = NULL;
+
+    fixture->bus = g_bus_get_sync (G_BUS_TYPE_SESSION, NULL, &error);
+    g_assert_no_error (error);
+    call_mock (fixture, "Reset", NULL);
+
+    fixture->proxy = gsd_sharing_proxy_new_for_bus_sync (G_BUS_TYPE_SESSION, G_DBUS_PROXY_FLAGS_NONE, SHARING_BUS_NAME,
+                                                         SHARING_OBJECT_PATH, NULL, &error);
+    g_assert_no_error (error);
+
+    fixture->window = GTK_WINDOW (gtk_window_new ());
+    fixture->networks = g_object_ref_sink (cc_sharing_networks_new (G_DBUS_PROXY (fixture->proxy), "rygel"));
+    gtk_window_set_child (fixture->window, fixture->networks);
+    gtk_window_present (fixture->window);
+
+    /* The list of networks is fetched asynchronously */
+    wait_for_network_row (fixture, "office-uuid", TRUE);
+}
+
+static void
+fixture_tear_down (SharingNetworksFixture *fixture, gconstpointer user_data)
+{
+    g_clear_pointer (&fixture->window, gtk_window_destroy);
+    g_clear_object (&fixture->networks);
+    g_clear_object (&fixture->proxy);
+    g_clear_object (&fixture->bus);
+}
+
+static void
+test_toggle_does_not_block (SharingNetworksFixture *fixture, gconstpointer user_data)
+{
+    GtkSwitch *current_switch = g_object_get_data (G_OBJECT (fixture->networks), "switch");
+    g_autoptr(GTimer) timer = NULL;
+    guint n_list_calls;
+    guint status;
+
+    n_list_calls = count_mock_calls (fixture, "ListNetworks");
+    call_mock (fixture, "SetDelay", g_variant_new ("(d)", 1.0));
+
+    /* The switch reflects the change before the daemon answers */
+    timer = g_timer_new ();
+    gtk_switch_set_active (current_switch, TRUE);
+    if (g_test_perf ())
+        g_test_minimized_result (g_timer_elapsed (timer, NULL), "Time to toggle the switch");
+    g_assert_true (gtk_switch_get_state (current_switch));
+    g_object_get (fixture->networks, "status", &status, NULL);
+    g_assert_cmpuint (status, ==, CC_SHARING_STATUS_ACTIVE);
+
+    flush_mock (fixture);
+    g_assert_true (gtk_switch_get_state (current_switch));
+
+    /* The cached list was updated without listing the networks again */
+    g_assert_cmpuint (count_mock_calls (fixture, "EnableService"), >, 0);
+    g_assert_cmpuint (count_mock_calls (fixture, "ListNetworks"), ==, n_list_calls);
+}
+
+static void
+test_toggle_rollback (SharingNetworksFixture *fixture, gconstpointer user_data)
+{
+    GtkSwitch *current_switch = g_object_get_data (G_OBJECT (fixture->networks), "switch");
+    guint status;
+
+    call_mock (fixture, "SetDelay", g_variant_new ("(d)", 1.0));
+    call_mock (fixture, "SetFail", g_variant_new ("(b)", TRUE));
+
+    /* The failure is only known once the main loop runs, the call did not block */
+    gtk_switch_set_active (current_switch, TRUE);
+    g_assert_true (gtk_switch_get_state (current_switch));
+
+    while (gtk_switch_get_state (current_switch))
+        g_main_context_iteration (NULL, TRUE);
+
+    g_assert_false (gtk_switch_get_active (current_switch));
+    g_object_get (fixture->networks, "status", &status, NULL);
+    g_assert_cmpuint (status, ==, CC_SHARING_STATUS_ENABLED);
+}
+
+static void
+test_remove_rollback (SharingNetworksFixture *fixture, gconstpointer user_data)
+{
+    GtkWidget *row;
+    GtkWidget *button;
+
+    call_mock (fixture, "SetDelay", g_variant_new ("(d)", 1.0));
+    call_mock (fixture, "SetFail", g_variant_new ("(b)", TRUE));
+
+    row = find_network_row (fixture->networks, "office-uuid");
+    g_assert_nonnull (row);
+    button = find_remove_button (row, row);
+    g_assert_nonnull (button);
+
+    /* The row goes away at once and comes back when the call fails */
+    g_signal_emit_by_name (button, "clicked");
+    g_assert_null (find_network_row (fixture->networks, "office-uuid"));
+
+    wait_for_network_row (fixture, "office-uuid", TRUE);
+}
+
+int
+main (int argc, char **argv)
+{
+    g_setenv ("GSETTINGS_BACKEND", "memory", TRUE);
+    g_setenv ("LC_ALL", "C", TRUE);
+
+    gtk_test_init (&argc, &argv, NULL);
+    adw_init ();
+    g_resources_register (cc_sharing_get_resource ());
+
+    g_test_add ("/sharing-networks/toggle-does-not-block", SharingNetworksFixture, NULL, fixture_set_up,
+                test_toggle_does_not_block, fixture_tear_down);
+    g_test_add ("/sharing-networks/toggle-rollback", SharingNetworksFixture, NULL, fixture_set_up,
+                test_toggle_rollback, fixture_tear_down);
+    g_test_add ("/sharing-networks/remove-rollback", SharingNetworksFixture, NULL, fixture_set_up,
+                test_remove_rollback, fixture_tear_down);
+
+    return g_test_run ();
+}
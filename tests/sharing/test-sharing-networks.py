@@ -0,0 +1,108 @@
+#!/usr/bin/env python3
+# Copyright © 2026 The GNOME Project
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+import os
+import subprocess
+import sys
+import unittest
+
+try:
+    import dbus
+    import dbusmock
+except ImportError:
+    sys.stderr.write('You need python-dbusmock (http://pypi.python.org/pypi/python-dbusmock) for this test suite.\n')
+    sys.exit(1)
+
+# Add the shared directory to the search path
+sys.path.append(os.path.join(os.path.dirname(__file__), '..', 'shared'))
+
+from gtest import GTest
+from x11session import X11SessionTestCase
+
+BUILDDIR = os.environ.get('BUILDDIR', os.path.join(os.path.dirname(__file__)))
+
+SHARING_BUS_NAME = 'org.gnome.SettingsDaemon.Sharing'
+SHARING_OBJECT_PATH = '/org/gnome/SettingsDaemon/Sharing'
+SHARING_INTERFACE = 'org.gnome.SettingsDaemon.Sharing'
+GSD_SHARING_STATUS_AVAILABLE = 3
+
+# Every method sleeps for the delay set with SetDelay() and fails after
+# SetFail(True), the mock is reset by the Reset() method
+PROLOGUE_CODE = '''
+import time
+time.sleep(getattr(self, 'delay', 0.0))
+if getattr(self, 'fail', False):
+    raise dbus.exceptions.DBusException('Injected failure', name='org.freedesktop.DBus.Error.Failed')
+self.networks = getattr(self, 'networks', [('office-uuid', 'Office', '802-3-ethernet')])
+'''
+
+RESET_CODE = '''
+self.delay = 0.0
+self.fail = False
+self.networks = [('office-uuid', 'Office', '802-3-ethernet')]
+'''
+
+ENABLE_SERVICE_CODE = PROLOGUE_CODE + '''
+current = (self.Get(SHARING_INTERFACE, 'CurrentNetwork'), self.Get(SHARING_INTERFACE, 'CurrentNetworkName'),
+           self.Get(SHARING_INTERFACE, 'CarrierType'))
+if current[0] not in [n[0] for n in self.networks]:
+    self.networks.append(current)
+'''.replace('SHARING_INTERFACE', repr(SHARING_INTERFACE))
+
+DISABLE_SERVICE_CODE = PROLOGUE_CODE + '''
+self.networks = [n for n in self.networks if n[0] != args[1]]
+'''
+
+LIST_NETWORKS_CODE = PROLOGUE_CODE + '''
+ret = self.networks
+'''
+
+
+class PanelTestCase(X11SessionTestCase, GTest):
+    g_test_exe = os.path.join(BUILDDIR, 'test-sharing-networks')
+
+    @classmethod
+    def setUpClass(klass):
+        super().setUpClass()
+
+        klass.sharing, klass.sharing_obj = klass.spawn_server(
+            SHARING_BUS_NAME, SHARING_OBJECT_PATH, SHARING_INTERFACE, system_bus=False, stdout=subprocess.DEVNULL)
+        klass.sharing_obj.AddProperties(SHARING_INTERFACE, {
+            'CurrentNetwork': 'home-uuid',
+            'CurrentNetworkName': 'Home',
+            'CarrierType': '802-11-wireless',
+            'SharingStatus': dbus.UInt32(GSD_SHARING_STATUS_AVAILABLE),
+        })
+        klass.sharing_obj.AddMethods(SHARING_INTERFACE, [
+            ('EnableService', 's', '', ENABLE_SERVICE_CODE),
+            ('DisableService', 'ss', '', DISABLE_SERVICE_CODE),
+            ('ListNetworks', 's', 'a(sss)', LIST_NETWORKS_CODE),
+            ('SetDelay', 'd', '', 'self.delay = args[0]'),
+            ('SetFail', 'b', '', 'self.fail = args[0]'),
+            ('Reset', '', '', RESET_CODE),
+        ])
+
+    @classmethod
+    def tearDownClass(klass):
+        klass.sharing.terminate()
+        klass.sharing.wait()
+
+        super().tearDownClass()
+
+
+if __name__ == '__main__':
+    # avoid writing to stderr
+    unittest.main(testRunner=unittest.TextTestRunner(stream=sys.stdout, verbosity=2))
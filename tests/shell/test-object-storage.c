@@ -0,0 +1,419 @@
+/* test-object-storage.c
+ *
+ * Copyright 2026 The GNOME Project
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#undef G_LOG_DOMAIN
+#define G_LOG_DOMAIN "test-object-storage"
+
+#include <gio/gio.h>
+
+#include "cc-object-storage.h"
+
+#define SERVICE_NAME "org.gnome.Settings.Test"
+#define SERVICE_PATH "/org/gnome/Settings/Test"
+#define SERVICE_INTERFACE "org.gnome.Settings.Test"
+
+static const gchar introspection_xml[] = "<node>"
+                                         "  <interface name='" SERVICE_INTERFACE "'>"
+                                         "    <property name='Value' type='u' access='read'/>"
+                                         "  </interface>"
+                                         "</node>";
+
+typedef struct {
+    GMainContext *context;
+    GMainLoop *loop;
+    GThread *thread;
+    gchar *address;
+
+    GMutex lock;
+    GCond cond;
+    gboolean ready;
+    /* Proxies load their properties when created, this keeps them waiting */
+    gboolean hold_properties;
+    guint n_property_requests;
+} MockService;
+
+static MockService mock_service;
+
+static GVariant *
+get_property_cb (GDBusConnection *connection, const gchar *sender, const gchar *object_path,
+                 const gchar *interface_name, const gchar *property_name, GError **error, gpointer user_data)
+{
+    MockService *service = user_data;
+
+    g_mutex_lock (&service->lock);
+    service->n_property_requests++;
+    g_cond_broadcast (&service->cond);
+    while (service->hold_properties)
+        g_cond_wait (&service->cond, &service->lock);
+    g_mutex_unlock (&service->lock);
+
+    return g_variant_new_uint32 (42);
+}
+
+static const GDBusInterfaceVTable interface_vtable = { NULL, get_property_cb, NULL };
+
+static gpointer
+mock_service_thread_func (gpointer user_data)
+{
+    MockService *service = user_data;
+    g_autoptr(GDBusNodeInfo) node_info = NULL;
+    g_autoptr(GDBusConnection) connection = NULL;
+    g_autoptr(GVariant) reply = NULL;
+    g_autoptr(GError) error = NULL;
+
+    g_main_context_push_thread_default (service->context);
+
+    /* Not the session bus singleton, so it is served from this thread */
+    connection = g_dbus_connection_new_for_address_sync (service->address,
+                                                         G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT |
+                                                             G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION,
+                                                         NULL, NULL, &error);
+    g_assert_no_error (error);
+
+    node_info = g_dbus_node_info_new_for_xml (introspection_xml, &error);
+    g_assert_no_error (error);
+
+    g_dbus_connection_register_object (connection, SERVICE_PATH, node_info->interfaces[0], &interface_vtable, service,
+                                       NULL, &error);
+    g_assert_no_error (error);
+
+    reply = g_dbus_connection_call_sync (connection, "org.freedesktop.DBus", "/org/freedesktop/DBus",
+                                         "org.freedesktop.DBus", "RequestName",
+                                         g_variant_new ("(su)", SERVICE_NAME, 0), G_VARIANT_TYPE ("(u)"),
+                                         G_DBUS_CALL_FLAGS_NONE, -1, NULL, &error);
+    g_assert_no_error (error);
+
+    g_mutex_lock (&service->lock);
+    service->ready = TRUE;
+    g_cond_signal (&service->cond);
+    g_mutex_unlock (&service->lock);
+
+    g_main_loop_run (service->loop);
+
+    g_dbus_connection_close_sync (connection, NULL, NULL);
+    g_main_context_pop_thread_default (service->context);
+
+    return NULL;
+}
+
+static void
+mock_service_start (MockService *service, const gchar *address)
+{
+    service->context = g_main_context_new ();
+    service->loop = g_main_loop_new (service->context, FALSE);
+    service->address = g_strdup (address);
+    g_mutex_init (&service->lock);
+    g_cond_init (&service->cond);
+
+    service->thread = g_thread_new ("mock-service", mock_service_thread_func, service);
+
+    g_mutex_lock (&service->lock);
+    while (!service->ready)
+        g_cond_wait (&service->cond, &service->lock);
+    g_mutex_unlock (&service->lock);
+}
+
+static void
+mock_service_stop (MockService *service)
+{
+    g_main_loop_quit (service->loop);
+    g_thread_join (service->thread);
+
+    g_main_loop_unref (service->loop);
+    g_main_context_unref (service->context);
+    g_free (service->address);
+    g_mutex_clear (&service->lock);
+    g_cond_clear (&service->cond);
+}
+
+static void
+mock_service_hold_properties (MockService *service)
+{
+    g_mutex_lock (&service->lock);
+    service->hold_properties = TRUE;
+    service->n_property_requests = 0;
+    g_mutex_unlock (&service->lock);
+}
+
+static void
+mock_service_wait_for_request (MockService *service)
+{
+    g_mutex_lock (&service->lock);
+    while (service->n_property_requests == 0)
+        g_cond_wait (&service->cond, &service->lock);
+    g_mutex_unlock (&service->lock);
+}
+
+static void
+mock_service_release_properties (MockService *service)
+{
+    g_mutex_lock (&service->lock);
+    service->hold_properties = FALSE;
+    g_cond_broadcast (&service->cond);
+    g_mutex_unlock (&service->lock);
+}
+
+static void
+start_warming_up (void)
+{
+    cc_object_storage_declare_dbus_proxy (G_BUS_TYPE_SESSION, G_DBUS_PROXY_FLAGS_NONE, SERVICE_NAME, SERVICE_PATH,
+                                          SERVICE_INTERFACE);
+    cc_object_storage_warm_dbus_proxies ();
+
+    /* Start warming it up, and do not let it finish until released */
+    mock_service_hold_properties (&mock_service);
+    while (g_main_context_iteration (NULL, FALSE))
+        ;
+    mock_service_wait_for_request (&mock_service);
+}
+
+static void
+wait_for_created (guint n_created)
+{
+    CcObjectStorageProxyStats stats;
+
+    do {
+        g_main_context_iteration (NULL, TRUE);
+        cc_object_storage_get_proxy_stats (&stats);
+    } while (stats.created < n_created);
+}
+
+static GDBusProxy *
+create_proxy_sync (void)
+{
+    g_autoptr(GError) error = NULL;
+    GDBusProxy *proxy;
+
+    proxy = cc_object_storage_create_dbus_proxy_sync (G_BUS_TYPE_SESSION, G_DBUS_PROXY_FLAGS_NONE, SERVICE_NAME,
+                                                      SERVICE_PATH, SERVICE_INTERFACE, NULL, &error);
+    g_assert_no_error (error);
+    g_assert_true (G_IS_DBUS_PROXY (proxy));
+
+    return proxy;
+}
+
+static void
+create_proxy_cb (GObject *object, GAsyncResult *result, gpointer user_data)
+{
+    GDBusProxy **proxy = user_data;
+    g_autoptr(GError) error = NULL;
+
+    *proxy = cc_object_storage_create_dbus_proxy_finish (result, &error);
+    g_assert_no_error (error);
+}
+
+static void
+assert_proxy_loaded (GDBusProxy *proxy)
+{
+    g_autoptr(GVariant) value = g_dbus_proxy_get_cached_property (proxy, "Value");
+
+    g_assert_nonnull (value);
+    g_assert_cmpuint (g_variant_get_uint32 (value), ==, 42);
+}
+
+static void
+test_miss (void)
+{
+    g_autoptr(GDBusProxy) proxy = NULL;
+    g_autoptr(GDBusProxy) cached_proxy = NULL;
+    CcObjectStorageProxyStats stats;
+
+    cc_object_storage_initialize ();
+
+    /* Nobody declared it, so the first caller has to wait */
+    proxy = create_proxy_sync ();
+    assert_proxy_loaded (proxy);
+
+    cc_object_storage_get_proxy_stats (&stats);
+    g_assert_cmpuint (stats.hits, ==, 0);
+    g_assert_cmpuint (stats.misses, ==, 1);
+    g_assert_cmpint (stats.blocked_time, >, 0);
+
+    cached_proxy = create_proxy_sync ();
+    g_assert_true (cached_proxy == proxy);
+
+    cc_object_storage_get_proxy_stats (&stats);
+    g_assert_cmpuint (stats.hits, ==, 1);
+    g_assert_cmpuint (stats.misses, ==, 1);
+
+    cc_object_storage_destroy ();
+}
+
+static void
+test_warm_up (void)
+{
+    g_autoptr(GDBusProxy) proxy = NULL;
+    CcObjectStorageProxyStats stats;
+
+    cc_object_storage_initialize ();
+
+    cc_object_storage_declare_dbus_proxy (G_BUS_TYPE_SESSION, G_DBUS_PROXY_FLAGS_NONE, SERVICE_NAME, SERVICE_PATH,
+                                          SERVICE_INTERFACE);
+    cc_object_storage_warm_dbus_proxies ();
+    wait_for_created (1);
+
+    /* By the time the panel asks for it, it is ready */
+    proxy = create_proxy_sync ();
+    assert_proxy_loaded (proxy);
+
+    cc_object_storage_get_proxy_stats (&stats);
+    g_assert_cmpuint (stats.hits, ==, 1);
+    g_assert_cmpuint (stats.misses, ==, 0);
+    g_assert_cmpuint (stats.created, ==, 1);
+    g_assert_cmpint (stats.blocked_time, ==, 0);
+
+    cc_object_storage_destroy ();
+}
+
+static void
+test_pending (void)
+{
+    g_autoptr(GDBusProxy) proxy = NULL;
+    g_autoptr(GDBusProxy) async_proxy = NULL;
+    CcObjectStorageProxyStats stats;
+
+    cc_object_storage_initialize ();
+
+    start_warming_up ();
+
+    /* Callers asking for it in the meantime share it. The background proxy
+     * is only stored once the main loop runs, so the synchronous caller
+     * still finds it pending. */
+    cc_object_storage_create_dbus_proxy (G_BUS_TYPE_SESSION, G_DBUS_PROXY_FLAGS_NONE, SERVICE_NAME, SERVICE_PATH,
+                                         SERVICE_INTERFACE, NULL, create_proxy_cb, &async_proxy);
+    mock_service_release_properties (&mock_service);
+    proxy = create_proxy_sync ();
+    assert_proxy_loaded (proxy);
+
+    while (!async_proxy)
+        g_main_context_iteration (NULL, TRUE);
+    g_assert_true (async_proxy == proxy);
+
+    cc_object_storage_get_proxy_stats (&stats);
+    g_assert_cmpuint (stats.hits, ==, 2);
+    g_assert_cmpuint (stats.misses, ==, 0);
+    g_assert_cmpuint (stats.created, ==, 1);
+
+    cc_object_storage_destroy ();
+}
+
+static void
+create_proxy_cancelled_cb (GObject *object, GAsyncResult *result, gpointer user_data)
+{
+    gboolean *done = user_data;
+    g_autoptr(GDBusProxy) proxy = NULL;
+    g_autoptr(GError) error = NULL;
+
+    proxy = cc_object_storage_create_dbus_proxy_finish (result, &error);
+    g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+    g_assert_null (proxy);
+
+    *done = TRUE;
+}
+
+static void
+test_pending_cancelled (void)
+{
+    g_autoptr(GCancellable) cancellable = g_cancellable_new ();
+    CcObjectStorageProxyStats stats;
+    gboolean done = FALSE;
+
+    cc_object_storage_initialize ();
+
+    start_warming_up ();
+
+    /* A cancelled caller does not wait for the shared proxy */
+    cc_object_storage_create_dbus_proxy (G_BUS_TYPE_SESSION, G_DBUS_PROXY_FLAGS_NONE, SERVICE_NAME, SERVICE_PATH,
+                                         SERVICE_INTERFACE, cancellable, create_proxy_cancelled_cb, &done);
+    g_cancellable_cancel (cancellable);
+    while (!done)
+        g_main_context_iteration (NULL, TRUE);
+
+    cc_object_storage_get_proxy_stats (&stats);
+    g_assert_cmpuint (stats.created, ==, 0);
+
+    mock_service_release_properties (&mock_service);
+    wait_for_created (1);
+
+    cc_object_storage_destroy ();
+}
+
+static gpointer
+cancel_thread_func (gpointer user_data)
+{
+    g_cancellable_cancel (G_CANCELLABLE (user_data));
+
+    return NULL;
+}
+
+static void
+test_pending_cancelled_sync (void)
+{
+    g_autoptr(GCancellable) cancellable = g_cancellable_new ();
+    g_autoptr(GDBusProxy) proxy = NULL;
+    g_autoptr(GError) error = NULL;
+    CcObjectStorageProxyStats stats;
+    GThread *thread;
+
+    cc_object_storage_initialize ();
+
+    start_warming_up ();
+
+    /* Whether it is cancelled before or while waiting, the call gives up */
+    thread = g_thread_new ("cancel", cancel_thread_func, cancellable);
+    proxy = cc_object_storage_create_dbus_proxy_sync (G_BUS_TYPE_SESSION, G_DBUS_PROXY_FLAGS_NONE, SERVICE_NAME,
+                                                      SERVICE_PATH, SERVICE_INTERFACE, cancellable, &error);
+    g_thread_join (thread);
+    g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+    g_assert_null (proxy);
+
+    cc_object_storage_get_proxy_stats (&stats);
+    g_assert_cmpuint (stats.hits, ==, 0);
+    g_assert_cmpuint (stats.misses, ==, 0);
+
+    mock_service_release_properties (&mock_service);
+    wait_for_created (1);
+
+    cc_object_storage_destroy ();
+}
+
+gint
+main (gint argc, gchar **argv)
+{
+    g_autoptr(GTestDBus) bus = NULL;
+    int ret;
+
+    g_test_init (&argc, &argv, NULL);
+
+    bus = g_test_dbus_new (G_TEST_DBUS_NONE);
+    g_test_dbus_up (bus);
+    mock_service_start (&mock_service, g_test_dbus_get_bus_address (bus));
+
+    g_test_add_func ("/object-storage/miss", test_miss);
+    g_test_add_func ("/object-storage/warm-up", test_warm_up);
+    g_test_add_func ("/object-storage/pending", test_pending);
+    g_test_add_func ("/object-storage/pending-cancelled", test_pending_cancelled);
+    g_test_add_func ("/object-storage/pending-cancelled-sync", test_pending_cancelled_sync);
+
+    ret = g_test_run ();
+
+    mock_service_stop (&mock_service);
+    g_test_dbus_down (bus);
+
+    return ret;
+}
@@ -0,0 +1,137 @@
+#include "config.h"
+
+#include <glib.h>
+#include <locale.h>
+
+#include "cc-level-monitor.h"
+
+#define N_BENCHMARK_BARS 24
+#define N_BENCHMARK_SAMPLES 250
+
+static guint n_opened = 0;
+static guint n_closed = 0;
+
+static gpointer
+fake_open (CcLevelMonitor *monitor, const CcLevelMonitorSource *source)
+{
+    n_opened++;
+
+    return g_memdup2 (source, sizeof (*source));
+}
+
+static void
+fake_close (CcLevelMonitor *monitor, gpointer handle)
+{
+    n_closed++;
+
+    g_free (handle);
+}
+
+static const CcLevelMonitorBackend fake_backend = {
+    fake_open,
+    fake_close,
+};
+
+static void
+source_init (CcLevelMonitorSource *source, CcStreamType type, guint stream_index)
+{
+    source->context = GUINT_TO_POINTER (1);
+    source->type = type;
+    source->index = stream_index;
+    source->id = stream_index + 100;
+}
+
+static void
+reset_counters (void)
+{
+    n_opened = 0;
+    n_closed = 0;
+}
+
+static void
+test_shared_streams (void)
+{
+    g_autoptr(CcLevelMonitor) monitor = cc_level_monitor_new (&fake_backend);
+    CcLevelMonitorSource output, input;
+
+    reset_counters ();
+    source_init (&output, CC_STREAM_TYPE_OUTPUT, 1);
+    source_init (&input, CC_STREAM_TYPE_INPUT, 1);
+
+    /* Bars showing the same stream share one measurement */
+    cc_level_monitor_subscribe (monitor, &output);
+    cc_level_monitor_subscribe (monitor, &output);
+    g_assert_cmpuint (n_opened, ==, 1);
+    g_assert_cmpuint (cc_level_monitor_get_n_sources (monitor), ==, 1);
+
+    /* Streams of a different type are measured separately */
+    cc_level_monitor_subscribe (monitor, &input);
+    g_assert_cmpuint (n_opened, ==, 2);
+    g_assert_cmpuint (cc_level_monitor_get_n_sources (monitor), ==, 2);
+
+    cc_level_monitor_push_peak (monitor, &output, 0.5);
+    cc_level_monitor_push_peak (monitor, &input, 2.0);
+    g_assert_cmpfloat (cc_level_monitor_get_peak (monitor, &output), ==, 0.5);
+    g_assert_cmpfloat (cc_level_monitor_get_peak (monitor, &input), ==, 1.0);
+
+    /* The stream stays open until the last bar is unmapped */
+    cc_level_monitor_unsubscribe (monitor, &output);
+    g_assert_cmpuint (n_closed, ==, 0);
+    g_assert_cmpfloat (cc_level_monitor_get_peak (monitor, &output), ==, 0.5);
+
+    cc_level_monitor_unsubscribe (monitor, &output);
+    g_assert_cmpuint (n_closed, ==, 1);
+    g_assert_cmpfloat (cc_level_monitor_get_peak (monitor, &output), ==, 0.0);
+
+    /* Peaks of unmonitored streams are dropped */
+    cc_level_monitor_push_peak (monitor, &output, 0.7);
+    g_assert_cmpfloat (cc_level_monitor_get_peak (monitor, &output), ==, 0.0);
+
+    /* Remaining streams are closed with the monitor */
+    g_clear_object (&monitor);
+    g_assert_cmpuint (n_closed, ==, 2);
+}
+
+static void
+test_benchmark (void)
+{
+    g_autoptr(CcLevelMonitor) monitor = cc_level_monitor_new (&fake_backend);
+    g_autoptr(GTimer) timer = g_timer_new ();
+    CcLevelMonitorSource sources[N_BENCHMARK_BARS];
+    gdouble total = 0.0;
+
+    reset_counters ();
+
+    /* A handful of devices, each shown by several bars */
+    for (guint i = 0; i < N_BENCHMARK_BARS; i++) {
+        source_init (&sources[i], CC_STREAM_TYPE_OUTPUT, i % 4);
+        cc_level_monitor_subscribe (monitor, &sources[i]);
+    }
+    g_assert_cmpuint (n_opened, ==, 4);
+
+    g_timer_start (timer);
+    for (guint sample = 0; sample < N_BENCHMARK_SAMPLES; sample++) {
+        for (guint i = 0; i < 4; i++)
+            cc_level_monitor_push_peak (monitor, &sources[i], (sample % 10) / 10.0);
+
+        for (guint i = 0; i < N_BENCHMARK_BARS; i++)
+            total += cc_level_monitor_get_peak (monitor, &sources[i]);
+    }
+
+    g_assert_cmpfloat (total, >, 0.0);
+    g_test_minimized_result (g_timer_elapsed (timer, NULL), "%u samples for %u bars over %u streams",
+                             N_BENCHMARK_SAMPLES, N_BENCHMARK_BARS, n_opened);
+}
+
+int
+main (int argc, char **argv)
+{
+    setlocale (LC_ALL, "");
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/sound/level-monitor/shared-streams", test_shared_streams);
+    if (g_test_perf ())
+        g_test_add_func ("/sound/level-monitor/benchmark", test_benchmark);
+
+    return g_test_run ();
+}
@@ -0,0 +1,267 @@
+/*
+ * Copyright (C) 2026 The GNOME Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib/gstdio.h>
+#include <locale.h>
+#include <string.h>
+
+#include "cc-about-probes.h"
+
+enum {
+    PROBE_STABLE,
+    PROBE_VOLATILE,
+    PROBE_MISSING,
+    PROBE_SLOW,
+    N_PROBES
+};
+
+static gint n_calls[N_PROBES];
+
+/* The slow probe waits until the test lets it go */
+static GMutex probes_lock;
+static GCond probes_cond;
+static gboolean hold_slow_probe;
+static guint n_returned;
+
+static void
+set_hold_slow_probe (gboolean hold)
+{
+    g_mutex_lock (&probes_lock);
+    hold_slow_probe = hold;
+    if (hold)
+        n_returned = 0;
+    g_cond_broadcast (&probes_cond);
+    g_mutex_unlock (&probes_lock);
+}
+
+static void
+probe_returning (void)
+{
+    g_mutex_lock (&probes_lock);
+    n_returned++;
+    g_cond_broadcast (&probes_cond);
+    g_mutex_unlock (&probes_lock);
+}
+
+static void
+wait_for_probes_returned (guint n_probes)
+{
+    g_mutex_lock (&probes_lock);
+    while (n_returned < n_probes)
+        g_cond_wait (&probes_cond, &probes_lock);
+    g_mutex_unlock (&probes_lock);
+}
+
+static GVariant *
+probe_stable (void)
+{
+    g_atomic_int_inc (&n_calls[PROBE_STABLE]);
+    probe_returning ();
+    return g_variant_new_string ("Stable");
+}
+
+static GVariant *
+probe_volatile (void)
+{
+    g_atomic_int_inc (&n_calls[PROBE_VOLATILE]);
+    probe_returning ();
+    return g_variant_new_uint64 (42);
+}
+
+static GVariant *
+probe_missing (void)
+{
+    g_atomic_int_inc (&n_calls[PROBE_MISSING]);
+    probe_returning ();
+    return NULL;
+}
+
+static GVariant *
+probe_slow (void)
+{
+    g_atomic_int_inc (&n_calls[PROBE_SLOW]);
+
+    g_mutex_lock (&probes_lock);
+    while (hold_slow_probe)
+        g_cond_wait (&probes_cond, &probes_lock);
+    g_mutex_unlock (&probes_lock);
+
+    probe_returning ();
+    return g_variant_new_string ("Slow");
+}
+
+static const CcAboutProbe probes[N_PROBES] = {
+    [PROBE_STABLE] = { "stable", "s", probe_stable, TRUE },
+    [PROBE_VOLATILE] = { "volatile", "t", probe_volatile, FALSE },
+    [PROBE_MISSING] = { "missing", "s", probe_missing, TRUE },
+    [PROBE_SLOW] = { "slow", "s", probe_slow, TRUE },
+};
+
+typedef struct {
+    guint n_results;
+    guint n_immediate;
+    gboolean running;
+    guint slow_position;
+    GVariant *values[N_PROBES];
+} Results;
+
+static void
+results_clear (Results *results)
+{
+    for (guint i = 0; i < N_PROBES; i++)
+        g_clear_pointer (&results->values[i], g_variant_unref);
+    results->n_results = 0;
+    results->n_immediate = 0;
+}
+
+static void
+result_cb (guint probe, GVariant *value, gpointer user_data)
+{
+    Results *results = user_data;
+
+    g_assert_cmpuint (probe, <, N_PROBES);
+    g_assert_null (results->values[probe]);
+
+    results->values[probe] = value ? g_variant_ref (value) : NULL;
+    results->n_results++;
+    if (probe == PROBE_SLOW)
+        results->slow_position = results->n_results;
+    if (results->running)
+        results->n_immediate++;
+}
+
+static void
+run_probes (Results *results, const char *cache_file, const char *boot_id)
+{
+    results_clear (results);
+
+    results->running = TRUE;
+    cc_about_probes_run (probes, N_PROBES, cache_file, boot_id, NULL, result_cb, results);
+    results->running = FALSE;
+
+    while (results->n_results < N_PROBES)
+        g_main_context_iteration (NULL, TRUE);
+
+    /* Let the cache be written */
+    while (g_main_context_iteration (NULL, FALSE))
+        ;
+}
+
+static void
+test_run (void)
+{
+    g_autofree char *cache_dir = NULL;
+    g_autofree char *cache_file = NULL;
+    Results results = { 0 };
+
+    cache_dir = g_dir_make_tmp ("test-about-probes-XXXXXX", NULL);
+    g_assert_nonnull (cache_dir);
+    cache_file = g_build_filename (cache_dir, "system-details", NULL);
+
+    memset (n_calls, 0, sizeof (n_calls));
+
+    /* Nothing is cached yet, everything is probed in the background */
+    run_probes (&results, cache_file, "boot-1");
+    g_assert_cmpuint (results.n_immediate, ==, 0);
+    g_assert_cmpstr (g_variant_get_string (results.values[PROBE_STABLE], NULL), ==, "Stable");
+    g_assert_cmpuint (g_variant_get_uint64 (results.values[PROBE_VOLATILE]), ==, 42);
+    g_assert_null (results.values[PROBE_MISSING]);
+    g_assert_cmpstr (g_variant_get_string (results.values[PROBE_SLOW], NULL), ==, "Slow");
+    g_assert_true (g_file_test (cache_file, G_FILE_TEST_EXISTS));
+    for (guint i = 0; i < N_PROBES; i++)
+        g_assert_cmpint (n_calls[i], ==, 1);
+
+    /* Cached results are reported right away, the rest is probed again */
+    run_probes (&results, cache_file, "boot-1");
+    g_assert_cmpuint (results.n_immediate, ==, 2);
+    g_assert_cmpstr (g_variant_get_string (results.values[PROBE_STABLE], NULL), ==, "Stable");
+    g_assert_cmpstr (g_variant_get_string (results.values[PROBE_SLOW], NULL), ==, "Slow");
+    g_assert_cmpint (n_calls[PROBE_STABLE], ==, 1);
+    g_assert_cmpint (n_calls[PROBE_VOLATILE], ==, 2);
+    g_assert_cmpint (n_calls[PROBE_MISSING], ==, 2);
+    g_assert_cmpint (n_calls[PROBE_SLOW], ==, 1);
+
+    /* The cache is dropped after a reboot */
+    run_probes (&results, cache_file, "boot-2");
+    g_assert_cmpuint (results.n_immediate, ==, 0);
+    g_assert_cmpint (n_calls[PROBE_STABLE], ==, 2);
+    g_assert_cmpint (n_calls[PROBE_SLOW], ==, 2);
+
+    /* Without a boot ID nothing is cached */
+    g_assert_cmpint (g_unlink (cache_file), ==, 0);
+    run_probes (&results, cache_file, NULL);
+    g_assert_false (g_file_test (cache_file, G_FILE_TEST_EXISTS));
+
+    results_clear (&results);
+    g_rmdir (cache_dir);
+}
+
+static void
+test_parallel (void)
+{
+    Results results = { 0 };
+
+    memset (n_calls, 0, sizeof (n_calls));
+
+    /* The slow probe doesn't hold back the others */
+    set_hold_slow_probe (TRUE);
+    cc_about_probes_run (probes, N_PROBES, NULL, NULL, NULL, result_cb, &results);
+    while (results.n_results < N_PROBES - 1)
+        g_main_context_iteration (NULL, TRUE);
+    g_assert_cmpuint (results.slow_position, ==, 0);
+
+    set_hold_slow_probe (FALSE);
+    while (results.n_results < N_PROBES)
+        g_main_context_iteration (NULL, TRUE);
+    g_assert_cmpuint (results.slow_position, ==, N_PROBES);
+    for (guint i = 0; i < N_PROBES; i++)
+        g_assert_cmpint (n_calls[i], ==, 1);
+
+    results_clear (&results);
+}
+
+static void
+test_cancel (void)
+{
+    g_autoptr(GCancellable) cancellable = g_cancellable_new ();
+    Results results = { 0 };
+
+    /* Nothing is reported once cancelled, even by the probes still running */
+    set_hold_slow_probe (TRUE);
+    cc_about_probes_run (probes, N_PROBES, NULL, NULL, cancellable, result_cb, &results);
+    g_cancellable_cancel (cancellable);
+    set_hold_slow_probe (FALSE);
+
+    wait_for_probes_returned (N_PROBES);
+    while (g_main_context_iteration (NULL, FALSE))
+        ;
+
+    g_assert_cmpuint (results.n_results, ==, 0);
+}
+
+int
+main (int argc, char **argv)
+{
+    setlocale (LC_ALL, "");
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/about/probes/run", test_run);
+    g_test_add_func ("/about/probes/parallel", test_parallel);
+    g_test_add_func ("/about/probes/cancel", test_cancel);
+
+    return g_test_run ();
+}
@@ -0,0 +1,297 @@
+/*
+ * Copyright (C) 2026 The GNOME Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define G_LOG_DOMAIN "test-avatar-gallery"
+
+#include <glib/gstdio.h>
+#include <unistd.h>
+#include <utime.h>
+
+#include "cc-avatar-gallery.h"
+
+#define N_FACES 20
+#define N_BENCHMARK_FACES 2000
+#define IMAGE_SIZE 512
+#define THUMBNAIL_SIZE 80
+#define TIMEOUT_SECONDS 30
+
+static gchar *
+create_faces_dir (const gchar *name, guint n_faces)
+{
+    g_autoptr(GdkPixbuf) pixbuf = NULL;
+    g_autoptr(GError) error = NULL;
+    gchar *dir;
+
+    dir = g_build_filename (g_get_user_data_dir (), name, NULL);
+    g_assert_cmpint (g_mkdir_with_parents (dir, 0755), ==, 0);
+
+    pixbuf = gdk_pixbuf_new (GDK_COLORSPACE_RGB, FALSE, 8, IMAGE_SIZE, IMAGE_SIZE);
+    for (guint i = 0; i < n_faces; i++) {
+        g_autofree gchar *path = g_strdup_printf ("%s/face-%04u.png", dir, i);
+
+        gdk_pixbuf_fill (pixbuf, (i * 0x10203) << 8 | 0xff);
+        gdk_pixbuf_save (pixbuf, path, "png", &error, NULL);
+        g_assert_no_error (error);
+    }
+
+    return dir;
+}
+
+static void
+wait_for_loaded (CcAvatarGallery *gallery)
+{
+    g_autoptr(GTimer) timer = g_timer_new ();
+
+    while (cc_avatar_gallery_get_loading (gallery)) {
+        g_assert_cmpfloat (g_timer_elapsed (timer, NULL), <, TIMEOUT_SECONDS);
+        g_main_context_iteration (NULL, TRUE);
+    }
+}
+
+static void
+wait_for_n_faces (CcAvatarGallery *gallery, guint n_faces)
+{
+    /* The faces only change from the directory monitor callbacks */
+    while (g_list_model_get_n_items (cc_avatar_gallery_get_faces (gallery)) != n_faces)
+        g_main_context_iteration (NULL, TRUE);
+}
+
+static void
+texture_loaded_cb (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+    GdkTexture **texture = user_data;
+    g_autoptr(GError) error = NULL;
+
+    *texture = cc_avatar_gallery_load_texture_finish (res, &error);
+    g_assert_no_error (error);
+}
+
+static GdkTexture *
+load_texture (CcAvatarGallery *gallery, GFile *file, gint size)
+{
+    GdkTexture *texture = NULL;
+
+    cc_avatar_gallery_load_texture_async (gallery, file, size, NULL, texture_loaded_cb, &texture);
+    while (texture == NULL)
+        g_main_context_iteration (NULL, TRUE);
+
+    return texture;
+}
+
+static void
+test_enumerate (void)
+{
+    g_autofree gchar *dir = create_faces_dir ("faces", N_FACES);
+    g_autofree gchar *subdir = g_build_filename (dir, "subdir", NULL);
+    g_autofree gchar *legacy_link = g_build_filename (dir, "legacy-face.png", NULL);
+    g_autoptr(CcAvatarGallery) gallery = NULL;
+    const gchar *facesdirs[] = { dir, NULL };
+
+    /* Neither directories nor legacy faces are listed */
+    g_assert_cmpint (g_mkdir (subdir, 0755), ==, 0);
+    g_assert_cmpint (symlink ("legacy/face.png", legacy_link), ==, 0);
+
+    gallery = cc_avatar_gallery_new (facesdirs, NULL);
+    g_assert_true (cc_avatar_gallery_get_loading (gallery));
+
+    wait_for_loaded (gallery);
+    g_assert_cmpuint (g_list_model_get_n_items (cc_avatar_gallery_get_faces (gallery)), ==, N_FACES);
+
+    for (guint i = 0; i < N_FACES; i++) {
+        g_autoptr(GFile) face = g_list_model_get_item (cc_avatar_gallery_get_faces (gallery), i);
+        g_autofree gchar *basename = g_file_get_basename (face);
+
+        g_assert_true (g_str_has_prefix (basename, "face-"));
+        g_assert_true (g_str_has_prefix (g_object_get_data (G_OBJECT (face), "a11y_label"), "face-"));
+        g_assert_false (g_str_has_suffix (g_object_get_data (G_OBJECT (face), "a11y_label"), ".png"));
+    }
+}
+
+static void
+test_fallback (void)
+{
+    g_autofree gchar *missing = g_build_filename (g_get_user_data_dir (), "missing", NULL);
+    g_autofree gchar *first = create_faces_dir ("first", 2);
+    g_autofree gchar *second = create_faces_dir ("second", 3);
+    g_autoptr(CcAvatarGallery) gallery = NULL;
+    g_autoptr(CcAvatarGallery) fallback_gallery = NULL;
+    const gchar *facesdirs[] = { missing, first, second, NULL };
+    const gchar *no_facesdirs[] = { missing, NULL };
+
+    /* Every configured directory is used */
+    gallery = cc_avatar_gallery_new (facesdirs, facesdirs);
+    wait_for_loaded (gallery);
+    g_assert_cmpuint (g_list_model_get_n_items (cc_avatar_gallery_get_faces (gallery)), ==, 5);
+
+    /* But only the first fallback directory with faces */
+    fallback_gallery = cc_avatar_gallery_new (no_facesdirs, facesdirs);
+    wait_for_loaded (fallback_gallery);
+    g_assert_cmpuint (g_list_model_get_n_items (cc_avatar_gallery_get_faces (fallback_gallery)), ==, 2);
+}
+
+static void
+test_monitor (void)
+{
+    g_autofree gchar *dir = create_faces_dir ("monitored", N_FACES);
+    g_autofree gchar *path = g_build_filename (dir, "face-0000.png", NULL);
+    g_autofree gchar *copy = g_build_filename (dir, "copy.png", NULL);
+    g_autofree gchar *contents = NULL;
+    g_autoptr(CcAvatarGallery) gallery = NULL;
+    g_autoptr(GError) error = NULL;
+    const gchar *facesdirs[] = { dir, NULL };
+    gsize length;
+
+    gallery = cc_avatar_gallery_new (facesdirs, NULL);
+    wait_for_loaded (gallery);
+
+    g_file_get_contents (path, &contents, &length, &error);
+    g_assert_no_error (error);
+    g_file_set_contents (copy, contents, length, &error);
+    g_assert_no_error (error);
+    wait_for_n_faces (gallery, N_FACES + 1);
+
+    g_assert_cmpint (g_unlink (path), ==, 0);
+    g_assert_cmpint (g_unlink (copy), ==, 0);
+    wait_for_n_faces (gallery, N_FACES - 1);
+}
+
+static void
+test_texture_cache (void)
+{
+    g_autofree gchar *dir = create_faces_dir ("cached", 1);
+    g_autofree gchar *path = g_build_filename (dir, "face-0000.png", NULL);
+    g_autoptr(GFile) file = g_file_new_for_path (path);
+    g_autoptr(CcAvatarGallery) gallery = NULL;
+    g_autoptr(GdkTexture) texture = NULL;
+    g_autoptr(GdkTexture) cached = NULL;
+    g_autoptr(GdkTexture) larger = NULL;
+    g_autoptr(GdkTexture) reloaded = NULL;
+    g_autoptr(GDateTime) later = NULL;
+    const gchar *facesdirs[] = { dir, NULL };
+
+    gallery = cc_avatar_gallery_new (facesdirs, NULL);
+    wait_for_loaded (gallery);
+
+    /* Decoded at the displayed size, not the file size */
+    texture = load_texture (gallery, file, THUMBNAIL_SIZE);
+    g_assert_cmpint (gdk_texture_get_width (texture), ==, THUMBNAIL_SIZE);
+    g_assert_cmpint (gdk_texture_get_height (texture), ==, THUMBNAIL_SIZE);
+
+    cached = load_texture (gallery, file, THUMBNAIL_SIZE);
+    g_assert_true (cached == texture);
+
+    /* HiDPI needs its own texture, and small images are never upscaled */
+    larger = load_texture (gallery, file, IMAGE_SIZE * 2);
+    g_assert_true (larger != texture);
+    g_assert_cmpint (gdk_texture_get_width (larger), ==, IMAGE_SIZE);
+
+    /* Rewritten files are decoded again */
+    later = g_date_time_new_now_utc ();
+    g_assert_cmpint (g_utime (path, &(struct utimbuf) { .actime = g_date_time_to_unix (later) + 10,
+                                                         .modtime = g_date_time_to_unix (later) + 10 }),
+                     ==, 0);
+    reloaded = load_texture (gallery, file, IMAGE_SIZE * 2);
+    g_assert_true (reloaded != larger);
+}
+
+typedef struct {
+    GdkTexture **textures;
+    guint index;
+    guint *n_pending;
+} BenchmarkLoad;
+
+static void
+benchmark_texture_loaded_cb (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+    g_autofree BenchmarkLoad *load = user_data;
+    g_autoptr(GdkTexture) texture = NULL;
+    g_autoptr(GError) error = NULL;
+
+    texture = cc_avatar_gallery_load_texture_finish (res, &error);
+    g_assert_no_error (error);
+
+    /* The second pass must get the very textures of the first one */
+    if (load->textures[load->index] != NULL)
+        g_assert_true (texture == load->textures[load->index]);
+    else
+        load->textures[load->index] = g_steal_pointer (&texture);
+
+    (*load->n_pending)--;
+}
+
+static void
+test_gallery_benchmark (void)
+{
+    g_autofree gchar *dir = create_faces_dir ("benchmark", N_BENCHMARK_FACES);
+    g_autoptr(CcAvatarGallery) gallery = NULL;
+    g_autoptr(GTimer) timer = NULL;
+    g_autofree GdkTexture **textures = g_new0 (GdkTexture *, N_BENCHMARK_FACES);
+    const gchar *facesdirs[] = { dir, NULL };
+    GListModel *faces;
+    guint n_pending;
+
+    timer = g_timer_new ();
+    gallery = cc_avatar_gallery_new (facesdirs, NULL);
+    g_test_minimized_result (g_timer_elapsed (timer, NULL), "Creating the gallery");
+
+    faces = cc_avatar_gallery_get_faces (gallery);
+    while (g_list_model_get_n_items (faces) == 0)
+        g_main_context_iteration (NULL, TRUE);
+    g_test_minimized_result (g_timer_elapsed (timer, NULL), "First faces of %u", N_BENCHMARK_FACES);
+
+    wait_for_loaded (gallery);
+    g_test_minimized_result (g_timer_elapsed (timer, NULL), "Listing %u faces", N_BENCHMARK_FACES);
+    g_assert_cmpuint (g_list_model_get_n_items (faces), ==, N_BENCHMARK_FACES);
+
+    for (guint pass = 0; pass < 2; pass++) {
+        g_timer_start (timer);
+        n_pending = N_BENCHMARK_FACES;
+        for (guint i = 0; i < N_BENCHMARK_FACES; i++) {
+            g_autoptr(GFile) face = g_list_model_get_item (faces, i);
+            BenchmarkLoad *load = g_new0 (BenchmarkLoad, 1);
+
+            load->textures = textures;
+            load->index = i;
+            load->n_pending = &n_pending;
+            cc_avatar_gallery_load_texture_async (gallery, face, THUMBNAIL_SIZE, NULL, benchmark_texture_loaded_cb,
+                                                  load);
+        }
+        while (n_pending > 0)
+            g_main_context_iteration (NULL, TRUE);
+
+        g_test_minimized_result (g_timer_elapsed (timer, NULL), "%s %u thumbnails", pass == 0 ? "Decoding" : "Reusing",
+                                 N_BENCHMARK_FACES);
+    }
+
+    for (guint i = 0; i < N_BENCHMARK_FACES; i++)
+        g_object_unref (textures[i]);
+}
+
+gint
+main (gint argc, gchar **argv)
+{
+    g_test_init (&argc, &argv, G_TEST_OPTION_ISOLATE_DIRS, NULL);
+
+    g_test_add_func ("/avatar-gallery/enumerate", test_enumerate);
+    g_test_add_func ("/avatar-gallery/fallback", test_fallback);
+    g_test_add_func ("/avatar-gallery/monitor", test_monitor);
+    g_test_add_func ("/avatar-gallery/texture-cache", test_texture_cache);
+    if (g_test_perf ())
+        g_test_add_func ("/avatar-gallery/benchmark", test_gallery_benchmark);
+
+    return g_test_run ();
+}
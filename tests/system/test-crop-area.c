@@ -0,0 +1,273 @@
+/*
+ * Copyright (C) 2026 The GNOME Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define G_LOG_DOMAIN "test-crop-area"
+
+#include <gtk/gtk.h>
+#include <math.h>
+
+#include "cc-crop-area.h"
+#include "cc-test-render.h"
+
+#define CROP_SIZE 96
+/* A 40 megapixel camera picture */
+#define BENCHMARK_WIDTH 7744
+#define BENCHMARK_HEIGHT 5184
+#define N_BENCHMARK_FRAMES 60
+#define BENCHMARK_RADIUS 20
+
+typedef struct {
+    GtkWindow *window;
+    CcCropArea *area;
+    GtkGesture *drag_gesture;
+    GskRenderer *renderer;
+} CropAreaFixture;
+
+static void
+fixture_set_up (CropAreaFixture *fixture, gconstpointer user_data)
+{
+    g_autoptr(GListModel) controllers = NULL;
+
+    fixture->window = GTK_WINDOW (gtk_window_new ());
+    gtk_window_set_default_size (fixture->window, 400, 300);
+    fixture->area = CC_CROP_AREA (cc_crop_area_new ());
+    gtk_window_set_child (fixture->window, GTK_WIDGET (fixture->area));
+    gtk_window_present (fixture->window);
+
+    /* Drive the drags through the gesture of the widget */
+    controllers = gtk_widget_observe_controllers (GTK_WIDGET (fixture->area));
+    for (guint i = 0; i < g_list_model_get_n_items (controllers); i++) {
+        g_autoptr(GtkEventController) controller = g_list_model_get_item (controllers, i);
+
+        if (GTK_IS_GESTURE_DRAG (controller))
+            fixture->drag_gesture = GTK_GESTURE (controller);
+    }
+    g_assert_nonnull (fixture->drag_gesture);
+
+    fixture->renderer = cc_test_renderer_new ();
+}
+
+static void
+fixture_tear_down (CropAreaFixture *fixture, gconstpointer user_data)
+{
+    gsk_renderer_unrealize (fixture->renderer);
+    g_clear_object (&fixture->renderer);
+    g_clear_pointer (&fixture->window, gtk_window_destroy);
+}
+
+static GdkTexture *
+create_texture (int width, int height)
+{
+    g_autoptr(GBytes) bytes = NULL;
+    guchar *data;
+    gsize stride = width * 3;
+
+    /* Red on the left half, blue on the right half */
+    data = g_malloc (stride * height);
+    for (int x = 0; x < width; x++) {
+        data[x * 3] = x < width / 2 ? 0xff : 0;
+        data[x * 3 + 1] = 0;
+        data[x * 3 + 2] = x < width / 2 ? 0 : 0xff;
+    }
+    for (int y = 1; y < height; y++)
+        memcpy (data + y * stride, data, stride);
+
+    bytes = g_bytes_new_take (data, stride * height);
+    return gdk_memory_texture_new (width, height, GDK_MEMORY_R8G8B8, bytes, stride);
+}
+
+static GskRenderNode *
+render_frame (CropAreaFixture *fixture)
+{
+    return cc_test_render_widget (fixture->renderer, GTK_WIDGET (fixture->area));
+}
+
+/* Returns the first node of @type in the tree of @node, depth first */
+static GskRenderNode *
+find_node (GskRenderNode *node, GskRenderNodeType type)
+{
+    GskRenderNode *found = NULL;
+
+    if (gsk_render_node_get_node_type (node) == type)
+        return node;
+
+    switch (gsk_render_node_get_node_type (node)) {
+    case GSK_CONTAINER_NODE:
+        for (guint i = 0; i < gsk_container_node_get_n_children (node) && found == NULL; i++)
+            found = find_node (gsk_container_node_get_child (node, i), type);
+        return found;
+    case GSK_TRANSFORM_NODE:
+        return find_node (gsk_transform_node_get_child (node), type);
+    case GSK_CLIP_NODE:
+        return find_node (gsk_clip_node_get_child (node), type);
+    case GSK_ROUNDED_CLIP_NODE:
+        return find_node (gsk_rounded_clip_node_get_child (node), type);
+    case GSK_MASK_NODE:
+        found = find_node (gsk_mask_node_get_source (node), type);
+        return found != NULL ? found : find_node (gsk_mask_node_get_mask (node), type);
+    default:
+        return NULL;
+    }
+}
+
+/* Returns the bounds of the circle drawn around the crop rectangle */
+static graphene_rect_t
+get_crop_bounds (GskRenderNode *node)
+{
+    GskRenderNode *circle = find_node (node, GSK_ROUNDED_CLIP_NODE);
+
+    g_assert_nonnull (circle);
+    return gsk_rounded_clip_node_get_clip (circle)->bounds;
+}
+
+static void
+wait_for_preview (CropAreaFixture *fixture)
+{
+    g_autoptr(GTimer) timer = g_timer_new ();
+
+    while (cc_crop_area_get_preview (fixture->area) == NULL) {
+        g_assert_cmpfloat (g_timer_elapsed (timer, NULL), <, CC_TEST_TIMEOUT_SECONDS);
+        g_main_context_iteration (NULL, TRUE);
+    }
+}
+
+static void
+create_pixbuf_cb (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+    GdkPixbuf **pixbuf = user_data;
+    g_autoptr(GError) error = NULL;
+
+    *pixbuf = cc_crop_area_create_pixbuf_finish (CC_CROP_AREA (source_object), res, &error);
+    g_assert_no_error (error);
+}
+
+static GdkPixbuf *
+create_pixbuf (CropAreaFixture *fixture)
+{
+    GdkPixbuf *pixbuf = NULL;
+
+    cc_crop_area_create_pixbuf_async (fixture->area, CROP_SIZE, NULL, create_pixbuf_cb, &pixbuf);
+    while (pixbuf == NULL)
+        g_main_context_iteration (NULL, TRUE);
+
+    return pixbuf;
+}
+
+static void
+assert_pixel (GdkPixbuf *pixbuf, int x, int y, guchar red, guchar blue)
+{
+    const guchar *pixel = gdk_pixbuf_read_pixels (pixbuf) + y * gdk_pixbuf_get_rowstride (pixbuf) +
+                          x * gdk_pixbuf_get_n_channels (pixbuf);
+
+    g_assert_cmpuint (pixel[0], ==, red);
+    g_assert_cmpuint (pixel[2], ==, blue);
+}
+
+static void
+test_create_pixbuf (CropAreaFixture *fixture, gconstpointer user_data)
+{
+    g_autoptr(GdkTexture) texture = create_texture (400, 200);
+    g_autoptr(GdkPixbuf) pixbuf = NULL;
+    g_autoptr(GskRenderNode) node = NULL;
+
+    cc_crop_area_set_paintable (fixture->area, GDK_PAINTABLE (texture));
+    cc_test_wait_for_allocation (GTK_WIDGET (fixture->area));
+    node = render_frame (fixture);
+
+    /* The initial crop is a square in the middle of the picture */
+    pixbuf = create_pixbuf (fixture);
+    g_assert_cmpint (gdk_pixbuf_get_width (pixbuf), ==, CROP_SIZE);
+    g_assert_cmpint (gdk_pixbuf_get_height (pixbuf), ==, CROP_SIZE);
+    assert_pixel (pixbuf, 2, CROP_SIZE / 2, 0xff, 0);
+    assert_pixel (pixbuf, CROP_SIZE - 3, CROP_SIZE / 2, 0, 0xff);
+}
+
+static void
+test_crop_benchmark (CropAreaFixture *fixture, gconstpointer user_data)
+{
+    g_autoptr(GdkTexture) texture = create_texture (BENCHMARK_WIDTH, BENCHMARK_HEIGHT);
+    g_autoptr(GdkPixbuf) pixbuf = NULL;
+    g_autoptr(GskRenderNode) first_node = NULL;
+    g_autoptr(GTimer) timer = g_timer_new ();
+    GskRenderNode *image_node;
+    graphene_rect_t crop_bounds;
+    gdouble start_x, start_y;
+    gdouble drawing_time = 0;
+    guint n_moves = 0;
+
+    cc_crop_area_set_paintable (fixture->area, GDK_PAINTABLE (texture));
+    g_test_minimized_result (g_timer_elapsed (timer, NULL), "Setting a %ux%u picture", BENCHMARK_WIDTH,
+                             BENCHMARK_HEIGHT);
+    cc_test_wait_for_allocation (GTK_WIDGET (fixture->area));
+    wait_for_preview (fixture);
+
+    /* The picture is drawn from the downscaled copy */
+    first_node = render_frame (fixture);
+    image_node = find_node (first_node, GSK_TEXTURE_SCALE_NODE);
+    g_assert_nonnull (image_node);
+    g_assert_true (gsk_texture_scale_node_get_texture (image_node) == cc_crop_area_get_preview (fixture->area));
+    g_assert_null (find_node (first_node, GSK_TEXTURE_NODE));
+
+    /* Grab the crop circle in its middle */
+    crop_bounds = get_crop_bounds (first_node);
+    start_x = gtk_widget_get_width (GTK_WIDGET (fixture->area)) / 2.0;
+    start_y = gtk_widget_get_height (GTK_WIDGET (fixture->area)) / 2.0;
+    g_signal_emit_by_name (fixture->drag_gesture, "drag-begin", start_x, start_y);
+
+    /* Each drag update moves the crop circle, and only redraws the overlay on top of the same picture */
+    for (guint i = 0; i < N_BENCHMARK_FRAMES; i++) {
+        g_autoptr(GskRenderNode) node = NULL;
+        gdouble angle = 2 * G_PI * (i + 1) / N_BENCHMARK_FRAMES;
+        graphene_rect_t bounds;
+
+        g_signal_emit_by_name (fixture->drag_gesture, "drag-update", BENCHMARK_RADIUS * sin (angle),
+                               BENCHMARK_RADIUS * (1 - cos (angle)) / 2);
+
+        g_timer_start (timer);
+        node = render_frame (fixture);
+        drawing_time += g_timer_elapsed (timer, NULL);
+
+        g_assert_true (find_node (node, GSK_TEXTURE_SCALE_NODE) == image_node);
+
+        bounds = get_crop_bounds (node);
+        if (!graphene_rect_equal (&bounds, &crop_bounds))
+            n_moves++;
+        crop_bounds = bounds;
+    }
+
+    g_signal_emit_by_name (fixture->drag_gesture, "drag-end", 0.0, 0.0);
+    g_assert_cmpuint (n_moves, >, N_BENCHMARK_FRAMES / 2);
+    g_test_minimized_result (drawing_time / N_BENCHMARK_FRAMES, "Drawing a drag frame");
+
+    g_timer_start (timer);
+    pixbuf = create_pixbuf (fixture);
+    g_test_minimized_result (g_timer_elapsed (timer, NULL), "Cropping the picture");
+}
+
+int
+main (int argc, char **argv)
+{
+    gtk_test_init (&argc, &argv, NULL);
+
+    g_test_add ("/crop-area/create-pixbuf", CropAreaFixture, NULL, fixture_set_up, test_create_pixbuf,
+                fixture_tear_down);
+    if (g_test_perf ())
+        g_test_add ("/crop-area/benchmark", CropAreaFixture, NULL, fixture_set_up, test_crop_benchmark,
+                    fixture_tear_down);
+
+    return g_test_run ();
+}
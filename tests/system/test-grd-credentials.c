@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2026 The GNOME Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define G_LOG_DOMAIN "test-grd-credentials"
+
+#include "cc-gnome-remote-desktop.h"
+
+/* The mock is set up in test-grd-credentials.py */
+#define SECRETS_BUS_NAME "org.freedesktop.secrets"
+#define SECRETS_OBJECT_PATH "/org/freedesktop/secrets"
+#define TIMEOUT_SECONDS 10
+
+static void
+store_result_cb (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+    GAsyncResult **result = user_data;
+
+    *result = g_object_ref (res);
+}
+
+static GAsyncResult *
+wait_for_result (GAsyncResult **result)
+{
+    g_autoptr(GTimer) timer = g_timer_new ();
+
+    while (*result == NULL) {
+        g_assert_cmpfloat (g_timer_elapsed (timer, NULL), <, TIMEOUT_SECONDS);
+        g_main_context_iteration (NULL, TRUE);
+    }
+
+    return *result;
+}
+
+static void
+call_mock (const char *method)
+{
+    g_autoptr(GDBusConnection) bus = NULL;
+    g_autoptr(GVariant) result = NULL;
+    g_autoptr(GError) error = NULL;
+
+    bus = g_bus_get_sync (G_BUS_TYPE_SESSION, NULL, &error);
+    g_assert_no_error (error);
+
+    result = g_dbus_connection_call_sync (bus, SECRETS_BUS_NAME, SECRETS_OBJECT_PATH, "org.freedesktop.DBus.Mock",
+                                          method, NULL, NULL, G_DBUS_CALL_FLAGS_NONE, -1, NULL, &error);
+    g_assert_no_error (error);
+}
+
+static GVariant *
+get_mock_calls (const char *method)
+{
+    g_autoptr(GDBusConnection) bus = NULL;
+    g_autoptr(GVariant) result = NULL;
+    g_autoptr(GError) error = NULL;
+
+    bus = g_bus_get_sync (G_BUS_TYPE_SESSION, NULL, &error);
+    g_assert_no_error (error);
+
+    result = g_dbus_connection_call_sync (bus, SECRETS_BUS_NAME, SECRETS_OBJECT_PATH, "org.freedesktop.DBus.Mock",
+                                          "GetMethodCalls", g_variant_new ("(s)", method),
+                                          G_VARIANT_TYPE ("(a(tav))"), G_DBUS_CALL_FLAGS_NONE, -1, NULL, &error);
+    g_assert_no_error (error);
+
+    return g_variant_get_child_value (result, 0);
+}
+
+static void
+store_credentials (const char *username, const char *password)
+{
+    g_autoptr(GAsyncResult) result = NULL;
+    g_autoptr(GError) error = NULL;
+
+    cc_grd_store_rdp_credentials (username, password, NULL, store_result_cb, &result);
+    g_assert_true (cc_grd_store_rdp_credentials_finish (wait_for_result (&result), &error));
+    g_assert_no_error (error);
+}
+
+static void
+test_lookup_empty (void)
+{
+    g_autoptr(GAsyncResult) result = NULL;
+    g_autofree gchar *username = NULL;
+    g_autofree gchar *password = NULL;
+    g_autoptr(GError) error = NULL;
+
+    call_mock ("ClearCalls");
+
+    cc_grd_lookup_rdp_credentials (NULL, store_result_cb, &result);
+    g_assert_true (cc_grd_lookup_rdp_credentials_finish (wait_for_result (&result), &username, &password, &error));
+    g_assert_no_error (error);
+    g_assert_null (username);
+    g_assert_null (password);
+}
+
+static void
+test_store_lookup (void)
+{
+    g_autoptr(GAsyncResult) result = NULL;
+    g_autofree gchar *username = NULL;
+    g_autofree gchar *password = NULL;
+    g_autoptr(GError) error = NULL;
+
+    store_credentials ("first", "one");
+    store_credentials ("second", "two");
+
+    cc_grd_lookup_rdp_credentials (NULL, store_result_cb, &result);
+    g_assert_true (cc_grd_lookup_rdp_credentials_finish (wait_for_result (&result), &username, &password, &error));
+    g_assert_no_error (error);
+    g_assert_cmpstr (username, ==, "second");
+    g_assert_cmpstr (password, ==, "two");
+}
+
+static void
+test_lookup_is_scoped (void)
+{
+    g_autoptr(GAsyncResult) result = NULL;
+    g_autoptr(GVariant) calls = NULL;
+    GVariantIter iter;
+    GVariant *args;
+    guint64 timestamp;
+    g_autoptr(GError) error = NULL;
+
+    call_mock ("ClearCalls");
+
+    cc_grd_lookup_rdp_credentials (NULL, store_result_cb, &result);
+    g_assert_true (cc_grd_lookup_rdp_credentials_finish (wait_for_result (&result), NULL, NULL, &error));
+    g_assert_no_error (error);
+
+    /* Only items of the RDP credentials schema are searched for */
+    calls = get_mock_calls ("SearchItems");
+    g_assert_cmpuint (g_variant_n_children (calls), ==, 1);
+
+    g_variant_iter_init (&iter, calls);
+    while (g_variant_iter_loop (&iter, "(t@av)", &timestamp, &args)) {
+        g_autoptr(GVariant) arg = g_variant_get_child_value (args, 0);
+        g_autoptr(GVariant) attributes = g_variant_get_variant (arg);
+        const gchar *schema = NULL;
+
+        g_assert_true (g_variant_lookup (attributes, "xdg:schema", "&s", &schema));
+        g_assert_cmpstr (schema, ==, "org.gnome.RemoteDesktop.RdpCredentials");
+    }
+}
+
+int
+main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/grd-credentials/lookup-empty", test_lookup_empty);
+    g_test_add_func ("/grd-credentials/store-lookup", test_store_lookup);
+    g_test_add_func ("/grd-credentials/lookup-is-scoped", test_lookup_is_scoped);
+
+    return g_test_run ();
+}
@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+# Copyright © 2026 The GNOME Project
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+import os
+import subprocess
+import sys
+import unittest
+
+import dbus
+
+try:
+    import dbusmock
+except ImportError:
+    sys.stderr.write('You need python-dbusmock (http://pypi.python.org/pypi/python-dbusmock) for this test suite.\n')
+    sys.exit(1)
+
+# Add the shared directory to the search path
+sys.path.append(os.path.join(os.path.dirname(__file__), '..', 'shared'))
+
+from gtest import GTest
+
+BUILDDIR = os.environ.get('BUILDDIR', os.path.join(os.path.dirname(__file__)))
+
+SECRETS_BUS_NAME = 'org.freedesktop.secrets'
+SECRETS_OBJECT_PATH = '/org/freedesktop/secrets'
+SERVICE_INTERFACE = 'org.freedesktop.Secret.Service'
+COLLECTION_INTERFACE = 'org.freedesktop.Secret.Collection'
+ITEM_INTERFACE = 'org.freedesktop.Secret.Item'
+COLLECTION_PATH = SECRETS_OBJECT_PATH + '/collection/login'
+SESSION_PATH = SECRETS_OBJECT_PATH + '/session/1'
+
+# A minimal unlocked keyring with plain text sessions. Items are kept
+# in the mock object, stored items replace the ones with the same
+# attributes.
+CREATE_ITEM_CODE = '''
+attributes = dict(args[0]['org.freedesktop.Secret.Item.Attributes'])
+items = objects['%s'].secret_items = getattr(objects['%s'], 'secret_items', {})
+path = None
+for item_path, (item_attributes, secret) in items.items():
+    if item_attributes == attributes:
+        path = item_path
+if path is None:
+    path = '%s/%%d' %% (len(items) + 1)
+items[path] = (attributes, args[1])
+ret = (dbus.ObjectPath(path), dbus.ObjectPath('/'))
+''' % (COLLECTION_PATH, COLLECTION_PATH, COLLECTION_PATH)
+
+SEARCH_ITEMS_CODE = '''
+items = getattr(objects['%s'], 'secret_items', {})
+found = [dbus.ObjectPath(path) for path, (attributes, secret) in sorted(items.items())
+         if all(attributes.get(k) == v for k, v in args[0].items())]
+ret = (dbus.Array(found, signature='o'), dbus.Array([], signature='o'))
+''' % COLLECTION_PATH
+
+GET_SECRETS_CODE = '''
+items = getattr(objects['%s'], 'secret_items', {})
+ret = dbus.Dictionary({path: items[path][1] for path in args[0] if path in items}, signature='o(oayays)')
+''' % COLLECTION_PATH
+
+
+class GrdCredentialsTestCase(dbusmock.DBusTestCase, GTest):
+    g_test_exe = os.path.join(BUILDDIR, 'test-grd-credentials')
+
+    @classmethod
+    def setUpClass(klass):
+        klass.start_session_bus()
+
+        klass.secrets, klass.secrets_obj = klass.spawn_server(
+            SECRETS_BUS_NAME, SECRETS_OBJECT_PATH, SERVICE_INTERFACE, stdout=subprocess.DEVNULL)
+        klass.secrets_obj.AddProperties(SERVICE_INTERFACE, {
+            'Collections': dbus.Array([dbus.ObjectPath(COLLECTION_PATH)], signature='o'),
+        })
+        klass.secrets_obj.AddMethods(SERVICE_INTERFACE, [
+            ('OpenSession', 'sv', 'vo', 'ret = (dbus.String("", variant_level=1), dbus.ObjectPath("%s"))' %
+             SESSION_PATH),
+            ('ReadAlias', 's', 'o', 'ret = dbus.ObjectPath("%s")' % COLLECTION_PATH),
+            ('SearchItems', 'a{ss}', 'aoao', SEARCH_ITEMS_CODE),
+            ('GetSecrets', 'aoo', 'a{o(oayays)}', GET_SECRETS_CODE),
+            ('Unlock', 'ao', 'aoo', 'ret = (args[0], dbus.ObjectPath("/"))'),
+        ])
+        klass.secrets_obj.AddObject(COLLECTION_PATH, COLLECTION_INTERFACE, {
+            'Label': 'Login',
+            'Locked': False,
+            'Items': dbus.Array([], signature='o'),
+        }, [
+            ('CreateItem', 'a{sv}(oayays)b', 'oo', CREATE_ITEM_CODE),
+        ])
+
+    @classmethod
+    def tearDownClass(klass):
+        klass.secrets.terminate()
+        klass.secrets.wait()
+
+        super().tearDownClass()
+
+
+if __name__ == '__main__':
+    # avoid writing to stderr
+    unittest.main(testRunner=unittest.TextTestRunner(stream=sys.stdout, verbosity=2))
@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2026 The GNOME Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define G_LOG_DOMAIN "test-systemd-service"
+
+#include <gio/gio.h>
+
+#include "cc-systemd-service.h"
+
+/* The mock is set up in test-systemd-service.py */
+#define TIMEOUT_SECONDS 10
+
+static void
+store_result_cb (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+    GAsyncResult **result = user_data;
+
+    *result = g_object_ref (res);
+}
+
+static GAsyncResult *
+wait_for_result (GAsyncResult **result)
+{
+    g_autoptr(GTimer) timer = g_timer_new ();
+
+    while (*result == NULL) {
+        g_assert_cmpfloat (g_timer_elapsed (timer, NULL), <, TIMEOUT_SECONDS);
+        g_main_context_iteration (NULL, TRUE);
+    }
+
+    return *result;
+}
+
+static CcServiceState
+get_state (const char *service)
+{
+    g_autoptr(GAsyncResult) result = NULL;
+    g_autoptr(GError) error = NULL;
+    CcServiceState state;
+
+    cc_get_service_state (service, G_BUS_TYPE_SYSTEM, NULL, store_result_cb, &result);
+    state = cc_get_service_state_finish (wait_for_result (&result), &error);
+    g_assert_no_error (error);
+
+    return state;
+}
+
+static gboolean
+enable_service (const char *service, GError **error)
+{
+    g_autoptr(GAsyncResult) result = NULL;
+
+    cc_enable_service (service, G_BUS_TYPE_SYSTEM, NULL, store_result_cb, &result);
+
+    return cc_enable_service_finish (wait_for_result (&result), error);
+}
+
+static gboolean
+disable_service (const char *service, GError **error)
+{
+    g_autoptr(GAsyncResult) result = NULL;
+
+    cc_disable_service (service, G_BUS_TYPE_SYSTEM, NULL, store_result_cb, &result);
+
+    return cc_disable_service_finish (wait_for_result (&result), error);
+}
+
+static void
+test_get_state (void)
+{
+    g_assert_cmpint (get_state ("get-state.service"), ==, CC_SERVICE_STATE_DISABLED);
+    g_assert_cmpint (get_state ("masked-get-state.service"), ==, CC_SERVICE_STATE_MASKED);
+}
+
+static void
+test_enable_disable (void)
+{
+    g_autoptr(GError) error = NULL;
+
+    g_assert_true (enable_service ("enable-disable.service", &error));
+    g_assert_no_error (error);
+    g_assert_cmpint (get_state ("enable-disable.service"), ==, CC_SERVICE_STATE_ENABLED);
+
+    g_assert_true (disable_service ("enable-disable.service", &error));
+    g_assert_no_error (error);
+    g_assert_cmpint (get_state ("enable-disable.service"), ==, CC_SERVICE_STATE_DISABLED);
+}
+
+static void
+test_enable_failure (void)
+{
+    g_autoptr(GError) error = NULL;
+
+    g_assert_false (enable_service ("fail-enable.service", &error));
+    g_assert_error (error, G_IO_ERROR, G_IO_ERROR_DBUS_ERROR);
+    g_assert_true (g_str_has_prefix (error->message, "Failed to start service: "));
+
+    /* A unit failing to start isn't enabled */
+    g_assert_cmpint (get_state ("fail-enable.service"), ==, CC_SERVICE_STATE_DISABLED);
+}
+
+typedef struct {
+    GAsyncResult **result;
+    guint n_ticks;
+} TickData;
+
+static gboolean
+tick_cb (gpointer user_data)
+{
+    TickData *data = user_data;
+
+    if (*data->result == NULL)
+        data->n_ticks++;
+
+    return G_SOURCE_CONTINUE;
+}
+
+static void
+test_enable_does_not_block (void)
+{
+    g_autoptr(GAsyncResult) result = NULL;
+    g_autoptr(GError) error = NULL;
+    g_autoptr(GTimer) timer = g_timer_new ();
+    TickData data = { &result, 0 };
+    guint tick_id;
+
+    tick_id = g_timeout_add (10, tick_cb, &data);
+
+    /* Starting the unit takes two seconds */
+    cc_enable_service ("slow-enable.service", G_BUS_TYPE_SYSTEM, NULL, store_result_cb, &result);
+    if (g_test_perf ())
+        g_test_minimized_result (g_timer_elapsed (timer, NULL), "Returning from cc_enable_service()");
+    g_assert_null (result);
+
+    g_assert_true (cc_enable_service_finish (wait_for_result (&result), &error));
+    g_assert_no_error (error);
+
+    /* The main loop kept running meanwhile */
+    g_test_message ("%u ticks before the unit was started", data.n_ticks);
+    g_assert_cmpuint (data.n_ticks, >, 0);
+    g_assert_cmpint (get_state ("slow-enable.service"), ==, CC_SERVICE_STATE_ENABLED);
+
+    g_source_remove (tick_id);
+}
+
+static void
+test_cancel (void)
+{
+    g_autoptr(GCancellable) cancellable = g_cancellable_new ();
+    g_autoptr(GAsyncResult) result = NULL;
+    g_autoptr(GError) error = NULL;
+
+    cc_enable_service ("slow-cancel.service", G_BUS_TYPE_SYSTEM, cancellable, store_result_cb, &result);
+    g_cancellable_cancel (cancellable);
+
+    g_assert_false (cc_enable_service_finish (wait_for_result (&result), &error));
+    g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+}
+
+static void
+service_changed_cb (const char *service, gpointer user_data)
+{
+    guint *n_changes = user_data;
+
+    g_assert_cmpstr (service, ==, "watch.service");
+    (*n_changes)++;
+}
+
+static void
+test_watch (void)
+{
+    g_autoptr(GTimer) timer = g_timer_new ();
+    g_autoptr(GError) error = NULL;
+    guint n_changes = 0;
+    guint watch_id;
+
+    watch_id = cc_watch_service ("watch.service", G_BUS_TYPE_SYSTEM, service_changed_cb, &n_changes, NULL);
+
+    g_assert_true (enable_service ("watch.service", &error));
+    g_assert_no_error (error);
+
+    while (n_changes == 0) {
+        g_assert_cmpfloat (g_timer_elapsed (timer, NULL), <, TIMEOUT_SECONDS);
+        g_main_context_iteration (NULL, TRUE);
+    }
+
+    /* No callbacks once unwatched */
+    cc_unwatch_service (watch_id);
+    n_changes = 0;
+
+    g_assert_true (disable_service ("watch.service", &error));
+    g_assert_no_error (error);
+    while (g_main_context_iteration (NULL, FALSE))
+        ;
+    g_assert_cmpuint (n_changes, ==, 0);
+}
+
+int
+main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/systemd-service/get-state", test_get_state);
+    g_test_add_func ("/systemd-service/enable-disable", test_enable_disable);
+    g_test_add_func ("/systemd-service/enable-failure", test_enable_failure);
+    g_test_add_func ("/systemd-service/enable-does-not-block", test_enable_does_not_block);
+    g_test_add_func ("/systemd-service/cancel", test_cancel);
+    g_test_add_func ("/systemd-service/watch", test_watch);
+
+    return g_test_run ();
+}
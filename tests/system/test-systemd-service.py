@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+# Copyright © 2026 The GNOME Project
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, see <http://www.gnu.org/licenses/>.
+
+import os
+import subprocess
+import sys
+import unittest
+
+try:
+    import dbusmock
+except ImportError:
+    sys.stderr.write('You need python-dbusmock (http://pypi.python.org/pypi/python-dbusmock) for this test suite.\n')
+    sys.exit(1)
+
+# Add the shared directory to the search path
+sys.path.append(os.path.join(os.path.dirname(__file__), '..', 'shared'))
+
+from gtest import GTest
+
+BUILDDIR = os.environ.get('BUILDDIR', os.path.join(os.path.dirname(__file__)))
+
+SYSTEMD_BUS_NAME = 'org.freedesktop.systemd1'
+SYSTEMD_OBJECT_PATH = '/org/freedesktop/systemd1'
+SYSTEMD_MANAGER_INTERFACE = 'org.freedesktop.systemd1.Manager'
+
+# Units are disabled until enabled, except for a few special names:
+#  - masked-*: reported as masked
+#  - fail-*: StartUnit and StopUnit fail
+#  - slow-*: StartUnit takes two seconds to return
+UNIT_PATH_CODE = '''
+unit_path = '/org/freedesktop/systemd1/unit/' + ''.join(c if c.isalnum() else '_%02x' % ord(c) for c in args[0])
+if unit_path not in objects:
+    self.AddObject(unit_path, 'org.freedesktop.systemd1.Unit', {'ActiveState': 'inactive'}, [])
+'''
+
+GET_UNIT_FILE_STATE_CODE = '''
+states = getattr(self, 'unit_file_states', {})
+ret = 'masked' if args[0].startswith('masked-') else states.get(args[0], 'disabled')
+'''
+
+SET_UNIT_FILE_STATE_CODE = '''
+self.unit_file_states = getattr(self, 'unit_file_states', {})
+for unit in args[0]:
+    self.unit_file_states[unit] = '@STATE@'
+self.EmitSignal('org.freedesktop.systemd1.Manager', 'UnitFilesChanged', '', [])
+'''
+
+SET_ACTIVE_STATE_CODE = '''
+if args[0].startswith('fail-'):
+    raise dbus.exceptions.DBusException('Unit %s failed' % args[0], name='org.freedesktop.systemd1.UnitFailed')
+if args[0].startswith('slow-'):
+    import time
+    time.sleep(2)
+''' + UNIT_PATH_CODE + '''
+objects[unit_path].Set('org.freedesktop.systemd1.Unit', 'ActiveState', '@STATE@')
+ret = '/org/freedesktop/systemd1/job/1'
+'''
+
+
+class SystemdServiceTestCase(dbusmock.DBusTestCase, GTest):
+    g_test_exe = os.path.join(BUILDDIR, 'test-systemd-service')
+
+    @classmethod
+    def setUpClass(klass):
+        klass.start_system_bus()
+
+        klass.systemd, klass.systemd_obj = klass.spawn_server(
+            SYSTEMD_BUS_NAME, SYSTEMD_OBJECT_PATH, SYSTEMD_MANAGER_INTERFACE, system_bus=True,
+            stdout=subprocess.DEVNULL)
+        klass.systemd_obj.AddMethods(SYSTEMD_MANAGER_INTERFACE, [
+            ('GetUnitFileState', 's', 's', GET_UNIT_FILE_STATE_CODE),
+            ('EnableUnitFiles', 'asbb', 'ba(sss)',
+             SET_UNIT_FILE_STATE_CODE.replace('@STATE@', 'enabled') + 'ret = (False, [])'),
+            ('DisableUnitFiles', 'asb', 'a(sss)',
+             SET_UNIT_FILE_STATE_CODE.replace('@STATE@', 'disabled') + 'ret = []'),
+            ('StartUnit', 'ss', 'o', SET_ACTIVE_STATE_CODE.replace('@STATE@', 'active')),
+            ('StopUnit', 'ss', 'o', SET_ACTIVE_STATE_CODE.replace('@STATE@', 'inactive')),
+            ('LoadUnit', 's', 'o', UNIT_PATH_CODE + 'ret = unit_path'),
+            ('Subscribe', '', '', ''),
+        ])
+
+    @classmethod
+    def tearDownClass(klass):
+        klass.systemd.terminate()
+        klass.systemd.wait()
+
+        super().tearDownClass()
+
+
+if __name__ == '__main__':
+    # avoid writing to stderr
+    unittest.main(testRunner=unittest.TextTestRunner(stream=sys.stdout, verbosity=2))
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2026 The GNOME Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <locale.h>
+
+#include "cc-system-resources.h"
+#include "tz.h"
+
+#define N_WARM_LOADS 20
+
+static gchar *
+get_index_file (void)
+{
+    return g_build_filename (g_get_user_cache_dir (), "gnome-control-center", "tz-index", NULL);
+}
+
+static void
+assert_db_equal (TzDB *a, TzDB *b)
+{
+    GHashTableIter iter;
+    gpointer alias, real;
+
+    g_assert_cmpuint (a->locations->len, ==, b->locations->len);
+    for (guint i = 0; i < a->locations->len; i++) {
+        TzLocation *loc_a = g_ptr_array_index (a->locations, i);
+        TzLocation *loc_b = g_ptr_array_index (b->locations, i);
+
+        g_assert_cmpstr (loc_a->country, ==, loc_b->country);
+        g_assert_cmpstr (loc_a->zone, ==, loc_b->zone);
+        g_assert_cmpstr (loc_a->comment, ==, loc_b->comment);
+        g_assert_cmpfloat (loc_a->latitude, ==, loc_b->latitude);
+        g_assert_cmpfloat (loc_a->longitude, ==, loc_b->longitude);
+    }
+
+    g_assert_cmpuint (g_hash_table_size (a->backward), ==, g_hash_table_size (b->backward));
+    g_hash_table_iter_init (&iter, a->backward);
+    while (g_hash_table_iter_next (&iter, &alias, &real))
+        g_assert_cmpstr (g_hash_table_lookup (b->backward, alias), ==, real);
+}
+
+static void
+test_index (void)
+{
+    g_autofree gchar *index_file = get_index_file ();
+    g_autoptr(TzDB) parsed = NULL;
+    g_autoptr(TzDB) cached = NULL;
+    g_autoptr(TzDB) corrupt = NULL;
+
+    /* The first load parses zone.tab and writes the index */
+    g_assert_false (g_file_test (index_file, G_FILE_TEST_EXISTS));
+    parsed = tz_load_db ();
+    g_assert_nonnull (parsed);
+    g_assert_null (parsed->index);
+    g_assert_true (g_file_test (index_file, G_FILE_TEST_EXISTS));
+
+    /* The second one only maps the index */
+    cached = tz_load_db ();
+    g_assert_nonnull (cached);
+    g_assert_nonnull (cached->index);
+    assert_db_equal (parsed, cached);
+
+    /* A damaged index is ignored and rebuilt */
+    g_assert_true (g_file_set_contents (index_file, "garbage", -1, NULL));
+    corrupt = tz_load_db ();
+    g_assert_nonnull (corrupt);
+    g_assert_null (corrupt->index);
+    assert_db_equal (parsed, corrupt);
+
+    /* The default database is loaded once */
+    g_assert_true (tz_db_get_default () == tz_db_get_default ());
+}
+
+static void
+test_index_benchmark (void)
+{
+    g_autofree gchar *index_file = get_index_file ();
+    g_autoptr(GTimer) timer = g_timer_new ();
+    g_autoptr(TzDB) cold_db = NULL;
+    gdouble cold_time;
+    gdouble warm_time;
+
+    g_remove (index_file);
+
+    g_timer_start (timer);
+    cold_db = tz_load_db ();
+    cold_time = g_timer_elapsed (timer, NULL);
+    g_assert_null (cold_db->index);
+
+    g_timer_start (timer);
+    for (guint i = 0; i < N_WARM_LOADS; i++) {
+        g_autoptr(TzDB) warm_db = tz_load_db ();
+
+        g_assert_nonnull (warm_db->index);
+    }
+    warm_time = g_timer_elapsed (timer, NULL) / N_WARM_LOADS;
+
+    g_test_minimized_result (cold_time, "Cold load of %u locations", cold_db->locations->len);
+    g_test_minimized_result (warm_time, "Warm load of %u locations", cold_db->locations->len);
+
+    /* Opening the panel again only takes the shared database */
+    g_timer_start (timer);
+    for (guint i = 0; i < N_WARM_LOADS; i++)
+        g_assert_nonnull (tz_db_get_default ());
+    g_test_minimized_result (g_timer_elapsed (timer, NULL) / N_WARM_LOADS, "Shared database lookup");
+}
+
+gint
+main (gint argc, gchar **argv)
+{
+    setlocale (LC_ALL, "");
+    g_test_init (&argc, &argv, G_TEST_OPTION_ISOLATE_DIRS, NULL);
+
+    g_resources_register (cc_system_get_resource ());
+
+    g_test_add_func ("/datetime/timezone-index", test_index);
+    if (g_test_perf ())
+        g_test_add_func ("/datetime/timezone-index/benchmark", test_index_benchmark);
+
+    return g_test_run ();
+}
@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2026 The GNOME Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+#include <glib.h>
+#include <locale.h>
+#include <string.h>
+
+#include "cc-system-resources.h"
+#include "cc-tz-item.h"
+#include "cc-util.h"
+#include "tz.h"
+
+static CcTzItem *
+find_item (GPtrArray *items, const char *zone)
+{
+    for (guint i = 0; i < items->len; i++) {
+        CcTzItem *item = g_ptr_array_index (items, i);
+
+        if (g_str_equal (cc_tz_item_get_location (item)->zone, zone))
+            return item;
+    }
+
+    g_assert_not_reached ();
+}
+
+static GPtrArray *
+create_items (void)
+{
+    GPtrArray *locations;
+    GPtrArray *items;
+
+    locations = tz_get_locations (tz_db_get_default ());
+    items = g_ptr_array_new_full (locations->len, g_object_unref);
+    for (guint i = 0; i < locations->len; i++)
+        g_ptr_array_add (items, cc_tz_item_new (g_ptr_array_index (locations, i)));
+
+    return items;
+}
+
+static gboolean
+item_matches (CcTzItem *item, const char *text)
+{
+    g_autofree char *query = cc_util_normalize_casefold_and_unaccent (text);
+    g_auto(GStrv) words = g_strsplit (query, " ", 0);
+
+    return cc_tz_item_matches (item, (const char *const *) words);
+}
+
+static void
+test_search (void)
+{
+    g_autoptr(GPtrArray) items = create_items ();
+    CcTzItem *kolkata = find_item (items, "Asia/Kolkata");
+    CcTzItem *karachi = find_item (items, "Asia/Karachi");
+    CcTzItem *sao_paulo = find_item (items, "America/Sao_Paulo");
+
+    g_assert_true (item_matches (kolkata, "as kol"));
+    g_assert_false (item_matches (karachi, "as kol"));
+    g_assert_true (item_matches (kolkata, "ASIA"));
+    g_assert_true (item_matches (kolkata, "  kolkata "));
+
+    /* Searches ignore accents on either side */
+    g_assert_true (item_matches (sao_paulo, "sao paulo"));
+    g_assert_true (item_matches (sao_paulo, "São Paulo"));
+
+    g_assert_cmpint (cc_tz_item_get_match (kolkata, "kolkata"), ==, CC_TZ_ITEM_MATCH_EXACT);
+    g_assert_cmpint (cc_tz_item_get_match (kolkata, "kol"), ==, CC_TZ_ITEM_MATCH_PREFIX);
+    g_assert_cmpint (cc_tz_item_get_match (kolkata, "kata"), ==, CC_TZ_ITEM_MATCH_OTHER);
+    g_assert_cmpint (cc_tz_item_get_match (kolkata, ""), ==, CC_TZ_ITEM_MATCH_OTHER);
+}
+
+/* What the dialog did before the search keys were kept on the items */
+static gboolean
+item_matches_casefold (CcTzItem *item, const char *search_terms)
+{
+    g_autofree char *country = NULL;
+    g_autofree char *name = NULL;
+    g_autofree char *zone = NULL;
+    g_autofree char *name_fold = NULL;
+    g_autofree char *zone_fold = NULL;
+    g_autofree char *country_fold = NULL;
+    g_auto(GStrv) strv = NULL;
+
+    g_object_get (item, "country", &country, "name", &name, "zone", &zone, NULL);
+    if (!name || !zone || !country)
+        return FALSE;
+
+    name_fold = g_utf8_casefold (name, -1);
+    zone_fold = g_utf8_casefold (zone, -1);
+    country_fold = g_utf8_casefold (country, -1);
+
+    strv = g_strsplit (search_terms, " ", 0);
+    for (guint i = 0; strv[i]; i++) {
+        g_autofree char *str_fold = NULL;
+
+        if (!*strv[i])
+            continue;
+
+        str_fold = g_utf8_casefold (strv[i], -1);
+        if (!strstr (name_fold, str_fold) && !strstr (zone_fold, str_fold) && !strstr (country_fold, str_fold))
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+static void
+test_search_benchmark (void)
+{
+    const char *search = "america new york";
+    g_autoptr(GPtrArray) items = create_items ();
+    g_autoptr(GPtrArray) matches = NULL;
+    g_autoptr(GTimer) timer = g_timer_new ();
+    guint n_casefold_matches = 0;
+
+    /* Type the search one character at a time, checking the whole list each time */
+    g_timer_start (timer);
+    for (gsize len = 1; len <= strlen (search); len++) {
+        g_autofree char *text = g_strndup (search, len);
+
+        n_casefold_matches = 0;
+        for (guint i = 0; i < items->len; i++)
+            n_casefold_matches += item_matches_casefold (g_ptr_array_index (items, i), text);
+    }
+    g_test_minimized_result (g_timer_elapsed (timer, NULL), "Casefolding search over %u zones", items->len);
+
+    /* Same, but only checking the previous matches again, as the filter model does */
+    g_timer_start (timer);
+    matches = g_ptr_array_ref (items);
+    for (gsize len = 1; len <= strlen (search); len++) {
+        g_autofree char *text = g_strndup (search, len);
+        g_autofree char *query = cc_util_normalize_casefold_and_unaccent (text);
+        g_auto(GStrv) words = g_strsplit (query, " ", 0);
+        GPtrArray *narrowed;
+
+        narrowed = g_ptr_array_new_full (matches->len, g_object_unref);
+        for (guint i = 0; i < matches->len; i++) {
+            CcTzItem *item = g_ptr_array_index (matches, i);
+
+            if (cc_tz_item_matches (item, (const char *const *) words))
+                g_ptr_array_add (narrowed, g_object_ref (item));
+        }
+
+        g_ptr_array_unref (matches);
+        matches = narrowed;
+    }
+    g_test_minimized_result (g_timer_elapsed (timer, NULL), "Incremental search over %u zones", items->len);
+
+    g_assert_cmpuint (matches->len, ==, n_casefold_matches);
+    g_assert_cmpuint (matches->len, >, 0);
+}
+
+gint
+main (gint argc, gchar **argv)
+{
+    setlocale (LC_ALL, "");
+    g_test_init (&argc, &argv, NULL);
+
+    g_resources_register (cc_system_get_resource ());
+
+    g_test_add_func ("/datetime/timezone-search", test_search);
+    if (g_test_perf ())
+        g_test_add_func ("/datetime/timezone-search/benchmark", test_search_benchmark);
+
+    return g_test_run ();
+}
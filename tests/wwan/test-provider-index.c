@@ -0,0 +1,247 @@
+/* test-provider-index.c
+ *
+ * Copyright 2026 The GNOME Project
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#undef G_LOG_DOMAIN
+#define G_LOG_DOMAIN "test-provider-index"
+
+#include <config.h>
+#include <nma-mobile-providers.h>
+
+#include "cc-wwan-provider-index.h"
+
+#define N_BENCHMARK_LOOKUPS 100
+
+#define DATABASE_TEMPLATE                                                                                              \
+    "<?xml version=\"1.0\"?>\n"                                                                                        \
+    "<serviceproviders format=\"2.0\">\n"                                                                              \
+    "  <country code=\"us\">\n"                                                                                        \
+    "    <provider>\n"                                                                                                 \
+    "      <name>Three Digits</name>\n"                                                                                \
+    "      <gsm>\n"                                                                                                    \
+    "        <network-id mcc=\"310\" mnc=\"410\"/>\n"                                                                  \
+    "        <apn value=\"%s\">\n"                                                                                     \
+    "          <name>Internet</name>\n"                                                                                \
+    "          <username>user</username>\n"                                                                            \
+    "          <password>secret</password>\n"                                                                          \
+    "        </apn>\n"                                                                                                 \
+    "      </gsm>\n"                                                                                                   \
+    "    </provider>\n"                                                                                                \
+    "    <provider>\n"                                                                                                 \
+    "      <name>Padded</name>\n"                                                                                      \
+    "      <gsm>\n"                                                                                                    \
+    "        <network-id mcc=\"310\" mnc=\"026\"/>\n"                                                                  \
+    "        <apn value=\"padded.example\"/>\n"                                                                        \
+    "      </gsm>\n"                                                                                                   \
+    "    </provider>\n"                                                                                                \
+    "    <provider>\n"                                                                                                 \
+    "      <name>Unpadded</name>\n"                                                                                    \
+    "      <gsm>\n"                                                                                                    \
+    "        <network-id mcc=\"310\" mnc=\"26\"/>\n"                                                                   \
+    "        <apn value=\"unpadded.example\"/>\n"                                                                      \
+    "      </gsm>\n"                                                                                                   \
+    "    </provider>\n"                                                                                                \
+    "  </country>\n"                                                                                                   \
+    "  <country code=\"gb\">\n"                                                                                        \
+    "    <provider>\n"                                                                                                 \
+    "      <name>Two Digits</name>\n"                                                                                  \
+    "      <gsm>\n"                                                                                                    \
+    "        <network-id mcc=\"234\" mnc=\"15\"/>\n"                                                                   \
+    "        <apn value=\"wap.example\">\n"                                                                            \
+    "          <name>WAP</name>\n"                                                                                     \
+    "        </apn>\n"                                                                                                 \
+    "      </gsm>\n"                                                                                                   \
+    "    </provider>\n"                                                                                                \
+    "  </country>\n"                                                                                                   \
+    "</serviceproviders>\n"
+
+static gchar *
+write_database (const gchar *apn)
+{
+    g_autofree gchar *contents = g_strdup_printf (DATABASE_TEMPLATE, apn);
+    g_autoptr(GError) error = NULL;
+    gchar *path;
+
+    path = g_build_filename (g_get_user_data_dir (), "serviceproviders.xml", NULL);
+    g_mkdir_with_parents (g_get_user_data_dir (), 0755);
+    g_file_set_contents (path, contents, -1, &error);
+    g_assert_no_error (error);
+
+    return path;
+}
+
+static void
+lookup_cb (GObject *object, GAsyncResult *result, gpointer user_data)
+{
+    GPtrArray **apns = user_data;
+    g_autoptr(GError) error = NULL;
+
+    *apns = cc_wwan_provider_index_lookup_finish (result, &error);
+    g_assert_no_error (error);
+}
+
+static GPtrArray *
+lookup (const gchar *database, const gchar *mcc_mnc)
+{
+    GPtrArray *apns = NULL;
+
+    cc_wwan_provider_index_lookup_async (database, mcc_mnc, NULL, lookup_cb, &apns);
+    while (!apns)
+        g_main_context_iteration (NULL, TRUE);
+
+    return apns;
+}
+
+static void
+test_lookup (void)
+{
+    g_autofree gchar *database = write_database ("internet.example");
+    g_autoptr(GPtrArray) apns = NULL;
+    g_autoptr(GPtrArray) short_apns = NULL;
+    g_autoptr(GPtrArray) padded_apns = NULL;
+    g_autoptr(GPtrArray) long_apns = NULL;
+    g_autoptr(GPtrArray) prefix_apns = NULL;
+    g_autoptr(GPtrArray) extended_apns = NULL;
+    g_autoptr(GPtrArray) unknown_apns = NULL;
+    CcWwanProviderApn *apn;
+
+    apns = lookup (database, "310410");
+    g_assert_cmpuint (apns->len, ==, 1);
+    apn = apns->pdata[0];
+    g_assert_cmpstr (cc_wwan_provider_apn_get_name (apn), ==, "Internet");
+    g_assert_cmpstr (cc_wwan_provider_apn_get_apn (apn), ==, "internet.example");
+    g_assert_cmpstr (cc_wwan_provider_apn_get_username (apn), ==, "user");
+    g_assert_cmpstr (cc_wwan_provider_apn_get_password (apn), ==, "secret");
+
+    /* A 2-digit MNC is the same as the zero-padded 3-digit one, preferring the latter */
+    short_apns = lookup (database, "31026");
+    g_assert_cmpuint (short_apns->len, ==, 1);
+    g_assert_cmpstr (cc_wwan_provider_apn_get_apn (short_apns->pdata[0]), ==, "padded.example");
+
+    padded_apns = lookup (database, "310026");
+    g_assert_cmpuint (padded_apns->len, ==, 1);
+    g_assert_cmpstr (cc_wwan_provider_apn_get_apn (padded_apns->pdata[0]), ==, "padded.example");
+
+    long_apns = lookup (database, "234015");
+    g_assert_cmpuint (long_apns->len, ==, 1);
+    g_assert_cmpstr (cc_wwan_provider_apn_get_apn (long_apns->pdata[0]), ==, "wap.example");
+    g_assert_null (cc_wwan_provider_apn_get_username (long_apns->pdata[0]));
+
+    /* Other MNCs sharing a prefix are different operators */
+    prefix_apns = lookup (database, "31041");
+    g_assert_cmpuint (prefix_apns->len, ==, 0);
+
+    extended_apns = lookup (database, "234150");
+    g_assert_cmpuint (extended_apns->len, ==, 0);
+
+    unknown_apns = lookup (database, "00101");
+    g_assert_cmpuint (unknown_apns->len, ==, 0);
+}
+
+static void
+test_database_changed (void)
+{
+    g_autofree gchar *database = write_database ("old.example");
+    g_autofree gchar *index_file = NULL;
+    g_autoptr(GPtrArray) apns = NULL;
+    g_autoptr(GPtrArray) new_apns = NULL;
+    g_autoptr(GFile) file = NULL;
+    g_autoptr(GError) error = NULL;
+
+    apns = lookup (database, "310410");
+    g_assert_cmpstr (cc_wwan_provider_apn_get_apn (apns->pdata[0]), ==, "old.example");
+
+    index_file = g_build_filename (g_get_user_cache_dir (), "gnome-control-center", "wwan-providers", NULL);
+    g_assert_true (g_file_test (index_file, G_FILE_TEST_IS_REGULAR));
+
+    /* Make sure the modification time differs even on coarse file systems */
+    g_free (write_database ("new.example"));
+    file = g_file_new_for_path (database);
+    g_file_set_attribute_uint64 (file, G_FILE_ATTRIBUTE_TIME_MODIFIED, g_get_real_time () / G_USEC_PER_SEC + 60,
+                                 G_FILE_QUERY_INFO_NONE, NULL, &error);
+    g_assert_no_error (error);
+
+    new_apns = lookup (database, "310410");
+    g_assert_cmpstr (cc_wwan_provider_apn_get_apn (new_apns->pdata[0]), ==, "new.example");
+}
+
+static void
+test_lookup_benchmark (void)
+{
+    NMAMobileProvidersDatabase *db;
+    g_autoptr(GTimer) timer = NULL;
+    g_autoptr(GError) error = NULL;
+    g_autoptr(GPtrArray) apns = NULL;
+    g_autoptr(GPtrArray) mcc_mncs = NULL;
+    GHashTableIter iter;
+    gpointer value;
+
+    if (!g_file_test (MOBILE_BROADBAND_PROVIDER_INFO_DATABASE, G_FILE_TEST_IS_REGULAR)) {
+        g_test_skip ("mobile-broadband-provider-info is not installed");
+        return;
+    }
+
+    /* What opening the APN list used to cost on the UI thread */
+    timer = g_timer_new ();
+    db = nma_mobile_providers_database_new_sync (NULL, MOBILE_BROADBAND_PROVIDER_INFO_DATABASE, NULL, &error);
+    g_assert_no_error (error);
+    g_test_minimized_result (g_timer_elapsed (timer, NULL), "Parsing the provider database");
+
+    mcc_mncs = g_ptr_array_new_with_free_func (g_free);
+    g_hash_table_iter_init (&iter, nma_mobile_providers_database_get_countries (db));
+    while (g_hash_table_iter_next (&iter, NULL, &value) && mcc_mncs->len < N_BENCHMARK_LOOKUPS) {
+        for (GSList *l = nma_country_info_get_providers (value); l && mcc_mncs->len < N_BENCHMARK_LOOKUPS;
+             l = l->next) {
+            const gchar **ids = nma_mobile_provider_get_3gpp_mcc_mnc (l->data);
+
+            if (ids && ids[0])
+                g_ptr_array_add (mcc_mncs, g_strdup (ids[0]));
+        }
+    }
+    g_assert_cmpuint (mcc_mncs->len, >, 0);
+
+    g_timer_start (timer);
+    for (guint i = 0; i < mcc_mncs->len; i++)
+        nma_mobile_providers_database_lookup_3gpp_mcc_mnc (db, mcc_mncs->pdata[i]);
+    g_test_minimized_result (g_timer_elapsed (timer, NULL) / mcc_mncs->len, "Looking up an operator in the database");
+    g_object_unref (db);
+
+    g_timer_start (timer);
+    apns = lookup (NULL, mcc_mncs->pdata[0]);
+    g_test_minimized_result (g_timer_elapsed (timer, NULL), "Building the provider index");
+
+    g_timer_start (timer);
+    for (guint i = 0; i < mcc_mncs->len; i++) {
+        g_autoptr(GPtrArray) indexed_apns = lookup (NULL, mcc_mncs->pdata[i]);
+    }
+    g_test_minimized_result (g_timer_elapsed (timer, NULL) / mcc_mncs->len, "Looking up an operator in the index");
+}
+
+gint
+main (gint argc, gchar **argv)
+{
+    g_test_init (&argc, &argv, G_TEST_OPTION_ISOLATE_DIRS, NULL);
+
+    g_test_add_func ("/wwan/provider-index/lookup", test_lookup);
+    g_test_add_func ("/wwan/provider-index/database-changed", test_database_changed);
+    if (g_test_perf ())
+        g_test_add_func ("/wwan/provider-index/benchmark", test_lookup_benchmark);
+
+    return g_test_run ();
+}